@@ -8,6 +8,7 @@
 #include "hardware/bma.h"
 #include "hardware/blestepctl.h"
 #include "hardware/motor.h"
+#include "utils/history.h"
 
 // App icon must have an size of 64x64 pixel with an alpha channel
 // Use https://lvgl.io/tools/imageconverter to convert your images and set "true color with alpha"
@@ -27,6 +28,7 @@ static String size, length, goal_step, goal_dist;
 // Widgets
 static Label lblStepcounter, lblStepachievement;
 static Label lblDistance, lblDistachievement;
+static Label lblWeek;
 static Arc arcStepcounter, arcDistance;
 
 static Style big, small;
@@ -127,6 +129,11 @@ void build_main_page()
     lblDistachievement.text("0")
         .style(small, true)
         .alignOrig0(arcDistance, LV_ALIGN_CENTER);
+
+    lblWeek = Label(&screen);
+    lblWeek.text("")
+        .style(small, true)
+        .alignInParentTopLeft(10, 10);
 }
 
 void refresh_main_page()
@@ -153,6 +160,18 @@ void refresh_main_page()
     snprintf( buff, sizeof( buff ), "%d%%", gDist == 0 ? 0 : 100 * dist / gDist );
     lblDistachievement.text(buff).realign();
     arcDistance.end( gDist == 0 ? 0 : 360 * dist / gDist );
+    // Steps of the last 7 closed days from the history
+    timeseries_point_t points[ 7 ];
+    uint32_t now = history_get_local_time();
+    int32_t count = now ? history_query( HISTORY_STEPS, TIMESERIES_DAY, now - 7 * 86400, now, points, 7 ) : 0;
+    int32_t week = 0;
+    for( int32_t i = 0 ; i < count ; i++ ) {
+        week += points[ i ].value;
+    }
+    if ( count ) {
+        snprintf( buff, sizeof( buff ), "7 days: %d", week );
+        lblWeek.text(buff).realign();
+    }
 }
 
 void activity_activate_cb()
@@ -50,6 +50,7 @@ LV_IMG_DECLARE(info_1_16px);
  * declare callback functions for the app and widget icon to enter the app
  */
 static void enter_corona_app_detector_event_cb( lv_obj_t * obj, lv_event_t event );
+static void corona_app_detector_build( void );
 
 void corona_app_detector_setup( void ) {
     /**
@@ -58,8 +59,12 @@ void corona_app_detector_setup( void ) {
     corona_app_detector_main_tile_num = mainbar_add_app_tile( 1, 1, "corona app detector" );
     corona_app_detector = app_register( "corona\ndetector", &corona_app_detector_64px, enter_corona_app_detector_event_cb );
     /**
-     * setup app main tile
+     * setup app main tile on first use
      */
+    mainbar_add_tile_setup_cb( corona_app_detector_main_tile_num, corona_app_detector_build );
+}
+
+static void corona_app_detector_build( void ) {
     corona_app_detector_main_setup( corona_app_detector_main_tile_num );
 }
 
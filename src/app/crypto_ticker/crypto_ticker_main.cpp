@@ -36,8 +36,9 @@
 
 #include "hardware/wifictl.h"
 
+#include "utils/worker.h"
+
 EventGroupHandle_t crypto_ticker_main_event_handle = NULL;
-TaskHandle_t _crypto_ticker_main_sync_Task;
 
 lv_obj_t *crypto_ticker_main_tile = NULL;
 lv_style_t crypto_ticker_main_style;
@@ -50,7 +51,8 @@ lv_obj_t *crypto_ticker_main_volume_value_label = NULL;
 crypto_ticker_main_data_t crypto_ticker_main_data;
 
 
-void crypto_ticker_main_sync_Task( void * pvParameters );
+int32_t crypto_ticker_main_sync_job( worker_job_t *job );
+void crypto_ticker_main_sync_done( worker_job_t *job );
 bool crypto_ticker_main_wifictl_event_cb( EventBits_t event, void *arg );
 
 LV_IMG_DECLARE(exit_32px);
@@ -197,51 +199,46 @@ void crypto_ticker_main_sync_request( void ) {
     }
     else {
         xEventGroupSetBits( crypto_ticker_main_event_handle, CRYPTO_TICKER_MAIN_SYNC_REQUEST );
-        xTaskCreate(    crypto_ticker_main_sync_Task,      /* Function to implement the task */
-                        "crypto ticker main sync Task",    /* Name of the task */
-                        5000,                            /* Stack size in words */
-                        NULL,                            /* Task input parameter */
-                        1,                               /* Priority of the task */
-                        &_crypto_ticker_main_sync_Task );  /* Task handle. */ 
+        if ( worker_submit( "crypto ticker main sync", crypto_ticker_main_sync_job, crypto_ticker_main_sync_done, NULL, WORKER_PRIO_NORMAL ) == WORKER_NO_JOB ) {
+            xEventGroupClearBits( crypto_ticker_main_event_handle, CRYPTO_TICKER_MAIN_SYNC_REQUEST );
+        }
     }
 }
 
-void crypto_ticker_main_sync_Task( void * pvParameters ) {
+int32_t crypto_ticker_main_sync_job( worker_job_t *job ) {
     crypto_ticker_config_t *crypto_ticker_config = crypto_ticker_get_config();
     int32_t retval = -1;
 
-    log_i("start crypto ticker main task, heap: %d", ESP.getFreeHeap() );
-
-    vTaskDelay( 250 );
+    vTaskDelay( WORKER_NET_SETTLE_MS );
 
     if ( xEventGroupGetBits( crypto_ticker_main_event_handle ) & CRYPTO_TICKER_MAIN_SYNC_REQUEST ) {   
         if ( crypto_ticker_config->autosync ) {
             retval = crypto_ticker_fetch_statistics( crypto_ticker_config , &crypto_ticker_main_data );
-            if ( retval == 200 ) {
-                time_t now;
-                struct tm info;
-                char buf[64];
+        }
+    }
+    return( retval );
+}
 
+void crypto_ticker_main_sync_done( worker_job_t *job ) {
+    if ( job->result == 200 ) {
+        time_t now;
+        struct tm info;
+        char buf[64];
 
-                lv_label_set_text( crypto_ticker_main_last_price_value_label, crypto_ticker_main_data.lastPrice );
-                lv_obj_align( crypto_ticker_main_last_price_value_label, NULL, LV_ALIGN_IN_RIGHT_MID, -5, 0 );
+        lv_label_set_text( crypto_ticker_main_last_price_value_label, crypto_ticker_main_data.lastPrice );
+        lv_obj_align( crypto_ticker_main_last_price_value_label, NULL, LV_ALIGN_IN_RIGHT_MID, -5, 0 );
 
-                lv_label_set_text( crypto_ticker_main_price_change_value_label, crypto_ticker_main_data.priceChangePercent );
-                lv_obj_align( crypto_ticker_main_price_change_value_label, NULL, LV_ALIGN_IN_RIGHT_MID, -5, 0 );
+        lv_label_set_text( crypto_ticker_main_price_change_value_label, crypto_ticker_main_data.priceChangePercent );
+        lv_obj_align( crypto_ticker_main_price_change_value_label, NULL, LV_ALIGN_IN_RIGHT_MID, -5, 0 );
 
-                lv_label_set_text( crypto_ticker_main_volume_value_label, crypto_ticker_main_data.volume );
-                lv_obj_align( crypto_ticker_main_volume_value_label, NULL, LV_ALIGN_IN_RIGHT_MID, -5, 0 );
-               
+        lv_label_set_text( crypto_ticker_main_volume_value_label, crypto_ticker_main_data.volume );
+        lv_obj_align( crypto_ticker_main_volume_value_label, NULL, LV_ALIGN_IN_RIGHT_MID, -5, 0 );
 
-                time( &now );
-                localtime_r( &now, &info );
-                strftime( buf, sizeof(buf), "updated: %d.%b %H:%M", &info );
-                lv_label_set_text( crypto_ticker_main_update_label, buf );
-                lv_obj_invalidate( lv_scr_act() );
-            }
-        }
+        time( &now );
+        localtime_r( &now, &info );
+        strftime( buf, sizeof(buf), "updated: %d.%b %H:%M", &info );
+        lv_label_set_text( crypto_ticker_main_update_label, buf );
+        lv_obj_invalidate( lv_scr_act() );
     }
     xEventGroupClearBits( crypto_ticker_main_event_handle, CRYPTO_TICKER_MAIN_SYNC_REQUEST );
-    log_i("finish crypto ticker main task, heap: %d", ESP.getFreeHeap() );
-    vTaskDelete( NULL );
 }
\ No newline at end of file
@@ -32,12 +32,13 @@
 #include "gui/widget.h"
 
 #include "utils/json_psram_allocator.h"
+#include "utils/worker.h"
 #include "hardware/wifictl.h"
 
 EventGroupHandle_t crypto_ticker_widget_event_handle = NULL;
 
-TaskHandle_t _crypto_ticker_widget_sync_Task;
-void crypto_ticker_widget_sync_Task( void * pvParameters );
+int32_t crypto_ticker_widget_sync_job( worker_job_t *job );
+void crypto_ticker_widget_sync_done( worker_job_t *job );
 
 crypto_ticker_widget_data_t crypto_ticker_widget_data;
 
@@ -96,36 +97,36 @@ void crypto_ticker_widget_sync_request( void ) {
     else {
         xEventGroupSetBits( crypto_ticker_widget_event_handle, CRYPTO_TICKER_WIDGET_SYNC_REQUEST );
         widget_hide_indicator( crypto_ticker_widget );
-        xTaskCreate(    crypto_ticker_widget_sync_Task,       /* Function to implement the task */
-                        "crypto_ticker widget sync Task",     /* Name of the task */
-                        5000,                           /* Stack size in words */
-                        NULL,                           /* Task input parameter */
-                        1,                              /* Priority of the task */
-                        &_crypto_ticker_widget_sync_Task );   /* Task handle. */
+        if ( worker_submit( "crypto_ticker widget sync", crypto_ticker_widget_sync_job, crypto_ticker_widget_sync_done, NULL, WORKER_PRIO_NORMAL ) == WORKER_NO_JOB ) {
+            xEventGroupClearBits( crypto_ticker_widget_event_handle, CRYPTO_TICKER_WIDGET_SYNC_REQUEST );
+        }
     }
 }
 
-void crypto_ticker_widget_sync_Task( void * pvParameters ) {
-    log_i("start crypto_ticker widget task");
+int32_t crypto_ticker_widget_sync_job( worker_job_t *job ) {
+    int32_t retval = -1;
 
-    vTaskDelay( 250 );
+    vTaskDelay( WORKER_NET_SETTLE_MS );
 
     if ( xEventGroupGetBits( crypto_ticker_widget_event_handle ) & CRYPTO_TICKER_WIDGET_SYNC_REQUEST ) {       
-        uint32_t retval = crypto_ticker_fetch_price(crypto_ticker_get_config() , &crypto_ticker_widget_data );
-        if ( retval == 200 ) {
-            widget_set_indicator( crypto_ticker_widget, ICON_INDICATOR_OK );
-            // Check for label text width overflow
-            auto price = crypto_ticker_widget_data.price;
-            if (strlen(price) > 7 && strchr(price, '.') != NULL) {
-                price[7] = '\0'; // Trim it
-            }
-            widget_set_label( crypto_ticker_widget, price );
-        }
-        else {
-            widget_set_indicator( crypto_ticker_widget, ICON_INDICATOR_FAIL );
+        retval = crypto_ticker_fetch_price(crypto_ticker_get_config() , &crypto_ticker_widget_data );
+    }
+    return( retval );
+}
+
+void crypto_ticker_widget_sync_done( worker_job_t *job ) {
+    if ( job->result == 200 ) {
+        widget_set_indicator( crypto_ticker_widget, ICON_INDICATOR_OK );
+        // Check for label text width overflow
+        auto price = crypto_ticker_widget_data.price;
+        if (strlen(price) > 7 && strchr(price, '.') != NULL) {
+            price[7] = '\0'; // Trim it
         }
+        widget_set_label( crypto_ticker_widget, price );
+    }
+    else {
+        widget_set_indicator( crypto_ticker_widget, ICON_INDICATOR_FAIL );
     }
     xEventGroupClearBits( crypto_ticker_widget_event_handle, CRYPTO_TICKER_WIDGET_SYNC_REQUEST );
-    vTaskDelete( NULL );
 }
 
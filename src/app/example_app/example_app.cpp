@@ -47,6 +47,7 @@ LV_IMG_DECLARE(info_1_16px);
 // declare callback functions for the app and widget icon to enter the app
 static void enter_example_app_event_cb( lv_obj_t * obj, lv_event_t event );
 static void enter_example_widget_event_cb( lv_obj_t * obj, lv_event_t event );
+static void example_app_build( void );
 
 /*
  * setup routine for example app
@@ -74,7 +75,17 @@ void example_app_setup( void ) {
     widget_set_indicator( example_widget, ICON_INDICATOR_UPDATE );
 #endif // EXAMPLE_WIDGET
 
-    // init main and setup tile, see example_app_main.cpp and example_app_setup.cpp
+    // init main and setup tile on first use, see example_app_main.cpp and example_app_setup.cpp
+    // register the build function on both tiles, so both are build together on the first jump
+    // to one of them. apps that need the tile content at boot call the setup functions directly
+    mainbar_add_tile_setup_cb( example_app_main_tile_num, example_app_build );
+    mainbar_add_tile_setup_cb( example_app_setup_tile_num, example_app_build );
+}
+
+/*
+ * build all tiles of the app
+ */
+static void example_app_build( void ) {
     example_app_main_setup( example_app_main_tile_num );
     example_app_setup_setup( example_app_setup_tile_num );
 }
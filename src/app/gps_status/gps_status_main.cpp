@@ -89,7 +89,6 @@ void gps_status_main_setup(uint32_t tile_num) {
     lv_obj_add_style(setup_btn, LV_IMGBTN_PART_MAIN, &gps_status_main_style);
     lv_obj_align(setup_btn, gps_status_main_tile, LV_ALIGN_IN_BOTTOM_RIGHT, -10, -10);
     lv_obj_set_event_cb(setup_btn, enter_gps_status_setup_event_cb);
-    lv_obj_set_hidden(setup_btn, true);
 
     lv_style_copy(&gps_status_value_style, ws_get_mainbar_style());
     lv_style_set_bg_color(&gps_status_value_style, LV_OBJ_PART_MAIN, LV_COLOR_BLACK);
@@ -212,11 +211,7 @@ void gps_status_main_setup(uint32_t tile_num) {
      */
     gpsctl_register_cb(     GPSCTL_FIX 
                           | GPSCTL_NOFIX
-                          | GPSCTL_UPDATE_LOCATION
-                          | GPSCTL_UPDATE_SATELLITE
-                          | GPSCTL_UPDATE_SPEED
-                          | GPSCTL_UPDATE_ALTITUDE
-                          | GPSCTL_UPDATE_SOURCE
+                          | GPSCTL_UPDATE_FIX
                           , gpsctl_gps_status_event_cb
                           , "gpsctl gps status" );
 }
@@ -257,36 +252,41 @@ bool gpsctl_gps_status_event_cb( EventBits_t event, void *arg ) {
             lv_label_set_text( speed_value, "n/a" );
             lv_label_set_text( source_value, "n/a" );
             break;
-        case GPSCTL_UPDATE_LOCATION:
-            if( gps_data->valid_location )
-                snprintf( temp, sizeof( temp ), "%.4f/%.4f", gps_data->lat, gps_data->lon );
-            else
-                snprintf( temp, sizeof( temp ), "n/a" );
-            lv_label_set_text( pos_longlat_value, temp );
-            break;
-        case GPSCTL_UPDATE_SATELLITE:
-            if ( gps_data->valid_satellite )
-                snprintf( temp, sizeof( temp ), "%d", gps_data->satellites );
-            else
-                snprintf( temp, sizeof( temp ), "n/a" );
-            lv_label_set_text( num_satellites_value, temp );
-            break;
-        case GPSCTL_UPDATE_SPEED:
-            if ( gps_data->valid_speed )
-                snprintf( temp, sizeof( temp ), "%.2fkm/h", gps_data->speed_kmh );
-            else
-                snprintf( temp, sizeof( temp ), "n/a" );
-            lv_label_set_text( speed_value, temp );
-            break;
-        case GPSCTL_UPDATE_ALTITUDE:
-            if ( gps_data->valid_altitude )
-                snprintf( temp, sizeof( temp ), "%.1fm", gps_data->altitude_meters );
-            else
-                snprintf( temp, sizeof( temp ), "n/a" );
-            lv_label_set_text( altitude_value, temp);
-            break;
-        case GPSCTL_UPDATE_SOURCE:
-            lv_label_set_text( source_value, gpsctl_get_source_str( gps_data->gps_source ) );
+        case GPSCTL_UPDATE_FIX:
+            /*
+             * only the changed fields are redrawn
+             */
+            if ( gps_data->updated & GPSCTL_UPDATE_LOCATION ) {
+                if( gps_data->valid_location )
+                    snprintf( temp, sizeof( temp ), "%.4f/%.4f", gps_data->lat, gps_data->lon );
+                else
+                    snprintf( temp, sizeof( temp ), "n/a" );
+                lv_label_set_text( pos_longlat_value, temp );
+            }
+            if ( gps_data->updated & GPSCTL_UPDATE_SATELLITE ) {
+                if ( gps_data->valid_satellite )
+                    snprintf( temp, sizeof( temp ), "%d", gps_data->satellites );
+                else
+                    snprintf( temp, sizeof( temp ), "n/a" );
+                lv_label_set_text( num_satellites_value, temp );
+            }
+            if ( gps_data->updated & GPSCTL_UPDATE_SPEED ) {
+                if ( gps_data->valid_speed )
+                    snprintf( temp, sizeof( temp ), "%.2fkm/h", gps_data->speed_kmh );
+                else
+                    snprintf( temp, sizeof( temp ), "n/a" );
+                lv_label_set_text( speed_value, temp );
+            }
+            if ( gps_data->updated & GPSCTL_UPDATE_ALTITUDE ) {
+                if ( gps_data->valid_altitude )
+                    snprintf( temp, sizeof( temp ), "%.1fm", gps_data->altitude_meters );
+                else
+                    snprintf( temp, sizeof( temp ), "n/a" );
+                lv_label_set_text( altitude_value, temp);
+            }
+            if ( gps_data->updated & GPSCTL_UPDATE_SOURCE ) {
+                lv_label_set_text( source_value, gpsctl_get_source_str( gps_data->gps_source ) );
+            }
             break;
     }
 
@@ -30,15 +30,17 @@
 #include "gui/statusbar.h"
 #include "gui/widget_styles.h"
 
+#include "utils/track_recorder.h"
+
 lv_obj_t *gps_status_setup_tile = NULL;
 lv_style_t gps_status_setup_style;
 
-lv_obj_t *gps_status_foobar_switch = NULL;
+lv_obj_t *gps_status_record_switch = NULL;
 
 LV_IMG_DECLARE(exit_32px);
 
 static void exit_gps_status_setup_event_cb( lv_obj_t * obj, lv_event_t event );
-static void gps_status_foobar_switch_event_cb( lv_obj_t * obj, lv_event_t event );
+static void gps_status_record_switch_event_cb( lv_obj_t * obj, lv_event_t event );
 
 void gps_status_setup_setup( uint32_t tile_num ) {
 
@@ -65,27 +67,33 @@ void gps_status_setup_setup( uint32_t tile_num ) {
     lv_label_set_text( exit_label, "gps status setup");
     lv_obj_align( exit_label, exit_btn, LV_ALIGN_OUT_RIGHT_MID, 5, 0 );
 
-    lv_obj_t *gps_status_foobar_switch_cont = lv_obj_create( gps_status_setup_tile, NULL );
-    lv_obj_set_size( gps_status_foobar_switch_cont, lv_disp_get_hor_res( NULL ) , 40);
-    lv_obj_add_style( gps_status_foobar_switch_cont, LV_OBJ_PART_MAIN, &gps_status_setup_style  );
-    lv_obj_align( gps_status_foobar_switch_cont, exit_cont, LV_ALIGN_OUT_BOTTOM_LEFT, 0, 0 );
-
-    gps_status_foobar_switch = lv_switch_create( gps_status_foobar_switch_cont, NULL );
-    lv_obj_add_protect( gps_status_foobar_switch, LV_PROTECT_CLICK_FOCUS);
-    lv_obj_add_style( gps_status_foobar_switch, LV_SWITCH_PART_INDIC, ws_get_switch_style() );
-    lv_switch_off( gps_status_foobar_switch, LV_ANIM_ON );
-    lv_obj_align( gps_status_foobar_switch, gps_status_foobar_switch_cont, LV_ALIGN_IN_RIGHT_MID, -5, 0 );
-    lv_obj_set_event_cb( gps_status_foobar_switch, gps_status_foobar_switch_event_cb );
-
-    lv_obj_t *gps_status_foobar_switch_label = lv_label_create( gps_status_foobar_switch_cont, NULL);
-    lv_obj_add_style( gps_status_foobar_switch_label, LV_OBJ_PART_MAIN, &gps_status_setup_style  );
-    lv_label_set_text( gps_status_foobar_switch_label, "foo bar");
-    lv_obj_align( gps_status_foobar_switch_label, gps_status_foobar_switch_cont, LV_ALIGN_IN_LEFT_MID, 5, 0 );
+    lv_obj_t *gps_status_record_switch_cont = lv_obj_create( gps_status_setup_tile, NULL );
+    lv_obj_set_size( gps_status_record_switch_cont, lv_disp_get_hor_res( NULL ) , 40);
+    lv_obj_add_style( gps_status_record_switch_cont, LV_OBJ_PART_MAIN, &gps_status_setup_style  );
+    lv_obj_align( gps_status_record_switch_cont, exit_cont, LV_ALIGN_OUT_BOTTOM_LEFT, 0, 0 );
+
+    gps_status_record_switch = lv_switch_create( gps_status_record_switch_cont, NULL );
+    lv_obj_add_protect( gps_status_record_switch, LV_PROTECT_CLICK_FOCUS);
+    lv_obj_add_style( gps_status_record_switch, LV_SWITCH_PART_INDIC, ws_get_switch_style() );
+    lv_switch_off( gps_status_record_switch, LV_ANIM_ON );
+    lv_obj_align( gps_status_record_switch, gps_status_record_switch_cont, LV_ALIGN_IN_RIGHT_MID, -5, 0 );
+    lv_obj_set_event_cb( gps_status_record_switch, gps_status_record_switch_event_cb );
+
+    lv_obj_t *gps_status_record_switch_label = lv_label_create( gps_status_record_switch_cont, NULL);
+    lv_obj_add_style( gps_status_record_switch_label, LV_OBJ_PART_MAIN, &gps_status_setup_style  );
+    lv_label_set_text( gps_status_record_switch_label, "record track");
+    lv_obj_align( gps_status_record_switch_label, gps_status_record_switch_cont, LV_ALIGN_IN_LEFT_MID, 5, 0 );
 }
 
-static void gps_status_foobar_switch_event_cb( lv_obj_t * obj, lv_event_t event ) {
+static void gps_status_record_switch_event_cb( lv_obj_t * obj, lv_event_t event ) {
     switch( event ) {
-        case( LV_EVENT_VALUE_CHANGED ): Serial.printf( "switch value = %d\r\n", lv_switch_get_state( obj ) );
+        case( LV_EVENT_VALUE_CHANGED ): if ( lv_switch_get_state( obj ) ) {
+                                            if ( !track_recorder_start() )
+                                                lv_switch_off( obj, LV_ANIM_ON );
+                                        }
+                                        else {
+                                            track_recorder_stop();
+                                        }
                                         break;
     }
 }
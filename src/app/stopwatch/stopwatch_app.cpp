@@ -41,6 +41,7 @@ LV_IMG_DECLARE(stopwatch_app_64px);
 
 // declare callback functions
 static void enter_stopwatch_app_event_cb( lv_obj_t * obj, lv_event_t event );
+static void stopwatch_app_build( void );
 
 // setup routine for stopwatch app
 void stopwatch_app_setup( void ) {
@@ -49,7 +50,11 @@ void stopwatch_app_setup( void ) {
 
     stopwatch_app = app_register( "stop\nwatch", &stopwatch_app_64px, enter_stopwatch_app_event_cb );
 
-    // init main and setup tile, see stopwatch_app_main.cpp and stopwatch_app_setup.cpp
+    // init main tile on first use, see stopwatch_app_main.cpp
+    mainbar_add_tile_setup_cb( stopwatch_app_main_tile_num, stopwatch_app_build );
+}
+
+static void stopwatch_app_build( void ) {
     stopwatch_app_main_setup( stopwatch_app_main_tile_num );
 }
 
@@ -38,10 +38,11 @@
 #include "hardware/wifictl.h"
 
 #include "utils/json_psram_allocator.h"
+#include "utils/worker.h"
 
 EventGroupHandle_t weather_widget_event_handle = NULL;
-TaskHandle_t _weather_widget_sync_Task;
-void weather_widget_sync_Task( void * pvParameters );
+int32_t weather_widget_sync_job( worker_job_t *job );
+void weather_widget_sync_done( worker_job_t *job );
 
 weather_config_t weather_config;
 weather_forcast_t weather_today;
@@ -133,12 +134,9 @@ void weather_widget_sync_request( void ) {
     else {
         xEventGroupSetBits( weather_widget_event_handle, WEATHER_WIDGET_SYNC_REQUEST );
         widget_hide_indicator( weather_widget );
-        xTaskCreate(    weather_widget_sync_Task,       /* Function to implement the task */
-                        "weather widget sync Task",     /* Name of the task */
-                        5000,                           /* Stack size in words */
-                        NULL,                           /* Task input parameter */
-                        1,                              /* Priority of the task */
-                        &_weather_widget_sync_Task );   /* Task handle. */
+        if ( worker_submit( "weather widget sync", weather_widget_sync_job, weather_widget_sync_done, NULL, WORKER_PRIO_NORMAL ) == WORKER_NO_JOB ) {
+            xEventGroupClearBits( weather_widget_event_handle, WEATHER_WIDGET_SYNC_REQUEST );
+        }
     }
 }
 
@@ -146,33 +144,35 @@ weather_config_t *weather_get_config( void ) {
     return( &weather_config );
 }
 
-void weather_widget_sync_Task( void * pvParameters ) {
-    log_i("start weather widget task, heap: %d", ESP.getFreeHeap() );
+int32_t weather_widget_sync_job( worker_job_t *job ) {
+    int32_t retval = -1;
 
-    vTaskDelay( 250 );
+    vTaskDelay( WORKER_NET_SETTLE_MS );
 
     if ( xEventGroupGetBits( weather_widget_event_handle ) & WEATHER_WIDGET_SYNC_REQUEST ) {       
-        uint32_t retval = weather_fetch_today( &weather_config, &weather_today );
-        if ( retval == 200 ) {
-            widget_set_label( weather_widget, weather_today.temp );
-            widget_set_icon( weather_widget, (lv_obj_t*)resolve_owm_icon( weather_today.icon ) );
-            widget_set_indicator( weather_widget, ICON_INDICATOR_OK );
-
-            if ( weather_config.showWind ) {
-                widget_set_extended_label( weather_widget, weather_today.wind );
-            }
-            else {
-                widget_set_extended_label( weather_widget, "" );
-            }
+        retval = weather_fetch_today( &weather_config, &weather_today );
+    }
+    return( retval );
+}
+
+void weather_widget_sync_done( worker_job_t *job ) {
+    if ( job->result == 200 ) {
+        widget_set_label( weather_widget, weather_today.temp );
+        widget_set_icon( weather_widget, (lv_obj_t*)resolve_owm_icon( weather_today.icon ) );
+        widget_set_indicator( weather_widget, ICON_INDICATOR_OK );
+
+        if ( weather_config.showWind ) {
+            widget_set_extended_label( weather_widget, weather_today.wind );
         }
         else {
-            widget_set_indicator( weather_widget, ICON_INDICATOR_FAIL );
+            widget_set_extended_label( weather_widget, "" );
         }
-        lv_obj_invalidate( lv_scr_act() );
     }
+    else {
+        widget_set_indicator( weather_widget, ICON_INDICATOR_FAIL );
+    }
+    lv_obj_invalidate( lv_scr_act() );
     xEventGroupClearBits( weather_widget_event_handle, WEATHER_WIDGET_SYNC_REQUEST );
-    log_i("finish weather widget task, heap: %d", ESP.getFreeHeap() );
-    vTaskDelete( NULL );
 }
 
 void weather_save_config( void ) {
@@ -37,9 +37,9 @@
 #include "hardware/wifictl.h"
 
 #include "utils/alloc.h"
+#include "utils/worker.h"
 
 EventGroupHandle_t weather_forecast_event_handle = NULL;
-TaskHandle_t _weather_forecast_sync_Task;
 
 lv_obj_t *weather_forecast_tile = NULL;
 lv_style_t weather_forecast_style;
@@ -54,7 +54,8 @@ lv_obj_t *weather_forecast_wind_label[ WEATHER_MAX_FORECAST ];
 
 static weather_forcast_t *weather_forecast = NULL;
 
-void weather_forecast_sync_Task( void * pvParameters );
+int32_t weather_forecast_sync_job( worker_job_t *job );
+void weather_forecast_sync_done( worker_job_t *job );
 bool weather_forecast_wifictl_event_cb( EventBits_t event, void *arg );
 
 LV_IMG_DECLARE(exit_32px);
@@ -189,68 +190,67 @@ void weather_forecast_sync_request( void ) {
     }
     else {
         xEventGroupSetBits( weather_forecast_event_handle, WEATHER_FORECAST_SYNC_REQUEST );
-        xTaskCreate(    weather_forecast_sync_Task,      /* Function to implement the task */
-                        "weather forecast sync Task",    /* Name of the task */
-                        5000,                            /* Stack size in words */
-                        NULL,                            /* Task input parameter */
-                        1,                               /* Priority of the task */
-                        &_weather_forecast_sync_Task );  /* Task handle. */ 
+        if ( worker_submit( "weather forecast sync", weather_forecast_sync_job, weather_forecast_sync_done, NULL, WORKER_PRIO_NORMAL ) == WORKER_NO_JOB ) {
+            xEventGroupClearBits( weather_forecast_event_handle, WEATHER_FORECAST_SYNC_REQUEST );
+        }
     }
 }
 
-void weather_forecast_sync_Task( void * pvParameters ) {
+int32_t weather_forecast_sync_job( worker_job_t *job ) {
     weather_config_t *weather_config = weather_get_config();
     int32_t retval = -1;
 
-    log_i("start weather forecast task, heap: %d", ESP.getFreeHeap() );
-
-    vTaskDelay( 250 );
+    vTaskDelay( WORKER_NET_SETTLE_MS );
 
     if ( xEventGroupGetBits( weather_forecast_event_handle ) & WEATHER_FORECAST_SYNC_REQUEST ) {   
         if ( weather_config->autosync ) {
             retval = weather_fetch_forecast( weather_get_config() , &weather_forecast[ 0 ] );
-            if ( retval == 200 ) {
-                time_t now;
-                struct tm info;
-                char buf[64];
-
-                lv_label_set_text( weather_forecast_location_label, weather_forecast[ 0 ].name );
-
-                for( int i = 0 ; i < WEATHER_MAX_FORECAST / 4 ; i++ ) {
-                    lv_imgbtn_set_src( weather_forecast_icon_imgbtn[ i ], LV_BTN_STATE_RELEASED, resolve_owm_icon( weather_forecast[ i * 2 ].icon ) );
-                    lv_imgbtn_set_src( weather_forecast_icon_imgbtn[ i ], LV_BTN_STATE_PRESSED, resolve_owm_icon( weather_forecast[ i * 2 ].icon ) );
-                    lv_imgbtn_set_src( weather_forecast_icon_imgbtn[ i ], LV_BTN_STATE_CHECKED_RELEASED, resolve_owm_icon( weather_forecast[ i * 2 ].icon ) );
-                    lv_imgbtn_set_src( weather_forecast_icon_imgbtn[ i ], LV_BTN_STATE_CHECKED_PRESSED, resolve_owm_icon( weather_forecast[ i * 2 ].icon ) );
-
-                    lv_label_set_text( weather_forecast_temperature_label[ i ], weather_forecast[ i * 2 ].temp );
-
-                    if(weather_config->showWind)
-                    {
-                        lv_obj_align(weather_forecast_temperature_label[i], weather_forecast_icon_imgbtn[i], LV_ALIGN_OUT_BOTTOM_MID, 0, -22);
-                        lv_label_set_text(weather_forecast_wind_label[i], weather_forecast[i * 2].wind);
-                        lv_obj_align(weather_forecast_wind_label[i], weather_forecast_icon_imgbtn[i], LV_ALIGN_OUT_BOTTOM_MID, 0, 0);
-                    }
-                    else
-                    {
-                        lv_obj_align(weather_forecast_temperature_label[i], weather_forecast_icon_imgbtn[i], LV_ALIGN_OUT_BOTTOM_MID, 0, 0);
-                        lv_label_set_text(weather_forecast_wind_label[i], "");
-                    }
-
-                    localtime_r( &weather_forecast[ i * 2 ].timestamp, &info );
-                    strftime( buf, sizeof(buf), "%H:%M", &info );
-                    lv_label_set_text( weather_forecast_time_label[ i ], buf );
-                    lv_obj_align( weather_forecast_time_label[ i ], weather_forecast_icon_imgbtn[ i ], LV_ALIGN_OUT_TOP_MID, 0, 0);
-                }
-
-                time( &now );
-                localtime_r( &now, &info );
-                strftime( buf, sizeof(buf), "updated: %d.%b %H:%M", &info );
-                lv_label_set_text( weather_forecast_update_label, buf );
-                lv_obj_invalidate( lv_scr_act() );
+        }
+    }
+    return( retval );
+}
+
+void weather_forecast_sync_done( worker_job_t *job ) {
+    weather_config_t *weather_config = weather_get_config();
+
+    if ( job->result == 200 ) {
+        time_t now;
+        struct tm info;
+        char buf[64];
+
+        lv_label_set_text( weather_forecast_location_label, weather_forecast[ 0 ].name );
+
+        for( int i = 0 ; i < WEATHER_MAX_FORECAST / 4 ; i++ ) {
+            lv_imgbtn_set_src( weather_forecast_icon_imgbtn[ i ], LV_BTN_STATE_RELEASED, resolve_owm_icon( weather_forecast[ i * 2 ].icon ) );
+            lv_imgbtn_set_src( weather_forecast_icon_imgbtn[ i ], LV_BTN_STATE_PRESSED, resolve_owm_icon( weather_forecast[ i * 2 ].icon ) );
+            lv_imgbtn_set_src( weather_forecast_icon_imgbtn[ i ], LV_BTN_STATE_CHECKED_RELEASED, resolve_owm_icon( weather_forecast[ i * 2 ].icon ) );
+            lv_imgbtn_set_src( weather_forecast_icon_imgbtn[ i ], LV_BTN_STATE_CHECKED_PRESSED, resolve_owm_icon( weather_forecast[ i * 2 ].icon ) );
+
+            lv_label_set_text( weather_forecast_temperature_label[ i ], weather_forecast[ i * 2 ].temp );
+
+            if(weather_config->showWind)
+            {
+                lv_obj_align(weather_forecast_temperature_label[i], weather_forecast_icon_imgbtn[i], LV_ALIGN_OUT_BOTTOM_MID, 0, -22);
+                lv_label_set_text(weather_forecast_wind_label[i], weather_forecast[i * 2].wind);
+                lv_obj_align(weather_forecast_wind_label[i], weather_forecast_icon_imgbtn[i], LV_ALIGN_OUT_BOTTOM_MID, 0, 0);
             }
+            else
+            {
+                lv_obj_align(weather_forecast_temperature_label[i], weather_forecast_icon_imgbtn[i], LV_ALIGN_OUT_BOTTOM_MID, 0, 0);
+                lv_label_set_text(weather_forecast_wind_label[i], "");
+            }
+
+            localtime_r( &weather_forecast[ i * 2 ].timestamp, &info );
+            strftime( buf, sizeof(buf), "%H:%M", &info );
+            lv_label_set_text( weather_forecast_time_label[ i ], buf );
+            lv_obj_align( weather_forecast_time_label[ i ], weather_forecast_icon_imgbtn[ i ], LV_ALIGN_OUT_TOP_MID, 0, 0);
         }
+
+        time( &now );
+        localtime_r( &now, &info );
+        strftime( buf, sizeof(buf), "updated: %d.%b %H:%M", &info );
+        lv_label_set_text( weather_forecast_update_label, buf );
+        lv_obj_invalidate( lv_scr_act() );
     }
     xEventGroupClearBits( weather_forecast_event_handle, WEATHER_FORECAST_SYNC_REQUEST );
-    log_i("finsh weather forecast task, heap: %d", ESP.getFreeHeap() );
-    vTaskDelete( NULL );
 }
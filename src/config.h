@@ -41,6 +41,7 @@
      */
     #define ENABLE_WEBSERVER                        /** @brief To disable built-in webserver, comment this line */
     #define ENABLE_FTPSERVER                        /** @brief To disable built-in ftpserver, comment this line */
+    #define ENABLE_LAZY_APP_SETUP                   /** @brief build app tiles on first use, to build all at boot comment this line */
     /**
      * Enable non-latin languages support
      */
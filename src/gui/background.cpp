@@ -0,0 +1,241 @@
+/****************************************************************************
+ *   Oct 18 15:02:44 2026
+ *   Copyright  2026  My-TTGO-Watch contributors
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#include "config.h"
+#include <stdio.h>
+#include <sys/stat.h>
+#include "esp_timer.h"
+
+#include "background.h"
+
+#include "utils/alloc.h"
+#include "utils/bench.h"
+
+extern "C" {
+    #include "utils/ESP32-targz/uzlib/uzlib.h"
+}
+#include "gui/png_decoder/png_stream.h"
+
+static_assert( sizeof( background_bin_header_t ) == BACKGROUND_BIN_HEADER_SIZE, "bg.bin header layout changed, update tools/png2bg.py" );
+
+static lv_img_dsc_t *background = NULL;
+static background_stats_t background_stats;
+static int32_t background_bench_load = -1;
+
+/**
+ * @brief crc32 of a file
+ *
+ * @return  crc32 or 0 if the file can't be read
+ */
+static uint32_t background_file_crc( const char *filename ) {
+    uint8_t buf[ 512 ];
+    uint32_t crc = 0xffffffff;
+    size_t len;
+
+    FILE *file = fopen( filename, "rb" );
+    if ( !file ) {
+        return( 0 );
+    }
+    while( ( len = fread( buf, 1, sizeof( buf ), file ) ) > 0 ) {
+        crc = uzlib_crc32( buf, len, crc );
+    }
+    fclose( file );
+    return( crc ^ 0xffffffff );
+}
+
+/**
+ * @brief get size and modification time of a file
+ *
+ * @return  true if the file exists
+ */
+static bool background_file_stat( const char *filename, uint32_t *size, uint32_t *mtime ) {
+    struct stat info;
+
+    if ( stat( filename, &info ) ) {
+        return( false );
+    }
+    *size = info.st_size;
+    *mtime = info.st_mtime;
+    return( true );
+}
+
+bool background_bake( const char *png_filename, const char *bin_filename ) {
+    int64_t start = esp_timer_get_time();
+    bool retval = true;
+
+    png_stream_t *stream = png_stream_open( png_filename );
+    if ( !stream ) {
+        log_e("background %s not supported for baking", png_filename );
+        return( false );
+    }
+
+    lv_color_t *row = (lv_color_t *)MALLOC( stream->width * sizeof( lv_color_t ) );
+    FILE *file = fopen( bin_filename, "wb" );
+    if ( !row || !file ) {
+        log_e("background bake failed, can't open %s", bin_filename );
+        if ( file ) fclose( file );
+        free( row );
+        png_stream_close( stream );
+        return( false );
+    }
+
+    background_bin_header_t header;
+    header.magic = BACKGROUND_BIN_MAGIC;
+    header.version = BACKGROUND_BIN_VERSION;
+    header.color_depth = LV_COLOR_DEPTH;
+    header.color_swap = LV_COLOR_16_SWAP;
+    header.cf = LV_IMG_CF_TRUE_COLOR;
+    header.w = stream->width;
+    header.h = stream->height;
+    header.src_crc = background_file_crc( png_filename );
+    header.src_size = 0;
+    header.src_mtime = 0;
+    background_file_stat( png_filename, &header.src_size, &header.src_mtime );
+    retval = fwrite( &header, sizeof( header ), 1, file ) == 1;
+    /*
+     * convert row by row, transparent pixels are blended onto black
+     */
+    for( uint32_t y = 0 ; y < stream->height && retval ; y++ ) {
+        const uint8_t *rgba = png_stream_read_row( stream, y );
+        if ( !rgba ) {
+            retval = false;
+            break;
+        }
+        for( uint32_t x = 0 ; x < stream->width ; x++ ) {
+            uint8_t a = rgba[ 3 ];
+            row[ x ] = lv_color_make( rgba[ 0 ] * a / 255, rgba[ 1 ] * a / 255, rgba[ 2 ] * a / 255 );
+            rgba += 4;
+        }
+        retval = fwrite( row, sizeof( lv_color_t ), stream->width, file ) == stream->width;
+    }
+    fclose( file );
+    free( row );
+    png_stream_close( stream );
+
+    if ( !retval ) {
+        log_e("background bake failed, remove %s", bin_filename );
+        remove( bin_filename );
+        return( false );
+    }
+    background_stats.bake_us = esp_timer_get_time() - start;
+    background_stats.bakes++;
+    log_i("background %s baked into %s ( %dx%d, %dms )", png_filename, bin_filename, header.w, header.h, background_stats.bake_us / 1000 );
+    return( true );
+}
+
+const lv_img_dsc_t *background_load( const char *bin_filename, const char *png_filename ) {
+    background_bin_header_t header;
+
+    if ( background_bench_load == -1 ) {
+        background_bench_load = bench_register( "background load", BENCH_NO_BUDGET );
+    }
+
+    FILE *file = fopen( bin_filename, "rb" );
+    if ( !file ) {
+        return( NULL );
+    }
+    if ( fread( &header, sizeof( header ), 1, file ) != 1 || header.magic != BACKGROUND_BIN_MAGIC || header.version != BACKGROUND_BIN_VERSION
+                                                           || header.color_depth != LV_COLOR_DEPTH || header.color_swap != LV_COLOR_16_SWAP
+                                                           || header.cf != LV_IMG_CF_TRUE_COLOR ) {
+        log_w("background %s invalid or not in the native color format", bin_filename );
+        fclose( file );
+        return( NULL );
+    }
+    /*
+     * a bin file without source crc is always used, e.g. uploaded without png.
+     * the png is only read for the crc if size or modification time changed
+     */
+    uint32_t src_size, src_mtime;
+    if ( header.src_crc && png_filename && background_file_stat( png_filename, &src_size, &src_mtime )
+                        && ( src_size != header.src_size || src_mtime != header.src_mtime || !src_mtime ) ) {
+        uint32_t crc = background_file_crc( png_filename );
+        if ( crc && crc != header.src_crc ) {
+            log_i("background %s is outdated", bin_filename );
+            fclose( file );
+            return( NULL );
+        }
+        /*
+         * same content, e.g. uploaded again or converted on a computer, skip the crc next time
+         */
+        if ( src_mtime ) {
+            FILE *update = fopen( bin_filename, "r+b" );
+            if ( update ) {
+                header.src_size = src_size;
+                header.src_mtime = src_mtime;
+                fwrite( &header, sizeof( header ), 1, update );
+                fclose( update );
+            }
+        }
+    }
+
+    uint64_t bench_start = bench_begin( background_bench_load );
+    /*
+     * image descriptor and pixel data in one block, pixel data are read at once
+     */
+    uint32_t data_size = header.w * header.h * sizeof( lv_color_t );
+    lv_img_dsc_t *img = (lv_img_dsc_t *)MALLOC( sizeof( lv_img_dsc_t ) + data_size );
+    if ( !img ) {
+        log_e("background alloc failed ( %d bytes )", sizeof( lv_img_dsc_t ) + data_size );
+        fclose( file );
+        bench_end( background_bench_load, bench_start );
+        return( NULL );
+    }
+    uint8_t *data = (uint8_t *)( img + 1 );
+    size_t len = fread( data, 1, data_size, file );
+    fclose( file );
+    if ( len != data_size ) {
+        log_e("background %s truncated", bin_filename );
+        free( img );
+        bench_end( background_bench_load, bench_start );
+        return( NULL );
+    }
+    img->header.always_zero = 0;
+    img->header.cf = LV_IMG_CF_TRUE_COLOR;
+    img->header.w = header.w;
+    img->header.h = header.h;
+    img->data_size = data_size;
+    img->data = data;
+
+    background_release();
+    background = img;
+    background_stats.baked = true;
+    background_stats.bytes = sizeof( lv_img_dsc_t ) + data_size;
+    background_stats.load_us = bench_end( background_bench_load, bench_start );
+    log_i("background %s loaded ( %dx%d, %dus )", bin_filename, header.w, header.h, background_stats.load_us );
+    return( background );
+}
+
+void background_release( void ) {
+    if ( !background ) {
+        return;
+    }
+    /*
+     * the next background can get the same address
+     */
+    lv_img_cache_invalidate_src( background );
+    free( background );
+    background = NULL;
+    background_stats.baked = false;
+    background_stats.bytes = 0;
+}
+
+void background_get_stats( background_stats_t *stats ) {
+    *stats = background_stats;
+}
@@ -0,0 +1,110 @@
+/****************************************************************************
+ *   Oct 18 15:02:44 2026
+ *   Copyright  2026  My-TTGO-Watch contributors
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#ifndef _BACKGROUND_H
+    #define _BACKGROUND_H
+
+    #include <stdint.h>
+    #include "lvgl/lvgl.h"
+
+    #define BACKGROUND_BIN_MAGIC        0x4e424742  /** @brief "BGBN" */
+    #define BACKGROUND_BIN_VERSION      2           /** @brief background bin file version */
+    #define BACKGROUND_BIN_HEADER_SIZE  24          /** @brief size of background_bin_header_t in bytes */
+
+    /**
+     * @brief pre-baked background file header, followed by w * h pixels in the
+     * native color format, all values are little endian. the 24 byte header of
+     * version 2, tools/png2bg.py writes it as struct "<IBBBBHHIII":
+     *
+     *  offset  size    field
+     *  0       4       magic
+     *  4       1       version
+     *  5       1       color_depth
+     *  6       1       color_swap
+     *  7       1       cf
+     *  8       2       w
+     *  10      2       h
+     *  12      4       src_crc
+     *  16      4       src_size
+     *  20      4       src_mtime
+     */
+    typedef struct __attribute__((packed)) {
+        uint32_t magic;                             /** @brief BACKGROUND_BIN_MAGIC */
+        uint8_t version;                            /** @brief BACKGROUND_BIN_VERSION */
+        uint8_t color_depth;                        /** @brief LV_COLOR_DEPTH of the pixel data */
+        uint8_t color_swap;                         /** @brief LV_COLOR_16_SWAP of the pixel data */
+        uint8_t cf;                                 /** @brief LV_IMG_CF_TRUE_COLOR */
+        uint16_t w;                                 /** @brief width in pixels */
+        uint16_t h;                                 /** @brief height in pixels */
+        uint32_t src_crc;                           /** @brief crc32 of the source png file, 0 if unknown */
+        uint32_t src_size;                          /** @brief size of the source png file when the crc was checked */
+        uint32_t src_mtime;                         /** @brief modification time of the source png file when the crc was checked, 0 if unknown */
+    } background_bin_header_t;
+
+    /**
+     * @brief background statistic
+     */
+    typedef struct {
+        bool baked;                                 /** @brief true if the current background is a pre-baked bin file */
+        uint32_t bytes;                             /** @brief bytes held by the current background */
+        uint32_t load_us;                           /** @brief last bin load time in us */
+        uint32_t bake_us;                           /** @brief last bake time in us */
+        uint32_t bakes;                             /** @brief number of bakes since boot */
+    } background_stats_t;
+
+    #ifdef __cplusplus
+    extern "C" {
+    #endif
+
+    /**
+     * @brief convert a png file into a pre-baked background bin file
+     *
+     * @param   png_filename    source png file
+     * @param   bin_filename    destination bin file
+     *
+     * @return  true if success, false if failed or the png is not supported
+     */
+    bool background_bake( const char *png_filename, const char *bin_filename );
+    /**
+     * @brief load a pre-baked background with a single block read, the previous
+     * background is released
+     *
+     * @param   bin_filename    bin file
+     * @param   png_filename    source png file, the bin file is rejected if the png has changed, can be NULL
+     *
+     * @return  pointer to the image or NULL if not found, outdated or invalid
+     */
+    const lv_img_dsc_t *background_load( const char *bin_filename, const char *png_filename );
+    /**
+     * @brief free the loaded background, set an other image source before
+     */
+    void background_release( void );
+    /**
+     * @brief get the background statistic
+     *
+     * @param   stats           pointer to a background_stats_t structure
+     */
+    void background_get_stats( background_stats_t *stats );
+
+    #ifdef __cplusplus
+    }
+    #endif
+
+#endif // _BACKGROUND_H
@@ -0,0 +1,206 @@
+/****************************************************************************
+ *   Oct 18 15:41:09 2026
+ *   Copyright  2026  My-TTGO-Watch contributors
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#include "config.h"
+
+#include "glyph_cache.h"
+#include "utils/alloc.h"
+#include "utils/bench.h"
+
+/**
+ * @brief one registered font
+ */
+typedef struct {
+    const lv_font_t *font;                                              /** @brief cached font */
+    const uint8_t * (*get_glyph_bitmap)( const lv_font_t *, uint32_t ); /** @brief original LVGL callback */
+    glyph_cache_font_stats_t stats;                                     /** @brief font statistic */
+} glyph_cache_font_t;
+
+/**
+ * @brief one decompressed glyph
+ */
+typedef struct {
+    const lv_font_t *font;              /** @brief font of the glyph */
+    uint32_t letter;                    /** @brief unicode letter */
+    uint8_t *data;                      /** @brief decompressed bitmap, NULL for a free entry */
+    uint32_t size;                      /** @brief bitmap size in bytes */
+    uint32_t used;                      /** @brief lru counter of the last use */
+    uint8_t font_index;                 /** @brief index into glyph_cache_font */
+} glyph_cache_entry_t;
+
+static glyph_cache_font_t glyph_cache_font[ GLYPH_CACHE_FONTS ];
+static int32_t glyph_cache_fonts = 0;
+static glyph_cache_entry_t glyph_cache[ GLYPH_CACHE_ENTRYS ];
+static uint32_t glyph_cache_bytes = 0;
+static uint32_t glyph_cache_counter = 0;
+static int32_t glyph_cache_bench_decompress = -1;
+
+static const uint8_t *glyph_cache_get_glyph_bitmap( const lv_font_t *font, uint32_t letter );
+
+bool glyph_cache_register( lv_font_t *font, const char *name ) {
+    const lv_font_fmt_txt_dsc_t *fdsc = (const lv_font_fmt_txt_dsc_t *)font->dsc;
+
+    if ( font->get_glyph_bitmap != lv_font_get_bitmap_fmt_txt || fdsc->bitmap_format == LV_FONT_FMT_TXT_PLAIN ) {
+        log_w("font %s is not compressed, not cached", name );
+        return( false );
+    }
+    if ( glyph_cache_fonts >= GLYPH_CACHE_FONTS ) {
+        log_e("glyph cache font table full");
+        return( false );
+    }
+    if ( glyph_cache_bench_decompress == -1 ) {
+        glyph_cache_bench_decompress = bench_register( "glyph decompress", BENCH_NO_BUDGET );
+    }
+    glyph_cache_font_t *entry = &glyph_cache_font[ glyph_cache_fonts ];
+    entry->font = font;
+    entry->get_glyph_bitmap = font->get_glyph_bitmap;
+    entry->stats.name = name;
+    glyph_cache_fonts++;
+
+    font->get_glyph_bitmap = glyph_cache_get_glyph_bitmap;
+    log_i("glyph cache for font %s enabled", name );
+    return( true );
+}
+
+int32_t glyph_cache_get_fonts( void ) {
+    return( glyph_cache_fonts );
+}
+
+const glyph_cache_font_stats_t *glyph_cache_get_font_stats( int32_t font ) {
+    if ( font < 0 || font >= glyph_cache_fonts ) {
+        return( NULL );
+    }
+    return( &glyph_cache_font[ font ].stats );
+}
+
+static void glyph_cache_drop( glyph_cache_entry_t *entry ) {
+    glyph_cache_font_stats_t *stats = &glyph_cache_font[ entry->font_index ].stats;
+
+    free( entry->data );
+    glyph_cache_bytes -= entry->size;
+    stats->bytes -= entry->size;
+    stats->entrys--;
+    entry->data = NULL;
+}
+
+/**
+ * @brief get a free entry, least recently used glyphs are evicted until size bytes fit
+ *
+ * @return  pointer to a free entry or NULL if the glyph is larger than the cache
+ */
+static glyph_cache_entry_t *glyph_cache_alloc( uint32_t size ) {
+    if ( size > GLYPH_CACHE_SIZE ) {
+        return( NULL );
+    }
+    while( true ) {
+        glyph_cache_entry_t *free_entry = NULL;
+        glyph_cache_entry_t *lru = NULL;
+
+        for( int32_t i = 0 ; i < GLYPH_CACHE_ENTRYS ; i++ ) {
+            glyph_cache_entry_t *entry = &glyph_cache[ i ];
+            if ( entry->data == NULL ) {
+                if ( !free_entry ) {
+                    free_entry = entry;
+                }
+            }
+            else if ( !lru || entry->used < lru->used ) {
+                lru = entry;
+            }
+        }
+        if ( free_entry && glyph_cache_bytes + size <= GLYPH_CACHE_SIZE ) {
+            return( free_entry );
+        }
+        if ( !lru ) {
+            return( NULL );
+        }
+        glyph_cache_drop( lru );
+    }
+}
+
+/**
+ * @brief get_glyph_bitmap replacement, the returned bitmap stays valid until
+ * the next call like the LVGL decompress buffer
+ */
+static const uint8_t *glyph_cache_get_glyph_bitmap( const lv_font_t *font, uint32_t letter ) {
+    int32_t font_index = 0;
+
+    while( font_index < glyph_cache_fonts && glyph_cache_font[ font_index ].font != font ) {
+        font_index++;
+    }
+    if ( font_index == glyph_cache_fonts ) {
+        return( lv_font_get_bitmap_fmt_txt( font, letter ) );
+    }
+    glyph_cache_font_t *cached_font = &glyph_cache_font[ font_index ];
+
+    for( int32_t i = 0 ; i < GLYPH_CACHE_ENTRYS ; i++ ) {
+        glyph_cache_entry_t *entry = &glyph_cache[ i ];
+        if ( entry->data && entry->font == font && entry->letter == letter ) {
+            entry->used = ++glyph_cache_counter;
+            cached_font->stats.hits++;
+            return( entry->data );
+        }
+    }
+    cached_font->stats.misses++;
+
+    uint64_t bench_start = bench_begin( glyph_cache_bench_decompress );
+    const uint8_t *bitmap = cached_font->get_glyph_bitmap( font, letter );
+    bench_end( glyph_cache_bench_decompress, bench_start );
+    if ( !bitmap ) {
+        return( NULL );
+    }
+    /*
+     * same size as the LVGL decompress buffer, 3 bpp is decompressed to 4 bpp
+     */
+    lv_font_glyph_dsc_t dsc;
+    if ( !lv_font_get_glyph_dsc( font, &dsc, letter, 0 ) ) {
+        return( bitmap );
+    }
+    uint32_t pixels = dsc.box_w * dsc.box_h;
+    uint32_t size;
+    switch( dsc.bpp ) {
+        case 1:     size = ( pixels + 7 ) >> 3;
+                    break;
+        case 2:     size = ( pixels + 3 ) >> 2;
+                    break;
+        case 3:
+        case 4:     size = ( pixels + 1 ) >> 1;
+                    break;
+        default:    size = pixels;
+                    break;
+    }
+    glyph_cache_entry_t *entry = glyph_cache_alloc( size );
+    if ( !entry ) {
+        return( bitmap );
+    }
+    entry->data = (uint8_t *)MALLOC( size );
+    if ( !entry->data ) {
+        return( bitmap );
+    }
+    memcpy( entry->data, bitmap, size );
+    entry->font = font;
+    entry->letter = letter;
+    entry->size = size;
+    entry->font_index = font_index;
+    entry->used = ++glyph_cache_counter;
+    glyph_cache_bytes += size;
+    cached_font->stats.bytes += size;
+    cached_font->stats.entrys++;
+    return( entry->data );
+}
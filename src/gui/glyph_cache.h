@@ -0,0 +1,75 @@
+/****************************************************************************
+ *   Oct 18 15:41:09 2026
+ *   Copyright  2026  My-TTGO-Watch contributors
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#ifndef _GLYPH_CACHE_H
+    #define _GLYPH_CACHE_H
+
+    #include "lvgl/lvgl.h"
+
+    /*
+     * note:    tools/glyph_cache_sim.cpp builds this module on the host with
+     *          the real fonts and replays the main tile refresh.
+     */
+
+    #define GLYPH_CACHE_FONTS       8                   /** @brief max number of cached fonts */
+    #define GLYPH_CACHE_ENTRYS      128                 /** @brief max number of cached glyphs */
+    #if defined( BOARD_HAS_PSRAM )
+        #define GLYPH_CACHE_SIZE    ( 48 * 1024 )       /** @brief max decompressed glyph bytes in the cache */
+    #else
+        #define GLYPH_CACHE_SIZE    ( 8 * 1024 )        /** @brief max decompressed glyph bytes in the cache */
+    #endif
+
+    /**
+     * @brief per font statistic
+     */
+    typedef struct {
+        const char *name;               /** @brief font name */
+        uint32_t hits;                  /** @brief glyph bitmaps served from the cache */
+        uint32_t misses;                /** @brief glyph bitmaps decompressed by LVGL */
+        uint32_t entrys;                /** @brief cached glyphs */
+        uint32_t bytes;                 /** @brief cached glyph bytes */
+    } glyph_cache_font_stats_t;
+
+    /**
+     * @brief cache the decompressed glyph bitmaps of a compressed font, the
+     * font get_glyph_bitmap callback is replaced. uncompressed fonts are ignored
+     *
+     * @param   font        pointer to the font
+     * @param   name        font name for the statistic
+     *
+     * @return  true if success, false if the font is not compressed or the font table is full
+     */
+    bool glyph_cache_register( lv_font_t *font, const char *name );
+    /**
+     * @brief get the number of registered fonts
+     *
+     * @return  number of registered fonts
+     */
+    int32_t glyph_cache_get_fonts( void );
+    /**
+     * @brief get the statistic of a registered font
+     *
+     * @param   font        font number, 0...glyph_cache_get_fonts()-1
+     *
+     * @return  pointer to the statistic or NULL if failed
+     */
+    const glyph_cache_font_stats_t *glyph_cache_get_font_stats( int32_t font );
+
+#endif // _GLYPH_CACHE_H
@@ -21,9 +21,13 @@
  */
 #include "config.h"
 #include <stdio.h>
+#include "esp_timer.h"
 #include <TTGO.h>
+#include "lvgl/src/lv_misc/lv_gc.h"
 
 #include "gui.h"
+#include "background.h"
+#include "glyph_cache.h"
 #include "statusbar.h"
 #include "quickbar.h"
 #include "screenshot.h"
@@ -48,20 +52,43 @@
 #include "mainbar/setup_tile/utilities/utilities.h"
 
 #include "hardware/powermgm.h"
+#include "hardware/scheduler.h"
 #include "hardware/display.h"
 #include "hardware/motor.h"
 #include "hardware/touch.h"
+#include "hardware/framebuffer.h"
+
+#include "utils/bench.h"
+#include "utils/boot_profiler.h"
 
 lv_obj_t *img_bin;
 static volatile bool interact = false;
+static int64_t gui_wakeup_us = 0;
+static uint32_t gui_wakeup_frames = 0;
+static bool gui_wakeup_pending = false;
+static int32_t gui_bench_wakeup_frame = -1;
 static volatile bool first_run = true;
+static int32_t gui_bench_lv_task_handler = -1;
 
 bool gui_touch_event_cb( EventBits_t event, void *arg );
 bool gui_powermgm_event_cb( EventBits_t event, void *arg );
+static void gui_start_wakeup_frame( void );
 bool gui_powermgm_loop_event_cb( EventBits_t event, void *arg );
 
+LV_FONT_DECLARE(Ubuntu_16px);
+LV_FONT_DECLARE(Ubuntu_32px);
+LV_FONT_DECLARE(Ubuntu_48px);
+LV_FONT_DECLARE(Ubuntu_72px);
+
 void gui_setup( void )
 {
+    /*
+     * cache the decompressed glyphs of the often redrawn fonts
+     */
+    glyph_cache_register( &Ubuntu_16px, "Ubuntu_16px" );
+    glyph_cache_register( &Ubuntu_32px, "Ubuntu_32px" );
+    glyph_cache_register( &Ubuntu_48px, "Ubuntu_48px" );
+    glyph_cache_register( &Ubuntu_72px, "Ubuntu_72px" );
     /*
      * Create an blank wallpaper
      */
@@ -102,6 +129,11 @@ void gui_setup( void )
      * trigger an activity
      */
     lv_disp_trig_activity( NULL );
+    /*
+     * register lv_task_handler benchmark
+     */
+    gui_bench_lv_task_handler = bench_register( "lv_task_handler", GUI_TASK_HANDLER_BUDGET_US );
+    gui_bench_wakeup_frame = bench_register( "wakeup first frame", BENCH_NO_BUDGET );
     /*
      * setup background image
      */
@@ -144,6 +176,7 @@ bool gui_powermgm_event_cb( EventBits_t event, void *arg ) {
                                         ttgo->startLvglTick();
                                         lv_disp_trig_activity( NULL );
                                         interact = false;
+                                        gui_start_wakeup_frame();
                                         break;
         case POWERMGM_SILENCE_WAKEUP:   /*
                                          * resume all LVGL activitys and tasks
@@ -151,6 +184,7 @@ bool gui_powermgm_event_cb( EventBits_t event, void *arg ) {
                                         log_i("go silence wakeup");
                                         ttgo->startLvglTick();
                                         lv_disp_trig_activity( NULL );
+                                        gui_start_wakeup_frame();
                                         break;
         case POWERMGM_DISABLE_INTERRUPTS:
                                         /*
@@ -175,35 +209,60 @@ void gui_set_background_image ( uint32_t background_image ) {
             lv_img_set_src( img_bin, &bg );
             lv_obj_align( img_bin, NULL, LV_ALIGN_CENTER, 0, 0 );
             lv_obj_set_hidden( img_bin, false );
+            background_release();
             break;
         case 1:
             LV_IMG_DECLARE( bg1 );
             lv_img_set_src( img_bin, &bg1 );
             lv_obj_align( img_bin, NULL, LV_ALIGN_CENTER, 0, 0 );
             lv_obj_set_hidden( img_bin, false );
+            background_release();
             break;
         case 2:
             LV_IMG_DECLARE( bg2 );
             lv_img_set_src( img_bin, &bg2 );
             lv_obj_align( img_bin, NULL, LV_ALIGN_CENTER, 0, 0 );
             lv_obj_set_hidden( img_bin, false );
+            background_release();
             break;
         case 3:
             LV_IMG_DECLARE( bg3 );
             lv_img_set_src( img_bin, &bg3 );
             lv_obj_align( img_bin, NULL, LV_ALIGN_CENTER, 0, 0 );
             lv_obj_set_hidden( img_bin, false );
+            background_release();
             break;
         case 4:
             lv_obj_set_hidden( img_bin, true );
+            background_release();
             break;
         case 5:
             FILE* file;
+            const lv_img_dsc_t *baked;
+            /*
+             * prefer the pre-baked native image, bake it once if missing or outdated
+             */
+            baked = background_load( BACKGROUNDIMAGE_BIN, BACKGROUNDIMAGE );
+            if ( !baked && background_bake( BACKGROUNDIMAGE, BACKGROUNDIMAGE_BIN ) ) {
+                baked = background_load( BACKGROUNDIMAGE_BIN, BACKGROUNDIMAGE );
+            }
+            if ( baked ) {
+                log_i("set pre-baked custom background image from spiffs");
+                lv_img_set_src( img_bin, baked );
+                lv_obj_align( img_bin, NULL, LV_ALIGN_CENTER, 0, 0 );
+                lv_obj_set_hidden( img_bin, false );
+                break;
+            }
+
             file = fopen( BACKGROUNDIMAGE, "rb" );
 
             if ( file ) {
                 log_i("set custom background image from spiffs");
                 fclose( file );
+                /*
+                 * reopen the file, the image cache only decodes it again if it has changed
+                 */
+                lv_img_cache_invalidate_src( BACKGROUNDIMAGE );
                 lv_img_set_src( img_bin, BACKGROUNDIMAGE );
                 lv_obj_align( img_bin, NULL, LV_ALIGN_CENTER, 0, 0 );
                 lv_obj_set_hidden( img_bin, false );
@@ -212,12 +271,92 @@ void gui_set_background_image ( uint32_t background_image ) {
                 log_i("not custom background image found on spiffs, set to black");
                 lv_obj_set_hidden( img_bin, true );
             }
+            background_release();
             break;
         default:
             lv_obj_set_hidden( img_bin, true ); 
+            background_release();
     }
 }
 
+/**
+ * @brief remember the wakeup time, the first flushed frame after it is measured
+ */
+static void gui_start_wakeup_frame( void ) {
+    framebuffer_stats_t stats;
+
+    framebuffer_get_stats( &stats );
+    gui_wakeup_frames = stats.frames;
+    gui_wakeup_us = esp_timer_get_time();
+    gui_wakeup_pending = true;
+}
+
+/**
+ * @brief add the wakeup to first frame latency once a frame is refreshed
+ */
+static void gui_check_wakeup_frame( void ) {
+    framebuffer_stats_t stats;
+
+    if ( !gui_wakeup_pending ) {
+        return;
+    }
+    framebuffer_get_stats( &stats );
+    if ( stats.frames != gui_wakeup_frames ) {
+        gui_wakeup_pending = false;
+        bench_add( gui_bench_wakeup_frame, esp_timer_get_time() - gui_wakeup_us );
+        /*
+         * the first frame after setup is the end of the boot
+         */
+        boot_profiler_finish();
+    }
+}
+
+/**
+ * @brief check if a lvgl refresh or input read task has nothing to do. lvgl runs
+ * them every LV_DISP_DEF_REFR_PERIOD even if nothing is invalid or pressed, the
+ * anim task is switched off by lvgl itself when no animation is running
+ */
+static bool gui_task_is_idle( lv_task_t *task ) {
+    lv_disp_t *disp = lv_disp_get_default();
+
+    if ( disp && task == disp->refr_task ) {
+        return( disp->inv_p == 0 );
+    }
+    lv_indev_t *indev = lv_indev_get_next( NULL );
+    while( indev ) {
+        if ( task == indev->driver.read_task ) {
+            return( indev->proc.state == LV_INDEV_STATE_REL );
+        }
+        indev = lv_indev_get_next( indev );
+    }
+    return( false );
+}
+
+/**
+ * @brief get the time in ms until the next lv_task is ready to run. idle refresh
+ * and input read tasks only count when they are due, an invalidation in a lv_task
+ * or a new touch sample with lv_task_ready() brings them back in the next loop
+ */
+static uint32_t gui_get_next_task_deadline( void ) {
+    uint32_t deadline = SCHEDULER_MAX_SLEEP;
+
+    lv_task_t *task = (lv_task_t *)_lv_ll_get_head( &LV_GC_ROOT( _lv_task_ll ) );
+    while( task ) {
+        if ( task->prio != LV_TASK_PRIO_OFF ) {
+            uint32_t elapsed = lv_tick_elaps( task->last_run );
+            uint32_t remaining = elapsed >= task->period ? 0 : task->period - elapsed;
+            if ( remaining > 0 && gui_task_is_idle( task ) ) {
+                remaining = deadline;
+            }
+            if ( remaining < deadline ) {
+                deadline = remaining;
+            }
+        }
+        task = (lv_task_t *)_lv_ll_get_next( &LV_GC_ROOT( _lv_task_ll ), task );
+    }
+    return( deadline );
+}
+
 bool gui_powermgm_loop_event_cb( EventBits_t event, void *arg ) {
     uint32_t timeout = 0;
     
@@ -228,6 +367,7 @@ bool gui_powermgm_loop_event_cb( EventBits_t event, void *arg ) {
                                         if ( first_run ) {
                                             first_run = false;
                                             interact = true;
+                                            gui_start_wakeup_frame();
                                             log_i("set normal timeout on first run");
                                         }
                                         /**
@@ -242,7 +382,10 @@ bool gui_powermgm_loop_event_cb( EventBits_t event, void *arg ) {
                                         }
 
                                         if ( lv_disp_get_inactive_time( NULL ) < timeout  || display_get_timeout() == DISPLAY_MAX_TIMEOUT ) {
+                                            uint64_t bench_start = bench_begin( gui_bench_lv_task_handler );
                                             lv_task_handler();
+                                            bench_end( gui_bench_lv_task_handler, bench_start );
+                                            gui_check_wakeup_frame();
                                         }
                                         else {
                                             powermgm_set_event( POWERMGM_STANDBY_REQUEST );
@@ -250,12 +393,19 @@ bool gui_powermgm_loop_event_cb( EventBits_t event, void *arg ) {
 
                                         break;
         case POWERMGM_SILENCE_WAKEUP:   if ( lv_disp_get_inactive_time( NULL ) < display_get_timeout() * 1000 ) {
+                                            uint64_t bench_start = bench_begin( gui_bench_lv_task_handler );
                                             lv_task_handler();
+                                            bench_end( gui_bench_lv_task_handler, bench_start );
+                                            gui_check_wakeup_frame();
                                         }
                                         else {
                                             powermgm_set_event( POWERMGM_STANDBY_REQUEST );
                                         }
                                         break;
     }
+    /**
+     * sleep until the next lv_task is ready
+     */
+    scheduler_set_deadline( gui_get_next_task_deadline() );
     return( true );
 }
@@ -26,6 +26,8 @@
     #include <TTGO.h>
     
     #define BACKGROUNDIMAGE    "/spiffs/bg.png"
+    #define BACKGROUNDIMAGE_BIN "/spiffs/bg.bin"     /** @brief pre-baked BACKGROUNDIMAGE in the native color format */
+    #define GUI_TASK_HANDLER_BUDGET_US      15000   /** @brief max average lv_task_handler runtime in us before an regression is reported */
 
     /**
      * @brief GUI setup
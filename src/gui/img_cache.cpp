@@ -0,0 +1,231 @@
+/****************************************************************************
+ *   Oct 18 15:12:40 2026
+ *   Copyright  2026  My-TTGO-Watch contributors
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#include "config.h"
+#include <sys/stat.h>
+
+#include "img_cache.h"
+#include "utils/alloc.h"
+
+/**
+ * @brief one decoded image or frame
+ */
+typedef struct {
+    char path[ IMG_CACHE_PATH_SIZE ];   /** @brief file path, empty for variable sources */
+    const void *src;                    /** @brief lv_img_dsc_t pointer for variable sources */
+    uint32_t frame;                     /** @brief frame number */
+    time_t mtime;                       /** @brief file modification time */
+    off_t file_size;                    /** @brief file size */
+    uint8_t *data;                      /** @brief decoded data, NULL for a free entry */
+    uint32_t size;                      /** @brief decoded size in bytes */
+    uint32_t decode_us;                 /** @brief decode time */
+    uint32_t refs;                      /** @brief open references */
+    uint32_t used;                      /** @brief lru counter of the last use */
+} img_cache_entry_t;
+
+static img_cache_entry_t img_cache[ IMG_CACHE_ENTRYS ];
+static img_cache_stats_t img_cache_stats;
+static uint32_t img_cache_counter = 0;
+
+/**
+ * @brief get the file system path of a LVGL file source, LVGL paths can
+ * start with a drive letter like "S:/spiffs/bg.sjpg"
+ */
+static const char *img_cache_fs_path( const char *path ) {
+    if ( path[ 0 ] >= 'A' && path[ 0 ] <= 'Z' && path[ 1 ] == ':' ) {
+        return( &path[ 2 ] );
+    }
+    return( path );
+}
+
+/**
+ * @brief get mtime and size of a file, both are 0 if the file is unknown.
+ * entrys of unknown files are only keyed on the source string
+ */
+static void img_cache_stat( lv_img_src_t src_type, const void *src, time_t *mtime, off_t *file_size ) {
+    struct stat info;
+
+    *mtime = 0;
+    *file_size = 0;
+    if ( src_type == LV_IMG_SRC_FILE && stat( img_cache_fs_path( (const char *)src ), &info ) == 0 ) {
+        *mtime = info.st_mtime;
+        *file_size = info.st_size;
+    }
+}
+
+static bool img_cache_match( img_cache_entry_t *entry, lv_img_src_t src_type, const void *src, uint32_t frame ) {
+    if ( entry->data == NULL || entry->frame != frame ) {
+        return( false );
+    }
+    if ( src_type == LV_IMG_SRC_FILE ) {
+        return( entry->src == NULL && !strcmp( entry->path, (const char *)src ) );
+    }
+    return( entry->src == src );
+}
+
+static void img_cache_drop( img_cache_entry_t *entry ) {
+    free( entry->data );
+    img_cache_stats.bytes -= entry->size;
+    img_cache_stats.entrys--;
+    entry->data = NULL;
+}
+
+/**
+ * @brief find the valid entry of an image or frame, entrys of a changed file are dropped
+ *
+ * @return  pointer to the entry or NULL if not cached
+ */
+static img_cache_entry_t *img_cache_find( lv_img_src_t src_type, const void *src, uint32_t frame ) {
+    time_t mtime;
+    off_t file_size;
+
+    if ( src_type != LV_IMG_SRC_FILE && src_type != LV_IMG_SRC_VARIABLE ) {
+        return( NULL );
+    }
+    img_cache_stat( src_type, src, &mtime, &file_size );
+
+    for( int32_t i = 0 ; i < IMG_CACHE_ENTRYS ; i++ ) {
+        img_cache_entry_t *entry = &img_cache[ i ];
+        if ( !img_cache_match( entry, src_type, src, frame ) ) {
+            continue;
+        }
+        /*
+         * a changed file is dropped as soon as nobody use the old content
+         */
+        if ( entry->mtime != mtime || entry->file_size != file_size ) {
+            if ( entry->refs == 0 ) {
+                img_cache_drop( entry );
+            }
+            continue;
+        }
+        return( entry );
+    }
+    return( NULL );
+}
+
+const uint8_t *img_cache_get( lv_img_src_t src_type, const void *src, uint32_t frame ) {
+    img_cache_entry_t *entry = img_cache_find( src_type, src, frame );
+
+    if ( entry == NULL ) {
+        img_cache_stats.misses++;
+        return( NULL );
+    }
+    entry->refs++;
+    entry->used = ++img_cache_counter;
+    img_cache_stats.hits++;
+    img_cache_stats.saved_us += entry->decode_us;
+    return( entry->data );
+}
+
+bool img_cache_contains( lv_img_src_t src_type, const void *src, uint32_t frame ) {
+    return( img_cache_find( src_type, src, frame ) != NULL );
+}
+
+bool img_cache_put( lv_img_src_t src_type, const void *src, uint32_t frame, uint8_t *data, uint32_t size, uint32_t decode_us ) {
+    img_cache_entry_t *entry = NULL;
+
+    img_cache_stats.decode_us += decode_us;
+
+    if ( src_type != LV_IMG_SRC_FILE && src_type != LV_IMG_SRC_VARIABLE ) {
+        return( false );
+    }
+    if ( size > IMG_CACHE_SIZE || ( src_type == LV_IMG_SRC_FILE && strlen( (const char *)src ) >= IMG_CACHE_PATH_SIZE ) ) {
+        img_cache_stats.rejected++;
+        return( false );
+    }
+    /*
+     * evict the least recently used unreferenced entrys until the data fits
+     */
+    while( true ) {
+        img_cache_entry_t *oldest = NULL;
+        entry = NULL;
+
+        for( int32_t i = 0 ; i < IMG_CACHE_ENTRYS ; i++ ) {
+            img_cache_entry_t *cache_entry = &img_cache[ i ];
+            if ( cache_entry->data == NULL ) {
+                entry = cache_entry;
+            }
+            else if ( cache_entry->refs == 0 && ( oldest == NULL || cache_entry->used < oldest->used ) ) {
+                oldest = cache_entry;
+            }
+        }
+        if ( entry && img_cache_stats.bytes + size <= IMG_CACHE_SIZE ) {
+            break;
+        }
+        if ( oldest == NULL ) {
+            img_cache_stats.rejected++;
+            return( false );
+        }
+        img_cache_drop( oldest );
+        img_cache_stats.evictions++;
+    }
+
+    if ( src_type == LV_IMG_SRC_FILE ) {
+        strlcpy( entry->path, (const char *)src, sizeof( entry->path ) );
+        entry->src = NULL;
+    }
+    else {
+        entry->path[ 0 ] = '\0';
+        entry->src = src;
+    }
+    img_cache_stat( src_type, src, &entry->mtime, &entry->file_size );
+    entry->frame = frame;
+    entry->data = data;
+    entry->size = size;
+    entry->decode_us = decode_us;
+    entry->refs = 1;
+    entry->used = ++img_cache_counter;
+    img_cache_stats.bytes += size;
+    img_cache_stats.entrys++;
+    return( true );
+}
+
+bool img_cache_release( const uint8_t *data ) {
+    if ( data == NULL ) {
+        return( false );
+    }
+    for( int32_t i = 0 ; i < IMG_CACHE_ENTRYS ; i++ ) {
+        img_cache_entry_t *entry = &img_cache[ i ];
+        if ( entry->data == data ) {
+            if ( entry->refs ) {
+                entry->refs--;
+            }
+            return( true );
+        }
+    }
+    return( false );
+}
+
+void img_cache_invalidate( const char *path ) {
+    /*
+     * LVGL's cache holds references, close them first
+     */
+    lv_img_cache_invalidate_src( path );
+    for( int32_t i = 0 ; i < IMG_CACHE_ENTRYS ; i++ ) {
+        img_cache_entry_t *entry = &img_cache[ i ];
+        if ( entry->data && entry->refs == 0 && ( path == NULL || ( entry->src == NULL && !strcmp( img_cache_fs_path( entry->path ), img_cache_fs_path( path ) ) ) ) ) {
+            img_cache_drop( entry );
+        }
+    }
+}
+
+void img_cache_get_stats( img_cache_stats_t *stats ) {
+    *stats = img_cache_stats;
+}
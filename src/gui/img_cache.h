@@ -0,0 +1,115 @@
+/****************************************************************************
+ *   Oct 18 15:12:40 2026
+ *   Copyright  2026  My-TTGO-Watch contributors
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#ifndef _IMG_CACHE_H
+    #define _IMG_CACHE_H
+
+    #include "lvgl/lvgl.h"
+
+    #define IMG_CACHE_ENTRYS        32                  /** @brief max number of cached images or frames */
+    #define IMG_CACHE_PATH_SIZE     48                  /** @brief max path length incl. \0 */
+    #define IMG_CACHE_LV_ENTRYS     16                  /** @brief LVGL image cache size, decoded data is bounded by the image cache */
+    #if defined( BOARD_HAS_PSRAM )
+        #define IMG_CACHE_SIZE      ( 512 * 1024 )      /** @brief max decoded bytes in the cache */
+    #else
+        #define IMG_CACHE_SIZE      ( 64 * 1024 )       /** @brief max decoded bytes in the cache */
+    #endif
+
+    /**
+     * @brief image cache statistic
+     */
+    typedef struct {
+        uint32_t hits;                  /** @brief lookups with a valid entry */
+        uint32_t misses;                /** @brief lookups without a valid entry */
+        uint32_t evictions;             /** @brief entrys dropped to make room */
+        uint32_t rejected;              /** @brief decoded images that did not fit */
+        uint32_t entrys;                /** @brief current number of entrys */
+        uint32_t bytes;                 /** @brief current decoded bytes */
+        uint64_t decode_us;             /** @brief time spent in decoding on misses */
+        uint64_t saved_us;              /** @brief decode time saved by hits */
+    } img_cache_stats_t;
+
+    #ifdef __cplusplus
+    extern "C" {
+    #endif
+
+    /**
+     * @brief get a decoded image or frame from the cache, a file is only found if
+     * its mtime and size are unchanged. each hit must be released with img_cache_release
+     *
+     * @param   src_type    LV_IMG_SRC_FILE or LV_IMG_SRC_VARIABLE
+     * @param   src         file path or pointer to the lv_img_dsc_t
+     * @param   frame       frame number, 0 for single frame images
+     *
+     * @return  pointer to the decoded data in native color format or NULL if not cached
+     */
+    const uint8_t *img_cache_get( lv_img_src_t src_type, const void *src, uint32_t frame );
+    /**
+     * @brief check if an image or frame is cached, for prefetching. no reference
+     * is taken and the lookup is not counted as hit or miss
+     *
+     * @param   src_type    LV_IMG_SRC_FILE or LV_IMG_SRC_VARIABLE
+     * @param   src         file path or pointer to the lv_img_dsc_t
+     * @param   frame       frame number, 0 for single frame images
+     *
+     * @return  true if cached
+     */
+    bool img_cache_contains( lv_img_src_t src_type, const void *src, uint32_t frame );
+    /**
+     * @brief add a decoded image or frame, least recently used unreferenced entrys
+     * are evicted until it fits
+     *
+     * @param   src_type    LV_IMG_SRC_FILE or LV_IMG_SRC_VARIABLE
+     * @param   src         file path or pointer to the lv_img_dsc_t
+     * @param   frame       frame number, 0 for single frame images
+     * @param   data        decoded data allocated with MALLOC
+     * @param   size        size of the decoded data in bytes
+     * @param   decode_us   time it took to decode
+     *
+     * @return  true if the cache owns the data now and it must be released with
+     *          img_cache_release, false if the caller still owns the data
+     */
+    bool img_cache_put( lv_img_src_t src_type, const void *src, uint32_t frame, uint8_t *data, uint32_t size, uint32_t decode_us );
+    /**
+     * @brief release a reference from img_cache_get or img_cache_put
+     *
+     * @param   data        pointer to the decoded data
+     *
+     * @return  true if the data is owned by the cache, false if not
+     */
+    bool img_cache_release( const uint8_t *data );
+    /**
+     * @brief drop all unreferenced entrys of a file, call if a file is changed
+     *
+     * @param   path        file path with or without LVGL drive letter or NULL for all entrys
+     */
+    void img_cache_invalidate( const char *path );
+    /**
+     * @brief get the image cache statistic
+     *
+     * @param   stats       pointer to a img_cache_stats_t structure
+     */
+    void img_cache_get_stats( img_cache_stats_t *stats );
+
+    #ifdef __cplusplus
+    }
+    #endif
+
+#endif // _IMG_CACHE_H
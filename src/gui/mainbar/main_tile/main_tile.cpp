@@ -21,6 +21,7 @@
  */
 #include <stdio.h>
 #include <time.h>
+#include <sys/time.h>
 
 #include "config.h"
 #include "main_tile.h"
@@ -56,6 +57,7 @@ lv_task_t * main_tile_task;
 void main_tile_update_task( lv_task_t * task );
 void main_tile_align_widgets( void );
 void main_tile_format_time( char *, size_t, struct tm * );
+static void main_tile_schedule_update( void );
 bool main_tile_powermgm_event_cb( EventBits_t event, void *arg );
 bool main_tile_time_update_ebent_cb( EventBits_t event, void *arg );
 
@@ -130,7 +132,8 @@ void main_tile_setup( void ) {
         lv_obj_set_hidden( widget_entry[ widget ].ext_label, true );
     }
 
-    main_tile_task = lv_task_create( main_tile_update_task, 500, LV_TASK_PRIO_MID, NULL );
+    main_tile_task = lv_task_create( main_tile_update_task, 1000, LV_TASK_PRIO_MID, NULL );
+    main_tile_schedule_update();
 
     powermgm_register_cb( POWERMGM_WAKEUP , main_tile_powermgm_event_cb, "main tile time update" );
     timesync_register_cb( TIME_SYNC_UPDATE, main_tile_time_update_ebent_cb, "main tile time sync" );
@@ -303,6 +306,22 @@ void main_tile_update_time( bool force ) {
          */
         last = now;
     }
+    main_tile_schedule_update();
+}
+
+/**
+ * @brief run the update task again shortly after the next full minute
+ */
+static void main_tile_schedule_update( void ) {
+    struct timeval now;
+
+    if ( main_tile_task == NULL ) {
+        return;
+    }
+    gettimeofday( &now, NULL );
+    uint32_t next = ( 60 - now.tv_sec % 60 ) * 1000 - now.tv_usec / 1000 + MAIN_TILE_UPDATE_MARGIN;
+    lv_task_set_period( main_tile_task, next );
+    lv_task_reset( main_tile_task );
 }
 
 void main_tile_update_task( lv_task_t * task ) {
@@ -31,6 +31,8 @@
     #define WIDGET_LABEL_Y_SIZE 16
     #define WIDGET_X_CLEARENCE  16
 
+    #define MAIN_TILE_UPDATE_MARGIN     50      /** @brief time in ms after a full minute until the time is updated */
+
     /**
      * @brief setup the app tile
      */
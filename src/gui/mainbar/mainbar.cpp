@@ -20,9 +20,11 @@
  *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
  */
 #include <stdio.h>
+#include "esp_timer.h"
 #include "config.h"
 
 #include "mainbar.h"
+#include "tile_index.h"
 #include "main_tile/main_tile.h"
 #include "setup_tile/setup_tile.h"
 #include "note_tile/note_tile.h"
@@ -32,6 +34,8 @@
 #include "gui/widget_styles.h"
 
 #include "utils/alloc.h"
+#include "utils/bench.h"
+#include "utils/boot_profiler.h"
 
 #include "setup_tile/battery_settings/battery_settings.h"
 #include "setup_tile/wlan_settings/wlan_settings.h"
@@ -47,6 +51,15 @@ static lv_point_t *tile_pos_table = NULL;
 static uint32_t current_tile = 0;
 static uint32_t tile_entrys = 0;
 static uint32_t app_tile_pos = MAINBAR_APP_TILE_X_START;
+static uint32_t tile_capacity = 0;
+static tile_index_pos_slot_t *tile_pos_slots = NULL;
+static tile_index_id_slot_t *tile_id_slots = NULL;
+static tile_index_t tile_index = { NULL, NULL, 0, 0 };
+static int32_t mainbar_bench_tile_setup = -1;
+static int32_t mainbar_bench_add_tile = -1;
+static int32_t mainbar_bench_jump = -1;
+
+static void mainbar_run_tile_setup_cb( uint32_t tile_number );
 
 void mainbar_setup( void ) {
     /*
@@ -61,6 +74,62 @@ void mainbar_setup( void ) {
     lv_tileview_set_edge_flash( mainbar, false);
     lv_obj_add_style( mainbar, LV_OBJ_PART_MAIN, ws_get_mainbar_style() );
     lv_page_set_scrlbar_mode( mainbar, LV_SCRLBAR_MODE_OFF);
+
+    mainbar_bench_tile_setup = bench_register( "lazy tile setup", BENCH_NO_BUDGET );
+    mainbar_bench_add_tile = bench_register( "mainbar add tile", BENCH_NO_BUDGET );
+    mainbar_bench_jump = bench_register( "mainbar jump", BENCH_NO_BUDGET );
+}
+
+/**
+ * @brief make room for the given number of tiles, the tables grow by
+ * MAINBAR_TILE_GROWTH and the index is rebuild
+ */
+static void mainbar_reserve_tiles( uint32_t entrys ) {
+    if ( entrys <= tile_capacity ) {
+        return;
+    }
+    uint32_t capacity = tile_capacity ? tile_capacity * MAINBAR_TILE_GROWTH : MAINBAR_TILE_RESERVE;
+    while( capacity < entrys ) {
+        capacity *= MAINBAR_TILE_GROWTH;
+    }
+    uint32_t index_size = tile_index_slots( capacity );
+
+    lv_point_t *new_tile_pos_table = ( lv_point_t * )REALLOC( tile_pos_table, sizeof( lv_point_t ) * capacity );
+    if ( new_tile_pos_table == NULL ) {
+        log_e("tile_pos_table realloc faild");
+        while(true);
+    }
+    tile_pos_table = new_tile_pos_table;
+
+    lv_tile_t *new_tile = ( lv_tile_t * )REALLOC( tile, sizeof( lv_tile_t ) * capacity );
+    if ( new_tile == NULL ) {
+        log_e("tile realloc faild");
+        while(true);
+    }
+    tile = new_tile;
+
+    tile_index_pos_slot_t *new_pos_slots = ( tile_index_pos_slot_t * )REALLOC( tile_pos_slots, sizeof( tile_index_pos_slot_t ) * index_size );
+    if ( new_pos_slots == NULL ) {
+        log_e("tile index realloc faild");
+        while(true);
+    }
+    tile_pos_slots = new_pos_slots;
+
+    tile_index_id_slot_t *new_id_slots = ( tile_index_id_slot_t * )REALLOC( tile_id_slots, sizeof( tile_index_id_slot_t ) * index_size );
+    if ( new_id_slots == NULL ) {
+        log_e("tile index realloc faild");
+        while(true);
+    }
+    tile_id_slots = new_id_slots;
+    tile_capacity = capacity;
+    /*
+     * rebuild the index in tile order, so the first tile with a position or id still wins
+     */
+    tile_index_init( &tile_index, tile_pos_slots, tile_id_slots, index_size );
+    for ( uint32_t i = 0 ; i < tile_entrys ; i++ ) {
+        tile_index_add( &tile_index, tile[ i ].x, tile[ i ].y, tile[ i ].id, i );
+    }
+    log_d("tile capacity %d, index size %d", tile_capacity, index_size );
 }
 
 uint32_t mainbar_add_tile( uint16_t x, uint16_t y, const char *id ) {
@@ -72,39 +141,10 @@ uint32_t mainbar_add_tile( uint16_t x, uint16_t y, const char *id ) {
         while( true );
     }
 
+    uint64_t bench_start = bench_begin( mainbar_bench_add_tile );
+    mainbar_reserve_tiles( tile_entrys + 1 );
     tile_entrys++;
 
-    if ( tile_pos_table == NULL ) {
-        tile_pos_table = ( lv_point_t * )MALLOC( sizeof( lv_point_t ) * tile_entrys );
-        if ( tile_pos_table == NULL ) {
-            log_e("tile_pos_table malloc faild");
-            while(true);
-        }
-        tile = ( lv_tile_t * )MALLOC( sizeof( lv_tile_t ) * tile_entrys );
-        if ( tile == NULL ) {
-            log_e("tile malloc faild");
-            while(true);
-        }
-    }
-    else {
-        lv_point_t *new_tile_pos_table;
-        lv_tile_t *new_tile;
-
-        new_tile_pos_table = ( lv_point_t * )REALLOC( tile_pos_table, sizeof( lv_point_t ) * tile_entrys );
-        if ( new_tile_pos_table == NULL ) {
-            log_e("tile_pos_table realloc faild");
-            while(true);
-        }
-        tile_pos_table = new_tile_pos_table;
-        
-        new_tile = ( lv_tile_t * )REALLOC( tile, sizeof( lv_tile_t ) * tile_entrys );
-        if ( new_tile == NULL ) {
-            log_e("tile realloc faild");
-            while(true);
-        }
-        tile = new_tile;
-    }
-
     tile_pos_table[ tile_entrys - 1 ].x = x;
     tile_pos_table[ tile_entrys - 1 ].y = y;
 
@@ -112,9 +152,18 @@ uint32_t mainbar_add_tile( uint16_t x, uint16_t y, const char *id ) {
     tile[ tile_entrys - 1 ].tile = my_tile;
     tile[ tile_entrys - 1 ].activate_cb = NULL;
     tile[ tile_entrys - 1 ].hibernate_cb = NULL;
+    tile[ tile_entrys - 1 ].setup_cb = NULL;
     tile[ tile_entrys - 1 ].x = x;
     tile[ tile_entrys - 1 ].y = y;
     tile[ tile_entrys - 1 ].id = id;
+    tile[ tile_entrys - 1 ].activations = 0;
+    tile[ tile_entrys - 1 ].activate_us = 0;
+    tile[ tile_entrys - 1 ].activate_max_us = 0;
+    tile[ tile_entrys - 1 ].hibernate_us = 0;
+    tile[ tile_entrys - 1 ].hibernate_max_us = 0;
+    if ( !tile_index_add( &tile_index, x, y, id, tile_entrys - 1 ) ) {
+        log_w("tile %s at x=%d, y=%d overlaps tile %d", id, x, y, mainbar_get_tile_by_pos( x, y ) );
+    }
     lv_obj_set_size( tile[ tile_entrys - 1 ].tile, lv_disp_get_hor_res( NULL ), LV_VER_RES);
     //lv_obj_reset_style_list( tile[ tile_entrys - 1 ].tile, LV_OBJ_PART_MAIN );
     lv_obj_add_style( tile[ tile_entrys - 1 ].tile, LV_OBJ_PART_MAIN, ws_get_mainbar_style() );
@@ -122,10 +171,36 @@ uint32_t mainbar_add_tile( uint16_t x, uint16_t y, const char *id ) {
     lv_tileview_add_element( mainbar, tile[ tile_entrys - 1 ].tile );
     lv_tileview_set_valid_positions( mainbar, tile_pos_table, tile_entrys );
     log_d("add tile: x=%d, y=%d, id=%s", tile_pos_table[ tile_entrys - 1 ].x, tile_pos_table[ tile_entrys - 1 ].y, tile[ tile_entrys - 1 ].id );
+    bench_end( mainbar_bench_add_tile, bench_start );
+    boot_profiler_mark( id );
 
     return( tile_entrys - 1 );
 }
 
+uint32_t mainbar_get_tile_by_pos( uint16_t x, uint16_t y ) {
+    int32_t tile_number = tile_index_get_pos( &tile_index, x, y );
+
+    return( tile_number == TILE_INDEX_FREE ? MAINBAR_NO_TILE : tile_number );
+}
+
+uint32_t mainbar_get_tile_by_id( const char *id ) {
+    int32_t tile_number = tile_index_get_id( &tile_index, id );
+
+    return( tile_number == TILE_INDEX_FREE ? MAINBAR_NO_TILE : tile_number );
+}
+
+uint32_t mainbar_get_tile_entrys( void ) {
+    return( tile_entrys );
+}
+
+bool mainbar_get_tile( uint32_t tile_number, lv_tile_t *tile_info ) {
+    if ( tile_number < tile_entrys ) {
+        *tile_info = tile[ tile_number ];
+        return( true );
+    }
+    return( false );
+}
+
 bool mainbar_add_tile_hibernate_cb( uint32_t tile_number, MAINBAR_CALLBACK_FUNC hibernate_cb ) {
     /*
      * check if mainbar already initialized
@@ -164,6 +239,68 @@ bool mainbar_add_tile_activate_cb( uint32_t tile_number, MAINBAR_CALLBACK_FUNC a
     }
 }
 
+bool mainbar_add_tile_setup_cb( uint32_t tile_number, MAINBAR_CALLBACK_FUNC setup_cb ) {
+    /*
+     * check if mainbar already initialized
+     */
+    if ( !mainbar ) {
+        log_e("main not initialized");
+        while( true );
+    }
+
+    if ( tile_number < tile_entrys ) {
+        tile[ tile_number ].setup_cb = setup_cb;
+        return( true );
+    }
+    else {
+        log_e("tile number %d do not exist", tile_number );
+        return( false );
+    }
+}
+
+/**
+ * @brief call the setup callback of a tile once, all tiles with the same
+ * setup callback are marked as done
+ */
+static void mainbar_run_tile_setup_cb( uint32_t tile_number ) {
+    MAINBAR_CALLBACK_FUNC setup_cb = tile[ tile_number ].setup_cb;
+
+    if ( setup_cb == NULL ) {
+        return;
+    }
+    for ( uint32_t i = 0 ; i < tile_entrys ; i++ ) {
+        if ( tile[ i ].setup_cb == setup_cb ) {
+            tile[ i ].setup_cb = NULL;
+        }
+    }
+    log_d("call setup cb for tile: %d", tile_number );
+    uint64_t bench_start = bench_begin( mainbar_bench_tile_setup );
+    setup_cb();
+    bench_end( mainbar_bench_tile_setup, bench_start );
+}
+
+void mainbar_build_tiles( void ) {
+#ifndef ENABLE_LAZY_APP_SETUP
+    for ( uint32_t i = 0 ; i < tile_entrys ; i++ ) {
+        mainbar_run_tile_setup_cb( i );
+    }
+#endif
+}
+
+/**
+ * @brief check if a x * y app tile area at the next app tile position is free
+ */
+static bool mainbar_app_tile_area_free( uint16_t x, uint16_t y ) {
+    for ( int hor = 0 ; hor < x ; hor++ ) {
+        for ( int ver = 0 ; ver < y ; ver++ ) {
+            if ( mainbar_get_tile_by_pos( hor + app_tile_pos, ver + MAINBAR_APP_TILE_Y_START ) != MAINBAR_NO_TILE ) {
+                return( false );
+            }
+        }
+    }
+    return( true );
+}
+
 uint32_t mainbar_add_app_tile( uint16_t x, uint16_t y, const char *id ) {
     /*
      * check if mainbar already initialized
@@ -174,6 +311,13 @@ uint32_t mainbar_add_app_tile( uint16_t x, uint16_t y, const char *id ) {
     }
 
     uint32_t retval = -1;
+    /*
+     * skip app tile columns that are already in use
+     */
+    while( !mainbar_app_tile_area_free( x, y ) ) {
+        log_w("app tile column %d already in use", app_tile_pos );
+        app_tile_pos++;
+    }
 
     for ( int hor = 0 ; hor < x ; hor++ ) {
         for ( int ver = 0 ; ver < y ; ver++ ) {
@@ -227,6 +371,19 @@ void mainbar_jump_to_maintile( lv_anim_enable_t anim ) {
     }
 }
 
+/**
+ * @brief store the last and max runtime of a tile callback
+ */
+static void mainbar_tile_time( const char *id, uint32_t *last_us, uint32_t *max_us, int64_t start ) {
+    *last_us = esp_timer_get_time() - start;
+    if ( *last_us > *max_us ) {
+        *max_us = *last_us;
+    }
+    if ( *last_us > MAINBAR_TILE_CB_BUDGET_US ) {
+        log_w("slow tile callback for %s: %dus", id, *last_us );
+    }
+}
+
 void mainbar_jump_to_tilenumber( uint32_t tile_number, lv_anim_enable_t anim ) {
     /*
      * check if mainbar already initialized
@@ -238,18 +395,27 @@ void mainbar_jump_to_tilenumber( uint32_t tile_number, lv_anim_enable_t anim ) {
 
     if ( tile_number < tile_entrys ) {
         log_d("jump to tile %d from tile %d", tile_number, current_tile );
+        uint64_t bench_start = bench_begin( mainbar_bench_jump );
+        // build the tile content on first use
+        mainbar_run_tile_setup_cb( tile_number );
         lv_tileview_set_tile_act( mainbar, tile_pos_table[ tile_number ].x, tile_pos_table[ tile_number ].y, anim );
         // call hibernate callback for the current tile if exist
         if ( tile[ current_tile ].hibernate_cb != NULL ) {
             log_d("call hibernate cb for tile: %d", current_tile );
+            int64_t start = esp_timer_get_time();
             tile[ current_tile ].hibernate_cb();
+            mainbar_tile_time( tile[ current_tile ].id, &tile[ current_tile ].hibernate_us, &tile[ current_tile ].hibernate_max_us, start );
         }
         // call activate callback for the new tile if exist
+        tile[ tile_number ].activations++;
         if ( tile[ tile_number ].activate_cb != NULL ) { 
             log_d("call activate cb for tile: %d", tile_number );
+            int64_t start = esp_timer_get_time();
             tile[ tile_number ].activate_cb();
+            mainbar_tile_time( tile[ tile_number ].id, &tile[ tile_number ].activate_us, &tile[ tile_number ].activate_max_us, start );
         }
         current_tile = tile_number;
+        bench_end( mainbar_bench_jump, bench_start );
     }
     else {
         log_e( "tile number %d do not exist", tile_number );
@@ -30,13 +30,23 @@
         lv_obj_t *tile;
         MAINBAR_CALLBACK_FUNC activate_cb;
         MAINBAR_CALLBACK_FUNC hibernate_cb;
+        MAINBAR_CALLBACK_FUNC setup_cb;
         uint16_t x;
         uint16_t y;
         const char *id;
+        uint32_t activations;           /** @brief number of jumps to the tile */
+        uint32_t activate_us;           /** @brief last activate callback runtime */
+        uint32_t activate_max_us;       /** @brief max activate callback runtime */
+        uint32_t hibernate_us;          /** @brief last hibernate callback runtime */
+        uint32_t hibernate_max_us;      /** @brief max hibernate callback runtime */
     } lv_tile_t;
 
     #define MAINBAR_APP_TILE_X_START     0
     #define MAINBAR_APP_TILE_Y_START     4
+    #define MAINBAR_TILE_RESERVE        48              /** @brief initial tile table capacity */
+    #define MAINBAR_TILE_GROWTH         2               /** @brief tile table growth factor when full */
+    #define MAINBAR_TILE_CB_BUDGET_US   20000           /** @brief activate or hibernate callbacks above this runtime are logged */
+    #define MAINBAR_NO_TILE             ( (uint32_t)-1 )    /** @brief tile lookup failed */
 
     /**
      * @brief mainbar setup funktion
@@ -88,6 +98,39 @@
      * @return  tile number, if get more than 1 tile it is the first tile number
      */
     uint32_t mainbar_add_app_tile( uint16_t x, uint16_t y, const char *id );
+    /**
+     * @brief get the tile number at a tile position
+     *
+     * @param   x   x position
+     * @param   y   y position
+     *
+     * @return  tile number or MAINBAR_NO_TILE if not found
+     */
+    uint32_t mainbar_get_tile_by_pos( uint16_t x, uint16_t y );
+    /**
+     * @brief get the first tile number with a tile id
+     *
+     * @param   id  tile id
+     *
+     * @return  tile number or MAINBAR_NO_TILE if not found
+     */
+    uint32_t mainbar_get_tile_by_id( const char *id );
+    /**
+     * @brief get the number of tiles
+     *
+     * @return  number of tiles
+     */
+    uint32_t mainbar_get_tile_entrys( void );
+    /**
+     * @brief get a copy of a tile with its callback runtimes, the tile table
+     * moves when it grows so no pointer into it is handed out
+     *
+     * @param   tile_number   tile number
+     * @param   tile_info     pointer to the lv_tile_t to fill
+     *
+     * @return  true if the tile exist
+     */
+    bool mainbar_get_tile( uint32_t tile_number, lv_tile_t *tile_info );
     /**
      * @brief get the lv_obj_t for a specific tile number
      *
@@ -114,6 +157,22 @@
      * @return  true or false, true means registration was success
      */
     bool mainbar_add_tile_activate_cb( uint32_t tile_number, MAINBAR_CALLBACK_FUNC activate_cb );
+    /**
+     * @brief register a setup callback function that build the tile content, with
+     * ENABLE_LAZY_APP_SETUP it is called on the first jump to the tile, otherwise from
+     * mainbar_build_tiles. register the same callback on all tiles of an app to build
+     * them together
+     *
+     * @param   tile_number     tile number
+     * @param   setup_cb        pointer to the setup callback function
+     *
+     * @return  true or false, true means registration was success
+     */
+    bool mainbar_add_tile_setup_cb( uint32_t tile_number, MAINBAR_CALLBACK_FUNC setup_cb );
+    /**
+     * @brief call all registered tile setup callbacks, does nothing with ENABLE_LAZY_APP_SETUP
+     */
+    void mainbar_build_tiles( void );
     /**
      * @brief
      */
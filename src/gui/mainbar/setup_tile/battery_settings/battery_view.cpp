@@ -29,6 +29,7 @@
 #include "gui/widget_styles.h"
 #include "hardware/pmu.h"
 #include "hardware/motor.h"
+#include "utils/history.h"
 
 lv_obj_t *battery_view_tile=NULL;
 lv_style_t battery_view_style;
@@ -40,6 +41,7 @@ lv_obj_t *battery_view_voltage;
 lv_obj_t *charge_view_current;
 lv_obj_t *discharge_view_current;
 lv_obj_t *vbus_view_voltage;
+lv_obj_t *history_view_range;
 lv_task_t *battery_view_task;
 
 LV_IMG_DECLARE(exit_32px);
@@ -162,6 +164,19 @@ void battery_view_tile_setup( uint32_t tile_num ) {
     lv_label_set_text( vbus_view_voltage, "2.4mV");
     lv_obj_align( vbus_view_voltage, vbus_voltage_cont, LV_ALIGN_IN_RIGHT_MID, -5, 0 );
 
+    lv_obj_t *history_range_cont = lv_obj_create( battery_view_tile, NULL );
+    lv_obj_set_size( history_range_cont, lv_disp_get_hor_res( NULL ) , 22 );
+    lv_obj_add_style( history_range_cont, LV_OBJ_PART_MAIN, &battery_view_style  );
+    lv_obj_align( history_range_cont, vbus_voltage_cont, LV_ALIGN_OUT_BOTTOM_MID, 0, 0 );
+    lv_obj_t *history_range_label = lv_label_create( history_range_cont, NULL);
+    lv_obj_add_style( history_range_label, LV_OBJ_PART_MAIN, &battery_view_style  );
+    lv_label_set_text( history_range_label, "last 24h");
+    lv_obj_align( history_range_label, history_range_cont, LV_ALIGN_IN_LEFT_MID, 5, 0 );
+    history_view_range = lv_label_create( history_range_cont, NULL);
+    lv_obj_add_style( history_view_range, LV_OBJ_PART_MAIN, &battery_view_style  );
+    lv_label_set_text( history_view_range, "n/a");
+    lv_obj_align( history_view_range, history_range_cont, LV_ALIGN_IN_RIGHT_MID, -5, 0 );
+
     mainbar_add_tile_activate_cb( battery_view_tile_num, battery_activate_cb );
     mainbar_add_tile_activate_cb( battery_view_tile_num + 1, battery_activate_cb );
     mainbar_add_tile_hibernate_cb( battery_view_tile_num, battery_hibernate_cb );
@@ -169,6 +184,28 @@ void battery_view_tile_setup( uint32_t tile_num ) {
 }
 
 void battery_activate_cb( void ) {
+    timeseries_point_t points[ 24 ];
+    char temp[16]="";
+    /*
+     * the hourly battery means only change once per hour, no need to query them every second
+     */
+    uint32_t now = history_get_local_time();
+    int32_t count = now ? history_query( HISTORY_BATTERY, TIMESERIES_HOUR, now - 86400, now, points, 24 ) : 0;
+    if ( count ) {
+        int32_t min = points[ 0 ].value;
+        int32_t max = points[ 0 ].value;
+        for( int32_t i = 1 ; i < count ; i++ ) {
+            min = points[ i ].value < min ? points[ i ].value : min;
+            max = points[ i ].value > max ? points[ i ].value : max;
+        }
+        snprintf( temp, sizeof( temp ), "%d-%d%%", min, max );
+    }
+    else {
+        snprintf( temp, sizeof( temp ), "n/a" );
+    }
+    lv_label_set_text( history_view_range, temp );
+    lv_obj_align( history_view_range, lv_obj_get_parent( history_view_range ), LV_ALIGN_IN_RIGHT_MID, -5, 0 );
+
     battery_view_task = lv_task_create(battery_view_update_task, 1000,  LV_TASK_PRIO_LOWEST, NULL );
 }
 
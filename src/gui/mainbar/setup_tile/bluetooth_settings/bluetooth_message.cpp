@@ -37,7 +37,7 @@
 
 #include "utils/json_psram_allocator.h"
 #include "utils/alloc.h"
-#include "utils/msg_chain.h"
+#include "utils/notification_store.h"
 
 // messages app and widget
 icon_t *messages_app = NULL;
@@ -59,7 +59,7 @@ lv_obj_t *bluetooth_next_msg_btn = NULL;
 lv_obj_t *bluetooth_trash_msg_btn = NULL;
 lv_obj_t *bluetooth_msg_entrys_label = NULL;
 
-msg_chain_t *bluetooth_msg_chain = NULL;
+notification_store_t *bluetooth_notification_store = NULL;
 static bool bluetooth_message_active = true;
 int32_t bluetooth_current_msg = -1;
 
@@ -102,17 +102,16 @@ static void bluetooth_del_message_event_cb( lv_obj_t * obj, lv_event_t event );
 static void exit_bluetooth_message_event_cb( lv_obj_t * obj, lv_event_t event );
 static void enter_bluetooth_messages_cb( lv_obj_t * obj, lv_event_t event );
 bool bluetooth_message_event_cb( EventBits_t event, void *arg );
-const lv_img_dsc_t *bluetooth_message_find_img( const char * src_name );
+int16_t bluetooth_message_find_icon( const char * src_name );
 
-void bluetooth_add_msg_to_chain( const char *msg );
 bool bluetooth_message_queue_msg( const char *msg );
-bool bluetooth_delete_msg_from_chain( int32_t entry );
-int32_t bluetooth_get_msg_entrys( void );
-const char* bluetooth_get_msg_entry( int32_t entry );
-void bluetooth_print_msg_chain( void );
 void bluetooth_message_show_msg( int32_t entry );
 
 void bluetooth_message_tile_setup( void ) {
+    /*
+     * allocate the notification store
+     */
+    bluetooth_notification_store = notification_store_create();
     /*
      * get an app tile and copy mainstyle
      */
@@ -206,9 +205,9 @@ void bluetooth_message_tile_setup( void ) {
 static void enter_bluetooth_messages_cb( lv_obj_t * obj, lv_event_t event ) {
     switch( event ) {
         case( LV_EVENT_CLICKED ):       
-            if ( msg_chain_get_entrys( bluetooth_msg_chain ) > 0 ) {
+            if ( notification_store_get_entrys( bluetooth_notification_store ) > 0 ) {
                 statusbar_hide( true );
-                bluetooth_message_show_msg( msg_chain_get_entrys( bluetooth_msg_chain ) - 1 );
+                bluetooth_message_show_msg( notification_store_get_entrys( bluetooth_notification_store ) - 1 );
                 mainbar_jump_to_tilenumber( bluetooth_message_tile_num, LV_ANIM_OFF );
             }
             break;
@@ -232,7 +231,7 @@ static void bluetooth_prev_message_event_cb( lv_obj_t * obj, lv_event_t event )
 static void bluetooth_next_message_event_cb( lv_obj_t * obj, lv_event_t event ) {
     switch( event ) {
         case( LV_EVENT_CLICKED ):
-            if ( bluetooth_current_msg < ( msg_chain_get_entrys( bluetooth_msg_chain ) - 1 ) ) {
+            if ( bluetooth_current_msg < ( notification_store_get_entrys( bluetooth_notification_store ) - 1 ) ) {
                 bluetooth_current_msg++;
                 bluetooth_message_show_msg( bluetooth_current_msg );
             }
@@ -244,21 +243,21 @@ static void bluetooth_next_message_event_cb( lv_obj_t * obj, lv_event_t event )
 static void bluetooth_del_message_event_cb( lv_obj_t * obj, lv_event_t event ) {
     switch( event ) {
         case( LV_EVENT_CLICKED ):
-            if ( msg_chain_get_entrys( bluetooth_msg_chain ) == 1 ) {
-                msg_chain_delete_msg_entry( bluetooth_msg_chain, bluetooth_current_msg );
+            if ( notification_store_get_entrys( bluetooth_notification_store ) == 1 ) {
+                notification_store_delete( bluetooth_notification_store, bluetooth_current_msg );
                 bluetooth_current_msg--;
                 app_hide_indicator( messages_app );
                 messages_widget = widget_remove( messages_widget );
                 mainbar_jump_to_maintile( LV_ANIM_OFF );
             }
             else {
-                if ( bluetooth_current_msg == ( msg_chain_get_entrys( bluetooth_msg_chain ) - 1 ) ) {
-                    msg_chain_delete_msg_entry( bluetooth_msg_chain, bluetooth_current_msg );
+                if ( bluetooth_current_msg == ( notification_store_get_entrys( bluetooth_notification_store ) - 1 ) ) {
+                    notification_store_delete( bluetooth_notification_store, bluetooth_current_msg );
                     bluetooth_current_msg--;
                     bluetooth_message_show_msg( bluetooth_current_msg );
                 }
                 else {
-                    msg_chain_delete_msg_entry( bluetooth_msg_chain, bluetooth_current_msg );
+                    notification_store_delete( bluetooth_notification_store, bluetooth_current_msg );
                     bluetooth_message_show_msg( bluetooth_current_msg );
                 }
             }
@@ -277,7 +276,7 @@ bool bluetooth_message_event_cb( EventBits_t event, void *arg ) {
 static void exit_bluetooth_message_event_cb( lv_obj_t * obj, lv_event_t event ) {
     switch( event ) {
         case( LV_EVENT_CLICKED ):       
-            switch ( msg_chain_get_entrys( bluetooth_msg_chain ) ) {
+            switch ( notification_store_get_entrys( bluetooth_notification_store ) ) {
                 case 1:
                     widget_set_indicator( messages_widget, ICON_INDICATOR_1 );
                     app_set_indicator( messages_app, ICON_INDICATOR_1 );
@@ -307,17 +306,20 @@ void bluetooth_message_enable( void ) {
     bluetooth_message_active = true;    
 }
 
-const lv_img_dsc_t *bluetooth_message_find_img( const char * src_name ) {
+int16_t bluetooth_message_find_icon( const char * src_name ) {
     /*
      * search for the right src icon
      */
+    if ( src_name == NULL ) {
+        return( NOTIFICATION_NO_ICON );
+    }
     for ( int i = 0; src_icon[ i ].img != NULL; i++ ) {
         if ( strstr( src_name, src_icon[ i ].src_name ) ) {
             log_i("hit: %s -> %s", src_name, src_icon[ i ].src_name );
-            return( src_icon[ i ].img );
+            return( i );
         }
     }
-    return( &message_32px );
+    return( NOTIFICATION_NO_ICON );
 }
 
 bool bluetooth_message_queue_msg( const char *msg ) {
@@ -342,9 +344,14 @@ bool bluetooth_message_queue_msg( const char *msg ) {
          */        
         if( !strcmp( doc["t"], "notify" ) ) {
             /*
-             * add msg to the msg chain
+             * add the pre parsed msg to the notification store, the sender
+             * falls back to the phone number
              */
-            bluetooth_msg_chain = msg_chain_add_msg( bluetooth_msg_chain, msg );
+            const char *sender = doc["sender"] ? doc["sender"].as<const char*>() : doc["tel"].as<const char*>();
+            if ( notification_store_add( bluetooth_notification_store, doc["id"] | 0, doc["src"], doc["title"], sender, doc["body"], bluetooth_message_find_icon( doc["src"] ) ) == NULL ) {
+                log_e("add msg to notification store failed");
+                return( retval );
+            }
             /*
              * wakeup for showing msg/alert
              */
@@ -353,10 +360,10 @@ bool bluetooth_message_queue_msg( const char *msg ) {
              * only alert or alret and showing msg
              */
             if ( blectl_get_show_notification() ) {
-                bluetooth_message_show_msg( msg_chain_get_entrys( bluetooth_msg_chain ) - 1 );
+                bluetooth_message_show_msg( notification_store_get_entrys( bluetooth_notification_store ) - 1 );
                 mainbar_jump_to_tilenumber( bluetooth_message_tile_num, LV_ANIM_OFF );
             }
-            bluetooth_current_msg = msg_chain_get_entrys( bluetooth_msg_chain ) - 1;
+            bluetooth_current_msg = notification_store_get_entrys( bluetooth_notification_store ) - 1;
             sound_play_progmem_wav( piep_wav, piep_wav_len );
             motor_vibe(10);
             /*
@@ -372,7 +379,7 @@ bool bluetooth_message_queue_msg( const char *msg ) {
             /*
              * set widget icon indicator
              */
-            switch ( msg_chain_get_entrys( bluetooth_msg_chain ) ) {
+            switch ( notification_store_get_entrys( bluetooth_notification_store ) ) {
                 case 1:
                             widget_set_indicator( messages_widget, ICON_INDICATOR_1 );
                             app_set_indicator( messages_app, ICON_INDICATOR_1 );
@@ -400,8 +407,8 @@ void bluetooth_message_show_msg( int32_t entry ) {
     /*
      * if an msg set?
      */
-    const char *msg = msg_chain_get_msg_entry( bluetooth_msg_chain, entry );
-    if ( msg == NULL ) {
+    const notification_t *notification = notification_store_get( bluetooth_notification_store, entry );
+    if ( notification == NULL ) {
         return;
     }
     /*
@@ -413,95 +420,72 @@ void bluetooth_message_show_msg( int32_t entry ) {
     else {
         lv_obj_set_hidden( bluetooth_prev_msg_btn, true );
     }
-    if ( entry < ( msg_chain_get_entrys( bluetooth_msg_chain ) -1 ) ) {
+    if ( entry < ( notification_store_get_entrys( bluetooth_notification_store ) -1 ) ) {
         lv_obj_set_hidden( bluetooth_next_msg_btn, false );
     }
     else {
         lv_obj_set_hidden( bluetooth_next_msg_btn, true );
     }
     /*
-     * allocate json memory and serialize msg
+     * set the receive time string
      */
-    SpiRamJsonDocument doc( strlen( msg ) * 4 );
-    DeserializationError error = deserializeJson( doc, msg );
-    if ( error ) {
-        log_e("bluetooth message deserializeJson() failed: %s", error.c_str() );
+    struct tm info;
+    char timestamp[16]="";
+    localtime_r( &notification->timestamp, &info );
+    int h = info.tm_hour;
+    int m = info.tm_min;
+    snprintf( timestamp, sizeof( timestamp ), "%02d:%02d", h, m );
+    lv_label_set_text( bluetooth_message_time_label, timestamp );
+    /*
+     * set the numbers of msg string
+     */
+    snprintf( msg_num, sizeof( msg_num ), "%d/%d", entry + 1, notification_store_get_entrys( bluetooth_notification_store ) );
+    lv_label_set_text( bluetooth_msg_entrys_label, msg_num );
+    lv_obj_align( bluetooth_msg_entrys_label, bluetooth_next_msg_btn, LV_ALIGN_OUT_LEFT_MID, -5, 0 );
+    /*
+     * hide statusbar
+     */
+    statusbar_hide( true );
+    /*
+     * set notify source icon if msg src known
+     */
+    if ( notification->icon != NOTIFICATION_NO_ICON ) {
+        lv_img_set_src( bluetooth_message_img, src_icon[ notification->icon ].img );
     }
     else {
-        /*
-         * if msg an notify msg?
-         */
-        if( !strcmp( doc["t"], "notify" ) ) {
-            /*
-             * set the receive time string
-             */
-            struct tm info;
-            char timestamp[16]="";
-            localtime_r( msg_chain_get_msg_timestamp_entry( bluetooth_msg_chain, entry ), &info );
-            int h = info.tm_hour;
-            int m = info.tm_min;
-            snprintf( timestamp, sizeof( timestamp ), "%02d:%02d", h, m );
-            lv_label_set_text( bluetooth_message_time_label, timestamp );
-            /*
-             * set the numbers of msg string
-             */
-            snprintf( msg_num, sizeof( msg_num ), "%d/%d", entry + 1, msg_chain_get_entrys( bluetooth_msg_chain ) );
-            lv_label_set_text( bluetooth_msg_entrys_label, msg_num );
-            lv_obj_align( bluetooth_msg_entrys_label, bluetooth_next_msg_btn, LV_ALIGN_OUT_LEFT_MID, -5, 0 );
-            /*
-             * hide statusbar
-             */
-            statusbar_hide( true );
-            /*
-             * set notify source icon if msg src known
-             */
-            if ( doc["src"] ) {
-                lv_img_set_src( bluetooth_message_img, bluetooth_message_find_img( doc["src"] ) ); 
-                lv_label_set_text( bluetooth_message_notify_source_label, doc["src"] );
-            }
-            else {
-                lv_img_set_src( bluetooth_message_img, &message_32px );
-                lv_label_set_text( bluetooth_message_notify_source_label, "Message" );
-            }
-            /*
-             * set message if body known or set title and if no other information
-             * available set an emty msg
-             */
-            if ( doc["body"] ) {
-                lv_label_set_text( bluetooth_message_msg_label, doc["body"] );
-            }
-            else if ( doc["title"] ) {
-                lv_label_set_text( bluetooth_message_msg_label, doc["title"] );
-            }
-            else {
-                lv_label_set_text( bluetooth_message_msg_label, "" );
-            }
-            /*
-             * scroll back to the top of the msg
-             */
-            if ( lv_page_get_scrl_height( bluetooth_message_page ) > 160 ) {
-                lv_page_scroll_ver( bluetooth_message_page, lv_page_get_scrl_height( bluetooth_message_page ) ); 
-            }
-            /*
-             * set sender label from available source
-             */
-            if ( doc["title"] ) {
-                lv_label_set_text( bluetooth_message_sender_label, doc["title"] );
-            }
-            else if ( doc["sender"] ) {
-                lv_label_set_text( bluetooth_message_sender_label, doc["sender"] );
-            }
-            else if( doc["tel"] ) {
-                lv_label_set_text( bluetooth_message_sender_label, doc["tel"] );
-            }
-            else {
-                lv_label_set_text( bluetooth_message_sender_label, "n/a" );
-            }
-            /*
-             * trigger invalidate to redraw all information
-             */
-            lv_obj_invalidate( lv_scr_act() );
-        }
-    }        
-    doc.clear();
+        lv_img_set_src( bluetooth_message_img, &message_32px );
+    }
+    lv_label_set_text( bluetooth_message_notify_source_label, notification->src );
+    /*
+     * set message if body known or set title and if no other information
+     * available set an emty msg
+     */
+    if ( *notification->body ) {
+        lv_label_set_text( bluetooth_message_msg_label, notification->body );
+    }
+    else {
+        lv_label_set_text( bluetooth_message_msg_label, notification->title );
+    }
+    /*
+     * scroll back to the top of the msg
+     */
+    if ( lv_page_get_scrl_height( bluetooth_message_page ) > 160 ) {
+        lv_page_scroll_ver( bluetooth_message_page, lv_page_get_scrl_height( bluetooth_message_page ) ); 
+    }
+    /*
+     * set sender label from available source
+     */
+    if ( *notification->title ) {
+        lv_label_set_text( bluetooth_message_sender_label, notification->title );
+    }
+    else if ( *notification->sender ) {
+        lv_label_set_text( bluetooth_message_sender_label, notification->sender );
+    }
+    else {
+        lv_label_set_text( bluetooth_message_sender_label, "n/a" );
+    }
+    /*
+     * trigger invalidate to redraw all information
+     */
+    lv_obj_invalidate( lv_scr_act() );
 }
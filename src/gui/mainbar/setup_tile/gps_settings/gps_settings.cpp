@@ -164,7 +164,7 @@ void gps_settings_tile_setup( void ) {
     else
         lv_switch_off( fakegps_onoff, LV_ANIM_OFF );
 
-    gpsctl_register_cb( GPSCTL_FIX | GPSCTL_NOFIX | GPSCTL_UPDATE_LOCATION, gps_settings_latlon_update_cb, "gps settings" );
+    gpsctl_register_cb( GPSCTL_FIX | GPSCTL_NOFIX | GPSCTL_UPDATE_FIX, gps_settings_latlon_update_cb, "gps settings" );
     gpsctl_register_cb( GPSCTL_UPDATE_CONFIG, gps_settings_config_update_cb, "gps settings" );
 }
 
@@ -204,8 +204,11 @@ bool gps_settings_latlon_update_cb( EventBits_t event, void *arg ) {
     char msg[64] = "";
 
     switch( event ) {
-        case GPSCTL_UPDATE_LOCATION:
+        case GPSCTL_UPDATE_FIX:
             gps_data = (gps_data_t*)arg;
+            if ( !( gps_data->updated & GPSCTL_UPDATE_LOCATION ) ) {
+                return( true );
+            }
             lat = gps_data->lat;
             lon = gps_data->lon;
             break;
@@ -40,12 +40,19 @@
 #include "hardware/wifictl.h"
 #include "hardware/motor.h"
 
+#include "utils/basejsonconfig.h"
 #include "utils/http_ota/http_ota.h"
+#include "utils/worker.h"
+
+#define UPDATE_JOB_FAILED           0
+#define UPDATE_JOB_OK               1
+#define UPDATE_JOB_NO_WIFI          2
 
 EventGroupHandle_t update_event_handle = NULL;
-TaskHandle_t _update_Task;
 lv_task_t *_update_progress_task;
-void update_Task( void * pvParameters );
+static int64_t update_firmware_version = 0;
+int32_t update_job( worker_job_t *job );
+void update_job_done( worker_job_t *job );
 
 icon_t *update_setup_icon = NULL;
 
@@ -247,6 +254,7 @@ static void update_event_handler(lv_obj_t * obj, lv_event_t event) {
             delay(20);
             display_standby();
             ttgo->stopLvglTick();
+            BaseJsonConfig::flushAll();
             SPIFFS.end();
             log_i("SPIFFS unmounted!");
             delay(500);
@@ -257,12 +265,9 @@ static void update_event_handler(lv_obj_t * obj, lv_event_t event) {
         }
         else {
             xEventGroupSetBits( update_event_handle, UPDATE_REQUEST );
-            xTaskCreate(    update_Task,
-                            "update Task",
-                            5000,
-                            NULL,
-                            1,
-                            &_update_Task );
+            if ( worker_submit( "update", update_job, update_job_done, NULL, WORKER_PRIO_HIGH ) == WORKER_NO_JOB ) {
+                xEventGroupClearBits( update_event_handle, UPDATE_REQUEST );
+            }
         }
     }
 }
@@ -273,20 +278,40 @@ void update_check_version( void ) {
     }
     else {
         xEventGroupSetBits( update_event_handle, UPDATE_GET_VERSION_REQUEST );
-        xTaskCreate(    update_Task,
-                        "update Task",
-                        5000,
-                        NULL,
-                        1,
-                        &_update_Task );
+        if ( worker_submit( "update check version", update_job, update_job_done, NULL, WORKER_PRIO_NORMAL ) == WORKER_NO_JOB ) {
+            xEventGroupClearBits( update_event_handle, UPDATE_GET_VERSION_REQUEST );
+        }
     }
 }
 
-void update_Task( void * pvParameters ) {
-    log_i("start update task, heap: %d", ESP.getFreeHeap() );
+int32_t update_job( worker_job_t *job ) {
+    int32_t retval = UPDATE_JOB_FAILED;
+
+    if ( xEventGroupGetBits( update_event_handle) & UPDATE_GET_VERSION_REQUEST ) {
+        update_firmware_version = update_check_new_version( update_setup_get_url() );
+        retval = UPDATE_JOB_OK;
+    }
+    if ( ( xEventGroupGetBits( update_event_handle) & UPDATE_REQUEST ) && ( update_get_url() != NULL ) ) {
+        if( ( WiFi.status() == WL_CONNECTED ) ) {
+
+            uint32_t display_timeout = display_get_timeout();
+            display_set_timeout( DISPLAY_MAX_TIMEOUT );
+
+            retval = http_ota_start( update_get_url(), update_get_md5(), update_get_size() ) ? UPDATE_JOB_OK : UPDATE_JOB_FAILED;
+
+            display_set_timeout( display_timeout );
+            powermgm_set_event( POWERMGM_WAKEUP_REQUEST );
+        }
+        else {
+            retval = UPDATE_JOB_NO_WIFI;
+        }
+    }
+    return( retval );
+}
 
+void update_job_done( worker_job_t *job ) {
     if ( xEventGroupGetBits( update_event_handle) & UPDATE_GET_VERSION_REQUEST ) {
-        int64_t firmware_version = update_check_new_version( update_setup_get_url() );
+        int64_t firmware_version = update_firmware_version;
         if ( firmware_version > atol( __FIRMWARE__ ) && firmware_version > 0 ) {
             char version_msg[48] = "";
             snprintf( version_msg, sizeof( version_msg ), "new version: %lld", firmware_version );
@@ -308,34 +333,24 @@ void update_Task( void * pvParameters ) {
             lv_obj_align( update_status_label, update_btn, LV_ALIGN_OUT_BOTTOM_MID, 0, 5 );  
             setup_hide_indicator( update_setup_icon );
         }
-        lv_obj_invalidate( lv_scr_act() );
     }
     if ( ( xEventGroupGetBits( update_event_handle) & UPDATE_REQUEST ) && ( update_get_url() != NULL ) ) {
-        if( ( WiFi.status() == WL_CONNECTED ) ) {
-
-            uint32_t display_timeout = display_get_timeout();
-            display_set_timeout( DISPLAY_MAX_TIMEOUT );
-
-            if ( http_ota_start( update_get_url(), update_get_md5(), update_get_size() ) ) {
+        switch( job->result ) {
+            case UPDATE_JOB_OK:
                 reset = true;
-                progress = 0;
                 lv_label_set_text( update_status_label, "update ok, turn off and on!" );
                 lv_obj_align( update_status_label, update_btn, LV_ALIGN_OUT_BOTTOM_MID, 0, 5 );
                 lv_label_set_text( update_btn_label, "restart");
-            }
-            progress = 0;
-            lv_bar_set_value( update_progressbar, 0 , LV_ANIM_ON );
-            display_set_timeout( display_timeout );
-            powermgm_set_event( POWERMGM_WAKEUP_REQUEST );
-        }
-        else {
-            lv_label_set_text( update_status_label, "turn wifi on!" );
-            lv_obj_align( update_status_label, update_btn, LV_ALIGN_OUT_BOTTOM_MID, 0, 5 );  
+                break;
+            case UPDATE_JOB_NO_WIFI:
+                lv_label_set_text( update_status_label, "turn wifi on!" );
+                lv_obj_align( update_status_label, update_btn, LV_ALIGN_OUT_BOTTOM_MID, 0, 5 );  
+                break;
         }
+        progress = 0;
+        lv_bar_set_value( update_progressbar, 0 , LV_ANIM_ON );
     }
     xEventGroupClearBits( update_event_handle, UPDATE_REQUEST | UPDATE_GET_VERSION_REQUEST );
     lv_disp_trig_activity(NULL);
     lv_obj_invalidate( lv_scr_act() );
-    log_i("finish update task, heap: %d", ESP.getFreeHeap() );
-    vTaskDelete( NULL );
-}
\ No newline at end of file
+}
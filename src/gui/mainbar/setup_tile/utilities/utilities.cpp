@@ -33,6 +33,8 @@
 #include "hardware/motor.h"
 #include "hardware/display.h"
 
+#include "utils/basejsonconfig.h"
+
 
 
 lv_obj_t *utilities_tile=NULL;
@@ -266,6 +268,7 @@ static void reboot_utilities_event_cb( lv_obj_t * obj, lv_event_t event ) {
 
                                         TTGOClass *ttgo = TTGOClass::getWatch();
                                         ttgo->stopLvglTick();
+                                        BaseJsonConfig::flushAll();
                                         SPIFFS.end();
                                         log_i("SPIFFS unmounted!");
                                         delay(500);
@@ -284,6 +287,7 @@ static void poweroff_utilities_event_cb( lv_obj_t * obj, lv_event_t event ) {
                                         
                                         TTGOClass *ttgo = TTGOClass::getWatch();
                                         ttgo->stopLvglTick();
+                                        BaseJsonConfig::flushAll();
                                         SPIFFS.end();
                                         log_i("SPIFFS unmounted!");
                                         delay(500);
@@ -0,0 +1,138 @@
+/****************************************************************************
+ *   Oct 19 10:12:40 2026
+ *   Copyright  2026  My-TTGO-Watch contributors
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#include <string.h>
+
+#include "tile_index.h"
+
+/**
+ * @brief fibonacci hash of a tile position, the top bits of the product
+ * depend on x and y, the low bits only on y
+ */
+static uint32_t tile_index_pos_hash( uint32_t pos ) {
+    return( pos * 2654435761u );
+}
+
+/**
+ * @brief FNV-1a hash of a tile id, ids like "app 1" and "app 2" only
+ * differ in the last byte, so the top bits are mixed once more
+ */
+static uint32_t tile_index_id_hash( const char *id ) {
+    uint32_t hash = 2166136261u;
+
+    while( *id ) {
+        hash = ( hash ^ (uint8_t)*id++ ) * 16777619u;
+    }
+    hash ^= hash >> 16;
+    hash *= 0x85ebca6bu;
+    hash ^= hash >> 13;
+    return( hash );
+}
+
+uint32_t tile_index_slots( uint32_t tiles ) {
+    uint32_t size = 2;
+
+    while( size < tiles * 2 ) {
+        size <<= 1;
+    }
+    return( size );
+}
+
+void tile_index_init( tile_index_t *index, tile_index_pos_slot_t *pos, tile_index_id_slot_t *id, uint32_t size ) {
+    index->pos = pos;
+    index->id = id;
+    index->size = size;
+    index->shift = 32;
+    while( size > 1 ) {
+        index->shift--;
+        size >>= 1;
+    }
+    for( uint32_t i = 0 ; i < index->size ; i++ ) {
+        index->pos[ i ].pos = 0;
+        index->pos[ i ].tile = TILE_INDEX_FREE;
+        index->id[ i ].id = NULL;
+        index->id[ i ].tile = TILE_INDEX_FREE;
+    }
+}
+
+bool tile_index_add( tile_index_t *index, uint16_t x, uint16_t y, const char *id, int16_t tile ) {
+    uint32_t mask = index->size - 1;
+    uint32_t pos = ( (uint32_t)x << 16 ) | y;
+    uint32_t slot = tile_index_pos_hash( pos ) >> index->shift;
+    bool retval = true;
+
+    while( index->pos[ slot ].tile != TILE_INDEX_FREE && index->pos[ slot ].pos != pos ) {
+        slot = ( slot + 1 ) & mask;
+    }
+    if ( index->pos[ slot ].tile == TILE_INDEX_FREE ) {
+        index->pos[ slot ].pos = pos;
+        index->pos[ slot ].tile = tile;
+    }
+    else {
+        retval = false;
+    }
+
+    if ( id == NULL ) {
+        return( retval );
+    }
+    slot = tile_index_id_hash( id ) >> index->shift;
+    while( index->id[ slot ].tile != TILE_INDEX_FREE ) {
+        if ( !strcmp( index->id[ slot ].id, id ) ) {
+            return( retval );
+        }
+        slot = ( slot + 1 ) & mask;
+    }
+    index->id[ slot ].id = id;
+    index->id[ slot ].tile = tile;
+    return( retval );
+}
+
+int32_t tile_index_get_pos( const tile_index_t *index, uint16_t x, uint16_t y ) {
+    if ( index->size == 0 ) {
+        return( TILE_INDEX_FREE );
+    }
+    uint32_t mask = index->size - 1;
+    uint32_t pos = ( (uint32_t)x << 16 ) | y;
+    uint32_t slot = tile_index_pos_hash( pos ) >> index->shift;
+
+    while( index->pos[ slot ].tile != TILE_INDEX_FREE ) {
+        if ( index->pos[ slot ].pos == pos ) {
+            return( index->pos[ slot ].tile );
+        }
+        slot = ( slot + 1 ) & mask;
+    }
+    return( TILE_INDEX_FREE );
+}
+
+int32_t tile_index_get_id( const tile_index_t *index, const char *id ) {
+    if ( index->size == 0 || id == NULL ) {
+        return( TILE_INDEX_FREE );
+    }
+    uint32_t mask = index->size - 1;
+    uint32_t slot = tile_index_id_hash( id ) >> index->shift;
+
+    while( index->id[ slot ].tile != TILE_INDEX_FREE ) {
+        if ( !strcmp( index->id[ slot ].id, id ) ) {
+            return( index->id[ slot ].tile );
+        }
+        slot = ( slot + 1 ) & mask;
+    }
+    return( TILE_INDEX_FREE );
+}
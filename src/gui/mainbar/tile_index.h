@@ -0,0 +1,114 @@
+/****************************************************************************
+ *   Oct 19 10:12:40 2026
+ *   Copyright  2026  My-TTGO-Watch contributors
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#ifndef _TILE_INDEX_H
+    #define _TILE_INDEX_H
+
+    #include <stdint.h>
+    #include <stdbool.h>
+
+    /*
+     * note:    this module is plain C without arduino dependencies,
+     *          tools/mainbar_bench.cpp builds it on the host.
+     *
+     * two open addressing hash tables with linear probing map a tile
+     * position and a tile id to the tile number. the slots keep their
+     * own key, so the index does not depend on the tile table and
+     * survives when the tile table is moved by a realloc.
+     */
+    #define TILE_INDEX_FREE             -1                  /** @brief free slot or tile not found */
+
+    /**
+     * @brief position index slot
+     */
+    typedef struct {
+        uint32_t pos;                                       /** @brief ( x << 16 ) | y */
+        int16_t tile;                                       /** @brief tile number or TILE_INDEX_FREE */
+    } tile_index_pos_slot_t;
+
+    /**
+     * @brief id index slot
+     */
+    typedef struct {
+        const char *id;                                     /** @brief tile id, not copied */
+        int16_t tile;                                       /** @brief tile number or TILE_INDEX_FREE */
+    } tile_index_id_slot_t;
+
+    /**
+     * @brief tile index, the slot arrays are owned by the caller
+     */
+    typedef struct {
+        tile_index_pos_slot_t *pos;                         /** @brief position slots */
+        tile_index_id_slot_t *id;                           /** @brief id slots */
+        uint32_t size;                                      /** @brief number of slots per table, a power of two */
+        uint32_t shift;                                     /** @brief 32 - log2( size ), the slot is the top bits of the hash */
+    } tile_index_t;
+
+    /**
+     * @brief get the number of slots for a number of tiles, a power of two
+     * and at least twice the number of tiles
+     *
+     * @param   tiles       number of tiles
+     *
+     * @return  number of slots
+     */
+    uint32_t tile_index_slots( uint32_t tiles );
+    /**
+     * @brief set up an empty index
+     *
+     * @param   index       pointer to the index
+     * @param   pos         position slot array with size entrys
+     * @param   id          id slot array with size entrys
+     * @param   size        number of slots, from tile_index_slots()
+     */
+    void tile_index_init( tile_index_t *index, tile_index_pos_slot_t *pos, tile_index_id_slot_t *id, uint32_t size );
+    /**
+     * @brief add a tile, the first tile with a position or id wins
+     *
+     * @param   index       pointer to the index
+     * @param   x           x position
+     * @param   y           y position
+     * @param   id          tile id, can be NULL
+     * @param   tile        tile number
+     *
+     * @return  false if the position is already in use
+     */
+    bool tile_index_add( tile_index_t *index, uint16_t x, uint16_t y, const char *id, int16_t tile );
+    /**
+     * @brief get the tile at a position
+     *
+     * @param   index       pointer to the index
+     * @param   x           x position
+     * @param   y           y position
+     *
+     * @return  tile number or TILE_INDEX_FREE if not found
+     */
+    int32_t tile_index_get_pos( const tile_index_t *index, uint16_t x, uint16_t y );
+    /**
+     * @brief get the first tile with an id
+     *
+     * @param   index       pointer to the index
+     * @param   id          tile id
+     *
+     * @return  tile number or TILE_INDEX_FREE if not found
+     */
+    int32_t tile_index_get_id( const tile_index_t *index, const char *id );
+
+#endif // _TILE_INDEX_H
@@ -8,6 +8,12 @@
  *********************/
 #include "lvgl/lvgl.h"
 #include "lodepng.h"
+#include "png_decoder.h"
+#include "png_stream.h"
+#include "utils/bench.h"
+#include "gui/img_cache.h"
+#include "utils/alloc.h"
+#include "esp_timer.h"
 #include <stdlib.h>
 #include <stdio.h>
 
@@ -26,10 +32,17 @@ static lv_res_t decoder_info(struct _lv_img_decoder * decoder, const void * src,
 static lv_res_t decoder_open(lv_img_decoder_t * dec, lv_img_decoder_dsc_t * dsc);
 static void decoder_close(lv_img_decoder_t * dec, lv_img_decoder_dsc_t * dsc);
 static void convert_color_depth(uint8_t * img, uint32_t px_cnt);
+static uint8_t * cache_image(lv_img_decoder_dsc_t * dsc, uint8_t * img_data, uint32_t px_cnt, int64_t start);
+static lv_res_t decoder_open_stream(lv_img_decoder_dsc_t * dsc, png_stream_t * stream, int64_t start);
+static lv_res_t decoder_read_line(lv_img_decoder_t * decoder, lv_img_decoder_dsc_t * dsc, lv_coord_t x, lv_coord_t y, lv_coord_t len, uint8_t * buf);
+static void convert_row(const uint8_t * rgba, uint8_t * out, uint32_t px_cnt);
 
 /**********************
  *  STATIC VARIABLES
  **********************/
+static png_decoder_stats_t png_decoder_stats;
+static int32_t png_bench_decode = -1;
+static int32_t png_bench_first_row = -1;
 
 /**********************
  *      MACROS
@@ -48,6 +61,19 @@ void png_decoder_init(void)
     lv_img_decoder_set_info_cb(dec, decoder_info);
     lv_img_decoder_set_open_cb(dec, decoder_open);
     lv_img_decoder_set_close_cb(dec, decoder_close);
+    lv_img_decoder_set_read_line_cb(dec, decoder_read_line);
+
+    png_bench_decode = bench_register("png decode", BENCH_NO_BUDGET);
+    png_bench_first_row = bench_register("png first row", BENCH_NO_BUDGET);
+}
+
+/**
+ * Get the PNG decoder statistic
+ * @param stats pointer to a png_decoder_stats_t structure
+ */
+void png_decoder_get_stats(png_decoder_stats_t * stats)
+{
+    *stats = png_decoder_stats;
 }
 
 /**********************
@@ -119,6 +145,11 @@ static lv_res_t decoder_open(lv_img_decoder_t * decoder, lv_img_decoder_dsc_t *
     uint32_t error;                 /*For the return values of PNG decoder functions*/
 
     uint8_t * img_data = NULL;
+    int64_t start = esp_timer_get_time();
+
+    /*Use the already decoded image if it is in the cache*/
+    dsc->img_data = img_cache_get(dsc->src_type, dsc->src, 0);
+    if(dsc->img_data) return LV_RES_OK;
 
     /*If it's a PNG file...*/
     if(dsc->src_type == LV_IMG_SRC_FILE) {
@@ -126,6 +157,10 @@ static lv_res_t decoder_open(lv_img_decoder_t * decoder, lv_img_decoder_dsc_t *
 
         if(!strcmp(&fn[strlen(fn) - 3], "png")) {              /*Check the extension*/
 
+            /*Decode row by row into the native format if the format allows it*/
+            png_stream_t * stream = png_stream_open(fn);
+            if(stream) return decoder_open_stream(dsc, stream, start);
+
             /*Load the PNG file into buffer. It's still compressed (not decoded)*/
             unsigned char * png_data;      /*Pointer to the loaded data. Same as the original file just loaded into the RAM*/
             size_t png_data_size;          /*Size of `png_data` in bytes*/
@@ -142,6 +177,9 @@ static lv_res_t decoder_open(lv_img_decoder_t * decoder, lv_img_decoder_dsc_t *
 
             /*Decode the loaded image in ARGB8888 */
             error = lodepng_decode32(&img_data, &png_width, &png_height, png_data, png_data_size);
+            free(png_data);         /*The compressed data is not needed anymore*/
+            png_decoder_stats.lodepng++;
+            png_decoder_stats.lodepng_bytes = png_data_size + (png_width * 4 + 1) * png_height + png_width * png_height * 4;
             if(error) {
                 printf("error %u: %s\n", error, lodepng_error_text(error));
                 return LV_RES_INV;
@@ -149,7 +187,7 @@ static lv_res_t decoder_open(lv_img_decoder_t * decoder, lv_img_decoder_dsc_t *
 
             /*Convert the image to the system's color depth*/
             convert_color_depth(img_data,  png_width * png_height);
-            dsc->img_data = img_data;
+            dsc->img_data = cache_image(dsc, img_data, png_width * png_height, start);
             return LV_RES_OK;     /*The image is fully decoded. Return with its pointer*/
         }
     }
@@ -169,7 +207,7 @@ static lv_res_t decoder_open(lv_img_decoder_t * decoder, lv_img_decoder_dsc_t *
         /*Convert the image to the system's color depth*/
         convert_color_depth(img_data,  png_width * png_height);
 
-        dsc->img_data = img_data;
+        dsc->img_data = cache_image(dsc, img_data, png_width * png_height, start);
         return LV_RES_OK;     /*Return with its pointer*/
     }
 
@@ -182,7 +220,124 @@ static lv_res_t decoder_open(lv_img_decoder_t * decoder, lv_img_decoder_dsc_t *
 static void decoder_close(lv_img_decoder_t * decoder, lv_img_decoder_dsc_t * dsc)
 {
     (void) decoder; /*Unused*/
-    if(dsc->img_data) free((uint8_t *)dsc->img_data);
+    /*A row stream is only open if the image is decoded on demand*/
+    if(dsc->user_data) {
+        png_stream_close(dsc->user_data);
+        dsc->user_data = NULL;
+    }
+    /*Cached images are only released, the cache frees them*/
+    if(dsc->img_data && !img_cache_release(dsc->img_data)) free((uint8_t *)dsc->img_data);
+}
+
+/**
+ * Shrink a converted image to its native size and add it to the image cache
+ * @param dsc pointer to the decoder descriptor
+ * @param img_data the converted image
+ * @param px_cnt number of pixels in `img_data`
+ * @param start decode start time in us
+ * @return pointer to the image, maybe moved by the shrink
+ */
+static uint8_t * cache_image(lv_img_decoder_dsc_t * dsc, uint8_t * img_data, uint32_t px_cnt, int64_t start)
+{
+    uint32_t size = px_cnt * LV_IMG_PX_SIZE_ALPHA_BYTE;
+    uint8_t * native = REALLOC(img_data, size);
+    if(native) img_data = native;
+
+    img_cache_put(dsc->src_type, dsc->src, 0, img_data, size, esp_timer_get_time() - start);
+    return img_data;
+}
+
+/**
+ * Decode a PNG file row by row straight into the native format, only two rows and the
+ * inflate window are needed next to the image. If the image does not fit into memory
+ * the stream stays open and the rows are decoded in `decoder_read_line`
+ * @param dsc pointer to the decoder descriptor
+ * @param stream the opened row stream
+ * @param start decode start time in us
+ * @return LV_RES_OK: no error; LV_RES_INV: decoding failed
+ */
+static lv_res_t decoder_open_stream(lv_img_decoder_dsc_t * dsc, png_stream_t * stream, int64_t start)
+{
+    uint32_t row_size = stream->width * LV_IMG_PX_SIZE_ALPHA_BYTE;
+    uint32_t size = row_size * stream->height;
+
+    png_decoder_stats.stream_bytes = stream->size;
+
+    uint8_t * img_data = MALLOC(size);
+    if(!img_data) {
+        png_decoder_stats.on_demand++;
+        dsc->user_data = stream;
+        dsc->img_data = NULL;
+        return LV_RES_OK;
+    }
+
+    for(uint32_t y = 0; y < stream->height; y++) {
+        const uint8_t * row = png_stream_read_row(stream, y);
+        if(!row) {
+            free(img_data);
+            png_stream_close(stream);
+            return LV_RES_INV;
+        }
+        if(y == 0) bench_add(png_bench_first_row, esp_timer_get_time() - start);
+        convert_row(row, img_data + y * row_size, stream->width);
+    }
+    png_stream_close(stream);
+    png_decoder_stats.streamed++;
+    bench_add(png_bench_decode, esp_timer_get_time() - start);
+
+    img_cache_put(dsc->src_type, dsc->src, 0, img_data, size, esp_timer_get_time() - start);
+    dsc->img_data = img_data;
+    return LV_RES_OK;
+}
+
+/**
+ * Decode `len` pixels of a row from an on demand decoded image
+ * @param decoder pointer to the decoder the function associated with
+ * @param dsc pointer to decoder descriptor
+ * @param x start x coordinate
+ * @param y start y coordinate
+ * @param len number of pixels to decode
+ * @param buf a buffer to store the decoded pixels
+ * @return LV_RES_OK: ok; LV_RES_INV: failed
+ */
+static lv_res_t decoder_read_line(lv_img_decoder_t * decoder, lv_img_decoder_dsc_t * dsc, lv_coord_t x, lv_coord_t y, lv_coord_t len, uint8_t * buf)
+{
+    (void) decoder; /*Unused*/
+    png_stream_t * stream = dsc->user_data;
+    if(!stream) return LV_RES_INV;
+
+    const uint8_t * row = png_stream_read_row(stream, y);
+    if(!row) return LV_RES_INV;
+
+    convert_row(row + x * 4, buf, len);
+    return LV_RES_OK;
+}
+
+/**
+ * Convert a RGBA8888 row to the native color format with alpha byte
+ * @param rgba the RGBA8888 pixels
+ * @param out the native pixels
+ * @param px_cnt number of pixels
+ */
+static void convert_row(const uint8_t * rgba, uint8_t * out, uint32_t px_cnt)
+{
+    uint32_t i;
+    for(i = 0; i < px_cnt; i++) {
+        lv_color_t c = LV_COLOR_MAKE(rgba[0], rgba[1], rgba[2]);
+#if LV_COLOR_DEPTH == 32
+        c.ch.alpha = rgba[3];
+        memcpy(out, &c, sizeof(c));
+#elif LV_COLOR_DEPTH == 16
+        out[0] = c.full & 0xFF;
+        out[1] = c.full >> 8;
+        out[2] = rgba[3];
+#elif LV_COLOR_DEPTH == 8
+        out[0] = c.full;
+        out[1] = rgba[3];
+#endif
+        out += LV_IMG_PX_SIZE_ALPHA_BYTE;
+        rgba += 4;
+    }
 }
 
 /**
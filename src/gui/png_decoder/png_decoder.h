@@ -21,6 +21,13 @@ extern "C" {
 /**********************
  *      TYPEDEFS
  **********************/
+typedef struct {
+    uint32_t streamed;              /*Images decoded row by row*/
+    uint32_t on_demand;             /*Images decoded in read_line because the whole image did not fit*/
+    uint32_t lodepng;               /*Images decoded with lodepng because the format is not streamable*/
+    uint32_t stream_bytes;          /*Transient memory of the last row by row decode*/
+    uint32_t lodepng_bytes;         /*Transient memory of the last lodepng decode*/
+} png_decoder_stats_t;
 
 /**********************
  * GLOBAL PROTOTYPES
@@ -31,6 +38,12 @@ extern "C" {
  */
 void png_decoder_init(void);
 
+/**
+ * Get the PNG decoder statistic
+ * @param stats pointer to a png_decoder_stats_t structure
+ */
+void png_decoder_get_stats(png_decoder_stats_t * stats);
+
 /**********************
  *      MACROS
  **********************/
@@ -0,0 +1,355 @@
+/****************************************************************************
+ *   Oct 18 16:05:12 2026
+ *   Copyright  2026  My-TTGO-Watch contributors
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "png_stream.h"
+#include "utils/alloc.h"
+
+static const uint8_t png_stream_signature[ 8 ] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+
+static uint32_t png_stream_be32( const uint8_t *data ) {
+    return( ( (uint32_t)data[ 0 ] << 24 ) | ( (uint32_t)data[ 1 ] << 16 ) | ( (uint32_t)data[ 2 ] << 8 ) | data[ 3 ] );
+}
+
+/**
+ * @brief multiply two sizes, false on uint32_t overflow
+ */
+static bool png_stream_mul( uint32_t a, uint32_t b, uint32_t *result ) {
+    if ( b != 0 && a > UINT32_MAX / b ) {
+        return( false );
+    }
+    *result = a * b;
+    return( true );
+}
+
+/**
+ * @brief read the next byte of the zlib stream, IDAT chunk borders are skipped
+ */
+static unsigned int png_stream_read_byte( TINF_DATA *data, unsigned char *out ) {
+    png_stream_t *stream = (png_stream_t *)( (uint8_t *)data - offsetof( png_stream_t, inflate ) );
+
+    while( stream->idat_remaining == 0 ) {
+        uint8_t header[ 12 ];
+        /*
+         * skip the crc of the last chunk and read the next chunk header
+         */
+        if ( fread( header, 1, sizeof( header ), stream->file ) != sizeof( header ) || memcmp( &header[ 8 ], "IDAT", 4 ) ) {
+            data->eof = true;
+            *out = 0;
+            return( 0 );
+        }
+        stream->idat_remaining = png_stream_be32( &header[ 4 ] );
+        stream->input_pos = stream->input_len = 0;
+    }
+    if ( stream->input_pos == stream->input_len ) {
+        uint32_t len = stream->idat_remaining < PNG_STREAM_INPUT_SIZE ? stream->idat_remaining : PNG_STREAM_INPUT_SIZE;
+        stream->input_len = fread( stream->input, 1, len, stream->file );
+        stream->input_pos = 0;
+        if ( stream->input_len == 0 ) {
+            data->eof = true;
+            *out = 0;
+            return( 0 );
+        }
+    }
+    stream->idat_remaining--;
+    *out = stream->input[ stream->input_pos++ ];
+    return( 1 );
+}
+
+/**
+ * @brief position the file at the first IDAT data and start the inflate stream
+ */
+static bool png_stream_rewind( png_stream_t *stream ) {
+    /*
+     * the chunk reader skips the 4 crc bytes in front of each chunk header
+     */
+    if ( fseek( stream->file, stream->idat_pos - 4, SEEK_SET ) ) {
+        return( false );
+    }
+    stream->idat_remaining = 0;
+    stream->input_pos = stream->input_len = 0;
+    stream->next_y = 0;
+    memset( &stream->inflate, 0, sizeof( stream->inflate ) );
+    memset( stream->dict, 0, stream->dict_size );
+    memset( stream->prev, 0, stream->row_bytes + 1 );
+    stream->inflate.readSourceByte = png_stream_read_byte;
+    uzlib_uncompress_init( &stream->inflate, stream->dict, stream->dict_size );
+    int window = uzlib_zlib_parse_header( &stream->inflate );
+    if ( window < 0 || ( 1u << ( window + 8 ) ) > stream->dict_size ) {
+        return( false );
+    }
+    return( true );
+}
+
+png_stream_t *png_stream_open( const char *filename ) {
+    uint8_t header[ 33 ];
+    uint8_t trns[ 256 ];
+    uint32_t trns_len = 0;
+
+    FILE *file = fopen( filename, "rb" );
+    if ( file == NULL ) {
+        return( NULL );
+    }
+    /*
+     * signature and IHDR
+     */
+    if ( fread( header, 1, sizeof( header ), file ) != sizeof( header ) || memcmp( header, png_stream_signature, sizeof( png_stream_signature ) ) || memcmp( &header[ 12 ], "IHDR", 4 ) ) {
+        fclose( file );
+        return( NULL );
+    }
+    uint32_t width = png_stream_be32( &header[ 16 ] );
+    uint32_t height = png_stream_be32( &header[ 20 ] );
+    uint8_t depth = header[ 24 ];
+    uint8_t color_type = header[ 25 ];
+    uint8_t interlace = header[ 28 ];
+    uint8_t bpp;
+    uint32_t row_bytes;
+    uint32_t rgba_bytes;
+
+    switch( color_type ) {
+        case 0:     bpp = 1; break;
+        case 2:     bpp = 3; break;
+        case 3:     bpp = 1; break;
+        case 4:     bpp = 2; break;
+        case 6:     bpp = 4; break;
+        default:    bpp = 0; break;
+    }
+    if ( depth != 8 || interlace != 0 || bpp == 0 ) {
+        fclose( file );
+        return( NULL );
+    }
+    /*
+     * the size comes from the file, check it before anything is allocated
+     */
+    if ( width == 0 || height == 0 || width > PNG_STREAM_MAX_SIZE || height > PNG_STREAM_MAX_SIZE
+      || !png_stream_mul( width, bpp, &row_bytes ) || !png_stream_mul( width, 4, &rgba_bytes ) ) {
+        fclose( file );
+        return( NULL );
+    }
+
+    png_stream_t *stream = (png_stream_t *)CALLOC( sizeof( png_stream_t ), 1 );
+    if ( stream == NULL ) {
+        fclose( file );
+        return( NULL );
+    }
+    stream->file = file;
+    stream->width = width;
+    stream->height = height;
+    stream->color_type = color_type;
+    stream->bpp = bpp;
+    stream->row_bytes = row_bytes;
+    /*
+     * read PLTE and tRNS until the first IDAT
+     */
+    while( true ) {
+        uint8_t chunk[ 8 ];
+        if ( fread( chunk, 1, sizeof( chunk ), file ) != sizeof( chunk ) ) {
+            png_stream_close( stream );
+            return( NULL );
+        }
+        uint32_t len = png_stream_be32( chunk );
+        if ( !memcmp( &chunk[ 4 ], "IDAT", 4 ) ) {
+            stream->idat_pos = ftell( file ) - 8;
+            break;
+        }
+        if ( !memcmp( &chunk[ 4 ], "PLTE", 4 ) && len <= 256 * 3 ) {
+            uint8_t rgb[ 3 ];
+            for( uint32_t i = 0 ; i < len / 3 ; i++ ) {
+                if ( fread( rgb, 1, 3, file ) != 3 ) {
+                    break;
+                }
+                stream->palette[ i * 4 + 0 ] = rgb[ 0 ];
+                stream->palette[ i * 4 + 1 ] = rgb[ 1 ];
+                stream->palette[ i * 4 + 2 ] = rgb[ 2 ];
+                stream->palette[ i * 4 + 3 ] = 0xff;
+            }
+            fseek( file, 4, SEEK_CUR );
+        }
+        else if ( !memcmp( &chunk[ 4 ], "tRNS", 4 ) && len <= sizeof( trns ) && color_type == 3 ) {
+            trns_len = fread( trns, 1, len, file );
+            fseek( file, 4, SEEK_CUR );
+        }
+        else if ( !memcmp( &chunk[ 4 ], "tRNS", 4 ) && ( ( color_type == 0 && len == 2 ) || ( color_type == 2 && len == 6 ) ) ) {
+            /*
+             * 16 bit big endian samples, the low byte is the 8 bit value
+             */
+            if ( fread( trns, 1, len, file ) == len ) {
+                for( uint32_t i = 0 ; i < len / 2 ; i++ ) {
+                    stream->trns_key[ i ] = trns[ i * 2 + 1 ];
+                }
+                stream->has_trns_key = true;
+            }
+            fseek( file, 4, SEEK_CUR );
+        }
+        else {
+            fseek( file, len + 4, SEEK_CUR );
+        }
+    }
+    for( uint32_t i = 0 ; i < trns_len ; i++ ) {
+        stream->palette[ i * 4 + 3 ] = trns[ i ];
+    }
+    /*
+     * two rows for unfiltering, one rgba row and the inflate window
+     */
+    stream->dict_size = 32768;
+    stream->row = (uint8_t *)MALLOC( stream->row_bytes + 1 );
+    stream->prev = (uint8_t *)MALLOC( stream->row_bytes + 1 );
+    stream->rgba = (uint8_t *)MALLOC( rgba_bytes );
+    stream->dict = (uint8_t *)MALLOC( stream->dict_size );
+    stream->size = sizeof( png_stream_t ) + ( stream->row_bytes + 1 ) * 2 + rgba_bytes + stream->dict_size;
+    if ( stream->row == NULL || stream->prev == NULL || stream->rgba == NULL || stream->dict == NULL || !png_stream_rewind( stream ) ) {
+        png_stream_close( stream );
+        return( NULL );
+    }
+    return( stream );
+}
+
+static uint8_t png_stream_paeth( uint8_t a, uint8_t b, uint8_t c ) {
+    int16_t p = a + b - c;
+    int16_t pa = abs( p - a );
+    int16_t pb = abs( p - b );
+    int16_t pc = abs( p - c );
+
+    if ( pa <= pb && pa <= pc ) {
+        return( a );
+    }
+    return( pb <= pc ? b : c );
+}
+
+/**
+ * @brief inflate and unfilter the next row into stream->row
+ */
+static bool png_stream_next_row( png_stream_t *stream ) {
+    uint8_t *row = stream->row + 1;
+    uint8_t *prev = stream->prev + 1;
+    uint32_t bpp = stream->bpp;
+
+    stream->inflate.dest = stream->row;
+    stream->inflate.destStart = stream->row;
+    stream->inflate.destSize = stream->row_bytes + 1;
+    int res = uzlib_uncompress_chksum( &stream->inflate );
+    if ( res < 0 || stream->inflate.dest != stream->row + stream->row_bytes + 1 ) {
+        return( false );
+    }
+
+    switch( stream->row[ 0 ] ) {
+        case 0:
+            break;
+        case 1:
+            for( uint32_t i = bpp ; i < stream->row_bytes ; i++ ) {
+                row[ i ] += row[ i - bpp ];
+            }
+            break;
+        case 2:
+            for( uint32_t i = 0 ; i < stream->row_bytes ; i++ ) {
+                row[ i ] += prev[ i ];
+            }
+            break;
+        case 3:
+            for( uint32_t i = 0 ; i < stream->row_bytes ; i++ ) {
+                row[ i ] += ( ( i >= bpp ? row[ i - bpp ] : 0 ) + prev[ i ] ) >> 1;
+            }
+            break;
+        case 4:
+            for( uint32_t i = 0 ; i < stream->row_bytes ; i++ ) {
+                row[ i ] += png_stream_paeth( i >= bpp ? row[ i - bpp ] : 0, prev[ i ], i >= bpp ? prev[ i - bpp ] : 0 );
+            }
+            break;
+        default:
+            return( false );
+    }
+    /*
+     * the unfiltered row is the previous row of the next one
+     */
+    uint8_t *swap = stream->prev;
+    stream->prev = stream->row;
+    stream->row = swap;
+    stream->next_y++;
+    return( true );
+}
+
+const uint8_t *png_stream_read_row( png_stream_t *stream, uint32_t y ) {
+    if ( stream == NULL || y >= stream->height ) {
+        return( NULL );
+    }
+    if ( y + 1 < stream->next_y && !png_stream_rewind( stream ) ) {
+        return( NULL );
+    }
+    /*
+     * the last decoded row is kept in stream->prev
+     */
+    while( stream->next_y <= y ) {
+        if ( !png_stream_next_row( stream ) ) {
+            return( NULL );
+        }
+    }
+    if ( y != stream->next_y - 1 ) {
+        return( NULL );
+    }
+    /*
+     * convert to rgba8888
+     */
+    const uint8_t *src = stream->prev + 1;
+    uint8_t *rgba = stream->rgba;
+    for( uint32_t x = 0 ; x < stream->width ; x++ ) {
+        switch( stream->color_type ) {
+            case 0:
+                rgba[ 0 ] = rgba[ 1 ] = rgba[ 2 ] = src[ 0 ];
+                rgba[ 3 ] = ( stream->has_trns_key && src[ 0 ] == stream->trns_key[ 0 ] ) ? 0 : 0xff;
+                break;
+            case 2:
+                rgba[ 0 ] = src[ 0 ];
+                rgba[ 1 ] = src[ 1 ];
+                rgba[ 2 ] = src[ 2 ];
+                rgba[ 3 ] = ( stream->has_trns_key && !memcmp( src, stream->trns_key, 3 ) ) ? 0 : 0xff;
+                break;
+            case 3:
+                memcpy( rgba, &stream->palette[ src[ 0 ] * 4 ], 4 );
+                break;
+            case 4:
+                rgba[ 0 ] = rgba[ 1 ] = rgba[ 2 ] = src[ 0 ];
+                rgba[ 3 ] = src[ 1 ];
+                break;
+            case 6:
+                memcpy( rgba, src, 4 );
+                break;
+        }
+        src += stream->bpp;
+        rgba += 4;
+    }
+    return( stream->rgba );
+}
+
+void png_stream_close( png_stream_t *stream ) {
+    if ( stream == NULL ) {
+        return;
+    }
+    if ( stream->file ) {
+        fclose( stream->file );
+    }
+    free( stream->row );
+    free( stream->prev );
+    free( stream->rgba );
+    free( stream->dict );
+    free( stream );
+}
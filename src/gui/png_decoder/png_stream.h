@@ -0,0 +1,95 @@
+/****************************************************************************
+ *   Oct 18 16:05:12 2026
+ *   Copyright  2026  My-TTGO-Watch contributors
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#ifndef _PNG_STREAM_H
+    #define _PNG_STREAM_H
+
+    #include <stdint.h>
+    #include <stdbool.h>
+    #include <stdio.h>
+
+    #include "utils/ESP32-targz/uzlib/uzlib.h"
+
+    #define PNG_STREAM_INPUT_SIZE       512         /** @brief file read buffer size */
+    #define PNG_STREAM_MAX_SIZE         2047        /** @brief max width and height, the 11 bit limit of lv_img_header_t */
+
+    /**
+     * @brief row streaming png decoder state
+     */
+    typedef struct {
+        FILE *file;                                 /** @brief png file */
+        long idat_pos;                              /** @brief file position of the first IDAT chunk */
+        uint32_t idat_remaining;                    /** @brief bytes left in the current IDAT chunk */
+        uint8_t input[ PNG_STREAM_INPUT_SIZE ];     /** @brief file read buffer */
+        uint32_t input_pos;                         /** @brief next byte in the read buffer */
+        uint32_t input_len;                         /** @brief valid bytes in the read buffer */
+        TINF_DATA inflate;                          /** @brief uzlib inflate state */
+        uint8_t *dict;                              /** @brief inflate window */
+        uint32_t dict_size;                         /** @brief inflate window size */
+        uint32_t width;                             /** @brief image width */
+        uint32_t height;                            /** @brief image height */
+        uint8_t color_type;                         /** @brief png color type */
+        uint8_t bpp;                                /** @brief bytes per pixel */
+        uint32_t row_bytes;                         /** @brief bytes per row without filter byte */
+        uint8_t *row;                               /** @brief current filtered row, filter byte first */
+        uint8_t *prev;                              /** @brief previous unfiltered row, filter byte first */
+        uint8_t *rgba;                              /** @brief current row as rgba8888 */
+        uint32_t next_y;                            /** @brief next row to decode */
+        uint8_t palette[ 256 * 4 ];                 /** @brief rgba palette for color type 3 */
+        uint8_t trns_key[ 3 ];                      /** @brief transparent gray or rgb value for color type 0 and 2 */
+        bool has_trns_key;                          /** @brief trns_key is valid */
+        uint32_t size;                              /** @brief allocated bytes incl. this structure */
+    } png_stream_t;
+
+    #ifdef __cplusplus
+    extern "C" {
+    #endif
+
+    /**
+     * @brief open a png file for row streaming, only non interlaced 8 bit images
+     * up to PNG_STREAM_MAX_SIZE x PNG_STREAM_MAX_SIZE are supported
+     *
+     * @param   filename    png file name
+     *
+     * @return  pointer to the stream or NULL if failed or not supported
+     */
+    png_stream_t *png_stream_open( const char *filename );
+    /**
+     * @brief decode a row, rows are decoded in order and the stream starts over
+     * if a previous row is requested
+     *
+     * @param   stream      pointer to the stream
+     * @param   y           row number
+     *
+     * @return  pointer to the row as rgba8888 or NULL if failed
+     */
+    const uint8_t *png_stream_read_row( png_stream_t *stream, uint32_t y );
+    /**
+     * @brief close the file and free all memory
+     *
+     * @param   stream      pointer to the stream
+     */
+    void png_stream_close( png_stream_t *stream );
+
+    #ifdef __cplusplus
+    }
+    #endif
+
+#endif // _PNG_STREAM_H
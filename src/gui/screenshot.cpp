@@ -22,58 +22,376 @@
 #include "config.h"
 #include "screenshot.h"
 
+#include "hardware/powermgm.h"
+#include "hardware/scheduler.h"
 #include "utils/alloc.h"
+#include "utils/bench.h"
 
-uint16_t *png;
+extern "C" {
+    #include "utils/ESP32-targz/uzlib/uzlib.h"
+}
+
+/**
+ * @brief png encoder state, only used while a capture is running
+ */
+typedef struct {
+    struct uzlib_comp comp;     /** @brief uzlib lz77 compressor with static huffman output */
+    uint8_t *window;            /** @brief filtered rows, matches can look back SCREENSHOT_WINDOW_ROWS rows */
+    uint32_t window_row;        /** @brief next row in the window */
+    uint32_t row_size;          /** @brief filter byte + rgb888 pixels */
+    uint32_t adler;             /** @brief zlib checksum over all filtered rows */
+    int32_t next_y;             /** @brief next expected display row */
+    bool failed;                /** @brief a band was not captured */
+} screenshot_encoder_t;
+
+static screenshot_encoder_t *encoder = NULL;
+static void ( *screenshot_display_flush )( lv_disp_drv_t *disp_drv, const lv_area_t *area, lv_color_t *color_p ) = NULL;
+static uint8_t *png = NULL;
+static uint32_t png_size = 0;
+static uint32_t png_len = 0;
+static bool png_ready = false;
+static bool png_overflow = false;
+static uint32_t png_copying = 0;
+static uint32_t png_shot = 0;
+static volatile uint32_t screenshot_requested = 0;
+static volatile uint32_t screenshot_request_time = 0;
+static screenshot_stats_t screenshot_stats;
+static int32_t screenshot_bench_capture = -1;
+portMUX_TYPE DRAM_ATTR screenshotMux = portMUX_INITIALIZER_UNLOCKED;
+
+static const uint8_t png_signature[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
 
 static void screenshot_disp_flush( lv_disp_drv_t *disp_drv, const lv_area_t *area, lv_color_t *color_p );
+static bool screenshot_powermgm_loop_cb( EventBits_t event, void *arg );
 
 void screenshot_setup( void ) {
-    png = (uint16_t*)MALLOC( lv_disp_get_hor_res( NULL ) * lv_disp_get_ver_res( NULL ) * sizeof( lv_color_t ) );
-    if ( png == NULL ) {
-        log_e("screenshot malloc failed");
-        while(1);
+    screenshot_bench_capture = bench_register( "screenshot capture", BENCH_NO_BUDGET );
+    powermgm_register_loop_cb( POWERMGM_WAKEUP | POWERMGM_SILENCE_WAKEUP, screenshot_powermgm_loop_cb, "powermgm screenshot loop" );
+}
+
+static bool screenshot_powermgm_loop_cb( EventBits_t event, void *arg ) {
+    if ( screenshot_requested != png_shot ) {
+        screenshot_take();
+    }
+    return( true );
+}
+
+/**
+ * @brief append data to the png buffer, the buffer grows in SCREENSHOT_CHUNK_SIZE steps
+ * up to SCREENSHOT_MAX_SIZE
+ */
+static bool screenshot_append( const void *data, uint32_t len ) {
+    if ( png == NULL || png_overflow ) {
+        return( false );
+    }
+    if ( png_len + len > SCREENSHOT_MAX_SIZE ) {
+        log_e("screenshot png larger than %d bytes", SCREENSHOT_MAX_SIZE );
+        png_overflow = true;
+        return( false );
+    }
+    if ( png_len + len > png_size ) {
+        uint32_t size = ( png_len + len + SCREENSHOT_CHUNK_SIZE - 1 ) / SCREENSHOT_CHUNK_SIZE * SCREENSHOT_CHUNK_SIZE;
+        uint8_t *buffer = (uint8_t *)REALLOC( png, size );
+        if ( buffer == NULL ) {
+            log_e("screenshot png realloc failed");
+            png_overflow = true;
+            return( false );
+        }
+        png = buffer;
+        png_size = size;
+    }
+    memcpy( png + png_len, data, len );
+    png_len += len;
+    return( true );
+}
+
+static bool screenshot_append_u32( uint32_t value ) {
+    uint8_t data[ 4 ] = { (uint8_t)( value >> 24 ), (uint8_t)( value >> 16 ), (uint8_t)( value >> 8 ), (uint8_t)value };
+    return( screenshot_append( data, sizeof( data ) ) );
+}
+
+/**
+ * @brief append a png chunk header, the crc is added by screenshot_chunk_end
+ *
+ * @return  offset of the chunk type
+ */
+static uint32_t screenshot_chunk_begin( const char *type, uint32_t len ) {
+    screenshot_append_u32( len );
+    uint32_t start = png_len;
+    screenshot_append( type, 4 );
+    return( start );
+}
+
+static void screenshot_chunk_end( uint32_t start ) {
+    if ( png_len < start ) {
+        return;
+    }
+    screenshot_append_u32( uzlib_crc32( png + start, png_len - start, 0xffffffff ) ^ 0xffffffff );
+}
+
+/**
+ * @brief move the compressed bytes from the uzlib output buffer to the png buffer
+ */
+static void screenshot_drain( void ) {
+    screenshot_append( encoder->comp.out.outbuf, encoder->comp.out.outlen );
+    encoder->comp.out.outlen = 0;
+}
+
+/**
+ * @brief convert one display row to rgb888 with png "sub" filter and compress it
+ */
+static void screenshot_encode_row( lv_color_t *color_p, int32_t width ) {
+    /*
+     * start over if the window is full, old hash entrys point into the window
+     */
+    if ( encoder->window_row == SCREENSHOT_WINDOW_ROWS ) {
+        encoder->window_row = 0;
+        memset( encoder->comp.hash_table, 0, sizeof( uzlib_hash_entry_t ) << SCREENSHOT_HASH_BITS );
+    }
+    uint8_t *row = encoder->window + encoder->window_row * encoder->row_size;
+    uint8_t *data = row;
+    uint8_t last[ 3 ] = { 0, 0, 0 };
+
+    *data++ = 1;
+    for( int32_t x = 0 ; x < width ; x++ ) {
+        lv_color32_t color;
+        color.full = lv_color_to32( color_p[ x ] );
+        *data++ = color.ch.red - last[ 0 ];
+        *data++ = color.ch.green - last[ 1 ];
+        *data++ = color.ch.blue - last[ 2 ];
+        last[ 0 ] = color.ch.red;
+        last[ 1 ] = color.ch.green;
+        last[ 2 ] = color.ch.blue;
+    }
+    uzlib_compress( &encoder->comp, row, encoder->row_size );
+    encoder->adler = uzlib_adler32( row, encoder->row_size, encoder->adler );
+    encoder->window_row++;
+    screenshot_drain();
+}
+
+static void screenshot_free_encoder( void ) {
+    if ( encoder == NULL ) {
+        return;
     }
+    free( encoder->comp.out.outbuf );
+    free( encoder->comp.hash_table );
+    free( encoder->window );
+    free( encoder );
+    encoder = NULL;
 }
 
-void screenshot_take( void ) {
-    lv_disp_drv_t driver;
-    lv_disp_t *system_disp;
+bool screenshot_take( void ) {
+    lv_disp_t *system_disp = lv_disp_get_default();
+    int32_t width = lv_disp_get_hor_res( NULL );
+    int32_t height = lv_disp_get_ver_res( NULL );
+    uint32_t shot = screenshot_requested;
+    uint32_t start = millis();
 
     log_i("take screenshot");
-    
-    system_disp = lv_disp_get_default();
-    driver.flush_cb = system_disp->driver.flush_cb;
+    /*
+     * the old png is no longer readable from here, a running copy is finished first
+     */
+    while( true ) {
+        portENTER_CRITICAL( &screenshotMux );
+        bool copying = png_copying != 0;
+        if ( !copying ) {
+            png_ready = false;
+        }
+        portEXIT_CRITICAL( &screenshotMux );
+        if ( !copying ) {
+            break;
+        }
+        delay( 1 );
+    }
+
+    uint64_t bench_start = bench_begin( screenshot_bench_capture );
+    png_len = 0;
+    png_overflow = false;
+    if ( png == NULL ) {
+        png = (uint8_t *)MALLOC( SCREENSHOT_CHUNK_SIZE );
+        png_size = png ? SCREENSHOT_CHUNK_SIZE : 0;
+    }
+    encoder = (screenshot_encoder_t *)CALLOC( sizeof( screenshot_encoder_t ), 1 );
+    if ( png == NULL || encoder == NULL ) {
+        log_e("screenshot alloc failed");
+        screenshot_free_encoder();
+        png_shot = shot;
+        bench_end( screenshot_bench_capture, bench_start );
+        return( false );
+    }
+    encoder->row_size = 1 + width * 3;
+    encoder->adler = 1;
+    encoder->comp.hash_bits = SCREENSHOT_HASH_BITS;
+    encoder->comp.dict_size = encoder->row_size * SCREENSHOT_WINDOW_ROWS;
+    encoder->comp.hash_table = (uzlib_hash_entry_t *)CALLOC( sizeof( uzlib_hash_entry_t ), 1 << SCREENSHOT_HASH_BITS );
+    encoder->window = (uint8_t *)MALLOC( encoder->comp.dict_size );
+    if ( encoder->comp.hash_table == NULL || encoder->window == NULL ) {
+        log_e("screenshot encoder alloc failed");
+        screenshot_free_encoder();
+        png_shot = shot;
+        bench_end( screenshot_bench_capture, bench_start );
+        return( false );
+    }
+    /*
+     * png header and zlib header, the IDAT length is patched at the end
+     */
+    uint8_t ihdr[ 13 ] = { 0, 0, 0, 0, 0, 0, 0, 0, 8, 2, 0, 0, 0 };
+    ihdr[ 2 ] = width >> 8;
+    ihdr[ 3 ] = width & 0xff;
+    ihdr[ 6 ] = height >> 8;
+    ihdr[ 7 ] = height & 0xff;
+    uint8_t zlib_header[ 2 ] = { 0x78, 0x01 };
+
+    screenshot_append( png_signature, sizeof( png_signature ) );
+    uint32_t chunk = screenshot_chunk_begin( "IHDR", sizeof( ihdr ) );
+    screenshot_append( ihdr, sizeof( ihdr ) );
+    screenshot_chunk_end( chunk );
+    uint32_t idat = screenshot_chunk_begin( "IDAT", 0 );
+    screenshot_append( zlib_header, sizeof( zlib_header ) );
+    zlib_start_block( &encoder->comp.out );
+    /*
+     * redraw the whole screen, each band is encoded on the way to the display
+     */
+    screenshot_display_flush = system_disp->driver.flush_cb;
     system_disp->driver.flush_cb = screenshot_disp_flush;
     lv_obj_invalidate( lv_scr_act() );
     lv_refr_now( system_disp );
-    system_disp->driver.flush_cb = driver.flush_cb;
+    system_disp->driver.flush_cb = screenshot_display_flush;
+    /*
+     * close the deflate stream and all chunks
+     */
+    zlib_finish_block( &encoder->comp.out );
+    screenshot_drain();
+    screenshot_append_u32( encoder->adler );
+    if ( png && png_len >= idat ) {
+        uint32_t idat_len = png_len - idat - 4;
+        png[ idat - 4 ] = idat_len >> 24;
+        png[ idat - 3 ] = idat_len >> 16;
+        png[ idat - 2 ] = idat_len >> 8;
+        png[ idat - 1 ] = idat_len;
+    }
+    screenshot_chunk_end( idat );
+    chunk = screenshot_chunk_begin( "IEND", 0 );
+    screenshot_chunk_end( chunk );
+
+    bool failed = encoder->failed || encoder->next_y != height || png_overflow;
+    uint32_t peak_ram = sizeof( screenshot_encoder_t ) + encoder->comp.dict_size + ( sizeof( uzlib_hash_entry_t ) << SCREENSHOT_HASH_BITS ) + encoder->comp.out.outsize + png_size;
+    screenshot_free_encoder();
+    bench_end( screenshot_bench_capture, bench_start );
+
+    if ( failed ) {
+        log_e("screenshot failed");
+        png_len = 0;
+    }
+    screenshot_stats.png_size = png_len;
+    screenshot_stats.peak_ram = peak_ram;
+    screenshot_stats.capture_ms = millis() - start;
+    screenshot_stats.captures++;
+
+    portENTER_CRITICAL( &screenshotMux );
+    png_shot = shot;
+    png_ready = !failed;
+    portEXIT_CRITICAL( &screenshotMux );
+
+    log_i("screenshot: %d bytes png, %d bytes peak ram, %dms", png_len, peak_ram, screenshot_stats.capture_ms );
+    return( !failed );
 }
 
 void screenshot_save( void ) {
+    if ( !png_ready ) {
+        log_e("no screenshot to save");
+        return;
+    }
 	if (SPIFFS.exists( SCREENSHOT_FILE_NAME )) {
 	    SPIFFS.remove( SCREENSHOT_FILE_NAME );
 	}
 
     fs::File file = SPIFFS.open( SCREENSHOT_FILE_NAME, FILE_WRITE );
-    
-    file.write( (uint8_t *)png, lv_disp_get_hor_res( NULL ) * lv_disp_get_ver_res( NULL ) * 2 );
-    file.flush();
+    if ( !file ) {
+        log_e("Can't open file: %s!", SCREENSHOT_FILE_NAME );
+        return;
+    }
+    screenshot_stats.spiffs_bytes = file.write( png, png_len );
     file.close();
 
-    log_i("save screenshot");
+    log_i("save screenshot, %d bytes", screenshot_stats.spiffs_bytes );
 }
 
-static void screenshot_disp_flush( lv_disp_drv_t *disp_drv, const lv_area_t *area, lv_color_t *color_p ) {
+uint32_t screenshot_request( void ) {
+    portENTER_CRITICAL( &screenshotMux );
+    uint32_t shot = ++screenshot_requested;
+    screenshot_request_time = millis();
+    portEXIT_CRITICAL( &screenshotMux );
+    scheduler_wakeup();
+    return( shot );
+}
+
+int32_t screenshot_copy( uint32_t shot, uint8_t **buffer ) {
+    int32_t ret = 0;
 
-    uint32_t x, y;
-    uint16_t *data = (uint16_t *)color_p;
+    *buffer = NULL;
+    portENTER_CRITICAL( &screenshotMux );
+    if ( (int32_t)( png_shot - shot ) < 0 ) {
+        /*
+         * not captured yet, give up after SCREENSHOT_TIMEOUT
+         */
+        ret = millis() - screenshot_request_time < SCREENSHOT_TIMEOUT ? SCREENSHOT_BUSY : 0;
+    }
+    else if ( png_shot == shot && png_ready ) {
+        /*
+         * screenshot_take waits with the next capture until the copy is done
+         */
+        png_copying++;
+        ret = png_len;
+    }
+    portEXIT_CRITICAL( &screenshotMux );
+    if ( ret <= 0 ) {
+        return( ret );
+    }
 
-    for(y = area->y1; y <= area->y2; y++) {
-        for(x = area->x1; x <= area->x2; x++) {
-            *(png + (y * lv_disp_get_hor_res( NULL ) + x )) = *data;
-            data++;
+    uint8_t *copy = (uint8_t *)MALLOC( ret );
+    if ( copy ) {
+        memcpy( copy, png, ret );
+    }
+    else {
+        log_e("screenshot copy alloc failed");
+        ret = 0;
+    }
+    portENTER_CRITICAL( &screenshotMux );
+    png_copying--;
+    portEXIT_CRITICAL( &screenshotMux );
+
+    *buffer = copy;
+    return( ret );
+}
+
+bool screenshot_is_pending( void ) {
+    portENTER_CRITICAL( &screenshotMux );
+    bool pending = (int32_t)( png_shot - screenshot_requested ) < 0 && millis() - screenshot_request_time < SCREENSHOT_TIMEOUT;
+    portEXIT_CRITICAL( &screenshotMux );
+    return( pending );
+}
+
+void screenshot_get_stats( screenshot_stats_t *stats ) {
+    *stats = screenshot_stats;
+}
+
+static void screenshot_disp_flush( lv_disp_drv_t *disp_drv, const lv_area_t *area, lv_color_t *color_p ) {
+    int32_t width = lv_disp_get_hor_res( NULL );
+    /*
+     * only full width bands from top to bottom can be encoded
+     */
+    if ( encoder->failed || area->x1 != 0 || area->x2 != width - 1 || area->y1 != encoder->next_y ) {
+        encoder->failed = true;
+    }
+    else {
+        for( int32_t y = area->y1 ; y <= area->y2 ; y++ ) {
+            screenshot_encode_row( color_p + ( y - area->y1 ) * width, width );
         }
-    } 
-    lv_disp_flush_ready(disp_drv);
+        encoder->next_y = area->y2 + 1;
+    }
+    /*
+     * and on the way to the display
+     */
+    screenshot_display_flush( disp_drv, area, color_p );
 }
@@ -24,42 +24,68 @@
 
     #include "config.h"
 
-    #define SCREENSHOT_FILE_NAME    "/screen.data"
+    #define SCREENSHOT_FILE_NAME        "/screen.png"       /** @brief screenshot file on spiffs */
+    #define SCREENSHOT_HASH_BITS        10                  /** @brief lz77 hash table size in bits */
+    #define SCREENSHOT_WINDOW_ROWS      8                   /** @brief number of filtered rows a match can look back */
+    #define SCREENSHOT_CHUNK_SIZE       4096                /** @brief png buffer grow size in bytes */
+    #define SCREENSHOT_MAX_SIZE         ( 240 * 240 * 2 )   /** @brief max png size in bytes, the raw rgb565 frame the png replaced, larger captures fail */
+    #define SCREENSHOT_TIMEOUT          3000                /** @brief max time in ms a web request waits for the capture, below the 5s async_tcp task watchdog */
+    #define SCREENSHOT_BUSY             -1                  /** @brief screenshot_copy return value if the capture is not finished */
+
+    /**
+     * @brief screenshot statistic
+     */
+    typedef struct {
+        uint32_t png_size;          /** @brief size of the last png in bytes */
+        uint32_t peak_ram;          /** @brief peak memory used by the last capture in bytes */
+        uint32_t spiffs_bytes;      /** @brief bytes written to spiffs by the last save */
+        uint32_t capture_ms;        /** @brief duration of the last capture */
+        uint32_t captures;          /** @brief number of captures since boot */
+    } screenshot_stats_t;
 
     /**
      * @brief setup screenshot
      */
     void screenshot_setup( void );
     /**
-     * @brief take a screenshoot an store it in psram
+     * @brief take a screenshot, the display content is png compressed band by band
+     * while it is flushed to the display, call only from the LVGL thread
+     *
+     * @return  true if success, false if failed
      */
-    void screenshot_take( void );
+    bool screenshot_take( void );
     /**
-     * @brief store a screenshoot from psram to spiffs
+     * @brief store the last screenshot as png to spiffs
      */
     void screenshot_save( void );
-
-/*
-    struct PNG_IMAGE {
-        uint8_t     png[ 8 ];
-        uint32_t    IHDR_len;
-        uint8_t     IHDR[ 4 ];
-        uint32_t    width;
-        uint32_t    height;
-        uint8_t     bitdepth;
-        uint8_t     colortype;
-        uint8_t     compression;
-        uint8_t     filter;
-        uint8_t     interlace_method;
-        uint32_t    IHDR_crc;
-        uint32_t    IDAT_len = LV_HOR_RES_MAX * LV_VER_RES_MAX * 3;
-        uint8_t     IDAT[ 4 ];
-        uint8_t     data[ LV_HOR_RES_MAX * LV_VER_RES_MAX * 3 ];
-        uint32_t    IDAT_crc;
-        uint32_t    IEND_len;
-        uint8_t     IEND[ 4 ];
-        uint32_t    IEND_crc;
-    } __attribute__((packed));
-*/
+    /**
+     * @brief request a screenshot from a other thread, it is taken in the next loop
+     *
+     * @return  screenshot number, use it with screenshot_copy
+     */
+    uint32_t screenshot_request( void );
+    /**
+     * @brief copy the png of a requested screenshot, the copy stays valid when
+     * the next screenshot is taken
+     *
+     * @param   shot        screenshot number from screenshot_request
+     * @param   buffer      pointer to the copy, free it with free()
+     *
+     * @return  png size, 0 if the capture failed, timed out, was replaced or the copy
+     *          can't be allocated, SCREENSHOT_BUSY if the capture is not finished
+     */
+    int32_t screenshot_copy( uint32_t shot, uint8_t **buffer );
+    /**
+     * @brief check if a requested screenshot is not captured yet
+     *
+     * @return  true if a capture is pending
+     */
+    bool screenshot_is_pending( void );
+    /**
+     * @brief get the screenshot statistic
+     *
+     * @param   stats       pointer to a screenshot_stats_t structure
+     */
+    void screenshot_get_stats( screenshot_stats_t *stats );
 
 #endif // _SCREENSHOT_H
\ No newline at end of file
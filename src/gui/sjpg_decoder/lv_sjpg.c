@@ -49,9 +49,14 @@
 
 #include "tjpgd.h"
 #include "lv_sjpg.h"
+#include "sjpg_convert.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <lvgl/lvgl.h>
+#include "esp_timer.h"
+#include "gui/img_cache.h"
+#include "utils/alloc.h"
+#include "utils/bench.h"
 
 /*********************
  *      DEFINES
@@ -82,9 +87,16 @@ static unsigned int input_func ( JDEC* jd, uint8_t* buff, unsigned int ndata );
 static int is_jpg( const uint8_t *raw_data );
 static void lv_sjpg_cleanup( SJPEG* sjpeg );
 static void lv_sjpg_free( SJPEG* sjpeg );
+static lv_res_t lv_sjpg_load_frame( lv_img_decoder_dsc_t * dsc, SJPEG* sjpeg, int frame );
+static void lv_sjpg_release_frame( SJPEG* sjpeg );
+static uint8_t * lv_sjpg_decode_frame( lv_img_decoder_dsc_t * dsc, SJPEG* sjpeg, int frame, uint32_t *size, uint32_t *decode_us );
+static void lv_sjpg_convert_frame( SJPEG* sjpeg, lv_color_t * native, int y0 );
+static void lv_sjpg_prefetch_task( lv_task_t * task );
  /**********************
  *  STATIC VARIABLES
  **********************/
+static int32_t sjpg_bench_decode = -1;
+static int32_t sjpg_bench_convert = -1;
 
 /**********************
  *      MACROS
@@ -100,6 +112,9 @@ void lv_split_jpeg_init( void )
     lv_img_decoder_set_open_cb( dec, decoder_open );
     lv_img_decoder_set_close_cb( dec, decoder_close );
     lv_img_decoder_set_read_line_cb( dec, decoder_read_line );
+
+    sjpg_bench_decode = bench_register( "sjpg frame decode", BENCH_NO_BUDGET );
+    sjpg_bench_convert = bench_register( "sjpg frame convert", BENCH_NO_BUDGET );
 }
 
 
@@ -705,149 +720,176 @@ static unsigned int input_func ( JDEC* jd, uint8_t* buff, unsigned int ndata )
 
 static lv_res_t decoder_read_line( lv_img_decoder_t * decoder, lv_img_decoder_dsc_t * dsc, lv_coord_t x, lv_coord_t y, lv_coord_t len, uint8_t * buf )
 {
+    SJPEG* sjpeg = ( SJPEG* ) dsc->user_data;
+    if( !sjpeg ) return LV_RES_INV;
 
-    if(dsc->src_type == LV_IMG_SRC_VARIABLE) {
-        SJPEG* sjpeg = ( SJPEG* ) dsc->user_data;
-
-
-        JRESULT rc;
-
-        int sjpeg_req_frame_index = y / sjpeg->sjpeg_single_frame_height;
-
-        /*If line not from cache, refresh cache */
-        if(sjpeg_req_frame_index != sjpeg->sjpeg_cache_frame_index) {
-            sjpeg->io.raw_sjpg_data = sjpeg->frame_base_array[ sjpeg_req_frame_index ];
-            rc = jd_prepare( sjpeg->tjpeg_jd, input_func, sjpeg->workb, (unsigned int)TJPGD_WORKBUFF_SIZE, &(sjpeg->io));
-            if(rc != JDR_OK ) return LV_RES_INV;
-            rc = jd_decomp ( sjpeg->tjpeg_jd, img_data_cb, 0);
-            if(rc != JDR_OK ) return LV_RES_INV;
-            sjpeg->sjpeg_cache_frame_index = sjpeg_req_frame_index;
-        }
-
-        //memcpy( buf, (uint8_t *)sjpeg->frame_cache + (x * 3) + ( y % sjpeg->sjpeg_single_frame_height ) * sjpeg->sjpeg_x_res*3/*2*/ , len*3/*2*/ );
+    int sjpeg_req_frame_index = y / sjpeg->sjpeg_single_frame_height;
 
-        int offset = 0;
-        uint8_t *cache = (uint8_t *)sjpeg->frame_cache + x*3 + ( y % sjpeg->sjpeg_single_frame_height ) * sjpeg->sjpeg_x_res*3;
+    /*If line not from the current frame, get the frame from the image cache or decode it */
+    if(sjpeg_req_frame_index != sjpeg->sjpeg_cache_frame_index) {
+        if( lv_sjpg_load_frame( dsc, sjpeg, sjpeg_req_frame_index ) != LV_RES_OK ) return LV_RES_INV;
+    }
 
-        #if  LV_COLOR_DEPTH == 32
+    /*The frame is already in the native color format*/
+    memcpy( buf, sjpeg->frame_native + ( x + ( y % sjpeg->sjpeg_single_frame_height ) * sjpeg->sjpeg_x_res ) * sizeof( lv_color_t ), len * sizeof( lv_color_t ) );
 
-        for( int i = 0; i < len; i++ ) {
-            buf[offset + 3] = 0xff;
-            buf[offset + 2] = *cache++;
-            buf[offset + 1] = *cache++;
-            buf[offset + 0] = *cache++;
-            offset += 4;
-        }
-
-        #elif  LV_COLOR_DEPTH == 16
+    return LV_RES_OK;
+}
 
-        for( int i = 0; i < len; i++ ) {
-            uint16_t col_16bit = (*cache++ & 0xf8) << 8;
-            col_16bit |= (*cache++ & 0xFC) << 3;
-            col_16bit |= (*cache++ >> 3);
-#ifdef LV_BIG_ENDIAN_SYSTEM
-            buf[offset++] = col_16bit >> 8;
-            buf[offset++] = col_16bit & 0xff;
-#else
-            buf[offset++] = col_16bit & 0xff;
-            buf[offset++] = col_16bit >> 8;
-#endif // LV_BIG_ENDIAN_SYSTEM
-        }
+/**
+ * Decode a frame and convert it to the native color format, decoded frames are shared
+ * through the image cache
+ * @param dsc pointer to decoder descriptor
+ * @param sjpeg pointer to the sjpeg structure
+ * @param frame frame number
+ * @return LV_RES_OK: ok; LV_RES_INV: failed
+ */
+static lv_res_t lv_sjpg_load_frame( lv_img_decoder_dsc_t * dsc, SJPEG* sjpeg, int frame )
+{
+    int previous = sjpeg->sjpeg_cache_frame_index;
 
-        #elif  LV_COLOR_DEPTH == 8
+    lv_sjpg_release_frame( sjpeg );
 
-        for( int i = 0; i < len; i++ ) {
-            uint8_t col_8bit = (*cache++ & 0xC0);
-            col_8bit |= (*cache++ & 0xe0) >> 2;
-            col_8bit |= (*cache++ & 0xe0) >> 5;
-            buf[offset++] = col_8bit;
-        }
-        #else
-            #error Unsupported LV_COLOR_DEPTH
+    const uint8_t *cached = img_cache_get( dsc->src_type, dsc->src, frame );
+    if( cached ) {
+        sjpeg->frame_native = (uint8_t *)cached;
+        sjpeg->frame_native_cached = true;
+    }
+    else {
+        uint32_t size;
+        uint32_t decode_us;
+        sjpeg->frame_native = lv_sjpg_decode_frame( dsc, sjpeg, frame, &size, &decode_us );
+        if( !sjpeg->frame_native ) return LV_RES_INV;
+        sjpeg->frame_native_cached = img_cache_put( dsc->src_type, dsc->src, frame, sjpeg->frame_native, size, decode_us );
+    }
+    sjpeg->sjpeg_cache_frame_index = frame;
 
+    /*Decode the frame in scroll direction when LVGL is idle. If the image cache can't hold a screen
+     *of frames, the prefetched frame is evicted before it is shown*/
+    uint32_t screen_frames = LV_VER_RES_MAX / sjpeg->sjpeg_single_frame_height + 2;
+    if( screen_frames * sjpeg->sjpeg_x_res * sjpeg->sjpeg_single_frame_height * sizeof( lv_color_t ) > IMG_CACHE_SIZE ) return LV_RES_OK;
 
-        #endif // LV_COLOR_DEPTH
+    sjpeg->prefetch_frame = ( previous >= 0 && frame < previous ) ? frame - 1 : frame + 1;
+    if( sjpeg->prefetch_frame >= 0 && sjpeg->prefetch_frame < sjpeg->sjpeg_total_frames && !sjpeg->prefetch_task ) {
+        sjpeg->prefetch_task = lv_task_create( lv_sjpg_prefetch_task, 0, LV_TASK_PRIO_LOWEST, dsc );
+    }
+    return LV_RES_OK;
+}
 
+/**
+ * Decode a frame and convert it to the native color format
+ * @param dsc pointer to decoder descriptor
+ * @param sjpeg pointer to the sjpeg structure
+ * @param frame frame number
+ * @param size store the size of the native frame here
+ * @param decode_us store the decode time here
+ * @return the native frame allocated with MALLOC or NULL if failed
+ */
+static uint8_t * lv_sjpg_decode_frame( lv_img_decoder_dsc_t * dsc, SJPEG* sjpeg, int frame, uint32_t *size, uint32_t *decode_us )
+{
+    JRESULT rc;
+    int64_t start = esp_timer_get_time();
 
-        return LV_RES_OK;
+    if(dsc->src_type == LV_IMG_SRC_VARIABLE) {
+        sjpeg->io.raw_sjpg_data = sjpeg->frame_base_array[ frame ];
     }
-
 #if LV_USE_FILESYSTEM
-
     else if(dsc->src_type == LV_IMG_SRC_FILE) {
-        SJPEG* sjpeg = ( SJPEG* ) dsc->user_data;
-        JRESULT rc;
-        int sjpeg_req_frame_index = y / sjpeg->sjpeg_single_frame_height;
-
-        lv_fs_file_t* lv_file_p = &(sjpeg->io.lv_file);
-        if(!lv_file_p) goto end;
-
-        /*If line not from cache, refresh cache */
-        if(sjpeg_req_frame_index != sjpeg->sjpeg_cache_frame_index) {
-            sjpeg->io.file_seek_offset = (int)(sjpeg->frame_base_offset [ sjpeg_req_frame_index ]);
-            //fseek(sjpeg->io.file,  sjpeg->io.file_seek_offset , SEEK_SET);
-            lv_fs_seek( &(sjpeg->io.lv_file), sjpeg->io.file_seek_offset );
-            rc = jd_prepare( sjpeg->tjpeg_jd, input_func, sjpeg->workb, (unsigned int)TJPGD_WORKBUFF_SIZE, &(sjpeg->io));
-            if(rc != JDR_OK ) return LV_RES_INV;
-            rc = jd_decomp ( sjpeg->tjpeg_jd, img_data_cb, 0);
-            if(rc != JDR_OK ) return LV_RES_INV;
-            sjpeg->sjpeg_cache_frame_index = sjpeg_req_frame_index;
-        }
-
-        //memcpy( buf, (uint8_t *)sjpeg->frame_cache + (x * 2) + ( y % sjpeg->sjpeg_single_frame_height ) * sjpeg->sjpeg_x_res*2 , len*2 );
-        int offset = 0;
-        uint8_t *cache = (uint8_t *)sjpeg->frame_cache + x*3 + ( y % sjpeg->sjpeg_single_frame_height ) * sjpeg->sjpeg_x_res*3;
-
-        #if LV_COLOR_DEPTH == 32
-        for( int i = 0; i < len; i++ ) {
-            buf[offset + 3] = 0xff;
-            buf[offset + 2] = *cache++;
-            buf[offset + 1] = *cache++;
-            buf[offset + 0] = *cache++;
-            offset += 4;
-        }
-
-        #elif  LV_COLOR_DEPTH == 16
-
-        for( int i = 0; i < len; i++ ) {
-            uint16_t col_8bit = (*cache++ & 0xf8) << 8;
-            col_8bit |= (*cache++ & 0xFC) << 3;
-            col_8bit |= (*cache++ >> 3);
-#ifdef LV_BIG_ENDIAN_SYSTEM
-            buf[offset++] = col_8bit >> 8;
-            buf[offset++] = col_8bit & 0xff;
-#else
-            buf[offset++] = col_8bit & 0xff;
-            buf[offset++] = col_8bit >> 8;
-#endif // LV_BIG_ENDIAN_SYSTEM
-        }
-
-        #elif  LV_COLOR_DEPTH == 8
+        sjpeg->io.file_seek_offset = (int)(sjpeg->frame_base_offset [ frame ]);
+        lv_fs_seek( &(sjpeg->io.lv_file), sjpeg->io.file_seek_offset );
+    }
+#endif // LV_USE_FILESYSTEM
+    else {
+        return NULL;
+    }
 
-        for( int i = 0; i < len; i++ ) {
-            uint8_t col_8bit = (*cache++ & 0xC0);
-            col_8bit |= (*cache++ & 0xe0) >> 2;
-            col_8bit |= (*cache++ & 0xe0) >> 5;
-            buf[offset++] = col_8bit;
-        }
+    rc = jd_prepare( sjpeg->tjpeg_jd, input_func, sjpeg->workb, (unsigned int)TJPGD_WORKBUFF_SIZE, &(sjpeg->io));
+    if(rc != JDR_OK ) return NULL;
+    rc = jd_decomp ( sjpeg->tjpeg_jd, img_data_cb, 0);
+    if(rc != JDR_OK ) return NULL;
 
-        #else
-            #error Unsupported LV_COLOR_DEPTH
+    *size = sjpeg->sjpeg_x_res * sjpeg->sjpeg_single_frame_height * sizeof( lv_color_t );
+    uint8_t *native = MALLOC( *size );
+    if( !native ) return NULL;
 
+    uint64_t bench_start = bench_begin( sjpg_bench_convert );
+    lv_sjpg_convert_frame( sjpeg, (lv_color_t *)native, frame * sjpeg->sjpeg_single_frame_height );
+    bench_end( sjpg_bench_convert, bench_start );
 
-        #endif // LV_COLOR_DEPTH
+    *decode_us = esp_timer_get_time() - start;
+    bench_add( sjpg_bench_decode, *decode_us );
+    return native;
+}
 
+/**
+ * Convert the decoded RGB888 frame to the native color format
+ * @param sjpeg pointer to the sjpeg structure
+ * @param native the native frame
+ * @param y0 image row of the first frame row, used for the dither pattern
+ */
+static void lv_sjpg_convert_frame( SJPEG* sjpeg, lv_color_t * native, int y0 )
+{
+    const uint8_t *cache = sjpeg->frame_cache;
+    uint32_t px_cnt = sjpeg->sjpeg_x_res * sjpeg->sjpeg_single_frame_height;
 
-        return LV_RES_OK;
+#if LV_COLOR_DEPTH == 16 && LV_COLOR_16_SWAP == 0 && !defined( LV_BIG_ENDIAN_SYSTEM )
+#if LV_SJPG_DITHER
+    (void)px_cnt;
+    sjpg_convert_rgb565_dither( cache, (uint16_t *)native, sjpeg->sjpeg_x_res, sjpeg->sjpeg_single_frame_height, y0 );
+#else
+    (void)y0;
+    sjpg_convert_rgb565( cache, (uint16_t *)native, px_cnt );
+#endif // LV_SJPG_DITHER
+#else
+    /*Other color formats pixel by pixel*/
+    (void)y0;
+    for( uint32_t i = 0; i < px_cnt; i++ ) {
+        *native++ = lv_color_make( cache[ 0 ], cache[ 1 ], cache[ 2 ] );
+        cache += 3;
     }
-#endif // LV_USE_FS_IF
-
-end:
-
-return LV_RES_INV;
-
+#endif
+}
 
+/**
+ * Decode the prefetch frame into the image cache, runs once when LVGL is idle
+ * @param task the prefetch task, user_data is the decoder descriptor
+ */
+static void lv_sjpg_prefetch_task( lv_task_t * task )
+{
+    lv_img_decoder_dsc_t * dsc = task->user_data;
+    SJPEG* sjpeg = ( SJPEG* ) dsc->user_data;
+    uint32_t size;
+    uint32_t decode_us;
+
+    lv_task_del( task );
+    sjpeg->prefetch_task = NULL;
+
+    /*Nothing to do if the frame is already cached*/
+    if( img_cache_contains( dsc->src_type, dsc->src, sjpeg->prefetch_frame ) ) return;
+    uint8_t *native = lv_sjpg_decode_frame( dsc, sjpeg, sjpeg->prefetch_frame, &size, &decode_us );
+    if( !native ) return;
+    /*The cache keeps the frame without a reference*/
+    if( img_cache_put( dsc->src_type, dsc->src, sjpeg->prefetch_frame, native, size, decode_us ) ) {
+        img_cache_release( native );
+    }
+    else {
+        free( native );
+    }
+}
 
+/**
+ * Release the current native frame
+ * @param sjpeg pointer to the sjpeg structure
+ */
+static void lv_sjpg_release_frame( SJPEG* sjpeg )
+{
+    if( sjpeg->frame_native ) {
+        if( sjpeg->frame_native_cached ) img_cache_release( sjpeg->frame_native );
+        else free( sjpeg->frame_native );
+    }
+    sjpeg->frame_native = NULL;
+    sjpeg->frame_native_cached = false;
+    sjpeg->sjpeg_cache_frame_index = -1;
 }
 
 
@@ -891,6 +933,9 @@ static int is_jpg( const uint8_t *raw_data )
 
 static void lv_sjpg_free( SJPEG* sjpeg )
 {
+    if(sjpeg->prefetch_task) lv_task_del(sjpeg->prefetch_task);
+    sjpeg->prefetch_task = NULL;
+    lv_sjpg_release_frame( sjpeg );
     if(sjpeg->frame_cache) lv_mem_free(sjpeg->frame_cache);
     if(sjpeg->frame_base_array) lv_mem_free(sjpeg->frame_base_array);
     if(sjpeg->frame_base_offset) lv_mem_free(sjpeg->frame_base_offset);
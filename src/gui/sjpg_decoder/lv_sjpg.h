@@ -22,6 +22,11 @@ extern "C" {
  *      DEFINES
  *********************/
 
+/*Ordered dithering when converting frames to 16 bit colors, trades speed for less banding*/
+#ifndef LV_SJPG_DITHER
+#define LV_SJPG_DITHER      0
+#endif
+
 
 /**********************
  *      TYPEDEFS
@@ -56,6 +61,10 @@ typedef struct {
     uint8_t **frame_base_array;         //to save base address of each split frames upto sjpeg_total_frames.
     int *frame_base_offset;             //to save base offset for fseek
     uint8_t *frame_cache;
+    uint8_t *frame_native;              //current frame in native color format, owned by the image cache if frame_native_cached
+    bool frame_native_cached;
+    int prefetch_frame;                 //next frame in scroll direction, decoded when LVGL is idle
+    lv_task_t *prefetch_task;
     uint8_t* workb;                     //JPG work buffer for jpeg library
     JDEC *tjpeg_jd;
     io_source_t io;
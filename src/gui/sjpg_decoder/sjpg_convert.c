@@ -0,0 +1,66 @@
+/**
+ * @file sjpg_convert.c
+ *
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+
+#include "sjpg_convert.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+#define SJPG_RGB565( r, g, b )      ( (uint16_t)( ( ( (r) & 0xF8 ) << 8 ) | ( ( (g) & 0xFC ) << 3 ) | ( (b) >> 3 ) ) )
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+void sjpg_convert_rgb565_px( const uint8_t * rgb888, uint16_t * rgb565, uint32_t px_cnt )
+{
+    for( uint32_t i = 0; i < px_cnt; i++ ) {
+        *rgb565++ = SJPG_RGB565( rgb888[ 0 ], rgb888[ 1 ], rgb888[ 2 ] );
+        rgb888 += 3;
+    }
+}
+
+void sjpg_convert_rgb565( const uint8_t * rgb888, uint16_t * rgb565, uint32_t px_cnt )
+{
+    /*Four pixels at once, three RGB888 words in and two RGB565 words out*/
+    if( ( (uintptr_t)rgb888 & 3 ) == 0 && ( (uintptr_t)rgb565 & 3 ) == 0 ) {
+        const uint32_t *in = (const uint32_t *)rgb888;
+        uint32_t *out = (uint32_t *)rgb565;
+        for( uint32_t i = px_cnt / 4; i > 0; i-- ) {
+            uint32_t w0 = in[ 0 ];
+            uint32_t w1 = in[ 1 ];
+            uint32_t w2 = in[ 2 ];
+            out[ 0 ] = ( ( w0 << 8 ) & 0xF800 ) | ( ( w0 >> 5 ) & 0x07E0 ) | ( ( w0 >> 19 ) & 0x001F ) |
+                       ( ( ( ( w0 >> 16 ) & 0xF800 ) | ( ( w1 << 3 ) & 0x07E0 ) | ( ( w1 >> 11 ) & 0x001F ) ) << 16 );
+            out[ 1 ] = ( ( w1 >> 8 ) & 0xF800 ) | ( ( w1 >> 21 ) & 0x07E0 ) | ( ( w2 >> 3 ) & 0x001F ) |
+                       ( ( ( w2 & 0xF800 ) | ( ( w2 >> 13 ) & 0x07E0 ) | ( ( w2 >> 27 ) & 0x001F ) ) << 16 );
+            in += 3;
+            out += 2;
+        }
+        rgb888 = (const uint8_t *)in;
+        rgb565 = (uint16_t *)out;
+        px_cnt &= 3;
+    }
+    sjpg_convert_rgb565_px( rgb888, rgb565, px_cnt );
+}
+
+void sjpg_convert_rgb565_dither( const uint8_t * rgb888, uint16_t * rgb565, uint32_t w, uint32_t h, uint32_t y0 )
+{
+    static const uint8_t bayer[ 4 ][ 4 ] = { { 0, 8, 2, 10 }, { 12, 4, 14, 6 }, { 3, 11, 1, 9 }, { 15, 7, 13, 5 } };
+
+    for( uint32_t y = 0; y < h; y++ ) {
+        for( uint32_t x = 0; x < w; x++ ) {
+            uint8_t t = bayer[ ( y0 + y ) & 3 ][ x & 3 ];
+            uint16_t r = rgb888[ 0 ] + ( t >> 1 );
+            uint16_t g = rgb888[ 1 ] + ( t >> 2 );
+            uint16_t b = rgb888[ 2 ] + ( t >> 1 );
+            *rgb565++ = SJPG_RGB565( r > 255 ? 255 : r, g > 255 ? 255 : g, b > 255 ? 255 : b );
+            rgb888 += 3;
+        }
+    }
+}
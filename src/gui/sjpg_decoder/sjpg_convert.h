@@ -0,0 +1,62 @@
+/**
+ * @file sjpg_convert.h
+ *
+ */
+
+#ifndef _SJPG_CONVERT_
+#define _SJPG_CONVERT_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+
+#include <stdint.h>
+
+/*
+ * note:    this module is plain C without lvgl dependencies,
+ *          tools/sjpg_bench.cpp builds it on the host.
+ *
+ * RGB888 rows from TJpgDec to little endian RGB565 without byte swap,
+ * the native lv_color_t of the watch.
+ */
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+
+/**
+ * Convert pixel by pixel, the reference for the other conversions
+ * @param rgb888 input pixels, 3 bytes per pixel
+ * @param rgb565 output pixels
+ * @param px_cnt number of pixels
+ */
+void sjpg_convert_rgb565_px( const uint8_t * rgb888, uint16_t * rgb565, uint32_t px_cnt );
+
+/**
+ * Convert four pixels at once, three 32 bit words in and two out, if both buffers
+ * are word aligned. the tail is converted pixel by pixel
+ * @param rgb888 input pixels, 3 bytes per pixel
+ * @param rgb565 output pixels
+ * @param px_cnt number of pixels
+ */
+void sjpg_convert_rgb565( const uint8_t * rgb888, uint16_t * rgb565, uint32_t px_cnt );
+
+/**
+ * Convert with a 4x4 ordered dither, the threshold is scaled to the lost bits of each channel
+ * @param rgb888 input pixels, 3 bytes per pixel
+ * @param rgb565 output pixels
+ * @param w width in pixels
+ * @param h height in pixels
+ * @param y0 image row of the first row, keeps the dither pattern continuous over frames
+ */
+void sjpg_convert_rgb565_dither( const uint8_t * rgb888, uint16_t * rgb565, uint32_t w, uint32_t h, uint32_t y0 );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _SJPG_CONVERT_ */
@@ -26,6 +26,7 @@
 #include "hardware/display.h"
 #include "gui/png_decoder/png_decoder.h"
 #include "gui/sjpg_decoder/lv_sjpg.h"
+#include "gui/img_cache.h"
 
 lv_obj_t *logo = NULL;
 lv_obj_t *preload = NULL;
@@ -40,7 +41,7 @@ void splash_screen_stage_one( void ) {
 
     lv_split_jpeg_init();
     png_decoder_init();
-    lv_img_cache_set_size(100);
+    lv_img_cache_set_size( IMG_CACHE_LV_ENTRYS );
 
     lv_style_init( &style );
     lv_style_set_radius( &style, LV_OBJ_PART_MAIN, 0 );
@@ -35,6 +35,7 @@
 #include "statusbar.h"
 
 #include "hardware/powermgm.h"
+#include "hardware/scheduler.h"
 #include "hardware/wifictl.h"
 #include "hardware/blectl.h"
 #include "hardware/rtcctl.h"
@@ -53,7 +54,7 @@
 #include "gui/mainbar/setup_tile/gps_settings/gps_settings.h"
 
 static bool statusbar_init = false;
-static bool statusbar_refresh_update = false;
+static volatile bool statusbar_refresh_update = false;
 
 static lv_obj_t *statusbar = NULL;
 static lv_obj_t *statusbar_wifi = NULL;
@@ -114,8 +115,8 @@ void statusbar_wifi_set_ip_state( bool state, const char *ip );
 void statusbar_bluetooth_set_state( bool state );
 void statusbar_gps_event_cb( lv_obj_t *gps, lv_event_t event );
 
-lv_task_t * statusbar_task;
-void statusbar_update_task( lv_task_t * task );
+bool statusbar_powermgm_loop_cb( EventBits_t event, void *arg );
+static void statusbar_request_refresh( void );
 
 void statusbar_setup( void )
 {
@@ -326,7 +327,7 @@ void statusbar_setup( void )
     display_register_cb( DISPLAYCTL_BRIGHTNESS, statusbar_displayctl_event_cb, "statusbar display" );
     gpsctl_register_cb( GPSCTL_ENABLE | GPSCTL_DISABLE | GPSCTL_FIX | GPSCTL_NOFIX, statusbar_gpsctl_event_cb, "statusbar gps" );
 
-    statusbar_task = lv_task_create( statusbar_update_task, 250, LV_TASK_PRIO_MID, NULL );
+    powermgm_register_loop_cb( POWERMGM_WAKEUP | POWERMGM_SILENCE_WAKEUP, statusbar_powermgm_loop_cb, "statusbar loop" );
 
     if( sound_get_available() ) {
         sound_register_cb( SOUNDCTL_ENABLED | SOUNDCTL_VOLUME, statusbar_soundctl_event_cb, "statusbar sound");
@@ -336,19 +337,28 @@ void statusbar_setup( void )
     }
 }
 
-void statusbar_update_task( lv_task_t * task ) {
+/**
+ * @brief mark the statusbar for refresh, all requests until the next loop are merged
+ */
+static void statusbar_request_refresh( void ) {
+    statusbar_refresh_update = true;
+    scheduler_wakeup();
+}
+
+bool statusbar_powermgm_loop_cb( EventBits_t event, void *arg ) {
     /*
      * check if statusbar ready
      */
     if ( !statusbar_init ) {
         log_e("statusbar not initialized");
-        return;
+        return( true );
     }
 
     if ( statusbar_refresh_update ) {
-        statusbar_refresh();
         statusbar_refresh_update = false;
+        statusbar_refresh();
     }
+    return( true );
 }
 
 bool statusbar_gpsctl_event_cb( EventBits_t event, void *arg ) {
@@ -532,7 +542,7 @@ bool statusbar_rtcctl_event_cb( EventBits_t event, void *arg ) {
             statusbar_hide_icon( STATUSBAR_ALARM );
             break;
     }
-    statusbar_refresh_update = true;
+    statusbar_request_refresh();
     return( true );
 }
 
@@ -558,7 +568,7 @@ bool statusbar_blectl_event_cb( EventBits_t event, void *arg ) {
         case BLECTL_DISCONNECT:     statusbar_style_icon( STATUSBAR_BLUETOOTH, STATUSBAR_STYLE_GRAY );
                                     break;
     }
-    statusbar_refresh_update = true;
+    statusbar_request_refresh();
     return( true );
 }
 
@@ -605,7 +615,7 @@ bool statusbar_wifictl_event_cb( EventBits_t event, void *arg ) {
                                     statusbar_show_icon( STATUSBAR_WIFI );
                                     break;
     }
-    statusbar_refresh_update = true;
+    statusbar_request_refresh();
     return( true );
 }
 
@@ -665,7 +675,7 @@ void statusbar_display_event_cb( lv_obj_t *display, lv_event_t event ){
             mainbar_jump_to_tilenumber( display_get_setup_tile_num(), LV_ANIM_OFF);
             break;
     }
-    statusbar_refresh_update = true;
+    statusbar_request_refresh();
 }
 
 void statusbar_sound_event_cb( lv_obj_t *sound, lv_event_t event ) {
@@ -695,7 +705,7 @@ void statusbar_sound_event_cb( lv_obj_t *sound, lv_event_t event ) {
             mainbar_jump_to_tilenumber( sound_get_setup_tile_num(), LV_ANIM_OFF);
             break;
     }
-    statusbar_refresh_update = true;
+    statusbar_request_refresh();
 }
 
 void statusbar_wifi_event_cb( lv_obj_t *wifi, lv_event_t event ) {
@@ -717,14 +727,14 @@ void statusbar_wifi_event_cb( lv_obj_t *wifi, lv_event_t event ) {
                                                         wifictl_set_autoon( true );
                                                         break;
             }
-            statusbar_refresh_update = true;
+            statusbar_request_refresh();
             break;
         case ( LV_EVENT_LONG_PRESSED ):             
             statusbar_expand( false );
             mainbar_jump_to_tilenumber(wifi_get_setup_tile_num(), LV_ANIM_OFF);
             break;
     }
-    statusbar_refresh_update = true;
+    statusbar_request_refresh();
 }
 
 void statusbar_gps_event_cb( lv_obj_t *gps, lv_event_t event ) {
@@ -744,12 +754,12 @@ void statusbar_gps_event_cb( lv_obj_t *gps, lv_event_t event ) {
                 case( LV_BTN_STATE_RELEASED ):          gpsctl_on();
                                                         break;
             }
-            statusbar_refresh_update = true;
+            statusbar_request_refresh();
             break;
         case ( LV_EVENT_LONG_PRESSED ):             
             statusbar_expand( false );
             mainbar_jump_to_tilenumber( gps_get_setup_tile_num() , LV_ANIM_OFF);
-            statusbar_refresh_update = true;
+            statusbar_request_refresh();
             break;
     }
 }
@@ -775,14 +785,14 @@ void statusbar_bluetooth_event_cb( lv_obj_t *bluetooth, lv_event_t event ) {
                 default:
                     break;
             }
-            statusbar_refresh_update = true;
+            statusbar_request_refresh();
             break;
         case ( LV_EVENT_LONG_PRESSED ):             
             statusbar_expand( false );
             mainbar_jump_to_tilenumber(bluetooth_get_setup_tile_num(), LV_ANIM_OFF);
             break;
     }
-    statusbar_refresh_update = true;
+    statusbar_request_refresh();
 }
 
 void statusbar_wifi_set_state( bool state, const char *wifiname ) {
@@ -850,7 +860,7 @@ void statusbar_hide_icon( statusbar_icon_t icon ) {
     }
 
     lv_obj_set_hidden( statusicon[ icon ].icon, true );
-    statusbar_refresh_update = true;
+    statusbar_request_refresh();
 }
 
 void statusbar_show_icon( statusbar_icon_t icon ) {
@@ -867,7 +877,7 @@ void statusbar_show_icon( statusbar_icon_t icon ) {
     }
 
     lv_obj_set_hidden( statusicon[ icon ].icon, false );
-    statusbar_refresh_update = true;
+    statusbar_request_refresh();
 }
 
 void statusbar_style_icon( statusbar_icon_t icon, statusbar_style_t style ) {
@@ -884,7 +894,7 @@ void statusbar_style_icon( statusbar_icon_t icon, statusbar_style_t style ) {
     }
 
     statusicon[ icon ].style = &statusbarstyle[ style ];
-    statusbar_refresh_update = true;
+    statusbar_request_refresh();
 }
 
 void statusbar_refresh( void ) {
@@ -975,7 +985,7 @@ void statusbar_expand( bool expand ) {
             should_save_sound_config = false;
         }
     }
-    statusbar_refresh_update = true;
+    statusbar_request_refresh();
 }
 
 void statusbar_hide( bool hide ) {
@@ -26,6 +26,7 @@
  */
 #include "config.h"
 #include "Arduino.h"
+#include <esp_timer.h>
 
 #include <BLEDevice.h>
 #include <BLEServer.h>
@@ -38,9 +39,12 @@
 #include "pmu.h"
 #include "powermgm.h"
 #include "callback.h"
+#include "scheduler.h"
 
-#include "utils/charbuffer.h"
 #include "utils/alloc.h"
+#include "utils/bench.h"
+#include "utils/ble_tx.h"
+#include "utils/gadgetbridge_scanner.h"
 
 #include "gui/statusbar.h"
 
@@ -48,8 +52,12 @@ EventGroupHandle_t blectl_status = NULL;
 portMUX_TYPE DRAM_ATTR blectlMux = portMUX_INITIALIZER_UNLOCKED;
 
 blectl_config_t blectl_config;
-blectl_msg_t blectl_msg;
-QueueHandle_t blectl_msg_queue;
+
+portMUX_TYPE DRAM_ATTR blectlTxMux = portMUX_INITIALIZER_UNLOCKED;
+static ble_tx_msg_t blectl_tx_control[ BLECTL_TX_CONTROL_QUEUE ];
+static ble_tx_msg_t blectl_tx_bulk[ BLECTL_TX_BULK_QUEUE ];
+static ble_tx_t blectl_tx;
+static int32_t blectl_bench_tx = -1;
 
 callback_t *blectl_callback = NULL;
 
@@ -57,33 +65,33 @@ bool blectl_send_event_cb( EventBits_t event, void *arg );
 bool blectl_powermgm_event_cb( EventBits_t event, void *arg );
 bool blectl_powermgm_loop_cb( EventBits_t event, void *arg );
 bool blectl_pmu_event_cb( EventBits_t event, void *arg );
-void blectl_send_next_msg( char *msg );
 void blectl_loop( void );
+static void blectl_tx_new_link( void );
 
 BLEServer *pServer = NULL;
 BLECharacteristic *pTxCharacteristic;
 BLECharacteristic *pRxCharacteristic;
 uint8_t txValue = 0;
 
-static CharBuffer gadgetbridge_msg;
+static gadgetbridge_scanner_t gadgetbridge_scanner;
+static int32_t blectl_bench_scan = -1;
 
 class BleCtlServerCallbacks: public BLEServerCallbacks {
     void onConnect(BLEServer* pServer, esp_ble_gatts_cb_param_t* param ) {
         pServer->updateConnParams( param->connect.remote_bda, 1450, 1500, 0, 10000 );
+        blectl_tx_new_link();
         blectl_set_event( BLECTL_AUTHWAIT );
         blectl_clear_event( BLECTL_DISCONNECT | BLECTL_CONNECT );
-        xQueueReset( blectl_msg_queue );
         blectl_send_event_cb( BLECTL_AUTHWAIT, (void *)"authwait" );
         log_i("BLE authwait");
         pServer->getAdvertising()->stop();
     };
 
     void onDisconnect(BLEServer* pServer) {
+        blectl_tx_new_link();
         blectl_set_event( BLECTL_DISCONNECT );
         blectl_clear_event( BLECTL_CONNECT | BLECTL_AUTHWAIT );
         blectl_send_event_cb( BLECTL_DISCONNECT, (void *)"disconnected" );
-        xQueueReset( blectl_msg_queue );
-        blectl_msg.active = false;
         log_i("BLE disconnected");
 
         if ( blectl_get_advertising() ) {
@@ -159,33 +167,36 @@ class BtlCtlSecurity : public BLESecurityCallbacks {
 class BleCtlCallbacks : public BLECharacteristicCallbacks
 {
     void onWrite( BLECharacteristic *pCharacteristic ) {
-        size_t msgLen = pCharacteristic->getValue().length();
-        const char *msg = pCharacteristic->getValue().c_str();
+        std::string value = pCharacteristic->getValue();
+        size_t msgLen = value.length();
+        const char *msg = value.c_str();
+        size_t pos = 0;
 
         log_i("receive %d bytes msg chunk", msgLen );
 
-        for ( int i = 0 ; i < msgLen ; i++ ) {
-            switch( msg[ i ] ) {
-                case EndofText:         gadgetbridge_msg.clear();
-                                        log_i("attention, new link establish");
-                                        blectl_send_event_cb( BLECTL_CONNECT, (void *)"connected" );
-                                        break;
-                case DataLinkEscape:    gadgetbridge_msg.clear();
-                                        log_i("attention, new message");
-                                        break;
-                case LineFeed:          {
-                                            log_i("attention, message complete");
-                                            const char *gbmsg = gadgetbridge_msg.c_str();
-                                            if( gbmsg[ 0 ] == 'G' && gbmsg[ 1 ] == 'B' ) {
-                                                log_i("gadgetbridge message identified, cut down to json");
-                                                gadgetbridge_msg.erase( gadgetbridge_msg.length() - 1 );
-                                                gbmsg += 3;
-                                            }
-                                            log_i("msg: %s", gbmsg );
-                                            blectl_send_event_cb( BLECTL_MSG, (void *)gbmsg );
-                                            break;
-                                        }
-                default:                gadgetbridge_msg.append( msg[ i ] );
+        while( pos < msgLen ) {
+            gadgetbridge_frame_t frame;
+
+            uint64_t bench_start = bench_begin( blectl_bench_scan );
+            pos += gadgetbridge_scanner_feed( &gadgetbridge_scanner, &msg[ pos ], msgLen - pos, &frame );
+            bench_end( blectl_bench_scan, bench_start );
+
+            switch( frame.event ) {
+                case GADGETBRIDGE_SCANNER_LINK:         log_i("attention, new link establish");
+                                                        blectl_send_event_cb( BLECTL_CONNECT, (void *)"connected" );
+                                                        break;
+                case GADGETBRIDGE_SCANNER_NEW_FRAME:    log_i("attention, new message");
+                                                        break;
+                case GADGETBRIDGE_SCANNER_FRAME:        log_i("attention, message complete");
+                                                        if ( frame.gadgetbridge ) {
+                                                            log_i("gadgetbridge message identified, cut down to json");
+                                                        }
+                                                        log_i("msg: %s", frame.data );
+                                                        blectl_send_event_cb( BLECTL_MSG, (void *)frame.data );
+                                                        break;
+                case GADGETBRIDGE_SCANNER_OVERFLOW:     log_e("message too long ( %d bytes ), dropped", frame.len );
+                                                        break;
+                default:                                break;
             }
         }
     }
@@ -196,6 +207,40 @@ class BleCtlCallbacks : public BLECharacteristicCallbacks
     }
 };
 
+/**
+ * @brief catch MTU, notify completion and congestion events from the gatt server
+ */
+static void blectl_gatts_event_handler( esp_gatts_cb_event_t event, esp_gatt_if_t gatts_if, esp_ble_gatts_cb_param_t *param ) {
+    switch( event ) {
+        case ESP_GATTS_MTU_EVT:
+            portENTER_CRITICAL( &blectlTxMux );
+            blectl_tx.mtu = param->mtu.mtu;
+            portEXIT_CRITICAL( &blectlTxMux );
+            log_i("BLE MTU negotiated: %d bytes", param->mtu.mtu );
+            break;
+        case ESP_GATTS_CONF_EVT:
+            portENTER_CRITICAL( &blectlTxMux );
+            ble_tx_complete( &blectl_tx );
+            portEXIT_CRITICAL( &blectlTxMux );
+            scheduler_wakeup();
+            break;
+        case ESP_GATTS_CONGEST_EVT:
+            portENTER_CRITICAL( &blectlTxMux );
+            blectl_tx.congested = param->congest.congested;
+            portEXIT_CRITICAL( &blectlTxMux );
+            scheduler_wakeup();
+            break;
+        case ESP_GATTS_DISCONNECT_EVT:
+            portENTER_CRITICAL( &blectlTxMux );
+            blectl_tx.mtu = BLE_TX_DEFAULT_MTU;
+            blectl_tx.congested = false;
+            portEXIT_CRITICAL( &blectlTxMux );
+            break;
+        default:
+            break;
+    }
+}
+
 void blectl_setup( void ) {
 
     blectl_status = xEventGroupCreate();
@@ -206,15 +251,12 @@ void blectl_setup( void ) {
     esp_bt_controller_mem_release( ESP_BT_MODE_IDLE );
     esp_bt_mem_release( ESP_BT_MODE_IDLE );
 
-    blectl_msg.active = false;
-    blectl_msg.msg = NULL;
-    blectl_msg.msglen = 0;
-    blectl_msg.msgpos = 0;
+    ble_tx_init( &blectl_tx, blectl_tx_control, BLECTL_TX_CONTROL_QUEUE, blectl_tx_bulk, BLECTL_TX_BULK_QUEUE );
 
-    blectl_msg_queue = xQueueCreate( 5, sizeof( char * ) );
-    if ( blectl_msg_queue == NULL ) {
-        log_e("Failed to allocate msg queue");
-        while(true);
+    blectl_bench_tx = bench_register( "blectl tx msg latency", BENCH_NO_BUDGET );
+    blectl_bench_scan = bench_register( "blectl frame scan", 200 );
+    if ( !gadgetbridge_scanner_init( &gadgetbridge_scanner, GADGETBRIDGE_SCANNER_SIZE ) ) {
+        log_e("Failed to allocate gadgetbridge receive buffer");
     }
 
     // Create the BLE Device
@@ -222,6 +264,8 @@ void blectl_setup( void ) {
     // This is too long I think:
     // BLEDevice::init("Espruino Gadgetbridge Compatible Device");
     BLEDevice::init("Espruino (T-Watch2020)");
+    BLEDevice::setMTU( BLECTL_TX_LOCAL_MTU );
+    BLEDevice::setCustomGattsHandler( blectl_gatts_event_handler );
     // The minimum power level (-12dbm) ESP_PWR_LVL_N12 was too low
     switch( blectl_config.txpower ) {
         case 0:             BLEDevice::setPower( ESP_PWR_LVL_N12 );
@@ -449,60 +493,67 @@ void blectl_read_config( void ) {
     blectl_config.load();
 }
 
-bool blectl_send_msg( const char *msg ) {
-    if ( blectl_get_event( BLECTL_CONNECT | BLECTL_AUTHWAIT ) ) {
-        /*
-         * Duplicate message
-         */
-        size_t len = strlen( msg );
-        char *buff = (char *)CALLOC( len + 1, 1 );
-        if ( buff == NULL ) {
-            log_e("buff calloc failed");
-            while( true );
-        }
-        strcpy( buff, msg );
-        /*
-         * Send message
-         */
-        BaseType_t ret;
-        ret = xQueueSend( blectl_msg_queue, &buff, 0);
-        /*
-         * buff will be freeed on the receive part
-         */
-        buff = NULL;
-        if ( ret != pdTRUE ) {
-            log_e("fail to send msg");
-            return false;
-        }
-        return true;
-    }
-    else {
+/**
+ * @brief copy a msg into a lane, the copy is freed after send
+ */
+static bool blectl_queue_msg( uint32_t lane, const char *msg ) {
+    ble_tx_msg_t item;
+    /*
+     * read the link first, a disconnect after the check below makes
+     * the msg an old link msg and ble_tx_push refuse it
+     */
+    portENTER_CRITICAL( &blectlTxMux );
+    item.link = blectl_tx.link;
+    portEXIT_CRITICAL( &blectlTxMux );
+
+    if ( !blectl_get_event( BLECTL_CONNECT | BLECTL_AUTHWAIT ) ) {
         log_e("msg can't send while bluetooth is not connected");
-        return false;
+        return( false );
+    }
+    /*
+     * Duplicate message
+     */
+    item.len = strlen( msg );
+    item.queued_us = esp_timer_get_time();
+    item.data = (char *)MALLOC( item.len + 1 );
+    if ( item.data == NULL ) {
+        log_e("msg alloc failed");
+        return( false );
     }
+    memcpy( item.data, msg, item.len + 1 );
+    /*
+     * Send message, msg will be freed on the receive part
+     */
+    portENTER_CRITICAL( &blectlTxMux );
+    bool queued = ble_tx_push( &blectl_tx, lane, &item );
+    portEXIT_CRITICAL( &blectlTxMux );
+    if ( !queued ) {
+        log_e("fail to send msg, queue full or link lost");
+        free( item.data );
+        return( false );
+    }
+    scheduler_wakeup();
+    return( true );
 }
 
-void blectl_send_next_msg( char *msg ) {
-    if ( !blectl_msg.active && blectl_get_event( BLECTL_CONNECT ) ) {
+bool blectl_send_msg( const char *msg ) {
+    return( blectl_queue_msg( BLE_TX_CONTROL, msg ) );
+}
 
-        if ( blectl_msg.msg == NULL ) { 
-            blectl_msg.msg = (char *)CALLOC( BLECTL_MSG_MTU, 1 );
-            if ( blectl_msg.msg == NULL ) {
-                log_e("blectl_msg.msg calloc failed");
-                while( true );
-            }
-        }
+bool blectl_send_bulk_msg( const char *msg ) {
+    return( blectl_queue_msg( BLE_TX_BULK, msg ) );
+}
 
-        strncpy( blectl_msg.msg, msg, BLECTL_MSG_MTU );
-        blectl_msg.active = true;
-        blectl_msg.msglen = strlen( (const char*)msg ) ;
-        blectl_msg.msgpos = 0;
-    }
-    else {
-        log_e("blectl is send another msg or not connected");
-        blectl_send_event_cb( BLECTL_MSG_SEND_ABORT , (char*)"msg send abort, blectl is send another msg or not connected" );
-        return;
-    }
+/**
+ * @brief start a new link on connect and disconnect, called from the bt stack task.
+ * queued msg of the old link are dropped by blectl_loop, msg queued for the new
+ * link wait until the client is connected
+ */
+static void blectl_tx_new_link( void ) {
+    portENTER_CRITICAL( &blectlTxMux );
+    ble_tx_new_link( &blectl_tx );
+    portEXIT_CRITICAL( &blectlTxMux );
+    scheduler_wakeup();
 }
 
 void blectl_on( void ) {
@@ -526,68 +577,61 @@ void blectl_off( void ) {
     blectl_send_event_cb( BLECTL_OFF, (void *)NULL );
 }
 
-static void blectl_send_chunk ( int32_t len ) {
-    // Send
-    pTxCharacteristic->setValue( (unsigned char*)&blectl_msg.msg[ blectl_msg.msgpos ], len );
+static void blectl_send_chunk ( const ble_tx_out_t *out ) {
+    pTxCharacteristic->setValue( (unsigned char*)out->chunk, out->len );
     pTxCharacteristic->notify();
 
-    char chunk_msg[ 64 ] = "";
-    for( int i = 0 ; i < len ; i++ ) {
-        if ( blectl_msg.msg[ blectl_msg.msgpos + i ] > 0x1F ) {
-            chunk_msg[ i ] = blectl_msg.msg[ blectl_msg.msgpos + i ];
-        }
-        else {
-            chunk_msg[ i ] = '?';
-        }
-    }
-    chunk_msg[ len ] = '\0';
-    log_d("send %2dbyte [ \"%s\" ] chunk", len, chunk_msg );
+    log_d("send %3dbyte chunk, %d/%d", out->len, out->pos, blectl_tx.active.len );
+}
+
+/**
+ * @brief finish a msg and free it
+ */
+static void blectl_finish_msg( ble_tx_msg_t *msg ) {
+    uint32_t us = esp_timer_get_time() - msg->queued_us;
+
+    bench_add( blectl_bench_tx, us );
+    log_d("msg send, %d bytes in %dus", msg->len, us );
+
+    free( msg->data );
+    blectl_send_event_cb( BLECTL_MSG_SEND_SUCCESS , (char*)"msg send success" );
 }
 
 void blectl_loop ( void ) {
-    static uint64_t nextmillis = 0;
+    uint64_t start = esp_timer_get_time();
 
-    if ( !blectl_get_event( BLECTL_CONNECT ) ) {
-        return;
-    }
+    do {
+        ble_tx_out_t out;
+        bool ready = blectl_get_event( BLECTL_CONNECT );
 
-    if ( !blectl_msg.active ) {
-        // Retrieve next message
-        char *msg;
-        BaseType_t available;
-        available = xQueueReceive( blectl_msg_queue, &msg, 0);
-        if ( available == pdTRUE ) {
-            blectl_send_next_msg( msg );
-            free( msg );
-        }
-    }
+        portENTER_CRITICAL( &blectlTxMux );
+        uint32_t timeouts = blectl_tx.timeouts;
+        blectl_tx.ready = ready;
+        ble_tx_result_t result = ble_tx_poll( &blectl_tx, millis(), &out );
+        timeouts = blectl_tx.timeouts - timeouts;
+        portEXIT_CRITICAL( &blectlTxMux );
 
-    if ( blectl_msg.active && nextmillis < millis() ) {
-        nextmillis = millis() + BLECTL_CHUNKDELAY;
-        if ( blectl_msg.msgpos < blectl_msg.msglen ) {
-            if ( ( blectl_msg.msglen - blectl_msg.msgpos ) > BLECTL_CHUNKSIZE ) {
-                blectl_send_chunk ( BLECTL_CHUNKSIZE );
-                blectl_msg.msgpos += BLECTL_CHUNKSIZE;
-            }
-            else if ( ( blectl_msg.msglen - blectl_msg.msgpos ) > 0 ) {
-                blectl_send_chunk ( blectl_msg.msglen - blectl_msg.msgpos );
-                blectl_send_event_cb( BLECTL_MSG_SEND_SUCCESS , (char*)"msg send success" );
-                blectl_msg.active = false;
-                blectl_msg.msglen = 0;
-                blectl_msg.msgpos = 0;
-            }
-            else {
-                log_e("malformed chunksize");
-                blectl_send_event_cb( BLECTL_MSG_SEND_ABORT , (char*)"msg send abort, malformed chunksize" );
-                blectl_msg.active = false;
-                blectl_msg.msglen = 0;
-                blectl_msg.msgpos = 0;
-            }
+        if ( timeouts ) {
+            log_w("no notify completion, restore credits");
         }
-        else {
-            blectl_msg.active = false;
-            blectl_msg.msglen = 0;
-            blectl_msg.msgpos = 0;
+        switch( result ) {
+            case BLE_TX_CHUNK:      blectl_send_chunk( &out );
+                                    break;
+            case BLE_TX_DONE:       blectl_finish_msg( &out.msg );
+                                    break;
+            case BLE_TX_DROPPED:    log_w("msg of an old link dropped, %d bytes", out.msg.len );
+                                    free( out.msg.data );
+                                    break;
+            case BLE_TX_WAIT:       /*
+                                     * wait for the next completion event or end of congestion
+                                     */
+                                    scheduler_set_deadline( BLE_TX_TIMEOUT );
+                                    return;
+            default:                return;
         }
-    }
+    } while( esp_timer_get_time() - start < BLECTL_TX_LOOP_BUDGET_US );
+    /*
+     * loop budget exceeded, continue with the next loop
+     */
+    scheduler_set_deadline( 0 );
 }
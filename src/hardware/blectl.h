@@ -88,23 +88,11 @@
     #define BATTERY_POWER_STATE_LEVEL_GOOD                  0x80
     #define BATTERY_POWER_STATE_LEVEL_CRITICALLY_LOW        0xC0
 
-    #define EndofText               0x03
-    #define LineFeed                0x0a
-    #define DataLinkEscape          0x10
+    #define BLECTL_TX_LOCAL_MTU         517     /** @brief max ATT MTU offered to the client */
+    #define BLECTL_TX_LOOP_BUDGET_US    4000    /** @brief max time in us for sending chunks in one loop */
+    #define BLECTL_TX_CONTROL_QUEUE     8       /** @brief queue depth for control msg */
+    #define BLECTL_TX_BULK_QUEUE        16      /** @brief queue depth for bulk msg */
 
-    #define BLECTL_CHUNKSIZE        20      /** @brief chunksize for send msg */
-    #define BLECTL_CHUNKDELAY       20      /** @brief chunk delay in ms for each msg chunk */
-    #define BLECTL_MSG_MTU          512     /** @brief max msg size */
-
-    /**
-     * @brief blectl send msg structure
-     */
-    typedef struct {
-        char *msg;                      /** @brief pointer to an sending msg */
-        bool active;                    /** @brief send msg structure active */
-        int32_t msglen;                 /** @brief msg lenght */
-        int32_t msgpos;                 /** @brief msg postition for next send */
-    } blectl_msg_t;
     /**
      * @brief ble setup function
      */
@@ -198,11 +186,23 @@
      */
     void blectl_update_battery( int32_t percent, bool charging, bool plug );
     /**
-     * @brief send an message over bluettoth to gadgetbridge
+     * @brief send an message over bluettoth to gadgetbridge, control msg are
+     * send before any bulk msg, msg length is not limited
      * 
      * @param   msg     pointer to a string
+     *
+     * @return  true if queued, false if failed
      */
     bool blectl_send_msg( const char *msg );
+    /**
+     * @brief send an bulk message like step or battery sync over bluettoth to
+     * gadgetbridge, bulk msg are send when no control msg is waiting
+     * 
+     * @param   msg     pointer to a string
+     *
+     * @return  true if queued, false if failed
+     */
+    bool blectl_send_bulk_msg( const char *msg );
     /**
      * @brief set the transmission power
      * 
@@ -26,10 +26,13 @@
 #include <soc/rtc.h>
 
 #include "bma.h"
+#include "bma_fifo.h"
 #include "powermgm.h"
 #include "callback.h"
+#include "scheduler.h"
 
 #include "gui/statusbar.h"
+#include "utils/bench.h"
 
 volatile bool DRAM_ATTR bma_irq_flag = false;
 portMUX_TYPE DRAM_ATTR BMA_IRQ_Mux = portMUX_INITIALIZER_UNLOCKED;
@@ -46,11 +49,20 @@ callback_t *bma_callback = NULL;
 
 bool first_loop_run = true;
 
+static activity_classifier_t bma_activity;
+static int16_t bma_fifo_buffer[ ( BMA_FIFO_SIZE / BMA_FIFO_FRAME_SIZE ) * 3 ];
+static uint32_t bma_fifo_last_poll = 0;
+static uint64_t bma_activity_cpu_us = 0;
+static int32_t bma_bench_fifo_drain = -1;
+static int32_t bma_bench_activity_classify = -1;
+
 void IRAM_ATTR bma_irq( void );
 bool bma_send_event_cb( EventBits_t event, void *arg );
 bool bma_powermgm_event_cb( EventBits_t event, void *arg );
 bool bma_powermgm_loop_cb( EventBits_t event, void *arg );
 void bma_notify_stepcounter( void );
+static bool bma_read_interrupt( void );
+static void bma_drain_fifo( void );
 
 void bma_setup( void ) {
     TTGOClass *ttgo = TTGOClass::getWatch();
@@ -69,6 +81,12 @@ void bma_setup( void ) {
      * load config from json
      */
     bma_config.load();
+    /*
+     * init activity classifier
+     */
+    activity_classifier_init( &bma_activity );
+    bma_bench_fifo_drain = bench_register( "bma fifo drain", BENCH_NO_BUDGET );
+    bma_bench_activity_classify = bench_register( "activity classify", BENCH_NO_BUDGET );
     /*
      * init stepcounter
      */
@@ -126,8 +144,7 @@ bool bma_powermgm_loop_cb( EventBits_t event , void *arg ) {
     /*
      * check interrupts event source
      */
-    if ( temp_bma_irq_flag ) {                
-        while( !ttgo->bma->readInterrupt() );
+    if ( temp_bma_irq_flag && bma_read_interrupt() ) {
         /*
          * set powermgm wakeup event and save BMA_* event
          */
@@ -143,6 +160,14 @@ bool bma_powermgm_loop_cb( EventBits_t event , void *arg ) {
             BMA_stepcounter = true;
         }
     }
+    /*
+     * drain the fifo on the watermark interrupt, the poll catches a missed
+     * interrupt edge after light sleep. runs in all powermgm states
+     */
+    if ( bma_fifo_is_enabled() && ( temp_bma_irq_flag || millis() - bma_fifo_last_poll >= BMA_FIFO_POLL_INTERVAL ) ) {
+        bma_fifo_last_poll = millis();
+        bma_drain_fifo();
+    }
     /*
      * check pmu event
      */
@@ -178,6 +203,44 @@ bool bma_powermgm_loop_cb( EventBits_t event , void *arg ) {
     return( true );
 }
 
+static bool bma_read_interrupt( void ) {
+    TTGOClass *ttgo = TTGOClass::getWatch();
+
+    for( int i = 0 ; i < BMA_IRQ_READ_RETRY ; i++ ) {
+        if ( ttgo->bma->readInterrupt() ) {
+            return( true );
+        }
+    }
+    log_w("read bma interrupt status failed");
+    return( false );
+}
+
+static void bma_drain_fifo( void ) {
+    bool changed = false;
+
+    uint64_t bench_start = bench_begin( bma_bench_fifo_drain );
+    int32_t frames = bma_fifo_read( bma_fifo_buffer, BMA_FIFO_SIZE / BMA_FIFO_FRAME_SIZE );
+    uint32_t drain_us = bench_end( bma_bench_fifo_drain, bench_start );
+    if ( frames <= 0 ) {
+        return;
+    }
+
+    bench_start = bench_begin( bma_bench_activity_classify );
+    for( int32_t i = 0 ; i < frames ; i++ ) {
+        int16_t *mg = &bma_fifo_buffer[ i * 3 ];
+        if ( activity_classifier_push( &bma_activity, mg[ 0 ], mg[ 1 ], mg[ 2 ] ) ) {
+            changed = true;
+        }
+    }
+    bma_activity_cpu_us += drain_us + bench_end( bma_bench_activity_classify, bench_start );
+
+    if ( changed ) {
+        uint32_t activity = bma_activity.activity;
+        log_i("activity: %s (std %dmg, cadence %d.%02dHz)", activity_classifier_get_name( activity ), bma_activity.features.std_mg, bma_activity.features.cadence / 100, bma_activity.features.cadence % 100 );
+        bma_send_event_cb( BMACTL_ACTIVITY, &activity );
+    }
+}
+
 void bma_notify_stepcounter( void ) {
     uint32_t val = 0;
     TTGOClass *ttgo = TTGOClass::getWatch();
@@ -263,12 +326,24 @@ void bma_reload_settings( void ) {
     ttgo->bma->enableStepCountInterrupt( bma_config.enable[ BMA_STEPCOUNTER ] );
     ttgo->bma->enableWakeupInterrupt( bma_config.enable[ BMA_DOUBLECLICK ] );
     ttgo->bma->enableTiltInterrupt( bma_config.enable[ BMA_TILT ] );
+    /*
+     * fifo batch acquisition for the activity classifier
+     */
+    if ( bma_config.enable[ BMA_ACTIVITY ] ) {
+        if ( !bma_fifo_is_enabled() && !bma_fifo_enable() ) {
+            log_e("activity classification disabled, fifo setup failed");
+        }
+    }
+    else {
+        bma_fifo_disable();
+    }
 }
 
 void IRAM_ATTR bma_irq( void ) {
     portENTER_CRITICAL_ISR(&BMA_IRQ_Mux);
     bma_irq_flag = true;
     portEXIT_CRITICAL_ISR(&BMA_IRQ_Mux);
+    scheduler_wakeup_from_isr();
 }
 
 bool bma_register_cb( EventBits_t event, CALLBACK_FUNC callback_func, const char *id ) {
@@ -363,3 +438,20 @@ void bma_reset_stepcounter( void ) {
      */
     bma_notify_stepcounter();
 }
+
+uint32_t bma_get_activity( void ) {
+    return( bma_activity.activity );
+}
+
+const activity_classifier_t *bma_get_activity_classifier( void ) {
+    return( &bma_activity );
+}
+
+uint32_t bma_get_activity_cpu_us( void ) {
+    const bma_fifo_stats_t *stats = bma_fifo_get_stats();
+
+    if ( stats->frames < BMA_FIFO_RATE ) {
+        return( 0 );
+    }
+    return( bma_activity_cpu_us * BMA_FIFO_RATE / stats->frames );
+}
@@ -25,12 +25,17 @@
     #include "TTGO.h"
     #include "callback.h"
     #include "hardware/config/bmaconfig.h"
+    #include "utils/activity_classifier.h"
     
     #define BMACTL_EVENT_INT            _BV(0)              /** @brief event mask for bma interrupt */
     #define BMACTL_DOUBLECLICK          _BV(1)              /** @brief event mask for an doubleclick event */
     #define BMACTL_STEPCOUNTER          _BV(2)              /** @brief event mask for an stepcounter update event, callback arg is (uint32*) */
     #define BMACTL_STEPCOUNTER_RESET    _BV(3)              /** @brief event mask for an stepcounter reset event */
     #define BMACTL_TILT                 _BV(4)              /** @brief event mask for an tilt event */
+    #define BMACTL_ACTIVITY             _BV(5)              /** @brief event mask for an activity change, callback arg is (uint32_t*) with ACTIVITY_* */
+
+    #define BMA_IRQ_READ_RETRY          3                   /** @brief max tries to read the interrupt status */
+    #define BMA_FIFO_POLL_INTERVAL      4000                /** @brief fifo poll interval in ms if the watermark interrupt is missed */
     /**
      * @brief setup bma activity measurement
      */
@@ -94,5 +99,25 @@
      * @brief reset the stepcounter value
      */
     void bma_reset_stepcounter( void );
+    /**
+     * @brief get the current activity from the fifo classifier
+     *
+     * @return  ACTIVITY_STILL...ACTIVITY_SLEEP
+     */
+    uint32_t bma_get_activity( void );
+    /**
+     * @brief get the activity classifier state with the last window features
+     * and the time per activity
+     *
+     * @return  pointer to the classifier
+     */
+    const activity_classifier_t *bma_get_activity_classifier( void );
+    /**
+     * @brief get the cpu time for fifo drain and classification per second
+     * of accelerometer data
+     *
+     * @return  cpu time in us
+     */
+    uint32_t bma_get_activity_cpu_us( void );
     
 #endif // _BMA_H
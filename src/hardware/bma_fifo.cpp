@@ -0,0 +1,200 @@
+/****************************************************************************
+ *   Oct 18 17:21:40 2026
+ *   Copyright  2026  My-TTGO-Watch contributors
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#include "config.h"
+#include <TTGO.h>
+
+#include "bma_fifo.h"
+
+/*
+ * BMA423 registers, the TTGO BMA class has no fifo api
+ */
+#define BMA_FIFO_REG_LENGTH_0           0x24
+#define BMA_FIFO_REG_DATA               0x26
+#define BMA_FIFO_REG_ACC_CONF           0x40
+#define BMA_FIFO_REG_ACC_RANGE          0x41
+#define BMA_FIFO_REG_DOWNS              0x45
+#define BMA_FIFO_REG_WTM_0              0x46
+#define BMA_FIFO_REG_CONFIG_0           0x48
+#define BMA_FIFO_REG_CONFIG_1           0x49
+#define BMA_FIFO_REG_INT_MAP_DATA       0x58
+#define BMA_FIFO_REG_PWR_CTRL           0x7D
+#define BMA_FIFO_REG_CMD                0x7E
+
+#define BMA_FIFO_DOWNS_FILTERED         0x80            /** @brief use filtered data for the fifo */
+#define BMA_FIFO_CONFIG_1_ACC_EN        0x40            /** @brief accel frames, no header */
+#define BMA_FIFO_INT1_FWM               0x02            /** @brief watermark interrupt on INT1 */
+#define BMA_FIFO_PWR_CTRL_ACC_EN        0x04            /** @brief accelerometer enable */
+#define BMA_FIFO_CMD_FLUSH              0xB0            /** @brief clear the fifo */
+#define BMA_FIFO_ODR_25HZ               0x06            /** @brief ACC_CONF odr code for 25Hz */
+#define BMA_FIFO_EMPTY_FRAME            0x8000          /** @brief x value of an empty frame */
+
+static bool bma_fifo_enabled = false;
+static uint8_t bma_fifo_range = 0;
+static bma_fifo_stats_t bma_fifo_stats;
+
+static bool bma_fifo_read_reg( uint8_t reg, uint8_t *data, uint16_t len ) {
+    TTGOClass *ttgo = TTGOClass::getWatch();
+
+    if ( ttgo->i2c->readBytes( BMA_FIFO_I2C_ADDR, reg, data, len ) ) {
+        bma_fifo_stats.errors++;
+        return( false );
+    }
+    return( true );
+}
+
+static bool bma_fifo_write_reg( uint8_t reg, uint8_t value ) {
+    TTGOClass *ttgo = TTGOClass::getWatch();
+
+    if ( ttgo->i2c->writeBytes( BMA_FIFO_I2C_ADDR, reg, &value, 1 ) ) {
+        bma_fifo_stats.errors++;
+        return( false );
+    }
+    /*
+     * the BMA423 needs 450us between writes in advanced power save mode
+     */
+    delayMicroseconds( 450 );
+    return( true );
+}
+
+bool bma_fifo_enable( void ) {
+    uint8_t acc_conf = 0;
+    uint8_t pwr_ctrl = 0;
+    uint8_t int_map = 0;
+    uint8_t range = 0;
+
+    if ( !bma_fifo_read_reg( BMA_FIFO_REG_ACC_CONF, &acc_conf, 1 ) || !bma_fifo_read_reg( BMA_FIFO_REG_ACC_RANGE, &range, 1 ) ||
+         !bma_fifo_read_reg( BMA_FIFO_REG_PWR_CTRL, &pwr_ctrl, 1 ) || !bma_fifo_read_reg( BMA_FIFO_REG_INT_MAP_DATA, &int_map, 1 ) ) {
+        log_e("bma fifo: register read failed");
+        return( false );
+    }
+    /*
+     * downsample the feature engine odr to 25Hz, the odr is kept for the
+     * stepcounter, tilt and double click features
+     */
+    uint8_t odr = acc_conf & 0x0f;
+    uint8_t downs = odr > BMA_FIFO_ODR_25HZ ? odr - BMA_FIFO_ODR_25HZ : 0;
+    if ( downs > 7 ) {
+        downs = 7;
+    }
+    if ( odr < BMA_FIFO_ODR_25HZ ) {
+        log_w("bma fifo: odr code %d is below 25Hz", odr );
+    }
+    bma_fifo_range = range & 0x03;
+
+    bool retval = bma_fifo_write_reg( BMA_FIFO_REG_PWR_CTRL, pwr_ctrl | BMA_FIFO_PWR_CTRL_ACC_EN ) &&
+                  bma_fifo_write_reg( BMA_FIFO_REG_DOWNS, BMA_FIFO_DOWNS_FILTERED | ( downs << 4 ) ) &&
+                  bma_fifo_write_reg( BMA_FIFO_REG_WTM_0, BMA_FIFO_WATERMARK & 0xff ) &&
+                  bma_fifo_write_reg( BMA_FIFO_REG_WTM_0 + 1, ( BMA_FIFO_WATERMARK >> 8 ) & 0x1f ) &&
+                  bma_fifo_write_reg( BMA_FIFO_REG_CONFIG_0, 0x00 ) &&
+                  bma_fifo_write_reg( BMA_FIFO_REG_CONFIG_1, BMA_FIFO_CONFIG_1_ACC_EN ) &&
+                  bma_fifo_write_reg( BMA_FIFO_REG_CMD, BMA_FIFO_CMD_FLUSH ) &&
+                  bma_fifo_write_reg( BMA_FIFO_REG_INT_MAP_DATA, int_map | BMA_FIFO_INT1_FWM );
+
+    if ( !retval ) {
+        log_e("bma fifo: register write failed");
+        return( false );
+    }
+    bma_fifo_enabled = true;
+    log_i("bma fifo enabled, odr code %d, downsampling 2^%d, range %dg", odr, downs, 2 << bma_fifo_range );
+    return( true );
+}
+
+void bma_fifo_disable( void ) {
+    uint8_t int_map = 0;
+
+    if ( !bma_fifo_enabled ) {
+        return;
+    }
+    if ( bma_fifo_read_reg( BMA_FIFO_REG_INT_MAP_DATA, &int_map, 1 ) ) {
+        bma_fifo_write_reg( BMA_FIFO_REG_INT_MAP_DATA, int_map & ~BMA_FIFO_INT1_FWM );
+    }
+    bma_fifo_write_reg( BMA_FIFO_REG_CONFIG_1, 0x00 );
+    bma_fifo_write_reg( BMA_FIFO_REG_CMD, BMA_FIFO_CMD_FLUSH );
+    bma_fifo_enabled = false;
+    log_i("bma fifo disabled");
+}
+
+bool bma_fifo_is_enabled( void ) {
+    return( bma_fifo_enabled );
+}
+
+int32_t bma_fifo_get_length( void ) {
+    uint8_t length[ 2 ];
+
+    if ( !bma_fifo_read_reg( BMA_FIFO_REG_LENGTH_0, length, sizeof( length ) ) ) {
+        return( -1 );
+    }
+    return( length[ 0 ] | ( ( length[ 1 ] & 0x3f ) << 8 ) );
+}
+
+int32_t bma_fifo_read( int16_t *mg, int32_t max_frames ) {
+    uint8_t buffer[ BMA_FIFO_CHUNK_FRAMES * BMA_FIFO_FRAME_SIZE ];
+    int32_t frames = 0;
+
+    if ( !bma_fifo_enabled ) {
+        return( 0 );
+    }
+    int32_t length = bma_fifo_get_length();
+    if ( length <= 0 ) {
+        return( 0 );
+    }
+    if ( length > BMA_FIFO_SIZE - BMA_FIFO_FRAME_SIZE ) {
+        bma_fifo_stats.overruns++;
+    }
+    int32_t available = length / BMA_FIFO_FRAME_SIZE;
+    if ( available > max_frames ) {
+        available = max_frames;
+    }
+    /*
+     * drain in bursts, the data register does not auto increment
+     */
+    while( frames < available ) {
+        int32_t chunk = available - frames;
+        if ( chunk > BMA_FIFO_CHUNK_FRAMES ) {
+            chunk = BMA_FIFO_CHUNK_FRAMES;
+        }
+        if ( !bma_fifo_read_reg( BMA_FIFO_REG_DATA, buffer, chunk * BMA_FIFO_FRAME_SIZE ) ) {
+            break;
+        }
+        for( int32_t i = 0 ; i < chunk ; i++ ) {
+            uint8_t *frame = &buffer[ i * BMA_FIFO_FRAME_SIZE ];
+            if ( ( frame[ 0 ] | ( frame[ 1 ] << 8 ) ) == BMA_FIFO_EMPTY_FRAME ) {
+                available = frames;
+                break;
+            }
+            /*
+             * 12 bit left justified, 1024 lsb/g at 2g range
+             */
+            for( int32_t axis = 0 ; axis < 3 ; axis++ ) {
+                int32_t raw = (int16_t)( frame[ axis * 2 ] | ( frame[ axis * 2 + 1 ] << 8 ) ) >> 4;
+                *mg++ = ( ( raw * 1000 ) << bma_fifo_range ) >> 10;
+            }
+            frames++;
+        }
+    }
+    bma_fifo_stats.drains++;
+    bma_fifo_stats.frames += frames;
+    return( frames );
+}
+
+const bma_fifo_stats_t *bma_fifo_get_stats( void ) {
+    return( &bma_fifo_stats );
+}
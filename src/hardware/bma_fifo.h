@@ -0,0 +1,82 @@
+/****************************************************************************
+ *   Oct 18 17:21:40 2026
+ *   Copyright  2026  My-TTGO-Watch contributors
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#ifndef _BMA_FIFO_H
+    #define _BMA_FIFO_H
+
+    #include <stdint.h>
+
+    #define BMA_FIFO_I2C_ADDR           0x19                /** @brief BMA423 i2c address on the watch */
+    #define BMA_FIFO_SIZE               1024                /** @brief BMA423 fifo size in bytes */
+    #define BMA_FIFO_FRAME_SIZE         6                   /** @brief headerless accel frame, x/y/z 16 bit */
+    #define BMA_FIFO_WATERMARK          ( 100 * BMA_FIFO_FRAME_SIZE )   /** @brief watermark interrupt level, 4s at 25Hz */
+    #define BMA_FIFO_CHUNK_FRAMES       16                  /** @brief frames per i2c burst */
+    #define BMA_FIFO_RATE               25                  /** @brief fifo sample rate in Hz after downsampling */
+
+    /**
+     * @brief fifo statistic
+     */
+    typedef struct {
+        uint32_t drains;                    /** @brief number of fifo drains */
+        uint32_t frames;                    /** @brief total frames read */
+        uint32_t overruns;                  /** @brief drains with a full fifo, samples are lost */
+        uint32_t errors;                    /** @brief i2c errors */
+    } bma_fifo_stats_t;
+
+    /**
+     * @brief configure the accelerometer fifo for headerless 25Hz accel frames
+     * and map the watermark interrupt to INT1
+     *
+     * @return  true if success, false on an i2c error
+     */
+    bool bma_fifo_enable( void );
+    /**
+     * @brief disable the fifo and unmap the watermark interrupt
+     */
+    void bma_fifo_disable( void );
+    /**
+     * @brief check if the fifo is enabled
+     *
+     * @return  true if enabled
+     */
+    bool bma_fifo_is_enabled( void );
+    /**
+     * @brief get the fifo fill level
+     *
+     * @return  fill level in bytes or -1 on an i2c error
+     */
+    int32_t bma_fifo_get_length( void );
+    /**
+     * @brief read up to max_frames frames from the fifo in i2c bursts
+     *
+     * @param   mg          pointer to a buffer for max_frames x/y/z triples in mg
+     * @param   max_frames  max frames to read
+     *
+     * @return  number of frames read
+     */
+    int32_t bma_fifo_read( int16_t *mg, int32_t max_frames );
+    /**
+     * @brief get the fifo statistic
+     *
+     * @return  pointer to the statistic
+     */
+    const bma_fifo_stats_t *bma_fifo_get_stats( void );
+
+#endif // _BMA_FIFO_H
@@ -19,14 +19,38 @@
  *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
  */
 #include "config.h"
+#include <esp_timer.h>
 
 #include "callback.h"
+#include "scheduler.h"
 #include "utils/alloc.h"
+#include "utils/event_journal.h"
 
 void  display_record_event( callback_t *callback, EventBits_t event );
 
 callback_t *callback_head = NULL;
 static bool display_event_logging = false;
+/**
+ * fixed entry and subscription node pools, allocated on first use
+ */
+static callback_table_t *callback_pool = NULL;
+static uint16_t callback_pool_used = 0;
+static callback_node_t *callback_node_pool = NULL;
+static uint16_t callback_node_pool_used = 0;
+
+static bool callback_pool_alloc( void ) {
+    if ( callback_pool && callback_node_pool ) {
+        return( true );
+    }
+    callback_pool = ( callback_table_t * )CALLOC( sizeof( callback_table_t ), CALLBACK_POOL_ENTRYS );
+    callback_node_pool = ( callback_node_t * )CALLOC( sizeof( callback_node_t ), CALLBACK_POOL_NODES );
+    if ( callback_pool == NULL || callback_node_pool == NULL ) {
+        log_e("callback pool calloc failed");
+        return( false );
+    }
+    log_i("callback pool alloc success ( %d + %d bytes )", sizeof( callback_table_t ) * CALLBACK_POOL_ENTRYS, sizeof( callback_node_t ) * CALLBACK_POOL_NODES );
+    return( true );
+}
 
 void callback_print( void ) {
     /**
@@ -42,14 +66,60 @@ void callback_print( void ) {
     callback_t *callback_counter = callback_head;
     do {
         log_d(" |--%s", callback_counter->name, callback_counter );
-        for( int32_t i = 0 ; i < callback_counter->entrys ; i++ ) {
-            log_d(" |  |--id:%s, event mask:%04x", callback_counter->table[ i ].id, callback_counter->table[ i ].event );
+        for( uint16_t i = callback_counter->first_entry ; i != CALLBACK_NO_ENTRY ; i = callback_pool[ i ].next ) {
+            callback_table_t *entry = &callback_pool[ i ];
+            log_d(" |  |--id:%s, event mask:%04x, count:%llu, min:%dus, avg:%lluus, max:%dus", entry->id, entry->event, entry->counter, entry->counter ? entry->min_us : 0, entry->counter ? entry->total_us / entry->counter : 0, entry->max_us );
         }
         callback_counter = callback_counter->next_callback_t;
     }
     while ( callback_counter );
 }
 
+uint32_t callback_get_slowest( const callback_table_t **slowest, uint32_t count ) {
+    uint32_t found = 0;
+    /**
+     * insertion sort all used pool entrys by their max execution time
+     */
+    for( uint16_t i = 0 ; i < callback_pool_used ; i++ ) {
+        callback_table_t *entry = &callback_pool[ i ];
+        if ( entry->counter == 0 ) {
+            continue;
+        }
+        uint32_t pos = found < count ? found : count;
+        while( pos > 0 && slowest[ pos - 1 ]->max_us < entry->max_us ) {
+            if ( pos < count ) {
+                slowest[ pos ] = slowest[ pos - 1 ];
+            }
+            pos--;
+        }
+        if ( pos < count ) {
+            slowest[ pos ] = entry;
+            if ( found < count ) {
+                found++;
+            }
+        }
+    }
+    return( found );
+}
+
+void callback_print_slowest( uint32_t count ) {
+    const callback_table_t **slowest = ( const callback_table_t ** )CALLOC( sizeof( callback_table_t * ), count );
+    if ( slowest == NULL ) {
+        log_e("slowest table calloc failed");
+        return;
+    }
+
+    uint32_t found = callback_get_slowest( slowest, count );
+    log_i("slowest %d callback functions:", found );
+    for( uint32_t i = 0 ; i < found ; i++ ) {
+        const callback_table_t *entry = slowest[ i ];
+        log_i(" |--%s:%s, count:%llu, min:%dus, avg:%lluus, max:%dus, <100us:%d, <1ms:%d, <10ms:%d, <100ms:%d, >=100ms:%d",
+                entry->name, entry->id, entry->counter, entry->min_us, entry->total_us / entry->counter, entry->max_us,
+                entry->histogram[ 0 ], entry->histogram[ 1 ], entry->histogram[ 2 ], entry->histogram[ 3 ], entry->histogram[ 4 ] );
+    }
+    free( slowest );
+}
+
 callback_t *callback_init( const char *name ) {
     /**
      * allocate an callback table
@@ -73,7 +143,12 @@ callback_t *callback_init( const char *name ) {
          */
         callback->entrys = 0;
         callback->debug = false;
-        callback->table = NULL;
+        callback->first_entry = CALLBACK_NO_ENTRY;
+        callback->last_entry = CALLBACK_NO_ENTRY;
+        for( int bit = 0 ; bit < CALLBACK_EVENT_BITS ; bit++ ) {
+            callback->bit_head[ bit ] = CALLBACK_NO_ENTRY;
+            callback->bit_tail[ bit ] = CALLBACK_NO_ENTRY;
+        }
         callback->name = name;
         callback->next_callback_t = NULL;
         /**
@@ -101,97 +176,169 @@ bool callback_register( callback_t *callback, EventBits_t event, CALLBACK_FUNC c
         return( retval );
     }
     /**
-     * increment callback entry counter
+     * check if the pools allocated and have enough space left
      */
-    callback->entrys++;
+    if ( !callback_pool_alloc() ) {
+        return( retval );
+    }
+    if ( callback_pool_used >= CALLBACK_POOL_ENTRYS ) {
+        log_e("callback entry pool exhausted for: %s", id );
+        return( retval );
+    }
+    if ( callback_node_pool_used + __builtin_popcount( event ) > CALLBACK_POOL_NODES ) {
+        log_e("callback node pool exhausted for: %s", id );
+        return( retval );
+    }
     /**
-     * check if this entry is the first one for allocation or reallocate
+     * set new entry
      */
-    if ( callback->table == NULL ) {
-        callback->table = ( callback_table_t * )CALLOC( sizeof( callback_table_t ) * callback->entrys, 1 );
-        if ( callback->table == NULL ) {
-            log_e("callback_table_t calloc faild for: %s", id );
-            return( retval );
-        }
-        retval = true;
+    uint16_t index = callback_pool_used++;
+    callback_table_t *entry = &callback_pool[ index ];
+    entry->event = event;
+    entry->callback_func = callback_func;
+    entry->id = id;
+    entry->counter = 0;
+    entry->total_us = 0;
+    entry->min_us = UINT32_MAX;
+    entry->max_us = 0;
+    memset( entry->histogram, 0, sizeof( entry->histogram ) );
+    entry->name = callback->name;
+    entry->next = CALLBACK_NO_ENTRY;
+    /**
+     * append entry to the callback table entry chain
+     */
+    if ( callback->last_entry == CALLBACK_NO_ENTRY ) {
+        callback->first_entry = index;
     }
     else {
-        callback_table_t *new_callback_table = NULL;
-        new_callback_table = ( callback_table_t * )REALLOC( callback->table, sizeof( callback_table_t ) * callback->entrys );
-        if ( new_callback_table == NULL ) {
-            log_e("callback_table_t realloc faild for: %s", id );
-            return( retval );
-        }
-        callback->table = new_callback_table;
-        retval = true;
+        callback_pool[ callback->last_entry ].next = index;
     }
+    callback->last_entry = index;
+    callback->entrys++;
     /**
-     * set new entry
+     * append a subscription node for each event bit, entrys are allocated in
+     * ascending order, so every bit chain stay sorted by registration order
      */
-    callback->table[ callback->entrys - 1 ].event = event;
-    callback->table[ callback->entrys - 1 ].callback_func = callback_func;
-    callback->table[ callback->entrys - 1 ].id = id;
-    callback->table[ callback->entrys - 1 ].counter = 0;
+    for( int bit = 0 ; bit < CALLBACK_EVENT_BITS ; bit++ ) {
+        if ( !( event & ( 1UL << bit ) ) ) {
+            continue;
+        }
+        uint16_t node = callback_node_pool_used++;
+        callback_node_pool[ node ].entry = index;
+        callback_node_pool[ node ].next = CALLBACK_NO_ENTRY;
+        if ( callback->bit_tail[ bit ] == CALLBACK_NO_ENTRY ) {
+            callback->bit_head[ bit ] = node;
+        }
+        else {
+            callback_node_pool[ callback->bit_tail[ bit ] ].next = node;
+        }
+        callback->bit_tail[ bit ] = node;
+    }
+    retval = true;
+
     if ( callback->debug ) {
-        log_d("register callback_func for %s success (%p:%s)", callback->name, callback->table[ callback->entrys - 1 ].callback_func, callback->table[ callback->entrys - 1 ].id );
+        log_d("register callback_func for %s success (%p:%s)", callback->name, entry->callback_func, entry->id );
     }
     return( retval );
 }
 
-void display_record_event( callback_t *callback, EventBits_t event ) {
-    time_t now;
-    struct tm info;
-
-    time( &now );
-    localtime_r( &now, &info );
-
-    char event_log_filename[32];
-    size_t written = strftime(event_log_filename, sizeof(event_log_filename), "/event_log_%Y-%m-%d.csv", &info);
-    if(written == 0){
-        log_e("Can't convert time to filename" );
-        return;
+/**
+ * @brief call one callback entry and account the execution time
+ */
+static bool callback_call_entry( callback_t *callback, callback_table_t *entry, EventBits_t event, void *arg ) {
+    /**
+     * print out callback event
+     */
+    if ( callback->debug ) {
+        log_i("call %s cb (%p:%04x:%s)", callback->name, entry->callback_func, event, entry->id );
     }
-
-    bool write_header = !(SPIFFS.exists(event_log_filename));
-
-    fs::File file = SPIFFS.open( event_log_filename, FILE_APPEND );
-
-    if (!file) {
-        log_e("Can't open file: %s!", event_log_filename );
-        return;
+    /**
+     * call callback and measure the execution time
+     */
+    int64_t start = esp_timer_get_time();
+    bool retval = entry->callback_func( event, arg );
+    uint32_t us = esp_timer_get_time() - start;
+    /**
+     * increment callback counter and update execution time stats
+     */
+    entry->counter++;
+    entry->total_us += us;
+    if ( us < entry->min_us ) {
+        entry->min_us = us;
     }
-
-    if (write_header) {
-        file.println("Date\tTime\tFirmware\tUptime_ms\tCallback\tEvent\tFreeHeap\tBatt_V\tCharge_C\tDischarge_C\tBatt_%\tCharging_mA\tDischarging_mA\tPower_mW\tAXP_Temp_degC\tBMA_Temp_degC" );
+    if ( us > entry->max_us ) {
+        entry->max_us = us;
+    }
+    if ( us < 100 ) {
+        entry->histogram[ 0 ]++;
+    }
+    else if ( us < 1000 ) {
+        entry->histogram[ 1 ]++;
+    }
+    else if ( us < 10000 ) {
+        entry->histogram[ 2 ]++;
+    }
+    else if ( us < 100000 ) {
+        entry->histogram[ 3 ]++;
+    }
+    else {
+        entry->histogram[ 4 ]++;
     }
+    return( retval );
+}
 
-    if (! file.print( &info, "%F%t%T%t" ) ) {
-        log_e("Failed to append to event log file: %s!", event_log_filename );
-    } else {
-        AXP20X_Class *power = TTGOClass::getWatch()->power;
-        BMA *bma = TTGOClass::getWatch()->bma;
-        char log_line[256]="";
-        snprintf( log_line, sizeof( log_line ), "%s\t%lu\t%s\t%04x\t%u\t%0.2f\t%u\t%u\t%d\t%0.1f\t%0.1f\t%0.1f\t%0.1f\t%0.1f",
-            __FIRMWARE__,
-            millis(), 
-            callback->name,
-            event,
-            ESP.getFreeHeap(),
-            power->getBattVoltage() / 1000.0,
-            power->getBattChargeCoulomb(),
-            power->getBattDischargeCoulomb(),
-            power->getBattPercentage(),
-            power->getBattChargeCurrent(),
-            power->getBattDischargeCurrent(),
-            power->getBattInpower(),
-            power->getTemp(),
-            bma->temperature()
-        );
-        if (! file.println(log_line) ) {
-            log_e("Failed to append to event log file: %s!", event_log_filename );
+/**
+ * @brief call all subscribed entrys for the set event bits in order of registration
+ */
+static bool callback_dispatch( callback_t *callback, EventBits_t event, void *arg ) {
+    bool retval = true;
+    /**
+     * fast path, a single event bit only walk the subscription chain of this bit
+     */
+    if ( __builtin_popcount( event ) == 1 ) {
+        for( uint16_t node = callback->bit_head[ __builtin_ctz( event ) ] ; node != CALLBACK_NO_ENTRY ; node = callback_node_pool[ node ].next ) {
+            if ( !callback_call_entry( callback, &callback_pool[ callback_node_pool[ node ].entry ], event, arg ) ) {
+                retval = false;
+            }
+        }
+        return( retval );
+    }
+    /**
+     * multiple event bits, merge the sorted subscription chains so that each
+     * entry is called only once and in order of registration
+     */
+    uint16_t cursor[ CALLBACK_EVENT_BITS ];
+    for( int bit = 0 ; bit < CALLBACK_EVENT_BITS ; bit++ ) {
+        cursor[ bit ] = ( event & ( 1UL << bit ) ) ? callback->bit_head[ bit ] : CALLBACK_NO_ENTRY;
+    }
+    while( true ) {
+        uint16_t next_entry = CALLBACK_NO_ENTRY;
+        for( int bit = 0 ; bit < CALLBACK_EVENT_BITS ; bit++ ) {
+            if ( cursor[ bit ] != CALLBACK_NO_ENTRY && callback_node_pool[ cursor[ bit ] ].entry < next_entry ) {
+                next_entry = callback_node_pool[ cursor[ bit ] ].entry;
+            }
+        }
+        if ( next_entry == CALLBACK_NO_ENTRY ) {
+            break;
+        }
+        for( int bit = 0 ; bit < CALLBACK_EVENT_BITS ; bit++ ) {
+            if ( cursor[ bit ] != CALLBACK_NO_ENTRY && callback_node_pool[ cursor[ bit ] ].entry == next_entry ) {
+                cursor[ bit ] = callback_node_pool[ cursor[ bit ] ].next;
+            }
+        }
+        if ( !callback_call_entry( callback, &callback_pool[ next_entry ], event, arg ) ) {
+            retval = false;
         }
     }
-    file.close();
+    return( retval );
+}
+
+void display_record_event( callback_t *callback, EventBits_t event ) {
+    /**
+     * only buffer a binary record, the journal is flushed in blocks on standby
+     * or when the ring buffer reach the high water mark
+     */
+    event_journal_record( callback->name, event );
 }
 
 bool callback_send( callback_t *callback, EventBits_t event, void *arg ) {
@@ -216,32 +363,14 @@ bool callback_send( callback_t *callback, EventBits_t event, void *arg ) {
     if( display_event_logging ) {
         display_record_event( callback, event );
     }
-
-    retval = true;
     /**
-     * crowl all callback entrys with their right mask
+     * call only the entrys subscribed to the set event bits
      */
-    for ( int entry = 0 ; entry < callback->entrys ; entry++ ) {
-        yield();
-        if ( event & callback->table[ entry ].event ) {
-            /**
-             * print out callback event
-             */
-            if ( callback->debug ) {
-                log_i("call %s cb (%p:%04x:%s)", callback->name, callback->table[ entry ].callback_func, event, callback->table[ entry ].id );
-            }
-            /**
-             * increment callback counter
-             */
-            callback->table[ entry ].counter++;
-            /**
-             * call callback an check the returnvalue
-             */
-            if ( !callback->table[ entry ].callback_func( event, arg ) ) {
-                retval = false;
-            }
-        }
-    }
+    retval = callback_dispatch( callback, event, arg );
+    /**
+     * an event from another task may change something the loop has to handle
+     */
+    scheduler_wakeup();
     return( retval );
 }
 
@@ -259,26 +388,10 @@ bool callback_send_no_log( callback_t *callback, EventBits_t event, void *arg )
     if ( callback->entrys == 0 ) {
         return( retval );
     }
-
-    retval = true;
     /**
-     * crowl all callback entrys with their right mask
+     * call only the entrys subscribed to the set event bits
      */
-    for ( int entry = 0 ; entry < callback->entrys ; entry++ ) {
-        yield();
-        if ( event & callback->table[ entry ].event ) {
-            /**
-             * increment callback counter
-             */
-            callback->table[ entry ].counter++;
-            /**
-             * call callback an check the returnvalue
-             */
-            if ( !callback->table[ entry ].callback_func( event, arg ) ) {
-                retval = false;
-            }
-        }
-    }
+    retval = callback_dispatch( callback, event, arg );
     return( retval );
 }
 
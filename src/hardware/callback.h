@@ -23,6 +23,12 @@
 
     #include <stdint.h>
 
+    #define CALLBACK_POOL_ENTRYS        192     /** @brief max number of callback entrys over all callback tables */
+    #define CALLBACK_POOL_NODES         384     /** @brief max number of event bit subscriptions over all callback tables */
+    #define CALLBACK_EVENT_BITS         32      /** @brief number of event bits per callback table */
+    #define CALLBACK_NO_ENTRY           0xffff  /** @brief end of an entry/node chain */
+    #define CALLBACK_HISTOGRAM_BUCKETS  5       /** @brief number of execution time buckets: <100us, <1ms, <10ms, <100ms and >=100ms */
+
     /**
      * @brief typedef for the callback function call
      * 
@@ -41,15 +47,32 @@
         CALLBACK_FUNC callback_func;        /** @brief pointer to a callback function */
         const char *id;                     /** @brief id for the callback */
         uint64_t counter;                   /** @brief callback function call counter thair returned true */
+        uint64_t total_us;                  /** @brief summed execution time in us, avg = total_us / counter */
+        uint32_t min_us;                    /** @brief fastest execution time in us */
+        uint32_t max_us;                    /** @brief slowest execution time in us */
+        uint32_t histogram[ CALLBACK_HISTOGRAM_BUCKETS ];  /** @brief execution time buckets */
+        const char *name;                   /** @brief name of the callback table this entry belongs to */
+        uint16_t next;                      /** @brief next entry in the same callback table in order of registration */
     } callback_table_t;
 
+    /**
+     * @brief callback event bit subscription node
+     */
+    typedef struct {
+        uint16_t entry;                     /** @brief subscribed entry in the callback entry pool */
+        uint16_t next;                      /** @brief next subscription node for the same event bit */
+    } callback_node_t;
+
     /**
      * @brief callback head structure
      */
     typedef struct callback_t {
         uint32_t entrys;                    /** @brief count callback entrys */
         bool debug;                         /** @brief debug flag, if TRUE to get debug messages */
-        callback_table_t *table;            /** @brief pointer to an callback table */
+        uint16_t first_entry;               /** @brief first entry in the callback entry pool */
+        uint16_t last_entry;                /** @brief last entry in the callback entry pool */
+        uint16_t bit_head[ CALLBACK_EVENT_BITS ];  /** @brief first subscription node per event bit */
+        uint16_t bit_tail[ CALLBACK_EVENT_BITS ];  /** @brief last subscription node per event bit */
         const char *name;                   /** @brief id for the callback structure */
         callback_t *next_callback_t;        
     } callback_t;
@@ -94,9 +117,11 @@
      */
     bool callback_send_no_log( callback_t *callback, EventBits_t event, void *arg );
     /**
-     * @brief enable/disable SPIFFS event logging
+     * @brief enable/disable SPIFFS event logging into the binary event journal
      * 
      * @param enable    true if logging enabled, false if logging disabled
+     * 
+     * @note    events are buffered in RAM and flushed on standby, use tools/event_journal2csv.py to decode
      */
     void display_event_logging_enable( bool enable );
     /**
@@ -110,5 +135,20 @@
      * @brief prints out the complete callback table and their entrys
      */
     void callback_print( void );
+    /**
+     * @brief prints out the slowest callback functions over all callback tables
+     * 
+     * @param   count           number of callback functions to print
+     */
+    void callback_print_slowest( uint32_t count );
+    /**
+     * @brief get the slowest callback functions over all callback tables, sorted by max execution time
+     * 
+     * @param   slowest         pointer to an array for the result
+     * @param   count           size of the array
+     * 
+     * @return  number of entrys written into the array
+     */
+    uint32_t callback_get_slowest( const callback_table_t **slowest, uint32_t count );
 
 #endif // _CALLBACK_H
\ No newline at end of file
@@ -31,6 +31,7 @@ bool bma_config_t::onSave(JsonDocument& doc) {
     doc["doubleclick"] = enable[ BMA_DOUBLECLICK ];
     doc["tilt"] = enable[ BMA_TILT ];
     doc["daily_stepcounter"] = enable[ BMA_DAILY_STEPCOUNTER ];
+    doc["activity"] = enable[ BMA_ACTIVITY ];
 
     return true;
 }
@@ -40,10 +41,15 @@ bool bma_config_t::onLoad(JsonDocument& doc) {
     enable[ BMA_DOUBLECLICK ] = doc["doubleclick"] | true;
     enable[ BMA_TILT ] = doc["tilt"] | false;
     enable[ BMA_DAILY_STEPCOUNTER ] = doc["daily_stepcounter"] | false;
+    enable[ BMA_ACTIVITY ] = doc["activity"] | false;
   
     return true;
 }
 
 bool bma_config_t::onDefault( void ) {
+    /*
+     * the fifo wakes up the watch every few seconds in standby, opt-in
+     */
+    enable[ BMA_ACTIVITY ] = false;
     return true;
 }
\ No newline at end of file
@@ -29,6 +29,7 @@
         BMA_DOUBLECLICK,
         BMA_TILT,
         BMA_DAILY_STEPCOUNTER,
+        BMA_ACTIVITY,
         BMA_CONFIG_NUM
     };
 
@@ -32,6 +32,7 @@ bool display_config_t::onSave(JsonDocument& doc) {
     doc["background_image"] = background_image;
     doc["use_dma"] = use_dma;
     doc["use_double_buffering"] = use_double_buffering;
+    doc["band_height"] = band_height;
     doc["vibe"] = vibe;
 
     return true;
@@ -45,6 +46,7 @@ bool display_config_t::onLoad(JsonDocument& doc) {
     background_image = doc["background_image"] | 2;
     use_dma = doc["use_dma"] | true;
     use_double_buffering = doc["use_double_buffering"] | true;
+    band_height = doc["band_height"] | 20;
     vibe = doc["vibe"] | true;
 
     return true;
@@ -45,6 +45,7 @@
         bool block_return_maintile = false;             /** @brief block back to main tile on standby */
         bool use_dma = true;                            /** @brief use dma framebuffer */
         bool use_double_buffering = true;               /** @brief use double framebuffer */
+        uint32_t band_height = 20;                      /** @brief framebuffer band height in lines */
         bool vibe = true;                               /** @brief vibe for touch feedback */
         uint32_t background_image = 2;                  /** @brief background image */
 
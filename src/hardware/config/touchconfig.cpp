@@ -0,0 +1,59 @@
+/****************************************************************************
+ *   Oct 18 20:04:26 2026
+ *   Copyright  2026  My-TTGO-Watch contributors
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#include "touchconfig.h"
+
+/*
+ * issue https://github.com/sharandac/My-TTGO-Watch/issues/18 fix,
+ * x is scaled by 1.15 around the center of the 240px screen
+ */
+static const int32_t touch_default_calibration[ 6 ] = { 75366, 0, -1179648, 0, 65536, 0 };
+
+touch_config_t::touch_config_t() : BaseJsonConfig(TOUCH_JSON_CONFIG_FILE) {
+    onDefault();
+}
+
+bool touch_config_t::onSave(JsonDocument& doc) {
+    JsonArray matrix = doc.createNestedArray("calibration");
+    for ( int i = 0 ; i < 6 ; i++ ) {
+        matrix.add( calibration.m[ i ] );
+    }
+    doc["filter_latency"] = filter_latency;
+
+    return true;
+}
+
+bool touch_config_t::onLoad(JsonDocument& doc) {
+    for ( int i = 0 ; i < 6 ; i++ ) {
+        calibration.m[ i ] = doc["calibration"][ i ] | touch_default_calibration[ i ];
+    }
+    filter_latency = doc["filter_latency"] | TOUCH_DEFAULT_FILTER_LATENCY;
+
+    return true;
+}
+
+bool touch_config_t::onDefault( void ) {
+    for ( int i = 0 ; i < 6 ; i++ ) {
+        calibration.m[ i ] = touch_default_calibration[ i ];
+    }
+    filter_latency = TOUCH_DEFAULT_FILTER_LATENCY;
+
+    return true;
+}
@@ -0,0 +1,47 @@
+/****************************************************************************
+ *   Oct 18 20:04:26 2026
+ *   Copyright  2026  My-TTGO-Watch contributors
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#ifndef _TOUCH_CONFIG_H
+    #define _TOUCH_CONFIG_H
+
+    #include "utils/basejsonconfig.h"
+    #include "utils/touch_gesture.h"
+
+    #define TOUCH_JSON_CONFIG_FILE      "/touch.json"       /** @brief defines json config file name */
+    #define TOUCH_DEFAULT_FILTER_LATENCY 20                 /** @brief default jitter filter time constant in ms */
+
+    /**
+     * @brief touch config structure
+     */
+    class touch_config_t : public BaseJsonConfig {
+        public:
+        touch_config_t();
+        touch_calibration_t calibration;                    /** @brief calibration matrix, raw controller point to screen */
+        uint16_t filter_latency = TOUCH_DEFAULT_FILTER_LATENCY;  /** @brief jitter filter time constant in ms, 0 means off */
+
+        protected:
+        ////////////// Available for overloading: //////////////
+        virtual bool onLoad(JsonDocument& document);
+        virtual bool onSave(JsonDocument& document);
+        virtual bool onDefault( void );
+        virtual size_t getJsonBufferSize() { return 1000; }
+    };
+
+#endif // _TOUCH_CONFIG_H
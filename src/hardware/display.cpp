@@ -27,6 +27,7 @@
 #include "motor.h"
 #include "bma.h"
 #include "framebuffer.h"
+#include "scheduler.h"
 #include "gui/gui.h"
 
 display_config_t display_config;
@@ -55,6 +56,7 @@ void display_setup( void ) {
     /**
      * setup framebuffer
      */
+    framebuffer_set_band_height( display_config.band_height );
     framebuffer_setup( display_config.use_dma, display_config.use_double_buffering );
     /**
      * register powermgm and pwermgm loop callback functions
@@ -94,6 +96,16 @@ void display_loop( void ) {
             brightness--;
             ttgo->bl->adjust( brightness );
         }
+        /**
+         * keep fading without waiting for the next gui task
+         */
+        scheduler_set_deadline( DISPLAY_FADE_STEP );
+  }
+  /**
+   * apply a new framebuffer band height
+   */
+  if ( framebuffer_get_band_height() != display_config.band_height ) {
+      framebuffer_set_band_height( display_config.band_height );
   }
   /**
    * check timeout
@@ -142,6 +154,7 @@ void display_wakeup( bool silence ) {
         log_i("go silence wakeup");
         ttgo->openBL();
         ttgo->displayWakeup();
+        framebuffer_invalidate_hashes();
         ttgo->bl->adjust( 0 );
         brightness = 0;
         dest_brightness = 0;
@@ -150,6 +163,7 @@ void display_wakeup( bool silence ) {
         log_i("go wakeup");
         ttgo->openBL();
         ttgo->displayWakeup();
+        framebuffer_invalidate_hashes();
         ttgo->bl->adjust( 0 );
         brightness = 0;
         dest_brightness = display_get_brightness();
@@ -209,6 +223,24 @@ void display_set_use_dma( bool use_dma ) {
     framebuffer_setup( display_config.use_dma, display_config.use_double_buffering );
 }
 
+uint32_t display_get_band_height( void ) {
+    return( display_config.band_height );
+}
+
+void display_set_band_height( uint32_t band_height ) {
+    if ( band_height < FRAMEBUFFER_MIN_BAND_H ) {
+        band_height = FRAMEBUFFER_MIN_BAND_H;
+    }
+    if ( band_height > FRAMEBUFFER_MAX_BAND_H ) {
+        band_height = FRAMEBUFFER_MAX_BAND_H;
+    }
+    /**
+     * the framebuffer is reallocated from the display loop, LVGL is not thread safe
+     */
+    display_config.band_height = band_height;
+    scheduler_wakeup();
+}
+
 void display_set_block_return_maintile( bool block_return_maintile ) {
     display_config.block_return_maintile = block_return_maintile;
 }
@@ -217,6 +249,7 @@ void display_set_rotation( uint32_t rotation ) {
     TTGOClass *ttgo = TTGOClass::getWatch();
     display_config.rotation = rotation;
     ttgo->tft->setRotation( rotation / 90 );
+    framebuffer_invalidate_hashes();
     lv_obj_invalidate( lv_scr_act() );
 }
 
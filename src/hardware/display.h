@@ -29,6 +29,8 @@
     #define DISPLAYCTL_TIMEOUT          _BV(1)          /** @brief event mask display timeout, callback arg is (bool*) */
     #define DISPLAYCTL_SCREENSHOT       _BV(2)          /** @brief event mask display screenshot, callback arg is (bool*) */
 
+    #define DISPLAY_FADE_STEP           2               /** @brief time in ms between two backlight fade steps */
+
     /**
      * @brief setup display
      * 
@@ -79,6 +81,19 @@
      * @param  use_dma  true for use DMA or false
      */    
     void display_set_use_dma( bool use_dma );
+    /**
+     * @brief read the framebuffer band height from config
+     *
+     * @return  band height in lines
+     */
+    uint32_t display_get_band_height( void );
+    /**
+     * @brief set the framebuffer band height, a higher band needs more memory
+     * but less flushes per frame
+     *
+     * @param  band_height  band height in lines
+     */
+    void display_set_band_height( uint32_t band_height );
     /**
      * @brief read the use double buffering from config
      * 
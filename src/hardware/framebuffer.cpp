@@ -22,40 +22,138 @@
 #include "config.h"
 #include <TTGO.h>
 #include <esp_ipc.h>
+#include <esp_timer.h>
 
 #include "framebuffer.h"
+#include "framebuffer_areas.h"
+#include "framebuffer_model.h"
 #include "powermgm.h"
 
 #include "utils/alloc.h"
+#include "utils/bench.h"
 
 lv_color_t *framebuffer1 = NULL;
 lv_color_t *framebuffer2 = NULL;
+static bool framebuffer_want_dma = false;
 static bool framebuffer_use_dma = false;
+static bool framebuffer_use_double = false;
+static bool framebuffer_initialized = false;
+static uint32_t framebuffer_band_height = FRAMEBUFFER_BUFFER_H;
+static volatile bool framebuffer_dma_pending = false;
+static uint64_t framebuffer_dma_wait_us = 0;
+static framebuffer_stats_t framebuffer_stats;
+static uint64_t framebuffer_stats_time = 0;
+static uint32_t framebuffer_stats_frames = 0;
+
+static int32_t framebuffer_bench_frame = -1;
+static int32_t framebuffer_bench_dma_wait = -1;
+static int32_t framebuffer_bench_hash = -1;
+
+static framebuffer_hash_t framebuffer_hashes[ FRAMEBUFFER_HASH_ENTRYS ];
+static framebuffer_frame_stats_t framebuffer_frame;
 
 static lv_disp_buf_t disp_buf;
 
 bool framebuffer_setup_dma( bool doubleframebuffer  );
 bool framebuffer_setup_nodma( bool doubleframebuffer  );
 static void framebuffer_flush(lv_disp_drv_t *disp_drv, const lv_area_t *area, lv_color_t *color_p);
+static void framebuffer_wait_cb( lv_disp_drv_t *disp_drv );
+static void framebuffer_monitor_cb( lv_disp_drv_t *disp_drv, uint32_t time, uint32_t px );
+static void framebuffer_dma_finish( lv_disp_drv_t *disp_drv, bool wait );
+static void framebuffer_refr_task( lv_task_t *task );
 
 void framebuffer_setup( bool dma, bool doubleframebuffer ) {
+    framebuffer_bench_frame = bench_register( "framebuffer frame", BENCH_NO_BUDGET );
+    framebuffer_bench_dma_wait = bench_register( "framebuffer dma wait", BENCH_NO_BUDGET );
+    framebuffer_bench_hash = bench_register( "framebuffer hash", BENCH_NO_BUDGET );
+    /*
+     * merge the invalid areas before each refresh
+     */
+    lv_disp_t *system_disp = lv_disp_get_default();
+    if ( system_disp->refr_task ) {
+        system_disp->refr_task->task_cb = framebuffer_refr_task;
+    }
+    framebuffer_invalidate_hashes();
+    /*
+     * wait until the last band is on the display before the buffers are freed
+     */
+    if ( framebuffer_initialized ) {
+        framebuffer_dma_finish( &lv_disp_get_default()->driver, true );
+    }
+    framebuffer_want_dma = dma;
+    framebuffer_use_double = doubleframebuffer;
+    framebuffer_initialized = true;
+
     if ( dma ) {
         TTGOClass *ttgo = TTGOClass::getWatch();
         ttgo->tft->initDMA();
-        framebuffer_setup_dma( doubleframebuffer );
+        if ( framebuffer_setup_dma( doubleframebuffer ) ) {
+            return;
+        }
     }
-    else {
-        framebuffer_setup_nodma( doubleframebuffer );
+    framebuffer_setup_nodma( doubleframebuffer );
+}
+
+void framebuffer_set_band_height( uint32_t band_height ) {
+    if ( band_height < FRAMEBUFFER_MIN_BAND_H ) {
+        band_height = FRAMEBUFFER_MIN_BAND_H;
+    }
+    if ( band_height > FRAMEBUFFER_MAX_BAND_H ) {
+        band_height = FRAMEBUFFER_MAX_BAND_H;
+    }
+    if ( band_height == framebuffer_band_height ) {
+        return;
     }
+    framebuffer_band_height = band_height;
+    log_i("framebuffer band height: %d lines", framebuffer_band_height );
+    /*
+     * realloc the framebuffer with the new band height if already running,
+     * DMA is tried again if it was configured and failed before
+     */
+    if ( framebuffer_initialized ) {
+        framebuffer_setup( framebuffer_want_dma, framebuffer_use_double );
+    }
+}
+
+uint32_t framebuffer_get_band_height( void ) {
+    return( framebuffer_band_height );
+}
+
+void framebuffer_invalidate_hashes( void ) {
+    memset( framebuffer_hashes, 0, sizeof( framebuffer_hashes ) );
+}
+
+void framebuffer_get_stats( framebuffer_stats_t *stats ) {
+    framebuffer_model_t model;
+    framebuffer_model_result_t result;
+
+    *stats = framebuffer_stats;
+    /*
+     * model a full screen swipe with the current setup and the measured render time
+     */
+    model.width = lv_disp_get_hor_res( NULL );
+    model.height = lv_disp_get_ver_res( NULL );
+    model.band_height = framebuffer_band_height;
+    model.dma = framebuffer_use_dma;
+    model.double_buffer = framebuffer_use_double;
+    model.spi_frequency = FRAMEBUFFER_SPI_FREQUENCY;
+    model.cmd_bytes = FRAMEBUFFER_FLUSH_CMD_BYTES;
+    model.render_ns_px = framebuffer_stats.render_ns_px;
+    model.band_overhead_us = 0;
+    model.hash_ns_px = 0;
+    framebuffer_model_frame( &model, &result );
+    stats->spi_bound_fps = framebuffer_model_spi_bound_fps( &model );
+    stats->swipe_fps = result.fps;
 }
 
 bool framebuffer_setup_nodma( bool doubleframebuffer  ) {
     lv_color_t *tmp_framebuffer1 = NULL;
     lv_color_t *tmp_framebuffer2 = NULL;
+    uint32_t framebuffer_size = FRAMEBUFFER_BUFFER_W * framebuffer_band_height;
     /*
      * allocate new framebuffer
      */
-    tmp_framebuffer1 = (lv_color_t*)CALLOC( sizeof(lv_color_t), FRAMEBUFFER_BUFFER_SIZE );
+    tmp_framebuffer1 = (lv_color_t*)CALLOC( sizeof(lv_color_t), framebuffer_size );
     if ( tmp_framebuffer1 == NULL ) {
         log_e("framebuffer 1 malloc failed");
         return( false );
@@ -64,7 +162,7 @@ bool framebuffer_setup_nodma( bool doubleframebuffer  ) {
      * if double buffer set, allocate the second one
      */
     if ( doubleframebuffer ) {
-        tmp_framebuffer2 = (lv_color_t*)CALLOC( sizeof(lv_color_t), FRAMEBUFFER_BUFFER_SIZE );
+        tmp_framebuffer2 = (lv_color_t*)CALLOC( sizeof(lv_color_t), framebuffer_size );
         if ( tmp_framebuffer2 == NULL ) {
             log_e("framebuffer 2 malloc failed");
             if ( tmp_framebuffer1 ) {
@@ -89,19 +187,21 @@ bool framebuffer_setup_nodma( bool doubleframebuffer  ) {
     framebuffer1 = tmp_framebuffer1;
     if ( doubleframebuffer ) {
         framebuffer2 = tmp_framebuffer2;
-        log_i("double framebuffer enable ( 2 x %d bytes )", sizeof(lv_color_t) * FRAMEBUFFER_BUFFER_SIZE );
+        log_i("double framebuffer enable ( 2 x %d bytes )", sizeof(lv_color_t) * framebuffer_size );
     }
     else {
         framebuffer2 = NULL;
-        log_i("single framebuffer enable ( %d bytes )", sizeof(lv_color_t) * FRAMEBUFFER_BUFFER_SIZE );
+        log_i("single framebuffer enable ( %d bytes )", sizeof(lv_color_t) * framebuffer_size );
     }
     /*
      * set LVGL driver
      */
     lv_disp_t *system_disp;
-    lv_disp_buf_init( &disp_buf, framebuffer1, framebuffer2, FRAMEBUFFER_BUFFER_SIZE );
+    lv_disp_buf_init( &disp_buf, framebuffer1, framebuffer2, framebuffer_size );
     system_disp = lv_disp_get_default();
     system_disp->driver.flush_cb = framebuffer_flush;
+    system_disp->driver.wait_cb = framebuffer_wait_cb;
+    system_disp->driver.monitor_cb = framebuffer_monitor_cb;
     system_disp->driver.hor_res = lv_disp_get_hor_res( NULL );
     system_disp->driver.ver_res = lv_disp_get_ver_res( NULL );
     system_disp->driver.buffer = &disp_buf;
@@ -115,10 +215,11 @@ bool framebuffer_setup_dma( bool doubleframebuffer  ) {
 #if defined( TWATCH_USE_PSRAM_ALLOC_LVGL ) && defined( CONFIG_SPIRAM_SPEED_80M )
     lv_color_t *tmp_framebuffer1 = NULL;
     lv_color_t *tmp_framebuffer2 = NULL;
+    uint32_t framebuffer_size = FRAMEBUFFER_BUFFER_W * framebuffer_band_height;
     /*
      * allocate new framebuffer
      */
-    tmp_framebuffer1 = (lv_color_t*)calloc( sizeof(lv_color_t), FRAMEBUFFER_BUFFER_SIZE );
+    tmp_framebuffer1 = (lv_color_t*)calloc( sizeof(lv_color_t), framebuffer_size );
     if ( tmp_framebuffer1 == NULL ) {
         log_e("framebuffer 1 malloc failed");
         return( false );
@@ -127,7 +228,7 @@ bool framebuffer_setup_dma( bool doubleframebuffer  ) {
      * if double buffer set, allocate the second one
      */
     if ( doubleframebuffer ) {
-        tmp_framebuffer2 = (lv_color_t*)calloc( sizeof(lv_color_t), FRAMEBUFFER_BUFFER_SIZE );
+        tmp_framebuffer2 = (lv_color_t*)calloc( sizeof(lv_color_t), framebuffer_size );
         if ( tmp_framebuffer2 == NULL ) {
             log_e("framebuffer 2 malloc failed");
             if ( tmp_framebuffer1 ) {
@@ -151,19 +252,21 @@ bool framebuffer_setup_dma( bool doubleframebuffer  ) {
     framebuffer1 = tmp_framebuffer1;
     if ( doubleframebuffer ) {
         framebuffer2 = tmp_framebuffer2;
-        log_i("custom arduino-esp32 framework detected, double DMA framebuffer enable ( 2 x %d bytes )", sizeof(lv_color_t) * FRAMEBUFFER_BUFFER_SIZE );
+        log_i("custom arduino-esp32 framework detected, double DMA framebuffer enable ( 2 x %d bytes )", sizeof(lv_color_t) * framebuffer_size );
     }
     else {
         framebuffer2 = NULL;
-        log_i("custom arduino-esp32 framework detected, single DMA framebuffer enable ( %d bytes )", sizeof(lv_color_t) * FRAMEBUFFER_BUFFER_SIZE );
+        log_i("custom arduino-esp32 framework detected, single DMA framebuffer enable ( %d bytes )", sizeof(lv_color_t) * framebuffer_size );
     }
     /*
      * set LVGL driver
      */
     lv_disp_t *system_disp;
-    lv_disp_buf_init( &disp_buf, framebuffer1, framebuffer2, FRAMEBUFFER_BUFFER_SIZE );
+    lv_disp_buf_init( &disp_buf, framebuffer1, framebuffer2, framebuffer_size );
     system_disp = lv_disp_get_default();
     system_disp->driver.flush_cb = framebuffer_flush;
+    system_disp->driver.wait_cb = framebuffer_wait_cb;
+    system_disp->driver.monitor_cb = framebuffer_monitor_cb;
     system_disp->driver.hor_res = lv_disp_get_hor_res( NULL );
     system_disp->driver.ver_res = lv_disp_get_ver_res( NULL );
     system_disp->driver.buffer = &disp_buf;
@@ -176,18 +279,164 @@ bool framebuffer_setup_dma( bool doubleframebuffer  ) {
 #endif
 }
 
+/**
+ * @brief hand the buffer of the last DMA transfer back to LVGL if the transfer is done
+ *
+ * @param   disp_drv    pointer to the display driver
+ * @param   wait        true to block until the transfer is done and close the spi transaction
+ */
+static void framebuffer_dma_finish( lv_disp_drv_t *disp_drv, bool wait ) {
+    TTGOClass *ttgo = TTGOClass::getWatch();
+
+    if ( !framebuffer_dma_pending ) {
+        return;
+    }
+
+    if ( wait ) {
+        uint64_t start = esp_timer_get_time();
+        ttgo->tft->endWrite();
+        framebuffer_dma_wait_us += esp_timer_get_time() - start;
+    }
+    else if ( ttgo->tft->dmaBusy() ) {
+        return;
+    }
+    framebuffer_dma_pending = false;
+    lv_disp_flush_ready( disp_drv );
+}
+
+/**
+ * @brief check if an area with the same content is already on the display and
+ * remember the new content
+ *
+ * @return  true if the content is unchanged
+ */
+static bool framebuffer_check_hash( const lv_area_t *area, lv_color_t *color_p, uint32_t size ) {
+    framebuffer_area_t hash_area = { area->x1, area->y1, area->x2, area->y2 };
+
+    uint64_t bench_start = bench_begin( framebuffer_bench_hash );
+    uint32_t hash = framebuffer_areas_hash( (const uint16_t *)color_p, size );
+    bench_end( framebuffer_bench_hash, bench_start );
+
+    return( framebuffer_areas_check_hash( framebuffer_hashes, FRAMEBUFFER_HASH_ENTRYS, &hash_area, hash, framebuffer_stats.frames + 1 ) );
+}
+
 static void framebuffer_flush(lv_disp_drv_t *disp_drv, const lv_area_t *area, lv_color_t *color_p) {
     TTGOClass *ttgo = TTGOClass::getWatch();
 
     uint32_t size = (area->x2 - area->x1 + 1) * (area->y2 - area->y1 + 1) ;
-    ttgo->tft->startWrite();
-    ttgo->tft->setAddrWindow(area->x1, area->y1, (area->x2 - area->x1 + 1), (area->y2 - area->y1 + 1)); /* set the working window */
+    /*
+     * skip the spi transfer if the display already shows this content
+     */
+    if ( framebuffer_check_hash( area, color_p, size ) ) {
+        framebuffer_frame.skipped_px += size;
+        lv_disp_flush_ready( disp_drv );
+        return;
+    }
+    framebuffer_frame.pushed_px += size;
+    framebuffer_frame.flushes++;
+
     if ( framebuffer_use_dma ) {
+        /*
+         * the spi transaction stays open over all bands of a frame, the
+         * address window can only be changed after the last band is out
+         */
+        if ( ttgo->tft->dmaBusy() ) {
+            uint64_t start = esp_timer_get_time();
+            ttgo->tft->dmaWait();
+            framebuffer_dma_wait_us += esp_timer_get_time() - start;
+        }
+        ttgo->tft->startWrite();
+        ttgo->tft->setAddrWindow(area->x1, area->y1, (area->x2 - area->x1 + 1), (area->y2 - area->y1 + 1)); /* set the working window */
         ttgo->tft->pushPixelsDMA(( uint16_t *)color_p, size);
+        /*
+         * LVGL render the next band into the other buffer, this buffer is
+         * returned in framebuffer_wait_cb or at the end of the frame
+         */
+        framebuffer_dma_pending = true;
     }
     else {
+        ttgo->tft->startWrite();
+        ttgo->tft->setAddrWindow(area->x1, area->y1, (area->x2 - area->x1 + 1), (area->y2 - area->y1 + 1)); /* set the working window */
         ttgo->tft->pushPixels(( uint16_t *)color_p, size);
+        ttgo->tft->endWrite();
+        lv_disp_flush_ready( disp_drv );
     }
-    ttgo->tft->endWrite();
-    lv_disp_flush_ready( disp_drv );
+}
+
+/**
+ * @brief called from LVGL while it waits for a buffer, polls the DMA completion
+ */
+static void framebuffer_wait_cb( lv_disp_drv_t *disp_drv ) {
+    uint64_t start = esp_timer_get_time();
+    framebuffer_dma_finish( disp_drv, false );
+    framebuffer_dma_wait_us += esp_timer_get_time() - start;
+}
+
+/**
+ * @brief called from LVGL after a refresh, close the spi transaction and update the statistic
+ */
+static void framebuffer_monitor_cb( lv_disp_drv_t *disp_drv, uint32_t time, uint32_t px ) {
+    framebuffer_dma_finish( disp_drv, true );
+
+    bench_add( framebuffer_bench_frame, time * 1000 );
+    bench_add( framebuffer_bench_dma_wait, framebuffer_dma_wait_us );
+    framebuffer_stats.frames++;
+    framebuffer_stats.pixels += px;
+    /*
+     * spi bytes are the pixels plus the address window commands for each flush
+     */
+    framebuffer_frame.spi_bytes = framebuffer_frame.pushed_px * sizeof( lv_color_t ) + framebuffer_frame.flushes * FRAMEBUFFER_FLUSH_CMD_BYTES;
+    /*
+     * render time per pixel from frames of at least half the screen, the
+     * time without the dma wait and without blocking spi transfers
+     */
+    if ( px >= lv_disp_get_hor_res( NULL ) * lv_disp_get_ver_res( NULL ) / 2 ) {
+        int64_t render_us = (int64_t)time * 1000 - framebuffer_dma_wait_us;
+        if ( !framebuffer_use_dma ) {
+            render_us -= (int64_t)framebuffer_frame.spi_bytes * 8 * 1000000 / FRAMEBUFFER_SPI_FREQUENCY;
+        }
+        framebuffer_stats.render_ns_px = render_us > 0 ? render_us * 1000 / px : 0;
+    }
+    framebuffer_dma_wait_us = 0;
+    framebuffer_stats.last_frame = framebuffer_frame;
+    framebuffer_stats.invalidated_px += framebuffer_frame.invalidated_px;
+    framebuffer_stats.pushed_px += framebuffer_frame.pushed_px;
+    framebuffer_stats.skipped_px += framebuffer_frame.skipped_px;
+    framebuffer_stats.spi_bytes += framebuffer_frame.spi_bytes;
+    framebuffer_stats_frames++;
+    /*
+     * update the frames per second once a second
+     */
+    uint64_t now = esp_timer_get_time();
+    if ( now - framebuffer_stats_time >= 1000000 ) {
+        framebuffer_stats.fps = ( (uint64_t)framebuffer_stats_frames * 1000000 ) / ( now - framebuffer_stats_time );
+        framebuffer_stats_frames = 0;
+        framebuffer_stats_time = now;
+    }
+}
+
+/**
+ * @brief merge the invalid areas before LVGL joins and refreshes them
+ */
+static void framebuffer_merge_areas( lv_disp_t *disp ) {
+    framebuffer_area_t areas[ LV_INV_BUF_SIZE ];
+
+    for( uint32_t i = 0 ; i < disp->inv_p ; i++ ) {
+        areas[ i ] = { disp->inv_areas[ i ].x1, disp->inv_areas[ i ].y1, disp->inv_areas[ i ].x2, disp->inv_areas[ i ].y2 };
+    }
+    uint32_t invalidated = framebuffer_areas_merge( areas, disp->inv_area_joined, disp->inv_p, FRAMEBUFFER_MERGE_SLACK );
+    for( uint32_t i = 0 ; i < disp->inv_p ; i++ ) {
+        lv_area_set( &disp->inv_areas[ i ], areas[ i ].x1, areas[ i ].y1, areas[ i ].x2, areas[ i ].y2 );
+    }
+    memset( &framebuffer_frame, 0, sizeof( framebuffer_frame ) );
+    framebuffer_frame.invalidated_px = invalidated;
+}
+
+static void framebuffer_refr_task( lv_task_t *task ) {
+    lv_disp_t *disp = (lv_disp_t *)task->user_data;
+
+    if ( disp && disp->inv_p ) {
+        framebuffer_merge_areas( disp );
+    }
+    _lv_disp_refr_task( task );
 }
@@ -22,9 +22,45 @@
 #ifndef _FRAMEBUFFER_H
     #define _FRAMEBUFFER_H
 
+    #include <stdint.h>
+
     #define FRAMEBUFFER_BUFFER_W        ( 240 )
     #define FRAMEBUFFER_BUFFER_H        ( 20 )
     #define FRAMEBUFFER_BUFFER_SIZE     ( FRAMEBUFFER_BUFFER_W * FRAMEBUFFER_BUFFER_H )
+    #define FRAMEBUFFER_MIN_BAND_H      ( 4 )
+    #define FRAMEBUFFER_MAX_BAND_H      ( 60 )
+    #define FRAMEBUFFER_SPI_FREQUENCY   ( 40000000 )    /** @brief display spi clock, used for the fps model in framebuffer_model.h */
+    #define FRAMEBUFFER_FLUSH_CMD_BYTES ( 11 )          /** @brief spi bytes for the address window of one flush */
+    #define FRAMEBUFFER_MERGE_SLACK     ( 240 )         /** @brief max wasted pixels when two invalid areas are merged */
+    #define FRAMEBUFFER_HASH_ENTRYS     ( 32 )          /** @brief number of remembered area content hashes */
+
+    /**
+     * @brief per frame pixel accounting
+     */
+    typedef struct {
+        uint32_t invalidated_px;        /** @brief pixels invalidated by LVGL, before merging */
+        uint32_t pushed_px;             /** @brief pixels send to the display */
+        uint32_t skipped_px;            /** @brief pixels not send because the content was unchanged */
+        uint32_t flushes;               /** @brief number of address windows send */
+        uint32_t spi_bytes;             /** @brief spi bytes incl. address window commands */
+    } framebuffer_frame_stats_t;
+
+    /**
+     * @brief framebuffer statistic
+     */
+    typedef struct {
+        uint32_t frames;                /** @brief number of refreshed frames since boot */
+        uint64_t pixels;                /** @brief number of flushed pixels since boot */
+        uint32_t fps;                   /** @brief refreshed frames in the last second */
+        uint32_t spi_bound_fps;         /** @brief theoretical upper bound of full screen frames per second, spi bus always busy and no render time */
+        uint32_t swipe_fps;             /** @brief modelled full screen swipe frames per second with the current setup and render_ns_px */
+        uint32_t render_ns_px;          /** @brief measured LVGL render time per pixel of the last frame with at least half the screen */
+        uint64_t invalidated_px;        /** @brief pixels invalidated since boot */
+        uint64_t pushed_px;             /** @brief pixels send to the display since boot */
+        uint64_t skipped_px;            /** @brief pixels skipped since boot */
+        uint64_t spi_bytes;             /** @brief spi bytes since boot */
+        framebuffer_frame_stats_t last_frame;   /** @brief accounting of the last frame */
+    } framebuffer_stats_t;
 
     /**
      * @brief setup framebuffer
@@ -35,5 +71,27 @@
      * @note DMA and double buffering can enable/disable at any time with no restriction
      */
     void framebuffer_setup( bool dma, bool doubleframebuffer );
+    /**
+     * @brief set the framebuffer band height, the framebuffer is reallocated if needed
+     *
+     * @param band_height   band height in lines, FRAMEBUFFER_MIN_BAND_H to FRAMEBUFFER_MAX_BAND_H
+     */
+    void framebuffer_set_band_height( uint32_t band_height );
+    /**
+     * @brief get the framebuffer band height
+     *
+     * @return  band height in lines
+     */
+    uint32_t framebuffer_get_band_height( void );
+    /**
+     * @brief forget all content hashes, call if the display content is changed without LVGL
+     */
+    void framebuffer_invalidate_hashes( void );
+    /**
+     * @brief get the framebuffer statistic
+     *
+     * @param stats         pointer to a framebuffer_stats_t structure
+     */
+    void framebuffer_get_stats( framebuffer_stats_t *stats );
     
 #endif // _FRAMEBUFFER_H
\ No newline at end of file
@@ -0,0 +1,131 @@
+/****************************************************************************
+ *   Oct 20 11:02:55 2026
+ *   Copyright  2026  My-TTGO-Watch contributors
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#include <string.h>
+
+#include "framebuffer_areas.h"
+
+uint32_t framebuffer_area_size( const framebuffer_area_t *area ) {
+    return( (uint32_t)( area->x2 - area->x1 + 1 ) * (uint32_t)( area->y2 - area->y1 + 1 ) );
+}
+
+/**
+ * @brief bounding box of two areas
+ */
+static void framebuffer_area_join( framebuffer_area_t *joined, const framebuffer_area_t *a, const framebuffer_area_t *b ) {
+    joined->x1 = a->x1 < b->x1 ? a->x1 : b->x1;
+    joined->y1 = a->y1 < b->y1 ? a->y1 : b->y1;
+    joined->x2 = a->x2 > b->x2 ? a->x2 : b->x2;
+    joined->y2 = a->y2 > b->y2 ? a->y2 : b->y2;
+}
+
+/**
+ * @brief true if two areas overlap or touch
+ */
+static bool framebuffer_area_is_on( const framebuffer_area_t *a, const framebuffer_area_t *b ) {
+    return( a->x1 <= b->x2 && a->x2 >= b->x1 && a->y1 <= b->y2 && a->y2 >= b->y1 );
+}
+
+uint32_t framebuffer_areas_merge( framebuffer_area_t *areas, uint8_t *joined, uint32_t count, uint32_t slack ) {
+    uint32_t invalidated = 0;
+    bool merged = true;
+
+    for( uint32_t i = 0 ; i < count ; i++ ) {
+        if ( !joined[ i ] ) {
+            invalidated += framebuffer_area_size( &areas[ i ] );
+        }
+    }
+
+    while( merged ) {
+        merged = false;
+        for( uint32_t i = 0 ; i < count ; i++ ) {
+            if ( joined[ i ] ) {
+                continue;
+            }
+            for( uint32_t j = i + 1 ; j < count ; j++ ) {
+                framebuffer_area_t bounding;
+
+                if ( joined[ j ] ) {
+                    continue;
+                }
+                framebuffer_area_join( &bounding, &areas[ i ], &areas[ j ] );
+                if ( framebuffer_area_size( &bounding ) <= framebuffer_area_size( &areas[ i ] ) + framebuffer_area_size( &areas[ j ] ) + slack ) {
+                    areas[ i ] = bounding;
+                    joined[ j ] = 1;
+                    merged = true;
+                }
+            }
+        }
+    }
+    return( invalidated );
+}
+
+uint32_t framebuffer_areas_hash( const uint16_t *px, uint32_t size ) {
+    uint32_t hash = 2166136261;
+    /*
+     * fnv-1a over two pixels at once
+     */
+    for( uint32_t i = 0 ; i + 1 < size ; i += 2 ) {
+        hash = ( hash ^ ( px[ i ] | ( px[ i + 1 ] << 16 ) ) ) * 16777619;
+    }
+    if ( size & 1 ) {
+        hash = ( hash ^ px[ size - 1 ] ) * 16777619;
+    }
+    return( hash );
+}
+
+bool framebuffer_areas_check_hash( framebuffer_hash_t *hashes, uint32_t entrys, const framebuffer_area_t *area, uint32_t hash, uint32_t frame ) {
+    framebuffer_hash_t *entry = NULL;
+    framebuffer_hash_t *oldest = &hashes[ 0 ];
+
+    for( uint32_t i = 0 ; i < entrys ; i++ ) {
+        framebuffer_hash_t *hash_entry = &hashes[ i ];
+        if ( hash_entry->used == 0 ) {
+            oldest = hash_entry;
+            continue;
+        }
+        if ( !memcmp( &hash_entry->area, area, sizeof( framebuffer_area_t ) ) ) {
+            entry = hash_entry;
+        }
+        else if ( framebuffer_area_is_on( &hash_entry->area, area ) ) {
+            /*
+             * an overlapping area is overwritten, the hash is no longer valid
+             */
+            hash_entry->used = 0;
+            oldest = hash_entry;
+            continue;
+        }
+        if ( oldest->used != 0 && hash_entry->used < oldest->used ) {
+            oldest = hash_entry;
+        }
+    }
+
+    if ( entry && entry->hash == hash ) {
+        entry->used = frame;
+        return( true );
+    }
+    if ( entry == NULL ) {
+        entry = oldest;
+        entry->area = *area;
+    }
+    entry->hash = hash;
+    entry->used = frame;
+    return( false );
+}
@@ -0,0 +1,99 @@
+/****************************************************************************
+ *   Oct 20 11:02:55 2026
+ *   Copyright  2026  My-TTGO-Watch contributors
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#ifndef _FRAMEBUFFER_AREAS_H
+    #define _FRAMEBUFFER_AREAS_H
+
+    #include <stdint.h>
+    #include <stdbool.h>
+
+    /*
+     * note:    this module is plain C without arduino dependencies,
+     *          tools/framebuffer_replay.cpp builds it on the host.
+     *
+     * the invalid area merge and the content hashes of the flushed bands
+     * behind framebuffer.cpp. areas have the same layout as lv_area_t with
+     * a 16 bit lv_coord_t, the caller copies them in and out.
+     */
+
+    /**
+     * @brief display area, inclusive coordinates
+     */
+    typedef struct {
+        int16_t x1;
+        int16_t y1;
+        int16_t x2;
+        int16_t y2;
+    } framebuffer_area_t;
+
+    /**
+     * @brief content hash of an area that is already on the display
+     */
+    typedef struct {
+        framebuffer_area_t area;                /** @brief display area */
+        uint32_t hash;                          /** @brief content hash */
+        uint32_t used;                          /** @brief frame number of the last use, 0 for a free entry */
+    } framebuffer_hash_t;
+
+    /**
+     * @brief get the number of pixels of an area
+     *
+     * @param   area        pointer to the area
+     *
+     * @return  pixels
+     */
+    uint32_t framebuffer_area_size( const framebuffer_area_t *area );
+    /**
+     * @brief merge invalid areas. two areas are merged if the bounding box wastes
+     * at most slack pixels, each merge saves one render pass and one address window
+     *
+     * @param   areas       area array, merged areas are grown in place
+     * @param   joined      joined flag per area like lv_disp_t.inv_area_joined, a merged away area is set to 1
+     * @param   count       number of areas
+     * @param   slack       max wasted pixels per merge
+     *
+     * @return  number of invalidated pixels before merging, joined areas not counted
+     */
+    uint32_t framebuffer_areas_merge( framebuffer_area_t *areas, uint8_t *joined, uint32_t count, uint32_t slack );
+    /**
+     * @brief fnv-1a hash over 16 bit pixels
+     *
+     * @param   px          pointer to the pixels
+     * @param   size        number of pixels
+     *
+     * @return  hash
+     */
+    uint32_t framebuffer_areas_hash( const uint16_t *px, uint32_t size );
+    /**
+     * @brief check if an area with the same content is already on the display and
+     * remember the new content. entries of overlapping areas are dropped, a new
+     * area replaces a free or the least recently used entry
+     *
+     * @param   hashes      hash table
+     * @param   entrys      number of entries
+     * @param   area        pointer to the flushed area
+     * @param   hash        content hash of the area
+     * @param   frame       current frame number, counted from 1
+     *
+     * @return  true if the content is unchanged
+     */
+    bool framebuffer_areas_check_hash( framebuffer_hash_t *hashes, uint32_t entrys, const framebuffer_area_t *area, uint32_t hash, uint32_t frame );
+
+#endif // _FRAMEBUFFER_AREAS_H
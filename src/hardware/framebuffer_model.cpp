@@ -0,0 +1,86 @@
+/****************************************************************************
+ *   Oct 20 09:41:17 2026
+ *   Copyright  2026  My-TTGO-Watch contributors
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#include "framebuffer_model.h"
+
+/**
+ * @brief spi time in ns for a number of bytes
+ */
+static uint64_t framebuffer_model_spi_ns( const framebuffer_model_t *model, uint64_t bytes ) {
+    return( bytes * 8 * 1000000000ull / model->spi_frequency );
+}
+
+void framebuffer_model_frame( const framebuffer_model_t *model, framebuffer_model_result_t *result ) {
+    uint64_t cpu = 0;                       /* time the cpu is done with its current step */
+    uint64_t spi_end = 0;                   /* time the spi bus is free again */
+    uint64_t render = 0, spi = 0, wait = 0;
+    uint32_t bands = 0;
+
+    for( uint32_t y = 0 ; y < model->height ; y += model->band_height ) {
+        uint32_t lines = model->height - y < model->band_height ? model->height - y : model->band_height;
+        uint64_t px = (uint64_t)model->width * lines;
+        uint64_t render_ns = model->band_overhead_us * 1000ull + px * model->render_ns_px + px * model->hash_ns_px;
+        uint64_t cmd_ns = framebuffer_model_spi_ns( model, model->cmd_bytes );
+        uint64_t pixel_ns = framebuffer_model_spi_ns( model, px * 2 );
+        /*
+         * with one buffer the band can only be rendered after the last one is out
+         */
+        if ( !model->double_buffer && spi_end > cpu ) {
+            wait += spi_end - cpu;
+            cpu = spi_end;
+        }
+        cpu += render_ns;
+        /*
+         * the address window needs a free bus, the pixels go out blocking or in background
+         */
+        if ( spi_end > cpu ) {
+            wait += spi_end - cpu;
+            cpu = spi_end;
+        }
+        cpu += cmd_ns;
+        if ( model->dma ) {
+            spi_end = cpu + pixel_ns;
+        }
+        else {
+            cpu += pixel_ns;
+            spi_end = cpu;
+        }
+        render += render_ns;
+        spi += cmd_ns + pixel_ns;
+        bands++;
+    }
+    /*
+     * the frame ends when the last band is on the display
+     */
+    uint64_t frame = cpu > spi_end ? cpu : spi_end;
+    result->frame_us = frame / 1000;
+    result->fps = frame ? 1000000000ull / frame : 0;
+    result->render_us = render / 1000;
+    result->spi_us = spi / 1000;
+    result->cpu_wait_us = ( wait + frame - cpu ) / 1000;
+    result->bands = bands;
+}
+
+uint32_t framebuffer_model_spi_bound_fps( const framebuffer_model_t *model ) {
+    uint32_t bands = ( model->height + model->band_height - 1 ) / model->band_height;
+    uint64_t bytes = (uint64_t)model->width * model->height * 2 + (uint64_t)bands * model->cmd_bytes;
+
+    return( model->spi_frequency / 8 / bytes );
+}
@@ -0,0 +1,82 @@
+/****************************************************************************
+ *   Oct 20 09:41:17 2026
+ *   Copyright  2026  My-TTGO-Watch contributors
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#ifndef _FRAMEBUFFER_MODEL_H
+    #define _FRAMEBUFFER_MODEL_H
+
+    #include <stdint.h>
+    #include <stdbool.h>
+
+    /*
+     * note:    this module is plain C without arduino dependencies,
+     *          tools/framebuffer_sim.cpp builds it on the host.
+     *
+     * band by band timing model of a full screen refresh like a tile swipe.
+     * LVGL renders a band, framebuffer_flush hashes it and sends the address
+     * window, then the pixels go out blocking or by DMA. with DMA and two
+     * buffers the next band is rendered while the last one is on the spi
+     * bus, with one buffer LVGL waits until the buffer is free again.
+     */
+
+    /**
+     * @brief model parameter
+     */
+    typedef struct {
+        uint32_t width;                 /** @brief display width in px */
+        uint32_t height;                /** @brief display height in px */
+        uint32_t band_height;           /** @brief framebuffer band height in lines */
+        bool dma;                       /** @brief pixels are sent by DMA */
+        bool double_buffer;             /** @brief two band buffers */
+        uint32_t spi_frequency;         /** @brief spi clock in Hz */
+        uint32_t cmd_bytes;             /** @brief spi bytes of the address window per band */
+        uint32_t render_ns_px;          /** @brief LVGL render time per pixel in ns */
+        uint32_t band_overhead_us;      /** @brief LVGL time per band independent of its size */
+        uint32_t hash_ns_px;            /** @brief content hash time per pixel in ns */
+    } framebuffer_model_t;
+
+    /**
+     * @brief model result for one frame
+     */
+    typedef struct {
+        uint32_t frame_us;              /** @brief time from the first render to the last pixel on the display */
+        uint32_t fps;                   /** @brief frames per second with back to back frames */
+        uint32_t render_us;             /** @brief cpu time for rendering and hashing */
+        uint32_t spi_us;                /** @brief spi bus time incl. address windows */
+        uint32_t cpu_wait_us;           /** @brief cpu time spent waiting for the spi bus or a free buffer */
+        uint32_t bands;                 /** @brief number of flushed bands */
+    } framebuffer_model_result_t;
+
+    /**
+     * @brief run the model for one full screen frame
+     *
+     * @param   model       pointer to the model parameter
+     * @param   result      pointer to the result
+     */
+    void framebuffer_model_frame( const framebuffer_model_t *model, framebuffer_model_result_t *result );
+    /**
+     * @brief theoretical upper bound, the spi bus never idles and rendering costs nothing
+     *
+     * @param   model       pointer to the model parameter, only size, band height, spi clock and cmd bytes are used
+     *
+     * @return  full screen frames per second
+     */
+    uint32_t framebuffer_model_spi_bound_fps( const framebuffer_model_t *model );
+
+#endif // _FRAMEBUFFER_MODEL_H
@@ -25,15 +25,35 @@
 #include "gpsctl.h"
 #include "powermgm.h"
 #include "callback.h"
+#include "scheduler.h"
+
+#if defined( LILYGO_WATCH_HAS_GPS )
+    #include <driver/uart.h>
+    #include <esp_timer.h>
+#endif
 
 static bool gpsctl_init = false;
 
 gpsctl_config_t gpsctl_config;
 callback_t *gpsctl_callback = NULL;
 gps_data_t gps_data;
+static gpsctl_stats_t gpsctl_stats;
 
 #if defined( LILYGO_WATCH_HAS_GPS )
-    TinyGPSPlus *gps = nullptr;
+    static QueueHandle_t gpsctl_uart_queue = NULL;
+    static nmea_parser_t gpsctl_parser;
+    /*
+     * last completed fix, handed over from the uart task to the loop
+     */
+    portMUX_TYPE DRAM_ATTR gpsctlMux = portMUX_INITIALIZER_UNLOCKED;
+    static nmea_fix_t gpsctl_fix;
+    static bool gpsctl_fix_pending = false;
+    TaskHandle_t _gpsctl_Task;
+
+    void gpsctl_Task( void * pvParameters );
+    static void gpsctl_uart_setup( void );
+    static void gpsctl_post_fix( const nmea_fix_t *fix );
+    static void gpsctl_update_fix( const nmea_fix_t *fix );
 #endif
 
 bool gpsctl_powermgm_loop_cb( EventBits_t event, void *arg );
@@ -56,12 +76,11 @@ void gpsctl_setup( void ) {
 
     #if defined( LILYGO_WATCH_HAS_GPS )
         /*
-         * init tinygps
+         * power up the receiver, the uart task parses the sentences as they arrive
          */
         TTGOClass *ttgo = TTGOClass::getWatch();
         ttgo->trunOnGPS();
-        ttgo->gps_begin();
-        gps = ttgo->gps;
+        gpsctl_uart_setup();
     #endif
 
     powermgm_register_cb( POWERMGM_SILENCE_WAKEUP | POWERMGM_STANDBY | POWERMGM_WAKEUP, gpsctl_powermgm_event_cb, "powermgm gpsctl" );
@@ -81,6 +100,170 @@ bool gpsctl_get_available( void ) {
     #endif
 }
 
+#if defined( LILYGO_WATCH_HAS_GPS )
+
+static void gpsctl_uart_setup( void ) {
+    uart_config_t uart_config;
+
+    memset( &uart_config, 0, sizeof( uart_config ) );
+    uart_config.baud_rate = GPSCTL_BAUD;
+    uart_config.data_bits = UART_DATA_8_BITS;
+    uart_config.parity = UART_PARITY_DISABLE;
+    uart_config.stop_bits = UART_STOP_BITS_1;
+    uart_config.flow_ctrl = UART_HW_FLOWCTRL_DISABLE;
+
+    nmea_init( &gpsctl_parser );
+    /*
+     * the uart driver sends an UART_DATA event when the rx fifo fills
+     * up or the line goes quiet, there is no polling
+     */
+    if ( uart_param_config( (uart_port_t)GPSCTL_UART, &uart_config ) != ESP_OK ||
+         uart_set_pin( (uart_port_t)GPSCTL_UART, GPS_TX, GPS_RX, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE ) != ESP_OK ||
+         uart_driver_install( (uart_port_t)GPSCTL_UART, GPSCTL_RX_BUFFER, 0, GPSCTL_EVENT_QUEUE, &gpsctl_uart_queue, 0 ) != ESP_OK ) {
+        log_e("gps uart setup failed");
+        return;
+    }
+    xTaskCreate(    gpsctl_Task,                /* Function to implement the task */
+                    "gpsctl Task",              /* Name of the task */
+                    2500,                       /* Stack size in words */
+                    NULL,                       /* Task input parameter */
+                    1,                          /* Priority of the task */
+                    &_gpsctl_Task );            /* Task handle. */
+}
+
+void gpsctl_Task( void * pvParameters ) {
+    uart_event_t event;
+    uint8_t data[ GPSCTL_READ_SIZE ];
+    nmea_fix_t fix;
+
+    log_i("start gpsctl task, heap: %d", ESP.getFreeHeap() );
+
+    while( true ) {
+        /*
+         * an open epoch is completed when the receiver is quiet after its burst
+         */
+        TickType_t timeout = nmea_pending( &gpsctl_parser ) ? pdMS_TO_TICKS( GPSCTL_EPOCH_IDLE ) : portMAX_DELAY;
+        if ( xQueueReceive( gpsctl_uart_queue, &event, timeout ) != pdTRUE ) {
+            if ( nmea_flush( &gpsctl_parser, &fix ) ) {
+                gpsctl_post_fix( &fix );
+            }
+            gpsctl_stats.nmea = gpsctl_parser.stats;
+            continue;
+        }
+        switch( event.type ) {
+            case UART_DATA: {
+                int len;
+                while( ( len = uart_read_bytes( (uart_port_t)GPSCTL_UART, data, sizeof( data ), 0 ) ) > 0 ) {
+                    uint64_t start = esp_timer_get_time();
+                    const char *next = (const char*)data;
+                    size_t left = len;
+                    while( left ) {
+                        if ( nmea_parse( &gpsctl_parser, &next, &left, &fix ) ) {
+                            gpsctl_post_fix( &fix );
+                        }
+                    }
+                    gpsctl_stats.parse_us += esp_timer_get_time() - start;
+                }
+                gpsctl_stats.nmea = gpsctl_parser.stats;
+                break;
+            }
+            case UART_FIFO_OVF:
+            case UART_BUFFER_FULL:
+                gpsctl_stats.uart_overruns++;
+                uart_flush_input( (uart_port_t)GPSCTL_UART );
+                xQueueReset( gpsctl_uart_queue );
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+/**
+ * @brief hand a completed fix to the loop, the changed fields of a fix
+ * the loop has not picked up yet are kept
+ */
+static void gpsctl_post_fix( const nmea_fix_t *fix ) {
+    portENTER_CRITICAL( &gpsctlMux );
+    uint32_t updated = gpsctl_fix_pending ? gpsctl_fix.updated : 0;
+    gpsctl_fix = *fix;
+    gpsctl_fix.updated |= updated;
+    gpsctl_fix_pending = true;
+    portEXIT_CRITICAL( &gpsctlMux );
+    scheduler_wakeup();
+}
+
+/**
+ * @brief copy a fix into gps_data and send one GPSCTL_UPDATE_FIX event
+ */
+static void gpsctl_update_fix( const nmea_fix_t *fix ) {
+    uint32_t updated = 0;
+
+    gps_data.valid_location = fix->valid & NMEA_LOCATION;
+    gps_data.valid_speed = fix->valid & NMEA_SPEED;
+    gps_data.valid_altitude = fix->valid & NMEA_ALTITUDE;
+    gps_data.valid_satellite = fix->valid & NMEA_SATELLITES;
+    gps_data.valid_time = ( fix->valid & NMEA_TIME ) && ( fix->valid & NMEA_DATE );
+
+    if ( fix->updated & NMEA_LOCATION ) {
+        gps_data.lat = fix->lat / 10000000.0;
+        gps_data.lon = fix->lon / 10000000.0;
+        updated |= GPSCTL_UPDATE_LOCATION;
+    }
+    if ( fix->updated & NMEA_SPEED ) {
+        gps_data.speed_mps = fix->speed_mmps / 1000.0;
+        gps_data.speed_kmh = gps_data.speed_mps * 3.6;
+        gps_data.speed_mph = gps_data.speed_mps * 2.236936;
+        updated |= GPSCTL_UPDATE_SPEED;
+    }
+    if ( fix->updated & NMEA_ALTITUDE ) {
+        gps_data.altitude_meters = fix->altitude_cm / 100.0;
+        gps_data.altitude_feed = gps_data.altitude_meters * 3.28084;
+        updated |= GPSCTL_UPDATE_ALTITUDE;
+    }
+    if ( fix->updated & NMEA_SATELLITES ) {
+        gps_data.satellites = fix->satellites;
+        updated |= GPSCTL_UPDATE_SATELLITE;
+    }
+    if ( fix->updated & NMEA_TIME ) {
+        updated |= GPSCTL_UPDATE_TIME;
+    }
+    if ( fix->updated & NMEA_DATE ) {
+        updated |= GPSCTL_UPDATE_DATE;
+    }
+    gps_data.time = nmea_get_unix_time( fix );
+
+    if ( gps_data.valid_location && gps_data.gps_source != GPS_SOURCE_GPS ) {
+        gps_data.gps_source = GPS_SOURCE_GPS;
+        updated |= GPSCTL_UPDATE_SOURCE;
+    }
+    /*
+     * send FIX and SET_APP_LOCATION or NOFIX
+     */
+    if ( gps_data.valid_location != gps_data.gpsfix ) {
+        gps_data.gpsfix = gps_data.valid_location;
+        if ( gps_data.gpsfix ) {
+            gpsctl_send_cb( GPSCTL_FIX, NULL );
+            if ( gpsctl_get_app_use_gps() ) {
+                gpsctl_send_cb( GPSCTL_SET_APP_LOCATION, (void*)&gps_data );
+            }
+        }
+        else {
+            gpsctl_send_cb( GPSCTL_NOFIX, NULL );
+        }
+    }
+    /*
+     * one event for all changed fields
+     */
+    if ( updated ) {
+        gps_data.updated = updated;
+        gpsctl_stats.events++;
+        gpsctl_send_cb( GPSCTL_UPDATE_FIX, (void*)&gps_data );
+    }
+}
+
+#endif
+
 bool gpsctl_powermgm_loop_cb( EventBits_t event, void *arg ) {
     /*
      * check if gpsctl already init
@@ -88,83 +271,36 @@ bool gpsctl_powermgm_loop_cb( EventBits_t event, void *arg ) {
     if ( !gpsctl_init ) {
         return( true );
     }
-    static uint64_t lastmillis = millis();
 
-    if ( millis() - lastmillis > GPSCTL_INTERVAL ) {
-        /*
-         * check if the last update is more than 2 times away
-         * to avoid callback bombing
-         */
-        if ( ( millis() - lastmillis ) > GPSCTL_INTERVAL * 2 ) {
-            lastmillis = millis();
+    #if defined( LILYGO_WATCH_HAS_GPS )
+        nmea_fix_t fix;
+        bool pending = false;
+
+        portENTER_CRITICAL( &gpsctlMux );
+        if ( gpsctl_fix_pending ) {
+            fix = gpsctl_fix;
+            gpsctl_fix_pending = false;
+            pending = true;
         }
-        else {
-            lastmillis =+ GPSCTL_INTERVAL;
+        portEXIT_CRITICAL( &gpsctlMux );
+
+        if ( pending ) {
+            gpsctl_update_fix( &fix );
         }
+    #else
+        static uint64_t lastmillis = millis();
 
-        #if defined( LILYGO_WATCH_HAS_GPS )
-            TTGOClass *ttgo = TTGOClass::getWatch();
-            ttgo->gpsHandler();
-            /*
-             * store valid state
-             */
-            gps_data.valid_location = gps->location.isValid();
-            gps_data.valid_speed = gps->speed.isValid();
-            gps_data.valid_satellite = gps->satellites.isValid();
-            gps_data.valid_altitude = gps->altitude.isValid();
-            /*
-             * send FIX, UPDATE_SOURCE and UPDATE_LOCATION
-             */
-            if ( gps_data.valid_location != gps_data.gpsfix ) {
-                gps_data.gpsfix = gps_data.valid_location;
-                if ( gps_data.gpsfix ) {
-                    /*
-                     * send FIX and SET_APP_LOCATION event 
-                     */
-                    gpsctl_send_cb( GPSCTL_FIX, NULL );
-                    if ( gpsctl_get_app_use_gps() ) {
-                        gps_data.lat = gps->location.lat();
-                        gps_data.lon = gps->location.lng();
-                        gpsctl_send_cb( GPSCTL_SET_APP_LOCATION, (void*)&gps_data );
-                    }
-                    gpsctl_send_cb( GPSCTL_UPDATE_SOURCE, (void*)&gps_data );
-                }
-                else {
-                    /*
-                     * send NOFIX event
-                     */
-                    gpsctl_send_cb( GPSCTL_NOFIX, NULL );
-                }
-            }
+        if ( millis() - lastmillis > GPSCTL_INTERVAL ) {
             /*
-             * check for data updates
+             * check if the last update is more than 2 times away
+             * to avoid callback bombing
              */
-            if ( gps->location.isUpdated() ) {
-                gps_data.gps_source = GPS_SOURCE_GPS;
-                gps_data.lat = gps->location.lat();
-                gps_data.lon = gps->location.lng();
-                gpsctl_send_cb( GPSCTL_UPDATE_LOCATION, (void*)&gps_data );
-            }
-            if ( gps->speed.isUpdated() ) {
-                gps_data.gps_source = GPS_SOURCE_GPS;
-                gps_data.speed_mph = gps->speed.mph();
-                gps_data.speed_mps = gps->speed.mps();
-                gps_data.speed_kmh = gps->speed.kmph();
-                gpsctl_send_cb( GPSCTL_UPDATE_SPEED, (void*)&gps_data );
+            if ( ( millis() - lastmillis ) > GPSCTL_INTERVAL * 2 ) {
+                lastmillis = millis();
             }
-            if ( gps->altitude.isUpdated()) {
-                gps_data.gps_source = GPS_SOURCE_GPS;
-                gps_data.altitude_feed = gps->altitude.feet();
-                gps_data.altitude_meters = gps->altitude.meters();
-                gpsctl_send_cb( GPSCTL_UPDATE_ALTITUDE, (void*)&gps_data );
+            else {
+                lastmillis += GPSCTL_INTERVAL;
             }
-            if ( gps->satellites.isUpdated() ) {
-                gps_data.gps_source = GPS_SOURCE_GPS;
-                gps_data.satellites = gps->satellites.value();
-                gpsctl_send_cb( GPSCTL_UPDATE_SATELLITE, (void*)&gps_data );
-            }
-
-        #else
             /*
              * send only when valid_location and gpsfix not equal
              */
@@ -172,11 +308,11 @@ bool gpsctl_powermgm_loop_cb( EventBits_t event, void *arg ) {
                 gps_data.gpsfix = gps_data.valid_location;
                 if ( gps_data.gpsfix ) {
                     /*
-                     * send FIX, UPDATE_SOURCE and UPDATE_LOCATION
+                     * send FIX and UPDATE_FIX with location and source
                      */
                     gpsctl_send_cb( GPSCTL_FIX, NULL );
-                    gpsctl_send_cb( GPSCTL_UPDATE_LOCATION, (void*)&gps_data );
-                    gpsctl_send_cb( GPSCTL_UPDATE_SOURCE, (void*)&gps_data );
+                    gps_data.updated = GPSCTL_UPDATE_LOCATION | GPSCTL_UPDATE_SOURCE;
+                    gpsctl_send_cb( GPSCTL_UPDATE_FIX, (void*)&gps_data );
                     /*
                      * send SET_APP_LOCATION if enabled
                      */
@@ -191,8 +327,8 @@ bool gpsctl_powermgm_loop_cb( EventBits_t event, void *arg ) {
                     gpsctl_send_cb( GPSCTL_NOFIX, NULL );
                 }
             }
-        #endif
-    }
+        }
+    #endif
 
     return( true );
 }
@@ -376,11 +512,11 @@ void gpsctl_set_location( double lat, double lon, gps_source_t gps_source ) {
     gps_data.lat = lat;
     gps_data.lon = lon;
     /*
-     * send FIX, UPDATE_SOURCE and UPDATE_LOCATION
+     * send FIX and UPDATE_FIX with location and source
      */
     gpsctl_send_cb( GPSCTL_FIX, NULL );
-    gpsctl_send_cb( GPSCTL_UPDATE_LOCATION, (void*)&gps_data );
-    gpsctl_send_cb( GPSCTL_UPDATE_SOURCE, (void*)&gps_data );
+    gps_data.updated = GPSCTL_UPDATE_LOCATION | GPSCTL_UPDATE_SOURCE;
+    gpsctl_send_cb( GPSCTL_UPDATE_FIX, (void*)&gps_data );
     /*
      * send SET_APP_LOCATION if enabled
      */
@@ -413,4 +549,8 @@ const char *gpsctl_get_source_str( gps_source_t gps_source ) {
     }
 
     return( ret_val );
+}
+
+const gpsctl_stats_t *gpsctl_get_stats( void ) {
+    return( &gpsctl_stats );
 }
\ No newline at end of file
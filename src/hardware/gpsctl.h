@@ -25,22 +25,30 @@
     #include "TTGO.h"
     #include "callback.h"
     #include "hardware/config/gpsctlconfig.h"
+    #include "utils/nmea.h"
 
-    #define GPSCTL_INTERVAL             1000           /** @brief gps data intervall in milliseconds */
+    #define GPSCTL_INTERVAL             1000           /** @brief gps data intervall in milliseconds without gps receiver */
+    #define GPSCTL_UART                 1              /** @brief uart number of the gps receiver */
+    #define GPSCTL_BAUD                 9600           /** @brief gps receiver baud rate */
+    #define GPSCTL_RX_BUFFER            1024           /** @brief uart driver rx buffer, more than one burst of sentences */
+    #define GPSCTL_EVENT_QUEUE          16             /** @brief uart driver event queue length */
+    #define GPSCTL_READ_SIZE            128            /** @brief bytes per uart read in the gpsctl task */
+    #define GPSCTL_EPOCH_IDLE           50             /** @brief quiet time in ms after a burst that completes a fix */
 
     #define GPSCTL_ENABLE               _BV(0)         /** @brief event mask for GPS enabled */
     #define GPSCTL_DISABLE              _BV(1)         /** @brief event mask for GPS disable */
     #define GPSCTL_FIX                  _BV(2)         /** @brief event mask for GPS has an fix */
     #define GPSCTL_NOFIX                _BV(3)         /** @brief event mask for GPS has no fix */
     #define GPSCTL_SET_APP_LOCATION     _BV(4)         /** @brief event mask for GPS set location for user application like weather-app */
-    #define GPSCTL_UPDATE_LOCATION      _BV(5)         /** @brief event mask for GPS location update */
-    #define GPSCTL_UPDATE_DATE          _BV(6)         /** @brief event mask for GPS date update */
-    #define GPSCTL_UPDATE_TIME          _BV(7)         /** @brief event mask for GPS time update*/
-    #define GPSCTL_UPDATE_SPEED         _BV(8)         /** @brief event mask for GPS speed update*/
-    #define GPSCTL_UPDATE_ALTITUDE      _BV(9)         /** @brief event mask for GPS altitude update*/
-    #define GPSCTL_UPDATE_SATELLITE     _BV(10)        /** @brief event mask for GPS satellite update*/
-    #define GPSCTL_UPDATE_SOURCE        _BV(11)        /** @brief event mask for GPS source update*/
+    #define GPSCTL_UPDATE_LOCATION      _BV(5)         /** @brief changed field flag in gps_data_t.updated for location */
+    #define GPSCTL_UPDATE_DATE          _BV(6)         /** @brief changed field flag in gps_data_t.updated for date */
+    #define GPSCTL_UPDATE_TIME          _BV(7)         /** @brief changed field flag in gps_data_t.updated for time */
+    #define GPSCTL_UPDATE_SPEED         _BV(8)         /** @brief changed field flag in gps_data_t.updated for speed */
+    #define GPSCTL_UPDATE_ALTITUDE      _BV(9)         /** @brief changed field flag in gps_data_t.updated for altitude */
+    #define GPSCTL_UPDATE_SATELLITE     _BV(10)        /** @brief changed field flag in gps_data_t.updated for satellites */
+    #define GPSCTL_UPDATE_SOURCE        _BV(11)        /** @brief changed field flag in gps_data_t.updated for source */
     #define GPSCTL_UPDATE_CONFIG        _BV(12)        /** @brief event mask for GPS configuration*/
+    #define GPSCTL_UPDATE_FIX           _BV(13)        /** @brief event mask for a new fix, one event per fix with the changed fields in gps_data_t.updated */
     /**
      * @brief gps source types
      */
@@ -70,7 +78,19 @@
         double altitude_feed = 0;                       /** @brief altitude in feed */
         double altitude_meters = 0;                     /** @brief altitude in meter */
         uint32_t satellites = 0;                        /** @brief number of seen satellites */
+        bool valid_time = false;                        /** @brief true if time and date valid */
+        uint32_t time = 0;                              /** @brief utc unix time of the fix */
+        uint32_t updated = 0;                           /** @brief changed fields in GPSCTL_UPDATE_FIX, GPSCTL_UPDATE_* flags */
     } gps_data_t;
+    /**
+     * @brief gps receiver statistic
+     */
+    typedef struct {
+        nmea_stats_t nmea;                              /** @brief nmea parser statistic */
+        uint32_t uart_overruns;                         /** @brief uart fifo or buffer overflows */
+        uint32_t events;                                /** @brief GPSCTL_UPDATE_FIX events from the receiver */
+        uint64_t parse_us;                              /** @brief cpu time in the uart task in us */
+    } gpsctl_stats_t;
     /**
      * @brief setup gps
      */
@@ -155,5 +175,11 @@
      * @param gps_source gps source enum
      */
     const char *gpsctl_get_source_str( gps_source_t gps_source );
+    /**
+     * @brief get the gps receiver statistic
+     *
+     * @return  pointer to the statistic
+     */
+    const gpsctl_stats_t *gpsctl_get_stats( void );
 
 #endif // _GPSCTL_H
\ No newline at end of file
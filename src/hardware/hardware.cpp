@@ -18,18 +18,31 @@
 #include "hardware/pmu.h"
 #include "hardware/powermgm.h"
 #include "hardware/rtcctl.h"
+#include "hardware/scheduler.h"
 #include "hardware/sound.h"
 #include "hardware/timesync.h"
 #include "hardware/touch.h"
 #include "hardware/wifictl.h"
 
 #include "utils/fakegps.h"
+#include "utils/bench.h"
+#include "utils/worker.h"
+#include "utils/basejsonconfig.h"
+#include "utils/event_journal.h"
+#include "utils/history.h"
+#include "utils/battery_runtime.h"
+#include "utils/track_recorder.h"
 
 void hardware_setup( void ) {
     /**
      * pre hardware/powermgm setup
      */
     powermgm_setup();
+    scheduler_setup();
+    bench_setup();
+    event_journal_setup();
+    worker_setup();
+    basejsonconfig_setup();
 
     TTGOClass *ttgo = TTGOClass::getWatch();
     ttgo->begin();
@@ -66,6 +79,9 @@ void hardware_setup( void ) {
     blectl_read_config();
     sound_read_config();
     fakegps_setup();
+    history_setup();
+    battery_runtime_setup();
+    track_recorder_setup();
     
     splash_screen_stage_update( "init gui", 80 );
     splash_screen_stage_finish();
@@ -29,6 +29,7 @@
 #include "motor.h"
 #include "blectl.h"
 #include "callback.h"
+#include "scheduler.h"
 
 #include "gui/statusbar.h"
 
@@ -151,6 +152,7 @@ void IRAM_ATTR  pmu_irq( void ) {
     portENTER_CRITICAL_ISR(&PMU_IRQ_Mux);
     pmu_irq_flag = true;
     portEXIT_CRITICAL_ISR(&PMU_IRQ_Mux);
+    scheduler_wakeup_from_isr();
 }
 
 void pmu_loop( void ) {
@@ -40,6 +40,9 @@
 #include "rtcctl.h"
 #include "sound.h"
 #include "gpsctl.h"
+#include "scheduler.h"
+
+#include "utils/bench.h"
 
 EventGroupHandle_t powermgm_status = NULL;
 portMUX_TYPE DRAM_ATTR powermgmMux = portMUX_INITIALIZER_UNLOCKED;
@@ -49,11 +52,21 @@ callback_t *powermgm_loop_callback = NULL;
 
 esp_pm_config_esp32_t pm_config;
 
+static int32_t powermgm_bench_standby = -1;
+static int32_t powermgm_bench_silence_wakeup = -1;
+static int32_t powermgm_bench_wakeup = -1;
+
 bool powermgm_send_event_cb( EventBits_t event );
 bool powermgm_send_loop_event_cb( EventBits_t event );
 
 void powermgm_setup( void ) {
     powermgm_status = xEventGroupCreate();
+    /**
+     * register loop benchmarks
+     */
+    powermgm_bench_standby = bench_register( "powermgm loop standby", POWERMGM_LOOP_BUDGET_US );
+    powermgm_bench_silence_wakeup = bench_register( "powermgm loop silence wakeup", POWERMGM_LOOP_BUDGET_US );
+    powermgm_bench_wakeup = bench_register( "powermgm loop wakeup", POWERMGM_LOOP_BUDGET_US );
 }
 
 void powermgm_loop( void ) {
@@ -70,6 +83,14 @@ void powermgm_loop( void ) {
         }
         powermgm_clear_event( POWERMGM_POWER_BUTTON );
     }
+    /*
+     * reset requested from an other task, the reset callbacks write their
+     * pending data from the loop task
+     */
+    if ( powermgm_get_event( POWERMGM_RESET_REQUEST ) ) {
+        powermgm_clear_event( POWERMGM_RESET_REQUEST );
+        powermgm_reset();
+    }
     /*
      * when we are in wakeup and get an wakeup request, reset activity timer
      */
@@ -241,13 +262,19 @@ void powermgm_loop( void ) {
          */
         if ( !lighsleep )
             vTaskDelay( 250 );
+        uint64_t bench_start = bench_begin( powermgm_bench_standby );
         powermgm_send_loop_event_cb( POWERMGM_STANDBY );
+        bench_end( powermgm_bench_standby, bench_start );
     }
     else if ( powermgm_get_event( POWERMGM_WAKEUP ) ) {
+        uint64_t bench_start = bench_begin( powermgm_bench_wakeup );
         powermgm_send_loop_event_cb( POWERMGM_WAKEUP );
+        bench_end( powermgm_bench_wakeup, bench_start );
     }
     else if ( powermgm_get_event( POWERMGM_SILENCE_WAKEUP ) ) {
+        uint64_t bench_start = bench_begin( powermgm_bench_silence_wakeup );
         powermgm_send_loop_event_cb( POWERMGM_SILENCE_WAKEUP );
+        bench_end( powermgm_bench_silence_wakeup, bench_start );
     }
 }
 
@@ -265,6 +292,7 @@ void powermgm_set_event( EventBits_t bits ) {
     portENTER_CRITICAL(&powermgmMux);
     xEventGroupSetBits( powermgm_status, bits );
     portEXIT_CRITICAL(&powermgmMux);
+    scheduler_wakeup();
 }
 
 void powermgm_clear_event( EventBits_t bits ) {
@@ -34,8 +34,11 @@
     #define POWERMGM_POWER_BUTTON               _BV(6)         /** @brief event mask for powermgm pmu button is pressed */
     #define POWERMGM_SHUTDOWN                   _BV(12)        /** @brief event mask for powermgm shutdown */
     #define POWERMGM_RESET                      _BV(13)        /** @brief event mask for powermgm reset */
+    #define POWERMGM_RESET_REQUEST              _BV(14)        /** @brief event mask for powermgm reset request from an other task */
     #define POWERMGM_DISABLE_INTERRUPTS         _BV(15)        
     #define POWERMGM_ENABLE_INTERRUPTS          _BV(16)        
+
+    #define POWERMGM_LOOP_BUDGET_US             20000          /** @brief max average runtime for one loop in us before an regression is reported */
     
     /**
      * @brief setp power managment, coordinate managment beween CPU, wifictl, pmu, bma, display, backlight and lvgl
@@ -53,6 +56,11 @@
      * @brief power managment loop routine, call from loop. not for user use
      */
     void powermgm_loop( void );
+    /**
+     * @brief send POWERMGM_RESET to all registered callback functions and restart,
+     * call only from the loop task, other tasks set POWERMGM_RESET_REQUEST
+     */
+    void powermgm_reset( void );
     /**
      * @brief trigger a power managemt event
      * 
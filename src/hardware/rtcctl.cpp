@@ -26,6 +26,7 @@
 #include "rtcctl.h"
 #include "powermgm.h"
 #include "callback.h"
+#include "scheduler.h"
 #include "timesync.h"
 
 static rtcctl_alarm_t alarm_data; 
@@ -169,6 +170,7 @@ void IRAM_ATTR rtcctl_irq( void ) {
     portENTER_CRITICAL_ISR(&RTC_IRQ_Mux);
     rtc_irq_flag = true;
     portEXIT_CRITICAL_ISR(&RTC_IRQ_Mux);
+    scheduler_wakeup_from_isr();
 }
 
 bool rtcctl_powermgm_loop_cb( EventBits_t event, void *arg ) {
@@ -0,0 +1,127 @@
+/****************************************************************************
+ *   Oct 18 13:07:52 2026
+ *   Copyright  2026  My-TTGO-Watch contributors
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#include "config.h"
+#include <TTGO.h>
+#include <esp_timer.h>
+
+#include "scheduler.h"
+#include "powermgm.h"
+
+static SemaphoreHandle_t scheduler_semaphore = NULL;
+static TaskHandle_t scheduler_task = NULL;
+static uint32_t scheduler_deadline = SCHEDULER_MAX_SLEEP;
+
+static uint32_t scheduler_wakeups = 0;
+static uint64_t scheduler_idle_us = 0;
+static uint64_t scheduler_report_start = 0;
+static uint32_t scheduler_wakeups_per_minute = 0;
+static uint32_t scheduler_idle_percent = 0;
+
+void scheduler_setup( void ) {
+    scheduler_semaphore = xSemaphoreCreateBinary();
+    if ( scheduler_semaphore == NULL ) {
+        log_e("scheduler semaphore alloc failed");
+        return;
+    }
+    scheduler_report_start = esp_timer_get_time();
+}
+
+/**
+ * @brief update wakeup and idle statistic every SCHEDULER_REPORT_INTERVAL seconds
+ */
+static void scheduler_update_stats( void ) {
+    uint64_t now = esp_timer_get_time();
+    uint64_t elapsed = now - scheduler_report_start;
+
+    if ( elapsed < SCHEDULER_REPORT_INTERVAL * 1000000ULL ) {
+        return;
+    }
+    scheduler_wakeups_per_minute = ( (uint64_t)scheduler_wakeups * 60000000ULL ) / elapsed;
+    scheduler_idle_percent = ( scheduler_idle_us * 100 ) / elapsed;
+    log_i("scheduler: %d wakeups/min, %d%% idle", scheduler_wakeups_per_minute, scheduler_idle_percent );
+
+    scheduler_wakeups = 0;
+    scheduler_idle_us = 0;
+    scheduler_report_start = now;
+}
+
+void scheduler_loop( void ) {
+    if ( scheduler_task == NULL ) {
+        scheduler_task = xTaskGetCurrentTaskHandle();
+    }
+    /*
+     * loop callbacks lower the deadline if they need the next loop earlier
+     */
+    scheduler_deadline = SCHEDULER_MAX_SLEEP;
+    powermgm_loop();
+    /*
+     * standby handles sleep by itself, pending requests are handled without delay
+     */
+    if ( !powermgm_get_event( POWERMGM_WAKEUP | POWERMGM_SILENCE_WAKEUP ) ) {
+        scheduler_report_start = esp_timer_get_time();
+        scheduler_wakeups = 0;
+        scheduler_idle_us = 0;
+        return;
+    }
+    scheduler_wakeups++;
+    if ( scheduler_semaphore && scheduler_deadline > 0 && !powermgm_get_event( POWERMGM_POWER_BUTTON | POWERMGM_STANDBY_REQUEST | POWERMGM_WAKEUP_REQUEST | POWERMGM_SILENCE_WAKEUP_REQUEST ) ) {
+        uint64_t start = esp_timer_get_time();
+        xSemaphoreTake( scheduler_semaphore, pdMS_TO_TICKS( scheduler_deadline ) );
+        scheduler_idle_us += esp_timer_get_time() - start;
+    }
+    scheduler_update_stats();
+}
+
+void scheduler_set_deadline( uint32_t ms ) {
+    if ( ms < scheduler_deadline ) {
+        scheduler_deadline = ms;
+    }
+}
+
+void scheduler_wakeup( void ) {
+    /*
+     * events from the loop itself are seen before the next sleep
+     */
+    if ( scheduler_semaphore == NULL || xTaskGetCurrentTaskHandle() == scheduler_task ) {
+        return;
+    }
+    xSemaphoreGive( scheduler_semaphore );
+}
+
+void IRAM_ATTR scheduler_wakeup_from_isr( void ) {
+    BaseType_t woken = pdFALSE;
+
+    if ( scheduler_semaphore == NULL ) {
+        return;
+    }
+    xSemaphoreGiveFromISR( scheduler_semaphore, &woken );
+    if ( woken ) {
+        portYIELD_FROM_ISR();
+    }
+}
+
+uint32_t scheduler_get_wakeups_per_minute( void ) {
+    return( scheduler_wakeups_per_minute );
+}
+
+uint32_t scheduler_get_idle_percent( void ) {
+    return( scheduler_idle_percent );
+}
@@ -0,0 +1,65 @@
+/****************************************************************************
+ *   Oct 18 13:07:52 2026
+ *   Copyright  2026  My-TTGO-Watch contributors
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#ifndef _SCHEDULER_H
+    #define _SCHEDULER_H
+
+    #include <stdint.h>
+
+    #define SCHEDULER_MAX_SLEEP             1000        /** @brief max time in ms between two loops in wakeup and silence wakeup */
+    #define SCHEDULER_REPORT_INTERVAL       60          /** @brief wakeup and idle statistic interval in seconds */
+
+    /**
+     * @brief setup the scheduler, call after powermgm_setup
+     */
+    void scheduler_setup( void );
+    /**
+     * @brief run one powermgm loop and sleep until the next deadline or wakeup, call from loop
+     */
+    void scheduler_loop( void );
+    /**
+     * @brief request the next loop in max ms, call from a powermgm loop callback.
+     * the earliest deadline from all loop callbacks wins
+     *
+     * @param   ms          time in ms until the next loop is needed, 0 for no sleep
+     */
+    void scheduler_set_deadline( uint32_t ms );
+    /**
+     * @brief wakeup the loop before the next deadline, call from task context
+     */
+    void scheduler_wakeup( void );
+    /**
+     * @brief wakeup the loop before the next deadline, call from an interrupt
+     */
+    void scheduler_wakeup_from_isr( void );
+    /**
+     * @brief get the number of loops per minute in the last report interval
+     *
+     * @return  loops per minute
+     */
+    uint32_t scheduler_get_wakeups_per_minute( void );
+    /**
+     * @brief get the idle time in the last report interval
+     *
+     * @return  idle time in percent
+     */
+    uint32_t scheduler_get_idle_percent( void );
+
+#endif // _SCHEDULER_H
@@ -27,6 +27,7 @@
 
 #include "sound.h"
 #include "callback.h"
+#include "scheduler.h"
 #include "hardware/config/soundconfig.h"
 
 /*
@@ -42,14 +43,14 @@
 #include "AudioOutputI2S.h"
 #include <ESP8266SAM.h>
 
-AudioFileSourceSPIFFS *spliffs_file;
+AudioFileSourceSPIFFS *spliffs_file = NULL;
 AudioOutputI2S *out;
-AudioFileSourceID3 *id3;
+AudioFileSourceID3 *id3 = NULL;
 
 AudioGeneratorMP3 *mp3;
 AudioGeneratorWAV *wav;
 ESP8266SAM *sam;
-AudioFileSourcePROGMEM *progmem_file;
+AudioFileSourcePROGMEM *progmem_file = NULL;
 
 bool sound_init = false;
 bool is_speaking = false;
@@ -150,6 +151,12 @@ bool sound_powermgm_loop_cb( EventBits_t event, void *arg ) {
             log_i("stop playing wav sound");
             wav->stop(); 
         }
+        /**
+         * feed the decoder without delay while playing
+         */
+        if ( mp3->isRunning() || wav->isRunning() ) {
+            scheduler_set_deadline( 0 );
+        }
     }
     return( true );
 }
@@ -230,6 +237,12 @@ void sound_play_spiffs_mp3( const char *filename ) {
 
     if ( sound_config.enable && sound_init ) {
         log_i("playing file %s from SPIFFS", filename);
+        /**
+         * release the file source from the last play
+         */
+        if ( mp3->isRunning() ) mp3->stop();
+        delete id3;
+        delete spliffs_file;
         spliffs_file = new AudioFileSourceSPIFFS(filename);
         id3 = new AudioFileSourceID3(spliffs_file);
         mp3->begin(id3, out);
@@ -248,6 +261,11 @@ void sound_play_progmem_wav( const void *data, uint32_t len ) {
 
     if ( sound_config.enable && sound_init ) {
         log_i("playing audio (size %d) from PROGMEM ", len );
+        /**
+         * release the source from the last play
+         */
+        if ( wav->isRunning() ) wav->stop();
+        delete progmem_file;
         progmem_file = new AudioFileSourcePROGMEM( data, len );
         wav->begin(progmem_file, out);
     } else {
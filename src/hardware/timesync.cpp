@@ -30,14 +30,15 @@
 #include "callback.h"
 
 #include "hardware/config/timesyncconfig.h"
+#include "utils/worker.h"
 
 EventGroupHandle_t time_event_handle = NULL;
-TaskHandle_t _timesync_Task;
 timesync_config_t timesync_config;
 
 callback_t *timesync_callback = NULL;
 
-void timesync_Task( void * pvParameters );
+int32_t timesync_job( worker_job_t *job );
+void timesync_job_done( worker_job_t *job );
 bool timesync_powermgm_event_cb( EventBits_t event, void *arg );
 bool timesync_wifictl_event_cb( EventBits_t event, void *arg );
 bool timesync_blectl_event_cb( EventBits_t event, void *arg );
@@ -136,15 +137,12 @@ bool timesync_wifictl_event_cb( EventBits_t event, void *arg ) {
                 }
                 else {
                     /*
-                     * start timesync task
+                     * queue timesync job
                      */
                     xEventGroupSetBits( time_event_handle, TIME_SYNC_REQUEST );
-                    xTaskCreate(    timesync_Task,      /* Function to implement the task */
-                                    "timesync Task",    /* Name of the task */
-                                    2000,              /* Stack size in words */
-                                    NULL,               /* Task input parameter */
-                                    1,                  /* Priority of the task */
-                                    &_timesync_Task );  /* Task handle. */
+                    if ( worker_submit( "timesync", timesync_job, timesync_job_done, NULL, WORKER_PRIO_NORMAL ) == WORKER_NO_JOB ) {
+                        xEventGroupClearBits( time_event_handle, TIME_SYNC_REQUEST );
+                    }
                 }
             }
             break;
@@ -268,9 +266,7 @@ void timesyncToRTC( void ) {
     timesync_send_event_cb( TIME_SYNC_UPDATE, (void *)NULL );
 }
 
-void timesync_Task( void * pvParameters ) {
-  log_i("start time sync task, heap: %d", ESP.getFreeHeap() );
-
+int32_t timesync_job( worker_job_t *job ) {
     if ( xEventGroupGetBits( time_event_handle ) & TIME_SYNC_REQUEST ) { 
         struct tm info;
 
@@ -283,7 +279,9 @@ void timesync_Task( void * pvParameters ) {
             xEventGroupSetBits( time_event_handle, TIME_SYNC_OK );
         }
     }
+    return( 0 );
+}
+
+void timesync_job_done( worker_job_t *job ) {
     xEventGroupClearBits( time_event_handle, TIME_SYNC_REQUEST );
-    log_i("finish time sync task, heap: %d", ESP.getFreeHeap() );
-    vTaskDelete( NULL );
 }
@@ -20,30 +20,63 @@
  *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
  */
 #include "config.h"
+#include <esp_timer.h>
 #include "touch.h"
 #include "powermgm.h"
 #include "motor.h"
 #include "display.h"
 #include "callback.h"
+#include "scheduler.h"
+#include "hardware/config/touchconfig.h"
 
 volatile bool DRAM_ATTR touch_irq_flag = false;
+volatile int64_t DRAM_ATTR touch_irq_us = 0;
 portMUX_TYPE DRAM_ATTR Touch_IRQ_Mux = portMUX_INITIALIZER_UNLOCKED;
 void IRAM_ATTR touch_irq( void );
 callback_t *touch_callback = NULL;
+touch_config_t touch_config;
 
 bool touched = false;
 
 lv_indev_t *touch_indev = NULL;
+/*
+ * the loop samples the controller into the ring, lvgl reads it out,
+ * both run in the main loop task
+ */
+static touch_sample_t touch_ring[ TOUCH_RING_SIZE ];
+static uint8_t touch_ring_head = 0;
+static uint8_t touch_ring_tail = 0;
+static touch_sample_t touch_last_sample = { 0, 0, false, false };
+static touch_filter_t touch_filter;
+static touch_gesture_t touch_gesture;
+static touch_stats_t touch_stats;
+static bool touch_press = false;
+static uint32_t touch_press_ms = 0;
+static uint32_t touch_next_sample = 0;
+static int64_t touch_press_irq_us = 0;
+static uint64_t touch_latency_sum = 0;
+static uint32_t touch_latency_count = 0;
+static int16_t touch_last_x = 0;
+static int16_t touch_last_y = 0;
 
 static bool touch_read(lv_indev_drv_t * drv, lv_indev_data_t*data);
-static bool touch_getXY( int16_t &x, int16_t &y );
+static void touch_sample( void );
+static void touch_ring_push( int16_t x, int16_t y, bool pressed, bool first );
+static void touch_release( uint32_t now );
 bool touch_powermgm_event_cb( EventBits_t event, void *arg );
+bool touch_powermgm_loop_cb( EventBits_t event, void *arg );
 bool touch_send_event_cb( EventBits_t event, void *arg );
 
 static SemaphoreHandle_t xSemaphores = NULL;
 
 void touch_setup( void ) {
     TTGOClass *ttgo = TTGOClass::getWatch();
+    /*
+     * read calibration and filter config
+     */
+    touch_config.load();
+    touch_filter_init( &touch_filter, touch_config.filter_latency );
+    touch_gesture_init( &touch_gesture, lv_disp_get_hor_res( NULL ), lv_disp_get_ver_res( NULL ) );
     /*
      * reset/wakeup touch controller
      */
@@ -79,6 +112,7 @@ void touch_setup( void ) {
      * register powermgm callback function
      */
     powermgm_register_cb( POWERMGM_SILENCE_WAKEUP | POWERMGM_STANDBY | POWERMGM_WAKEUP | POWERMGM_ENABLE_INTERRUPTS | POWERMGM_DISABLE_INTERRUPTS , touch_powermgm_event_cb, "touch" );
+    powermgm_register_loop_cb( POWERMGM_WAKEUP, touch_powermgm_loop_cb, "touch loop" );
 }
 
 bool touch_register_cb( EventBits_t event, CALLBACK_FUNC callback_func, const char *id ) {
@@ -102,6 +136,7 @@ bool touch_send_event_cb( EventBits_t event, void *arg ) {
   /*
     * call all callbacks with her event mask
     */
+  touch_stats.events++;
   return( callback_send( touch_callback, event, arg ) );
 }
 
@@ -112,10 +147,24 @@ void touch_lock_give( void ) {
     xSemaphoreGive( xSemaphores );
 }
 
+const touch_stats_t *touch_get_stats( void ) {
+    touch_stats.latency_us = touch_latency_count ? touch_latency_sum / touch_latency_count : 0;
+    return( &touch_stats );
+}
+
+uint16_t touch_get_filter_latency( void ) {
+    return( touch_config.filter_latency );
+}
+
 bool touch_powermgm_event_cb( EventBits_t event, void *arg ) {
     TTGOClass *ttgo = TTGOClass::getWatch();
     switch( event ) {
         case POWERMGM_STANDBY:          log_i("go standby");
+                                        /*
+                                         * end a touch that is still open
+                                         */
+                                        touch_release( millis() );
+                                        touched = false;
                                         if ( touch_lock_take() ) {
                                             ttgo->touchToMonitor();
                                             touch_lock_give();
@@ -143,47 +192,8 @@ bool touch_powermgm_event_cb( EventBits_t event, void *arg ) {
     return( true );
 }
 
-static bool touch_getXY( int16_t &x, int16_t &y ) {
-    
-    TTGOClass *ttgo = TTGOClass::getWatch();
-    static bool touch_press = false;
-
-    // disable touch when we are in standby or silence wakeup
-    if ( powermgm_get_event( POWERMGM_STANDBY | POWERMGM_SILENCE_WAKEUP ) ) {
-        return( false );
-    }
-    /*
-     * get touchstate from touchcontroller if not taken
-     * by other task/thread
-     */
-    bool getTouchResult = false;
-    if ( touch_lock_take() ) {
-        getTouchResult = ttgo->getTouch( x, y );
-        touch_lock_give();
-    }
-    /*
-     * if touched?
-     */
-    if ( !getTouchResult ) {
-        touch_press = false;
-        return( false );
-    }
-    /*
-     * wibe if touched
-     */
-    if ( !touch_press ) {
-        touch_press = true;
-        if ( display_get_vibe() )
-            motor_vibe( 3 );
-    }
-    /*
-     * issue https://github.com/sharandac/My-TTGO-Watch/issues/18 fix
-     */
-    float temp_x = ( x - ( lv_disp_get_hor_res( NULL ) / 2 ) ) * 1.15;
-    float temp_y = ( y - ( lv_disp_get_ver_res( NULL ) / 2 ) ) * 1.0;
-    x = temp_x + ( lv_disp_get_hor_res( NULL ) / 2 );
-    y = temp_y + ( lv_disp_get_ver_res( NULL ) / 2 );
-
+bool touch_powermgm_loop_cb( EventBits_t event, void *arg ) {
+    touch_sample();
     return( true );
 }
 
@@ -193,50 +203,178 @@ void IRAM_ATTR touch_irq( void ) {
      */
     portENTER_CRITICAL_ISR(&Touch_IRQ_Mux);
     touch_irq_flag = true;
+    touch_irq_us = esp_timer_get_time();
     /*
      * leave critical section
      */
     portEXIT_CRITICAL_ISR(&Touch_IRQ_Mux);
+    scheduler_wakeup_from_isr();
 }
 
-static bool touch_read(lv_indev_drv_t * drv, lv_indev_data_t*data) {
+static void touch_ring_push( int16_t x, int16_t y, bool pressed, bool first ) {
+    uint8_t next = ( touch_ring_head + 1 ) % TOUCH_RING_SIZE;
     /*
-     * We use two flags, one changes in the interrupt handler
-     * the other controls whether we poll the sensor,
-     * and gets cleared when the level is no longer low,
-     * meaning the touch has finished
+     * drop the oldest sample if lvgl is behind, the newest state counts
      */
+    if ( next == touch_ring_tail ) {
+        touch_ring_tail = ( touch_ring_tail + 1 ) % TOUCH_RING_SIZE;
+        touch_stats.overruns++;
+    }
+    touch_ring[ touch_ring_head ].x = x;
+    touch_ring[ touch_ring_head ].y = y;
+    touch_ring[ touch_ring_head ].touched = pressed;
+    touch_ring[ touch_ring_head ].first = first;
+    touch_ring_head = next;
+}
+
+/**
+ * @brief end the current press, report the gesture and the release
+ */
+static void touch_release( uint32_t now ) {
+    touch_gesture_event_t gesture;
+
+    if ( !touch_press ) {
+        return;
+    }
+    touch_press = false;
+    touch_stats.touched_ms += now - touch_press_ms;
+    touch_filter_reset( &touch_filter );
+    touch_ring_push( touch_last_x, touch_last_y, false, false );
+
+    touch_t touch;
+    touch.touched = false;
+    touch.x_coor = touch_last_x;
+    touch.y_coor = touch_last_y;
+    touch_send_event_cb( TOUCH_UPDATE, (void*)&touch );
+
+    if ( touch_gesture_release( &touch_gesture, now, &gesture ) ) {
+        touch_stats.gestures++;
+        touch_send_event_cb( TOUCH_GESTURE, (void*)&gesture );
+    }
+}
+
+/**
+ * @brief read the controller while touched, run calibration, filter
+ * and gesture recognizer and buffer the filtered sample for lvgl
+ */
+static void touch_sample( void ) {
+    TTGOClass *ttgo = TTGOClass::getWatch();
+    touch_gesture_event_t gesture;
+    int16_t x = 0, y = 0;
+
     portENTER_CRITICAL( &Touch_IRQ_Mux );
     bool temp_touch_irq_flag = touch_irq_flag;
+    int64_t temp_touch_irq_us = touch_irq_us;
     touch_irq_flag = false;
     portEXIT_CRITICAL( &Touch_IRQ_Mux );
     touched |= temp_touch_irq_flag;
+
+    if ( !touched ) {
+        return;
+    }
     /*
-     * check for an touch interrupt
+     * sample with the controller rate, an interrupt is taken at once
      */
-    if ( touched ) {
-        data->state = touch_getXY( data->point.x, data->point.y ) ? LV_INDEV_STATE_PR : LV_INDEV_STATE_REL;
-        touched = digitalRead( TOUCH_INT ) == LOW;
-        if ( !touched ) {
+    uint32_t now = millis();
+    if ( !temp_touch_irq_flag && (int32_t)( touch_next_sample - now ) > 0 ) {
+        scheduler_set_deadline( touch_next_sample - now );
+        return;
+    }
+    touch_next_sample = now + TOUCH_SAMPLE_INTERVAL;
+    /*
+     * get touchstate from touchcontroller if not taken
+     * by other task/thread
+     */
+    bool pressed = false;
+    if ( touch_lock_take() ) {
+        pressed = ttgo->getTouch( x, y );
+        touch_lock_give();
+    }
+    touch_stats.samples++;
+    touched = digitalRead( TOUCH_INT ) == LOW;
+
+    if ( pressed ) {
+        touch_calibration_apply( &touch_config.calibration, &x, &y, lv_disp_get_hor_res( NULL ), lv_disp_get_ver_res( NULL ) );
+        bool first = !touch_press;
+        if ( first ) {
             /*
-             * Save power by switching to monitor mode now instead of waiting for 30 seconds.
+             * wibe if touched and tell the gui about the interaction
              */
-            if ( touch_lock_take() ) {
-                TTGOClass::getWatch()->touchToMonitor();
-                touch_lock_give();
-            }
+            touch_press = true;
+            touch_press_ms = now;
+            touch_press_irq_us = temp_touch_irq_flag ? temp_touch_irq_us : esp_timer_get_time();
+            touch_stats.touches++;
+            if ( display_get_vibe() )
+                motor_vibe( 3 );
         }
-        /**
-         * send touch event
-         */
-        touch_t touch;
-        touch.touched = touched;
-        touch.x_coor = data->point.x;
-        touch.y_coor = data->point.y;
-        touch_send_event_cb( TOUCH_UPDATE, (void*)&touch );
+        if ( touch_gesture_push( &touch_gesture, x, y, now, &gesture ) ) {
+            touch_stats.gestures++;
+            touch_send_event_cb( TOUCH_GESTURE, (void*)&gesture );
+        }
+        touch_filter_push( &touch_filter, &x, &y, now );
+        touch_last_x = x;
+        touch_last_y = y;
+        touch_ring_push( x, y, true, first );
+        if ( first ) {
+            touch_t touch;
+            touch.touched = true;
+            touch.x_coor = x;
+            touch.y_coor = y;
+            touch_send_event_cb( TOUCH_UPDATE, (void*)&touch );
+        }
+    }
+    if ( !pressed || !touched ) {
+        touch_release( now );
+    }
+
+    if ( touched ) {
+        scheduler_set_deadline( TOUCH_SAMPLE_INTERVAL );
     }
     else {
+        /*
+         * Save power by switching to monitor mode now instead of waiting for 30 seconds.
+         */
+        if ( touch_lock_take() ) {
+            ttgo->touchToMonitor();
+            touch_lock_give();
+        }
+    }
+    /*
+     * let lvgl read the new samples in this loop pass instead of the next read period
+     */
+    if ( touch_ring_head != touch_ring_tail && touch_indev->driver.read_task ) {
+        lv_task_ready( touch_indev->driver.read_task );
+    }
+}
+
+static bool touch_read(lv_indev_drv_t * drv, lv_indev_data_t*data) {
+    /*
+     * disable touch when we are in standby or silence wakeup
+     */
+    if ( powermgm_get_event( POWERMGM_STANDBY | POWERMGM_SILENCE_WAKEUP ) ) {
         data->state = LV_INDEV_STATE_REL;
+        return( false );
+    }
+    /*
+     * without new samples repeat the last state
+     */
+    if ( touch_ring_head != touch_ring_tail ) {
+        touch_last_sample = touch_ring[ touch_ring_tail ];
+        touch_ring_tail = ( touch_ring_tail + 1 ) % TOUCH_RING_SIZE;
+        if ( touch_last_sample.first ) {
+            uint32_t latency = esp_timer_get_time() - touch_press_irq_us;
+            touch_latency_sum += latency;
+            touch_latency_count++;
+            if ( latency > touch_stats.latency_max_us ) {
+                touch_stats.latency_max_us = latency;
+            }
+        }
     }
-    return( false );
+    data->point.x = touch_last_sample.x;
+    data->point.y = touch_last_sample.y;
+    data->state = touch_last_sample.touched ? LV_INDEV_STATE_PR : LV_INDEV_STATE_REL;
+    /*
+     * true lets lvgl call again for the next buffered sample
+     */
+    return( touch_ring_head != touch_ring_tail );
 }
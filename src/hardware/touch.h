@@ -24,8 +24,13 @@
 
     #include "TTGO.h"
     #include "callback.h"
+    #include "utils/touch_gesture.h"
 
-    #define TOUCH_UPDATE        _BV(0)
+    #define TOUCH_UPDATE                _BV(0)              /** @brief event mask for touch press and release, callback arg is (touch_t*) */
+    #define TOUCH_GESTURE               _BV(1)              /** @brief event mask for a recognized gesture, callback arg is (touch_gesture_event_t*) */
+
+    #define TOUCH_RING_SIZE             16                  /** @brief filtered samples buffered for lvgl */
+    #define TOUCH_SAMPLE_INTERVAL       10                  /** @brief sample interval while touched in ms */
 
     typedef struct {
         bool touched;
@@ -33,6 +38,30 @@
         int16_t y_coor;
     } touch_t;
 
+    /**
+     * @brief one filtered sample
+     */
+    typedef struct {
+        int16_t x;
+        int16_t y;
+        bool touched;
+        bool first;                         /** @brief first sample of a touch */
+    } touch_sample_t;
+
+    /**
+     * @brief touch pipeline statistic since boot
+     */
+    typedef struct {
+        uint32_t touches;                   /** @brief number of touches */
+        uint32_t samples;                   /** @brief controller reads */
+        uint32_t overruns;                  /** @brief samples dropped, lvgl did not read in time */
+        uint32_t events;                    /** @brief touch events sent to the callbacks */
+        uint32_t gestures;                  /** @brief recognized gestures */
+        uint32_t touched_ms;                /** @brief time touched */
+        uint32_t latency_us;                /** @brief average time from touch interrupt to lvgl read */
+        uint32_t latency_max_us;            /** @brief max time from touch interrupt to lvgl read */
+    } touch_stats_t;
+
     /**
      * @brief setup touch
      */
@@ -40,7 +69,7 @@
     /**
      * @brief registers a callback function which is called on a corresponding event
      * 
-     * @param   event  possible values: TOUCH_UPDATE
+     * @param   event  possible values: TOUCH_UPDATE, TOUCH_GESTURE
      * @param   callback_func   pointer to the callback function 
      * @param   id      program id
      */
@@ -53,5 +82,17 @@
      * @brief unlock the touch interface
      */
     void touch_lock_give( void );
+    /**
+     * @brief get the touch pipeline statistic
+     *
+     * @return  pointer to the statistic
+     */
+    const touch_stats_t *touch_get_stats( void );
+    /**
+     * @brief get the jitter filter time constant
+     *
+     * @return  time constant in ms, 0 means off
+     */
+    uint16_t touch_get_filter_latency( void );
 
 #endif // _TOUCH_H
\ No newline at end of file
@@ -26,9 +26,14 @@
 #include <TTGO.h>
 
 #include "gui/gui.h"
+#include "gui/mainbar/mainbar.h"
 
 #include "hardware/hardware.h"
 #include "hardware/powermgm.h"
+#include "hardware/scheduler.h"
+
+#include "utils/bench.h"
+#include "utils/boot_profiler.h"
 
 #include "app/weather/weather.h"
 #include "app/stopwatch/stopwatch_app.h"
@@ -46,6 +51,10 @@
 #include "app/example_app/example_app.h"
 
 void setup() {
+    int32_t bench_hardware_setup = bench_register( "hardware setup", BENCH_NO_BUDGET );
+    int32_t bench_gui_setup = bench_register( "gui setup", BENCH_NO_BUDGET );
+    int32_t bench_app_setup = bench_register( "app setup", BENCH_NO_BUDGET );
+    int32_t bench_hardware_post_setup = bench_register( "hardware post setup", BENCH_NO_BUDGET );
     /**
      * hardware setup
      * 
@@ -54,19 +63,27 @@ void setup() {
     Serial.begin(115200);
     log_i("starting t-watch %s, version: " __FIRMWARE__ " core: %d", WATCH_VERSION_NAME, xPortGetCoreID() );
     log_i("Configure watchdog to 30s: %d", esp_task_wdt_init( 30, true ) );
+    boot_profiler_mark( "serial" );
+    uint64_t bench_start = bench_begin( bench_hardware_setup );
     hardware_setup();
+    bench_end( bench_hardware_setup, bench_start );
+    boot_profiler_mark( "hardware setup" );
     /**
      * gui setup
      * 
      * /gui/gui.cpp
      */
+    bench_start = bench_begin( bench_gui_setup );
     gui_setup();
+    bench_end( bench_gui_setup, bench_start );
+    boot_profiler_mark( "gui setup" );
     /**
      * add apps here!!!
      * 
      * inlude your header file
      * and call your app setup
      */
+    bench_start = bench_begin( bench_app_setup );
     weather_app_setup();
     stopwatch_app_setup();
     alarm_clock_setup();
@@ -81,14 +98,21 @@ void setup() {
     powermeter_app_setup();
 	FindPhone_setup();
     example_app_setup();
+    mainbar_build_tiles();
+    bench_end( bench_app_setup, bench_start );
+    boot_profiler_mark( "app setup" );
     /**
      * post hardware setup
      * 
      * /hardware/hardware.cpp
      */
+    bench_start = bench_begin( bench_hardware_post_setup );
     hardware_post_setup();
+    bench_end( bench_hardware_post_setup, bench_start );
+    boot_profiler_mark( "hardware post setup" );
+    bench_print();
 }
 
 void loop() {
-    powermgm_loop();
+    scheduler_loop();
 }
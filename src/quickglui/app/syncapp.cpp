@@ -20,7 +20,7 @@ Application& SynchronizedApplication::init(const char* name, const lv_img_dsc_t
 
 SynchronizedApplication& SynchronizedApplication::init(const char* name, const lv_img_dsc_t *iconImg, bool addSyncButton, int userPageCount, int settingsPageCount) {
     Application::init(name, iconImg, userPageCount, settingsPageCount);
-    title = name + String(" sync Task");
+    title = name + String(" sync");
 
     if (addSyncButton)
     {
@@ -45,29 +45,18 @@ void SynchronizedApplication::startSynchronization(SyncRequestSource callSource)
     }
 
     xEventGroupSetBits(syncEvent, callSource);
-    auto result = xTaskCreate(&SynchronizedApplication::SyncTaskHandler,      /* Function to implement the task */
-                title.c_str(),    /* Name of the task */
-                5000,                            /* Stack size in words */
-                (void*)this,                            /* Task input parameter */
-                1,                               /* Priority of the task */
-                &syncTask );  /* Task handle. */
-    
-    if (result == pdPASS)
+    auto result = worker_submit(title.c_str(), &SynchronizedApplication::SyncJobHandler, &SynchronizedApplication::SyncDoneHandler, (void*)this, WORKER_PRIO_NORMAL);
+
+    if (result != WORKER_NO_JOB)
         log_d("%s scheduled", title.c_str());
-    else if (result == errCOULD_NOT_ALLOCATE_REQUIRED_MEMORY)
+    else
     {
         xEventGroupClearBits(syncEvent, callSource);
-        log_e("No enough memory to start %s!", title.c_str());
+        log_e("No free worker job to start %s!", title.c_str());
     }
-    else
-        while (true); // Not possible!!!
 }
 
 void SynchronizedApplication::onSyncRequest() {
-    log_i("start %s, heap: %d", title.c_str(), ESP.getFreeHeap());
-
-    vTaskDelay(250);
-
     auto flags = (SyncRequestSource)xEventGroupGetBits(syncEvent);
     if (flags & SyncRequestSource::IsRequired)
     {   
@@ -75,15 +64,22 @@ void SynchronizedApplication::onSyncRequest() {
         if (synchronize != nullptr)
             synchronize(flags);
     }
-    
+}
+
+void SynchronizedApplication::onSyncDone() {
     xEventGroupClearBits(syncEvent, SyncRequestSource::AllFlagsValues);
-    log_i("finsh %s, heap: %d", title.c_str(), ESP.getFreeHeap());
-    vTaskDelete( NULL );
 }
 
-void SynchronizedApplication::SyncTaskHandler(void* pvSelf)
+int32_t SynchronizedApplication::SyncJobHandler(worker_job_t* job)
 {
-    log_i("SyncTaskHandler: %d", pvSelf);
-    auto self = (SynchronizedApplication*)pvSelf;
+    auto self = (SynchronizedApplication*)job->arg;
+    vTaskDelay(WORKER_NET_SETTLE_MS);
     self->onSyncRequest();
+    return 0;
+}
+
+void SynchronizedApplication::SyncDoneHandler(worker_job_t* job)
+{
+    auto self = (SynchronizedApplication*)job->arg;
+    self->onSyncDone();
 }
\ No newline at end of file
@@ -9,6 +9,7 @@
 #define SYNCAPP_H
 
 #include "application.h"
+#include "utils/worker.h"
 #include <FreeRTOS.h>
 // #include <freertos/task.h>
 // #include <freertos/event_groups.h>
@@ -50,7 +51,7 @@ public:
      */
     void startSynchronization(SyncRequestSource callSource);
     /**
-     * @brief Set syncronisation handler callback. Method will be executed in background thread.
+     * @brief Set syncronisation handler callback. Method will be executed on a worker task.
      */
     SynchronizedApplication& synchronizeActionHandler(SynchronizeAction onSynchronizeHandler);
 
@@ -64,13 +65,17 @@ protected:
      * @brief Base low level handler. Don't change it without resons :)
      */
     virtual void onSyncRequest();
+    /**
+     * @brief Called on the gui thread after the synchronization is finished
+     */
+    virtual void onSyncDone();
 
 private:
-  static void SyncTaskHandler(void* pvSelf);
+  static int32_t SyncJobHandler(worker_job_t* job);
+  static void SyncDoneHandler(worker_job_t* job);
 
 protected:
   EventGroupHandle_t syncEvent = NULL;
-  TaskHandle_t syncTask;
   SynchronizeAction synchronize;
   String title;
 };
@@ -14,7 +14,6 @@
 #include "utils/json_psram_allocator.h"
 
 #define BLUETOOTH_MAX_RESPONSE_SIZE 512
-#define BLUETOOTH_MAX_TRANSMISSION_SIZE 240
 
 class BluetoothJsonResponse : public SpiRamJsonDocument
 {
@@ -45,20 +44,7 @@ public:
         auto len = serializeJson(*this, buf + 1, BLUETOOTH_MAX_RESPONSE_SIZE) + 1;
         buf[0] = buf[len++] = '\x03';
         buf[len] = '\0';
-        int maxp = BLUETOOTH_MAX_TRANSMISSION_SIZE;
-
-        if (len < maxp) {
-            blectl_send_msg(buf);
-        }
-        else if (BLUETOOTH_MAX_RESPONSE_SIZE > maxp) {
-            // Probably should be resolved in blectl_send_msg:
-            char saved = buf[maxp];
-            buf[maxp] = '\0';
-            blectl_send_msg(buf);
-            
-            buf[maxp] = saved;
-            blectl_send_msg(buf + maxp);
-        }
+        blectl_send_msg(buf);
     }
 
     // template <typename T>
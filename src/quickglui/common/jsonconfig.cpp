@@ -17,6 +17,8 @@ JsonConfig::JsonConfig(const char* configFileName) : BaseJsonConfig(configFileNa
 }
 
 JsonConfig::~JsonConfig() {
+  // write pending changes while onSave() and the options still exist
+  flush();
   for (int i = 0; i < count; i++) {
     delete options[i];
   }
@@ -0,0 +1,195 @@
+/****************************************************************************
+ *   Oct 18 17:05:52 2026
+ *   Copyright  2026  My-TTGO-Watch contributors
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#include <string.h>
+
+#include "activity_classifier.h"
+
+static const char *activity_classifier_names[ ACTIVITY_NUM ] = { "still", "walk", "run", "cycle", "sleep" };
+
+/**
+ * @brief integer square root
+ */
+static uint32_t activity_classifier_isqrt( uint32_t value ) {
+    uint32_t root = 0;
+    uint32_t bit = 1UL << 30;
+
+    while( bit > value ) {
+        bit >>= 2;
+    }
+    while( bit ) {
+        if ( value >= root + bit ) {
+            value -= root + bit;
+            root = ( root >> 1 ) + bit;
+        }
+        else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return( root );
+}
+
+void activity_classifier_init( activity_classifier_t *ac ) {
+    memset( ac, 0, sizeof( activity_classifier_t ) );
+    ac->activity = ACTIVITY_STILL;
+    ac->candidate = ACTIVITY_STILL;
+}
+
+/**
+ * @brief extract the features of the full window
+ */
+static void activity_classifier_features( activity_classifier_t *ac ) {
+    activity_features_t *features = &ac->features;
+    uint32_t sum = 0;
+    uint32_t var = 0;
+
+    for( int i = 0 ; i < ACTIVITY_WINDOW ; i++ ) {
+        sum += ac->magnitude[ i ];
+    }
+    features->mean_mg = sum / ACTIVITY_WINDOW;
+    /*
+     * divide each term before the sum, a 16g magnitude can't overflow 32 bit
+     */
+    for( int i = 0 ; i < ACTIVITY_WINDOW ; i++ ) {
+        int32_t diff = (int32_t)ac->magnitude[ i ] - (int32_t)features->mean_mg;
+        var += (uint32_t)( diff * diff ) / ACTIVITY_WINDOW;
+    }
+    features->std_mg = activity_classifier_isqrt( var );
+    for( int i = 0 ; i < 3 ; i++ ) {
+        features->gravity_mg[ i ] = ac->axis_sum[ i ] / ACTIVITY_WINDOW;
+    }
+    /*
+     * count upward crossings through the mean with hysteresis, the cadence
+     * is measured between the first and the last crossing
+     */
+    int32_t hyst = features->std_mg / 2;
+    if ( hyst < ACTIVITY_MIN_HYST_MG ) {
+        hyst = ACTIVITY_MIN_HYST_MG;
+    }
+    int32_t low = (int32_t)features->mean_mg - hyst;
+    int32_t high = (int32_t)features->mean_mg + hyst;
+    bool below = false;
+    int first = -1;
+    int last = -1;
+    int crossings = 0;
+
+    for( int i = 0 ; i < ACTIVITY_WINDOW ; i++ ) {
+        int32_t value = ac->magnitude[ i ];
+        if ( value < low ) {
+            below = true;
+        }
+        else if ( below && value > high ) {
+            below = false;
+            if ( first == -1 ) {
+                first = i;
+            }
+            last = i;
+            crossings++;
+        }
+    }
+    if ( crossings >= 3 ) {
+        features->cadence = ( crossings - 1 ) * ACTIVITY_SAMPLE_RATE * 100 / ( last - first );
+    }
+    else {
+        features->cadence = 0;
+    }
+}
+
+uint8_t activity_classifier_classify( const activity_features_t *features, uint32_t low_motion_windows ) {
+    if ( features->std_mg < ACTIVITY_STILL_STD_MG ) {
+        /*
+         * a watch lying flat on a table is not sleeping
+         */
+        int32_t z = features->gravity_mg[ 2 ] < 0 ? -features->gravity_mg[ 2 ] : features->gravity_mg[ 2 ];
+        if ( features->std_mg < ACTIVITY_TABLE_STD_MG && z > ACTIVITY_TABLE_FLAT_MG ) {
+            return( ACTIVITY_STILL );
+        }
+        return( low_motion_windows >= ACTIVITY_SLEEP_WINDOWS ? ACTIVITY_SLEEP : ACTIVITY_STILL );
+    }
+    if ( features->std_mg < ACTIVITY_SLEEP_STD_MG && low_motion_windows >= ACTIVITY_SLEEP_WINDOWS ) {
+        return( ACTIVITY_SLEEP );
+    }
+    if ( features->std_mg >= ACTIVITY_WALK_STD_MG && features->cadence >= ACTIVITY_WALK_CADENCE ) {
+        if ( features->std_mg >= ACTIVITY_RUN_STD_MG && features->cadence >= ACTIVITY_RUN_CADENCE ) {
+            return( ACTIVITY_RUN );
+        }
+        return( ACTIVITY_WALK );
+    }
+    /*
+     * motion without a step rhythm, the wrist rests on the handlebar
+     */
+    return( ACTIVITY_CYCLE );
+}
+
+bool activity_classifier_push( activity_classifier_t *ac, int16_t x, int16_t y, int16_t z ) {
+    uint32_t square = (int32_t)x * x + (int32_t)y * y + (int32_t)z * z;
+
+    ac->magnitude[ ac->samples++ ] = activity_classifier_isqrt( square );
+    ac->axis_sum[ 0 ] += x;
+    ac->axis_sum[ 1 ] += y;
+    ac->axis_sum[ 2 ] += z;
+
+    if ( ac->samples < ACTIVITY_WINDOW ) {
+        return( false );
+    }
+    activity_classifier_features( ac );
+    ac->samples = 0;
+    ac->axis_sum[ 0 ] = ac->axis_sum[ 1 ] = ac->axis_sum[ 2 ] = 0;
+    ac->windows++;
+
+    if ( ac->features.std_mg < ACTIVITY_SLEEP_STD_MG ) {
+        ac->low_motion_windows++;
+    }
+    else {
+        ac->low_motion_windows = 0;
+    }
+    /*
+     * account the window to the reported activity
+     */
+    ac->ms += ACTIVITY_WINDOW_MS;
+    ac->seconds[ ac->activity ] += ac->ms / 1000;
+    ac->ms %= 1000;
+    /*
+     * a new activity must win ACTIVITY_HYSTERESIS windows in a row
+     */
+    uint8_t candidate = activity_classifier_classify( &ac->features, ac->low_motion_windows );
+    if ( candidate == ac->candidate ) {
+        if ( ac->candidate_windows < 255 ) {
+            ac->candidate_windows++;
+        }
+    }
+    else {
+        ac->candidate = candidate;
+        ac->candidate_windows = 1;
+    }
+    if ( ac->candidate != ac->activity && ac->candidate_windows >= ACTIVITY_HYSTERESIS ) {
+        ac->activity = ac->candidate;
+        return( true );
+    }
+    return( false );
+}
+
+const char *activity_classifier_get_name( uint8_t activity ) {
+    if ( activity >= ACTIVITY_NUM ) {
+        return( "unknown" );
+    }
+    return( activity_classifier_names[ activity ] );
+}
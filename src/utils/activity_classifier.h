@@ -0,0 +1,126 @@
+/****************************************************************************
+ *   Oct 18 17:05:52 2026
+ *   Copyright  2026  My-TTGO-Watch contributors
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#ifndef _ACTIVITY_CLASSIFIER_H
+    #define _ACTIVITY_CLASSIFIER_H
+
+    #include <stdint.h>
+    #include <stdbool.h>
+
+    /*
+     * note:    this module is plain integer C without arduino dependencies,
+     *          tools/activity_replay.cpp builds it on the host.
+     */
+    #define ACTIVITY_SAMPLE_RATE        25                  /** @brief expected sample rate in Hz */
+    #define ACTIVITY_WINDOW             100                 /** @brief samples per classification window, 4s */
+    #define ACTIVITY_WINDOW_MS          ( ACTIVITY_WINDOW * 1000 / ACTIVITY_SAMPLE_RATE )
+    #define ACTIVITY_HYSTERESIS         2                   /** @brief windows a new activity must win before it is reported */
+
+    #define ACTIVITY_STILL_STD_MG       25                  /** @brief magnitude std below this is no motion */
+    #define ACTIVITY_SLEEP_STD_MG       40                  /** @brief magnitude std below this counts as low motion for sleep */
+    #define ACTIVITY_SLEEP_WINDOWS      75                  /** @brief low motion windows before sleep, 5min */
+    #define ACTIVITY_TABLE_STD_MG       10                  /** @brief below this and flat the watch is not worn */
+    #define ACTIVITY_TABLE_FLAT_MG      900                 /** @brief z gravity above this is flat */
+    #define ACTIVITY_WALK_STD_MG        80                  /** @brief min magnitude std for walk and run */
+    #define ACTIVITY_RUN_STD_MG         350                 /** @brief min magnitude std for run */
+    #define ACTIVITY_WALK_CADENCE       120                 /** @brief min step cadence for walk in 1/100Hz */
+    #define ACTIVITY_RUN_CADENCE        230                 /** @brief min step cadence for run in 1/100Hz */
+    #define ACTIVITY_MIN_HYST_MG        20                  /** @brief min hysteresis for the cadence crossing detection */
+
+    enum {
+        ACTIVITY_STILL = 0,
+        ACTIVITY_WALK,
+        ACTIVITY_RUN,
+        ACTIVITY_CYCLE,
+        ACTIVITY_SLEEP,
+        ACTIVITY_NUM
+    };
+
+    /**
+     * @brief features of one window
+     */
+    typedef struct {
+        uint32_t mean_mg;                   /** @brief mean acceleration magnitude in mg */
+        uint32_t std_mg;                    /** @brief standard deviation of the magnitude in mg */
+        uint32_t cadence;                   /** @brief magnitude cycles in 1/100Hz, 0 if no rhythm */
+        int32_t gravity_mg[ 3 ];            /** @brief mean x/y/z acceleration in mg */
+    } activity_features_t;
+
+    /**
+     * @brief classifier state
+     */
+    typedef struct {
+        uint16_t magnitude[ ACTIVITY_WINDOW ];  /** @brief magnitude of the current window in mg */
+        int32_t axis_sum[ 3 ];                  /** @brief x/y/z sum of the current window */
+        uint32_t samples;                       /** @brief samples in the current window */
+        activity_features_t features;           /** @brief features of the last window */
+        uint8_t activity;                       /** @brief reported activity, ACTIVITY_STILL...ACTIVITY_SLEEP */
+        uint8_t candidate;                      /** @brief activity of the last window */
+        uint8_t candidate_windows;              /** @brief consecutive windows with the same candidate */
+        uint32_t low_motion_windows;            /** @brief consecutive windows with low motion */
+        uint32_t windows;                       /** @brief total classified windows */
+        uint32_t seconds[ ACTIVITY_NUM ];       /** @brief time spent per reported activity in seconds */
+        uint32_t ms;                            /** @brief not yet accounted ms of the reported activity */
+    } activity_classifier_t;
+
+    #ifdef __cplusplus
+    extern "C" {
+    #endif
+
+    /**
+     * @brief reset the classifier state
+     *
+     * @param   ac          pointer to the classifier
+     */
+    void activity_classifier_init( activity_classifier_t *ac );
+    /**
+     * @brief add one sample, a full window is classified
+     *
+     * @param   ac          pointer to the classifier
+     * @param   x           x acceleration in mg
+     * @param   y           y acceleration in mg
+     * @param   z           z acceleration in mg
+     *
+     * @return  true if a window was completed and the reported activity changed
+     */
+    bool activity_classifier_push( activity_classifier_t *ac, int16_t x, int16_t y, int16_t z );
+    /**
+     * @brief classify a feature set without hysteresis
+     *
+     * @param   features            pointer to the window features
+     * @param   low_motion_windows  consecutive low motion windows including this one
+     *
+     * @return  ACTIVITY_STILL...ACTIVITY_SLEEP
+     */
+    uint8_t activity_classifier_classify( const activity_features_t *features, uint32_t low_motion_windows );
+    /**
+     * @brief get the name of an activity
+     *
+     * @param   activity    ACTIVITY_STILL...ACTIVITY_SLEEP
+     *
+     * @return  pointer to the name
+     */
+    const char *activity_classifier_get_name( uint8_t activity );
+
+    #ifdef __cplusplus
+    }
+    #endif
+
+#endif // _ACTIVITY_CLASSIFIER_H
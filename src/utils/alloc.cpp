@@ -0,0 +1,334 @@
+/****************************************************************************
+ *   Oct 18 14:37:52 2026
+ *   Copyright  2026  My-TTGO-Watch contributors
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#include "config.h"
+#include <Arduino.h>
+#include <esp_heap_caps.h>
+#include <soc/soc_memory_layout.h>
+
+#include "alloc.h"
+
+static const char *alloc_region_names[ ALLOC_REGIONS ] = { "internal", "psram" };
+static const uint32_t alloc_region_caps[ ALLOC_REGIONS ] = { MALLOC_CAP_INTERNAL, MALLOC_CAP_SPIRAM };
+
+#if defined( ALLOC_TRACKING )
+    /**
+     * @brief live allocation, one entry in the live table
+     */
+    typedef struct {
+        void *ptr;                                  /** @brief allocated memory, NULL if the entry is free */
+        uint32_t size;                              /** @brief allocated bytes */
+        uint8_t site;                               /** @brief call site number, ALLOC_MAX_SITES <= 256 */
+    } alloc_live_t;
+
+    static alloc_site_t alloc_sites[ ALLOC_MAX_SITES ];
+    static int32_t alloc_site_entrys = 0;
+    static alloc_live_t alloc_live[ ALLOC_MAX_LIVE ];
+    static uint32_t alloc_untracked = 0;
+    static uint32_t alloc_site_overflows = 0;
+    static uint32_t alloc_region_live[ ALLOC_REGIONS ];
+    static uint32_t alloc_region_peak[ ALLOC_REGIONS ];
+    static uint32_t alloc_region_allocs[ ALLOC_REGIONS ];
+    portMUX_TYPE DRAM_ATTR allocMux = portMUX_INITIALIZER_UNLOCKED;
+
+    extern "C" void __real_free( void *ptr );
+    extern "C" void __wrap_free( void *ptr );
+
+    static inline uint32_t alloc_hash( void *ptr ) {
+        return( ( (uintptr_t)ptr >> 2 ) % ALLOC_MAX_LIVE );
+    }
+
+    /**
+     * @brief get the call site number, call only inside allocMux
+     *
+     * @return  site number or -1 if the site table is full
+     */
+    static int32_t alloc_get_site_entry( const char *file, uint32_t line ) {
+        for( int32_t i = 0 ; i < alloc_site_entrys ; i++ ) {
+            if ( alloc_sites[ i ].line == line && alloc_sites[ i ].file == file ) {
+                return( i );
+            }
+        }
+        if ( alloc_site_entrys >= ALLOC_MAX_SITES ) {
+            return( -1 );
+        }
+        alloc_site_t *site = &alloc_sites[ alloc_site_entrys ];
+        site->file = file;
+        site->line = line;
+        return( alloc_site_entrys++ );
+    }
+
+    /**
+     * @brief add a new allocation to the live table and the statistic
+     */
+    static void alloc_track( void *ptr, size_t size, const char *file, uint32_t line ) {
+        if ( ptr == NULL ) {
+            return;
+        }
+        alloc_region_t region = esp_ptr_external_ram( ptr ) ? ALLOC_PSRAM : ALLOC_INTERNAL;
+        bool site_table_full = false;
+
+        portENTER_CRITICAL( &allocMux );
+        int32_t entry = alloc_get_site_entry( file, line );
+        /*
+         * find a free slot, linear probing
+         */
+        uint32_t slot = alloc_hash( ptr );
+        uint32_t probes = 0;
+        while( alloc_live[ slot ].ptr != NULL && probes < ALLOC_MAX_LIVE ) {
+            slot = ( slot + 1 ) % ALLOC_MAX_LIVE;
+            probes++;
+        }
+        if ( entry == -1 ) {
+            site_table_full = ( alloc_site_overflows++ == 0 );
+        }
+        if ( entry == -1 || probes == ALLOC_MAX_LIVE ) {
+            alloc_untracked++;
+        }
+        else {
+            alloc_live[ slot ].ptr = ptr;
+            alloc_live[ slot ].size = size;
+            alloc_live[ slot ].site = entry;
+
+            alloc_site_t *site = &alloc_sites[ entry ];
+            site->region = region;
+            site->allocs++;
+            site->live_bytes += size;
+            if ( site->live_bytes > site->peak_bytes ) {
+                site->peak_bytes = site->live_bytes;
+            }
+            alloc_region_allocs[ region ]++;
+            alloc_region_live[ region ] += size;
+            if ( alloc_region_live[ region ] > alloc_region_peak[ region ] ) {
+                alloc_region_peak[ region ] = alloc_region_live[ region ];
+            }
+        }
+        portEXIT_CRITICAL( &allocMux );
+        /*
+         * report a full site table once, outside the critical section
+         */
+        if ( site_table_full ) {
+            log_w("alloc site table full, %s:%d and later sites are untracked, raise ALLOC_MAX_SITES", file, line );
+        }
+    }
+
+    /**
+     * @brief remove an allocation from the live table, call only inside allocMux
+     *
+     * @return  true if the allocation was tracked
+     */
+    static bool alloc_untrack( void *ptr, alloc_live_t *removed ) {
+        uint32_t slot = alloc_hash( ptr );
+        uint32_t probes = 0;
+
+        while( alloc_live[ slot ].ptr != ptr ) {
+            if ( alloc_live[ slot ].ptr == NULL || ++probes == ALLOC_MAX_LIVE ) {
+                return( false );
+            }
+            slot = ( slot + 1 ) % ALLOC_MAX_LIVE;
+        }
+        *removed = alloc_live[ slot ];
+
+        alloc_site_t *site = &alloc_sites[ removed->site ];
+        alloc_region_t region = esp_ptr_external_ram( ptr ) ? ALLOC_PSRAM : ALLOC_INTERNAL;
+        site->frees++;
+        site->live_bytes -= removed->size;
+        alloc_region_live[ region ] -= removed->size;
+        /*
+         * backward shift deletion, keeps the probe chains intact without tombstones
+         */
+        uint32_t hole = slot;
+        uint32_t next = ( slot + 1 ) % ALLOC_MAX_LIVE;
+        while( alloc_live[ next ].ptr != NULL ) {
+            uint32_t home = alloc_hash( alloc_live[ next ].ptr );
+            bool move = ( hole <= next ) ? ( home <= hole || home > next ) : ( home <= hole && home > next );
+            if ( move ) {
+                alloc_live[ hole ] = alloc_live[ next ];
+                hole = next;
+            }
+            next = ( next + 1 ) % ALLOC_MAX_LIVE;
+        }
+        alloc_live[ hole ].ptr = NULL;
+
+        return( true );
+    }
+
+    void *alloc_tracking_malloc( size_t size, const char *file, uint32_t line ) {
+        #if defined( BOARD_HAS_PSRAM )
+            void *ptr = ps_malloc( size );
+        #else
+            void *ptr = malloc( size );
+        #endif
+        alloc_track( ptr, size, file, line );
+        return( ptr );
+    }
+
+    void *alloc_tracking_calloc( size_t n, size_t size, const char *file, uint32_t line ) {
+        #if defined( BOARD_HAS_PSRAM )
+            void *ptr = ps_calloc( n, size );
+        #else
+            void *ptr = calloc( n, size );
+        #endif
+        alloc_track( ptr, n * size, file, line );
+        return( ptr );
+    }
+
+    void *alloc_tracking_realloc( void *ptr, size_t size, const char *file, uint32_t line ) {
+        alloc_live_t removed;
+        bool tracked = false;
+        /*
+         * untrack before realloc, the old address can be reused by another task right after
+         */
+        if ( ptr ) {
+            portENTER_CRITICAL( &allocMux );
+            tracked = alloc_untrack( ptr, &removed );
+            portEXIT_CRITICAL( &allocMux );
+        }
+        #if defined( BOARD_HAS_PSRAM )
+            void *new_ptr = ps_realloc( ptr, size );
+        #else
+            void *new_ptr = realloc( ptr, size );
+        #endif
+        if ( new_ptr ) {
+            alloc_track( new_ptr, size, file, line );
+        }
+        else if ( tracked && size ) {
+            /*
+             * realloc failed, the old memory is still valid
+             */
+            alloc_track( ptr, removed.size, alloc_sites[ removed.site ].file, alloc_sites[ removed.site ].line );
+        }
+        return( new_ptr );
+    }
+
+    void __wrap_free( void *ptr ) {
+        alloc_live_t removed;
+
+        if ( ptr ) {
+            portENTER_CRITICAL( &allocMux );
+            alloc_untrack( ptr, &removed );
+            portEXIT_CRITICAL( &allocMux );
+        }
+        __real_free( ptr );
+    }
+
+    bool alloc_tracking_enabled( void ) {
+        return( true );
+    }
+
+    int32_t alloc_get_sites( void ) {
+        return( alloc_site_entrys );
+    }
+
+    bool alloc_get_site( int32_t entry, alloc_site_t *site ) {
+        if ( entry < 0 || entry >= alloc_site_entrys ) {
+            return( false );
+        }
+        portENTER_CRITICAL( &allocMux );
+        *site = alloc_sites[ entry ];
+        portEXIT_CRITICAL( &allocMux );
+        /*
+         * strip the build path
+         */
+        const char *src = strstr( site->file, "src/" );
+        if ( src ) {
+            site->file = src + 4;
+        }
+        return( true );
+    }
+
+    uint32_t alloc_get_untracked( void ) {
+        return( alloc_untracked );
+    }
+
+    uint32_t alloc_get_site_overflows( void ) {
+        return( alloc_site_overflows );
+    }
+#else
+    void *alloc_tracking_malloc( size_t size, const char *file, uint32_t line ) {
+        (void)file;
+        (void)line;
+        return( MALLOC( size ) );
+    }
+
+    void *alloc_tracking_calloc( size_t n, size_t size, const char *file, uint32_t line ) {
+        (void)file;
+        (void)line;
+        return( CALLOC( n, size ) );
+    }
+
+    void *alloc_tracking_realloc( void *ptr, size_t size, const char *file, uint32_t line ) {
+        (void)file;
+        (void)line;
+        return( REALLOC( ptr, size ) );
+    }
+
+    bool alloc_tracking_enabled( void ) {
+        return( false );
+    }
+
+    int32_t alloc_get_sites( void ) {
+        return( 0 );
+    }
+
+    bool alloc_get_site( int32_t entry, alloc_site_t *site ) {
+        (void)entry;
+        (void)site;
+        return( false );
+    }
+
+    uint32_t alloc_get_untracked( void ) {
+        return( 0 );
+    }
+
+    uint32_t alloc_get_site_overflows( void ) {
+        return( 0 );
+    }
+#endif // ALLOC_TRACKING
+
+void alloc_get_region_stats( alloc_region_t region, alloc_region_stats_t *stats ) {
+    multi_heap_info_t info;
+
+    memset( stats, 0, sizeof( alloc_region_stats_t ) );
+    if ( region < 0 || region >= ALLOC_REGIONS ) {
+        return;
+    }
+
+    heap_caps_get_info( &info, alloc_region_caps[ region ] );
+    stats->size = info.total_free_bytes + info.total_allocated_bytes;
+    stats->free = info.total_free_bytes;
+    stats->min_free = info.minimum_free_bytes;
+    stats->largest_free_block = info.largest_free_block;
+    stats->fragmentation = info.total_free_bytes ? 100 - ( (uint64_t)info.largest_free_block * 100 / info.total_free_bytes ) : 0;
+    #if defined( ALLOC_TRACKING )
+        portENTER_CRITICAL( &allocMux );
+        stats->live_bytes = alloc_region_live[ region ];
+        stats->peak_bytes = alloc_region_peak[ region ];
+        stats->allocs = alloc_region_allocs[ region ];
+        portEXIT_CRITICAL( &allocMux );
+    #endif
+}
+
+const char *alloc_get_region_name( alloc_region_t region ) {
+    if ( region < 0 || region >= ALLOC_REGIONS ) {
+        return( "unknown" );
+    }
+    return( alloc_region_names[ region ] );
+}
@@ -1,11 +1,23 @@
 #ifndef _ALLOC_H
     #define _ALLOC_H
 
+    #include <stddef.h>
+    #include <stdint.h>
+    #include <stdbool.h>
+
     #if defined( BOARD_HAS_PSRAM )
-        #include <stddef.h>
-        #include <stdbool.h>
         #include <esp32-hal-psram.h>
+    #endif // BOARD_HAS_PSRAM
 
+    #if defined( ALLOC_TRACKING )
+        /**
+         * allocation tracking, needs the build flags "-D ALLOC_TRACKING -Wl,--wrap=free"
+         * to see all frees
+         */
+        #define MALLOC( size )          alloc_tracking_malloc( size, __FILE__, __LINE__ )           /** @brief tracked malloc */
+        #define CALLOC( n, size )       alloc_tracking_calloc( n, size, __FILE__, __LINE__ )        /** @brief tracked calloc */
+        #define REALLOC( ptr, size )    alloc_tracking_realloc( ptr, size, __FILE__, __LINE__ )     /** @brief tracked realloc */
+    #elif defined( BOARD_HAS_PSRAM )
         #define MALLOC         ps_malloc            /** @brief malloac from PSRAM */
         #define CALLOC         ps_calloc            /** @brief calloc from PSRAM */
         #define REALLOC        ps_realloc           /** @brief realloc from PSRAM */
@@ -13,5 +25,115 @@
         #define MALLOC         malloc               /** @brief malloac from normal heap */
         #define CALLOC         calloc               /** @brief calloc from normal heap */
         #define REALLOC        realloc              /** @brief realloc from normal heap */
-    #endif // BOARD_HAS_PSRAM
-#endif // _ALLOC_H
\ No newline at end of file
+    #endif // ALLOC_TRACKING
+
+    #define ALLOC_MAX_SITES         128             /** @brief max number of tracked call sites, src has 67 MALLOC/CALLOC/REALLOC calls, max 256 */
+    #define ALLOC_MAX_LIVE          1024            /** @brief max number of tracked live allocations */
+
+    /**
+     * @brief memory regions
+     */
+    typedef enum {
+        ALLOC_INTERNAL = 0,                         /** @brief internal RAM */
+        ALLOC_PSRAM,                                /** @brief external PSRAM */
+        ALLOC_REGIONS                               /** @brief number of regions */
+    } alloc_region_t;
+
+    /**
+     * @brief per call site statistic
+     */
+    typedef struct {
+        const char *file;                           /** @brief source file of the call site */
+        uint32_t line;                              /** @brief source line of the call site */
+        alloc_region_t region;                      /** @brief region of the last allocation */
+        uint32_t allocs;                            /** @brief number of allocations */
+        uint32_t frees;                             /** @brief number of frees */
+        uint32_t live_bytes;                        /** @brief currently allocated bytes */
+        uint32_t peak_bytes;                        /** @brief max allocated bytes */
+    } alloc_site_t;
+
+    /**
+     * @brief per region statistic
+     */
+    typedef struct {
+        uint32_t size;                              /** @brief heap size in bytes */
+        uint32_t free;                              /** @brief free bytes */
+        uint32_t min_free;                          /** @brief min free bytes since boot */
+        uint32_t largest_free_block;                /** @brief largest free block in bytes */
+        uint32_t fragmentation;                     /** @brief fragmentation in percent, 100 - largest_free_block / free */
+        uint32_t live_bytes;                        /** @brief tracked allocated bytes, 0 without tracking */
+        uint32_t peak_bytes;                        /** @brief max tracked allocated bytes, 0 without tracking */
+        uint32_t allocs;                            /** @brief number of tracked allocations */
+    } alloc_region_stats_t;
+
+    #ifdef __cplusplus
+    extern "C" {
+    #endif
+
+    /**
+     * @brief tracked malloc, use MALLOC()
+     */
+    void *alloc_tracking_malloc( size_t size, const char *file, uint32_t line );
+    /**
+     * @brief tracked calloc, use CALLOC()
+     */
+    void *alloc_tracking_calloc( size_t n, size_t size, const char *file, uint32_t line );
+    /**
+     * @brief tracked realloc, use REALLOC()
+     */
+    void *alloc_tracking_realloc( void *ptr, size_t size, const char *file, uint32_t line );
+    /**
+     * @brief check if allocation tracking is compiled in
+     *
+     * @return  true if tracking is enabled
+     */
+    bool alloc_tracking_enabled( void );
+    /**
+     * @brief get the statistic of a memory region
+     *
+     * @param   region      ALLOC_INTERNAL or ALLOC_PSRAM
+     * @param   stats       pointer to a alloc_region_stats_t structure
+     */
+    void alloc_get_region_stats( alloc_region_t region, alloc_region_stats_t *stats );
+    /**
+     * @brief get the number of tracked call sites
+     *
+     * @return  number of call sites
+     */
+    int32_t alloc_get_sites( void );
+    /**
+     * @brief get a copy of a call site statistic
+     *
+     * @param   entry       call site number
+     * @param   site        pointer to a alloc_site_t structure
+     *
+     * @return  true if success, false if failed
+     */
+    bool alloc_get_site( int32_t entry, alloc_site_t *site );
+    /**
+     * @brief get the number of allocations that don't fit into the live table and are not tracked
+     *
+     * @return  number of untracked allocations
+     */
+    uint32_t alloc_get_untracked( void );
+    /**
+     * @brief get the number of allocations from call sites that don't fit into the site table,
+     * they are also counted as untracked
+     *
+     * @return  number of allocations without a site entry
+     */
+    uint32_t alloc_get_site_overflows( void );
+    /**
+     * @brief get the name of a memory region
+     *
+     * @param   region      ALLOC_INTERNAL or ALLOC_PSRAM
+     *
+     * @return  region name
+     */
+    const char *alloc_get_region_name( alloc_region_t region );
+
+    #ifdef __cplusplus
+    }
+    #endif
+
+#endif // _ALLOC_H
@@ -10,7 +10,23 @@
 //#include <hardware/json_psram_allocator.h>
 #include "json_psram_allocator.h"
 #include "alloc.h"
+#include "bench.h"
 #include <FS.h>
+#include <SPIFFS.h>
+#include <esp_timer.h>
+
+#include "hardware/powermgm.h"
+#include "hardware/scheduler.h"
+
+BaseJsonConfig* BaseJsonConfig::first = nullptr;
+uint32_t BaseJsonConfig::bytesWritten = 0;
+
+static int32_t basejsonconfig_bench_load = -1;
+static int32_t basejsonconfig_bench_write = -1;
+portMUX_TYPE DRAM_ATTR basejsonconfigMux = portMUX_INITIALIZER_UNLOCKED;
+
+bool basejsonconfig_powermgm_event_cb( EventBits_t event, void *arg );
+bool basejsonconfig_powermgm_loop_cb( EventBits_t event, void *arg );
 
 BaseJsonConfig::BaseJsonConfig(const char* configFileName) {
   if (configFileName[0] == '/')
@@ -18,49 +34,130 @@ BaseJsonConfig::BaseJsonConfig(const char* configFileName) {
   else
   {
     fileName[0] = '/';
-    strlcpy(fileName+1, configFileName, MAX_CONFIG_FILE_NAME_LENGTH);
+    strlcpy(fileName+1, configFileName, MAX_CONFIG_FILE_NAME_LENGTH - 1);
   }
+  /*
+   * add to the list of configs for delayed writes
+   */
+  next = first;
+  first = this;
+}
+
+BaseJsonConfig::~BaseJsonConfig() {
+    /*
+     * onSave() is pure virtual here, the derived class is already gone.
+     * derived configs destroyed at runtime flush in their own destructor
+     */
+    if ( dirty )
+        log_w("config destroyed with unsaved changes: %s", fileName );
+    /*
+     * remove from the list of configs
+     */
+    BaseJsonConfig** config = &first;
+    while (*config != nullptr) {
+        if (*config == this) {
+            *config = next;
+            break;
+        }
+        config = &(*config)->next;
+    }
+}
+
+void BaseJsonConfig::getFileName(char* name, size_t size, const char* extension) {
+    strlcpy(name, fileName, size);
+    if (extension == nullptr)
+        return;
+    /*
+     * replace .json or append the extension
+     */
+    char* dot = strrchr(name, '.');
+    if (dot != nullptr && !strcmp(dot, ".json"))
+        *dot = '\0';
+    strlcat(name, extension, size);
+}
+
+bool BaseJsonConfig::readFile(const char* name, bool binary) {
+    bool result = false;
+    /*
+     * open file
+     */
+    fs::File file = SPIFFS.open(name, FILE_READ);
+    /*
+     * check if open was success
+     */
+    if (!file) {
+        log_e("Can't open file: %s!", name);
+        return false;
+    }
+    /*
+     * get filesize
+     */
+    int filesize = file.size();
+    /*
+     * create json structure, the file holds the strings and the syntax, the
+     * document needs the strings and a node per value. start with one and a
+     * half times the file and double it when the file does not fit
+     */
+    size_t capacity = filesize + filesize / 2;
+    DeserializationError error = DeserializationError::EmptyInput;
+    for ( int attempt = 0 ; attempt < CONFIG_LOAD_ATTEMPTS && filesize > 0 ; attempt++, capacity *= 2 ) {
+        SpiRamJsonDocument doc( capacity );
+        file.seek( 0 );
+        error = binary ? deserializeMsgPack( doc, file ) : deserializeJson( doc, file );
+        if ( error != DeserializationError::NoMemory ) {
+            if ( !error ) {
+                log_i("json config deserialize success: %s, file: %s, %d of %d bytes used", error.c_str(), name, doc.memoryUsage(), capacity );
+                result = onLoad(doc);
+            }
+            doc.clear();
+            break;
+        }
+    }
+    /*
+     * check if create json structure was successfull
+     */
+    if ( error ) {
+        log_e("json config deserialize failed: %s, file: %s", error.c_str(), name );
+    }
+    file.close();
+
+    return result;
 }
 
 bool BaseJsonConfig::load() {
     bool result = false;
+    char name[MAX_CONFIG_FILE_NAME_LENGTH];
+    char tmpName[MAX_CONFIG_FILE_NAME_LENGTH + sizeof(CONFIG_TMP_EXTENSION)];
+    uint64_t start = esp_timer_get_time();
+    /*
+     * write pending changes first, the file is newer than the settings otherwise
+     */
+    flush();
+
+    getFileName(name, sizeof(name), binaryFormat ? CONFIG_BINARY_EXTENSION : nullptr);
+    snprintf(tmpName, sizeof(tmpName), "%s%s", name, CONFIG_TMP_EXTENSION);
+    /*
+     * a complete temp file without a config file is left from a write
+     * interrupted between remove and rename
+     */
+    if ( !SPIFFS.exists(name) && SPIFFS.exists(tmpName) ) {
+        log_w("recover config file from: %s", tmpName );
+        SPIFFS.rename(tmpName, name);
+    }
     /*
      * load config if exsits
      */
-    if ( SPIFFS.exists(fileName) ) {
-        /*
-         * open file
-         */
-        fs::File file = SPIFFS.open(fileName, FILE_READ);
+    if ( binaryFormat && SPIFFS.exists(name) ) {
+        result = readFile(name, true);
+    }
+    if ( !result && SPIFFS.exists(fileName) ) {
+        result = readFile(fileName, false);
         /*
-         * check if open was success
+         * convert to binary on the next write
          */
-        if (!file) {
-            log_e("Can't open file: %s!", fileName);
+        if ( result && binaryFormat ) {
+            save();
         }
-        else {
-            /*
-             * get filesize
-             */
-            int filesize = file.size();
-            /*
-             * create json structure
-             */
-            SpiRamJsonDocument doc( filesize*4 );
-            DeserializationError error = deserializeJson( doc, file );
-            /*
-             * check if create json structure was successfull
-             */
-            if ( error || filesize == 0 ) {
-                log_e("json config deserializeJson() failed: %s, file: %s", error.c_str(), fileName );
-            }
-            else {
-                log_i("json config deserializeJson() success: %s, file: %s", error.c_str(), fileName );
-                result = onLoad(doc);
-            }
-            doc.clear();
-        }
-        file.close();
     }
     /*
      * check if read from json is failed
@@ -69,36 +166,102 @@ bool BaseJsonConfig::load() {
         log_i("reading json failed, call defaults, file: %s", fileName );
         result = onDefault();
     }
+    bench_add( basejsonconfig_bench_load, esp_timer_get_time() - start );
 
     return result;
 }
 
 bool BaseJsonConfig::save() {
-    bool result = false;
-    fs::File file = SPIFFS.open(fileName, FILE_WRITE );
+    portENTER_CRITICAL( &basejsonconfigMux );
+    if ( !dirty ) {
+        dirty = true;
+        dirtySince = millis();
+    }
+    portEXIT_CRITICAL( &basejsonconfigMux );
+    scheduler_wakeup();
+
+    return !writeFailed;
+}
+
+bool BaseJsonConfig::flush() {
+    bool wasDirty;
+
+    portENTER_CRITICAL( &basejsonconfigMux );
+    wasDirty = dirty;
+    dirty = false;
+    portEXIT_CRITICAL( &basejsonconfigMux );
+
+    if ( !wasDirty )
+        return true;
+
+    bool result = write();
+    writeFailed = !result;
+    if ( !result ) {
+        log_e("write config failed, retry later: %s", fileName );
+        save();
+    }
+    return result;
+}
+
+bool BaseJsonConfig::writeFile(const char* name, JsonDocument& doc) {
+    fs::File file = SPIFFS.open(name, FILE_WRITE );
 
     if (!file) {
-        log_e("Can't open file: %s!", fileName);
-    }
-    else {
-        auto size = getJsonBufferSize();
-        SpiRamJsonDocument doc(size);
-        result = onSave(doc);
-        
-        size_t outSize = 0;
-        if (prettyJson)
+        log_e("Can't open file: %s!", name);
+        return false;
+    }
+
+    size_t outSize = 0;
+    if (binaryFormat)
+        outSize = serializeMsgPack(doc, file);
+    else if (prettyJson)
         outSize = serializeJsonPretty(doc, file);
-        else
+    else
         outSize = serializeJson(doc, file);
+    file.close();
 
-        if (result == true && outSize == 0) {
-            log_e("Failed to write config file %s", fileName);
-            result = false;
+    if (outSize == 0) {
+        log_e("Failed to write config file %s", name);
+        return false;
+    }
+    bytesWritten += outSize;
+
+    return true;
+}
+
+bool BaseJsonConfig::write() {
+    bool result = false;
+    char name[MAX_CONFIG_FILE_NAME_LENGTH];
+    char tmpName[MAX_CONFIG_FILE_NAME_LENGTH + sizeof(CONFIG_TMP_EXTENSION)];
+    uint64_t start = esp_timer_get_time();
+
+    getFileName(name, sizeof(name), binaryFormat ? CONFIG_BINARY_EXTENSION : nullptr);
+    snprintf(tmpName, sizeof(tmpName), "%s%s", name, CONFIG_TMP_EXTENSION);
+
+    auto size = getJsonBufferSize();
+    SpiRamJsonDocument doc(size);
+    result = onSave(doc);
+    /*
+     * write to a temp file and replace the config file only after a complete write
+     */
+    if ( result ) {
+        result = writeFile(tmpName, doc);
+    }
+    if ( result ) {
+        SPIFFS.remove(name);
+        result = SPIFFS.rename(tmpName, name);
+        if ( !result ) {
+            log_e("Can't rename %s to %s", tmpName, name);
         }
-        
-        doc.clear();
     }
-    file.close();
+    /*
+     * the json file is converted, remove it
+     */
+    if ( result && binaryFormat && SPIFFS.exists(fileName) ) {
+        SPIFFS.remove(fileName);
+    }
+    doc.clear();
+    bench_add( basejsonconfig_bench_write, esp_timer_get_time() - start );
 
     return result;
 }
@@ -111,3 +274,64 @@ void BaseJsonConfig::debugPrint() {
         serializeJsonPretty(doc, Serial);
     }
 }
+
+void BaseJsonConfig::flushAll() {
+    for ( BaseJsonConfig* config = first ; config != nullptr ; config = config->next ) {
+        config->flush();
+    }
+}
+
+uint32_t BaseJsonConfig::flushExpired() {
+    uint32_t next_write = UINT32_MAX;
+
+    for ( BaseJsonConfig* config = first ; config != nullptr ; config = config->next ) {
+        if ( !config->dirty )
+            continue;
+
+        uint32_t elapsed = millis() - config->dirtySince;
+        if ( elapsed >= CONFIG_SAVE_DELAY * 1000 ) {
+            config->flush();
+        }
+        else if ( CONFIG_SAVE_DELAY * 1000 - elapsed < next_write ) {
+            next_write = CONFIG_SAVE_DELAY * 1000 - elapsed;
+        }
+    }
+    return next_write;
+}
+
+void basejsonconfig_setup( void ) {
+    basejsonconfig_bench_load = bench_register( "config load", BENCH_NO_BUDGET );
+    basejsonconfig_bench_write = bench_register( "config write", BENCH_NO_BUDGET );
+
+    powermgm_register_cb( POWERMGM_STANDBY | POWERMGM_SHUTDOWN | POWERMGM_RESET, basejsonconfig_powermgm_event_cb, "powermgm config" );
+    powermgm_register_loop_cb( POWERMGM_STANDBY | POWERMGM_SILENCE_WAKEUP | POWERMGM_WAKEUP, basejsonconfig_powermgm_loop_cb, "powermgm config loop" );
+}
+
+bool basejsonconfig_powermgm_event_cb( EventBits_t event, void *arg ) {
+    switch( event ) {
+        case POWERMGM_STANDBY:
+        case POWERMGM_SHUTDOWN:
+        case POWERMGM_RESET:
+            BaseJsonConfig::flushAll();
+            break;
+    }
+    return( true );
+}
+
+bool basejsonconfig_powermgm_loop_cb( EventBits_t event, void *arg ) {
+    uint32_t next_write = BaseJsonConfig::flushExpired();
+
+    if ( next_write != UINT32_MAX ) {
+        scheduler_set_deadline( next_write );
+    }
+    return( true );
+}
+
+uint32_t basejsonconfig_get_bytes_per_day( void ) {
+    uint64_t uptime = millis() / 1000;
+
+    if ( uptime == 0 ) {
+        return( 0 );
+    }
+    return( (uint64_t)BaseJsonConfig::getBytesWritten() * 86400 / uptime );
+}
@@ -9,6 +9,10 @@
 #define BASEJSONCONFIG_H_
 
 #define MAX_CONFIG_FILE_NAME_LENGTH 32
+#define CONFIG_SAVE_DELAY           10        /** @brief seconds between the first change and the write to flash */
+#define CONFIG_TMP_EXTENSION        ".tmp"    /** @brief extension for the temporary file, renamed after a complete write */
+#define CONFIG_BINARY_EXTENSION     ".mpk"    /** @brief extension for the MessagePack config file, replace .json */
+#define CONFIG_LOAD_ATTEMPTS        4         /** @brief load tries, the json document doubles after each NoMemory */
 
 #include "ArduinoJson.h"
 
@@ -18,19 +22,48 @@
 class BaseJsonConfig {
 public:
   BaseJsonConfig(const char* configFileName);
+  virtual ~BaseJsonConfig();
   /**
-   * @brief Load settings from file
+   * @brief Load settings from file, a pending save is written first
    */
   bool load();
   /**
-   * @brief Save settings to file
+   * @brief Mark settings as changed, the file is written CONFIG_SAVE_DELAY
+   * seconds after the first change or on standby/shutdown. Multiple changes are written once
+   *
+   * @return  false if the last write of this config failed, it is retried with the next write.
+   *          call flush() to write now and get the result of this write
    */
   bool save();
+  /**
+   * @brief Write settings to file now if they are changed
+   *
+   * @return  true if nothing to write or the write was successful
+   */
+  bool flush();
+  /**
+   * @brief Check if settings are changed and not written yet
+   */
+  bool isDirty() { return dirty; }
   /**
    * @brief print out json
    */
   void debugPrint();
-  
+  /**
+   * @brief Write all changed settings now
+   */
+  static void flushAll();
+  /**
+   * @brief Write all changed settings where the save delay is over
+   *
+   * @return  time in ms until the next pending write, UINT32_MAX if nothing is pending
+   */
+  static uint32_t flushExpired();
+  /**
+   * @brief Get number of bytes written to flash since boot
+   */
+  static uint32_t getBytesWritten() { return bytesWritten; }
+
 protected:
   ////////////// Available for overloading: //////////////
   virtual bool onSave(JsonDocument& document) = 0;
@@ -38,9 +71,38 @@ protected:
   virtual bool onDefault( void ) = 0;
   virtual size_t getJsonBufferSize() { return 4096; }
 
+private:
+  bool write();
+  bool writeFile(const char* name, JsonDocument& doc);
+  bool readFile(const char* name, bool binary);
+  void getFileName(char* name, size_t size, const char* extension);
+
 protected:
   char fileName[MAX_CONFIG_FILE_NAME_LENGTH];
   bool prettyJson = true;
+  /**
+   * @brief store settings as MessagePack, an existing JSON file is converted on the next write
+   */
+  bool binaryFormat = false;
+
+private:
+  volatile bool dirty = false;
+  bool writeFailed = false;
+  uint32_t dirtySince = 0;
+  BaseJsonConfig* next = nullptr;
+  static BaseJsonConfig* first;
+  static uint32_t bytesWritten;
 };
 
-#endif
\ No newline at end of file
+/**
+ * @brief register powermgm callbacks for delayed config writes, call after powermgm_setup
+ */
+void basejsonconfig_setup( void );
+/**
+ * @brief get flash bytes written by config saves per day, extrapolated from the uptime
+ *
+ * @return  bytes per day
+ */
+uint32_t basejsonconfig_get_bytes_per_day( void );
+
+#endif
@@ -0,0 +1,238 @@
+/****************************************************************************
+ *   Oct 18 19:31:08 2026
+ *   Copyright  2026  My-TTGO-Watch contributors
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#include "config.h"
+#include <TTGO.h>
+
+#include "battery_runtime.h"
+
+#include "hardware/powermgm.h"
+#include "hardware/pmu.h"
+#include "hardware/wifictl.h"
+#include "hardware/blectl.h"
+#include "hardware/gpsctl.h"
+#include "hardware/sound.h"
+
+static discharge_model_t battery_runtime_model;
+static const char *battery_runtime_load_names[ BATTERY_RUNTIME_LOADS ] = { "standby", "silence wakeup", "wakeup", "wifi", "ble", "gps", "sound" };
+/*
+ * first guess in mA, the model moves away from it after a few intervals
+ */
+static const float battery_runtime_prior[ BATTERY_RUNTIME_LOADS ] = { 5.0f, 30.0f, 80.0f, 60.0f, 10.0f, 30.0f, 10.0f };
+
+static uint32_t battery_runtime_loads = _BV( BATTERY_RUNTIME_WAKEUP );
+static bool battery_runtime_sound = false;
+static uint32_t battery_runtime_last_ms = 0;
+static float battery_runtime_last_mah = 0.0f;
+static int32_t battery_runtime_percent = -1;
+static bool battery_runtime_plug = false;
+
+bool battery_runtime_powermgm_event_cb( EventBits_t event, void *arg );
+bool battery_runtime_powermgm_loop_cb( EventBits_t event, void *arg );
+bool battery_runtime_pmu_event_cb( EventBits_t event, void *arg );
+bool battery_runtime_wifictl_event_cb( EventBits_t event, void *arg );
+bool battery_runtime_blectl_event_cb( EventBits_t event, void *arg );
+bool battery_runtime_gpsctl_event_cb( EventBits_t event, void *arg );
+bool battery_runtime_sound_event_cb( EventBits_t event, void *arg );
+static void battery_runtime_account( void );
+static void battery_runtime_set_load( int load, bool on );
+
+void battery_runtime_setup( void ) {
+    discharge_model_init( &battery_runtime_model, BATTERY_RUNTIME_LOADS, battery_runtime_prior );
+    if ( discharge_model_load( &battery_runtime_model, BATTERY_RUNTIME_FILENAME ) ) {
+        log_i("discharge model loaded, %d intervals learned", battery_runtime_model.updates );
+    }
+    battery_runtime_last_ms = millis();
+    battery_runtime_last_mah = pmu_get_coulumb_data();
+    battery_runtime_plug = pmu_is_vbus_plug();
+
+    powermgm_register_cb( POWERMGM_STANDBY | POWERMGM_SILENCE_WAKEUP | POWERMGM_WAKEUP | POWERMGM_SHUTDOWN | POWERMGM_RESET, battery_runtime_powermgm_event_cb, "powermgm battery runtime" );
+    powermgm_register_loop_cb( POWERMGM_STANDBY | POWERMGM_SILENCE_WAKEUP | POWERMGM_WAKEUP, battery_runtime_powermgm_loop_cb, "powermgm battery runtime loop" );
+    pmu_register_cb( PMUCTL_STATUS, battery_runtime_pmu_event_cb, "pmu battery runtime" );
+    wifictl_register_cb( WIFICTL_ON | WIFICTL_OFF, battery_runtime_wifictl_event_cb, "wifictl battery runtime" );
+    blectl_register_cb( BLECTL_CONNECT | BLECTL_DISCONNECT, battery_runtime_blectl_event_cb, "blectl battery runtime" );
+    gpsctl_register_cb( GPSCTL_ENABLE | GPSCTL_DISABLE, battery_runtime_gpsctl_event_cb, "gpsctl battery runtime" );
+    sound_register_cb( SOUNDCTL_ENABLED, battery_runtime_sound_event_cb, "sound battery runtime" );
+}
+
+/**
+ * @brief account the time since the last call to the loads that were on
+ */
+static void battery_runtime_account( void ) {
+    uint32_t now = millis();
+    discharge_model_account( &battery_runtime_model, battery_runtime_loads, ( now - battery_runtime_last_ms ) / 1000.0f );
+    battery_runtime_last_ms = now;
+}
+
+static void battery_runtime_set_load( int load, bool on ) {
+    battery_runtime_account();
+    if ( on ) {
+        battery_runtime_loads |= _BV( load );
+    }
+    else {
+        battery_runtime_loads &= ~_BV( load );
+    }
+}
+
+bool battery_runtime_powermgm_event_cb( EventBits_t event, void *arg ) {
+    switch( event ) {
+        case POWERMGM_STANDBY:
+        case POWERMGM_SILENCE_WAKEUP:
+        case POWERMGM_WAKEUP:
+            battery_runtime_account();
+            battery_runtime_loads &= ~( _BV( BATTERY_RUNTIME_STANDBY ) | _BV( BATTERY_RUNTIME_SILENCE_WAKEUP ) | _BV( BATTERY_RUNTIME_WAKEUP ) | _BV( BATTERY_RUNTIME_SOUND ) );
+            if ( event == POWERMGM_STANDBY ) {
+                battery_runtime_loads |= _BV( BATTERY_RUNTIME_STANDBY );
+            }
+            else {
+                battery_runtime_loads |= _BV( event == POWERMGM_WAKEUP ? BATTERY_RUNTIME_WAKEUP : BATTERY_RUNTIME_SILENCE_WAKEUP );
+                /*
+                 * sound is powered down in standby
+                 */
+                if ( battery_runtime_sound ) {
+                    battery_runtime_loads |= _BV( BATTERY_RUNTIME_SOUND );
+                }
+            }
+            break;
+        case POWERMGM_SHUTDOWN:
+        case POWERMGM_RESET:
+            discharge_model_save( &battery_runtime_model, BATTERY_RUNTIME_FILENAME );
+            break;
+    }
+    return( true );
+}
+
+bool battery_runtime_powermgm_loop_cb( EventBits_t event, void *arg ) {
+    /*
+     * close the interval when it is long enough for the coulomb counter resolution
+     */
+    if ( millis() - battery_runtime_last_ms < 1000 ) {
+        return( true );
+    }
+    battery_runtime_account();
+    if ( battery_runtime_model.interval < BATTERY_RUNTIME_INTERVAL ) {
+        return( true );
+    }
+
+    float mah = pmu_get_coulumb_data();
+    float consumed = battery_runtime_last_mah - mah;
+    battery_runtime_last_mah = mah;
+    /*
+     * no learning while charging or after the pmu has cleared the counter
+     */
+    if ( battery_runtime_plug || consumed < 0.0f || consumed * 3600.0f / battery_runtime_model.interval > BATTERY_RUNTIME_MAX_CURRENT ) {
+        discharge_model_discard( &battery_runtime_model );
+        return( true );
+    }
+    discharge_model_update( &battery_runtime_model, consumed );
+    log_d("discharge model: %.2fmA mean, %.2fmA error, runtime %ds", battery_runtime_model.mean, battery_runtime_model.error, battery_runtime_get_runtime() );
+    return( true );
+}
+
+bool battery_runtime_pmu_event_cb( EventBits_t event, void *arg ) {
+    switch( event ) {
+        case PMUCTL_STATUS: {
+            battery_runtime_percent = *(int32_t*)arg & PMUCTL_STATUS_PERCENT;
+            bool plug = *(int32_t*)arg & PMUCTL_STATUS_PLUG;
+            /*
+             * save the learned model once per charge
+             */
+            if ( plug && !battery_runtime_plug ) {
+                discharge_model_save( &battery_runtime_model, BATTERY_RUNTIME_FILENAME );
+            }
+            if ( plug != battery_runtime_plug ) {
+                battery_runtime_account();
+                discharge_model_discard( &battery_runtime_model );
+                battery_runtime_last_mah = pmu_get_coulumb_data();
+                battery_runtime_plug = plug;
+            }
+            break;
+        }
+    }
+    return( true );
+}
+
+bool battery_runtime_wifictl_event_cb( EventBits_t event, void *arg ) {
+    switch( event ) {
+        case WIFICTL_ON:
+            battery_runtime_set_load( BATTERY_RUNTIME_WIFI, true );
+            break;
+        case WIFICTL_OFF:
+            battery_runtime_set_load( BATTERY_RUNTIME_WIFI, false );
+            break;
+    }
+    return( true );
+}
+
+bool battery_runtime_blectl_event_cb( EventBits_t event, void *arg ) {
+    switch( event ) {
+        case BLECTL_CONNECT:
+            battery_runtime_set_load( BATTERY_RUNTIME_BLE, true );
+            break;
+        case BLECTL_DISCONNECT:
+            battery_runtime_set_load( BATTERY_RUNTIME_BLE, false );
+            break;
+    }
+    return( true );
+}
+
+bool battery_runtime_gpsctl_event_cb( EventBits_t event, void *arg ) {
+    switch( event ) {
+        case GPSCTL_ENABLE:
+            battery_runtime_set_load( BATTERY_RUNTIME_GPS, true );
+            break;
+        case GPSCTL_DISABLE:
+            battery_runtime_set_load( BATTERY_RUNTIME_GPS, false );
+            break;
+    }
+    return( true );
+}
+
+bool battery_runtime_sound_event_cb( EventBits_t event, void *arg ) {
+    switch( event ) {
+        case SOUNDCTL_ENABLED:
+            battery_runtime_sound = *(bool*)arg;
+            battery_runtime_set_load( BATTERY_RUNTIME_SOUND, battery_runtime_sound && !( battery_runtime_loads & _BV( BATTERY_RUNTIME_STANDBY ) ) );
+            break;
+    }
+    return( true );
+}
+
+uint32_t battery_runtime_get_runtime( void ) {
+    if ( battery_runtime_plug || battery_runtime_percent < 0 ) {
+        return( 0 );
+    }
+    return( discharge_model_get_runtime( &battery_runtime_model, battery_runtime_percent * pmu_get_designed_battery_cap() / 100.0f ) );
+}
+
+float battery_runtime_get_current( void ) {
+    return( discharge_model_get_current( &battery_runtime_model, battery_runtime_loads ) );
+}
+
+discharge_model_t *battery_runtime_get_model( void ) {
+    return( &battery_runtime_model );
+}
+
+const char *battery_runtime_get_load_name( int load ) {
+    if ( load < 0 || load >= BATTERY_RUNTIME_LOADS ) {
+        return( NULL );
+    }
+    return( battery_runtime_load_names[ load ] );
+}
@@ -0,0 +1,72 @@
+/****************************************************************************
+ *   Oct 18 19:31:08 2026
+ *   Copyright  2026  My-TTGO-Watch contributors
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#ifndef _BATTERY_RUNTIME_H
+    #define _BATTERY_RUNTIME_H
+
+    #include "utils/discharge_model.h"
+
+    #define BATTERY_RUNTIME_INTERVAL    600                 /** @brief min seconds per model update, some coulomb counter steps even in standby */
+    #define BATTERY_RUNTIME_MAX_CURRENT 1000.0f             /** @brief max plausible discharge current in mA, above the counter was cleared */
+    #define BATTERY_RUNTIME_FILENAME    "/spiffs/discharge.bin"
+
+    enum {
+        BATTERY_RUNTIME_STANDBY = 0,                        /** @brief powermgm standby */
+        BATTERY_RUNTIME_SILENCE_WAKEUP,                     /** @brief powermgm silence wakeup */
+        BATTERY_RUNTIME_WAKEUP,                             /** @brief powermgm wakeup */
+        BATTERY_RUNTIME_WIFI,                               /** @brief wifi on */
+        BATTERY_RUNTIME_BLE,                                /** @brief ble connected */
+        BATTERY_RUNTIME_GPS,                                /** @brief gps enabled */
+        BATTERY_RUNTIME_SOUND,                              /** @brief sound enabled and not in standby */
+        BATTERY_RUNTIME_LOADS
+    };
+
+    /**
+     * @brief setup the discharge model, call after pmu setup
+     */
+    void battery_runtime_setup( void );
+    /**
+     * @brief get the predicted runtime with the current charge and the learned usage
+     *
+     * @return  runtime in seconds, 0 if unknown or charging
+     */
+    uint32_t battery_runtime_get_runtime( void );
+    /**
+     * @brief get the predicted current with the loads that are on now
+     *
+     * @return  current in mA
+     */
+    float battery_runtime_get_current( void );
+    /**
+     * @brief get the discharge model, e.g. for discharge_model_rank()
+     *
+     * @return  pointer to the model
+     */
+    discharge_model_t *battery_runtime_get_model( void );
+    /**
+     * @brief get the name of a load
+     *
+     * @param   load        BATTERY_RUNTIME_STANDBY ... BATTERY_RUNTIME_SOUND
+     *
+     * @return  pointer to the name or NULL if failed
+     */
+    const char *battery_runtime_get_load_name( int load );
+
+#endif // _BATTERY_RUNTIME_H
@@ -0,0 +1,185 @@
+/****************************************************************************
+ *   Oct 18 10:12:41 2026
+ *   Copyright  2026  My-TTGO-Watch contributors
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#include "config.h"
+#include <esp_timer.h>
+
+#include "bench.h"
+
+#include "hardware/powermgm.h"
+
+static bench_entry_t bench_table[ BENCH_MAX_ENTRYS ];
+static int32_t bench_entrys = 0;
+static uint32_t bench_overflows = 0;
+portMUX_TYPE DRAM_ATTR benchMux = portMUX_INITIALIZER_UNLOCKED;
+
+bool bench_powermgm_loop_cb( EventBits_t event, void *arg );
+
+void bench_setup( void ) {
+    powermgm_register_loop_cb( POWERMGM_WAKEUP | POWERMGM_SILENCE_WAKEUP, bench_powermgm_loop_cb, "bench loop" );
+}
+
+bool bench_powermgm_loop_cb( EventBits_t event, void *arg ) {
+    static uint64_t next_report = BENCH_REPORT_INTERVAL * 1000000ULL;
+    /**
+     * print out a report every BENCH_REPORT_INTERVAL seconds
+     */
+    if ( esp_timer_get_time() > next_report ) {
+        next_report = esp_timer_get_time() + BENCH_REPORT_INTERVAL * 1000000ULL;
+        bench_print();
+    }
+    return( true );
+}
+
+int32_t bench_register( const char *id, uint32_t budget_us ) {
+    int32_t retval = -1;
+
+    portENTER_CRITICAL( &benchMux );
+    /**
+     * check if the id already registered
+     */
+    for( int32_t i = 0 ; i < bench_entrys ; i++ ) {
+        if ( !strncmp( bench_table[ i ].id, id, BENCH_ID_SIZE - 1 ) ) {
+            retval = i;
+            break;
+        }
+    }
+    /**
+     * add a new entry if we have space left
+     */
+    if ( retval == -1 && bench_entrys < BENCH_MAX_ENTRYS ) {
+        retval = bench_entrys;
+        strlcpy( bench_table[ retval ].id, id, BENCH_ID_SIZE );
+        bench_table[ retval ].budget_us = budget_us;
+        bench_table[ retval ].count = 0;
+        bench_table[ retval ].total_us = 0;
+        bench_table[ retval ].min_us = UINT32_MAX;
+        bench_table[ retval ].max_us = 0;
+        bench_entrys++;
+    }
+    else if ( retval == -1 ) {
+        bench_overflows++;
+    }
+    portEXIT_CRITICAL( &benchMux );
+    /**
+     * the worker registers one entry per job id, so only the first overflow is logged as error
+     */
+    if ( retval == -1 ) {
+        if ( bench_overflows == 1 )
+            log_e("bench table full, can't register: %s, raise BENCH_MAX_ENTRYS", id );
+        else
+            log_d("bench table full, can't register: %s", id );
+    }
+    return( retval );
+}
+
+uint64_t bench_begin( int32_t handle ) {
+    return( esp_timer_get_time() );
+}
+
+uint32_t bench_end( int32_t handle, uint64_t start_us ) {
+    if ( handle < 0 || handle >= bench_entrys ) {
+        return( 0 );
+    }
+    uint32_t us = esp_timer_get_time() - start_us;
+    bench_add( handle, us );
+    return( us );
+}
+
+void bench_add( int32_t handle, uint32_t us ) {
+    if ( handle < 0 || handle >= bench_entrys ) {
+        return;
+    }
+    portENTER_CRITICAL( &benchMux );
+    bench_entry_t *entry = &bench_table[ handle ];
+    entry->count++;
+    entry->total_us += us;
+    if ( us < entry->min_us ) {
+        entry->min_us = us;
+    }
+    if ( us > entry->max_us ) {
+        entry->max_us = us;
+    }
+    portEXIT_CRITICAL( &benchMux );
+}
+
+const bench_entry_t *bench_get_entry( int32_t handle ) {
+    if ( handle < 0 || handle >= bench_entrys ) {
+        return( NULL );
+    }
+    return( &bench_table[ handle ] );
+}
+
+int32_t bench_get_entrys( void ) {
+    return( bench_entrys );
+}
+
+uint32_t bench_get_overflows( void ) {
+    return( bench_overflows );
+}
+
+static bool bench_entry_in_budget( bench_entry_t *entry ) {
+    if ( entry->budget_us == BENCH_NO_BUDGET || entry->count == 0 ) {
+        return( true );
+    }
+    return( ( entry->total_us / entry->count ) <= entry->budget_us );
+}
+
+bool bench_check( void ) {
+    bool retval = true;
+
+    for( int32_t i = 0 ; i < bench_entrys ; i++ ) {
+        if ( !bench_entry_in_budget( &bench_table[ i ] ) ) {
+            retval = false;
+        }
+    }
+    return( retval );
+}
+
+void bench_print( void ) {
+    log_i("bench: %d entrys", bench_entrys );
+    if ( bench_overflows ) {
+        log_e(" |--%d registrations failed, table full", bench_overflows );
+    }
+    for( int32_t i = 0 ; i < bench_entrys ; i++ ) {
+        bench_entry_t *entry = &bench_table[ i ];
+
+        if ( entry->count == 0 ) {
+            continue;
+        }
+        if ( bench_entry_in_budget( entry ) ) {
+            log_i(" |--%s: count=%d, min=%dus, avg=%lluus, max=%dus", entry->id, entry->count, entry->min_us, entry->total_us / entry->count, entry->max_us );
+        }
+        else {
+            log_e(" |--%s: count=%d, min=%dus, avg=%lluus, max=%dus, regression, budget=%dus", entry->id, entry->count, entry->min_us, entry->total_us / entry->count, entry->max_us, entry->budget_us );
+        }
+    }
+}
+
+void bench_reset( void ) {
+    portENTER_CRITICAL( &benchMux );
+    for( int32_t i = 0 ; i < bench_entrys ; i++ ) {
+        bench_table[ i ].count = 0;
+        bench_table[ i ].total_us = 0;
+        bench_table[ i ].min_us = UINT32_MAX;
+        bench_table[ i ].max_us = 0;
+    }
+    portEXIT_CRITICAL( &benchMux );
+}
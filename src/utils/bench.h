@@ -0,0 +1,125 @@
+/****************************************************************************
+ *   Oct 18 10:12:41 2026
+ *   Copyright  2026  My-TTGO-Watch contributors
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#ifndef _BENCH_H
+    #define _BENCH_H
+
+    #include <stdint.h>
+    #include <stddef.h>
+
+    #define BENCH_MAX_ENTRYS            64              /** @brief max number of bench entrys */
+    #define BENCH_ID_SIZE               32              /** @brief max id length with the terminating zero, longer ids are cut */
+    #define BENCH_REPORT_INTERVAL       60              /** @brief report interval in seconds */
+    #define BENCH_NO_BUDGET             0               /** @brief no regression check for this entry */
+
+    /**
+     * @brief bench entry structure
+     */
+    typedef struct {
+        char id[ BENCH_ID_SIZE ];           /** @brief id for the bench entry, copied from bench_register */
+        uint32_t budget_us;                 /** @brief max allowed average runtime in us, BENCH_NO_BUDGET for none */
+        uint32_t count;                     /** @brief number of measurements */
+        uint64_t total_us;                  /** @brief sum of all measurements in us */
+        uint32_t min_us;                    /** @brief fastest measurement in us */
+        uint32_t max_us;                    /** @brief slowest measurement in us */
+    } bench_entry_t;
+
+    #ifdef __cplusplus
+    extern "C" {
+    #endif
+
+    /**
+     * @brief setup bench report, call after powermgm setup
+     */
+    void bench_setup( void );
+    /**
+     * @brief register a bench entry, if the id already exist the existing entry is returned
+     *
+     * @param   id          pointer to an string thats contains the id aka name for the entry, the string is copied
+     * @param   budget_us   max allowed average runtime in us or BENCH_NO_BUDGET
+     *
+     * @return  bench handle or -1 if failed
+     */
+    int32_t bench_register( const char *id, uint32_t budget_us );
+    /**
+     * @brief start a measurement, the start time is kept by the caller so
+     * the same handle can be measured from several tasks at once
+     *
+     * @param   handle      bench handle from bench_register
+     *
+     * @return  start timestamp in us, pass it to bench_end
+     */
+    uint64_t bench_begin( int32_t handle );
+    /**
+     * @brief stop a measurement started with bench_begin and account it
+     *
+     * @param   handle      bench handle from bench_register
+     * @param   start_us    timestamp returned by bench_begin
+     *
+     * @return  measured time in us
+     */
+    uint32_t bench_end( int32_t handle, uint64_t start_us );
+    /**
+     * @brief account an external measured time
+     *
+     * @param   handle      bench handle from bench_register
+     * @param   us          time in us
+     */
+    void bench_add( int32_t handle, uint32_t us );
+    /**
+     * @brief get a bench entry
+     *
+     * @param   handle      bench handle from bench_register
+     *
+     * @return  pointer to a bench_entry_t or NULL if handle invalid
+     */
+    const bench_entry_t *bench_get_entry( int32_t handle );
+    /**
+     * @brief get the number of registered bench entrys
+     *
+     * @return  number of entrys
+     */
+    int32_t bench_get_entrys( void );
+    /**
+     * @brief get the number of bench_register calls that failed on a full table
+     *
+     * @return  number of failed registrations
+     */
+    uint32_t bench_get_overflows( void );
+    /**
+     * @brief check all entrys against their budget
+     *
+     * @return  true if all entrys within budget, false if an regression detected
+     */
+    bool bench_check( void );
+    /**
+     * @brief prints out all bench entrys and their regression state
+     */
+    void bench_print( void );
+    /**
+     * @brief clear all measurements, registered entrys and budgets stay
+     */
+    void bench_reset( void );
+
+    #ifdef __cplusplus
+    }
+    #endif
+
+#endif // _BENCH_H
@@ -0,0 +1,137 @@
+/****************************************************************************
+ *   Oct 19 14:05:12 2026
+ *   Copyright  2026  My-TTGO-Watch contributors
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#include "ble_tx.h"
+
+/**
+ * @brief get the oldest msg of a lane
+ */
+static ble_tx_msg_t *ble_tx_lane_tail( ble_tx_lane_t *lane ) {
+    return( &lane->msg[ ( lane->head + lane->size - lane->count ) % lane->size ] );
+}
+
+void ble_tx_init( ble_tx_t *tx, ble_tx_msg_t *control, uint32_t control_size, ble_tx_msg_t *bulk, uint32_t bulk_size ) {
+    tx->lane[ BLE_TX_CONTROL ].msg = control;
+    tx->lane[ BLE_TX_CONTROL ].size = control_size;
+    tx->lane[ BLE_TX_BULK ].msg = bulk;
+    tx->lane[ BLE_TX_BULK ].size = bulk_size;
+    for( uint32_t i = 0 ; i < BLE_TX_LANES ; i++ ) {
+        tx->lane[ i ].head = 0;
+        tx->lane[ i ].count = 0;
+    }
+    tx->has_active = false;
+    tx->pos = 0;
+    tx->link = 0;
+    tx->ready = false;
+    tx->mtu = BLE_TX_DEFAULT_MTU;
+    tx->credits = BLE_TX_CREDITS;
+    tx->congested = false;
+    tx->last_send = 0;
+    tx->timeouts = 0;
+}
+
+void ble_tx_new_link( ble_tx_t *tx ) {
+    tx->link++;
+    tx->credits = BLE_TX_CREDITS;
+    tx->congested = false;
+}
+
+bool ble_tx_push( ble_tx_t *tx, uint32_t lane, const ble_tx_msg_t *msg ) {
+    ble_tx_lane_t *l = &tx->lane[ lane ];
+
+    if ( msg->link != tx->link || l->count == l->size ) {
+        return( false );
+    }
+    l->msg[ l->head ] = *msg;
+    l->head = ( l->head + 1 ) % l->size;
+    l->count++;
+    return( true );
+}
+
+void ble_tx_complete( ble_tx_t *tx ) {
+    if ( tx->credits < BLE_TX_CREDITS ) {
+        tx->credits++;
+    }
+}
+
+ble_tx_result_t ble_tx_poll( ble_tx_t *tx, uint32_t now, ble_tx_out_t *out ) {
+    /*
+     * drop msg of old links, also while the link is not ready. a lane is in
+     * link order, so old msg are always at the tail
+     */
+    if ( tx->has_active && tx->active.link != tx->link ) {
+        out->msg = tx->active;
+        tx->has_active = false;
+        return( BLE_TX_DROPPED );
+    }
+    for( uint32_t i = 0 ; i < BLE_TX_LANES ; i++ ) {
+        ble_tx_lane_t *lane = &tx->lane[ i ];
+        if ( lane->count && ble_tx_lane_tail( lane )->link != tx->link ) {
+            out->msg = *ble_tx_lane_tail( lane );
+            lane->count--;
+            return( BLE_TX_DROPPED );
+        }
+    }
+    /*
+     * msg of the current link wait until the link is ready
+     */
+    if ( !tx->ready ) {
+        return( BLE_TX_IDLE );
+    }
+    if ( !tx->has_active ) {
+        uint32_t i = 0;
+        while( i < BLE_TX_LANES && tx->lane[ i ].count == 0 ) {
+            i++;
+        }
+        if ( i == BLE_TX_LANES ) {
+            return( BLE_TX_IDLE );
+        }
+        tx->active = *ble_tx_lane_tail( &tx->lane[ i ] );
+        tx->lane[ i ].count--;
+        tx->has_active = true;
+        tx->pos = 0;
+    }
+    if ( tx->pos >= tx->active.len ) {
+        out->msg = tx->active;
+        tx->has_active = false;
+        return( BLE_TX_DONE );
+    }
+    /*
+     * restore credits if the stack don't report the notify completion
+     */
+    if ( tx->credits <= 0 && now - tx->last_send > BLE_TX_TIMEOUT ) {
+        tx->credits = BLE_TX_CREDITS;
+        tx->timeouts++;
+    }
+    if ( tx->congested || tx->credits <= 0 ) {
+        return( BLE_TX_WAIT );
+    }
+    uint32_t len = tx->active.len - tx->pos;
+    if ( len > (uint32_t)( tx->mtu - BLE_TX_ATT_HEADER ) ) {
+        len = tx->mtu - BLE_TX_ATT_HEADER;
+    }
+    out->chunk = &tx->active.data[ tx->pos ];
+    out->len = len;
+    tx->pos += len;
+    out->pos = tx->pos;
+    tx->credits--;
+    tx->last_send = now;
+    return( BLE_TX_CHUNK );
+}
@@ -0,0 +1,149 @@
+/****************************************************************************
+ *   Oct 19 14:05:12 2026
+ *   Copyright  2026  My-TTGO-Watch contributors
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#ifndef _BLE_TX_H
+    #define _BLE_TX_H
+
+    #include <stdint.h>
+    #include <stdbool.h>
+
+    /*
+     * note:    this module is plain C without arduino dependencies,
+     *          tools/ble_tx_sim.cpp builds it on the host.
+     *
+     * two msg lanes, control before bulk, are sent in ATT MTU sized chunks
+     * paced by notify completion credits and congestion. every msg is tagged
+     * with the link number it was queued for, msg of an old link are dropped,
+     * msg queued for the current link wait until the link is ready.
+     * the functions are not thread safe, the caller locks.
+     */
+    #define BLE_TX_DEFAULT_MTU          23      /** @brief ATT MTU until the client negotiate a bigger one */
+    #define BLE_TX_ATT_HEADER           3       /** @brief ATT notify header size, chunksize is MTU - header */
+    #define BLE_TX_CREDITS              4       /** @brief max notifys in flight without a completion event */
+    #define BLE_TX_TIMEOUT              250     /** @brief time in ms without completion event before credits are restored */
+
+    #define BLE_TX_CONTROL              0       /** @brief control lane, sent first */
+    #define BLE_TX_BULK                 1       /** @brief bulk lane */
+    #define BLE_TX_LANES                2       /** @brief number of lanes */
+
+    /**
+     * @brief ble tx msg
+     */
+    typedef struct {
+        char *data;                     /** @brief msg data, the caller frees it after BLE_TX_DONE or BLE_TX_DROPPED */
+        uint32_t len;                   /** @brief msg length */
+        uint32_t link;                  /** @brief link number the msg was queued for */
+        uint64_t queued_us;             /** @brief time in us when the msg was queued */
+    } ble_tx_msg_t;
+
+    /**
+     * @brief ble tx msg ring
+     */
+    typedef struct {
+        ble_tx_msg_t *msg;              /** @brief msg array, owned by the caller */
+        uint32_t size;                  /** @brief number of msg in the array */
+        uint32_t head;                  /** @brief next free entry */
+        uint32_t count;                 /** @brief number of queued msg */
+    } ble_tx_lane_t;
+
+    /**
+     * @brief ble_tx_poll result
+     */
+    typedef enum {
+        BLE_TX_IDLE = 0,                /** @brief nothing to send or link not ready */
+        BLE_TX_WAIT,                    /** @brief wait for a completion event or the end of the congestion */
+        BLE_TX_CHUNK,                   /** @brief notify the chunk */
+        BLE_TX_DONE,                    /** @brief last chunk of msg was sent */
+        BLE_TX_DROPPED                  /** @brief msg of an old link dropped */
+    } ble_tx_result_t;
+
+    /**
+     * @brief ble_tx_poll output
+     */
+    typedef struct {
+        const char *chunk;              /** @brief chunk data on BLE_TX_CHUNK */
+        uint32_t len;                   /** @brief chunk length on BLE_TX_CHUNK */
+        uint32_t pos;                   /** @brief msg position after the chunk */
+        ble_tx_msg_t msg;               /** @brief msg on BLE_TX_DONE and BLE_TX_DROPPED */
+    } ble_tx_out_t;
+
+    /**
+     * @brief ble tx engine state
+     */
+    typedef struct {
+        ble_tx_lane_t lane[ BLE_TX_LANES ];     /** @brief msg lanes */
+        ble_tx_msg_t active;                    /** @brief msg in progress */
+        bool has_active;                        /** @brief active is valid */
+        uint32_t pos;                           /** @brief position in the active msg */
+        uint32_t link;                          /** @brief current link number, incremented on connect and disconnect */
+        bool ready;                             /** @brief link is ready to send */
+        uint16_t mtu;                           /** @brief negotiated ATT MTU */
+        int32_t credits;                        /** @brief notifys left without a completion event */
+        bool congested;                         /** @brief stack reports congestion */
+        uint32_t last_send;                     /** @brief time in ms of the last notify */
+        uint32_t timeouts;                      /** @brief credit restores without completion event */
+    } ble_tx_t;
+
+    /**
+     * @brief set up an empty engine
+     *
+     * @param   tx          pointer to the engine
+     * @param   control     control lane msg array
+     * @param   control_size    number of control lane msg
+     * @param   bulk        bulk lane msg array
+     * @param   bulk_size   number of bulk lane msg
+     */
+    void ble_tx_init( ble_tx_t *tx, ble_tx_msg_t *control, uint32_t control_size, ble_tx_msg_t *bulk, uint32_t bulk_size );
+    /**
+     * @brief start a new link on connect or disconnect, msg of the old link
+     * are dropped by the next ble_tx_poll calls
+     *
+     * @param   tx          pointer to the engine
+     */
+    void ble_tx_new_link( ble_tx_t *tx );
+    /**
+     * @brief queue a msg
+     *
+     * @param   tx          pointer to the engine
+     * @param   lane        BLE_TX_CONTROL or BLE_TX_BULK
+     * @param   msg         msg, link is the link number read before the connection state was checked
+     *
+     * @return  false if the lane is full or msg->link is an old link
+     */
+    bool ble_tx_push( ble_tx_t *tx, uint32_t lane, const ble_tx_msg_t *msg );
+    /**
+     * @brief a notify is completed
+     *
+     * @param   tx          pointer to the engine
+     */
+    void ble_tx_complete( ble_tx_t *tx );
+    /**
+     * @brief get the next step, call it until BLE_TX_IDLE or BLE_TX_WAIT. a chunk is
+     * counted as sent when it is returned
+     *
+     * @param   tx          pointer to the engine
+     * @param   now         time in ms
+     * @param   out         pointer to the output
+     *
+     * @return  result
+     */
+    ble_tx_result_t ble_tx_poll( ble_tx_t *tx, uint32_t now, ble_tx_out_t *out );
+
+#endif // _BLE_TX_H
@@ -0,0 +1,77 @@
+/****************************************************************************
+ *   Oct 18 16:12:37 2026
+ *   Copyright  2026  My-TTGO-Watch contributors
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#include "config.h"
+#include <Arduino.h>
+#include "esp_timer.h"
+
+#include "boot_profiler.h"
+
+/*
+ * fixed table, recording a stage must not change the measured heap
+ */
+static boot_profiler_mark_t boot_profiler_marks[ BOOT_PROFILER_MARKS ];
+static int32_t boot_profiler_entrys = 0;
+static bool boot_profiler_finished = false;
+
+void boot_profiler_mark( const char *stage ) {
+    if ( boot_profiler_finished || boot_profiler_entrys >= BOOT_PROFILER_MARKS ) {
+        return;
+    }
+    boot_profiler_mark_t *mark = &boot_profiler_marks[ boot_profiler_entrys++ ];
+    mark->stage = stage;
+    mark->us = esp_timer_get_time();
+    mark->heap = ESP.getFreeHeap();
+    mark->psram = ESP.getFreePsram();
+}
+
+void boot_profiler_finish( void ) {
+    if ( boot_profiler_finished ) {
+        return;
+    }
+    boot_profiler_mark( "first frame" );
+    boot_profiler_finished = true;
+    boot_profiler_print();
+}
+
+bool boot_profiler_is_finished( void ) {
+    return( boot_profiler_finished );
+}
+
+int32_t boot_profiler_get_marks( void ) {
+    return( boot_profiler_entrys );
+}
+
+const boot_profiler_mark_t *boot_profiler_get_mark( int32_t mark ) {
+    if ( mark < 0 || mark >= boot_profiler_entrys ) {
+        return( NULL );
+    }
+    return( &boot_profiler_marks[ mark ] );
+}
+
+void boot_profiler_print( void ) {
+    uint32_t last = 0;
+
+    for( int32_t i = 0 ; i < boot_profiler_entrys ; i++ ) {
+        boot_profiler_mark_t *mark = &boot_profiler_marks[ i ];
+        log_i("boot: %6dms (+%5dms) heap=%d psram=%d %s", mark->us / 1000, ( mark->us - last ) / 1000, mark->heap, mark->psram, mark->stage );
+        last = mark->us;
+    }
+}
@@ -0,0 +1,74 @@
+/****************************************************************************
+ *   Oct 18 16:12:37 2026
+ *   Copyright  2026  My-TTGO-Watch contributors
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#ifndef _BOOT_PROFILER_H
+    #define _BOOT_PROFILER_H
+
+    #include <stdint.h>
+
+    #define BOOT_PROFILER_MARKS             96                  /** @brief max number of recorded boot stages */
+
+    /**
+     * @brief one boot stage
+     */
+    typedef struct {
+        const char *stage;                  /** @brief stage name, the pointer must stay valid */
+        uint32_t us;                        /** @brief time since power on in us */
+        uint32_t heap;                      /** @brief free heap */
+        uint32_t psram;                     /** @brief free psram */
+    } boot_profiler_mark_t;
+
+    /**
+     * @brief record the end of a boot stage, ignored after boot_profiler_finish
+     *
+     * @param   stage       stage name, the pointer must stay valid
+     */
+    void boot_profiler_mark( const char *stage );
+    /**
+     * @brief record the first frame after setup and stop recording, the
+     * profile is printed
+     */
+    void boot_profiler_finish( void );
+    /**
+     * @brief check if the boot is finished
+     *
+     * @return  true if boot_profiler_finish was called
+     */
+    bool boot_profiler_is_finished( void );
+    /**
+     * @brief get the number of recorded stages
+     *
+     * @return  number of recorded stages
+     */
+    int32_t boot_profiler_get_marks( void );
+    /**
+     * @brief get a recorded stage
+     *
+     * @param   mark        stage number, 0...boot_profiler_get_marks()-1
+     *
+     * @return  pointer to the stage or NULL if failed
+     */
+    const boot_profiler_mark_t *boot_profiler_get_mark( int32_t mark );
+    /**
+     * @brief print all recorded stages
+     */
+    void boot_profiler_print( void );
+
+#endif // _BOOT_PROFILER_H
@@ -0,0 +1,225 @@
+/****************************************************************************
+ *   Oct 18 19:02:40 2026
+ *   Copyright  2026  My-TTGO-Watch contributors
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include "discharge_model.h"
+
+void discharge_model_init( discharge_model_t *dm, uint8_t loads, const float *prior ) {
+    memset( dm, 0, sizeof( discharge_model_t ) );
+    dm->loads = loads > DISCHARGE_MODEL_MAX_LOADS ? DISCHARGE_MODEL_MAX_LOADS : loads;
+    /*
+     * the prior is the starting point, the start variance allows
+     * the first intervals to move it freely
+     */
+    for( int i = 0 ; i < dm->loads ; i++ ) {
+        dm->current[ i ] = prior[ i ];
+        dm->p[ i ][ i ] = DISCHARGE_MODEL_MAX_VAR;
+    }
+}
+
+void discharge_model_account( discharge_model_t *dm, uint32_t load_mask, float seconds ) {
+    if ( seconds <= 0.0f ) {
+        return;
+    }
+    for( int i = 0 ; i < dm->loads ; i++ ) {
+        if ( load_mask & ( 1 << i ) ) {
+            dm->on_time[ i ] += seconds;
+        }
+    }
+    dm->interval += seconds;
+}
+
+void discharge_model_discard( discharge_model_t *dm ) {
+    memset( dm->on_time, 0, sizeof( dm->on_time ) );
+    dm->interval = 0.0f;
+}
+
+bool discharge_model_update( discharge_model_t *dm, float mah ) {
+    float x[ DISCHARGE_MODEL_MAX_LOADS ];
+    float px[ DISCHARGE_MODEL_MAX_LOADS ];
+    int n = dm->loads;
+
+    if ( dm->interval < 1.0f ) {
+        discharge_model_discard( dm );
+        return( false );
+    }
+    /*
+     * regressor is the on time part per load, the measurement the mean current
+     */
+    for( int i = 0 ; i < n ; i++ ) {
+        x[ i ] = dm->on_time[ i ] / dm->interval;
+    }
+    float y = mah * 3600.0f / dm->interval;
+    float alpha = dm->interval / DISCHARGE_MODEL_MIX_TIME;
+    alpha = alpha > 1.0f ? 1.0f : alpha;
+    discharge_model_discard( dm );
+    /*
+     * recursive least squares with forgetting:
+     *
+     *      k = P x / ( l + x' P x )
+     *      current += k ( y - current' x )
+     *      P = ( P - k x' P ) / l
+     */
+    float denom = DISCHARGE_MODEL_FORGET;
+    float predicted = 0.0f;
+    for( int i = 0 ; i < n ; i++ ) {
+        px[ i ] = 0.0f;
+        for( int j = 0 ; j < n ; j++ ) {
+            px[ i ] += dm->p[ i ][ j ] * x[ j ];
+        }
+        denom += x[ i ] * px[ i ];
+        predicted += dm->current[ i ] * x[ i ];
+    }
+    float e = y - predicted;
+    for( int i = 0 ; i < n ; i++ ) {
+        dm->current[ i ] += px[ i ] / denom * e;
+        /*
+         * a load can not deliver charge
+         */
+        if ( dm->current[ i ] < 0.0f ) {
+            dm->current[ i ] = 0.0f;
+        }
+    }
+    for( int i = 0 ; i < n ; i++ ) {
+        for( int j = 0 ; j < n ; j++ ) {
+            dm->p[ i ][ j ] = ( dm->p[ i ][ j ] - px[ i ] * px[ j ] / denom ) / DISCHARGE_MODEL_FORGET;
+        }
+    }
+    /*
+     * the variance of loads that are never on grows with each forgetting,
+     * scale row and column back to keep the matrix positive definite
+     */
+    for( int i = 0 ; i < n ; i++ ) {
+        if ( dm->p[ i ][ i ] > DISCHARGE_MODEL_MAX_VAR ) {
+            float s = sqrtf( DISCHARGE_MODEL_MAX_VAR / dm->p[ i ][ i ] );
+            for( int j = 0 ; j < n ; j++ ) {
+                dm->p[ i ][ j ] *= s;
+                dm->p[ j ][ i ] *= s;
+            }
+        }
+    }
+    /*
+     * statistics and usage mix
+     */
+    if ( dm->updates ) {
+        dm->error += ( fabsf( e ) - dm->error ) * 0.05f;
+        dm->mean += ( y - dm->mean ) * alpha;
+    }
+    else {
+        dm->error = fabsf( e );
+        dm->mean = y;
+        alpha = 1.0f;
+    }
+    for( int i = 0 ; i < n ; i++ ) {
+        dm->mix[ i ] += ( x[ i ] - dm->mix[ i ] ) * alpha;
+    }
+    dm->updates++;
+    return( true );
+}
+
+float discharge_model_get_current( discharge_model_t *dm, uint32_t load_mask ) {
+    float current = 0.0f;
+
+    for( int i = 0 ; i < dm->loads ; i++ ) {
+        if ( load_mask & ( 1 << i ) ) {
+            current += dm->current[ i ];
+        }
+    }
+    return( current );
+}
+
+float discharge_model_get_mean_current( discharge_model_t *dm ) {
+    float current = 0.0f;
+
+    for( int i = 0 ; i < dm->loads ; i++ ) {
+        current += dm->current[ i ] * dm->mix[ i ];
+    }
+    return( current );
+}
+
+uint32_t discharge_model_get_runtime( discharge_model_t *dm, float mah ) {
+    float current = discharge_model_get_mean_current( dm );
+
+    if ( !dm->updates || current <= 0.0f || mah <= 0.0f ) {
+        return( 0 );
+    }
+    return( (uint32_t)( mah / current * 3600.0f ) );
+}
+
+void discharge_model_rank( discharge_model_t *dm, uint8_t *order, float *drain ) {
+    float value[ DISCHARGE_MODEL_MAX_LOADS ];
+
+    for( int i = 0 ; i < dm->loads ; i++ ) {
+        order[ i ] = i;
+        value[ i ] = dm->current[ i ] * dm->mix[ i ];
+    }
+    /*
+     * insertion sort, a handful of loads
+     */
+    for( int i = 1 ; i < dm->loads ; i++ ) {
+        for( int j = i ; j > 0 && value[ order[ j ] ] > value[ order[ j - 1 ] ] ; j-- ) {
+            uint8_t tmp = order[ j ];
+            order[ j ] = order[ j - 1 ];
+            order[ j - 1 ] = tmp;
+        }
+    }
+    if ( drain ) {
+        for( int i = 0 ; i < dm->loads ; i++ ) {
+            drain[ i ] = value[ order[ i ] ];
+        }
+    }
+}
+
+bool discharge_model_save( discharge_model_t *dm, const char *filename ) {
+    uint32_t magic = DISCHARGE_MODEL_MAGIC;
+    bool retval = false;
+
+    FILE *file = fopen( filename, "wb" );
+    if ( !file ) {
+        return( false );
+    }
+    if ( fwrite( &magic, sizeof( magic ), 1, file ) == 1 && fwrite( dm, sizeof( discharge_model_t ), 1, file ) == 1 ) {
+        retval = true;
+    }
+    fclose( file );
+    return( retval );
+}
+
+bool discharge_model_load( discharge_model_t *dm, const char *filename ) {
+    discharge_model_t saved;
+    uint32_t magic = 0;
+    bool retval = false;
+
+    FILE *file = fopen( filename, "rb" );
+    if ( !file ) {
+        return( false );
+    }
+    if ( fread( &magic, sizeof( magic ), 1, file ) == 1 && magic == DISCHARGE_MODEL_MAGIC &&
+         fread( &saved, sizeof( discharge_model_t ), 1, file ) == 1 && saved.loads == dm->loads ) {
+        memcpy( dm, &saved, sizeof( discharge_model_t ) );
+        discharge_model_discard( dm );
+        retval = true;
+    }
+    fclose( file );
+    return( retval );
+}
@@ -0,0 +1,153 @@
+/****************************************************************************
+ *   Oct 18 19:02:40 2026
+ *   Copyright  2026  My-TTGO-Watch contributors
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#ifndef _DISCHARGE_MODEL_H
+    #define _DISCHARGE_MODEL_H
+
+    #include <stdint.h>
+    #include <stdbool.h>
+
+    /*
+     * note:    this module only uses stdio and float math, tools/discharge_sim.cpp
+     *          builds it on the host.
+     *
+     * the mean current of an interval is modeled as the sum of a current per
+     * load, weighted with the part of the interval the load was on:
+     *
+     *      current = sum( load_current[ i ] * on_time[ i ] / interval )
+     *
+     * the load currents are learned with a recursive least squares fit from
+     * the consumed charge of each interval. loads are e.g. the powermgm states,
+     * which are exclusive, and subsystems like wifi on top of them.
+     */
+    #define DISCHARGE_MODEL_MAX_LOADS   8                   /** @brief max number of loads */
+    #define DISCHARGE_MODEL_FORGET      0.998f              /** @brief forgetting factor per interval */
+    #define DISCHARGE_MODEL_MAX_VAR     2500.0f             /** @brief max variance of a load current in mA^2, limits the windup of unused loads */
+    #define DISCHARGE_MODEL_MIX_TIME    259200.0f           /** @brief time constant of the usage mix in seconds, 3 days */
+    #define DISCHARGE_MODEL_MAGIC       0x4d444344          /** @brief file magic, "DCDM" */
+
+    /**
+     * @brief model state
+     */
+    typedef struct {
+        uint8_t loads;                                      /** @brief number of loads */
+        float current[ DISCHARGE_MODEL_MAX_LOADS ];         /** @brief learned current per load in mA */
+        float p[ DISCHARGE_MODEL_MAX_LOADS ][ DISCHARGE_MODEL_MAX_LOADS ];  /** @brief covariance of the load currents */
+        float mix[ DISCHARGE_MODEL_MAX_LOADS ];             /** @brief average on time per load, 0...1 */
+        float on_time[ DISCHARGE_MODEL_MAX_LOADS ];         /** @brief on time per load in the open interval in seconds */
+        float interval;                                     /** @brief length of the open interval in seconds */
+        float error;                                        /** @brief average absolute prediction error before the update in mA */
+        float mean;                                         /** @brief average measured current in mA */
+        uint32_t updates;                                   /** @brief learned intervals */
+    } discharge_model_t;
+
+    #ifdef __cplusplus
+    extern "C" {
+    #endif
+
+    /**
+     * @brief init the model with a first guess of the load currents
+     *
+     * @param   dm          pointer to the model
+     * @param   loads       number of loads, max DISCHARGE_MODEL_MAX_LOADS
+     * @param   prior       pointer to loads currents in mA
+     */
+    void discharge_model_init( discharge_model_t *dm, uint8_t loads, const float *prior );
+    /**
+     * @brief add time to the open interval
+     *
+     * @param   dm          pointer to the model
+     * @param   load_mask   bit mask of the loads that were on, bit 0 is load 0
+     * @param   seconds     time in seconds
+     */
+    void discharge_model_account( discharge_model_t *dm, uint32_t load_mask, float seconds );
+    /**
+     * @brief close the open interval and learn from the consumed charge
+     *
+     * @param   dm          pointer to the model
+     * @param   mah         consumed charge in the interval in mAh
+     *
+     * @return  true if learned, false if the interval was empty
+     */
+    bool discharge_model_update( discharge_model_t *dm, float mah );
+    /**
+     * @brief drop the open interval, e.g. while charging
+     *
+     * @param   dm          pointer to the model
+     */
+    void discharge_model_discard( discharge_model_t *dm );
+    /**
+     * @brief get the predicted current for a set of loads
+     *
+     * @param   dm          pointer to the model
+     * @param   load_mask   bit mask of the loads that are on
+     *
+     * @return  current in mA
+     */
+    float discharge_model_get_current( discharge_model_t *dm, uint32_t load_mask );
+    /**
+     * @brief get the predicted average current with the learned usage mix
+     *
+     * @param   dm          pointer to the model
+     *
+     * @return  current in mA
+     */
+    float discharge_model_get_mean_current( discharge_model_t *dm );
+    /**
+     * @brief get the predicted runtime with the learned usage mix
+     *
+     * @param   dm          pointer to the model
+     * @param   mah         remaining charge in mAh
+     *
+     * @return  runtime in seconds, 0 if unknown
+     */
+    uint32_t discharge_model_get_runtime( discharge_model_t *dm, float mah );
+    /**
+     * @brief rank the loads by average drain, current times usage
+     *
+     * @param   dm          pointer to the model
+     * @param   order       pointer to a buffer for dm->loads load numbers, largest drain first
+     * @param   drain       pointer to a buffer for dm->loads drains in mA, can be NULL
+     */
+    void discharge_model_rank( discharge_model_t *dm, uint8_t *order, float *drain );
+    /**
+     * @brief save the model
+     *
+     * @param   dm          pointer to the model
+     * @param   filename    file name, e.g. "/spiffs/discharge.bin"
+     *
+     * @return  true if success
+     */
+    bool discharge_model_save( discharge_model_t *dm, const char *filename );
+    /**
+     * @brief load a saved model, the open interval is cleared
+     *
+     * @param   dm          pointer to the model, unchanged if failed
+     * @param   filename    file name
+     *
+     * @return  true if success, false if no matching model was saved
+     */
+    bool discharge_model_load( discharge_model_t *dm, const char *filename );
+
+    #ifdef __cplusplus
+    }
+    #endif
+
+#endif // _DISCHARGE_MODEL_H
@@ -0,0 +1,251 @@
+/****************************************************************************
+ *   Oct 18 11:02:17 2026
+ *   Copyright  2026  My-TTGO-Watch contributors
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#include "config.h"
+#include <TTGO.h>
+#include <time.h>
+
+#include "event_journal.h"
+
+#include "hardware/powermgm.h"
+#include "hardware/pmu.h"
+#include "utils/alloc.h"
+#include "utils/bench.h"
+
+static event_journal_record_t *journal = NULL;
+static uint32_t journal_head = 0;
+static uint32_t journal_tail = 0;
+static uint32_t journal_overruns = 0;
+static volatile bool journal_flush_request = false;
+static uint16_t journal_battery = 0;
+static const char *journal_names[ EVENT_JOURNAL_MAX_TABLES ];
+static uint8_t journal_tables = 0;
+static uint8_t journal_tables_written = 0;
+static char journal_filename[ 32 ] = "";
+portMUX_TYPE DRAM_ATTR journalMux = portMUX_INITIALIZER_UNLOCKED;
+
+static_assert( sizeof( event_journal_record_t ) == sizeof( event_journal_name_record_t ), "journal records must have the same size" );
+
+static int32_t journal_bench_record = -1;
+static int32_t journal_bench_flush = -1;
+
+bool event_journal_powermgm_event_cb( EventBits_t event, void *arg );
+bool event_journal_powermgm_loop_cb( EventBits_t event, void *arg );
+bool event_journal_pmu_event_cb( EventBits_t event, void *arg );
+
+void event_journal_setup( void ) {
+    /**
+     * allocate the ring buffer before the first callback table records into it,
+     * without it the journal stays disabled, record and flush do nothing
+     */
+    event_journal_record_t *ring = (event_journal_record_t *)CALLOC( sizeof( event_journal_record_t ), EVENT_JOURNAL_RECORDS );
+    if ( ring == NULL ) {
+        log_e("event journal calloc failed, journal disabled");
+        return;
+    }
+    portENTER_CRITICAL( &journalMux );
+    journal = ring;
+    portEXIT_CRITICAL( &journalMux );
+
+    journal_bench_record = bench_register( "event journal record", 50 );
+    journal_bench_flush = bench_register( "event journal flush", BENCH_NO_BUDGET );
+
+    powermgm_register_cb( POWERMGM_STANDBY | POWERMGM_SHUTDOWN | POWERMGM_RESET, event_journal_powermgm_event_cb, "powermgm event journal" );
+    /**
+     * pmu and bma events arrive in standby too, drain at high water there as well
+     */
+    powermgm_register_loop_cb( POWERMGM_STANDBY | POWERMGM_WAKEUP | POWERMGM_SILENCE_WAKEUP, event_journal_powermgm_loop_cb, "powermgm event journal loop" );
+    pmu_register_cb( PMUCTL_STATUS, event_journal_pmu_event_cb, "pmu event journal" );
+}
+
+bool event_journal_powermgm_event_cb( EventBits_t event, void *arg ) {
+    switch( event ) {
+        case POWERMGM_STANDBY:
+        case POWERMGM_SHUTDOWN:
+        case POWERMGM_RESET:
+            event_journal_flush();
+            break;
+    }
+    return( true );
+}
+
+bool event_journal_powermgm_loop_cb( EventBits_t event, void *arg ) {
+    if ( journal_flush_request ) {
+        event_journal_flush();
+    }
+    return( true );
+}
+
+bool event_journal_pmu_event_cb( EventBits_t event, void *arg ) {
+    switch( event ) {
+        case PMUCTL_STATUS:
+            journal_battery = *(int32_t*)arg;
+            break;
+    }
+    return( true );
+}
+
+/**
+ * @brief push a record into the ring buffer, call only inside journalMux
+ *
+ * @return  pointer to the record or NULL if the ring buffer is full
+ */
+static event_journal_record_t *event_journal_push( void ) {
+    if ( journal_head - journal_tail >= EVENT_JOURNAL_RECORDS ) {
+        journal_overruns++;
+        return( NULL );
+    }
+    event_journal_record_t *record = &journal[ journal_head % EVENT_JOURNAL_RECORDS ];
+    journal_head++;
+    if ( journal_head - journal_tail >= EVENT_JOURNAL_HIGH_WATER ) {
+        journal_flush_request = true;
+    }
+    return( record );
+}
+
+static void event_journal_fill_name( event_journal_name_record_t *record, uint8_t table, uint32_t timestamp, uint32_t uptime ) {
+    record->timestamp = timestamp;
+    record->uptime = uptime;
+    strncpy( record->name, journal_names[ table ], EVENT_JOURNAL_NAME_SIZE );
+    record->table = table;
+    record->type = EVENT_JOURNAL_TYPE_NAME;
+}
+
+void event_journal_record( const char *name, uint32_t event ) {
+    /**
+     * events before event_journal_setup are not recorded
+     */
+    if ( journal == NULL ) {
+        return;
+    }
+
+    uint64_t bench_start = bench_begin( journal_bench_record );
+
+    uint32_t timestamp = time( NULL );
+    uint32_t uptime = millis();
+    uint32_t heap = ESP.getFreeHeap();
+    uint32_t psram = ESP.getFreePsram();
+
+    portENTER_CRITICAL( &journalMux );
+    /**
+     * get the table id, the name record is written by event_journal_flush
+     */
+    uint8_t table = 0;
+    while( table < journal_tables && journal_names[ table ] != name ) {
+        table++;
+    }
+    if ( table == journal_tables && journal_tables < EVENT_JOURNAL_MAX_TABLES ) {
+        journal_names[ journal_tables++ ] = name;
+    }
+    /**
+     * add event record
+     */
+    event_journal_record_t *record = event_journal_push();
+    if ( record ) {
+        record->timestamp = timestamp;
+        record->uptime = uptime;
+        record->event = event;
+        record->heap = heap;
+        record->psram = psram;
+        record->battery = journal_battery;
+        record->table = table;
+        record->type = EVENT_JOURNAL_TYPE_EVENT;
+    }
+    portEXIT_CRITICAL( &journalMux );
+
+    bench_end( journal_bench_record, bench_start );
+}
+
+void event_journal_flush( void ) {
+    journal_flush_request = false;
+
+    if ( journal == NULL ) {
+        return;
+    }
+
+    portENTER_CRITICAL( &journalMux );
+    uint32_t head = journal_head;
+    uint32_t tail = journal_tail;
+    uint32_t first = tail;
+    uint8_t tables = journal_tables;
+    portEXIT_CRITICAL( &journalMux );
+
+    if ( head == tail ) {
+        return;
+    }
+
+    uint64_t bench_start = bench_begin( journal_bench_flush );
+    /**
+     * build the filename for today
+     */
+    struct tm info;
+    time_t now = time( NULL );
+    char filename[ sizeof( journal_filename ) ];
+    localtime_r( &now, &info );
+    if ( strftime( filename, sizeof( filename ), EVENT_JOURNAL_FILENAME, &info ) == 0 ) {
+        log_e("Can't convert time to filename" );
+        return;
+    }
+
+    fs::File file = SPIFFS.open( filename, FILE_APPEND );
+    if ( !file ) {
+        log_e("Can't open file: %s!", filename );
+        return;
+    }
+    /**
+     * every table name is written once per file before its first event,
+     * a new file starts with all known names
+     */
+    if ( strcmp( filename, journal_filename ) ) {
+        strlcpy( journal_filename, filename, sizeof( journal_filename ) );
+        journal_tables_written = 0;
+    }
+    for( ; journal_tables_written < tables ; journal_tables_written++ ) {
+        event_journal_name_record_t name_record;
+        event_journal_fill_name( &name_record, journal_tables_written, now, millis() );
+        file.write( (uint8_t*)&name_record, sizeof( name_record ) );
+    }
+    /**
+     * write buffered records in max two blocks
+     */
+    while( tail != head ) {
+        uint32_t start = tail % EVENT_JOURNAL_RECORDS;
+        uint32_t count = head - tail;
+        if ( start + count > EVENT_JOURNAL_RECORDS ) {
+            count = EVENT_JOURNAL_RECORDS - start;
+        }
+        if ( file.write( (uint8_t*)&journal[ start ], sizeof( event_journal_record_t ) * count ) != sizeof( event_journal_record_t ) * count ) {
+            log_e("Failed to append to event log file: %s!", filename );
+        }
+        tail += count;
+    }
+    file.close();
+
+    portENTER_CRITICAL( &journalMux );
+    journal_tail = tail;
+    portEXIT_CRITICAL( &journalMux );
+
+    log_d("event journal flushed, %d bytes, %d overruns", sizeof( event_journal_record_t ) * ( head - first ), journal_overruns );
+    bench_end( journal_bench_flush, bench_start );
+}
+
+uint32_t event_journal_get_overruns( void ) {
+    return( journal_overruns );
+}
@@ -0,0 +1,82 @@
+/****************************************************************************
+ *   Oct 18 11:02:17 2026
+ *   Copyright  2026  My-TTGO-Watch contributors
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#ifndef _EVENT_JOURNAL_H
+    #define _EVENT_JOURNAL_H
+
+    #include <stdint.h>
+
+    #define EVENT_JOURNAL_RECORDS           512                 /** @brief ring buffer size in records */
+    #define EVENT_JOURNAL_HIGH_WATER        384                 /** @brief flush when this many records are buffered */
+    #define EVENT_JOURNAL_MAX_TABLES        64                  /** @brief max number of callback tables with a journal id */
+    #define EVENT_JOURNAL_NAME_SIZE         14                  /** @brief max callback table name length in a name record */
+    #define EVENT_JOURNAL_FILENAME          "/event_log_%Y-%m-%d.bin"   /** @brief strftime format for the journal file */
+
+    #define EVENT_JOURNAL_TYPE_EVENT        0                   /** @brief record contains a callback event */
+    #define EVENT_JOURNAL_TYPE_NAME         1                   /** @brief record maps a table id to a callback table name */
+
+    /**
+     * @brief journal event record, all records have the same size
+     */
+    typedef struct __attribute__((packed)) {
+        uint32_t timestamp;                 /** @brief unix time */
+        uint32_t uptime;                    /** @brief uptime in ms */
+        uint32_t event;                     /** @brief event bits */
+        uint32_t heap;                      /** @brief free heap */
+        uint32_t psram;                     /** @brief free psram */
+        uint16_t battery;                   /** @brief last PMUCTL_STATUS word, percent and plug/charging/battery flags */
+        uint8_t table;                      /** @brief callback table id */
+        uint8_t type;                       /** @brief EVENT_JOURNAL_TYPE_EVENT */
+    } event_journal_record_t;
+
+    /**
+     * @brief journal name record, maps a table id to the callback table name
+     */
+    typedef struct __attribute__((packed)) {
+        uint32_t timestamp;                 /** @brief unix time */
+        uint32_t uptime;                    /** @brief uptime in ms */
+        char name[ EVENT_JOURNAL_NAME_SIZE ];   /** @brief callback table name, not always zero terminated */
+        uint8_t table;                      /** @brief callback table id */
+        uint8_t type;                       /** @brief EVENT_JOURNAL_TYPE_NAME */
+    } event_journal_name_record_t;
+
+    /**
+     * @brief setup event journal, register flush and battery status callbacks. call early, events before are not recorded
+     */
+    void event_journal_setup( void );
+    /**
+     * @brief record an event into the ring buffer, no flash access
+     *
+     * @param   name        callback table name, the pointer is used as key
+     * @param   event       event bits
+     */
+    void event_journal_record( const char *name, uint32_t event );
+    /**
+     * @brief write all buffered records into the journal file
+     */
+    void event_journal_flush( void );
+    /**
+     * @brief get the number of records lost because the ring buffer was full
+     *
+     * @return  number of lost records
+     */
+    uint32_t event_journal_get_overruns( void );
+
+#endif // _EVENT_JOURNAL_H
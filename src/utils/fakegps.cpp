@@ -26,14 +26,15 @@
 #include "hardware/gpsctl.h"
 #include "hardware/wifictl.h"
 #include "utils/json_psram_allocator.h"
+#include "utils/worker.h"
 
 static float lat = 0;
 static float lon = 0;
 
 EventGroupHandle_t fakegps_event_handle = NULL;
-TaskHandle_t _fakegps_get_location_Task = NULL;
 
-void fakegps_get_location_Task( void * pvParameters );
+int32_t fakegps_get_location_job( worker_job_t *job );
+void fakegps_get_location_done( worker_job_t *job );
 bool fakegps_wifictl_event_cb( EventBits_t event, void *arg );
 bool fakegps_gpsctl_event_cb( EventBits_t event, void *arg );
 void fakegps_start_task( void );
@@ -77,19 +78,14 @@ void fakegps_start_task( void ) {
     else {
         if ( gpsctl_get_gps_over_ip() && gpsctl_get_autoon() ) {
             xEventGroupSetBits( fakegps_event_handle, FAKEGPS_SYNC_REQUEST );
-            xTaskCreate(    fakegps_get_location_Task,
-                            "fakegps update Task",
-                            5000,
-                            NULL,
-                            1,
-                            &_fakegps_get_location_Task );
+            if ( worker_submit( "fakegps update", fakegps_get_location_job, fakegps_get_location_done, NULL, WORKER_PRIO_LOW ) == WORKER_NO_JOB ) {
+                xEventGroupClearBits( fakegps_event_handle, FAKEGPS_SYNC_REQUEST );
+            }
         }
     }
 }
 
-void fakegps_get_location_Task( void * pvParameters ) {
-    log_i("start fakegps task, heap: %d", ESP.getFreeHeap() );
-
+int32_t fakegps_get_location_job( worker_job_t *job ) {
     int httpcode = -1;
 
     HTTPClient fakegps_client;
@@ -107,21 +103,29 @@ void fakegps_get_location_Task( void * pvParameters ) {
         DeserializationError error = deserializeJson( doc, fakegps_client.getStream() );
         if (error) {
             log_e("fakegps deserializeJson() failed: %s", error.c_str() );
+            httpcode = -1;
         }
         else {
             if ( doc["lat"] && doc["lon"] ) {
                 lat = doc["lat"].as<float>();
                 lon = doc["lon"].as<float>();
                 log_i("lat: %f, lon:%f", lat, lon );
-                gpsctl_set_location( lat, lon, GPS_SOURCE_IP );
+            }
+            else {
+                httpcode = -1;
             }
         }
 
         doc.clear();
     }
     fakegps_client.end();
+    return( httpcode );
+}
+
+void fakegps_get_location_done( worker_job_t *job ) {
+    if ( job->result == 200 ) {
+        gpsctl_set_location( lat, lon, GPS_SOURCE_IP );
+    }
     xEventGroupClearBits( fakegps_event_handle, FAKEGPS_SYNC_REQUEST );
-    log_i("finish fakegps task, heap: %d", ESP.getFreeHeap() );
-    vTaskDelete( NULL );
 }
     
\ No newline at end of file
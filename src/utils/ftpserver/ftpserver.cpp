@@ -23,6 +23,7 @@
 #include <ESP8266FtpServer.h>
 
 #include "hardware/powermgm.h"
+#include "hardware/scheduler.h"
 
 FtpServer ftpSrv;   //set #define FTP_DEBUG in ESP8266FtpServer.h to see ftp verbose on serial
 bool ftpserver_powermgm_event_loop_cb( EventBits_t event, void *arg );
@@ -42,5 +43,6 @@ bool ftpserver_powermgm_event_loop_cb( EventBits_t event, void *arg ) {
             ftpSrv.handleFTP();
             break;
     }
+    scheduler_set_deadline( FTPSERVER_POLL_INTERVAL );
     return( true );
 }
\ No newline at end of file
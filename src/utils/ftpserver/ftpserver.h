@@ -26,6 +26,7 @@
 
     #define FTPSERVER_USER      "TTWatch"
     #define FTPSERVER_PASSWORD  "password"
+    #define FTPSERVER_POLL_INTERVAL     10      /** @brief max time in ms between two ftp server polls */
 
     /**
      *  @brief setup builtin ftpserver, call after first wifi-connection. otherwise esp32 will crash
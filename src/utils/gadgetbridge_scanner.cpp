@@ -0,0 +1,115 @@
+/****************************************************************************
+ *   Oct 18 12:31:26 2026
+ *   Copyright  2026  My-TTGO-Watch contributors
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#include "config.h"
+#include "alloc.h"
+
+#include "gadgetbridge_scanner.h"
+
+bool gadgetbridge_scanner_init( gadgetbridge_scanner_t *scanner, size_t size ) {
+    scanner->buffer = (char *)MALLOC( size );
+    if ( scanner->buffer == NULL ) {
+        log_e("gadgetbridge scanner buffer alloc failed");
+        scanner->size = 0;
+        return( false );
+    }
+    scanner->size = size;
+    gadgetbridge_scanner_reset( scanner );
+    return( true );
+}
+
+void gadgetbridge_scanner_reset( gadgetbridge_scanner_t *scanner ) {
+    scanner->len = 0;
+    scanner->close = 0;
+    scanner->overflow = false;
+}
+
+/**
+ * @brief build the frame view in place, the closing ')' or the byte behind the
+ * frame is overwritten with \0, nothing is copied
+ */
+static void gadgetbridge_scanner_frame( gadgetbridge_scanner_t *scanner, gadgetbridge_frame_t *frame ) {
+    char *data = scanner->buffer;
+    size_t len = scanner->len;
+
+    frame->gadgetbridge = false;
+    if ( len >= 3 && data[ 0 ] == 'G' && data[ 1 ] == 'B' && data[ 2 ] == '(' ) {
+        frame->gadgetbridge = true;
+        data += 3;
+        len = scanner->close > 2 ? scanner->close - 3 : len - 3;
+    }
+    data[ len ] = '\0';
+
+    frame->event = GADGETBRIDGE_SCANNER_FRAME;
+    frame->data = data;
+    frame->len = len;
+}
+
+size_t gadgetbridge_scanner_feed( gadgetbridge_scanner_t *scanner, const char *data, size_t len, gadgetbridge_frame_t *frame ) {
+    frame->event = GADGETBRIDGE_SCANNER_NONE;
+    frame->data = NULL;
+    frame->len = 0;
+    frame->gadgetbridge = false;
+
+    if ( scanner->buffer == NULL ) {
+        return( len );
+    }
+    /*
+     * one pass over the bytes, stop at the first control byte
+     */
+    for ( size_t i = 0 ; i < len ; i++ ) {
+        char c = data[ i ];
+        switch( c ) {
+            case GADGETBRIDGE_ETX:
+                gadgetbridge_scanner_reset( scanner );
+                frame->event = GADGETBRIDGE_SCANNER_LINK;
+                return( i + 1 );
+            case GADGETBRIDGE_DLE:
+                gadgetbridge_scanner_reset( scanner );
+                frame->event = GADGETBRIDGE_SCANNER_NEW_FRAME;
+                return( i + 1 );
+            case GADGETBRIDGE_LF:
+                if ( scanner->overflow ) {
+                    frame->event = GADGETBRIDGE_SCANNER_OVERFLOW;
+                    frame->len = scanner->len;
+                }
+                else {
+                    gadgetbridge_scanner_frame( scanner, frame );
+                }
+                gadgetbridge_scanner_reset( scanner );
+                return( i + 1 );
+            default:
+                /*
+                 * keep one byte for the \0, drop the frame if too long
+                 */
+                if ( scanner->len >= scanner->size - 1 ) {
+                    scanner->overflow = true;
+                    scanner->len++;
+                    break;
+                }
+                if ( c == ')' ) {
+                    scanner->close = scanner->len;
+                }
+                scanner->buffer[ scanner->len++ ] = c;
+                break;
+        }
+    }
+    return( len );
+}
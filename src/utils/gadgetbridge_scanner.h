@@ -0,0 +1,93 @@
+/****************************************************************************
+ *   Oct 18 12:31:26 2026
+ *   Copyright  2026  My-TTGO-Watch contributors
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#ifndef _GADGETBRIDGE_SCANNER_H
+    #define _GADGETBRIDGE_SCANNER_H
+
+    #include <stdint.h>
+    #include <stddef.h>
+
+    #define GADGETBRIDGE_SCANNER_SIZE       8192        /** @brief default receive buffer size in bytes, the max frame length is one byte less */
+
+    #define GADGETBRIDGE_ETX                0x03        /** @brief EndofText, new link established */
+    #define GADGETBRIDGE_DLE                0x10        /** @brief DataLinkEscape, start of a new frame */
+    #define GADGETBRIDGE_LF                 0x0a        /** @brief LineFeed, end of a frame */
+
+    /**
+     * @brief scanner events
+     */
+    typedef enum {
+        GADGETBRIDGE_SCANNER_NONE = 0,                  /** @brief all bytes consumed, no event */
+        GADGETBRIDGE_SCANNER_LINK,                      /** @brief EndofText received, new link established */
+        GADGETBRIDGE_SCANNER_NEW_FRAME,                 /** @brief DataLinkEscape received, new frame start */
+        GADGETBRIDGE_SCANNER_FRAME,                     /** @brief LineFeed received, frame complete */
+        GADGETBRIDGE_SCANNER_OVERFLOW                   /** @brief LineFeed received, frame was too long and dropped */
+    } gadgetbridge_scanner_event_t;
+
+    /**
+     * @brief view of a complete frame inside the scanner buffer, valid until the next feed call
+     */
+    typedef struct {
+        gadgetbridge_scanner_event_t event;             /** @brief scanner event */
+        const char *data;                               /** @brief frame payload, zero terminated, GB( and ) are cut off */
+        size_t len;                                     /** @brief payload length without \0 */
+        bool gadgetbridge;                              /** @brief true if the frame was a GB(...) frame */
+    } gadgetbridge_frame_t;
+
+    /**
+     * @brief scanner state
+     */
+    typedef struct {
+        char *buffer;                                   /** @brief fixed receive buffer */
+        size_t size;                                    /** @brief receive buffer size */
+        size_t len;                                     /** @brief bytes of the current frame */
+        size_t close;                                   /** @brief position of the last ')' in the current frame */
+        bool overflow;                                  /** @brief current frame is too long and is dropped */
+    } gadgetbridge_scanner_t;
+
+    /**
+     * @brief allocate the receive buffer once
+     *
+     * @param   scanner     pointer to the scanner
+     * @param   size        receive buffer size in bytes
+     *
+     * @return  true if success, false if failed
+     */
+    bool gadgetbridge_scanner_init( gadgetbridge_scanner_t *scanner, size_t size );
+    /**
+     * @brief drop the current frame
+     *
+     * @param   scanner     pointer to the scanner
+     */
+    void gadgetbridge_scanner_reset( gadgetbridge_scanner_t *scanner );
+    /**
+     * @brief scan received bytes until the next event, call it again with the
+     * remaining bytes until all bytes are consumed
+     *
+     * @param   scanner     pointer to the scanner
+     * @param   data        received bytes
+     * @param   len         number of received bytes
+     * @param   frame       pointer to the frame view, event is GADGETBRIDGE_SCANNER_NONE if no event occurred
+     *
+     * @return  number of consumed bytes
+     */
+    size_t gadgetbridge_scanner_feed( gadgetbridge_scanner_t *scanner, const char *data, size_t len, gadgetbridge_frame_t *frame );
+
+#endif // _GADGETBRIDGE_SCANNER_H
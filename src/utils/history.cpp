@@ -0,0 +1,185 @@
+/****************************************************************************
+ *   Oct 18 18:31:27 2026
+ *   Copyright  2026  My-TTGO-Watch contributors
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#include "config.h"
+#include <TTGO.h>
+#include <time.h>
+
+#include "history.h"
+
+#include "hardware/powermgm.h"
+#include "hardware/pmu.h"
+#include "hardware/bma.h"
+#include "utils/bench.h"
+
+static timeseries_t history_series[ HISTORY_NUM ];
+static bool history_open[ HISTORY_NUM ];
+static const char *history_names[ HISTORY_NUM ] = { "steps", "activity", "battery" };
+static const char *history_paths[ HISTORY_NUM ] = { "/spiffs/ts_steps", "/spiffs/ts_activity", "/spiffs/ts_battery" };
+static const uint8_t history_aggregate[ HISTORY_NUM ] = { TIMESERIES_SUM, TIMESERIES_SUM, TIMESERIES_MEAN };
+
+static uint64_t history_next_sample = 0;
+static bool history_first_sample = true;
+static uint32_t history_last_steps = 0;
+static uint32_t history_last_active = 0;
+static int32_t history_battery = -1;
+static int32_t history_bench_sample = -1;
+static int32_t history_bench_query = -1;
+
+bool history_powermgm_event_cb( EventBits_t event, void *arg );
+bool history_powermgm_loop_cb( EventBits_t event, void *arg );
+bool history_pmu_event_cb( EventBits_t event, void *arg );
+static void history_sample( void );
+
+void history_setup( void ) {
+    history_bench_sample = bench_register( "history sample", BENCH_NO_BUDGET );
+    history_bench_query = bench_register( "history query", BENCH_NO_BUDGET );
+
+    for( int i = 0 ; i < HISTORY_NUM ; i++ ) {
+        history_open[ i ] = timeseries_open( &history_series[ i ], history_paths[ i ], history_aggregate[ i ] );
+        if ( !history_open[ i ] ) {
+            log_e("open history %s failed", history_names[ i ] );
+        }
+    }
+
+    powermgm_register_cb( POWERMGM_SHUTDOWN | POWERMGM_RESET, history_powermgm_event_cb, "powermgm history" );
+    powermgm_register_loop_cb( POWERMGM_STANDBY | POWERMGM_SILENCE_WAKEUP | POWERMGM_WAKEUP, history_powermgm_loop_cb, "powermgm history loop" );
+    pmu_register_cb( PMUCTL_STATUS, history_pmu_event_cb, "pmu history" );
+}
+
+bool history_powermgm_event_cb( EventBits_t event, void *arg ) {
+    switch( event ) {
+        case POWERMGM_SHUTDOWN:
+        case POWERMGM_RESET:
+            history_flush();
+            break;
+    }
+    return( true );
+}
+
+bool history_powermgm_loop_cb( EventBits_t event, void *arg ) {
+    /*
+     * the loop runs only on wakeups in light sleep, a sample covers the
+     * time since the last sample
+     */
+    if ( history_next_sample < millis() ) {
+        history_next_sample = millis() + HISTORY_SAMPLE_INTERVAL * 1000L;
+        history_sample();
+    }
+    return( true );
+}
+
+bool history_pmu_event_cb( EventBits_t event, void *arg ) {
+    switch( event ) {
+        case PMUCTL_STATUS:
+            history_battery = *(int32_t*)arg & PMUCTL_STATUS_PERCENT;
+            break;
+    }
+    return( true );
+}
+
+uint32_t history_get_local_time( void ) {
+    time_t now;
+    struct tm info;
+
+    time( &now );
+    if ( now < HISTORY_VALID_TIME ) {
+        return( 0 );
+    }
+    localtime_r( &now, &info );
+    /*
+     * local offset from the difference of the seconds of the day
+     */
+    int32_t offset = ( info.tm_hour * 3600 + info.tm_min * 60 + info.tm_sec ) - (int32_t)( now % 86400 );
+    if ( offset < -12 * 3600 ) {
+        offset += 86400;
+    }
+    else if ( offset > 14 * 3600 ) {
+        offset -= 86400;
+    }
+    return( now + offset );
+}
+
+/**
+ * @brief add the increments of steps and active seconds and the battery percent
+ */
+static void history_sample( void ) {
+    uint32_t now = history_get_local_time();
+    if ( !now ) {
+        return;
+    }
+    const activity_classifier_t *ac = bma_get_activity_classifier();
+    uint32_t steps = bma_get_stepcounter();
+    uint32_t active = ac->seconds[ ACTIVITY_WALK ] + ac->seconds[ ACTIVITY_RUN ] + ac->seconds[ ACTIVITY_CYCLE ];
+
+    uint64_t bench_start = bench_begin( history_bench_sample );
+    if ( history_first_sample ) {
+        history_first_sample = false;
+        history_last_steps = steps;
+        history_last_active = active;
+    }
+    /*
+     * a smaller step count means a stepcounter reset
+     */
+    if ( history_open[ HISTORY_STEPS ] ) {
+        timeseries_add( &history_series[ HISTORY_STEPS ], now, steps >= history_last_steps ? steps - history_last_steps : steps );
+    }
+    if ( history_open[ HISTORY_ACTIVITY ] ) {
+        timeseries_add( &history_series[ HISTORY_ACTIVITY ], now, active - history_last_active );
+    }
+    if ( history_open[ HISTORY_BATTERY ] && history_battery >= 0 ) {
+        timeseries_add( &history_series[ HISTORY_BATTERY ], now, history_battery );
+    }
+    history_last_steps = steps;
+    history_last_active = active;
+    bench_end( history_bench_sample, bench_start );
+}
+
+int32_t history_query( int series, int tier, uint32_t from, uint32_t to, timeseries_point_t *points, int32_t max_points ) {
+    if ( series < 0 || series >= HISTORY_NUM || !history_open[ series ] ) {
+        return( 0 );
+    }
+    uint64_t bench_start = bench_begin( history_bench_query );
+    int32_t count = timeseries_query( &history_series[ series ], tier, from, to, points, max_points );
+    bench_end( history_bench_query, bench_start );
+    return( count );
+}
+
+void history_flush( void ) {
+    for( int i = 0 ; i < HISTORY_NUM ; i++ ) {
+        if ( history_open[ i ] ) {
+            timeseries_flush( &history_series[ i ] );
+        }
+    }
+}
+
+const char *history_get_name( int series ) {
+    if ( series < 0 || series >= HISTORY_NUM ) {
+        return( NULL );
+    }
+    return( history_names[ series ] );
+}
+
+const timeseries_stats_t *history_get_stats( int series ) {
+    if ( series < 0 || series >= HISTORY_NUM ) {
+        return( NULL );
+    }
+    return( &history_series[ series ].stats );
+}
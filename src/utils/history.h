@@ -0,0 +1,81 @@
+/****************************************************************************
+ *   Oct 18 18:31:27 2026
+ *   Copyright  2026  My-TTGO-Watch contributors
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#ifndef _HISTORY_H
+    #define _HISTORY_H
+
+    #include "utils/timeseries.h"
+
+    #define HISTORY_SAMPLE_INTERVAL     60                  /** @brief sample interval in seconds */
+    #define HISTORY_VALID_TIME          1577836800          /** @brief 2020-01-01, older times are not synced */
+
+    enum {
+        HISTORY_STEPS = 0,                                  /** @brief steps per bucket */
+        HISTORY_ACTIVITY,                                   /** @brief walk, run and cycle seconds per bucket */
+        HISTORY_BATTERY,                                    /** @brief mean battery percent per bucket */
+        HISTORY_NUM
+    };
+
+    /**
+     * @brief setup the step, activity and battery history, call after bma and pmu setup
+     */
+    void history_setup( void );
+    /**
+     * @brief get the closed buckets of a series in a time range
+     *
+     * @param   series      HISTORY_STEPS, HISTORY_ACTIVITY or HISTORY_BATTERY
+     * @param   tier        TIMESERIES_MINUTE, TIMESERIES_HOUR or TIMESERIES_DAY
+     * @param   from        range start in local time seconds
+     * @param   to          range end in local time seconds, inclusive
+     * @param   points      pointer to a buffer for max_points points
+     * @param   max_points  max number of points
+     *
+     * @return  number of points
+     */
+    int32_t history_query( int series, int tier, uint32_t from, uint32_t to, timeseries_point_t *points, int32_t max_points );
+    /**
+     * @brief get the current local time, the history buckets use local time
+     * so a day bucket starts at local midnight
+     *
+     * @return  local time in seconds or 0 if the time is not synced
+     */
+    uint32_t history_get_local_time( void );
+    /**
+     * @brief write all pending history bytes
+     */
+    void history_flush( void );
+    /**
+     * @brief get the name of a series
+     *
+     * @param   series      HISTORY_STEPS, HISTORY_ACTIVITY or HISTORY_BATTERY
+     *
+     * @return  pointer to the name or NULL if failed
+     */
+    const char *history_get_name( int series );
+    /**
+     * @brief get the statistic of a series since boot
+     *
+     * @param   series      HISTORY_STEPS, HISTORY_ACTIVITY or HISTORY_BATTERY
+     *
+     * @return  pointer to the statistic or NULL if failed
+     */
+    const timeseries_stats_t *history_get_stats( int series );
+
+#endif // _HISTORY_H
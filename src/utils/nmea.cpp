@@ -0,0 +1,385 @@
+/****************************************************************************
+ *   Oct 18 21:02:47 2026
+ *   Copyright  2026  My-TTGO-Watch contributors
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#include <string.h>
+
+#include "nmea.h"
+
+void nmea_init( nmea_parser_t *p ) {
+    memset( p, 0, sizeof( nmea_parser_t ) );
+    p->fix.time_ms = NMEA_NO_TIME;
+}
+
+static int nmea_hex( char c ) {
+    if ( c >= '0' && c <= '9' ) {
+        return( c - '0' );
+    }
+    if ( c >= 'A' && c <= 'F' ) {
+        return( c - 'A' + 10 );
+    }
+    if ( c >= 'a' && c <= 'f' ) {
+        return( c - 'a' + 10 );
+    }
+    return( -1 );
+}
+
+/**
+ * @brief parse a decimal number into fixed point, extra decimals are cut off
+ *
+ * @return  false if the field is empty or not a number
+ */
+static bool nmea_parse_fixed( const char *s, int decimals, int64_t *value ) {
+    int64_t result = 0;
+    bool negative = false;
+    bool digits = false;
+    int fraction = -1;
+
+    if ( *s == '-' ) {
+        negative = true;
+        s++;
+    }
+    for( ; *s ; s++ ) {
+        if ( *s == '.' && fraction < 0 ) {
+            fraction = 0;
+            continue;
+        }
+        if ( *s < '0' || *s > '9' ) {
+            return( false );
+        }
+        digits = true;
+        if ( fraction >= 0 ) {
+            if ( fraction == decimals ) {
+                continue;
+            }
+            fraction++;
+        }
+        result = result * 10 + ( *s - '0' );
+    }
+    if ( !digits ) {
+        return( false );
+    }
+    for( fraction = fraction < 0 ? 0 : fraction ; fraction < decimals ; fraction++ ) {
+        result *= 10;
+    }
+    *value = negative ? -result : result;
+    return( true );
+}
+
+/**
+ * @brief parse ddmm.mmmmm or dddmm.mmmmm with hemisphere into 1e-7 degree
+ */
+static bool nmea_parse_coordinate( const char *s, const char *hemisphere, int32_t *value ) {
+    int64_t raw;
+
+    if ( !nmea_parse_fixed( s, 5, &raw ) || raw < 0 ) {
+        return( false );
+    }
+    int64_t degree = raw / 10000000;
+    int64_t minutes = raw % 10000000;
+    if ( minutes >= 6000000 ) {
+        return( false );
+    }
+    /*
+     * minutes in 1e-5 to degree in 1e-7: * 100 / 60
+     */
+    int64_t result = degree * 10000000 + ( minutes * 10 + 3 ) / 6;
+    if ( *hemisphere == 'S' || *hemisphere == 'W' ) {
+        result = -result;
+    }
+    else if ( *hemisphere != 'N' && *hemisphere != 'E' ) {
+        return( false );
+    }
+    *value = (int32_t)result;
+    return( true );
+}
+
+/**
+ * @brief parse hhmmss.sss into ms of the day
+ */
+static bool nmea_parse_time( const char *s, uint32_t *time_ms ) {
+    int64_t raw;
+
+    if ( strlen( s ) < 6 || !nmea_parse_fixed( s, 3, &raw ) || raw < 0 ) {
+        return( false );
+    }
+    uint32_t hours = raw / 10000000;
+    uint32_t minutes = raw / 100000 % 100;
+    uint32_t ms = raw % 100000;
+    if ( hours > 23 || minutes > 59 || ms > 60999 ) {
+        return( false );
+    }
+    *time_ms = ( hours * 60 + minutes ) * 60000 + ms;
+    return( true );
+}
+
+/**
+ * @brief set the valid flag of a field and mark it updated if the value
+ * or the validity changed
+ */
+static void nmea_mark( nmea_fix_t *fix, uint32_t flag, bool valid, bool changed ) {
+    if ( valid != ( ( fix->valid & flag ) != 0 ) ) {
+        changed = true;
+    }
+    if ( valid ) {
+        fix->valid |= flag;
+    }
+    else {
+        fix->valid &= ~flag;
+    }
+    if ( changed ) {
+        fix->updated |= flag;
+    }
+}
+
+static void nmea_set_location( nmea_fix_t *fix, bool valid, int32_t lat, int32_t lon ) {
+    bool changed = false;
+
+    if ( valid ) {
+        changed = lat != fix->lat || lon != fix->lon;
+        fix->lat = lat;
+        fix->lon = lon;
+    }
+    nmea_mark( fix, NMEA_LOCATION, valid, changed );
+}
+
+static void nmea_decode_rmc( nmea_fix_t *fix, char **field, int fields ) {
+    int32_t lat, lon;
+    int64_t value;
+
+    if ( fields < 10 ) {
+        return;
+    }
+    bool active = field[ 2 ][ 0 ] == 'A';
+    bool location = active && nmea_parse_coordinate( field[ 3 ], field[ 4 ], &lat ) && nmea_parse_coordinate( field[ 5 ], field[ 6 ], &lon );
+    nmea_set_location( fix, location, lat, lon );
+
+    bool speed = active && nmea_parse_fixed( field[ 7 ], 3, &value ) && value >= 0;
+    if ( speed ) {
+        /*
+         * knots in 1e-3 to mm/s
+         */
+        uint32_t speed_mmps = value * 1852 / 3600;
+        nmea_mark( fix, NMEA_SPEED, true, speed_mmps != fix->speed_mmps );
+        fix->speed_mmps = speed_mmps;
+    }
+    else {
+        nmea_mark( fix, NMEA_SPEED, false, false );
+    }
+
+    bool course = active && nmea_parse_fixed( field[ 8 ], 2, &value ) && value >= 0 && value < 36000;
+    if ( course ) {
+        nmea_mark( fix, NMEA_COURSE, true, value != fix->course_cdeg );
+        fix->course_cdeg = value;
+    }
+    else {
+        nmea_mark( fix, NMEA_COURSE, false, false );
+    }
+
+    const char *date = field[ 9 ];
+    if ( strlen( date ) == 6 && nmea_parse_fixed( date, 0, &value ) ) {
+        uint8_t day = value / 10000;
+        uint8_t month = value / 100 % 100;
+        uint16_t year = 2000 + value % 100;
+        if ( day >= 1 && day <= 31 && month >= 1 && month <= 12 ) {
+            nmea_mark( fix, NMEA_DATE, true, day != fix->day || month != fix->month || year != fix->year );
+            fix->day = day;
+            fix->month = month;
+            fix->year = year;
+        }
+    }
+}
+
+static void nmea_decode_gga( nmea_fix_t *fix, char **field, int fields ) {
+    int32_t lat, lon;
+    int64_t value;
+
+    if ( fields < 11 ) {
+        return;
+    }
+    fix->quality = nmea_parse_fixed( field[ 6 ], 0, &value ) ? value : 0;
+    bool active = fix->quality > 0;
+    bool location = active && nmea_parse_coordinate( field[ 2 ], field[ 3 ], &lat ) && nmea_parse_coordinate( field[ 4 ], field[ 5 ], &lon );
+    nmea_set_location( fix, location, lat, lon );
+
+    if ( nmea_parse_fixed( field[ 7 ], 0, &value ) && value >= 0 && value < 256 ) {
+        nmea_mark( fix, NMEA_SATELLITES, true, value != fix->satellites );
+        fix->satellites = value;
+    }
+    else {
+        nmea_mark( fix, NMEA_SATELLITES, false, false );
+    }
+
+    if ( active && nmea_parse_fixed( field[ 8 ], 2, &value ) && value >= 0 && value < 65536 ) {
+        nmea_mark( fix, NMEA_HDOP, true, value != fix->hdop );
+        fix->hdop = value;
+    }
+    else {
+        nmea_mark( fix, NMEA_HDOP, false, false );
+    }
+
+    if ( active && nmea_parse_fixed( field[ 9 ], 2, &value ) ) {
+        nmea_mark( fix, NMEA_ALTITUDE, true, value != fix->altitude_cm );
+        fix->altitude_cm = value;
+    }
+    else {
+        nmea_mark( fix, NMEA_ALTITUDE, false, false );
+    }
+}
+
+/**
+ * @brief close the open epoch
+ */
+static bool nmea_complete( nmea_parser_t *p, nmea_fix_t *fix ) {
+    if ( !p->fix.updated ) {
+        return( false );
+    }
+    *fix = p->fix;
+    p->fix.updated = 0;
+    p->stats.epochs++;
+    return( true );
+}
+
+/**
+ * @brief check and decode the sentence in the line buffer
+ *
+ * @return  true if the sentence started a new epoch and the last one was completed
+ */
+static bool nmea_sentence( nmea_parser_t *p, nmea_fix_t *fix ) {
+    char *field[ NMEA_MAX_FIELDS ];
+    int fields = 0;
+    uint8_t checksum = 0;
+    char *star = NULL;
+    bool completed = false;
+
+    p->line[ p->len ] = '\0';
+    for( char *c = p->line + 1 ; *c ; c++ ) {
+        if ( *c == '*' ) {
+            star = c;
+            break;
+        }
+        checksum ^= *c;
+    }
+    if ( !star || nmea_hex( star[ 1 ] ) < 0 || nmea_hex( star[ 2 ] ) < 0 || ( ( nmea_hex( star[ 1 ] ) << 4 ) | nmea_hex( star[ 2 ] ) ) != checksum ) {
+        p->stats.checksum_errors++;
+        return( false );
+    }
+    p->stats.sentences++;
+    *star = '\0';
+    /*
+     * split into fields, field 0 is the talker and sentence id
+     */
+    field[ fields++ ] = p->line + 1;
+    for( char *c = p->line + 1 ; *c && fields < NMEA_MAX_FIELDS ; c++ ) {
+        if ( *c == ',' ) {
+            *c = '\0';
+            field[ fields++ ] = c + 1;
+        }
+    }
+    if ( strlen( field[ 0 ] ) != 5 || fields < 2 ) {
+        return( false );
+    }
+    const char *type = field[ 0 ] + 2;
+    bool rmc = !strcmp( type, "RMC" );
+    bool gga = !strcmp( type, "GGA" );
+    if ( !rmc && !gga ) {
+        return( false );
+    }
+    /*
+     * a new time starts the next epoch
+     */
+    uint32_t time_ms;
+    if ( nmea_parse_time( field[ 1 ], &time_ms ) ) {
+        if ( time_ms != p->fix.time_ms ) {
+            completed = nmea_complete( p, fix );
+        }
+        nmea_mark( &p->fix, NMEA_TIME, true, time_ms != p->fix.time_ms );
+        p->fix.time_ms = time_ms;
+    }
+    if ( rmc ) {
+        nmea_decode_rmc( &p->fix, field, fields );
+    }
+    else {
+        nmea_decode_gga( &p->fix, field, fields );
+    }
+    p->stats.decoded++;
+    return( completed );
+}
+
+bool nmea_parse( nmea_parser_t *p, const char **data, size_t *len, nmea_fix_t *fix ) {
+    while( *len ) {
+        char c = **data;
+        ( *data )++;
+        ( *len )--;
+        p->stats.bytes++;
+
+        if ( c == '$' ) {
+            p->in_sentence = true;
+            p->overrun = false;
+            p->len = 0;
+        }
+        else if ( !p->in_sentence ) {
+            continue;
+        }
+        else if ( c == '\r' || c == '\n' ) {
+            p->in_sentence = false;
+            if ( p->overrun ) {
+                p->stats.overruns++;
+                continue;
+            }
+            if ( nmea_sentence( p, fix ) ) {
+                return( true );
+            }
+            continue;
+        }
+        if ( p->len >= NMEA_LINE_SIZE ) {
+            p->overrun = true;
+            continue;
+        }
+        p->line[ p->len++ ] = c;
+    }
+    return( false );
+}
+
+bool nmea_flush( nmea_parser_t *p, nmea_fix_t *fix ) {
+    return( nmea_complete( p, fix ) );
+}
+
+bool nmea_pending( const nmea_parser_t *p ) {
+    return( p->fix.updated != 0 );
+}
+
+/**
+ * @brief days since 1970-01-01 of a gregorian date
+ */
+static int32_t nmea_days_from_civil( int32_t year, uint32_t month, uint32_t day ) {
+    year -= month <= 2;
+    int32_t era = ( year >= 0 ? year : year - 399 ) / 400;
+    uint32_t yoe = (uint32_t)( year - era * 400 );
+    uint32_t doy = ( 153 * ( month > 2 ? month - 3 : month + 9 ) + 2 ) / 5 + day - 1;
+    uint32_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return( era * 146097 + (int32_t)doe - 719468 );
+}
+
+uint32_t nmea_get_unix_time( const nmea_fix_t *fix ) {
+    if ( !( fix->valid & NMEA_TIME ) || !( fix->valid & NMEA_DATE ) ) {
+        return( 0 );
+    }
+    return( nmea_days_from_civil( fix->year, fix->month, fix->day ) * 86400 + fix->time_ms / 1000 );
+}
@@ -0,0 +1,148 @@
+/****************************************************************************
+ *   Oct 18 21:02:47 2026
+ *   Copyright  2026  My-TTGO-Watch contributors
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#ifndef _NMEA_H
+    #define _NMEA_H
+
+    #include <stdint.h>
+    #include <stdbool.h>
+    #include <stddef.h>
+
+    /*
+     * note:    this module is plain integer C without arduino dependencies,
+     *          tools/gps_bench.cpp builds it on the host.
+     *
+     * streaming NMEA 0183 parser. bytes are fed as they come from the uart,
+     * RMC and GGA sentences of any talker are decoded into one fix. all
+     * sentences a receiver sends for one position form an epoch, the epoch
+     * is complete when a sentence with a new time arrives or the receiver
+     * goes quiet, see nmea_flush().
+     */
+    #define NMEA_LINE_SIZE              83                  /** @brief max sentence length with $ and without CR LF */
+    #define NMEA_MAX_FIELDS             24                  /** @brief max fields per sentence */
+    #define NMEA_NO_TIME                0xffffffff          /** @brief time_ms before the first timed sentence */
+    /**
+     * @brief fix field flags for valid and updated
+     */
+    #define NMEA_LOCATION               ( 1 << 0 )          /** @brief lat and lon */
+    #define NMEA_ALTITUDE               ( 1 << 1 )          /** @brief altitude */
+    #define NMEA_SPEED                  ( 1 << 2 )          /** @brief speed over ground */
+    #define NMEA_COURSE                 ( 1 << 3 )          /** @brief course over ground */
+    #define NMEA_SATELLITES             ( 1 << 4 )          /** @brief satellites in use */
+    #define NMEA_HDOP                   ( 1 << 5 )          /** @brief horizontal dilution of precision */
+    #define NMEA_TIME                   ( 1 << 6 )          /** @brief utc time of day */
+    #define NMEA_DATE                   ( 1 << 7 )          /** @brief utc date */
+
+    /**
+     * @brief one fix, all values in fixed point
+     */
+    typedef struct {
+        uint32_t valid;                     /** @brief NMEA_* flags of the valid fields */
+        uint32_t updated;                   /** @brief NMEA_* flags of the fields changed in this epoch */
+        int32_t lat;                        /** @brief latitude in 1e-7 degree */
+        int32_t lon;                        /** @brief longitude in 1e-7 degree */
+        int32_t altitude_cm;                /** @brief altitude above mean sea level in cm */
+        uint32_t speed_mmps;                /** @brief speed over ground in mm/s */
+        uint16_t course_cdeg;               /** @brief course over ground in 1/100 degree */
+        uint16_t hdop;                      /** @brief hdop in 1/100 */
+        uint8_t satellites;                 /** @brief satellites in use */
+        uint8_t quality;                    /** @brief GGA fix quality, 0 = no fix */
+        uint16_t year;                      /** @brief utc date, e.g. 2026 */
+        uint8_t month;                      /** @brief 1...12 */
+        uint8_t day;                        /** @brief 1...31 */
+        uint32_t time_ms;                   /** @brief utc time of day in ms, NMEA_NO_TIME if unknown */
+    } nmea_fix_t;
+
+    /**
+     * @brief parser statistic
+     */
+    typedef struct {
+        uint32_t bytes;                     /** @brief bytes fed */
+        uint32_t sentences;                 /** @brief sentences with a valid checksum */
+        uint32_t decoded;                   /** @brief sentences decoded into the fix */
+        uint32_t checksum_errors;           /** @brief sentences with a wrong or missing checksum */
+        uint32_t overruns;                  /** @brief sentences longer than NMEA_LINE_SIZE */
+        uint32_t epochs;                    /** @brief completed epochs */
+    } nmea_stats_t;
+
+    /**
+     * @brief parser state
+     */
+    typedef struct {
+        char line[ NMEA_LINE_SIZE + 1 ];    /** @brief sentence being received */
+        uint8_t len;                        /** @brief bytes in line */
+        bool in_sentence;                   /** @brief true between $ and the line end */
+        bool overrun;                       /** @brief true if the sentence got too long */
+        nmea_fix_t fix;                     /** @brief fix of the open epoch */
+        nmea_stats_t stats;
+    } nmea_parser_t;
+
+    #ifdef __cplusplus
+    extern "C" {
+    #endif
+
+    /**
+     * @brief init a parser
+     *
+     * @param   p           pointer to the parser
+     */
+    void nmea_init( nmea_parser_t *p );
+    /**
+     * @brief feed received bytes, stops after the sentence that completed an epoch
+     *
+     * @param   p           pointer to the parser
+     * @param   data        pointer to a data pointer, advanced by the consumed bytes
+     * @param   len         pointer to the data length, reduced by the consumed bytes
+     * @param   fix         pointer to a fix, set if true is returned
+     *
+     * @return  true if an epoch was completed, call again with the remaining bytes
+     */
+    bool nmea_parse( nmea_parser_t *p, const char **data, size_t *len, nmea_fix_t *fix );
+    /**
+     * @brief complete the open epoch, call when the receiver is quiet after a burst
+     *
+     * @param   p           pointer to the parser
+     * @param   fix         pointer to a fix, set if true is returned
+     *
+     * @return  true if the epoch had updates
+     */
+    bool nmea_flush( nmea_parser_t *p, nmea_fix_t *fix );
+    /**
+     * @brief check if the open epoch has updates
+     *
+     * @param   p           pointer to the parser
+     *
+     * @return  true if nmea_flush() would complete an epoch
+     */
+    bool nmea_pending( const nmea_parser_t *p );
+    /**
+     * @brief get the utc unix time of a fix
+     *
+     * @param   fix         pointer to a fix
+     *
+     * @return  seconds since 1970 or 0 if time or date are invalid
+     */
+    uint32_t nmea_get_unix_time( const nmea_fix_t *fix );
+
+    #ifdef __cplusplus
+    }
+    #endif
+
+#endif // _NMEA_H
@@ -0,0 +1,243 @@
+/****************************************************************************
+ *   Oct 18 11:48:03 2026
+ *   Copyright  2026  My-TTGO-Watch contributors
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#include "config.h"
+#include "alloc.h"
+
+#include "notification_store.h"
+#include "bench.h"
+
+static const char *notification_store_default_src = "Message";
+static int32_t notification_store_bench_add = -1;
+
+notification_store_t *notification_store_create( void ) {
+    notification_store_t *store = (notification_store_t *)CALLOC( sizeof( notification_store_t ), 1 );
+    if ( store == NULL ) {
+        log_e("notification_store_t alloc failed");
+        return( NULL );
+    }
+    /*
+     * allocate slab and intern arena once
+     */
+    store->slab = (notification_t *)CALLOC( sizeof( notification_t ), NOTIFICATION_STORE_ENTRYS );
+    store->intern = (char *)CALLOC( NOTIFICATION_STORE_INTERN_SIZE, 1 );
+    if ( store->slab == NULL || store->intern == NULL ) {
+        log_e("notification store slab alloc failed");
+        free( store->slab );
+        free( store->intern );
+        free( store );
+        return( NULL );
+    }
+    store->first = 0;
+    store->entrys = 0;
+    store->intern_used = 0;
+    /*
+     * all slots are free, ring position i use slot i
+     */
+    for ( int32_t i = 0 ; i < NOTIFICATION_STORE_ENTRYS ; i++ ) {
+        store->order[ i ] = i;
+    }
+    notification_store_bench_add = bench_register( "notification store add", 100 );
+    log_i("notification store alloc success ( %d bytes )", sizeof( notification_t ) * NOTIFICATION_STORE_ENTRYS + NOTIFICATION_STORE_INTERN_SIZE );
+    return( store );
+}
+
+static inline notification_t *notification_store_slot( notification_store_t *store, int32_t entry ) {
+    return( &store->slab[ store->order[ ( store->first + entry ) % NOTIFICATION_STORE_ENTRYS ] ] );
+}
+
+/**
+ * @brief copy a string, a too long string is cut on an utf-8 character
+ * boundary and ends with NOTIFICATION_TRUNCATED_MARK
+ *
+ * @return  true if the string was cut
+ */
+static bool notification_store_copy( char *dst, size_t size, const char *src ) {
+    size_t len = src ? strlen( src ) : 0;
+
+    if ( len < size ) {
+        memcpy( dst, src ? src : "", len + 1 );
+        return( false );
+    }
+    /*
+     * step back over utf-8 continuation bytes, a lead byte is never kept without them
+     */
+    size_t cut = size - sizeof( NOTIFICATION_TRUNCATED_MARK );
+    while( cut > 0 && ( src[ cut ] & 0xc0 ) == 0x80 ) {
+        cut--;
+    }
+    memcpy( dst, src, cut );
+    memcpy( &dst[ cut ], NOTIFICATION_TRUNCATED_MARK, sizeof( NOTIFICATION_TRUNCATED_MARK ) );
+    return( true );
+}
+
+/**
+ * @brief remove interned strings no stored notification points to, the
+ * remaining strings move to the front and the src pointers are updated
+ */
+static void notification_store_intern_compact( notification_store_t *store ) {
+    size_t pos = 0;
+    size_t used = 0;
+
+    while( pos < store->intern_used ) {
+        char *interned = &store->intern[ pos ];
+        size_t len = strlen( interned ) + 1;
+        bool referenced = false;
+
+        for ( int32_t i = 0 ; i < store->entrys ; i++ ) {
+            notification_t *notification = notification_store_slot( store, i );
+            if ( notification->src == interned ) {
+                notification->src = &store->intern[ used ];
+                referenced = true;
+            }
+        }
+        if ( referenced ) {
+            memmove( &store->intern[ used ], interned, len );
+            used += len;
+        }
+        pos += len;
+    }
+    log_d("notification intern arena compacted from %d to %d bytes", store->intern_used, used );
+    store->intern_used = used;
+}
+
+/**
+ * @brief get an interned copy of a string, identical strings share the same memory
+ */
+static const char *notification_store_intern( notification_store_t *store, const char *str ) {
+    if ( str == NULL || *str == '\0' ) {
+        return( notification_store_default_src );
+    }
+    /*
+     * search the arena for an identical string
+     */
+    size_t pos = 0;
+    while( pos < store->intern_used ) {
+        const char *interned = &store->intern[ pos ];
+        if ( !strcmp( interned, str ) ) {
+            return( interned );
+        }
+        pos += strlen( interned ) + 1;
+    }
+    /*
+     * append the string if enough space left
+     */
+    size_t len = strlen( str ) + 1;
+    if ( store->intern_used + len > NOTIFICATION_STORE_INTERN_SIZE ) {
+        notification_store_intern_compact( store );
+    }
+    if ( store->intern_used + len > NOTIFICATION_STORE_INTERN_SIZE ) {
+        log_w("notification intern arena full, use default src");
+        return( notification_store_default_src );
+    }
+    char *interned = &store->intern[ store->intern_used ];
+    memcpy( interned, str, len );
+    store->intern_used += len;
+    return( interned );
+}
+
+const notification_t *notification_store_add( notification_store_t *store, int32_t id, const char *src, const char *title, const char *sender, const char *body, int16_t icon ) {
+    if ( store == NULL ) {
+        return( NULL );
+    }
+    uint64_t bench_start = bench_begin( notification_store_bench_add );
+    /*
+     * evict the oldest notification when full, the slot is reused
+     */
+    if ( store->entrys == NOTIFICATION_STORE_ENTRYS ) {
+        store->first = ( store->first + 1 ) % NOTIFICATION_STORE_ENTRYS;
+        store->entrys--;
+    }
+    /*
+     * the next free slot is always behind the last ring position
+     */
+    notification_t *notification = notification_store_slot( store, store->entrys );
+    store->entrys++;
+
+    notification->id = id;
+    time( &notification->timestamp );
+    /*
+     * the reused slot must not keep its old src alive during a compaction
+     */
+    notification->src = notification_store_default_src;
+    notification->src = notification_store_intern( store, src );
+    notification->icon = icon;
+    notification->truncated = 0;
+    notification->body_len = body ? strlen( body ) : 0;
+    if ( notification_store_copy( notification->title, sizeof( notification->title ), title ) )
+        notification->truncated |= NOTIFICATION_TRUNCATED_TITLE;
+    if ( notification_store_copy( notification->sender, sizeof( notification->sender ), sender ) )
+        notification->truncated |= NOTIFICATION_TRUNCATED_SENDER;
+    if ( notification_store_copy( notification->body, sizeof( notification->body ), body ) ) {
+        notification->truncated |= NOTIFICATION_TRUNCATED_BODY;
+        log_w("notification %d body cut from %d to %d bytes", id, notification->body_len, strlen( notification->body ) );
+    }
+
+    bench_end( notification_store_bench_add, bench_start );
+    return( notification );
+}
+
+const notification_t *notification_store_get( notification_store_t *store, int32_t entry ) {
+    if ( store == NULL || entry < 0 || entry >= store->entrys ) {
+        return( NULL );
+    }
+    return( notification_store_slot( store, entry ) );
+}
+
+bool notification_store_delete( notification_store_t *store, int32_t entry ) {
+    if ( store == NULL || entry < 0 || entry >= store->entrys ) {
+        return( false );
+    }
+    /*
+     * move the slot number of the deleted entry behind the last entry,
+     * all following entrys move one position forward
+     */
+    uint8_t slot = store->order[ ( store->first + entry ) % NOTIFICATION_STORE_ENTRYS ];
+    for ( int32_t i = entry ; i < store->entrys - 1 ; i++ ) {
+        store->order[ ( store->first + i ) % NOTIFICATION_STORE_ENTRYS ] = store->order[ ( store->first + i + 1 ) % NOTIFICATION_STORE_ENTRYS ];
+    }
+    store->order[ ( store->first + store->entrys - 1 ) % NOTIFICATION_STORE_ENTRYS ] = slot;
+    store->entrys--;
+    return( true );
+}
+
+int32_t notification_store_get_entrys( notification_store_t *store ) {
+    if ( store == NULL ) {
+        return( 0 );
+    }
+    return( store->entrys );
+}
+
+void notification_store_clear( notification_store_t *store ) {
+    if ( store == NULL ) {
+        return;
+    }
+    store->entrys = 0;
+}
+
+void notification_store_print( notification_store_t *store ) {
+    if ( store == NULL ) {
+        return;
+    }
+    for ( int32_t i = 0 ; i < store->entrys ; i++ ) {
+        const notification_t *notification = notification_store_slot( store, i );
+        log_i("notification %d: id=%d, src=\"%s\", title=\"%s\", sender=\"%s\", body=\"%s\"", i, notification->id, notification->src, notification->title, notification->sender, notification->body );
+    }
+}
@@ -0,0 +1,128 @@
+/****************************************************************************
+ *   Oct 18 11:48:03 2026
+ *   Copyright  2026  My-TTGO-Watch contributors
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#ifndef _NOTIFICATION_STORE_H
+    #define _NOTIFICATION_STORE_H
+
+    #include <stdint.h>
+    #include <sys/time.h>
+
+    #define NOTIFICATION_STORE_ENTRYS       32          /** @brief max number of stored notifications, the oldest is evicted when full */
+    #define NOTIFICATION_STORE_INTERN_SIZE  1024        /** @brief size of the interned string arena in bytes */
+    #define NOTIFICATION_TITLE_SIZE         64          /** @brief max title length incl. \0 */
+    #define NOTIFICATION_SENDER_SIZE        64          /** @brief max sender length incl. \0 */
+    #define NOTIFICATION_BODY_SIZE          768         /** @brief max body length incl. \0 */
+    #define NOTIFICATION_NO_ICON            -1          /** @brief no icon index known */
+    #define NOTIFICATION_TRUNCATED_MARK     "..."       /** @brief appended to a cut title, sender or body */
+    /**
+     * @brief flags for notification_t.truncated
+     */
+    #define NOTIFICATION_TRUNCATED_TITLE    ( 1 << 0 )  /** @brief title was cut */
+    #define NOTIFICATION_TRUNCATED_SENDER   ( 1 << 1 )  /** @brief sender was cut */
+    #define NOTIFICATION_TRUNCATED_BODY     ( 1 << 2 )  /** @brief body was cut */
+
+    /**
+     * @brief pre parsed notification, one slab slot
+     */
+    typedef struct {
+        int32_t id;                                     /** @brief gadgetbridge notification id */
+        time_t timestamp;                               /** @brief receive time */
+        const char *src;                                /** @brief interned notification source, never NULL */
+        int16_t icon;                                   /** @brief icon index or NOTIFICATION_NO_ICON */
+        uint8_t truncated;                              /** @brief NOTIFICATION_TRUNCATED_* flags */
+        uint32_t body_len;                              /** @brief body length in bytes as received */
+        char title[ NOTIFICATION_TITLE_SIZE ];          /** @brief title, empty if not set */
+        char sender[ NOTIFICATION_SENDER_SIZE ];        /** @brief sender or phone number, empty if not set */
+        char body[ NOTIFICATION_BODY_SIZE ];            /** @brief body, empty if not set */
+    } notification_t;
+
+    /**
+     * @brief notification store structure
+     */
+    typedef struct {
+        notification_t *slab;                           /** @brief NOTIFICATION_STORE_ENTRYS notification slots */
+        uint8_t order[ NOTIFICATION_STORE_ENTRYS ];     /** @brief ring of slot numbers, oldest first */
+        uint8_t first;                                  /** @brief ring position of the oldest notification */
+        int32_t entrys;                                 /** @brief number of stored notifications */
+        char *intern;                                   /** @brief interned string arena */
+        size_t intern_used;                             /** @brief used bytes in the interned string arena */
+    } notification_store_t;
+
+    /**
+     * @brief allocate a notification store, all memory is allocated once
+     *
+     * @return  pointer to the notification store, NULL if failed
+     */
+    notification_store_t *notification_store_create( void );
+    /**
+     * @brief add a notification, if the store is full the oldest notification is evicted.
+     * too long strings are cut on an utf-8 character boundary and end with NOTIFICATION_TRUNCATED_MARK
+     *
+     * @param   store       pointer to the notification store
+     * @param   id          gadgetbridge notification id
+     * @param   src         notification source or NULL
+     * @param   title       title or NULL
+     * @param   sender      sender or NULL
+     * @param   body        body or NULL
+     * @param   icon        icon index or NOTIFICATION_NO_ICON
+     *
+     * @return  pointer to the stored notification, NULL if failed
+     */
+    const notification_t *notification_store_add( notification_store_t *store, int32_t id, const char *src, const char *title, const char *sender, const char *body, int16_t icon );
+    /**
+     * @brief get a notification
+     *
+     * @param   store       pointer to the notification store
+     * @param   entry       entry number, 0 is the oldest
+     *
+     * @return  pointer to the notification or NULL if failed
+     */
+    const notification_t *notification_store_get( notification_store_t *store, int32_t entry );
+    /**
+     * @brief delete a notification
+     *
+     * @param   store       pointer to the notification store
+     * @param   entry       entry number, 0 is the oldest
+     *
+     * @return  true if success, false if failed
+     */
+    bool notification_store_delete( notification_store_t *store, int32_t entry );
+    /**
+     * @brief get the number of stored notifications
+     *
+     * @param   store       pointer to the notification store
+     *
+     * @return  number of entrys
+     */
+    int32_t notification_store_get_entrys( notification_store_t *store );
+    /**
+     * @brief delete all notifications, interned strings are reclaimed when the arena is full
+     *
+     * @param   store       pointer to the notification store
+     */
+    void notification_store_clear( notification_store_t *store );
+    /**
+     * @brief printf all notifications from the store
+     *
+     * @param   store       pointer to the notification store
+     */
+    void notification_store_print( notification_store_t *store );
+
+#endif // _NOTIFICATION_STORE_H
@@ -0,0 +1,560 @@
+/****************************************************************************
+ *   Oct 18 17:58:14 2026
+ *   Copyright  2026  My-TTGO-Watch contributors
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#include <stdio.h>
+#include <string.h>
+
+#include "timeseries.h"
+
+#define TIMESERIES_HEADER_SIZE      8                   /** @brief block header, first bucket and value */
+#define TIMESERIES_ENTRY_MAX        15                  /** @brief max encoded entry size */
+#define TIMESERIES_FILENAME_SIZE    ( TIMESERIES_PATH_SIZE + 16 )
+
+/**
+ * @brief bucket length and max blocks per file, two files per tier
+ */
+static const uint32_t timeseries_interval[ TIMESERIES_TIERS ] = { 60, 60 * 60, 24 * 60 * 60 };
+static const uint32_t timeseries_file_blocks[ TIMESERIES_TIERS ] = { 16, 16, 8 };
+
+static void timeseries_tier_filename( timeseries_t *ts, int tier, int file, char *filename, size_t size ) {
+    snprintf( filename, size, "%s_%c%d.bin", ts->path, "mhd"[ tier ], file );
+}
+
+static uint32_t timeseries_get_le32( const uint8_t *data ) {
+    return( data[ 0 ] | ( data[ 1 ] << 8 ) | ( data[ 2 ] << 16 ) | ( (uint32_t)data[ 3 ] << 24 ) );
+}
+
+static void timeseries_put_le32( uint8_t *data, uint32_t value ) {
+    data[ 0 ] = value;
+    data[ 1 ] = value >> 8;
+    data[ 2 ] = value >> 16;
+    data[ 3 ] = value >> 24;
+}
+
+static int timeseries_put_varint( uint8_t *data, uint64_t value ) {
+    int len = 0;
+
+    while( value >= 0x80 ) {
+        data[ len++ ] = ( value & 0x7f ) | 0x80;
+        value >>= 7;
+    }
+    data[ len++ ] = value;
+    return( len );
+}
+
+/**
+ * @return  bytes used or 0 if the varint is truncated
+ */
+static int timeseries_get_varint( const uint8_t *data, int len, uint64_t *value ) {
+    uint64_t result = 0;
+
+    for( int i = 0 ; i < len && i < 10 ; i++ ) {
+        result |= (uint64_t)( data[ i ] & 0x7f ) << ( 7 * i );
+        if ( !( data[ i ] & 0x80 ) ) {
+            *value = result;
+            return( i + 1 );
+        }
+    }
+    return( 0 );
+}
+
+/**
+ * @brief decode one block
+ *
+ * @param   block       block data
+ * @param   len         block length, less than TIMESERIES_BLOCK_SIZE for the last block
+ * @param   callback    called for each entry, return false to stop
+ *
+ * @return  true if the block is sealed with an end marker
+ */
+static bool timeseries_decode_block( const uint8_t *block, int len, bool (*callback)( void *arg, uint32_t bucket, int32_t value ), void *arg ) {
+    if ( len < TIMESERIES_HEADER_SIZE ) {
+        return( false );
+    }
+    uint32_t bucket = timeseries_get_le32( block );
+    int32_t value = (int32_t)timeseries_get_le32( block + 4 );
+    int pos = TIMESERIES_HEADER_SIZE;
+
+    if ( !callback( arg, bucket, value ) ) {
+        return( false );
+    }
+    while( pos < len ) {
+        uint64_t entry;
+        uint64_t gap = 0;
+        int used = timeseries_get_varint( block + pos, len - pos, &entry );
+        if ( !used ) {
+            break;
+        }
+        pos += used;
+        if ( entry & 1 ) {
+            used = timeseries_get_varint( block + pos, len - pos, &gap );
+            if ( !used ) {
+                break;
+            }
+            pos += used;
+            if ( gap == 0 ) {
+                return( true );
+            }
+        }
+        uint32_t zigzag = entry >> 1;
+        bucket += gap + 1;
+        value += (int32_t)( ( zigzag >> 1 ) ^ -( zigzag & 1 ) );
+        if ( !callback( arg, bucket, value ) ) {
+            break;
+        }
+    }
+    return( false );
+}
+
+/**
+ * @brief read a block of a tier file, the pending bytes of the active file
+ * are appended behind the flushed bytes
+ *
+ * @return  block length
+ */
+static int timeseries_read_block( timeseries_t *ts, int tier, FILE *file, uint32_t file_bytes, bool active, uint32_t block, uint8_t *data ) {
+    timeseries_tier_t *t = &ts->tier[ tier ];
+    uint32_t offset = block * TIMESERIES_BLOCK_SIZE;
+    uint32_t total = file_bytes + ( active ? t->pending_len : 0 );
+    int len = 0;
+
+    if ( offset >= total ) {
+        return( 0 );
+    }
+    if ( offset < file_bytes && file ) {
+        uint32_t size = file_bytes - offset;
+        if ( size > TIMESERIES_BLOCK_SIZE ) {
+            size = TIMESERIES_BLOCK_SIZE;
+        }
+        fseek( file, offset, SEEK_SET );
+        len = fread( data, 1, size, file );
+        if ( len != (int)size ) {
+            return( len );
+        }
+    }
+    if ( active && len < TIMESERIES_BLOCK_SIZE && offset + len >= file_bytes ) {
+        uint32_t pending_offset = offset + len - file_bytes;
+        uint32_t size = t->pending_len - pending_offset;
+        if ( size > (uint32_t)( TIMESERIES_BLOCK_SIZE - len ) ) {
+            size = TIMESERIES_BLOCK_SIZE - len;
+        }
+        memcpy( data + len, t->pending + pending_offset, size );
+        len += size;
+    }
+    return( len );
+}
+
+static uint32_t timeseries_file_size( FILE *file ) {
+    if ( !file ) {
+        return( 0 );
+    }
+    fseek( file, 0, SEEK_END );
+    long size = ftell( file );
+    return( size < 0 ? 0 : size );
+}
+
+static void timeseries_flush_tier( timeseries_t *ts, int tier ) {
+    timeseries_tier_t *t = &ts->tier[ tier ];
+    char filename[ TIMESERIES_FILENAME_SIZE ];
+
+    if ( !t->pending_len ) {
+        return;
+    }
+    timeseries_tier_filename( ts, tier, t->file, filename, sizeof( filename ) );
+    FILE *file = fopen( filename, "ab" );
+    if ( !file ) {
+        return;
+    }
+    size_t written = fwrite( t->pending, 1, t->pending_len, file );
+    fclose( file );
+
+    ts->stats.writes++;
+    ts->stats.bytes_written += written;
+    t->file_bytes += written;
+    t->pending_len = 0;
+}
+
+static void timeseries_write( timeseries_t *ts, int tier, const uint8_t *data, int len ) {
+    timeseries_tier_t *t = &ts->tier[ tier ];
+
+    ts->stats.bytes_encoded += len;
+    while( len ) {
+        if ( t->pending_len == TIMESERIES_PENDING_SIZE ) {
+            timeseries_flush_tier( ts, tier );
+            /*
+             * drop the bytes if the file can't be written
+             */
+            if ( t->pending_len ) {
+                t->pending_len = 0;
+            }
+        }
+        int size = TIMESERIES_PENDING_SIZE - t->pending_len;
+        if ( size > len ) {
+            size = len;
+        }
+        memcpy( t->pending + t->pending_len, data, size );
+        t->pending_len += size;
+        data += size;
+        len -= size;
+    }
+}
+
+/**
+ * @brief append a closed bucket to a tier
+ */
+static void timeseries_append( timeseries_t *ts, int tier, uint32_t bucket, int32_t value ) {
+    timeseries_tier_t *t = &ts->tier[ tier ];
+    uint8_t entry[ TIMESERIES_ENTRY_MAX ];
+    int len = 0;
+
+    ts->stats.buckets++;
+
+    if ( t->block_used ) {
+        uint32_t gap = bucket - t->last_bucket - 1;
+        int32_t delta = (int32_t)( (uint32_t)value - (uint32_t)t->last_value );
+        uint32_t zigzag = ( (uint32_t)delta << 1 ) ^ (uint32_t)( delta >> 31 );
+
+        len = timeseries_put_varint( entry, ( (uint64_t)zigzag << 1 ) | ( gap ? 1 : 0 ) );
+        if ( gap ) {
+            len += timeseries_put_varint( entry + len, gap );
+        }
+        /*
+         * seal the block if the entry and an end marker don't fit
+         */
+        if ( t->block_used + len + 2 > TIMESERIES_BLOCK_SIZE ) {
+            uint8_t pad[ TIMESERIES_ENTRY_MAX + 2 ];
+            int pad_len = TIMESERIES_BLOCK_SIZE - t->block_used;
+            memset( pad, 0, sizeof( pad ) );
+            pad[ 0 ] = 0x01;
+            timeseries_write( ts, tier, pad, pad_len );
+            t->block_used = 0;
+        }
+    }
+    if ( !t->block_used ) {
+        /*
+         * rotate: the older file is deleted and reused
+         */
+        uint32_t blocks = ( t->file_bytes + t->pending_len ) / TIMESERIES_BLOCK_SIZE;
+        if ( blocks >= timeseries_file_blocks[ tier ] ) {
+            char filename[ TIMESERIES_FILENAME_SIZE ];
+            timeseries_flush_tier( ts, tier );
+            t->pending_len = 0;
+            t->file ^= 1;
+            t->file_bytes = 0;
+            timeseries_tier_filename( ts, tier, t->file, filename, sizeof( filename ) );
+            remove( filename );
+            ts->stats.rotations++;
+        }
+        timeseries_put_le32( entry, bucket );
+        timeseries_put_le32( entry + 4, value );
+        len = TIMESERIES_HEADER_SIZE;
+    }
+    timeseries_write( ts, tier, entry, len );
+    t->block_used += len;
+    t->has_last = true;
+    t->last_bucket = bucket;
+    t->last_value = value;
+
+    if ( t->pending_len >= TIMESERIES_FLUSH_SIZE ) {
+        timeseries_flush_tier( ts, tier );
+    }
+}
+
+static int32_t timeseries_aggregate( timeseries_t *ts, timeseries_tier_t *t ) {
+    if ( ts->aggregate == TIMESERIES_MEAN ) {
+        return( t->acc_sum / t->acc_count );
+    }
+    return( t->acc_sum );
+}
+
+/**
+ * @brief add a value to the accumulator of a tier, a new bucket closes the
+ * open bucket and passes it to the next tier
+ */
+static bool timeseries_accumulate( timeseries_t *ts, int tier, uint32_t time, int32_t value ) {
+    timeseries_tier_t *t = &ts->tier[ tier ];
+    uint32_t bucket = time / timeseries_interval[ tier ];
+
+    if ( t->acc_count && bucket != t->acc_bucket ) {
+        if ( bucket < t->acc_bucket ) {
+            return( false );
+        }
+        int32_t closed = timeseries_aggregate( ts, t );
+        uint32_t closed_time = t->acc_bucket * timeseries_interval[ tier ];
+        if ( !t->has_last || t->acc_bucket > t->last_bucket ) {
+            timeseries_append( ts, tier, t->acc_bucket, closed );
+        }
+        t->acc_count = 0;
+        t->acc_sum = 0;
+        if ( tier + 1 < TIMESERIES_TIERS ) {
+            timeseries_accumulate( ts, tier + 1, closed_time, closed );
+        }
+    }
+    /*
+     * never reopen a bucket that is already written
+     */
+    if ( t->has_last && bucket <= t->last_bucket ) {
+        return( false );
+    }
+    t->acc_bucket = bucket;
+    t->acc_sum += value;
+    t->acc_count++;
+    return( true );
+}
+
+bool timeseries_add( timeseries_t *ts, uint32_t time, int32_t value ) {
+    ts->stats.samples++;
+    if ( !timeseries_accumulate( ts, TIMESERIES_MINUTE, time, value ) ) {
+        ts->stats.dropped++;
+        return( false );
+    }
+    return( true );
+}
+
+void timeseries_flush( timeseries_t *ts ) {
+    for( int tier = 0 ; tier < TIMESERIES_TIERS ; tier++ ) {
+        timeseries_flush_tier( ts, tier );
+    }
+}
+
+/**
+ * @brief query state
+ */
+typedef struct {
+    uint32_t from;
+    uint32_t to;
+    uint32_t interval;
+    timeseries_point_t *points;
+    int32_t max_points;
+    int32_t count;
+    bool done;
+} timeseries_query_t;
+
+static bool timeseries_query_cb( void *arg, uint32_t bucket, int32_t value ) {
+    timeseries_query_t *query = (timeseries_query_t *)arg;
+
+    if ( bucket > query->to ) {
+        query->done = true;
+        return( false );
+    }
+    if ( bucket >= query->from ) {
+        if ( query->count >= query->max_points ) {
+            query->done = true;
+            return( false );
+        }
+        query->points[ query->count ].time = bucket * query->interval;
+        query->points[ query->count ].value = value;
+        query->count++;
+    }
+    return( true );
+}
+
+static void timeseries_query_file( timeseries_t *ts, int tier, int file_num, timeseries_query_t *query ) {
+    timeseries_tier_t *t = &ts->tier[ tier ];
+    char filename[ TIMESERIES_FILENAME_SIZE ];
+    uint8_t block[ TIMESERIES_BLOCK_SIZE ];
+    bool active = ( file_num == t->file );
+
+    timeseries_tier_filename( ts, tier, file_num, filename, sizeof( filename ) );
+    FILE *file = fopen( filename, "rb" );
+    uint32_t file_bytes = active ? t->file_bytes : timeseries_file_size( file );
+    uint32_t total = file_bytes + ( active ? t->pending_len : 0 );
+    uint32_t blocks = ( total + TIMESERIES_BLOCK_SIZE - 1 ) / TIMESERIES_BLOCK_SIZE;
+
+    if ( blocks ) {
+        /*
+         * binary search the last block that starts at or before from
+         */
+        uint32_t low = 0;
+        uint32_t high = blocks - 1;
+        while( low < high ) {
+            uint32_t mid = ( low + high + 1 ) / 2;
+            int len = timeseries_read_block( ts, tier, file, file_bytes, active, mid, block );
+            if ( len >= TIMESERIES_HEADER_SIZE && timeseries_get_le32( block ) <= query->from ) {
+                low = mid;
+            }
+            else {
+                high = mid - 1;
+            }
+        }
+        for( uint32_t i = low ; i < blocks && !query->done ; i++ ) {
+            int len = timeseries_read_block( ts, tier, file, file_bytes, active, i, block );
+            timeseries_decode_block( block, len, timeseries_query_cb, query );
+        }
+    }
+    if ( file ) {
+        fclose( file );
+    }
+}
+
+int32_t timeseries_query( timeseries_t *ts, int tier, uint32_t from, uint32_t to, timeseries_point_t *points, int32_t max_points ) {
+    timeseries_query_t query;
+
+    if ( tier < 0 || tier >= TIMESERIES_TIERS ) {
+        return( 0 );
+    }
+    query.interval = timeseries_interval[ tier ];
+    query.from = from / query.interval;
+    query.to = to / query.interval;
+    query.points = points;
+    query.max_points = max_points;
+    query.count = 0;
+    query.done = false;
+    /*
+     * older file first
+     */
+    timeseries_query_file( ts, tier, ts->tier[ tier ].file ^ 1, &query );
+    query.done = ( query.count >= max_points );
+    timeseries_query_file( ts, tier, ts->tier[ tier ].file, &query );
+    return( query.count );
+}
+
+/**
+ * @brief restore state
+ */
+typedef struct {
+    uint32_t bucket;
+    int32_t value;
+    bool found;
+} timeseries_last_t;
+
+static bool timeseries_last_cb( void *arg, uint32_t bucket, int32_t value ) {
+    timeseries_last_t *last = (timeseries_last_t *)arg;
+
+    last->bucket = bucket;
+    last->value = value;
+    last->found = true;
+    return( true );
+}
+
+/**
+ * @brief get the first bucket of a file
+ *
+ * @return  true if the file has a block
+ */
+static bool timeseries_first_bucket( timeseries_t *ts, int tier, int file_num, uint32_t *bucket ) {
+    char filename[ TIMESERIES_FILENAME_SIZE ];
+    uint8_t header[ TIMESERIES_HEADER_SIZE ];
+
+    timeseries_tier_filename( ts, tier, file_num, filename, sizeof( filename ) );
+    FILE *file = fopen( filename, "rb" );
+    if ( !file ) {
+        return( false );
+    }
+    bool retval = fread( header, 1, sizeof( header ), file ) == sizeof( header );
+    fclose( file );
+    if ( retval ) {
+        *bucket = timeseries_get_le32( header );
+    }
+    return( retval );
+}
+
+static void timeseries_restore_tier( timeseries_t *ts, int tier ) {
+    timeseries_tier_t *t = &ts->tier[ tier ];
+    char filename[ TIMESERIES_FILENAME_SIZE ];
+    uint8_t block[ TIMESERIES_BLOCK_SIZE ];
+    uint32_t first[ 2 ];
+    bool exist[ 2 ];
+
+    for( int i = 0 ; i < 2 ; i++ ) {
+        exist[ i ] = timeseries_first_bucket( ts, tier, i, &first[ i ] );
+    }
+    t->file = ( exist[ 1 ] && ( !exist[ 0 ] || first[ 1 ] > first[ 0 ] ) ) ? 1 : 0;
+
+    timeseries_tier_filename( ts, tier, t->file, filename, sizeof( filename ) );
+    FILE *file = fopen( filename, "rb" );
+    t->file_bytes = timeseries_file_size( file );
+    if ( t->file_bytes ) {
+        uint32_t last_block = ( t->file_bytes - 1 ) / TIMESERIES_BLOCK_SIZE;
+        timeseries_last_t last = { 0, 0, false };
+        int len = timeseries_read_block( ts, tier, file, t->file_bytes, true, last_block, block );
+        bool sealed = timeseries_decode_block( block, len, timeseries_last_cb, &last );
+        if ( last.found ) {
+            t->has_last = true;
+            t->last_bucket = last.bucket;
+            t->last_value = last.value;
+            t->block_used = ( sealed || len == TIMESERIES_BLOCK_SIZE ) ? 0 : len;
+            /*
+             * the next block starts on a block boundary
+             */
+            if ( !t->block_used && len != TIMESERIES_BLOCK_SIZE ) {
+                uint8_t pad[ TIMESERIES_BLOCK_SIZE ];
+                memset( pad, 0, sizeof( pad ) );
+                timeseries_write( ts, tier, pad, TIMESERIES_BLOCK_SIZE - len );
+            }
+        }
+    }
+    if ( file ) {
+        fclose( file );
+    }
+}
+
+/**
+ * @brief refill the accumulator of a tier from the closed buckets of the
+ * tier below, the open buckets of the hour and day tier survive a restart
+ */
+static void timeseries_restore_accumulator( timeseries_t *ts, int tier ) {
+    timeseries_tier_t *t = &ts->tier[ tier ];
+    timeseries_point_t points[ 32 ];
+    uint32_t from = t->has_last ? ( t->last_bucket + 1 ) * timeseries_interval[ tier ] : 0;
+    int32_t count;
+
+    do {
+        count = timeseries_query( ts, tier - 1, from, UINT32_MAX, points, 32 );
+        for( int32_t i = 0 ; i < count ; i++ ) {
+            timeseries_accumulate( ts, tier, points[ i ].time, points[ i ].value );
+        }
+        if ( count ) {
+            from = points[ count - 1 ].time + timeseries_interval[ tier - 1 ];
+        }
+    } while( count == 32 );
+}
+
+bool timeseries_open( timeseries_t *ts, const char *path, uint8_t aggregate ) {
+    memset( ts, 0, sizeof( timeseries_t ) );
+    if ( strlen( path ) >= TIMESERIES_PATH_SIZE ) {
+        return( false );
+    }
+    strncpy( ts->path, path, sizeof( ts->path ) - 1 );
+    ts->aggregate = aggregate;
+
+    for( int tier = 0 ; tier < TIMESERIES_TIERS ; tier++ ) {
+        timeseries_restore_tier( ts, tier );
+    }
+    /*
+     * top down, a bucket closed by the hour restore is passed to the day
+     * accumulator and must not be read again from the hour files
+     */
+    for( int tier = TIMESERIES_TIERS - 1 ; tier > TIMESERIES_MINUTE ; tier-- ) {
+        timeseries_restore_accumulator( ts, tier );
+    }
+    /*
+     * the restore is no new data
+     */
+    memset( &ts->stats, 0, sizeof( ts->stats ) );
+    return( true );
+}
+
+uint32_t timeseries_get_interval( int tier ) {
+    if ( tier < 0 || tier >= TIMESERIES_TIERS ) {
+        return( 0 );
+    }
+    return( timeseries_interval[ tier ] );
+}
@@ -0,0 +1,162 @@
+/****************************************************************************
+ *   Oct 18 17:58:14 2026
+ *   Copyright  2026  My-TTGO-Watch contributors
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#ifndef _TIMESERIES_H
+    #define _TIMESERIES_H
+
+    #include <stdint.h>
+    #include <stdbool.h>
+
+    /*
+     * note:    this module only uses stdio, tools/timeseries_bench.cpp
+     *          builds it on the host.
+     *
+     * file format: each tier is stored in two rotating append-only files
+     * of fixed size blocks. a block starts with the bucket and value of its
+     * first entry, followed by varint entrys:
+     *
+     *      varint( zigzag( value delta ) << 1 | gap )
+     *      varint( bucket delta - 1 )                  only if gap is set
+     *
+     * a gap entry with bucket delta 1 ( 0x01 0x00 ) ends a block early.
+     * blocks are searched binary by the header, entrys are decoded linear.
+     */
+    #define TIMESERIES_BLOCK_SIZE       256                 /** @brief block size in bytes, one SPIFFS page */
+    #define TIMESERIES_PENDING_SIZE     64                  /** @brief unflushed bytes per tier */
+    #define TIMESERIES_FLUSH_SIZE       48                  /** @brief flush a tier when this amount of bytes is pending */
+    #define TIMESERIES_PATH_SIZE        32                  /** @brief max path length without tier suffix */
+
+    enum {
+        TIMESERIES_MINUTE = 0,
+        TIMESERIES_HOUR,
+        TIMESERIES_DAY,
+        TIMESERIES_TIERS
+    };
+
+    enum {
+        TIMESERIES_SUM = 0,                                 /** @brief buckets sum all values, e.g. steps */
+        TIMESERIES_MEAN                                     /** @brief buckets average all values, e.g. battery percent */
+    };
+
+    /**
+     * @brief one bucket
+     */
+    typedef struct {
+        uint32_t time;                      /** @brief bucket start in seconds */
+        int32_t value;                      /** @brief aggregated value */
+    } timeseries_point_t;
+
+    /**
+     * @brief statistic per series
+     */
+    typedef struct {
+        uint32_t samples;                   /** @brief values added with timeseries_add */
+        uint32_t dropped;                   /** @brief values dropped, time went backwards */
+        uint32_t buckets;                   /** @brief closed buckets over all tiers */
+        uint32_t bytes_encoded;             /** @brief encoded bytes including block header and padding */
+        uint32_t bytes_written;             /** @brief bytes written to the filesystem */
+        uint32_t writes;                    /** @brief write calls to the filesystem */
+        uint32_t rotations;                 /** @brief files rotated */
+    } timeseries_stats_t;
+
+    /**
+     * @brief one tier, encoder state and accumulator of the open bucket
+     */
+    typedef struct {
+        bool has_last;                      /** @brief true if a bucket was encoded */
+        uint32_t last_bucket;               /** @brief last encoded bucket */
+        int32_t last_value;                 /** @brief last encoded value */
+        uint16_t block_used;                /** @brief bytes used in the current block, 0 if no block is open */
+        uint16_t pending_len;               /** @brief unflushed bytes */
+        uint8_t pending[ TIMESERIES_PENDING_SIZE ];  /** @brief unflushed bytes */
+        uint8_t file;                       /** @brief active file, 0 or 1 */
+        uint32_t file_bytes;                /** @brief flushed bytes in the active file */
+        uint32_t acc_bucket;                /** @brief bucket of the accumulator */
+        int64_t acc_sum;                    /** @brief accumulated values */
+        uint32_t acc_count;                 /** @brief number of accumulated values, 0 if empty */
+    } timeseries_tier_t;
+
+    /**
+     * @brief time series
+     */
+    typedef struct {
+        char path[ TIMESERIES_PATH_SIZE ];  /** @brief file path prefix */
+        uint8_t aggregate;                  /** @brief TIMESERIES_SUM or TIMESERIES_MEAN */
+        timeseries_tier_t tier[ TIMESERIES_TIERS ];
+        timeseries_stats_t stats;
+    } timeseries_t;
+
+    #ifdef __cplusplus
+    extern "C" {
+    #endif
+
+    /**
+     * @brief open a time series and restore the state from the files
+     *
+     * @param   ts          pointer to the series
+     * @param   path        file path prefix, e.g. "/spiffs/ts_steps"
+     * @param   aggregate   TIMESERIES_SUM or TIMESERIES_MEAN
+     *
+     * @return  true if success
+     */
+    bool timeseries_open( timeseries_t *ts, const char *path, uint8_t aggregate );
+    /**
+     * @brief add a value, a new minute closes the open buckets
+     *
+     * @param   ts          pointer to the series
+     * @param   time        time in seconds
+     * @param   value       value
+     *
+     * @return  true if added, false if the time is older than the open minute
+     */
+    bool timeseries_add( timeseries_t *ts, uint32_t time, int32_t value );
+    /**
+     * @brief write all pending bytes
+     *
+     * @param   ts          pointer to the series
+     */
+    void timeseries_flush( timeseries_t *ts );
+    /**
+     * @brief get the closed buckets in a time range, pending bytes are included
+     *
+     * @param   ts          pointer to the series
+     * @param   tier        TIMESERIES_MINUTE, TIMESERIES_HOUR or TIMESERIES_DAY
+     * @param   from        range start in seconds
+     * @param   to          range end in seconds, inclusive
+     * @param   points      pointer to a buffer for max_points points
+     * @param   max_points  max number of points
+     *
+     * @return  number of points
+     */
+    int32_t timeseries_query( timeseries_t *ts, int tier, uint32_t from, uint32_t to, timeseries_point_t *points, int32_t max_points );
+    /**
+     * @brief get the bucket length of a tier
+     *
+     * @param   tier        TIMESERIES_MINUTE, TIMESERIES_HOUR or TIMESERIES_DAY
+     *
+     * @return  bucket length in seconds
+     */
+    uint32_t timeseries_get_interval( int tier );
+
+    #ifdef __cplusplus
+    }
+    #endif
+
+#endif // _TIMESERIES_H
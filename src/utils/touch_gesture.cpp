@@ -0,0 +1,182 @@
+/****************************************************************************
+ *   Oct 18 20:04:26 2026
+ *   Copyright  2026  My-TTGO-Watch contributors
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#include <string.h>
+
+#include "touch_gesture.h"
+
+static const char *touch_gesture_names[ TOUCH_GESTURE_NUM ] = { "none", "tap", "long press", "swipe left", "swipe right", "swipe up", "swipe down",
+                                                                "edge left", "edge right", "edge top", "edge bottom" };
+
+static int32_t touch_gesture_abs( int32_t value ) {
+    return( value < 0 ? -value : value );
+}
+
+static int16_t touch_gesture_clip( int32_t value, int16_t max ) {
+    return( value < 0 ? 0 : ( value >= max ? max - 1 : value ) );
+}
+
+void touch_calibration_apply( const touch_calibration_t *cal, int16_t *x, int16_t *y, int16_t width, int16_t height ) {
+    int32_t raw_x = *x;
+    int32_t raw_y = *y;
+    /*
+     * round to the nearest pixel
+     */
+    int32_t round = 1 << ( TOUCH_CALIBRATION_SHIFT - 1 );
+
+    *x = touch_gesture_clip( ( cal->m[ 0 ] * raw_x + cal->m[ 1 ] * raw_y + cal->m[ 2 ] + round ) >> TOUCH_CALIBRATION_SHIFT, width );
+    *y = touch_gesture_clip( ( cal->m[ 3 ] * raw_x + cal->m[ 4 ] * raw_y + cal->m[ 5 ] + round ) >> TOUCH_CALIBRATION_SHIFT, height );
+}
+
+void touch_filter_init( touch_filter_t *f, uint16_t latency_ms ) {
+    memset( f, 0, sizeof( touch_filter_t ) );
+    f->latency_ms = latency_ms;
+}
+
+void touch_filter_reset( touch_filter_t *f ) {
+    f->valid = false;
+}
+
+void touch_filter_push( touch_filter_t *f, int16_t *x, int16_t *y, uint32_t ms ) {
+    if ( !f->valid || !f->latency_ms ) {
+        f->valid = true;
+        f->x = *x << 8;
+        f->y = *y << 8;
+        f->out_x = *x;
+        f->out_y = *y;
+        f->ms = ms;
+        return;
+    }
+    /*
+     * the weight of a sample grows with the time since the last one,
+     * so the lag stays the same with an irregular sample rate
+     */
+    uint32_t dt = ms - f->ms;
+    dt = dt ? dt : 1;
+    int32_t alpha = ( dt << 8 ) / ( f->latency_ms + dt );
+    f->x += ( ( ( *x << 8 ) - f->x ) * alpha ) >> 8;
+    f->y += ( ( ( *y << 8 ) - f->y ) * alpha ) >> 8;
+    f->ms = ms;
+    /*
+     * report only moves out of the deadband, a resting finger stays put
+     */
+    int16_t new_x = ( f->x + 128 ) >> 8;
+    int16_t new_y = ( f->y + 128 ) >> 8;
+    if ( touch_gesture_abs( new_x - f->out_x ) > TOUCH_FILTER_DEADBAND || touch_gesture_abs( new_y - f->out_y ) > TOUCH_FILTER_DEADBAND ) {
+        f->out_x = new_x;
+        f->out_y = new_y;
+    }
+    *x = f->out_x;
+    *y = f->out_y;
+}
+
+void touch_gesture_init( touch_gesture_t *g, int16_t width, int16_t height ) {
+    memset( g, 0, sizeof( touch_gesture_t ) );
+    g->width = width;
+    g->height = height;
+}
+
+static void touch_gesture_event( touch_gesture_t *g, uint8_t type, uint32_t ms, touch_gesture_event_t *event ) {
+    event->type = type;
+    event->x = g->start_x;
+    event->y = g->start_y;
+    event->dx = g->x - g->start_x;
+    event->dy = g->y - g->start_y;
+    event->duration_ms = ms - g->start_ms;
+}
+
+bool touch_gesture_push( touch_gesture_t *g, int16_t x, int16_t y, uint32_t ms, touch_gesture_event_t *event ) {
+    if ( !g->down ) {
+        g->down = true;
+        g->moved = false;
+        g->long_press = false;
+        g->start_x = x;
+        g->start_y = y;
+        g->start_ms = ms;
+    }
+    g->x = x;
+    g->y = y;
+
+    if ( touch_gesture_abs( x - g->start_x ) > TOUCH_GESTURE_SLOP || touch_gesture_abs( y - g->start_y ) > TOUCH_GESTURE_SLOP ) {
+        g->moved = true;
+    }
+    if ( !g->moved && !g->long_press && ms - g->start_ms >= TOUCH_GESTURE_LONG_PRESS_MS ) {
+        g->long_press = true;
+        touch_gesture_event( g, TOUCH_GESTURE_LONG_PRESS, ms, event );
+        return( true );
+    }
+    return( false );
+}
+
+bool touch_gesture_release( touch_gesture_t *g, uint32_t ms, touch_gesture_event_t *event ) {
+    if ( !g->down ) {
+        return( false );
+    }
+    g->down = false;
+    /*
+     * a long press ends with the release
+     */
+    if ( g->long_press ) {
+        return( false );
+    }
+    if ( !g->moved ) {
+        touch_gesture_event( g, TOUCH_GESTURE_TAP, ms, event );
+        return( true );
+    }
+
+    int32_t dx = g->x - g->start_x;
+    int32_t dy = g->y - g->start_y;
+    if ( ms - g->start_ms > TOUCH_GESTURE_SWIPE_MAX_MS ) {
+        return( false );
+    }
+    /*
+     * the major axis decides the direction, a swipe away from
+     * the border it started at is an edge swipe
+     */
+    uint8_t type = TOUCH_GESTURE_NONE;
+    if ( touch_gesture_abs( dx ) >= touch_gesture_abs( dy ) && touch_gesture_abs( dx ) >= TOUCH_GESTURE_SWIPE_MIN ) {
+        if ( dx > 0 ) {
+            type = g->start_x < TOUCH_GESTURE_EDGE ? TOUCH_GESTURE_EDGE_LEFT : TOUCH_GESTURE_SWIPE_RIGHT;
+        }
+        else {
+            type = g->start_x >= g->width - TOUCH_GESTURE_EDGE ? TOUCH_GESTURE_EDGE_RIGHT : TOUCH_GESTURE_SWIPE_LEFT;
+        }
+    }
+    else if ( touch_gesture_abs( dy ) > touch_gesture_abs( dx ) && touch_gesture_abs( dy ) >= TOUCH_GESTURE_SWIPE_MIN ) {
+        if ( dy > 0 ) {
+            type = g->start_y < TOUCH_GESTURE_EDGE ? TOUCH_GESTURE_EDGE_TOP : TOUCH_GESTURE_SWIPE_DOWN;
+        }
+        else {
+            type = g->start_y >= g->height - TOUCH_GESTURE_EDGE ? TOUCH_GESTURE_EDGE_BOTTOM : TOUCH_GESTURE_SWIPE_UP;
+        }
+    }
+    if ( type == TOUCH_GESTURE_NONE ) {
+        return( false );
+    }
+    touch_gesture_event( g, type, ms, event );
+    return( true );
+}
+
+const char *touch_gesture_get_name( uint8_t type ) {
+    if ( type >= TOUCH_GESTURE_NUM ) {
+        return( touch_gesture_names[ TOUCH_GESTURE_NONE ] );
+    }
+    return( touch_gesture_names[ type ] );
+}
@@ -0,0 +1,188 @@
+/****************************************************************************
+ *   Oct 18 20:04:26 2026
+ *   Copyright  2026  My-TTGO-Watch contributors
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#ifndef _TOUCH_GESTURE_H
+    #define _TOUCH_GESTURE_H
+
+    #include <stdint.h>
+    #include <stdbool.h>
+
+    /*
+     * note:    this module is plain integer C without arduino dependencies,
+     *          tools/touch_sim.cpp builds it on the host.
+     *
+     * touch pipeline per sample: calibration -> jitter filter for the pointer,
+     * calibration -> gesture recognizer for the gestures. the recognizer sees
+     * unfiltered points, the filter lag would shorten fast swipes.
+     */
+    #define TOUCH_CALIBRATION_SHIFT     16                  /** @brief fixed point shift of the calibration matrix */
+    #define TOUCH_FILTER_DEADBAND       2                   /** @brief pointer moves below this in px are jitter */
+    #define TOUCH_GESTURE_SLOP          10                  /** @brief max movement in px for tap and long press */
+    #define TOUCH_GESTURE_SWIPE_MIN     40                  /** @brief min movement in px for a swipe */
+    #define TOUCH_GESTURE_SWIPE_MAX_MS  700                 /** @brief max duration of a swipe, slower is a drag */
+    #define TOUCH_GESTURE_LONG_PRESS_MS 600                 /** @brief min duration of a long press */
+    #define TOUCH_GESTURE_EDGE          16                  /** @brief edge swipes start within this px of the border */
+
+    enum {
+        TOUCH_GESTURE_NONE = 0,
+        TOUCH_GESTURE_TAP,
+        TOUCH_GESTURE_LONG_PRESS,
+        TOUCH_GESTURE_SWIPE_LEFT,                           /** @brief finger moves to the left */
+        TOUCH_GESTURE_SWIPE_RIGHT,
+        TOUCH_GESTURE_SWIPE_UP,
+        TOUCH_GESTURE_SWIPE_DOWN,
+        TOUCH_GESTURE_EDGE_LEFT,                            /** @brief swipe from the left border to the inside */
+        TOUCH_GESTURE_EDGE_RIGHT,
+        TOUCH_GESTURE_EDGE_TOP,
+        TOUCH_GESTURE_EDGE_BOTTOM,
+        TOUCH_GESTURE_NUM
+    };
+
+    /**
+     * @brief one recognized gesture
+     */
+    typedef struct {
+        uint8_t type;                       /** @brief TOUCH_GESTURE_TAP ... TOUCH_GESTURE_EDGE_BOTTOM */
+        int16_t x;                          /** @brief start point */
+        int16_t y;
+        int16_t dx;                         /** @brief movement from start to end */
+        int16_t dy;
+        uint32_t duration_ms;               /** @brief time from press to the event */
+    } touch_gesture_event_t;
+
+    /**
+     * @brief calibration matrix in fixed point, shifted by TOUCH_CALIBRATION_SHIFT
+     *
+     *      x' = ( m[0] * x + m[1] * y + m[2] ) >> TOUCH_CALIBRATION_SHIFT
+     *      y' = ( m[3] * x + m[4] * y + m[5] ) >> TOUCH_CALIBRATION_SHIFT
+     */
+    typedef struct {
+        int32_t m[ 6 ];
+    } touch_calibration_t;
+
+    /**
+     * @brief jitter filter, a time based exponential average
+     */
+    typedef struct {
+        bool valid;                         /** @brief true if a point was filtered since the last reset */
+        int32_t x;                          /** @brief filtered point in 1/256 px */
+        int32_t y;
+        int16_t out_x;                      /** @brief last reported point */
+        int16_t out_y;
+        uint32_t ms;                        /** @brief time of the last sample */
+        uint16_t latency_ms;                /** @brief time constant, 0 disables the filter */
+    } touch_filter_t;
+
+    /**
+     * @brief gesture recognizer state
+     */
+    typedef struct {
+        bool down;                          /** @brief true while touched */
+        bool moved;                         /** @brief true if the touch left the slop */
+        bool long_press;                    /** @brief true if a long press was reported */
+        int16_t start_x;
+        int16_t start_y;
+        int16_t x;                          /** @brief last point */
+        int16_t y;
+        uint32_t start_ms;
+        int16_t width;                      /** @brief screen size for the edge detection */
+        int16_t height;
+    } touch_gesture_t;
+
+    #ifdef __cplusplus
+    extern "C" {
+    #endif
+
+    /**
+     * @brief calibrate a raw controller point and clip it to the screen
+     *
+     * @param   cal         pointer to the calibration
+     * @param   x           pointer to x, raw in, calibrated out
+     * @param   y           pointer to y, raw in, calibrated out
+     * @param   width       screen width
+     * @param   height      screen height
+     */
+    void touch_calibration_apply( const touch_calibration_t *cal, int16_t *x, int16_t *y, int16_t width, int16_t height );
+    /**
+     * @brief init a jitter filter
+     *
+     * @param   f           pointer to the filter
+     * @param   latency_ms  time constant in ms, 0 disables the filter
+     */
+    void touch_filter_init( touch_filter_t *f, uint16_t latency_ms );
+    /**
+     * @brief reset the filter on release, the next point is taken as is
+     *
+     * @param   f           pointer to the filter
+     */
+    void touch_filter_reset( touch_filter_t *f );
+    /**
+     * @brief filter a point
+     *
+     * @param   f           pointer to the filter
+     * @param   x           pointer to x, calibrated in, filtered out
+     * @param   y           pointer to y, calibrated in, filtered out
+     * @param   ms          sample time in ms
+     */
+    void touch_filter_push( touch_filter_t *f, int16_t *x, int16_t *y, uint32_t ms );
+    /**
+     * @brief init a gesture recognizer
+     *
+     * @param   g           pointer to the recognizer
+     * @param   width       screen width
+     * @param   height      screen height
+     */
+    void touch_gesture_init( touch_gesture_t *g, int16_t width, int16_t height );
+    /**
+     * @brief add a touched point, may report a long press
+     *
+     * @param   g           pointer to the recognizer
+     * @param   x           calibrated x
+     * @param   y           calibrated y
+     * @param   ms          sample time in ms
+     * @param   event       pointer to an event, set if true is returned
+     *
+     * @return  true if a gesture was recognized
+     */
+    bool touch_gesture_push( touch_gesture_t *g, int16_t x, int16_t y, uint32_t ms, touch_gesture_event_t *event );
+    /**
+     * @brief end a touch, may report a tap or swipe
+     *
+     * @param   g           pointer to the recognizer
+     * @param   ms          release time in ms
+     * @param   event       pointer to an event, set if true is returned
+     *
+     * @return  true if a gesture was recognized
+     */
+    bool touch_gesture_release( touch_gesture_t *g, uint32_t ms, touch_gesture_event_t *event );
+    /**
+     * @brief get the name of a gesture
+     *
+     * @param   type        TOUCH_GESTURE_NONE ... TOUCH_GESTURE_EDGE_BOTTOM
+     *
+     * @return  pointer to the name
+     */
+    const char *touch_gesture_get_name( uint8_t type );
+
+    #ifdef __cplusplus
+    }
+    #endif
+
+#endif // _TOUCH_GESTURE_H
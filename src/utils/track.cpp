@@ -0,0 +1,444 @@
+/****************************************************************************
+ *   Oct 18 21:02:47 2026
+ *   Copyright  2026  My-TTGO-Watch contributors
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#include <string.h>
+#include <math.h>
+
+#include "track.h"
+
+#define TRACK_RECORD_MAX            20                  /** @brief max encoded record size */
+#define TRACK_M_PER_UNIT            0.11132f            /** @brief m per 1/TRACK_DEG_SCALE degree latitude */
+
+enum {
+    TRACK_GPX_HEADER = 0,
+    TRACK_GPX_POINTS,
+    TRACK_GPX_TRAILER,
+    TRACK_GPX_DONE
+};
+
+static int track_put_varint( uint8_t *data, uint64_t value ) {
+    int len = 0;
+
+    while( value >= 0x80 ) {
+        data[ len++ ] = ( value & 0x7f ) | 0x80;
+        value >>= 7;
+    }
+    data[ len++ ] = value;
+    return( len );
+}
+
+static int track_put_zigzag( uint8_t *data, int32_t value ) {
+    return( track_put_varint( data, ( (uint32_t)value << 1 ) ^ (uint32_t)( value >> 31 ) ) );
+}
+
+static bool track_get_varint( FILE *file, uint64_t *value ) {
+    uint64_t result = 0;
+
+    for( int i = 0 ; i < 10 ; i++ ) {
+        int c = fgetc( file );
+        if ( c == EOF ) {
+            return( false );
+        }
+        result |= (uint64_t)( c & 0x7f ) << ( 7 * i );
+        if ( !( c & 0x80 ) ) {
+            *value = result;
+            return( true );
+        }
+    }
+    return( false );
+}
+
+static bool track_get_zigzag( FILE *file, int32_t *value ) {
+    uint64_t zigzag;
+
+    if ( !track_get_varint( file, &zigzag ) ) {
+        return( false );
+    }
+    *value = (int32_t)( ( (uint32_t)zigzag >> 1 ) ^ -( (uint32_t)zigzag & 1 ) );
+    return( true );
+}
+
+bool track_open( track_t *t, const char *filename, float tolerance ) {
+    char magic[ TRACK_MAGIC_SIZE ];
+
+    memset( t, 0, sizeof( track_t ) );
+    strncpy( t->filename, filename, sizeof( t->filename ) - 1 );
+    t->tolerance = tolerance;
+    t->segment_start = true;
+    /*
+     * check the magic of an existing file or start a new one
+     */
+    FILE *file = fopen( filename, "rb" );
+    if ( file ) {
+        size_t len = fread( magic, 1, TRACK_MAGIC_SIZE, file );
+        fclose( file );
+        if ( len == TRACK_MAGIC_SIZE ) {
+            return( memcmp( magic, TRACK_MAGIC, TRACK_MAGIC_SIZE ) == 0 );
+        }
+    }
+    file = fopen( filename, "wb" );
+    if ( !file ) {
+        return( false );
+    }
+    size_t written = fwrite( TRACK_MAGIC, 1, TRACK_MAGIC_SIZE, file );
+    fclose( file );
+    t->stats.bytes_written += written;
+    return( written == TRACK_MAGIC_SIZE );
+}
+
+void track_flush( track_t *t ) {
+    if ( !t->pending_len ) {
+        return;
+    }
+    FILE *file = fopen( t->filename, "ab" );
+    if ( !file ) {
+        return;
+    }
+    size_t written = fwrite( t->pending, 1, t->pending_len, file );
+    fclose( file );
+
+    t->stats.writes++;
+    t->stats.bytes_written += written;
+    t->pending_len = 0;
+}
+
+static void track_encode( track_t *t, const track_point_t *point ) {
+    uint8_t data[ TRACK_RECORD_MAX ];
+    int len = 0;
+
+    /*
+     * a segment starts with an absolute point, time going backwards too
+     */
+    if ( t->segment_start || point->time < t->last.time ) {
+        len += track_put_varint( data + len, ( (uint64_t)point->time << 1 ) | 1 );
+        len += track_put_zigzag( data + len, point->lat );
+        len += track_put_zigzag( data + len, point->lon );
+        len += track_put_zigzag( data + len, point->altitude );
+        t->segment_start = false;
+        t->stats.segments++;
+    }
+    else {
+        len += track_put_varint( data + len, (uint64_t)( point->time - t->last.time ) << 1 );
+        len += track_put_zigzag( data + len, point->lat - t->last.lat );
+        len += track_put_zigzag( data + len, point->lon - t->last.lon );
+        len += track_put_zigzag( data + len, point->altitude - t->last.altitude );
+    }
+    t->last = *point;
+    t->stats.kept++;
+    t->stats.bytes_encoded += len;
+
+    if ( t->pending_len + len > TRACK_PENDING_SIZE ) {
+        track_flush( t );
+        /*
+         * drop the bytes if the file can't be written
+         */
+        t->pending_len = 0;
+    }
+    memcpy( t->pending + t->pending_len, data, len );
+    t->pending_len += len;
+}
+
+/**
+ * @brief distance in m of a point to a line segment, all in local meters
+ */
+static float track_segment_distance( float x, float y, float x1, float y1, float x2, float y2 ) {
+    float dx = x2 - x1;
+    float dy = y2 - y1;
+    float length = dx * dx + dy * dy;
+    float u = length > 0.0f ? ( ( x - x1 ) * dx + ( y - y1 ) * dy ) / length : 0.0f;
+
+    u = u < 0.0f ? 0.0f : ( u > 1.0f ? 1.0f : u );
+    dx = x1 + u * dx - x;
+    dy = y1 + u * dy - y;
+    return( sqrtf( dx * dx + dy * dy ) );
+}
+
+/**
+ * @brief Douglas-Peucker over the window
+ *
+ * @param   keep        set to true for the points to keep, first and last are always kept
+ */
+static void track_douglas_peucker( track_t *t, bool *keep ) {
+    float x[ TRACK_WINDOW ];
+    float y[ TRACK_WINDOW ];
+    uint8_t stack[ TRACK_WINDOW ][ 2 ];
+    int depth = 0;
+
+    if ( t->tolerance <= 0.0f ) {
+        for( int i = 0 ; i < t->count ; i++ ) {
+            keep[ i ] = true;
+        }
+        return;
+    }
+    /*
+     * equirectangular projection around the first point is good
+     * enough for the few km of a window
+     */
+    float scale = cosf( t->window[ 0 ].lat * ( 3.14159265f / 180.0f / TRACK_DEG_SCALE ) ) * TRACK_M_PER_UNIT;
+    for( int i = 0 ; i < t->count ; i++ ) {
+        x[ i ] = ( t->window[ i ].lon - t->window[ 0 ].lon ) * scale;
+        y[ i ] = ( t->window[ i ].lat - t->window[ 0 ].lat ) * TRACK_M_PER_UNIT;
+        keep[ i ] = false;
+    }
+    keep[ 0 ] = true;
+    keep[ t->count - 1 ] = true;
+
+    stack[ depth ][ 0 ] = 0;
+    stack[ depth ][ 1 ] = t->count - 1;
+    depth++;
+    while( depth ) {
+        depth--;
+        int first = stack[ depth ][ 0 ];
+        int last = stack[ depth ][ 1 ];
+        float max = 0.0f;
+        int index = 0;
+
+        for( int i = first + 1 ; i < last ; i++ ) {
+            float distance = track_segment_distance( x[ i ], y[ i ], x[ first ], y[ first ], x[ last ], y[ last ] );
+            if ( distance > max ) {
+                max = distance;
+                index = i;
+            }
+        }
+        if ( max > t->tolerance ) {
+            keep[ index ] = true;
+            stack[ depth ][ 0 ] = first;
+            stack[ depth ][ 1 ] = index;
+            depth++;
+            stack[ depth ][ 0 ] = index;
+            stack[ depth ][ 1 ] = last;
+            depth++;
+        }
+    }
+}
+
+/**
+ * @brief simplify the window and encode the decided points
+ *
+ * @param   final       true to encode all kept points and empty the window,
+ *                      false to keep the part after the last inner point open
+ */
+static void track_simplify( track_t *t, bool final ) {
+    bool keep[ TRACK_WINDOW ];
+    int open = t->count - 1;
+
+    if ( t->count < 2 ) {
+        t->count = final ? 0 : t->count;
+        return;
+    }
+    track_douglas_peucker( t, keep );
+    /*
+     * the segment to the last point may still change with the next
+     * points, it stays in the window from the last inner kept point
+     */
+    if ( !final ) {
+        for( open = t->count - 2 ; open > 0 && !keep[ open ] ; open-- );
+        if ( open == 0 ) {
+            open = t->count - 1;
+        }
+    }
+    for( int i = 1 ; i <= open ; i++ ) {
+        if ( keep[ i ] ) {
+            track_encode( t, &t->window[ i ] );
+        }
+    }
+    if ( final ) {
+        t->count = 0;
+        return;
+    }
+    memmove( &t->window[ 0 ], &t->window[ open ], ( t->count - open ) * sizeof( track_point_t ) );
+    t->count -= open;
+}
+
+void track_add( track_t *t, const track_point_t *point ) {
+    t->stats.points++;
+    /*
+     * the first point of a segment is always kept
+     */
+    if ( t->count == 0 ) {
+        track_encode( t, point );
+        t->window[ t->count++ ] = *point;
+        return;
+    }
+    t->window[ t->count++ ] = *point;
+    if ( t->count == TRACK_WINDOW ) {
+        track_simplify( t, false );
+    }
+}
+
+void track_break( track_t *t ) {
+    track_simplify( t, true );
+    t->segment_start = true;
+}
+
+void track_close( track_t *t ) {
+    track_break( t );
+    track_flush( t );
+}
+
+bool track_reader_open( track_reader_t *r, const char *filename ) {
+    char magic[ TRACK_MAGIC_SIZE ];
+
+    memset( r, 0, sizeof( track_reader_t ) );
+    r->file = fopen( filename, "rb" );
+    if ( !r->file ) {
+        return( false );
+    }
+    if ( fread( magic, 1, TRACK_MAGIC_SIZE, r->file ) != TRACK_MAGIC_SIZE || memcmp( magic, TRACK_MAGIC, TRACK_MAGIC_SIZE ) ) {
+        track_reader_close( r );
+        return( false );
+    }
+    return( true );
+}
+
+bool track_reader_next( track_reader_t *r, track_point_t *point, bool *segment_start ) {
+    uint64_t tag;
+    int32_t lat, lon, altitude;
+
+    if ( !r->file ) {
+        return( false );
+    }
+    if ( !track_get_varint( r->file, &tag ) || !track_get_zigzag( r->file, &lat ) || !track_get_zigzag( r->file, &lon ) || !track_get_zigzag( r->file, &altitude ) ) {
+        return( false );
+    }
+    *segment_start = tag & 1;
+    if ( *segment_start ) {
+        point->time = tag >> 1;
+        point->lat = lat;
+        point->lon = lon;
+        point->altitude = altitude;
+    }
+    else {
+        point->time = r->last.time + ( tag >> 1 );
+        point->lat = r->last.lat + lat;
+        point->lon = r->last.lon + lon;
+        point->altitude = r->last.altitude + altitude;
+    }
+    r->last = *point;
+    r->points++;
+    return( true );
+}
+
+void track_reader_close( track_reader_t *r ) {
+    if ( r->file ) {
+        fclose( r->file );
+        r->file = NULL;
+    }
+}
+
+bool track_gpx_open( track_gpx_t *g, const char *filename ) {
+    memset( g, 0, sizeof( track_gpx_t ) );
+    return( track_reader_open( &g->reader, filename ) );
+}
+
+/**
+ * @brief print a fixed point value with a sign and the given decimals
+ */
+static int track_print_fixed( char *text, size_t size, int32_t value, uint32_t scale, int decimals ) {
+    uint32_t magnitude = value < 0 ? -(uint32_t)value : value;
+    return( snprintf( text, size, "%s%u.%0*u", value < 0 ? "-" : "", (unsigned)( magnitude / scale ), decimals, (unsigned)( magnitude % scale ) ) );
+}
+
+/**
+ * @brief print a point as trkpt, opens a new trkseg on a segment start
+ */
+static int track_gpx_point( track_gpx_t *g, const track_point_t *point, bool segment_start ) {
+    char *text = g->text;
+    size_t size = sizeof( g->text );
+    int len = 0;
+
+    if ( segment_start ) {
+        len += snprintf( text + len, size - len, "%s<trkseg>\n", g->in_segment ? "</trkseg>\n" : "" );
+        g->in_segment = true;
+    }
+    /*
+     * utc date from days since 1970
+     */
+    int32_t days = point->time / 86400;
+    uint32_t seconds = point->time % 86400;
+    days += 719468;
+    int32_t era = days / 146097;
+    uint32_t doe = days - era * 146097;
+    uint32_t yoe = ( doe - doe / 1460 + doe / 36524 - doe / 146096 ) / 365;
+    uint32_t doy = doe - ( 365 * yoe + yoe / 4 - yoe / 100 );
+    uint32_t mp = ( 5 * doy + 2 ) / 153;
+    uint32_t day = doy - ( 153 * mp + 2 ) / 5 + 1;
+    uint32_t month = mp < 10 ? mp + 3 : mp - 9;
+    uint32_t year = yoe + era * 400 + ( month <= 2 );
+
+    len += snprintf( text + len, size - len, "<trkpt lat=\"" );
+    len += track_print_fixed( text + len, size - len, point->lat, TRACK_DEG_SCALE, 6 );
+    len += snprintf( text + len, size - len, "\" lon=\"" );
+    len += track_print_fixed( text + len, size - len, point->lon, TRACK_DEG_SCALE, 6 );
+    len += snprintf( text + len, size - len, "\"><ele>" );
+    len += track_print_fixed( text + len, size - len, point->altitude, 10, 1 );
+    len += snprintf( text + len, size - len, "</ele><time>%04u-%02u-%02uT%02u:%02u:%02uZ</time></trkpt>\n",
+                     (unsigned)year, (unsigned)month, (unsigned)day, (unsigned)( seconds / 3600 ), (unsigned)( seconds / 60 % 60 ), (unsigned)( seconds % 60 ) );
+    return( len );
+}
+
+size_t track_gpx_read( track_gpx_t *g, char *buffer, size_t size ) {
+    size_t len = 0;
+
+    while( len < size ) {
+        if ( g->text_pos == g->text_len ) {
+            track_point_t point;
+            bool segment_start;
+            int text_len = 0;
+
+            g->text_pos = 0;
+            switch( g->state ) {
+                case TRACK_GPX_HEADER:
+                    text_len = snprintf( g->text, sizeof( g->text ), "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+                                                                     "<gpx version=\"1.1\" creator=\"My-TTGO-Watch\" xmlns=\"http://www.topografix.com/GPX/1/1\">\n"
+                                                                     "<trk>\n" );
+                    g->state = TRACK_GPX_POINTS;
+                    break;
+                case TRACK_GPX_POINTS:
+                    if ( track_reader_next( &g->reader, &point, &segment_start ) ) {
+                        text_len = track_gpx_point( g, &point, segment_start || !g->in_segment );
+                        break;
+                    }
+                    g->state = TRACK_GPX_TRAILER;
+                    /* fall through */
+                case TRACK_GPX_TRAILER:
+                    text_len = snprintf( g->text, sizeof( g->text ), "%s</trk>\n</gpx>\n", g->in_segment ? "</trkseg>\n" : "" );
+                    g->state = TRACK_GPX_DONE;
+                    break;
+                default:
+                    g->text_len = 0;
+                    return( len );
+            }
+            g->text_len = text_len < (int)sizeof( g->text ) ? text_len : sizeof( g->text ) - 1;
+        }
+        size_t chunk = g->text_len - g->text_pos;
+        if ( chunk > size - len ) {
+            chunk = size - len;
+        }
+        memcpy( buffer + len, g->text + g->text_pos, chunk );
+        g->text_pos += chunk;
+        len += chunk;
+    }
+    return( len );
+}
+
+void track_gpx_close( track_gpx_t *g ) {
+    track_reader_close( &g->reader );
+}
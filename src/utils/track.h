@@ -0,0 +1,204 @@
+/****************************************************************************
+ *   Oct 18 21:02:47 2026
+ *   Copyright  2026  My-TTGO-Watch contributors
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#ifndef _TRACK_H
+    #define _TRACK_H
+
+    #include <stdint.h>
+    #include <stdbool.h>
+    #include <stddef.h>
+    #include <stdio.h>
+
+    /*
+     * note:    this module only uses stdio and float math, tools/gps_bench.cpp
+     *          builds it on the host.
+     *
+     * append-only binary track file. points are simplified with Douglas-Peucker
+     * over a sliding window before they are written, the window keeps its tail
+     * open so a straight line is not cut at the window border. the file starts
+     * with TRACK_MAGIC, followed by one record per point:
+     *
+     *      varint( time << 1 | 1 ), zigzag( lat ), zigzag( lon ), zigzag( alt )    first point of a segment
+     *      varint( dt << 1 ), zigzag( dlat ), zigzag( dlon ), zigzag( dalt )       delta to the previous point
+     *
+     * a walk at 1 fix per second needs 4-5 bytes per point unsimplified.
+     */
+    #define TRACK_MAGIC                 "TRK1"              /** @brief file magic */
+    #define TRACK_MAGIC_SIZE            4
+    #define TRACK_DEG_SCALE             1000000             /** @brief lat and lon unit, 1e-6 degree or ~0.11m */
+    #define TRACK_WINDOW                64                  /** @brief simplification window in points */
+    #define TRACK_PENDING_SIZE          256                 /** @brief encoded bytes buffered before a file write */
+    #define TRACK_PATH_SIZE             32                  /** @brief max file name length */
+    #define TRACK_GPX_TEXT_SIZE         192                 /** @brief gpx text buffer for one point */
+
+    /**
+     * @brief one track point
+     */
+    typedef struct {
+        uint32_t time;                      /** @brief utc unix time in seconds */
+        int32_t lat;                        /** @brief latitude in 1/TRACK_DEG_SCALE degree */
+        int32_t lon;                        /** @brief longitude in 1/TRACK_DEG_SCALE degree */
+        int32_t altitude;                   /** @brief altitude in dm */
+    } track_point_t;
+
+    /**
+     * @brief track writer statistic
+     */
+    typedef struct {
+        uint32_t points;                    /** @brief points added */
+        uint32_t kept;                      /** @brief points kept by the simplification and encoded */
+        uint32_t segments;                  /** @brief segments started */
+        uint32_t bytes_encoded;             /** @brief encoded bytes */
+        uint32_t bytes_written;             /** @brief bytes written to the file */
+        uint32_t writes;                    /** @brief file writes */
+    } track_stats_t;
+
+    /**
+     * @brief track writer
+     */
+    typedef struct {
+        char filename[ TRACK_PATH_SIZE ];
+        float tolerance;                    /** @brief max distance in m of a dropped point to the simplified track */
+        track_point_t window[ TRACK_WINDOW ];   /** @brief points not decided yet, window[ 0 ] is already encoded */
+        uint16_t count;                     /** @brief points in the window */
+        track_point_t last;                 /** @brief last encoded point, base of the next delta */
+        bool segment_start;                 /** @brief true if the next encoded point starts a segment */
+        uint8_t pending[ TRACK_PENDING_SIZE ];  /** @brief encoded bytes not written yet */
+        uint16_t pending_len;
+        track_stats_t stats;
+    } track_t;
+
+    /**
+     * @brief track file reader
+     */
+    typedef struct {
+        FILE *file;
+        track_point_t last;                 /** @brief last decoded point */
+        uint32_t points;                    /** @brief decoded points */
+    } track_reader_t;
+
+    /**
+     * @brief gpx export state, produces the gpx text in chunks
+     */
+    typedef struct {
+        track_reader_t reader;
+        uint8_t state;                      /** @brief header, points, trailer or done */
+        bool in_segment;                    /** @brief true if a trkseg is open */
+        char text[ TRACK_GPX_TEXT_SIZE ];   /** @brief text not returned yet */
+        uint16_t text_len;
+        uint16_t text_pos;
+    } track_gpx_t;
+
+    #ifdef __cplusplus
+    extern "C" {
+    #endif
+
+    /**
+     * @brief open a track file for appending, creates it if it does not exist
+     *
+     * @param   t           pointer to the track
+     * @param   filename    file name, e.g. "/spiffs/track.bin"
+     * @param   tolerance   max distance in m of a dropped point, 0 keeps all points
+     *
+     * @return  true if success, false if the file can't be created or is no track file
+     */
+    bool track_open( track_t *t, const char *filename, float tolerance );
+    /**
+     * @brief add a point to the track
+     *
+     * @param   t           pointer to the track
+     * @param   point       pointer to the point
+     */
+    void track_add( track_t *t, const track_point_t *point );
+    /**
+     * @brief end the segment, e.g. on a lost fix. the window is simplified
+     * and encoded, the next point starts a new segment
+     *
+     * @param   t           pointer to the track
+     */
+    void track_break( track_t *t );
+    /**
+     * @brief write the encoded bytes to the file, the window stays open
+     *
+     * @param   t           pointer to the track
+     */
+    void track_flush( track_t *t );
+    /**
+     * @brief end the segment and write everything to the file
+     *
+     * @param   t           pointer to the track
+     */
+    void track_close( track_t *t );
+    /**
+     * @brief open a track file for reading
+     *
+     * @param   r           pointer to the reader
+     * @param   filename    file name
+     *
+     * @return  true if success
+     */
+    bool track_reader_open( track_reader_t *r, const char *filename );
+    /**
+     * @brief read the next point, stops at the end or at a truncated record
+     *
+     * @param   r           pointer to the reader
+     * @param   point       pointer to a point
+     * @param   segment_start   pointer to a bool, true if the point starts a segment
+     *
+     * @return  true if a point was read
+     */
+    bool track_reader_next( track_reader_t *r, track_point_t *point, bool *segment_start );
+    /**
+     * @brief close a reader
+     *
+     * @param   r           pointer to the reader
+     */
+    void track_reader_close( track_reader_t *r );
+    /**
+     * @brief open a track file for gpx export
+     *
+     * @param   g           pointer to the export state
+     * @param   filename    file name
+     *
+     * @return  true if success
+     */
+    bool track_gpx_open( track_gpx_t *g, const char *filename );
+    /**
+     * @brief get the next chunk of the gpx text
+     *
+     * @param   g           pointer to the export state
+     * @param   buffer      pointer to the buffer
+     * @param   size        buffer size
+     *
+     * @return  number of bytes, 0 at the end
+     */
+    size_t track_gpx_read( track_gpx_t *g, char *buffer, size_t size );
+    /**
+     * @brief close the gpx export
+     *
+     * @param   g           pointer to the export state
+     */
+    void track_gpx_close( track_gpx_t *g );
+
+    #ifdef __cplusplus
+    }
+    #endif
+
+#endif // _TRACK_H
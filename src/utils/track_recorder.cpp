@@ -0,0 +1,152 @@
+/****************************************************************************
+ *   Oct 18 21:40:12 2026
+ *   Copyright  2026  My-TTGO-Watch contributors
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#include "config.h"
+#include <TTGO.h>
+#include <math.h>
+
+#include "track_recorder.h"
+
+#include "hardware/powermgm.h"
+#include "hardware/gpsctl.h"
+#include "utils/alloc.h"
+
+static track_t *track_recorder = NULL;
+static bool track_recorder_recording = false;
+static uint32_t track_recorder_last_flush = 0;
+static int32_t track_recorder_altitude = 0;
+
+bool track_recorder_gpsctl_event_cb( EventBits_t event, void *arg );
+bool track_recorder_powermgm_event_cb( EventBits_t event, void *arg );
+static void track_recorder_add( gps_data_t *gps_data );
+
+void track_recorder_setup( void ) {
+    /*
+     * the window and the write buffer are ~1.3kB, keep them off the task stacks
+     */
+    track_recorder = (track_t *)MALLOC( sizeof( track_t ) );
+    if ( track_recorder == NULL ) {
+        log_e("track recorder alloc failed");
+        while( true );
+    }
+    memset( track_recorder, 0, sizeof( track_t ) );
+
+    gpsctl_register_cb( GPSCTL_UPDATE_FIX | GPSCTL_NOFIX | GPSCTL_DISABLE, track_recorder_gpsctl_event_cb, "gpsctl track recorder" );
+    powermgm_register_cb( POWERMGM_SHUTDOWN | POWERMGM_RESET, track_recorder_powermgm_event_cb, "powermgm track recorder" );
+}
+
+bool track_recorder_gpsctl_event_cb( EventBits_t event, void *arg ) {
+    if ( !track_recorder_recording ) {
+        return( true );
+    }
+
+    switch( event ) {
+        case GPSCTL_UPDATE_FIX:
+            track_recorder_add( (gps_data_t*)arg );
+            break;
+        case GPSCTL_NOFIX:
+        case GPSCTL_DISABLE:
+            /*
+             * no line between the last point before and the first point after the gap
+             */
+            track_break( track_recorder );
+            break;
+    }
+    return( true );
+}
+
+bool track_recorder_powermgm_event_cb( EventBits_t event, void *arg ) {
+    switch( event ) {
+        case POWERMGM_SHUTDOWN:
+        case POWERMGM_RESET:
+            track_recorder_stop();
+            break;
+    }
+    return( true );
+}
+
+/**
+ * @brief add a fix from the receiver, fake or manual locations are not recorded
+ */
+static void track_recorder_add( gps_data_t *gps_data ) {
+    track_point_t point;
+
+    if ( gps_data->gps_source != GPS_SOURCE_GPS || !( gps_data->updated & GPSCTL_UPDATE_LOCATION ) ) {
+        return;
+    }
+    if ( !gps_data->valid_location || !gps_data->valid_time ) {
+        return;
+    }
+    /*
+     * keep the last altitude when the receiver sends none
+     */
+    if ( gps_data->valid_altitude ) {
+        track_recorder_altitude = lround( gps_data->altitude_meters * 10.0 );
+    }
+    point.time = gps_data->time;
+    point.lat = lround( gps_data->lat * TRACK_DEG_SCALE );
+    point.lon = lround( gps_data->lon * TRACK_DEG_SCALE );
+    point.altitude = track_recorder_altitude;
+    track_add( track_recorder, &point );
+    /*
+     * bound the loss on a crash or an empty battery
+     */
+    if ( point.time - track_recorder_last_flush >= TRACK_RECORDER_FLUSH_INTERVAL ) {
+        track_flush( track_recorder );
+        track_recorder_last_flush = point.time;
+    }
+}
+
+bool track_recorder_start( void ) {
+    if ( track_recorder_recording ) {
+        return( true );
+    }
+    if ( !track_open( track_recorder, TRACK_RECORDER_FILENAME, TRACK_RECORDER_TOLERANCE ) ) {
+        log_e("open track %s failed", TRACK_RECORDER_FILENAME );
+        return( false );
+    }
+    track_recorder_last_flush = 0;
+    track_recorder_recording = true;
+    log_i("track recording started");
+    return( true );
+}
+
+void track_recorder_stop( void ) {
+    if ( !track_recorder_recording ) {
+        return;
+    }
+    track_close( track_recorder );
+    track_recorder_recording = false;
+    log_i("track recording stopped, %d of %d points kept, %d bytes written", track_recorder->stats.kept, track_recorder->stats.points, track_recorder->stats.bytes_written );
+}
+
+bool track_recorder_is_recording( void ) {
+    return( track_recorder_recording );
+}
+
+void track_recorder_clear( void ) {
+    track_recorder_stop();
+    remove( TRACK_RECORDER_FILENAME );
+    memset( &track_recorder->stats, 0, sizeof( track_stats_t ) );
+}
+
+const track_stats_t *track_recorder_get_stats( void ) {
+    return( &track_recorder->stats );
+}
@@ -0,0 +1,61 @@
+/****************************************************************************
+ *   Oct 18 21:40:12 2026
+ *   Copyright  2026  My-TTGO-Watch contributors
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#ifndef _TRACK_RECORDER_H
+    #define _TRACK_RECORDER_H
+
+    #include "utils/track.h"
+
+    #define TRACK_RECORDER_FILENAME         "/spiffs/track.bin"
+    #define TRACK_RECORDER_TOLERANCE        5.0f            /** @brief max distance in m of a dropped point */
+    #define TRACK_RECORDER_FLUSH_INTERVAL   300             /** @brief max seconds between file writes while recording */
+
+    /**
+     * @brief setup the track recorder
+     */
+    void track_recorder_setup( void );
+    /**
+     * @brief start recording gps fixes, appends to the track file
+     *
+     * @return  true if success
+     */
+    bool track_recorder_start( void );
+    /**
+     * @brief stop recording and write the open segment to the file
+     */
+    void track_recorder_stop( void );
+    /**
+     * @brief check if the recorder is running
+     *
+     * @return  true if recording
+     */
+    bool track_recorder_is_recording( void );
+    /**
+     * @brief delete the track file, stops recording
+     */
+    void track_recorder_clear( void );
+    /**
+     * @brief get the track writer statistic of the current recording
+     *
+     * @return  pointer to the statistic
+     */
+    const track_stats_t *track_recorder_get_stats( void );
+
+#endif // _TRACK_RECORDER_H
@@ -20,6 +20,7 @@
  *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
  */
 
+#include <memory>
 #include <WiFi.h>
 #include <WiFiClient.h>
 #include <Update.h>
@@ -32,7 +33,28 @@
 #include "webserver.h"
 #include "config.h"
 #include "gui/screenshot.h"
+#include "gui/img_cache.h"
+#include "gui/background.h"
+#include "gui/glyph_cache.h"
+#include "gui/png_decoder/png_decoder.h"
 #include "hardware/touch.h"
+#include "hardware/bma.h"
+#include "hardware/bma_fifo.h"
+#include "hardware/scheduler.h"
+#include "hardware/display.h"
+#include "hardware/framebuffer.h"
+#include "hardware/gpsctl.h"
+#include "hardware/powermgm.h"
+#include "utils/bench.h"
+#include "utils/boot_profiler.h"
+#include "utils/history.h"
+#include "utils/battery_runtime.h"
+#include "utils/track_recorder.h"
+#include "gui/mainbar/mainbar.h"
+#include "utils/worker.h"
+#include "utils/basejsonconfig.h"
+#include "utils/alloc.h"
+#include "utils/json_psram_allocator.h"
 
 AsyncWebServer asyncserver( WEBSERVERPORT );
 TaskHandle_t _WEBSERVER_Task;
@@ -98,6 +120,15 @@ TaskHandle_t _WEBSERVER_Task;
     "\n </script>"
     "\n </body></html>";
 
+/**
+ * @brief print a 64 bit counter, String has no 64 bit constructor
+ */
+static String webserver_u64( uint64_t value ) {
+    char text[ 24 ];
+    snprintf( text, sizeof( text ), "%llu", value );
+    return( String( text ) );
+}
+
 void handleUpdate( AsyncWebServerRequest *request, const String& filename, size_t index, uint8_t *data, size_t len, bool final) {
 
   if (!index){
@@ -130,7 +161,8 @@ void handleUpdate( AsyncWebServerRequest *request, const String& filename, size_
     } else {
       Serial.println("Update complete");
       Serial.flush();
-      ESP.restart();
+      powermgm_set_event( POWERMGM_RESET_REQUEST );
+      scheduler_wakeup();
     }
   }
 }
@@ -163,11 +195,21 @@ void asyncwebserver_start(void){
       "<ul>"
       "<li><a target=\"cont\" href=\"/info\">/info</a> - Display information about the device"
       "<li><a target=\"cont\" href=\"/memory\">/memory</a> - Display memory information"
-      "<li><a target=\"cont\" href=\"/battery\">/battery</a> - Display battery charging information"
-      "<li><a target=\"cont\" href=\"/touch\">/touch</a> - Display touch screen information"
+      "<li><a target=\"cont\" href=\"/metrics\">/metrics</a> - Heap and allocation metrics, prometheus text format"
+      "<li><a target=\"cont\" href=\"/metrics.json\">/metrics.json</a> - Heap and allocation metrics as json"
+      "<li><a target=\"cont\" href=\"/framebuffer\">/framebuffer</a> - Display frame rate, set the band height with ?band_height=20"
+      "<li><a target=\"cont\" href=\"/bench\">/bench</a> - Display subsystem timings, answers with 500 on regression"
+      "<li><a target=\"cont\" href=\"/boot\">/boot</a> - Display boot stage timings and free memory"
+      "<li><a target=\"cont\" href=\"/tiles\">/tiles</a> - Display all tiles with activate and hibernate callback timings"
+      "<li><a target=\"cont\" href=\"/activity\">/activity</a> - Display activity classification and accelerometer fifo statistic"
+      "<li><a target=\"cont\" href=\"/history\">/history</a> - Display step, activity and battery history, select with ?series=steps&tier=hour"
+      "<li><a target=\"cont\" href=\"/battery\">/battery</a> - Display battery charging information and the predicted runtime"
+      "<li><a target=\"cont\" href=\"/touch\">/touch</a> - Display touch screen information and pipeline statistic"
+      "<li><a target=\"cont\" href=\"/gps\">/gps</a> - Display gps receiver and track recorder statistic"
+      "<li><a target=\"_blank\" href=\"/track.gpx\">/track.gpx</a> - Download the recorded track as gpx"
       "<li><a target=\"cont\" href=\"/network\">/network</a> - Display network information"
       "<li><a target=\"cont\" href=\"/shot\">/shot</a> - Capture a screen shot"
-      "<li><a target=\"cont\" href=\"/screen.data\">/screen.data</a> - Retrieve the image in RGB565 format, open it with gimp"
+      "<li><a target=\"cont\" href=\"/screen.png\">/screen.png</a> - Retrieve the last screen shot saved from the quickbar"
       "<li><a target=\"_blank\" href=\"/edit\">/edit</a> - View, edit, upload, and delete files"
       "</ul>"
       "<p><div style=\"color:red;\">Caution:</div> Use these with care:"
@@ -182,6 +224,22 @@ void asyncwebserver_start(void){
     uint32_t FreeSketchSpace = ESP.getFreeSketchSpace();
     uint32_t SketchFull = ESP.getSketchSize() + FreeSketchSpace;
 
+    worker_stats_t worker_stats;
+    worker_get_stats( &worker_stats );
+    screenshot_stats_t screenshot_stats;
+    screenshot_get_stats( &screenshot_stats );
+    img_cache_stats_t img_cache_stats;
+    img_cache_get_stats( &img_cache_stats );
+    png_decoder_stats_t png_decoder_stats;
+    png_decoder_get_stats( &png_decoder_stats );
+    background_stats_t background_stats;
+    background_get_stats( &background_stats );
+    String glyph_cache_info = "";
+    for( int32_t i = 0 ; i < glyph_cache_get_fonts() ; i++ ) {
+        const glyph_cache_font_stats_t *font_stats = glyph_cache_get_font_stats( i );
+        glyph_cache_info += (String) "\t<b>Glyph cache " + font_stats->name + ": </b>" + font_stats->hits + " hits, " + font_stats->misses + " misses, " + font_stats->entrys + " glyphs, " + font_stats->bytes + " bytes<br>";
+    }
+
     String html = (String) "<html><head><meta charset=\"utf-8\"></head><body><h3>Information</h3>" +
                   "<b><u>Memory</u></b><br>" +
                   "<b>Heap size: </b>" + ESP.getHeapSize() + "<br>" +
@@ -194,6 +252,15 @@ void asyncwebserver_start(void){
                   "\t<b>Battery voltage: </b>" + TTGOClass::getWatch()->power->getBattVoltage() / 1000 + " Volts" + "<br>" +
 
                   "\t<b>Uptime: </b>" + millis() / 1000 + "<br>" +
+                  "\t<b>Loop wakeups: </b>" + scheduler_get_wakeups_per_minute() + " per minute<br>" +
+                  "\t<b>Loop idle: </b>" + scheduler_get_idle_percent() + "%<br>" +
+                  "\t<b>Config writes: </b>" + BaseJsonConfig::getBytesWritten() + " bytes, " + basejsonconfig_get_bytes_per_day() + " bytes per day<br>" +
+                  "\t<b>Worker jobs: </b>" + worker_stats.queued + " queued, " + worker_stats.max_queued + " max, " + worker_stats.done + " done, " + worker_stats.cancelled + " cancelled, " + worker_stats.rejected + " rejected, " + worker_stats.stack_min_free + " bytes stack free<br>" +
+                  "\t<b>Screenshot: </b>" + screenshot_stats.png_size + " bytes png, " + screenshot_stats.peak_ram + " bytes peak ram, " + screenshot_stats.capture_ms + " ms, " + screenshot_stats.spiffs_bytes + " bytes saved<br>" +
+                  "\t<b>Image cache: </b>" + img_cache_stats.hits + " hits, " + img_cache_stats.misses + " misses, " + img_cache_stats.entrys + " entrys, " + img_cache_stats.bytes + " bytes, " + img_cache_stats.evictions + " evictions, " + img_cache_stats.rejected + " rejected, " + webserver_u64( img_cache_stats.saved_us / 1000 ) + " ms decode saved, " + webserver_u64( img_cache_stats.decode_us / 1000 ) + " ms decoded<br>" +
+                  "\t<b>PNG decoder: </b>" + png_decoder_stats.streamed + " row streamed, " + png_decoder_stats.on_demand + " on demand, " + png_decoder_stats.lodepng + " lodepng, " + png_decoder_stats.stream_bytes + " / " + png_decoder_stats.lodepng_bytes + " bytes transient ( stream / lodepng )<br>" +
+                  "\t<b>Background: </b>" + ( background_stats.baked ? "pre-baked" : "builtin or png" ) + ", " + background_stats.bytes + " bytes, " + background_stats.load_us + " us load, " + background_stats.bake_us / 1000 + " ms bake, " + background_stats.bakes + " bakes<br>" +
+                  glyph_cache_info +
                   "<br><b><u>Chip</u></b>" +
                   "<br><b>SdkVersion: </b>" + String(ESP.getSdkVersion()) + "<br>" +
                   "<b>CpuFreq: </b>" + String(ESP.getCpuFreqMHz()) + " MHz<br>" +
@@ -234,8 +301,234 @@ void asyncwebserver_start(void){
     request->send(200, "text/html", html);
   });
 
+  asyncserver.on("/metrics", HTTP_GET, [](AsyncWebServerRequest *request) {
+    alloc_region_stats_t stats;
+    alloc_site_t site;
+    String text = "# TYPE watch_heap_size_bytes gauge\n"
+                  "# TYPE watch_heap_free_bytes gauge\n"
+                  "# TYPE watch_heap_min_free_bytes gauge\n"
+                  "# TYPE watch_heap_largest_free_block_bytes gauge\n"
+                  "# TYPE watch_heap_fragmentation_percent gauge\n"
+                  "# TYPE watch_heap_live_bytes gauge\n"
+                  "# TYPE watch_heap_peak_bytes gauge\n"
+                  "# TYPE watch_heap_allocs_total counter\n";
+
+    for( int32_t region = 0 ; region < ALLOC_REGIONS ; region++ ) {
+        alloc_get_region_stats( (alloc_region_t)region, &stats );
+        String label = (String) "{region=\"" + alloc_get_region_name( (alloc_region_t)region ) + "\"} ";
+        text += (String) "watch_heap_size_bytes" + label + stats.size + "\n" +
+                "watch_heap_free_bytes" + label + stats.free + "\n" +
+                "watch_heap_min_free_bytes" + label + stats.min_free + "\n" +
+                "watch_heap_largest_free_block_bytes" + label + stats.largest_free_block + "\n" +
+                "watch_heap_fragmentation_percent" + label + stats.fragmentation + "\n";
+        if ( alloc_tracking_enabled() ) {
+            text += (String) "watch_heap_live_bytes" + label + stats.live_bytes + "\n" +
+                    "watch_heap_peak_bytes" + label + stats.peak_bytes + "\n" +
+                    "watch_heap_allocs_total" + label + stats.allocs + "\n";
+        }
+    }
+
+    if ( alloc_tracking_enabled() ) {
+        text += (String) "# TYPE watch_alloc_untracked_total counter\n" +
+                "watch_alloc_untracked_total " + alloc_get_untracked() + "\n" +
+                "# TYPE watch_alloc_site_overflows_total counter\n" +
+                "watch_alloc_site_overflows_total " + alloc_get_site_overflows() + "\n" +
+                "# TYPE watch_alloc_site_allocs_total counter\n"
+                "# TYPE watch_alloc_site_frees_total counter\n"
+                "# TYPE watch_alloc_site_live_bytes gauge\n"
+                "# TYPE watch_alloc_site_peak_bytes gauge\n";
+        for( int32_t i = 0 ; i < alloc_get_sites() ; i++ ) {
+            if ( !alloc_get_site( i, &site ) ) {
+                continue;
+            }
+            String label = (String) "{site=\"" + site.file + ":" + site.line + "\",region=\"" + alloc_get_region_name( site.region ) + "\"} ";
+            text += (String) "watch_alloc_site_allocs_total" + label + site.allocs + "\n" +
+                    "watch_alloc_site_frees_total" + label + site.frees + "\n" +
+                    "watch_alloc_site_live_bytes" + label + site.live_bytes + "\n" +
+                    "watch_alloc_site_peak_bytes" + label + site.peak_bytes + "\n";
+        }
+    }
+    request->send( 200, "text/plain; version=0.0.4", text );
+  });
+
+  asyncserver.on("/metrics.json", HTTP_GET, [](AsyncWebServerRequest *request) {
+    alloc_region_stats_t stats;
+    alloc_site_t site;
+    SpiRamJsonDocument doc( 1024 + alloc_get_sites() * 192 );
+
+    doc["tracking"] = alloc_tracking_enabled();
+    doc["untracked"] = alloc_get_untracked();
+    doc["site_overflows"] = alloc_get_site_overflows();
+    for( int32_t region = 0 ; region < ALLOC_REGIONS ; region++ ) {
+        alloc_get_region_stats( (alloc_region_t)region, &stats );
+        JsonObject heap = doc["regions"].createNestedObject( alloc_get_region_name( (alloc_region_t)region ) );
+        heap["size"] = stats.size;
+        heap["free"] = stats.free;
+        heap["min_free"] = stats.min_free;
+        heap["largest_free_block"] = stats.largest_free_block;
+        heap["fragmentation"] = stats.fragmentation;
+        heap["live"] = stats.live_bytes;
+        heap["peak"] = stats.peak_bytes;
+        heap["allocs"] = stats.allocs;
+    }
+    JsonArray sites = doc.createNestedArray("sites");
+    for( int32_t i = 0 ; i < alloc_get_sites() ; i++ ) {
+        if ( !alloc_get_site( i, &site ) ) {
+            continue;
+        }
+        JsonObject entry = sites.createNestedObject();
+        entry["file"] = site.file;
+        entry["line"] = site.line;
+        entry["region"] = alloc_get_region_name( site.region );
+        entry["allocs"] = site.allocs;
+        entry["frees"] = site.frees;
+        entry["live"] = site.live_bytes;
+        entry["peak"] = site.peak_bytes;
+    }
+
+    String json;
+    serializeJson( doc, json );
+    doc.clear();
+    request->send( 200, "application/json", json );
+  });
+
+  asyncserver.on("/framebuffer", HTTP_GET, [](AsyncWebServerRequest *request) {
+    framebuffer_stats_t stats;
+
+    if ( request->hasParam("band_height") ) {
+        display_set_band_height( request->getParam("band_height")->value().toInt() );
+        display_save_config();
+    }
+    framebuffer_get_stats( &stats );
+    String text = (String) "band_height\t" + framebuffer_get_band_height() + "\n" +
+                  "frames\t" + stats.frames + "\n" +
+                  "fps\t" + stats.fps + "\n" +
+                  "spi_bound_fps\t" + stats.spi_bound_fps + "\n" +
+                  "swipe_fps\t" + stats.swipe_fps + "\n" +
+                  "render_ns_px\t" + stats.render_ns_px + "\n" +
+                  "invalidated_px\t" + webserver_u64( stats.invalidated_px ) + "\n" +
+                  "pushed_px\t" + webserver_u64( stats.pushed_px ) + "\n" +
+                  "skipped_px\t" + webserver_u64( stats.skipped_px ) + "\n" +
+                  "spi_bytes\t" + webserver_u64( stats.spi_bytes ) + "\n" +
+                  "last_frame_invalidated_px\t" + stats.last_frame.invalidated_px + "\n" +
+                  "last_frame_pushed_px\t" + stats.last_frame.pushed_px + "\n" +
+                  "last_frame_skipped_px\t" + stats.last_frame.skipped_px + "\n" +
+                  "last_frame_flushes\t" + stats.last_frame.flushes + "\n" +
+                  "last_frame_spi_bytes\t" + stats.last_frame.spi_bytes + "\n";
+    request->send( 200, "text/plain", text );
+  });
+
+  asyncserver.on("/bench", HTTP_GET, [](AsyncWebServerRequest *request) {
+    String text = (String) "id\tcount\tmin_us\tavg_us\tmax_us\tbudget_us\tstate\n";
+
+    for( int32_t i = 0 ; i < bench_get_entrys() ; i++ ) {
+        const bench_entry_t *entry = bench_get_entry( i );
+        uint32_t avg = entry->count ? entry->total_us / entry->count : 0;
+        text += (String) entry->id + "\t" + entry->count + "\t" + ( entry->count ? entry->min_us : 0 ) + "\t" + avg + "\t" + entry->max_us + "\t" + entry->budget_us + "\t" +
+                ( ( entry->budget_us == BENCH_NO_BUDGET || avg <= entry->budget_us ) ? "ok" : "regression" ) + "\n";
+    }
+    if ( bench_get_overflows() ) {
+        text += (String) "# " + bench_get_overflows() + " registrations failed, bench table full\n";
+    }
+    request->send( bench_check() ? 200 : 500, "text/plain", text );
+  });
+
+  asyncserver.on("/boot", HTTP_GET, [](AsyncWebServerRequest *request) {
+    String text = (String) "stage\tt_ms\tdelta_ms\theap\tpsram\n";
+    uint32_t last = 0;
+
+    for( int32_t i = 0 ; i < boot_profiler_get_marks() ; i++ ) {
+        const boot_profiler_mark_t *mark = boot_profiler_get_mark( i );
+        text += (String) mark->stage + "\t" + mark->us / 1000 + "\t" + ( mark->us - last ) / 1000 + "\t" + mark->heap + "\t" + mark->psram + "\n";
+        last = mark->us;
+    }
+    text += (String) "idle\t" + millis() + "\t\t" + ESP.getFreeHeap() + "\t" + ESP.getFreePsram() + "\n";
+    request->send( 200, "text/plain", text );
+  });
+
+  asyncserver.on("/tiles", HTTP_GET, [](AsyncWebServerRequest *request) {
+    String text = (String) "tile\tid\tx\ty\tactivations\tactivate_us\tactivate_max_us\thibernate_us\thibernate_max_us\n";
+
+    for( uint32_t i = 0 ; i < mainbar_get_tile_entrys() ; i++ ) {
+        lv_tile_t tile;
+        if ( !mainbar_get_tile( i, &tile ) ) {
+            break;
+        }
+        text += (String) i + "\t" + ( tile.id ? tile.id : "" ) + "\t" + tile.x + "\t" + tile.y + "\t" + tile.activations + "\t" + tile.activate_us + "\t" + tile.activate_max_us + "\t" + tile.hibernate_us + "\t" + tile.hibernate_max_us + "\n";
+    }
+    request->send( 200, "text/plain", text );
+  });
+
+  asyncserver.on("/activity", HTTP_GET, [](AsyncWebServerRequest *request) {
+    const activity_classifier_t *ac = bma_get_activity_classifier();
+    const bma_fifo_stats_t *fifo_stats = bma_fifo_get_stats();
+
+    String text = (String) "fifo: " + ( bma_fifo_is_enabled() ? "enabled" : "disabled" ) + "\n" +
+                  "activity: " + activity_classifier_get_name( ac->activity ) + "\n" +
+                  "last window: mean " + ac->features.mean_mg + "mg, std " + ac->features.std_mg + "mg, cadence " + ac->features.cadence + "/100Hz, gravity " +
+                  ac->features.gravity_mg[ 0 ] + "/" + ac->features.gravity_mg[ 1 ] + "/" + ac->features.gravity_mg[ 2 ] + "mg\n" +
+                  "windows: " + ac->windows + "\n" +
+                  "fifo: " + fifo_stats->drains + " drains, " + fifo_stats->frames + " frames, " + fifo_stats->overruns + " overruns, " + fifo_stats->errors + " i2c errors\n" +
+                  "cpu: " + bma_get_activity_cpu_us() + " us per second of data\n\n" +
+                  "activity\tseconds\n";
+    for( int i = 0 ; i < ACTIVITY_NUM ; i++ ) {
+        text += (String) activity_classifier_get_name( i ) + "\t" + ac->seconds[ i ] + "\n";
+    }
+    request->send( 200, "text/plain", text );
+  });
+
+  asyncserver.on("/history", HTTP_GET, [](AsyncWebServerRequest *request) {
+    static const char *tier_names[ TIMESERIES_TIERS ] = { "minute", "hour", "day" };
+    int series = HISTORY_STEPS;
+    int tier = TIMESERIES_DAY;
+
+    if ( request->hasParam("series") ) {
+        for( int i = 0 ; i < HISTORY_NUM ; i++ ) {
+            if ( request->getParam("series")->value() == history_get_name( i ) ) {
+                series = i;
+            }
+        }
+    }
+    if ( request->hasParam("tier") ) {
+        for( int i = 0 ; i < TIMESERIES_TIERS ; i++ ) {
+            if ( request->getParam("tier")->value() == tier_names[ i ] ) {
+                tier = i;
+            }
+        }
+    }
+
+    String text = (String) "series\tsamples\tdropped\tbuckets\tencoded\twritten\twrites\trotations\n";
+    for( int i = 0 ; i < HISTORY_NUM ; i++ ) {
+        const timeseries_stats_t *stats = history_get_stats( i );
+        text += (String) history_get_name( i ) + "\t" + stats->samples + "\t" + stats->dropped + "\t" + stats->buckets + "\t" + stats->bytes_encoded + "\t" +
+                stats->bytes_written + "\t" + stats->writes + "\t" + stats->rotations + "\n";
+    }
+
+    uint32_t now = history_get_local_time();
+    timeseries_point_t *points = (timeseries_point_t*)MALLOC( sizeof( timeseries_point_t ) * WEBSERVER_HISTORY_POINTS );
+    if ( !now || !points ) {
+        text += "\nno time or memory\n";
+        request->send( 200, "text/plain", text );
+        if ( points ) {
+            free( points );
+        }
+        return;
+    }
+    int32_t count = history_query( series, tier, now - timeseries_get_interval( tier ) * WEBSERVER_HISTORY_POINTS, now, points, WEBSERVER_HISTORY_POINTS );
+    text += (String) "\n" + history_get_name( series ) + " per " + tier_names[ tier ] + "\ntime\tvalue\n";
+    for( int32_t i = 0 ; i < count ; i++ ) {
+        text += (String) points[ i ].time + "\t" + points[ i ].value + "\n";
+    }
+    free( points );
+    request->send( 200, "text/plain", text );
+  });
+
   asyncserver.on("/battery", HTTP_GET, [](AsyncWebServerRequest *request) {
     TTGOClass * ttgo = TTGOClass::getWatch();
+    discharge_model_t *dm = battery_runtime_get_model();
+    uint8_t order[ DISCHARGE_MODEL_MAX_LOADS ];
+    float drain[ DISCHARGE_MODEL_MAX_LOADS ];
+    discharge_model_rank( dm, order, drain );
 
     String html = (String) "<html><head><meta charset=\"utf-8\"></head><body><h3>Battery Details</h3>" +
                   "<b>Battery voltage: </b>" + ttgo->power->getBattVoltage() / 1000 + " Volts" + "<br>" +
@@ -245,15 +538,25 @@ void asyncwebserver_start(void){
                   "<b>Current Discharge: </b>" + ttgo->power->getBattDischargeCurrent() + "<br>" +
                   "<b>Fuel Gauge: </b>" + ttgo->power->getBattPercentage() + "%" + "<br>" +
                   "<b>Calculated: </b>" + ttgo->power->getCoulombData() + "mAh remaining" + "<br>" +
-
-                  "<br><b><u>System</u></b><br>" +
-                  "<b>Uptime: </b>" + millis() / 1000 + "<br>" +
-                  "</body></html>";
+                  "<br><b><u>Discharge model</u></b><br>" +
+                  "<b>Predicted runtime: </b>" + battery_runtime_get_runtime() / 60 + " min" + "<br>" +
+                  "<b>Predicted current now: </b>" + battery_runtime_get_current() + " mA" + "<br>" +
+                  "<b>Average current: </b>" + dm->mean + " mA, prediction error " + dm->error + " mA, " + dm->updates + " intervals" + "<br>" +
+                  "<table><tr><th>load</th><th>mA</th><th>usage %</th><th>drain mA</th></tr>";
+    for( int i = 0 ; i < dm->loads ; i++ ) {
+        html += (String) "<tr><td>" + battery_runtime_get_load_name( order[ i ] ) + "</td><td>" + dm->current[ order[ i ] ] + "</td><td>" +
+                dm->mix[ order[ i ] ] * 100.0f + "</td><td>" + drain[ i ] + "</td></tr>";
+    }
+    html += (String) "</table>" +
+            "<br><b><u>System</u></b><br>" +
+            "<b>Uptime: </b>" + millis() / 1000 + "<br>" +
+            "</body></html>";
     request->send(200, "text/html", html);
   });
 
   asyncserver.on("/touch", HTTP_GET, [](AsyncWebServerRequest *request) {
     TTGOClass * ttgo = TTGOClass::getWatch();
+    const touch_stats_t *stats = touch_get_stats();
 
     String html;
     if ( touch_lock_take() ) {
@@ -267,6 +570,14 @@ void asyncwebserver_start(void){
                     "<b>Active period: </b>" + ttgo->touch->getActivePeriod() + "<br>" +
                     "<b>Monitor period: </b>" + ttgo->touch->getMonitorPeriod() + "<br>" +
 
+                    "<br><b><u>Pipeline</u></b><br>" +
+                    "<b>Touches: </b>" + stats->touches + ", " + stats->touched_ms + " ms touched" + "<br>" +
+                    "<b>Samples: </b>" + stats->samples + ", " + stats->overruns + " overruns" + "<br>" +
+                    "<b>Events: </b>" + stats->events + ", " + ( stats->touched_ms ? stats->events * 1000.0f / stats->touched_ms : 0.0f ) + " per touched second" + "<br>" +
+                    "<b>Gestures: </b>" + stats->gestures + "<br>" +
+                    "<b>Interrupt to lvgl: </b>" + stats->latency_us + " us avg, " + stats->latency_max_us + " us max" + "<br>" +
+                    "<b>Filter latency: </b>" + touch_get_filter_latency() + " ms" + "<br>" +
+
                     "<br><b><u>System</u></b><br>" +
                     "<b>Uptime: </b>" + millis() / 1000 + "<br>" +
                     "</body></html>";
@@ -277,6 +588,53 @@ void asyncwebserver_start(void){
     request->send(200, "text/html", html);
   });
 
+  asyncserver.on("/gps", HTTP_GET, [](AsyncWebServerRequest *request) {
+    const gpsctl_stats_t *stats = gpsctl_get_stats();
+    const track_stats_t *track_stats = track_recorder_get_stats();
+
+    String html = (String) "<html><head><meta charset=\"utf-8\"></head><body><h3>GPS Receiver</h3>" +
+                  "<b>Bytes: </b>" + stats->nmea.bytes + ", " + stats->uart_overruns + " uart overruns" + "<br>" +
+                  "<b>Sentences: </b>" + stats->nmea.sentences + ", " + stats->nmea.decoded + " decoded" + "<br>" +
+                  "<b>Errors: </b>" + stats->nmea.checksum_errors + " checksum, " + stats->nmea.overruns + " too long" + "<br>" +
+                  "<b>Fixes: </b>" + stats->nmea.epochs + ", " + stats->events + " events" + "<br>" +
+                  "<b>Parse time: </b>" + (uint32_t)( stats->nmea.epochs ? stats->parse_us / stats->nmea.epochs : 0 ) + " us per fix" + "<br>" +
+
+                  "<br><b><u>Track recorder</u></b><br>" +
+                  "<b>Recording: </b>" + ( track_recorder_is_recording() ? "yes" : "no" ) + "<br>" +
+                  "<b>Points: </b>" + track_stats->points + ", " + track_stats->kept + " kept, " + track_stats->segments + " segments" + "<br>" +
+                  "<b>Bytes: </b>" + track_stats->bytes_encoded + " encoded, " + track_stats->bytes_written + " written in " + track_stats->writes + " writes" + "<br>" +
+
+                  "<br><b><u>System</u></b><br>" +
+                  "<b>Uptime: </b>" + millis() / 1000 + "<br>" +
+                  "</body></html>";
+    request->send(200, "text/html", html);
+  });
+
+  asyncserver.on("/track.gpx", HTTP_GET, [](AsyncWebServerRequest *request) {
+    /*
+     * the gpx text is produced while sending, a long track never sits in memory
+     */
+    track_gpx_t *gpx = (track_gpx_t *)MALLOC( sizeof( track_gpx_t ) );
+    if ( gpx == NULL ) {
+        request->send(500, "text/plain", "out of memory");
+        return;
+    }
+    if ( !track_gpx_open( gpx, TRACK_RECORDER_FILENAME ) ) {
+        free( gpx );
+        request->send(404, "text/plain", "no track recorded");
+        return;
+    }
+    request->onDisconnect( [gpx]() {
+        track_gpx_close( gpx );
+        free( gpx );
+    });
+    AsyncWebServerResponse *response = request->beginChunkedResponse( "application/gpx+xml", [gpx]( uint8_t *buffer, size_t maxLen, size_t index ) -> size_t {
+        return( track_gpx_read( gpx, (char *)buffer, maxLen ) );
+    });
+    response->addHeader( "Content-Disposition", "attachment; filename=track.gpx" );
+    request->send( response );
+  });
+
   asyncserver.on("/temp", HTTP_GET, [](AsyncWebServerRequest *request) {
     TTGOClass * ttgo = TTGOClass::getWatch();
 
@@ -307,9 +665,38 @@ void asyncwebserver_start(void){
   });
 
   asyncserver.on("/shot", HTTP_GET, [](AsyncWebServerRequest * request) {
-    request->send(200, "text/plain", "screen is taken\r\n" );
-    screenshot_take();
-    screenshot_save();
+    /*
+     * the screenshot is taken in the wakeup loop, wait for it and choose the
+     * status from the result
+     */
+    if ( powermgm_get_event( POWERMGM_STANDBY ) ) {
+        request->send( 503, "text/plain", "watch in standby, no screenshot" );
+        return;
+    }
+    if ( screenshot_is_pending() ) {
+        request->send( 409, "text/plain", "screenshot already in progress" );
+        return;
+    }
+    uint32_t shot = screenshot_request();
+    uint8_t *png = NULL;
+    int32_t len;
+    while( ( len = screenshot_copy( shot, &png ) ) == SCREENSHOT_BUSY ) {
+        delay( 10 );
+    }
+    if ( len == 0 ) {
+        request->send( 500, "text/plain", "screenshot failed" );
+        return;
+    }
+    /*
+     * the copy is freed with the response
+     */
+    std::shared_ptr<uint8_t> copy( png, free );
+    AsyncWebServerResponse *response = request->beginResponse( "image/png", len, [ copy, len ]( uint8_t *buffer, size_t maxLen, size_t index ) -> size_t {
+      size_t bytes = len - index < maxLen ? len - index : maxLen;
+      memcpy( buffer, copy.get() + index, bytes );
+      return( bytes );
+    });
+    request->send( response );
   });
 
   asyncserver.addHandler(new SPIFFSEditor(SPIFFS));
@@ -383,7 +770,8 @@ void asyncwebserver_start(void){
   asyncserver.on("/reset", HTTP_GET, []( AsyncWebServerRequest * request ) {
     request->send(200, "text/plain", "Reset\r\n" );
     delay(3000);
-    ESP.restart();    
+    powermgm_set_event( POWERMGM_RESET_REQUEST );
+    scheduler_wakeup();
   });
 
   asyncserver.on("/update", HTTP_GET, [](AsyncWebServerRequest * request) {
@@ -26,6 +26,7 @@
 
     #define WEBSERVERPORT   80
     #define UPNPPORT        80
+    #define WEBSERVER_HISTORY_POINTS    512     /** @brief max points per /history request */
 
     #define DEV_NAME        "My-Watch" 
     #define DEV_INFO        "Watch based on ESP32 from Espressif Systems"
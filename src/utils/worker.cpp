@@ -0,0 +1,227 @@
+/****************************************************************************
+ *   Oct 18 13:52:10 2026
+ *   Copyright  2026  My-TTGO-Watch contributors
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#include "config.h"
+#include <TTGO.h>
+#include <esp_timer.h>
+
+#include "worker.h"
+#include "bench.h"
+
+#include "hardware/powermgm.h"
+#include "hardware/scheduler.h"
+
+static worker_job_t worker_jobs[ WORKER_MAX_JOBS ];
+static worker_stats_t worker_stats;
+static QueueHandle_t worker_queue[ WORKER_PRIOS ];
+static QueueHandle_t worker_done_queue = NULL;
+static SemaphoreHandle_t worker_pending = NULL;
+static int32_t worker_bench_wait = -1;
+portMUX_TYPE DRAM_ATTR workerMux = portMUX_INITIALIZER_UNLOCKED;
+
+static void worker_Task( void * pvParameters );
+bool worker_powermgm_loop_cb( EventBits_t event, void *arg );
+
+void worker_setup( void ) {
+    worker_stats.stack_min_free = WORKER_STACK_SIZE;
+    /*
+     * all queues can hold every job slot, so a send never fails
+     */
+    for ( int32_t prio = 0 ; prio < WORKER_PRIOS ; prio++ ) {
+        worker_queue[ prio ] = xQueueCreate( WORKER_MAX_JOBS, sizeof( int32_t ) );
+    }
+    worker_done_queue = xQueueCreate( WORKER_MAX_JOBS, sizeof( int32_t ) );
+    worker_pending = xSemaphoreCreateCounting( WORKER_MAX_JOBS, 0 );
+    if ( worker_done_queue == NULL || worker_pending == NULL ) {
+        log_e("worker queue alloc failed");
+        while( true );
+    }
+
+    for ( int32_t i = 0 ; i < WORKER_TASKS ; i++ ) {
+        xTaskCreate(    worker_Task,                /* Function to implement the task */
+                        "worker Task",              /* Name of the task */
+                        WORKER_STACK_SIZE,          /* Stack size in bytes */
+                        NULL,                       /* Task input parameter */
+                        WORKER_TASK_PRIO,           /* Priority of the task */
+                        NULL );                     /* Task handle. */
+    }
+    worker_bench_wait = bench_register( "worker queue wait", BENCH_NO_BUDGET );
+    powermgm_register_loop_cb( POWERMGM_STANDBY | POWERMGM_SILENCE_WAKEUP | POWERMGM_WAKEUP, worker_powermgm_loop_cb, "worker loop" );
+}
+
+int32_t worker_submit( const char *id, WORKER_JOB_FUNC job_func, WORKER_DONE_FUNC done_func, void *arg, int32_t prio ) {
+    int32_t slot = WORKER_NO_JOB;
+
+    if ( worker_pending == NULL || job_func == NULL ) {
+        log_e("worker not ready, can't submit: %s", id );
+        return( WORKER_NO_JOB );
+    }
+    if ( prio < 0 || prio >= WORKER_PRIOS ) {
+        prio = WORKER_PRIO_NORMAL;
+    }
+    /*
+     * get a free job slot
+     */
+    portENTER_CRITICAL( &workerMux );
+    for ( int32_t i = 0 ; i < WORKER_MAX_JOBS ; i++ ) {
+        if ( !worker_jobs[ i ].active ) {
+            slot = i;
+            worker_jobs[ i ].active = true;
+            worker_jobs[ i ].generation++;
+            worker_stats.queued++;
+            if ( worker_stats.queued > worker_stats.max_queued ) {
+                worker_stats.max_queued = worker_stats.queued;
+            }
+            break;
+        }
+    }
+    if ( slot == WORKER_NO_JOB ) {
+        worker_stats.rejected++;
+    }
+    portEXIT_CRITICAL( &workerMux );
+
+    if ( slot == WORKER_NO_JOB ) {
+        log_e("worker queue full, can't submit: %s", id );
+        return( WORKER_NO_JOB );
+    }
+
+    worker_job_t *job = &worker_jobs[ slot ];
+    job->id = id;
+    job->job_func = job_func;
+    job->done_func = done_func;
+    job->arg = arg;
+    job->prio = prio;
+    job->result = WORKER_CANCELLED;
+    job->cancel = false;
+    job->bench = bench_register( id, BENCH_NO_BUDGET );
+    job->queued_us = esp_timer_get_time();
+
+    xQueueSend( worker_queue[ prio ], &slot, 0 );
+    xSemaphoreGive( worker_pending );
+    log_d("job %s queued, prio %d", id, prio );
+
+    return( ( job->generation << 8 ) | slot );
+}
+
+/**
+ * @brief get a job from an handle
+ *
+ * @return  pointer to the job or NULL if the job is already finished
+ */
+static worker_job_t *worker_get_job( int32_t handle ) {
+    if ( handle == WORKER_NO_JOB ) {
+        return( NULL );
+    }
+    int32_t slot = handle & 0xff;
+    if ( slot >= WORKER_MAX_JOBS ) {
+        return( NULL );
+    }
+    worker_job_t *job = &worker_jobs[ slot ];
+    if ( !job->active || job->generation != ( ( handle >> 8 ) & 0xffff ) ) {
+        return( NULL );
+    }
+    return( job );
+}
+
+bool worker_cancel( int32_t handle ) {
+    worker_job_t *job = worker_get_job( handle );
+
+    if ( job == NULL ) {
+        return( false );
+    }
+    job->cancel = true;
+    return( true );
+}
+
+bool worker_is_cancelled( worker_job_t *job ) {
+    return( job->cancel );
+}
+
+void worker_get_stats( worker_stats_t *stats ) {
+    portENTER_CRITICAL( &workerMux );
+    *stats = worker_stats;
+    portEXIT_CRITICAL( &workerMux );
+}
+
+static void worker_Task( void * pvParameters ) {
+    int32_t slot;
+
+    while( true ) {
+        xSemaphoreTake( worker_pending, portMAX_DELAY );
+        /*
+         * get the next job, highest priority first
+         */
+        slot = WORKER_NO_JOB;
+        for ( int32_t prio = 0 ; prio < WORKER_PRIOS ; prio++ ) {
+            if ( xQueueReceive( worker_queue[ prio ], &slot, 0 ) == pdTRUE ) {
+                break;
+            }
+        }
+        if ( slot == WORKER_NO_JOB ) {
+            continue;
+        }
+
+        worker_job_t *job = &worker_jobs[ slot ];
+        uint64_t start = esp_timer_get_time();
+        bench_add( worker_bench_wait, start - job->queued_us );
+
+        if ( !job->cancel ) {
+            log_i("start job %s, heap: %d", job->id, ESP.getFreeHeap() );
+            job->result = job->job_func( job );
+            bench_add( job->bench, esp_timer_get_time() - start );
+            uint32_t stack_free = uxTaskGetStackHighWaterMark( NULL );
+            portENTER_CRITICAL( &workerMux );
+            if ( stack_free < worker_stats.stack_min_free ) {
+                worker_stats.stack_min_free = stack_free;
+            }
+            portEXIT_CRITICAL( &workerMux );
+            log_i("finish job %s, heap: %d, stack free: %d", job->id, ESP.getFreeHeap(), stack_free );
+        }
+        /*
+         * hand over to the gui thread for completion
+         */
+        xQueueSend( worker_done_queue, &slot, portMAX_DELAY );
+        scheduler_wakeup();
+    }
+}
+
+bool worker_powermgm_loop_cb( EventBits_t event, void *arg ) {
+    int32_t slot;
+
+    while( xQueueReceive( worker_done_queue, &slot, 0 ) == pdTRUE ) {
+        worker_job_t *job = &worker_jobs[ slot ];
+
+        if ( job->done_func ) {
+            job->done_func( job );
+        }
+
+        portENTER_CRITICAL( &workerMux );
+        if ( job->cancel ) {
+            worker_stats.cancelled++;
+        }
+        else {
+            worker_stats.done++;
+        }
+        worker_stats.queued--;
+        job->active = false;
+        portEXIT_CRITICAL( &workerMux );
+    }
+    return( true );
+}
@@ -0,0 +1,125 @@
+/****************************************************************************
+ *   Oct 18 13:52:10 2026
+ *   Copyright  2026  My-TTGO-Watch contributors
+ ****************************************************************************/
+
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#ifndef _WORKER_H
+    #define _WORKER_H
+
+    #include <stdint.h>
+
+    #define WORKER_TASKS            2               /** @brief number of worker tasks */
+    #define WORKER_STACK_SIZE       5000            /** @brief stack size in bytes for each worker task, the size the per request sync tasks ran with, see stack_min_free on /info */
+    #define WORKER_TASK_PRIO        1               /** @brief freertos priority of the worker tasks */
+    #define WORKER_MAX_JOBS         16              /** @brief max number of queued and running jobs */
+    #define WORKER_NET_SETTLE_MS    250             /** @brief delay before the first request of a network sync job, the ip stack settles after a wifi connect */
+
+    #define WORKER_PRIO_HIGH        0               /** @brief job priority for user requested jobs */
+    #define WORKER_PRIO_NORMAL      1               /** @brief job priority for automatic jobs */
+    #define WORKER_PRIO_LOW         2               /** @brief job priority for background jobs */
+    #define WORKER_PRIOS            3               /** @brief number of job priorities */
+
+    #define WORKER_NO_JOB           -1              /** @brief invalid job handle */
+    #define WORKER_CANCELLED        -1              /** @brief job result if the job was cancelled before start */
+
+    struct worker_job_t;
+    /**
+     * @brief job function, called on a worker task
+     *
+     * @param   job         pointer to the job
+     *
+     * @return  job result, stored in job->result
+     */
+    typedef int32_t ( * WORKER_JOB_FUNC ) ( struct worker_job_t *job );
+    /**
+     * @brief completion function, called on the gui thread after the job is finished or cancelled
+     *
+     * @param   job         pointer to the job
+     */
+    typedef void ( * WORKER_DONE_FUNC ) ( struct worker_job_t *job );
+
+    /**
+     * @brief worker job structure
+     */
+    typedef struct worker_job_t {
+        const char *id;                     /** @brief job id, also used as bench id */
+        WORKER_JOB_FUNC job_func;           /** @brief job function */
+        WORKER_DONE_FUNC done_func;         /** @brief completion function or NULL */
+        void *arg;                          /** @brief user argument */
+        int32_t prio;                       /** @brief job priority */
+        int32_t result;                     /** @brief return value from the job function or WORKER_CANCELLED */
+        volatile bool cancel;               /** @brief cancel requested, long running jobs should check this */
+        bool active;                        /** @brief job slot in use */
+        uint16_t generation;                /** @brief slot generation, part of the job handle */
+        int32_t bench;                      /** @brief bench handle for the job runtime */
+        uint64_t queued_us;                 /** @brief time in us when the job was queued */
+    } worker_job_t;
+
+    /**
+     * @brief worker statistic
+     */
+    typedef struct {
+        uint32_t queued;                    /** @brief current number of queued and running jobs */
+        uint32_t max_queued;                /** @brief max number of queued and running jobs */
+        uint32_t done;                      /** @brief number of finished jobs */
+        uint32_t cancelled;                 /** @brief number of cancelled jobs */
+        uint32_t rejected;                  /** @brief number of rejected jobs, queue full */
+        uint32_t stack_min_free;            /** @brief lowest free stack in bytes seen after a job on any worker task */
+    } worker_stats_t;
+
+    /**
+     * @brief start the worker tasks
+     */
+    void worker_setup( void );
+    /**
+     * @brief queue a job
+     *
+     * @param   id          job id
+     * @param   job_func    job function, called on a worker task
+     * @param   done_func   completion function, called on the gui thread, can be NULL
+     * @param   arg         user argument
+     * @param   prio        WORKER_PRIO_HIGH, WORKER_PRIO_NORMAL or WORKER_PRIO_LOW
+     *
+     * @return  job handle or WORKER_NO_JOB if failed
+     */
+    int32_t worker_submit( const char *id, WORKER_JOB_FUNC job_func, WORKER_DONE_FUNC done_func, void *arg, int32_t prio );
+    /**
+     * @brief request cancellation of a job, a queued job is not started,
+     * a running job has to check worker_is_cancelled(). the completion function is always called
+     *
+     * @param   handle      job handle
+     *
+     * @return  true if the job was found, false if the job is already finished
+     */
+    bool worker_cancel( int32_t handle );
+    /**
+     * @brief check inside a job function if the job should stop
+     *
+     * @param   job         pointer to the job
+     *
+     * @return  true if cancelled
+     */
+    bool worker_is_cancelled( worker_job_t *job );
+    /**
+     * @brief get the worker statistic
+     *
+     * @param   stats       pointer to a worker_stats_t structure
+     */
+    void worker_get_stats( worker_stats_t *stats );
+
+#endif // _WORKER_H
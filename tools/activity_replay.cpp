@@ -0,0 +1,131 @@
+/*
+ * Replay recorded accelerometer CSV files through the activity classifier
+ * from src/utils/activity_classifier.cpp and report the classification
+ * accuracy and the CPU time per second of data.
+ *
+ * build:   g++ -O2 tools/activity_replay.cpp -o activity_replay
+ * usage:   activity_replay walk.csv [run.csv ...]
+ *
+ * one sample per line at 25Hz: x_mg,y_mg,z_mg[,label]
+ * label is one of still, walk, run, cycle, sleep. lines that don't start
+ * with a number are skipped. without labels only the timing is reported.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../src/utils/activity_classifier.cpp"
+
+static int label_to_activity( const char *label ) {
+    for( int i = 0 ; i < ACTIVITY_NUM ; i++ ) {
+        if ( !strncmp( label, activity_classifier_get_name( i ), strlen( activity_classifier_get_name( i ) ) ) ) {
+            return( i );
+        }
+    }
+    return( -1 );
+}
+
+static uint64_t now_ns( void ) {
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return( (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec );
+}
+
+int main( int argc, char **argv ) {
+    uint32_t confusion[ ACTIVITY_NUM ][ ACTIVITY_NUM ] = {};
+    uint64_t total_ns = 0;
+    uint64_t total_samples = 0;
+
+    if ( argc < 2 ) {
+        fprintf( stderr, "usage: %s file.csv [file.csv ...]\n", argv[ 0 ] );
+        return( 1 );
+    }
+
+    for( int file = 1 ; file < argc ; file++ ) {
+        static activity_classifier_t ac;
+        uint32_t window_labels[ ACTIVITY_NUM ] = {};
+        uint32_t samples = 0;
+        uint64_t ns = 0;
+        char line[ 256 ];
+
+        FILE *f = fopen( argv[ file ], "r" );
+        if ( !f ) {
+            perror( argv[ file ] );
+            return( 1 );
+        }
+        activity_classifier_init( &ac );
+
+        while( fgets( line, sizeof( line ), f ) ) {
+            char *p = line;
+            long value[ 3 ];
+            int label = -1;
+
+            if ( !( *p == '-' || ( *p >= '0' && *p <= '9' ) ) ) {
+                continue;
+            }
+            for( int axis = 0 ; axis < 3 ; axis++ ) {
+                value[ axis ] = strtol( p, &p, 10 );
+                while( *p == ',' || *p == ' ' || *p == '\t' ) {
+                    p++;
+                }
+            }
+            if ( *p ) {
+                label = label_to_activity( p );
+            }
+            if ( label >= 0 ) {
+                window_labels[ label ]++;
+            }
+
+            uint64_t start = now_ns();
+            activity_classifier_push( &ac, value[ 0 ], value[ 1 ], value[ 2 ] );
+            ns += now_ns() - start;
+            samples++;
+            /*
+             * compare the reported activity with the majority label of the window
+             */
+            if ( ac.samples == 0 ) {
+                int truth = -1;
+                for( int i = 0 ; i < ACTIVITY_NUM ; i++ ) {
+                    if ( window_labels[ i ] && ( truth < 0 || window_labels[ i ] > window_labels[ truth ] ) ) {
+                        truth = i;
+                    }
+                }
+                if ( truth >= 0 ) {
+                    confusion[ truth ][ ac.activity ]++;
+                }
+                memset( window_labels, 0, sizeof( window_labels ) );
+            }
+        }
+        fclose( f );
+
+        printf( "%s: %u samples, %u windows, %.1fs data, %.2f us cpu per second of data\n", argv[ file ], samples, ac.windows,
+                (double)samples / ACTIVITY_SAMPLE_RATE, samples ? (double)ns / 1000.0 / ( (double)samples / ACTIVITY_SAMPLE_RATE ) : 0.0 );
+        total_ns += ns;
+        total_samples += samples;
+    }
+
+    uint32_t correct = 0;
+    uint32_t labeled = 0;
+    printf( "\ntruth \\ classified" );
+    for( int i = 0 ; i < ACTIVITY_NUM ; i++ ) {
+        printf( "\t%s", activity_classifier_get_name( i ) );
+    }
+    printf( "\n" );
+    for( int truth = 0 ; truth < ACTIVITY_NUM ; truth++ ) {
+        printf( "%s\t\t", activity_classifier_get_name( truth ) );
+        for( int i = 0 ; i < ACTIVITY_NUM ; i++ ) {
+            printf( "\t%u", confusion[ truth ][ i ] );
+            labeled += confusion[ truth ][ i ];
+        }
+        correct += confusion[ truth ][ truth ];
+        printf( "\n" );
+    }
+    if ( labeled ) {
+        printf( "\naccuracy: %.1f%% of %u labeled windows\n", 100.0 * correct / labeled, labeled );
+    }
+    if ( total_samples ) {
+        printf( "cpu: %.2f us per second of data\n", (double)total_ns / 1000.0 / ( (double)total_samples / ACTIVITY_SAMPLE_RATE ) );
+    }
+    return( 0 );
+}
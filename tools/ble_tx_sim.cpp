@@ -0,0 +1,339 @@
+/*
+ * Run the ble tx engine from src/utils/ble_tx.cpp over a simulated link
+ * and report throughput and msg latency for several ATT MTUs and
+ * connection intervals, next to the old fixed 20 byte / 20ms sender.
+ * Before that the link handling is checked: msg queued between connect
+ * and the ready link are kept and sent, msg of a lost link are dropped,
+ * long msg are reassembled and credits come back without completions.
+ *
+ * build:   g++ -O2 tools/ble_tx_sim.cpp -o ble_tx_sim
+ * usage:   ble_tx_sim
+ *
+ * the link sends SIM_LL_PER_INTERVAL link layer packets with 27 bytes
+ * payload per connection interval, a notify needs 4 bytes l2cap and
+ * 3 bytes att header on top. the completion of a notify wakes the loop
+ * like ESP_GATTS_CONF_EVT does on the watch, otherwise the loop sleeps
+ * until the deadline blectl_loop sets.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <deque>
+#include <string>
+
+#include "../src/utils/ble_tx.cpp"
+
+#define SIM_LL_PAYLOAD          27          /* link layer payload without data length extension */
+#define SIM_LL_PER_INTERVAL     6           /* link layer packets per connection interval */
+#define SIM_L2CAP_HEADER        4
+#define SIM_OLD_CHUNK           20          /* old BLECTL_CHUNKSIZE */
+#define SIM_OLD_DELAY           20          /* old BLECTL_CHUNKDELAY in ms */
+#define SIM_BULK_MSG            2048        /* bulk sync msg size */
+#define SIM_BULK_COUNT          16
+#define SIM_CONTROL_MSG         64          /* control reply size */
+#define SIM_CONTROL_EVERY       500         /* ms between control replies */
+
+static int failed = 0;
+
+static ble_tx_msg_t control[ 8 ];
+static ble_tx_msg_t bulk[ 16 ];
+
+static void check( const char *name, bool ok ) {
+    printf( "%-44s %s\n", name, ok ? "ok" : "FAILED" );
+    failed += ok ? 0 : 1;
+}
+
+static ble_tx_msg_t make_msg( ble_tx_t *tx, uint32_t len, char fill, uint64_t now_us ) {
+    ble_tx_msg_t msg;
+
+    msg.data = (char *)malloc( len + 1 );
+    for( uint32_t i = 0 ; i < len ; i++ ) {
+        msg.data[ i ] = fill + i % 23;
+    }
+    msg.data[ len ] = 0;
+    msg.len = len;
+    msg.link = tx->link;
+    msg.queued_us = now_us;
+    return( msg );
+}
+
+/**
+ * @brief poll until idle or wait, every chunk is completed at once. collect
+ * the chunks into sent and count done and dropped msg
+ */
+static void drain( ble_tx_t *tx, uint32_t now, std::string *sent, uint32_t *done, uint32_t *dropped ) {
+    ble_tx_out_t out;
+    ble_tx_result_t result;
+
+    while( ( result = ble_tx_poll( tx, now, &out ) ) != BLE_TX_IDLE && result != BLE_TX_WAIT ) {
+        if ( result == BLE_TX_CHUNK ) {
+            sent->append( out.chunk, out.len );
+            ble_tx_complete( tx );
+        }
+        else {
+            *( result == BLE_TX_DONE ? done : dropped ) += 1;
+            free( out.msg.data );
+        }
+    }
+}
+
+static void check_link( void ) {
+    ble_tx_t tx;
+    std::string sent;
+    uint32_t done = 0, dropped = 0;
+
+    ble_tx_init( &tx, control, 8, bulk, 16 );
+    /*
+     * connect, the client is still authenticating
+     */
+    ble_tx_new_link( &tx );
+    ble_tx_msg_t hello = make_msg( &tx, 7, 'a', 0 );
+    std::string hello_data( hello.data, hello.len );
+    check( "push while authenticating", ble_tx_push( &tx, BLE_TX_CONTROL, &hello ) );
+    drain( &tx, 0, &sent, &done, &dropped );
+    check( "kept until the link is ready", sent.empty() && done == 0 && dropped == 0 );
+    tx.ready = true;
+    drain( &tx, 1, &sent, &done, &dropped );
+    check( "sent on the first poll after connect", sent == hello_data && done == 1 && dropped == 0 );
+    /*
+     * a long msg in mtu sized chunks
+     */
+    tx.mtu = 185;
+    sent.clear();
+    ble_tx_msg_t big = make_msg( &tx, 10000, 'A', 0 );
+    std::string big_data( big.data, big.len );
+    ble_tx_push( &tx, BLE_TX_BULK, &big );
+    drain( &tx, 2, &sent, &done, &dropped );
+    check( "10000 byte msg reassembled", sent == big_data && done == 2 );
+    /*
+     * control overtakes queued bulk msg
+     */
+    sent.clear();
+    ble_tx_msg_t b = make_msg( &tx, 10, 'b', 0 );
+    ble_tx_msg_t c = make_msg( &tx, 10, 'c', 0 );
+    std::string order = std::string( c.data, c.len ) + std::string( b.data, b.len );
+    ble_tx_push( &tx, BLE_TX_BULK, &b );
+    ble_tx_push( &tx, BLE_TX_CONTROL, &c );
+    drain( &tx, 3, &sent, &done, &dropped );
+    check( "control lane before bulk lane", sent == order );
+    /*
+     * disconnect in the middle of a msg, with more msg queued
+     */
+    ble_tx_out_t out;
+    ble_tx_msg_t half = make_msg( &tx, 1000, 'h', 0 );
+    ble_tx_msg_t queued = make_msg( &tx, 10, 'q', 0 );
+    ble_tx_push( &tx, BLE_TX_BULK, &half );
+    ble_tx_push( &tx, BLE_TX_BULK, &queued );
+    ble_tx_poll( &tx, 4, &out );
+    uint32_t old_link = tx.link;
+    ble_tx_new_link( &tx );
+    tx.ready = false;
+    ble_tx_msg_t late = make_msg( &tx, 10, 'l', 0 );
+    late.link = old_link;
+    check( "push for a lost link refused", !ble_tx_push( &tx, BLE_TX_BULK, &late ) );
+    free( late.data );
+    done = dropped = 0;
+    sent.clear();
+    drain( &tx, 5, &sent, &done, &dropped );
+    check( "lost link msg dropped while not ready", dropped == 2 && done == 0 && sent.empty() );
+    /*
+     * no completion events, credits come back after BLE_TX_TIMEOUT
+     */
+    ble_tx_new_link( &tx );
+    tx.ready = true;
+    ble_tx_msg_t slow = make_msg( &tx, 1000, 's', 0 );
+    ble_tx_push( &tx, BLE_TX_BULK, &slow );
+    uint32_t chunks = 0;
+    while( ble_tx_poll( &tx, 10, &out ) == BLE_TX_CHUNK ) {
+        chunks++;
+    }
+    bool waiting = chunks == BLE_TX_CREDITS && ble_tx_poll( &tx, 10 + BLE_TX_TIMEOUT, &out ) == BLE_TX_WAIT;
+    check( "credits restored after the timeout", waiting && ble_tx_poll( &tx, 11 + BLE_TX_TIMEOUT, &out ) == BLE_TX_CHUNK && tx.timeouts == 1 );
+    done = dropped = 0;
+    sent.clear();
+    tx.credits = BLE_TX_CREDITS;
+    drain( &tx, 20 + BLE_TX_TIMEOUT, &sent, &done, &dropped );
+}
+
+/**
+ * @brief notify in flight on the simulated link
+ */
+typedef struct {
+    uint32_t ll_packets;
+} sim_notify_t;
+
+typedef struct {
+    uint32_t bulk_ms;
+    double bulk_bytes_per_s;
+    double control_avg_ms;
+    double control_max_ms;
+    uint32_t wakeups;
+} sim_result_t;
+
+/**
+ * @brief send SIM_BULK_COUNT bulk msg with a control reply every SIM_CONTROL_EVERY ms,
+ * old sends SIM_OLD_CHUNK bytes every SIM_OLD_DELAY ms from one fifo
+ */
+static sim_result_t simulate( uint16_t mtu, uint32_t interval_ms, bool old ) {
+    ble_tx_t tx;
+    std::deque<sim_notify_t> link;
+    sim_result_t result = { 0, 0, 0, 0, 0 };
+    uint32_t bulk_queued = 0, bulk_done = 0, control_queued = 0, control_count = 0;
+    uint64_t bulk_bytes = 0;
+    uint32_t next_loop = 0, next_interval = interval_ms, next_control = SIM_CONTROL_EVERY;
+    double control_sum = 0;
+    std::deque<ble_tx_msg_t> fifo;
+    uint32_t fifo_pos = 0;
+
+    ble_tx_init( &tx, control, 8, bulk, 16 );
+    ble_tx_new_link( &tx );
+    tx.ready = true;
+    tx.mtu = mtu;
+
+    uint32_t now;
+    for( now = 0 ; ( bulk_done < SIM_BULK_COUNT || control_count < control_queued ) && now < 600000 ; now++ ) {
+        bool wake = false;
+        /*
+         * queue bulk msg as the lane has room, a control reply every SIM_CONTROL_EVERY
+         */
+        while( bulk_queued < SIM_BULK_COUNT && ( old ? fifo.size() < 16 : tx.lane[ BLE_TX_BULK ].count < 16 ) ) {
+            ble_tx_msg_t msg = make_msg( &tx, SIM_BULK_MSG, 'B', (uint64_t)now * 1000 );
+            if ( old ) {
+                fifo.push_back( msg );
+            }
+            else {
+                ble_tx_push( &tx, BLE_TX_BULK, &msg );
+            }
+            bulk_queued++;
+            wake = true;
+        }
+        if ( now >= next_control && bulk_done < SIM_BULK_COUNT ) {
+            ble_tx_msg_t msg = make_msg( &tx, SIM_CONTROL_MSG, 'C', (uint64_t)now * 1000 );
+            if ( old ) {
+                fifo.push_back( msg );
+            }
+            else {
+                ble_tx_push( &tx, BLE_TX_CONTROL, &msg );
+            }
+            next_control += SIM_CONTROL_EVERY;
+            control_queued++;
+            wake = true;
+        }
+        /*
+         * connection event, completions wake the loop
+         */
+        if ( now >= next_interval ) {
+            uint32_t budget = SIM_LL_PER_INTERVAL;
+            while( !link.empty() && link.front().ll_packets <= budget ) {
+                budget -= link.front().ll_packets;
+                link.pop_front();
+                ble_tx_complete( &tx );
+                wake = true;
+            }
+            if ( !link.empty() ) {
+                link.front().ll_packets -= budget;
+            }
+            next_interval += interval_ms;
+        }
+        if ( old ) {
+            /*
+             * the old loop: one chunk, then delay
+             */
+            if ( now < next_loop || fifo.empty() ) {
+                continue;
+            }
+            result.wakeups++;
+            ble_tx_msg_t *msg = &fifo.front();
+            uint32_t len = msg->len - fifo_pos < SIM_OLD_CHUNK ? msg->len - fifo_pos : SIM_OLD_CHUNK;
+            link.push_back( { ( len + BLE_TX_ATT_HEADER + SIM_L2CAP_HEADER + SIM_LL_PAYLOAD - 1 ) / SIM_LL_PAYLOAD } );
+            fifo_pos += len;
+            if ( fifo_pos >= msg->len ) {
+                double ms = now - msg->queued_us / 1000.0;
+                if ( msg->data[ 0 ] == 'C' ) {
+                    control_sum += ms;
+                    control_count++;
+                    result.control_max_ms = ms > result.control_max_ms ? ms : result.control_max_ms;
+                }
+                else {
+                    bulk_done++;
+                    bulk_bytes += msg->len;
+                    result.bulk_ms = now;
+                }
+                free( msg->data );
+                fifo.pop_front();
+                fifo_pos = 0;
+            }
+            next_loop = now + SIM_OLD_DELAY;
+            continue;
+        }
+        if ( !wake && now < next_loop ) {
+            continue;
+        }
+        /*
+         * blectl_loop
+         */
+        result.wakeups++;
+        ble_tx_out_t out;
+        ble_tx_result_t r;
+        next_loop = now + 1000;
+        while( ( r = ble_tx_poll( &tx, now, &out ) ) != BLE_TX_IDLE ) {
+            if ( r == BLE_TX_WAIT ) {
+                next_loop = now + BLE_TX_TIMEOUT;
+                break;
+            }
+            if ( r == BLE_TX_CHUNK ) {
+                link.push_back( { ( out.len + BLE_TX_ATT_HEADER + SIM_L2CAP_HEADER + SIM_LL_PAYLOAD - 1 ) / SIM_LL_PAYLOAD } );
+            }
+            else if ( r == BLE_TX_DONE ) {
+                double ms = now - out.msg.queued_us / 1000.0;
+                if ( out.msg.data[ 0 ] == 'C' ) {
+                    control_sum += ms;
+                    control_count++;
+                    result.control_max_ms = ms > result.control_max_ms ? ms : result.control_max_ms;
+                }
+                else {
+                    bulk_done++;
+                    bulk_bytes += out.msg.len;
+                    result.bulk_ms = now;
+                }
+                free( out.msg.data );
+            }
+        }
+    }
+    result.bulk_bytes_per_s = bulk_bytes * 1000.0 / result.bulk_ms;
+    result.control_avg_ms = control_count ? control_sum / control_count : 0;
+    /*
+     * free what is left
+     */
+    std::string sent;
+    uint32_t done = 0, dropped = 0;
+    ble_tx_new_link( &tx );
+    drain( &tx, now, &sent, &done, &dropped );
+    for( auto &msg : fifo ) {
+        free( msg.data );
+    }
+    return( result );
+}
+
+int main( void ) {
+    static const uint16_t mtus[] = { 23, 185, 247 };
+    static const uint32_t intervals[] = { 15, 30, 50 };
+
+    check_link();
+
+    printf( "\n%d x %d byte bulk msg, %d byte control reply every %dms, %d ll packets per interval\n\n",
+            SIM_BULK_COUNT, SIM_BULK_MSG, SIM_CONTROL_MSG, SIM_CONTROL_EVERY, SIM_LL_PER_INTERVAL );
+    printf( "%-10s %4s %9s %12s %12s %12s %10s\n", "sender", "mtu", "interval", "bulk B/s", "ctrl avg ms", "ctrl max ms", "wakeups/s" );
+    for( uint32_t i = 0 ; i < sizeof( intervals ) / sizeof( intervals[ 0 ] ) ; i++ ) {
+        sim_result_t r = simulate( BLE_TX_DEFAULT_MTU, intervals[ i ], true );
+        double seconds = SIM_BULK_COUNT * SIM_BULK_MSG / r.bulk_bytes_per_s;
+        printf( "%-10s %4d %7dms %12.0f %12.1f %12.1f %10.1f\n", "old 20/20", 23, intervals[ i ], r.bulk_bytes_per_s, r.control_avg_ms, r.control_max_ms, r.wakeups / seconds );
+        for( uint32_t m = 0 ; m < sizeof( mtus ) / sizeof( mtus[ 0 ] ) ; m++ ) {
+            r = simulate( mtus[ m ], intervals[ i ], false );
+            seconds = SIM_BULK_COUNT * SIM_BULK_MSG / r.bulk_bytes_per_s;
+            printf( "%-10s %4d %7dms %12.0f %12.1f %12.1f %10.1f\n", "ble_tx", mtus[ m ], intervals[ i ], r.bulk_bytes_per_s, r.control_avg_ms, r.control_max_ms, r.wakeups / seconds );
+        }
+    }
+    printf( "\n%s\n", failed ? "FAILED" : "all ok" );
+    return( failed ? 1 : 0 );
+}
@@ -0,0 +1,194 @@
+/*
+ * Drive the discharge model from src/utils/discharge_model.cpp with a
+ * synthetic load trace and compare the learned currents and the runtime
+ * prediction with the simulated truth.
+ *
+ * build:   g++ -O2 tools/discharge_sim.cpp -o discharge_sim
+ * usage:   discharge_sim [days] [seed]
+ *
+ * the trace simulates one second steps of a watch with the loads of
+ * src/utils/battery_runtime.h. the battery is charged in the evening
+ * and the coulomb counter is quantized like the AXP202 at 200Hz. after
+ * the learning days full batteries are drained without charging and
+ * the runtime predicted at full charge is compared to the real runtime.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "../src/utils/discharge_model.cpp"
+
+#define SIM_CAPACITY        350.0           /* mAh */
+#define SIM_INTERVAL        600             /* seconds per model update, same as BATTERY_RUNTIME_INTERVAL */
+#define SIM_RUNS            10              /* validation discharges */
+#define SIM_COUNT_MAH       ( 65536.0 * 0.5 / 3600.0 / 200.0 )
+
+enum { STANDBY = 0, SILENCE_WAKEUP, WAKEUP, WIFI, BLE, GPS, SOUND, LOADS };
+
+static const char *names[ LOADS ] = { "standby", "silence wakeup", "wakeup", "wifi", "ble", "gps", "sound" };
+static const float truth[ LOADS ] = { 4.5f, 28.0f, 72.0f, 55.0f, 6.0f, 38.0f, 11.0f };
+static const float prior[ LOADS ] = { 5.0f, 30.0f, 80.0f, 60.0f, 10.0f, 30.0f, 10.0f };
+
+static double rnd( void ) {
+    return( (double)rand() / RAND_MAX );
+}
+
+/*
+ * the synthetic user: wakeups every few minutes at daytime, a silence
+ * wakeup every 5 minutes for sync, wifi while syncing, ble connected
+ * most of the time, a gps run on some evenings and sound on some days
+ */
+typedef struct {
+    uint32_t awake_until;
+    uint32_t silence_until;
+    uint32_t gps_until;
+    bool ble;
+    bool sound_day;
+} user_t;
+
+static uint32_t user_step( user_t *u, uint32_t t ) {
+    uint32_t hour = ( t / 3600 ) % 24;
+    uint32_t mask = 0;
+
+    if ( t % 86400 == 0 ) {
+        u->sound_day = rnd() < 0.5;
+    }
+    if ( t % 60 == 0 && rnd() < 0.05 ) {
+        u->ble = !u->ble || rnd() < 0.9;
+    }
+    if ( hour >= 7 && hour < 23 && t >= u->awake_until && rnd() < 1.0 / 400 ) {
+        u->awake_until = t + 5 + rand() % 60;
+    }
+    if ( t % 300 == 0 ) {
+        u->silence_until = t + 3 + rand() % 5;
+    }
+    if ( hour == 18 && t % 3600 == 0 && rnd() < 0.3 ) {
+        u->gps_until = t + 1800 + rand() % 1800;
+        u->awake_until = u->gps_until;
+    }
+    if ( t < u->awake_until ) {
+        mask |= 1 << WAKEUP;
+        if ( u->sound_day ) {
+            mask |= 1 << SOUND;
+        }
+        if ( rnd() < 0.002 ) {
+            mask |= 1 << WIFI;
+        }
+    }
+    else if ( t < u->silence_until ) {
+        mask |= 1 << SILENCE_WAKEUP | 1 << WIFI;
+    }
+    else {
+        mask |= 1 << STANDBY;
+    }
+    if ( t < u->gps_until ) {
+        mask |= 1 << GPS;
+    }
+    if ( u->ble ) {
+        mask |= 1 << BLE;
+    }
+    return( mask );
+}
+
+static double true_current( uint32_t mask ) {
+    double current = 0.0;
+    for( int i = 0 ; i < LOADS ; i++ ) {
+        if ( mask & ( 1 << i ) ) {
+            current += truth[ i ];
+        }
+    }
+    /*
+     * 10% noise on top of the load currents
+     */
+    return( current * ( 0.9 + 0.2 * rnd() ) );
+}
+
+int main( int argc, char **argv ) {
+    int days = argc > 1 ? atoi( argv[ 1 ] ) : 14;
+    srand( argc > 2 ? atoi( argv[ 2 ] ) : 1 );
+
+    discharge_model_t dm;
+    user_t u = { 0, 0, 0, true, false };
+    double charge = SIM_CAPACITY;
+    double counted = 0.0;
+    uint32_t last_count = 0;
+    uint32_t charging_until = 0;
+    double err_sum = 0.0;
+    uint32_t err_n = 0;
+
+    discharge_model_init( &dm, LOADS, prior );
+    /*
+     * learning days
+     */
+    for( uint32_t t = 0 ; t < (uint32_t)days * 86400 ; t++ ) {
+        uint32_t mask = user_step( &u, t );
+        if ( t < charging_until ) {
+            charge = SIM_CAPACITY;
+            discharge_model_discard( &dm );
+            continue;
+        }
+        if ( ( t / 3600 ) % 24 == 22 && charge < SIM_CAPACITY * 0.4 ) {
+            charging_until = t + 7200;
+            continue;
+        }
+        double current = true_current( mask );
+        charge -= current / 3600.0;
+        counted += current / 3600.0;
+        discharge_model_account( &dm, mask, 1.0f );
+        if ( dm.interval >= SIM_INTERVAL ) {
+            uint32_t count = (uint32_t)( counted / SIM_COUNT_MAH );
+            if ( discharge_model_update( &dm, ( count - last_count ) * SIM_COUNT_MAH ) && dm.updates > 100 ) {
+                err_sum += dm.error;
+                err_n++;
+            }
+            last_count = count;
+        }
+    }
+
+    printf( "%d days, %u intervals of %ds\n\n", days, dm.updates, SIM_INTERVAL );
+    printf( "load\t\ttrue mA\tlearned mA\tusage %%\n" );
+    for( int i = 0 ; i < LOADS ; i++ ) {
+        printf( "%-14s\t%.1f\t%.1f\t\t%.1f\n", names[ i ], truth[ i ], dm.current[ i ], dm.mix[ i ] * 100.0f );
+    }
+    printf( "\ninterval current: mean %.2f mA, mean abs prediction error %.2f mA\n", dm.mean, err_n ? err_sum / err_n : 0.0 );
+
+    uint8_t order[ LOADS ];
+    float drain[ LOADS ];
+    discharge_model_rank( &dm, order, drain );
+    printf( "\nrank\tload\t\tdrain mA\n" );
+    for( int i = 0 ; i < LOADS ; i++ ) {
+        printf( "%d\t%-14s\t%.2f\n", i + 1, names[ order[ i ] ], drain[ i ] );
+    }
+
+    /*
+     * validation: drain full batteries without charging, the runtime is
+     * predicted at full charge and the model keeps learning
+     */
+    uint32_t t = (uint32_t)days * 86400;
+    double sum = 0.0, abs_sum = 0.0;
+    printf( "\nrun\tpredicted h\tactual h\terror %%\n" );
+    for( int run = 0 ; run < SIM_RUNS ; run++ ) {
+        uint32_t predicted = discharge_model_get_runtime( &dm, SIM_CAPACITY );
+        uint32_t start = t;
+        charge = SIM_CAPACITY;
+        while( charge > 0.0 ) {
+            uint32_t mask = user_step( &u, t );
+            double current = true_current( mask );
+            charge -= current / 3600.0;
+            counted += current / 3600.0;
+            discharge_model_account( &dm, mask, 1.0f );
+            if ( dm.interval >= SIM_INTERVAL ) {
+                uint32_t count = (uint32_t)( counted / SIM_COUNT_MAH );
+                discharge_model_update( &dm, ( count - last_count ) * SIM_COUNT_MAH );
+                last_count = count;
+            }
+            t++;
+        }
+        double error = 100.0 * ( (double)predicted - ( t - start ) ) / ( t - start );
+        sum += error;
+        abs_sum += fabs( error );
+        printf( "%d\t%.1f\t\t%.1f\t\t%.1f\n", run + 1, predicted / 3600.0, ( t - start ) / 3600.0, error );
+    }
+    printf( "\nruntime error: mean %.1f%%, mean abs %.1f%%\n", sum / SIM_RUNS, abs_sum / SIM_RUNS );
+    return( fabs( sum / SIM_RUNS ) > 10.0 ? 1 : 0 );
+}
@@ -0,0 +1,70 @@
+#!/usr/bin/env python3
+"""
+Convert a binary event journal (/event_log_YYYY-MM-DD.bin) written by
+src/utils/event_journal.cpp into a tab separated CSV file.
+
+usage: event_journal2csv.py event_log_2021-04-20.bin [output.csv]
+
+timestamps are printed in local time, like the watch names the journal
+files. run it with the timezone of the watch when it differs, e.g.
+TZ=Europe/Berlin event_journal2csv.py event_log_2021-04-20.bin
+"""
+import struct
+import sys
+import time
+
+# must match event_journal_record_t and event_journal_name_record_t
+RECORD = struct.Struct("<IIIIIHBB")
+NAME_RECORD = struct.Struct("<II14sBB")
+TYPE_EVENT = 0
+TYPE_NAME = 1
+
+PMUCTL_STATUS_PERCENT = 0xFF
+PMUCTL_STATUS_PLUG = 0x100
+PMUCTL_STATUS_CHARGING = 0x200
+PMUCTL_STATUS_BATTERY = 0x400
+
+
+def decode(infile, out):
+    names = {}
+    out.write("Date\tTime\tUptime_ms\tCallback\tEvent\tFreeHeap\tFreePsram\tBatt_%\tPlug\tCharging\tBattery\n")
+    with open(infile, "rb") as f:
+        while True:
+            data = f.read(RECORD.size)
+            if len(data) < RECORD.size:
+                break
+            record_type = data[-1]
+            if record_type == TYPE_NAME:
+                _, _, name, table, _ = NAME_RECORD.unpack(data)
+                names[table] = name.split(b"\0", 1)[0].decode("ascii", "replace")
+                continue
+            if record_type != TYPE_EVENT:
+                sys.stderr.write("unknown record type %d, skipped\n" % record_type)
+                continue
+            timestamp, uptime, event, heap, psram, battery, table, _ = RECORD.unpack(data)
+            out.write("%s\t%d\t%s\t%04x\t%d\t%d\t%d\t%d\t%d\t%d\n" % (
+                time.strftime("%Y-%m-%d\t%H:%M:%S", time.localtime(timestamp)),
+                uptime,
+                names.get(table, "table_%d" % table),
+                event,
+                heap,
+                psram,
+                battery & PMUCTL_STATUS_PERCENT,
+                1 if battery & PMUCTL_STATUS_PLUG else 0,
+                1 if battery & PMUCTL_STATUS_CHARGING else 0,
+                1 if battery & PMUCTL_STATUS_BATTERY else 0))
+
+
+def main():
+    if len(sys.argv) < 2:
+        sys.stderr.write(__doc__)
+        sys.exit(1)
+    if len(sys.argv) > 2:
+        with open(sys.argv[2], "w") as out:
+            decode(sys.argv[1], out)
+    else:
+        decode(sys.argv[1], sys.stdout)
+
+
+if __name__ == "__main__":
+    main()
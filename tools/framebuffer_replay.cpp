@@ -0,0 +1,360 @@
+/*
+ * Replay typical UI sessions through the invalid area merge and the band
+ * content hashes from src/hardware/framebuffer_areas.cpp and report what
+ * each redraw costs on the spi bus: invalidated, pushed and skipped pixels,
+ * address windows and spi bytes. Every session runs four times: LVGL's own
+ * area join only like before, with the merge, with the hash skip and with
+ * both. A shadow display is updated with the pushed bands, a skipped band
+ * has to match it and the shadow display has to match the rendered screen
+ * after every frame.
+ *
+ * build:   g++ -O2 tools/framebuffer_replay.cpp -o framebuffer_replay
+ * usage:   framebuffer_replay [band_height]
+ *
+ * the invalidation follows _lv_inv_area, the join lv_refr_join_area and
+ * the band split lv_refr_area of LVGL 7. widgets draw a pattern that
+ * depends on their content version, a redraw without a new version
+ * renders the same pixels like a label set to the same text.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../src/hardware/framebuffer_areas.cpp"
+
+#define SIM_WIDTH           240
+#define SIM_HEIGHT          240
+#define SIM_INV_BUF_SIZE    32              /* LV_INV_BUF_SIZE */
+#define SIM_REFR_PERIOD     30              /* LV_DISP_DEF_REFR_PERIOD in ms */
+#define SIM_BAND_H          20              /* FRAMEBUFFER_BUFFER_H */
+#define SIM_MERGE_SLACK     240             /* FRAMEBUFFER_MERGE_SLACK */
+#define SIM_HASH_ENTRYS     32              /* FRAMEBUFFER_HASH_ENTRYS */
+#define SIM_CMD_BYTES       11              /* FRAMEBUFFER_FLUSH_CMD_BYTES */
+
+typedef struct {
+    const char *name;
+    framebuffer_area_t area;
+    uint32_t redraw_ms;                     /* redraw period, 0 for never */
+    uint32_t change_ms;                     /* content change period, 0 for never */
+} widget_t;
+
+/*
+ * main tile with the statusbar, the periods are the statusbar and
+ * main tile update tasks
+ */
+static const widget_t widgets[] = {
+    { "wifi icon",      {   6,   6,  25,  25 },  500, 20000 },
+    { "ble icon",       {  30,   6,  49,  25 },  500, 15000 },
+    { "battery icon",   { 170,   6, 185,  25 },  250,     0 },
+    { "battery label",  { 190,   6, 235,  25 },  250, 60000 },
+    { "clock",          {  30,  70, 209, 129 },  500, 60000 },
+    { "date",           {  60, 140, 179, 159 },  500,     0 },
+};
+#define WIDGETS     ( sizeof( widgets ) / sizeof( widgets[ 0 ] ) )
+
+typedef enum {
+    SESSION_WATCHFACE = 0,
+    SESSION_SWIPE,
+    SESSION_SCROLL,
+    SESSION_TOGGLE,
+    SESSION_MAX
+} session_t;
+
+static const char *session_name[] = { "watch face, 60s", "tile swipe x5", "notification scroll x5", "settings toggle x10" };
+static const uint32_t session_ms[] = { 60000, 15000, 10000, 20000 };
+
+typedef enum {
+    MODE_LVGL = 0,
+    MODE_MERGE,
+    MODE_HASH,
+    MODE_BOTH,
+    MODE_MAX
+} mode_t_;
+
+static const char *mode_name[] = { "lvgl join", "merge", "hash skip", "merge + hash" };
+
+typedef struct {
+    uint64_t frames;
+    uint64_t invalidated_px;
+    uint64_t pushed_px;
+    uint64_t skipped_px;
+    uint64_t flushes;
+    uint64_t spi_bytes;
+    uint64_t host_ns;
+} result_t;
+
+static uint16_t screen[ SIM_WIDTH * SIM_HEIGHT ];      /* what LVGL renders */
+static uint16_t shadow[ SIM_WIDTH * SIM_HEIGHT ];      /* what the display shows */
+static uint16_t band[ SIM_WIDTH * 60 ];
+static framebuffer_area_t inv_areas[ SIM_INV_BUF_SIZE ];
+static uint8_t inv_joined[ SIM_INV_BUF_SIZE ];
+static uint32_t inv_p = 0;
+static framebuffer_hash_t hashes[ SIM_HASH_ENTRYS ];
+static uint32_t band_height = SIM_BAND_H;
+static int failed = 0;
+
+static uint64_t now_ns( void ) {
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return( (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec );
+}
+
+static uint16_t pattern( uint32_t id, uint32_t version, int32_t x, int32_t y ) {
+    uint32_t h = ( id * 2654435761u ) ^ ( version * 40503u ) ^ ( (uint32_t)x * 73856093u ) ^ ( (uint32_t)y * 19349663u );
+    return( ( h >> 16 ) & 0x0f ? 0x18e3 * ( id + 1 ) : h );
+}
+
+static void draw( const framebuffer_area_t *area, uint32_t id, uint32_t version, int32_t dx, int32_t dy ) {
+    for( int32_t y = area->y1 ; y <= area->y2 ; y++ ) {
+        for( int32_t x = area->x1 ; x <= area->x2 ; x++ ) {
+            screen[ y * SIM_WIDTH + x ] = pattern( id, version, x + dx, y + dy );
+        }
+    }
+}
+
+/**
+ * @brief _lv_inv_area, clip, drop areas inside an invalid area, full screen on overflow
+ */
+static void invalidate( framebuffer_area_t area ) {
+    area.x1 = area.x1 < 0 ? 0 : area.x1;
+    area.y1 = area.y1 < 0 ? 0 : area.y1;
+    area.x2 = area.x2 >= SIM_WIDTH ? SIM_WIDTH - 1 : area.x2;
+    area.y2 = area.y2 >= SIM_HEIGHT ? SIM_HEIGHT - 1 : area.y2;
+
+    for( uint32_t i = 0 ; i < inv_p ; i++ ) {
+        if ( area.x1 >= inv_areas[ i ].x1 && area.y1 >= inv_areas[ i ].y1 && area.x2 <= inv_areas[ i ].x2 && area.y2 <= inv_areas[ i ].y2 ) {
+            return;
+        }
+    }
+    if ( inv_p < SIM_INV_BUF_SIZE ) {
+        inv_areas[ inv_p++ ] = area;
+    }
+    else {
+        inv_p = 1;
+        inv_areas[ 0 ] = { 0, 0, SIM_WIDTH - 1, SIM_HEIGHT - 1 };
+    }
+}
+
+/**
+ * @brief lv_refr_join_area, join areas that touch if the bounding box is smaller than both
+ */
+static void lvgl_join( void ) {
+    for( uint32_t in = 0 ; in < inv_p ; in++ ) {
+        if ( inv_joined[ in ] ) {
+            continue;
+        }
+        for( uint32_t from = 0 ; from < inv_p ; from++ ) {
+            if ( inv_joined[ from ] || in == from || !framebuffer_area_is_on( &inv_areas[ in ], &inv_areas[ from ] ) ) {
+                continue;
+            }
+            framebuffer_area_t joined;
+            framebuffer_area_join( &joined, &inv_areas[ in ], &inv_areas[ from ] );
+            if ( framebuffer_area_size( &joined ) < framebuffer_area_size( &inv_areas[ in ] ) + framebuffer_area_size( &inv_areas[ from ] ) ) {
+                inv_areas[ in ] = joined;
+                inv_joined[ from ] = 1;
+            }
+        }
+    }
+}
+
+/**
+ * @brief framebuffer_flush for one band, hash skip or push to the shadow display
+ */
+static void flush( const framebuffer_area_t *part, bool hash, uint32_t frame, result_t *result ) {
+    uint32_t w = part->x2 - part->x1 + 1;
+    uint32_t size = framebuffer_area_size( part );
+
+    for( int32_t y = part->y1 ; y <= part->y2 ; y++ ) {
+        memcpy( &band[ ( y - part->y1 ) * w ], &screen[ y * SIM_WIDTH + part->x1 ], w * sizeof( uint16_t ) );
+    }
+    uint64_t start = now_ns();
+    bool skip = hash && framebuffer_areas_check_hash( hashes, SIM_HASH_ENTRYS, part, framebuffer_areas_hash( band, size ), frame );
+    result->host_ns += now_ns() - start;
+    if ( skip ) {
+        for( int32_t y = part->y1 ; y <= part->y2 ; y++ ) {
+            if ( memcmp( &band[ ( y - part->y1 ) * w ], &shadow[ y * SIM_WIDTH + part->x1 ], w * sizeof( uint16_t ) ) ) {
+                if ( failed++ == 0 ) {
+                    printf( "band %d,%d-%d,%d skipped but changed\n", part->x1, part->y1, part->x2, part->y2 );
+                }
+                break;
+            }
+        }
+        result->skipped_px += size;
+        return;
+    }
+    for( int32_t y = part->y1 ; y <= part->y2 ; y++ ) {
+        memcpy( &shadow[ y * SIM_WIDTH + part->x1 ], &band[ ( y - part->y1 ) * w ], w * sizeof( uint16_t ) );
+    }
+    result->pushed_px += size;
+    result->flushes++;
+    result->spi_bytes += size * 2 + SIM_CMD_BYTES;
+}
+
+/**
+ * @brief one refresh of all invalid areas
+ */
+static void refresh( mode_t_ mode, result_t *result ) {
+    if ( inv_p == 0 ) {
+        return;
+    }
+    result->frames++;
+    memset( inv_joined, 0, sizeof( inv_joined ) );
+    if ( mode == MODE_MERGE || mode == MODE_BOTH ) {
+        uint64_t start = now_ns();
+        result->invalidated_px += framebuffer_areas_merge( inv_areas, inv_joined, inv_p, SIM_MERGE_SLACK );
+        result->host_ns += now_ns() - start;
+    }
+    else {
+        for( uint32_t i = 0 ; i < inv_p ; i++ ) {
+            result->invalidated_px += framebuffer_area_size( &inv_areas[ i ] );
+        }
+    }
+    lvgl_join();
+    /*
+     * lv_refr_area, bands of as many lines as fit into the buffer
+     */
+    for( uint32_t i = 0 ; i < inv_p ; i++ ) {
+        if ( inv_joined[ i ] ) {
+            continue;
+        }
+        framebuffer_area_t *area = &inv_areas[ i ];
+        int32_t max_row = ( SIM_WIDTH * band_height ) / ( area->x2 - area->x1 + 1 );
+        for( int32_t y = area->y1 ; y <= area->y2 ; y += max_row ) {
+            framebuffer_area_t part = { area->x1, (int16_t)y, area->x2, (int16_t)( y + max_row - 1 > area->y2 ? area->y2 : y + max_row - 1 ) };
+            flush( &part, mode == MODE_HASH || mode == MODE_BOTH, result->frames, result );
+        }
+    }
+    inv_p = 0;
+    if ( memcmp( screen, shadow, sizeof( screen ) ) ) {
+        if ( failed++ == 0 ) {
+            printf( "display differs after frame %d\n", (int)result->frames );
+        }
+    }
+}
+
+static void run( session_t session, mode_t_ mode, result_t *result ) {
+    framebuffer_area_t full = { 0, 0, SIM_WIDTH - 1, SIM_HEIGHT - 1 };
+    framebuffer_area_t list = { 0, 32, SIM_WIDTH - 1, SIM_HEIGHT - 1 };
+    framebuffer_area_t toggle = { 170, 80, 229, 109 };
+    framebuffer_area_t toggle_label = { 10, 85, 160, 104 };
+    uint32_t version[ WIDGETS ] = { 0 };
+    uint32_t tile = 0;
+
+    srand( 1 );
+    memset( result, 0, sizeof( result_t ) );
+    memset( hashes, 0, sizeof( hashes ) );
+    memset( shadow, 0, sizeof( shadow ) );
+    inv_p = 0;
+    /*
+     * the first frame draws the main tile
+     */
+    draw( &full, 100, 0, 0, 0 );
+    for( uint32_t w = 0 ; w < WIDGETS ; w++ ) {
+        draw( &widgets[ w ].area, w, 0, 0, 0 );
+    }
+    invalidate( full );
+    refresh( mode, result );
+    memset( result, 0, sizeof( result_t ) );
+
+    for( uint32_t ms = SIM_REFR_PERIOD ; ms <= session_ms[ session ] ; ms += SIM_REFR_PERIOD ) {
+        /*
+         * the tile content, the statusbar and main tile widgets keep redrawing
+         */
+        switch( session ) {
+            case SESSION_SWIPE:
+                /*
+                 * every 3s a swipe of 10 frames to the next tile
+                 */
+                if ( ms % 3000 < 10 * SIM_REFR_PERIOD ) {
+                    int32_t frame = ms % 3000 / SIM_REFR_PERIOD;
+                    draw( &full, 100 + tile, 0, frame * 24, 0 );
+                    invalidate( full );
+                    if ( frame == 9 ) {
+                        tile++;
+                        draw( &full, 100 + tile, 0, 0, 0 );
+                        for( uint32_t w = 0 ; w < WIDGETS ; w++ ) {
+                            draw( &widgets[ w ].area, w, version[ w ], 0, 0 );
+                        }
+                    }
+                }
+                break;
+            case SESSION_SCROLL:
+                /*
+                 * one second scrolling, one second reading
+                 */
+                if ( ms % 2000 < 1000 ) {
+                    draw( &list, 200, 0, 0, ms % 2000 / 8 + ms / 2000 * 125 );
+                    invalidate( list );
+                }
+                break;
+            case SESSION_TOGGLE:
+                /*
+                 * every 2s a switch animates over 8 frames, the label changes at the end
+                 */
+                if ( ms % 2000 < 8 * SIM_REFR_PERIOD ) {
+                    draw( &toggle, 300, ms / 2000 * 8 + ms % 2000 / SIM_REFR_PERIOD, 0, 0 );
+                    invalidate( toggle );
+                    if ( ms % 2000 / SIM_REFR_PERIOD == 7 ) {
+                        draw( &toggle_label, 301, ms / 2000, 0, 0 );
+                        invalidate( toggle_label );
+                    }
+                }
+                break;
+            default:
+                break;
+        }
+        for( uint32_t w = 0 ; w < WIDGETS ; w++ ) {
+            const widget_t *widget = &widgets[ w ];
+            if ( session == SESSION_SCROLL && widget->area.y1 >= 32 ) {
+                continue;
+            }
+            if ( session == SESSION_TOGGLE && widget->area.y1 >= 32 ) {
+                continue;
+            }
+            if ( widget->redraw_ms && ms % widget->redraw_ms < SIM_REFR_PERIOD ) {
+                if ( widget->change_ms && ms % widget->change_ms < SIM_REFR_PERIOD ) {
+                    version[ w ]++;
+                }
+                draw( &widget->area, w, version[ w ], 0, 0 );
+                invalidate( widget->area );
+            }
+        }
+        refresh( mode, result );
+    }
+}
+
+int main( int argc, char **argv ) {
+    band_height = argc > 1 ? atoi( argv[ 1 ] ) : SIM_BAND_H;
+    if ( band_height < 4 || band_height > 60 ) {
+        printf( "band height 4..60\n" );
+        return( 1 );
+    }
+    printf( "band height %d lines, merge slack %d px, %d hash entries\n", band_height, SIM_MERGE_SLACK, SIM_HASH_ENTRYS );
+
+    for( int session = 0 ; session < SESSION_MAX ; session++ ) {
+        result_t results[ MODE_MAX ];
+
+        printf( "\n%s\n", session_name[ session ] );
+        printf( "%-14s %7s %12s %12s %12s %9s %12s %12s %10s\n", "", "frames", "invalidated", "pushed", "skipped", "flushes", "spi bytes", "bytes/frame", "host ns/f" );
+        for( int mode = 0 ; mode < MODE_MAX ; mode++ ) {
+            result_t *r = &results[ mode ];
+            run( (session_t)session, (mode_t_)mode, r );
+            printf( "%-14s %7d %12llu %12llu %12llu %9llu %12llu %12llu %10llu\n", mode_name[ mode ], (int)r->frames,
+                    (unsigned long long)r->invalidated_px, (unsigned long long)r->pushed_px, (unsigned long long)r->skipped_px,
+                    (unsigned long long)r->flushes, (unsigned long long)r->spi_bytes,
+                    (unsigned long long)( r->frames ? r->spi_bytes / r->frames : 0 ),
+                    (unsigned long long)( r->frames ? r->host_ns / r->frames : 0 ) );
+        }
+        /*
+         * the merge may push a few wasted pixels, never more than the slack per merge
+         */
+        if ( results[ MODE_BOTH ].spi_bytes > results[ MODE_LVGL ].spi_bytes ) {
+            printf( "merge + hash costs more spi bytes than lvgl join\n" );
+            failed++;
+        }
+    }
+    printf( "\n%-40s %s\n", "skipped bands unchanged, display in sync", failed ? "FAILED" : "ok" );
+    printf( "%s\n", failed ? "FAILED" : "all ok" );
+    return( failed ? 1 : 0 );
+}
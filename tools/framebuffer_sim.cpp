@@ -0,0 +1,125 @@
+/*
+ * Model a full screen tile swipe with the band pipeline from
+ * src/hardware/framebuffer_model.cpp and report the frames per second for
+ * blocking flushes, DMA with one buffer and DMA with two buffers over the
+ * band heights framebuffer_set_band_height allows. The model is checked
+ * against the closed forms it has to match: blocking is render plus spi,
+ * two buffers are never better than the slower of render and spi plus one
+ * band of the other, nothing beats the spi bound.
+ *
+ * build:   g++ -O2 tools/framebuffer_sim.cpp -o framebuffer_sim
+ * usage:   framebuffer_sim [render_ns_px] [band_overhead_us]
+ *
+ * render_ns_px is what /framebuffer reports as render_ns_px on the watch,
+ * without it a light and a busy tile are modelled. band_overhead_us is
+ * the LVGL cost per band independent of its size.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../src/hardware/framebuffer_model.cpp"
+
+#define SIM_WIDTH           240
+#define SIM_HEIGHT          240
+#define SIM_SPI_FREQUENCY   40000000        /* FRAMEBUFFER_SPI_FREQUENCY */
+#define SIM_CMD_BYTES       11              /* FRAMEBUFFER_FLUSH_CMD_BYTES */
+#define SIM_MIN_BAND_H      4               /* FRAMEBUFFER_MIN_BAND_H */
+#define SIM_MAX_BAND_H      60              /* FRAMEBUFFER_MAX_BAND_H */
+#define SIM_HASH_NS_PX      4               /* framebuffer_check_hash, one multiply and xor per pixel */
+#define SIM_BAND_OVERHEAD   40              /* lvgl object walk and clipping per band in us */
+
+static int failed = 0;
+
+static const char *mode_name[] = { "blocking", "dma, one buffer", "dma, two buffers" };
+
+static void setup( framebuffer_model_t *model, uint32_t band_height, int mode, uint32_t render_ns_px, uint32_t band_overhead_us ) {
+    model->width = SIM_WIDTH;
+    model->height = SIM_HEIGHT;
+    model->band_height = band_height;
+    model->dma = mode > 0;
+    model->double_buffer = mode > 1;
+    model->spi_frequency = SIM_SPI_FREQUENCY;
+    model->cmd_bytes = SIM_CMD_BYTES;
+    model->render_ns_px = render_ns_px;
+    model->band_overhead_us = band_overhead_us;
+    model->hash_ns_px = SIM_HASH_NS_PX;
+}
+
+/**
+ * @brief check one band height against the closed forms
+ */
+static bool check( uint32_t band_height, uint32_t render_ns_px, uint32_t band_overhead_us ) {
+    framebuffer_model_t model;
+    framebuffer_model_result_t r[ 3 ];
+
+    for( int mode = 0 ; mode < 3 ; mode++ ) {
+        setup( &model, band_height, mode, render_ns_px, band_overhead_us );
+        framebuffer_model_frame( &model, &r[ mode ] );
+    }
+    uint32_t bound = framebuffer_model_spi_bound_fps( &model );
+    uint32_t band_render = r[ 0 ].render_us / r[ 0 ].bands;
+    uint32_t band_spi = r[ 0 ].spi_us / r[ 0 ].bands;
+    uint32_t slower = r[ 2 ].render_us > r[ 2 ].spi_us ? r[ 2 ].render_us : r[ 2 ].spi_us;
+    /*
+     * rounding to us is one us per band at most
+     */
+    uint32_t slack = r[ 0 ].bands + 1;
+
+    bool ok = r[ 0 ].frame_us + slack >= r[ 0 ].render_us + r[ 0 ].spi_us && r[ 0 ].frame_us <= r[ 0 ].render_us + r[ 0 ].spi_us + slack
+           && r[ 1 ].frame_us + slack >= r[ 0 ].frame_us && r[ 1 ].frame_us <= r[ 0 ].frame_us + slack
+           && r[ 2 ].frame_us + slack >= slower && r[ 2 ].frame_us <= slower + ( band_render > band_spi ? band_spi : band_render ) + band_spi + slack
+           && r[ 2 ].fps >= r[ 0 ].fps
+           && r[ 0 ].fps <= bound && r[ 2 ].fps <= bound;
+    if ( !ok ) {
+        printf( "band height %d, render %d ns/px: model does not match\n", band_height, render_ns_px );
+    }
+    return( ok );
+}
+
+static void table( const char *name, uint32_t render_ns_px, uint32_t band_overhead_us ) {
+    framebuffer_model_t model;
+    framebuffer_model_result_t r;
+
+    printf( "\n%s, %d ns/px render, %d us per band\n", name, render_ns_px, band_overhead_us );
+    printf( "%-8s %-8s", "band h", "bound" );
+    for( int mode = 0 ; mode < 3 ; mode++ ) {
+        printf( " %18s", mode_name[ mode ] );
+    }
+    printf( "  %s\n", "cpu wait us, two buffers" );
+    for( uint32_t band_height = SIM_MIN_BAND_H ; band_height <= SIM_MAX_BAND_H ; band_height += 4 ) {
+        setup( &model, band_height, 0, render_ns_px, band_overhead_us );
+        printf( "%-8d %-8d", band_height, framebuffer_model_spi_bound_fps( &model ) );
+        for( int mode = 0 ; mode < 3 ; mode++ ) {
+            setup( &model, band_height, mode, render_ns_px, band_overhead_us );
+            framebuffer_model_frame( &model, &r );
+            printf( " %14d fps", r.fps );
+        }
+        printf( "  %d\n", r.cpu_wait_us );
+    }
+}
+
+int main( int argc, char **argv ) {
+    uint32_t band_overhead_us = argc > 2 ? atoi( argv[ 2 ] ) : SIM_BAND_OVERHEAD;
+    /*
+     * the closed forms over render costs from idle to far slower than the bus
+     */
+    bool ok = true;
+    for( uint32_t render_ns_px = 0 ; render_ns_px <= 400 && ok ; render_ns_px += 5 ) {
+        for( uint32_t band_height = SIM_MIN_BAND_H ; band_height <= SIM_MAX_BAND_H && ok ; band_height++ ) {
+            ok = check( band_height, render_ns_px, 0 ) && check( band_height, render_ns_px, band_overhead_us );
+        }
+    }
+    printf( "%-40s %s\n", "model against closed forms", ok ? "ok" : "FAILED" );
+    failed += ok ? 0 : 1;
+
+    if ( argc > 1 ) {
+        table( "measured", atoi( argv[ 1 ] ), band_overhead_us );
+    }
+    else {
+        table( "light tile", 60, band_overhead_us );
+        table( "busy tile", 250, band_overhead_us );
+    }
+    printf( "\nbound: spi bus always busy and no render time, one address window per band\n" );
+    printf( "%s\n", failed ? "FAILED" : "all ok" );
+    return( failed ? 1 : 0 );
+}
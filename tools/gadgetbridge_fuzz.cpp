@@ -0,0 +1,239 @@
+/*
+ * Feed Gadgetbridge traffic through the frame scanner from
+ * src/utils/gadgetbridge_scanner.cpp and compare every event with a
+ * reference parser that keeps the whole stream in a std::string, like
+ * the removed CharBuffer. The traffic is sent in one piece, in BLE sized
+ * chunks, and mutated with random control bytes, dropped and flipped
+ * bytes and frames longer than the receive buffer. The scan speed is
+ * measured for 20 and 244 byte chunks.
+ *
+ * build:   g++ -O2 -Itools/host tools/gadgetbridge_fuzz.cpp -o gadgetbridge_fuzz
+ * usage:   gadgetbridge_fuzz [rounds] [recording]
+ *
+ * a recording is the raw byte stream as onWrite receives it, without a
+ * recording a session is synthesized from the messages Gadgetbridge
+ * sends to a Bangle.js: link start, setTime, notify, call, musicinfo,
+ * weather, find and a notify with a long utf-8 body.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include <esp_timer.h>
+
+#include "../src/utils/gadgetbridge_scanner.cpp"
+
+#define FUZZ_ROUNDS         20000
+#define FUZZ_BUFFER_SIZE    512             /* small receive buffer so overflows are hit */
+
+typedef struct {
+    gadgetbridge_scanner_event_t event;
+    std::string data;
+    size_t len;
+    bool gadgetbridge;
+} event_t;
+
+static int failed = 0;
+
+static std::string frame( const std::string &payload ) {
+    return( std::string( 1, GADGETBRIDGE_DLE ) + payload + "\n" );
+}
+
+static std::string synthesize( void ) {
+    std::string s( 1, GADGETBRIDGE_ETX );
+    std::string body;
+
+    s += frame( "setTime(1792324800);E.setTimeZone(2.0);(s=>{s&&(s.timezone=2.0)&&require('Storage').write('setting.json',s);})(require('Storage').readJSON('setting.json',1))" );
+    s += frame( "GB({\"t\":\"notify\",\"id\":1602876524,\"src\":\"WhatsApp\",\"title\":\"Anna\",\"body\":\"Bin in 10 Minuten da :)\"})" );
+    s += frame( "GB({\"t\":\"call\",\"cmd\":\"incoming\",\"name\":\"Mum\",\"number\":\"+49301234567\"})" );
+    s += frame( "GB({\"t\":\"musicinfo\",\"artist\":\"Daft Punk\",\"album\":\"Discovery\",\"track\":\"One More Time (Radio Edit)\",\"dur\":320,\"c\":-1,\"n\":-1})" );
+    s += frame( "GB({\"t\":\"musicstate\",\"state\":\"play\",\"position\":12,\"shuffle\":1,\"repeat\":1})" );
+    s += frame( "GB({\"t\":\"weather\",\"temp\":288,\"hum\":71,\"txt\":\"light rain\",\"wind\":3.6,\"loc\":\"Berlin\"})" );
+    s += frame( "GB({\"t\":\"find\",\"n\":true})" );
+    for( int i = 0 ; i < 40 ; i++ ) {
+        body += "Grüße aus Köln 😀 (";
+    }
+    s += frame( "GB({\"t\":\"notify\",\"id\":1602876525,\"src\":\"Telegram\",\"title\":\"Group\",\"body\":\"" + body + "\"})" );
+    s += frame( "GB({\"t\":\"notify-\",\"id\":1602876524})" );
+    return( s );
+}
+
+/**
+ * @brief reference parser, the whole frame is collected before it is looked at
+ */
+static std::vector<event_t> reference( const std::string &stream, size_t size ) {
+    std::vector<event_t> events;
+    std::string current;
+
+    for( char c : stream ) {
+        if ( c == GADGETBRIDGE_ETX || c == GADGETBRIDGE_DLE ) {
+            current.clear();
+            events.push_back( { c == GADGETBRIDGE_ETX ? GADGETBRIDGE_SCANNER_LINK : GADGETBRIDGE_SCANNER_NEW_FRAME, "", 0, false } );
+        }
+        else if ( c == GADGETBRIDGE_LF ) {
+            if ( current.size() > size - 1 ) {
+                events.push_back( { GADGETBRIDGE_SCANNER_OVERFLOW, "", current.size(), false } );
+            }
+            else if ( current.compare( 0, 3, "GB(" ) == 0 ) {
+                size_t close = current.rfind( ')' );
+                std::string data = close != std::string::npos && close > 2 ? current.substr( 3, close - 3 ) : current.substr( 3 );
+                events.push_back( { GADGETBRIDGE_SCANNER_FRAME, data, data.size(), true } );
+            }
+            else {
+                events.push_back( { GADGETBRIDGE_SCANNER_FRAME, current, current.size(), false } );
+            }
+            current.clear();
+        }
+        else {
+            current += c;
+        }
+    }
+    return( events );
+}
+
+/**
+ * @brief feed the stream in chunks like onWrite does, chunk 0 means random 1..244
+ */
+static std::vector<event_t> scan( gadgetbridge_scanner_t *scanner, const std::string &stream, size_t chunk ) {
+    std::vector<event_t> events;
+    size_t offset = 0;
+
+    gadgetbridge_scanner_reset( scanner );
+    while( offset < stream.size() ) {
+        size_t len = chunk ? chunk : 1 + rand() % 244;
+        len = len < stream.size() - offset ? len : stream.size() - offset;
+        /*
+         * the characteristic value is a separate copy per write
+         */
+        std::string value = stream.substr( offset, len );
+        size_t pos = 0;
+        while( pos < len ) {
+            gadgetbridge_frame_t frame;
+            pos += gadgetbridge_scanner_feed( scanner, &value[ pos ], len - pos, &frame );
+            if ( frame.event != GADGETBRIDGE_SCANNER_NONE ) {
+                events.push_back( { frame.event, frame.data ? std::string( frame.data, frame.len ) : "", frame.len, frame.gadgetbridge } );
+            }
+        }
+        offset += len;
+    }
+    return( events );
+}
+
+static bool same( const std::vector<event_t> &a, const std::vector<event_t> &b ) {
+    if ( a.size() != b.size() ) {
+        return( false );
+    }
+    for( size_t i = 0 ; i < a.size() ; i++ ) {
+        if ( a[ i ].event != b[ i ].event || a[ i ].data != b[ i ].data || a[ i ].len != b[ i ].len || a[ i ].gadgetbridge != b[ i ].gadgetbridge ) {
+            return( false );
+        }
+    }
+    return( true );
+}
+
+static std::string mutate( const std::string &stream ) {
+    static const char specials[] = { GADGETBRIDGE_ETX, GADGETBRIDGE_DLE, GADGETBRIDGE_LF, ')', '(', 'G', 'B', 0 };
+    std::string s = stream;
+    int mutations = 1 + rand() % 8;
+
+    for( int i = 0 ; i < mutations && !s.empty() ; i++ ) {
+        size_t pos = rand() % s.size();
+        switch( rand() % 5 ) {
+            case 0:     s.insert( pos, 1, specials[ rand() % sizeof( specials ) ] );
+                        break;
+            case 1:     s.erase( pos, 1 + rand() % 16 );
+                        break;
+            case 2:     s[ pos ] ^= 1 << ( rand() % 8 );
+                        break;
+            case 3:     s.insert( pos, std::string( FUZZ_BUFFER_SIZE - 8 + rand() % 16, 'x' ) );
+                        break;
+            default:    s = s.substr( 0, pos );
+                        break;
+        }
+    }
+    return( s );
+}
+
+int main( int argc, char **argv ) {
+    uint32_t rounds = argc > 1 ? atoi( argv[ 1 ] ) : FUZZ_ROUNDS;
+    std::string stream;
+    gadgetbridge_scanner_t scanner;
+
+    if ( argc > 2 ) {
+        FILE *file = fopen( argv[ 2 ], "rb" );
+        if ( file == NULL ) {
+            printf( "can't open %s\n", argv[ 2 ] );
+            return( 1 );
+        }
+        char buffer[ 4096 ];
+        size_t len;
+        while( ( len = fread( buffer, 1, sizeof( buffer ), file ) ) > 0 ) {
+            stream.append( buffer, len );
+        }
+        fclose( file );
+    }
+    else {
+        stream = synthesize();
+    }
+    srand( 1 );
+    /*
+     * the recording as it is, with the default buffer size
+     */
+    gadgetbridge_scanner_init( &scanner, GADGETBRIDGE_SCANNER_SIZE );
+    std::vector<event_t> expected = reference( stream, GADGETBRIDGE_SCANNER_SIZE );
+    bool ok = same( scan( &scanner, stream, stream.size() ), expected );
+    for( size_t chunk = 1 ; chunk <= 244 && ok ; chunk++ ) {
+        ok = same( scan( &scanner, stream, chunk ), expected );
+    }
+    printf( "%-40s %s\n", "recording, 1..244 byte chunks", ok ? "ok" : "FAILED" );
+    failed += ok ? 0 : 1;
+    /*
+     * mutated streams against a small buffer
+     */
+    uint32_t diff = 0, overflows = 0;
+    free( scanner.buffer );
+    gadgetbridge_scanner_init( &scanner, FUZZ_BUFFER_SIZE );
+    for( uint32_t i = 0 ; i < rounds ; i++ ) {
+        std::string fuzzed = mutate( stream );
+        std::vector<event_t> ref = reference( fuzzed, FUZZ_BUFFER_SIZE );
+        for( const event_t &e : ref ) {
+            overflows += e.event == GADGETBRIDGE_SCANNER_OVERFLOW ? 1 : 0;
+        }
+        if ( !same( scan( &scanner, fuzzed, 0 ), ref ) ) {
+            if ( diff++ == 0 ) {
+                printf( "first mismatch in round %d\n", i );
+            }
+        }
+    }
+    printf( "%-40s %s\n", "mutated streams, random chunks", diff ? "FAILED" : "ok" );
+    printf( "  %d rounds, %d overflow frames\n", rounds, overflows );
+    failed += diff ? 1 : 0;
+    /*
+     * scan speed
+     */
+    free( scanner.buffer );
+    gadgetbridge_scanner_init( &scanner, GADGETBRIDGE_SCANNER_SIZE );
+    for( size_t chunk : { (size_t)20, (size_t)244 } ) {
+        uint32_t repeat = 2000, frames = 0, chunks = 0;
+        uint64_t start = esp_timer_get_time();
+        for( uint32_t r = 0 ; r < repeat ; r++ ) {
+            for( size_t offset = 0 ; offset < stream.size() ; offset += chunk ) {
+                size_t len = chunk < stream.size() - offset ? chunk : stream.size() - offset;
+                size_t pos = 0;
+                while( pos < len ) {
+                    gadgetbridge_frame_t frame;
+                    pos += gadgetbridge_scanner_feed( &scanner, &stream[ offset + pos ], len - pos, &frame );
+                    frames += frame.event == GADGETBRIDGE_SCANNER_FRAME ? 1 : 0;
+                }
+                chunks++;
+            }
+        }
+        uint64_t us = esp_timer_get_time() - start;
+        printf( "%3d byte chunks: %6.1f MB/s, %5.0f ns per chunk, %d frames\n", (int)chunk, (double)stream.size() * repeat / us, us * 1000.0 / chunks, frames );
+    }
+    free( scanner.buffer );
+    printf( "%s\n", failed ? "FAILED" : "all ok" );
+    return( failed ? 1 : 0 );
+}
@@ -0,0 +1,298 @@
+/*
+ * Replay main tile refreshes through the glyph cache from
+ * src/gui/glyph_cache.cpp with the real Ubuntu_72px and Ubuntu_16px
+ * fonts. Labels are laid out and drawn band by band like LVGL 7 does:
+ * every glyph that crosses a band is fetched with get_glyph_bitmap and
+ * blended into the band, so the 72px clock digits are fetched once per
+ * band they cross. Each refresh is drawn without and with the cache and
+ * the bands have to match.
+ *
+ * build:   g++ -O2 -DBOARD_HAS_PSRAM -Itools/host -Isrc tools/glyph_cache_sim.cpp -x c tools/host/lvgl/lv_font_fmt_txt.c src/gui/font/Ubuntu_16px.c src/gui/font/Ubuntu_72px.c -o glyph_cache_sim
+ * usage:   glyph_cache_sim [days] [band height]
+ *
+ * without -DBOARD_HAS_PSRAM the 8 KB cache is used. a day is 1440
+ * minute ticks that redraw the time label and the step counter, a
+ * battery label update every 5 minutes and SIM_WAKEUPS wakeups that
+ * redraw the whole screen. the time is host time, the pixel and bitmap
+ * counts carry over to the watch.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <vector>
+
+#include "../src/utils/bench.cpp"
+#include "../src/gui/glyph_cache.cpp"
+
+extern "C" {
+    LV_FONT_DECLARE( Ubuntu_16px );
+    LV_FONT_DECLARE( Ubuntu_72px );
+}
+
+#define SIM_DAYS            7
+#define SIM_WIDTH           240
+#define SIM_HEIGHT          240
+#define SIM_BAND_H          20                  /* FRAMEBUFFER_BUFFER_H */
+#define SIM_MAX_BAND_H      60                  /* FRAMEBUFFER_MAX_BAND_H */
+#define SIM_WAKEUPS         150                 /* full screen redraws per day */
+
+typedef enum {
+    SIM_MINUTE = 0,
+    SIM_WAKEUP,
+    SIM_EVENTS
+} sim_event_t;
+
+static const char *sim_event_name[ SIM_EVENTS ] = { "minute tick", "wakeup" };
+
+/**
+ * @brief one laid out glyph
+ */
+typedef struct {
+    uint32_t letter;
+    int16_t x, y;
+    lv_font_glyph_dsc_t dsc;
+} sim_glyph_t;
+
+/**
+ * @brief one label, y is the top of the text line
+ */
+typedef struct {
+    const lv_font_t *font;
+    int16_t y;
+    bool center;
+    int16_t x1, x2;
+    std::vector<sim_glyph_t> glyphs;
+} sim_label_t;
+
+/**
+ * @brief what one refresh did
+ */
+typedef struct {
+    uint32_t bitmaps;               /* get_glyph_bitmap calls */
+    uint32_t decompressed_px;       /* pixels the LVGL decompressor produced */
+    uint64_t us;                    /* draw time on the host */
+    uint32_t hash;                  /* fnv-1a of all drawn bands */
+} sim_result_t;
+
+static int failed = 0;
+static uint16_t band[ SIM_WIDTH * SIM_MAX_BAND_H ];
+static uint32_t band_h = SIM_BAND_H;
+static uint32_t bitmaps = 0;
+
+static sim_label_t time_label = { &Ubuntu_72px, 64, true };
+static sim_label_t date_label = { &Ubuntu_16px, 150, true };
+static sim_label_t step_label = { &Ubuntu_16px, 8, false };
+static sim_label_t battery_label = { &Ubuntu_16px, 8, false };
+static sim_label_t *labels[] = { &time_label, &date_label, &step_label, &battery_label };
+
+static void sim_label_set_text( sim_label_t *label, const char *text, int16_t x ) {
+    int16_t pos = 0;
+
+    label->glyphs.clear();
+    for( const char *c = text ; *c ; c++ ) {
+        sim_glyph_t glyph;
+        glyph.letter = (uint8_t)*c;
+        if ( !lv_font_get_glyph_dsc( label->font, &glyph.dsc, glyph.letter, (uint8_t)c[ 1 ] ) ) {
+            continue;
+        }
+        glyph.x = pos + glyph.dsc.ofs_x;
+        glyph.y = label->y + ( label->font->line_height - label->font->base_line ) - glyph.dsc.box_h - glyph.dsc.ofs_y;
+        label->glyphs.push_back( glyph );
+        pos += glyph.dsc.adv_w;
+    }
+    x = label->center ? ( SIM_WIDTH - pos ) / 2 : x;
+    for( sim_glyph_t &glyph : label->glyphs ) {
+        glyph.x += x;
+    }
+    label->x1 = x;
+    label->x2 = x + pos - 1;
+}
+
+/**
+ * @brief draw the part of a label inside the band, 2 bpp white on a dark background
+ */
+static void sim_label_draw( const sim_label_t *label, int16_t y1, int16_t y2 ) {
+    for( const sim_glyph_t &glyph : label->glyphs ) {
+        if ( glyph.dsc.box_w == 0 || glyph.y > y2 || glyph.y + glyph.dsc.box_h - 1 < y1 ) {
+            continue;
+        }
+        const uint8_t *bitmap = lv_font_get_glyph_bitmap( label->font, glyph.letter );
+        bitmaps++;
+        if ( !bitmap ) {
+            continue;
+        }
+        for( int16_t y = glyph.y > y1 ? glyph.y : y1 ; y <= y2 && y < glyph.y + glyph.dsc.box_h ; y++ ) {
+            for( int16_t x = 0 ; x < glyph.dsc.box_w ; x++ ) {
+                uint32_t px = ( y - glyph.y ) * glyph.dsc.box_w + x;
+                uint8_t alpha = ( bitmap[ px >> 2 ] >> ( 6 - ( px & 3 ) * 2 ) ) & 3;
+                int16_t bx = glyph.x + x;
+                if ( alpha == 0 || bx < 0 || bx >= SIM_WIDTH ) {
+                    continue;
+                }
+                uint16_t *dst = &band[ ( y - y1 ) * SIM_WIDTH + bx ];
+                uint32_t g = ( ( *dst >> 5 ) & 0x3f ) * ( 3 - alpha ) / 3 + 0x3f * alpha / 3;
+                *dst = ( *dst & 0xf81f ) | ( g << 5 );
+            }
+        }
+    }
+}
+
+/**
+ * @brief redraw the rows y1..y2 in bands like the LVGL refresh does
+ */
+static void sim_refresh( int16_t y1, int16_t y2, sim_result_t *result ) {
+    uint32_t px_start = lv_font_host_decompressed_px;
+    uint32_t bitmaps_start = bitmaps;
+    uint64_t start = esp_timer_get_time();
+
+    for( int16_t band_y1 = y1 ; band_y1 <= y2 ; band_y1 += band_h ) {
+        int16_t band_y2 = band_y1 + (int16_t)band_h - 1 < y2 ? band_y1 + band_h - 1 : y2;
+        for( uint32_t i = 0 ; i < SIM_WIDTH * band_h ; i++ ) {
+            band[ i ] = 0x1082;
+        }
+        for( sim_label_t *label : labels ) {
+            sim_label_draw( label, band_y1, band_y2 );
+        }
+        for( int32_t i = 0 ; i < SIM_WIDTH * ( band_y2 - band_y1 + 1 ) ; i++ ) {
+            result->hash = ( result->hash ^ band[ i ] ) * 16777619;
+        }
+    }
+    result->us += esp_timer_get_time() - start;
+    result->bitmaps += bitmaps - bitmaps_start;
+    result->decompressed_px += lv_font_host_decompressed_px - px_start;
+}
+
+/**
+ * @brief rows a label covers, LVGL invalidates the old and the new area of the label
+ */
+static void sim_label_rows( const sim_label_t *label, int16_t *y1, int16_t *y2 ) {
+    *y1 = label->y;
+    *y2 = label->y + label->font->line_height - 1;
+}
+
+/**
+ * @brief replay days of main tile refreshes
+ */
+static void sim_run( uint32_t days, sim_result_t *result, uint32_t *count ) {
+    time_t now = 1792324800;                    /* Sun Oct 18 2026, 00:00 UTC */
+
+    memset( result, 0, sizeof( sim_result_t ) * SIM_EVENTS );
+    memset( count, 0, sizeof( uint32_t ) * SIM_EVENTS );
+    for( uint32_t minute = 0 ; minute < days * 1440 ; minute++, now += 60 ) {
+        struct tm info;
+        char text[ 64 ];
+        gmtime_r( &now, &info );
+
+        strftime( text, sizeof( text ), "%H:%M", &info );
+        sim_label_set_text( &time_label, text, 0 );
+        strftime( text, sizeof( text ), "%a %d.%b %Y", &info );
+        sim_label_set_text( &date_label, text, 0 );
+        snprintf( text, sizeof( text ), "%d", info.tm_hour >= 7 && info.tm_hour < 22 ? ( minute % 1440 - 420 ) * 11 : 0 );
+        sim_label_set_text( &step_label, text, 5 );
+        snprintf( text, sizeof( text ), "%d%%", 100 - (int)( minute % 1440 ) / 20 );
+        sim_label_set_text( &battery_label, text, 190 );
+        /*
+         * the time label and the statusbar labels that changed
+         */
+        int16_t y1, y2;
+        sim_label_rows( &time_label, &y1, &y2 );
+        sim_refresh( y1, y2, &result[ SIM_MINUTE ] );
+        sim_label_rows( &step_label, &y1, &y2 );
+        sim_refresh( y1, y2, &result[ SIM_MINUTE ] );
+        if ( minute % 5 == 0 ) {
+            sim_label_rows( &battery_label, &y1, &y2 );
+            sim_refresh( y1, y2, &result[ SIM_MINUTE ] );
+        }
+        count[ SIM_MINUTE ]++;
+        /*
+         * wakeups spread over the day, the whole screen is drawn
+         */
+        if ( ( minute % 1440 ) * SIM_WAKEUPS / 1440 != ( minute % 1440 + 1 ) * SIM_WAKEUPS / 1440 ) {
+            sim_refresh( 0, SIM_HEIGHT - 1, &result[ SIM_WAKEUP ] );
+            count[ SIM_WAKEUP ]++;
+        }
+    }
+}
+
+/**
+ * @brief decompress every glyph, the rle stream has to end where the next
+ * glyph starts. the font converter may flush one more byte for a pending repeat
+ */
+static bool check_decoder( const lv_font_t *font, uint32_t *glyphs ) {
+    const lv_font_fmt_txt_dsc_t *fdsc = (const lv_font_fmt_txt_dsc_t *)font->dsc;
+    uint32_t last_gid = 0;
+
+    for( uint32_t i = 0 ; i < fdsc->cmap_num ; i++ ) {
+        const lv_font_fmt_txt_cmap_t *cmap = &fdsc->cmaps[ i ];
+        uint32_t ids = cmap->type == LV_FONT_FMT_TXT_CMAP_SPARSE_TINY ? cmap->list_length : cmap->range_length;
+        last_gid = cmap->glyph_id_start + ids - 1 > last_gid ? cmap->glyph_id_start + ids - 1 : last_gid;
+    }
+    *glyphs = 0;
+    for( uint32_t i = 0 ; i < fdsc->cmap_num ; i++ ) {
+        const lv_font_fmt_txt_cmap_t *cmap = &fdsc->cmaps[ i ];
+        uint32_t ids = cmap->type == LV_FONT_FMT_TXT_CMAP_SPARSE_TINY ? cmap->list_length : cmap->range_length;
+        for( uint32_t id = 0 ; id < ids ; id++ ) {
+            uint32_t gid = cmap->glyph_id_start + id;
+            uint32_t letter = cmap->range_start + ( cmap->type == LV_FONT_FMT_TXT_CMAP_SPARSE_TINY ? cmap->unicode_list[ id ] : id );
+            const lv_font_fmt_txt_glyph_dsc_t *gdsc = &fdsc->glyph_dsc[ gid ];
+            if ( gid == last_gid || gdsc->box_w * gdsc->box_h == 0 ) {
+                continue;
+            }
+            uint32_t stored = gdsc[ 1 ].bitmap_index - gdsc->bitmap_index;
+            if ( !lv_font_get_bitmap_fmt_txt( font, letter ) || ( lv_font_host_rle_bits + 7 ) / 8 > stored || ( lv_font_host_rle_bits + 7 ) / 8 + 1 < stored ) {
+                printf( "letter U+%X: %d bits read, %d bytes stored\n", letter, lv_font_host_rle_bits, stored );
+                return( false );
+            }
+            ( *glyphs )++;
+        }
+    }
+    return( true );
+}
+
+int main( int argc, char **argv ) {
+    uint32_t days = argc > 1 ? atoi( argv[ 1 ] ) : SIM_DAYS;
+    band_h = argc > 2 ? atoi( argv[ 2 ] ) : SIM_BAND_H;
+    sim_result_t uncached[ SIM_EVENTS ], cached[ SIM_EVENTS ];
+    uint32_t count[ SIM_EVENTS ];
+
+    if ( band_h < 1 || band_h > SIM_MAX_BAND_H || days < 1 ) {
+        printf( "band height 1..%d, at least one day\n", SIM_MAX_BAND_H );
+        return( 1 );
+    }
+    for( const lv_font_t *font : { &Ubuntu_16px, &Ubuntu_72px } ) {
+        uint32_t glyphs;
+        bool ok = check_decoder( font, &glyphs );
+        printf( "%-40s %s\n", font == &Ubuntu_16px ? "decoder, Ubuntu_16px" : "decoder, Ubuntu_72px", ok ? "ok" : "FAILED" );
+        printf( "  %d glyphs end at the next glyph\n", glyphs );
+        failed += ok ? 0 : 1;
+    }
+    /*
+     * the same days without and with the cache, the drawn bands have to match
+     */
+    sim_run( days, uncached, count );
+    glyph_cache_register( &Ubuntu_16px, "Ubuntu_16px" );
+    glyph_cache_register( &Ubuntu_72px, "Ubuntu_72px" );
+    sim_run( days, cached, count );
+    bool ok = uncached[ SIM_MINUTE ].hash == cached[ SIM_MINUTE ].hash && uncached[ SIM_WAKEUP ].hash == cached[ SIM_WAKEUP ].hash;
+    printf( "%-40s %s\n", "cached bands match uncached bands", ok ? "ok" : "FAILED" );
+    failed += ok ? 0 : 1;
+
+    printf( "%d days, %d line bands, %d byte cache\n", days, band_h, GLYPH_CACHE_SIZE );
+    printf( "%-12s %-9s %10s %16s %12s\n", "per refresh", "", "bitmaps", "decompressed px", "host us" );
+    for( uint32_t e = 0 ; e < SIM_EVENTS ; e++ ) {
+        for( sim_result_t *r : { &uncached[ e ], &cached[ e ] } ) {
+            printf( "%-12s %-9s %10.1f %16.0f %12.2f\n", sim_event_name[ e ], r == &cached[ e ] ? "cached" : "uncached",
+                    (double)r->bitmaps / count[ e ], (double)r->decompressed_px / count[ e ], (double)r->us / count[ e ] );
+        }
+    }
+    printf( "%-16s %10s %10s %8s %8s\n", "font", "hits", "misses", "glyphs", "bytes" );
+    for( int32_t i = 0 ; i < glyph_cache_get_fonts() ; i++ ) {
+        const glyph_cache_font_stats_t *stats = glyph_cache_get_font_stats( i );
+        printf( "%-16s %10d %10d %8d %8d\n", stats->name, stats->hits, stats->misses, stats->entrys, stats->bytes );
+    }
+    const bench_entry_t *decompress = bench_get_entry( glyph_cache_bench_decompress );
+    printf( "glyph decompress: %d misses, %d us max on the host\n", decompress->count, decompress->max_us );
+    printf( "%s\n", failed ? "FAILED" : "all ok" );
+    return( failed ? 1 : 0 );
+}
@@ -0,0 +1,350 @@
+/*
+ * Replay NMEA logs through the gps pipeline from src/utils/nmea.cpp and
+ * src/utils/track.cpp and report the cpu time per fix, the callback
+ * events per fix and the track size per hour for several simplification
+ * tolerances.
+ *
+ * build:   g++ -O2 tools/gps_bench.cpp -o gps_bench
+ * usage:   gps_bench [directory] [log.nmea ...]
+ *
+ * without logs a walk, a run, a bike ride and an hour sitting still are
+ * synthesized, one burst of RMC, VTG, GGA, GSA, GSV and GLL per second
+ * like a multi constellation receiver sends it, with a correlated 2.5m
+ * position error and a lost fix in the middle. track files are written
+ * to directory, default /tmp.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <string>
+#include <vector>
+
+#include "../src/utils/nmea.cpp"
+#include "../src/utils/track.cpp"
+
+#define BENCH_START         1792324800      /* 2026-10-18 12:00 utc */
+#define BENCH_SECONDS       3600
+#define BENCH_REPEAT        20              /* parse runs for the cpu time */
+#define BENCH_M_PER_DEG     111320.0
+
+static const float tolerances[] = { 0.0f, 2.0f, 5.0f, 10.0f };
+#define TOLERANCES          ( sizeof( tolerances ) / sizeof( tolerances[ 0 ] ) )
+
+static uint64_t now_ns( void ) {
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return( (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec );
+}
+
+static double rnd( void ) {
+    return( (double)rand() / RAND_MAX );
+}
+
+static double gauss( void ) {
+    return( sqrt( -2.0 * log( rnd() * 0.999999 + 0.000001 ) ) * cos( 6.283185 * rnd() ) );
+}
+
+static void sentence( std::string &log, const char *body ) {
+    uint8_t checksum = 0;
+    char tail[ 8 ];
+
+    for( const char *c = body ; *c ; c++ ) {
+        checksum ^= *c;
+    }
+    snprintf( tail, sizeof( tail ), "*%02X\r\n", checksum );
+    log += "$";
+    log += body;
+    log += tail;
+}
+
+static void coordinate( char *text, size_t size, double deg, bool lat ) {
+    char hemisphere = lat ? ( deg < 0 ? 'S' : 'N' ) : ( deg < 0 ? 'W' : 'E' );
+    deg = fabs( deg );
+    int whole = (int)deg;
+    double minutes = ( deg - whole ) * 60.0;
+    snprintf( text, size, lat ? "%02d%08.5f,%c" : "%03d%08.5f,%c", whole, minutes, hemisphere );
+}
+
+/*
+ * one hour at speed m/s with smooth turns, the fix is lost from minute
+ * 30 to 31
+ */
+static std::string synthesize( double speed ) {
+    std::string log;
+    double lat = 52.52, lon = 13.40, alt = 35.0;
+    double heading = rnd() * 6.283;
+    double turn = 0.0;
+    double error_n = 0.0, error_e = 0.0, error_u = 0.0;
+    char body[ 160 ], lat_text[ 24 ], lon_text[ 24 ];
+
+    for( int s = 0 ; s < BENCH_SECONDS ; s++ ) {
+        uint32_t t = BENCH_START + s;
+        int hh = t / 3600 % 24, mm = t / 60 % 60, ss = t % 60;
+        bool fix = s < 1800 || s >= 1860;
+
+        turn = turn * 0.95 + gauss() * 0.01;
+        if ( rnd() < 0.003 ) {
+            turn += ( rnd() - 0.5 ) * 1.5;
+        }
+        heading += turn;
+        lat += speed * cos( heading ) / BENCH_M_PER_DEG;
+        lon += speed * sin( heading ) / ( BENCH_M_PER_DEG * cos( lat * M_PI / 180.0 ) );
+        alt += speed * 0.02 * sin( s / 300.0 );
+        error_n = error_n * 0.95 + gauss() * 2.5 * sqrt( 1.0 - 0.95 * 0.95 );
+        error_e = error_e * 0.95 + gauss() * 2.5 * sqrt( 1.0 - 0.95 * 0.95 );
+        error_u = error_u * 0.95 + gauss() * 4.0 * sqrt( 1.0 - 0.95 * 0.95 );
+
+        double m_lat = lat + error_n / BENCH_M_PER_DEG;
+        double m_lon = lon + error_e / ( BENCH_M_PER_DEG * cos( lat * M_PI / 180.0 ) );
+        double knots = fabs( speed + gauss() * 0.2 ) * 1.943844;
+        double course = fmod( heading * 180.0 / M_PI + 3600.0, 360.0 );
+        int sats = 9 + rand() % 3;
+        coordinate( lat_text, sizeof( lat_text ), m_lat, true );
+        coordinate( lon_text, sizeof( lon_text ), m_lon, false );
+
+        if ( fix ) {
+            snprintf( body, sizeof( body ), "GNRMC,%02d%02d%02d.000,A,%s,%s,%.2f,%.2f,181026,,,A", hh, mm, ss, lat_text, lon_text, knots, course );
+            sentence( log, body );
+            snprintf( body, sizeof( body ), "GNVTG,%.2f,T,,M,%.2f,N,%.2f,K,A", course, knots, knots * 1.852 );
+            sentence( log, body );
+            snprintf( body, sizeof( body ), "GNGGA,%02d%02d%02d.000,%s,%s,1,%02d,%.2f,%.1f,M,39.6,M,,", hh, mm, ss, lat_text, lon_text, sats, 0.9 + rnd() * 0.4, alt + error_u );
+            sentence( log, body );
+            sentence( log, "GNGSA,A,3,05,07,13,15,18,23,24,30,,,,,1.61,0.97,1.28" );
+            sentence( log, "GNGSA,A,3,68,69,84,,,,,,,,,,1.61,0.97,1.28" );
+        }
+        else {
+            snprintf( body, sizeof( body ), "GNRMC,%02d%02d%02d.000,V,,,,,,,181026,,,N", hh, mm, ss );
+            sentence( log, body );
+            sentence( log, "GNVTG,,,,,,,,,N" );
+            snprintf( body, sizeof( body ), "GNGGA,%02d%02d%02d.000,,,,,0,00,25.5,,,,,,", hh, mm, ss );
+            sentence( log, body );
+            sentence( log, "GNGSA,A,1,,,,,,,,,,,,,25.5,25.5,25.5" );
+        }
+        sentence( log, "GPGSV,3,1,12,05,41,307,31,07,23,052,28,13,72,180,35,15,38,247,29" );
+        sentence( log, "GPGSV,3,2,12,18,12,320,22,23,08,098,,24,55,134,33,30,61,274,34" );
+        sentence( log, "GPGSV,3,3,12,10,05,025,,16,02,199,,26,03,352,,29,01,140,,0" );
+        sentence( log, "GLGSV,1,1,03,68,44,110,30,69,67,311,27,84,31,055,24" );
+        if ( fix ) {
+            snprintf( body, sizeof( body ), "GNGLL,%s,%s,%02d%02d%02d.000,A,A", lat_text, lon_text, hh, mm, ss );
+        }
+        else {
+            snprintf( body, sizeof( body ), "GNGLL,,,,,%02d%02d%02d.000,V,N", hh, mm, ss );
+        }
+        sentence( log, body );
+    }
+    return( log );
+}
+
+static bool read_file( const char *filename, std::string &log ) {
+    FILE *file = fopen( filename, "rb" );
+    char buffer[ 4096 ];
+    size_t len;
+
+    if ( !file ) {
+        return( false );
+    }
+    while( ( len = fread( buffer, 1, sizeof( buffer ), file ) ) > 0 ) {
+        log.append( buffer, len );
+    }
+    fclose( file );
+    return( true );
+}
+
+/*
+ * feed the log like the uart task: chunks of the uart fifo size and a
+ * flush when the receiver goes quiet after a burst
+ */
+static void parse( const std::string &log, std::vector<nmea_fix_t> *fixes, nmea_stats_t *stats ) {
+    nmea_parser_t p;
+    nmea_fix_t fix;
+
+    nmea_init( &p );
+    for( size_t pos = 0 ; pos < log.size() ; pos += 120 ) {
+        const char *data = log.data() + pos;
+        size_t len = log.size() - pos < 120 ? log.size() - pos : 120;
+        while( len ) {
+            if ( nmea_parse( &p, &data, &len, &fix ) && fixes ) {
+                fixes->push_back( fix );
+            }
+        }
+    }
+    if ( nmea_flush( &p, &fix ) && fixes ) {
+        fixes->push_back( fix );
+    }
+    *stats = p.stats;
+}
+
+/*
+ * the gpsctl mapping of a fix to a track point
+ */
+static bool to_point( const nmea_fix_t *fix, track_point_t *point ) {
+    if ( !( fix->valid & NMEA_LOCATION ) || !nmea_get_unix_time( fix ) ) {
+        return( false );
+    }
+    point->time = nmea_get_unix_time( fix );
+    point->lat = ( fix->lat + ( fix->lat < 0 ? -5 : 5 ) ) / 10;
+    point->lon = ( fix->lon + ( fix->lon < 0 ? -5 : 5 ) ) / 10;
+    point->altitude = fix->valid & NMEA_ALTITUDE ? fix->altitude_cm / 10 : 0;
+    return( true );
+}
+
+static double distance_m( const track_point_t *p, const track_point_t *a, const track_point_t *b ) {
+    double scale = cos( p->lat * M_PI / 180.0 / TRACK_DEG_SCALE ) * BENCH_M_PER_DEG / TRACK_DEG_SCALE;
+    double m = BENCH_M_PER_DEG / TRACK_DEG_SCALE;
+    return( track_segment_distance( 0.0f, 0.0f, ( a->lon - p->lon ) * scale, ( a->lat - p->lat ) * m, ( b->lon - p->lon ) * scale, ( b->lat - p->lat ) * m ) );
+}
+
+/*
+ * max distance of the recorded points to the simplified track, each point
+ * is checked against the simplified segment that covers its time
+ */
+static double max_error( const std::vector<track_point_t> &points, const std::vector<track_point_t> &kept, const std::vector<bool> &starts ) {
+    double max = 0.0;
+    size_t k = 0;
+
+    for( size_t i = 0 ; i < points.size() ; i++ ) {
+        const track_point_t *p = &points[ i ];
+        while( k + 1 < kept.size() && kept[ k + 1 ].time <= p->time ) {
+            k++;
+        }
+        if ( kept[ k ].time == p->time || k + 1 >= kept.size() || starts[ k + 1 ] ) {
+            continue;
+        }
+        double d = distance_m( p, &kept[ k ], &kept[ k + 1 ] );
+        max = d > max ? d : max;
+    }
+    return( max );
+}
+
+static int run( const char *name, const std::string &log, const char *directory ) {
+    std::vector<nmea_fix_t> fixes;
+    std::vector<track_point_t> points;
+    nmea_stats_t stats;
+    int errors = 0;
+
+    parse( log, &fixes, &stats );
+    uint64_t start = now_ns();
+    for( int i = 0 ; i < BENCH_REPEAT ; i++ ) {
+        parse( log, NULL, &stats );
+    }
+    double parse_ns = ( now_ns() - start ) / (double)BENCH_REPEAT;
+    /*
+     * the old gpsctl sent location, speed, altitude and satellites each
+     * time a sentence carried them, the new one sends one event per epoch
+     * with changed fields
+     */
+    uint32_t events_old = 0, events_new = 0;
+    for( size_t i = 0 ; i < fixes.size() ; i++ ) {
+        const nmea_fix_t *f = &fixes[ i ];
+        events_old += !!( f->valid & NMEA_LOCATION ) + !!( f->valid & NMEA_SPEED ) + !!( f->valid & NMEA_ALTITUDE ) + !!( f->valid & NMEA_SATELLITES );
+        events_new += !!( f->updated & ( NMEA_LOCATION | NMEA_SPEED | NMEA_ALTITUDE | NMEA_SATELLITES ) );
+        track_point_t point;
+        if ( to_point( f, &point ) ) {
+            points.push_back( point );
+        }
+    }
+    double hours = fixes.size() ? ( fixes.size() ) / 3600.0 : 1.0;
+
+    printf( "\n%s: %zu bytes, %u sentences, %u checksum errors, %u fixes, %zu with location\n", name, log.size(), stats.sentences, stats.checksum_errors, stats.epochs, points.size() );
+    printf( "parse\t\t%.1f ns/byte, %.2f us/fix\n", parse_ns / log.size(), parse_ns / 1000.0 / ( stats.epochs ? stats.epochs : 1 ) );
+    printf( "events/fix\told %.2f, new %.2f\n", (double)events_old / fixes.size(), (double)events_new / fixes.size() );
+    printf( "nmea\t\t%.0f bytes/h\n", log.size() / hours );
+    printf( "tolerance\tpoints\tbytes/h\tbytes/point\tgpx bytes/h\tmax error\trecord us/fix\n" );
+
+    for( size_t t = 0 ; t < TOLERANCES ; t++ ) {
+        char filename[ 256 ];
+        track_t *track = (track_t *)malloc( sizeof( track_t ) );
+        snprintf( filename, sizeof( filename ), "%s/gps_bench.trk", directory );
+        remove( filename );
+        if ( !track_open( track, filename, tolerances[ t ] ) ) {
+            printf( "can't open %s\n", filename );
+            free( track );
+            return( 1 );
+        }
+        start = now_ns();
+        bool fix = true;
+        size_t p = 0;
+        for( size_t i = 0 ; i < fixes.size() ; i++ ) {
+            track_point_t point;
+            if ( to_point( &fixes[ i ], &point ) ) {
+                track_add( track, &point );
+                fix = true;
+                p++;
+            }
+            else if ( fix ) {
+                track_break( track );
+                fix = false;
+            }
+        }
+        track_close( track );
+        double record_ns = now_ns() - start;
+        /*
+         * decode, check the lossless case and the error of the simplified track
+         */
+        track_reader_t reader;
+        std::vector<track_point_t> kept;
+        std::vector<bool> starts;
+        track_point_t point;
+        bool segment_start;
+        track_reader_open( &reader, filename );
+        while( track_reader_next( &reader, &point, &segment_start ) ) {
+            kept.push_back( point );
+            starts.push_back( segment_start );
+        }
+        track_reader_close( &reader );
+        if ( tolerances[ t ] == 0.0f ) {
+            bool same = kept.size() == points.size();
+            for( size_t i = 0 ; same && i < kept.size() ; i++ ) {
+                same = !memcmp( &kept[ i ], &points[ i ], sizeof( track_point_t ) );
+            }
+            if ( !same ) {
+                printf( "lossless round trip failed\n" );
+                errors++;
+            }
+        }
+        double error = max_error( points, kept, starts );
+        if ( error > tolerances[ t ] + 0.05 ) {
+            errors++;
+        }
+        track_gpx_t gpx;
+        char buffer[ 512 ];
+        size_t gpx_bytes = 0, len;
+        track_gpx_open( &gpx, filename );
+        while( ( len = track_gpx_read( &gpx, buffer, sizeof( buffer ) ) ) > 0 ) {
+            gpx_bytes += len;
+        }
+        track_gpx_close( &gpx );
+
+        printf( "%.0fm\t\t%zu\t%.0f\t%.2f\t\t%.0f\t\t%.2fm\t\t%.3f\n", tolerances[ t ], kept.size(), track->stats.bytes_written / hours,
+                kept.size() ? (double)track->stats.bytes_encoded / kept.size() : 0.0, gpx_bytes / hours, error, record_ns / 1000.0 / ( p ? p : 1 ) );
+        free( track );
+    }
+    return( errors );
+}
+
+int main( int argc, char **argv ) {
+    const char *directory = argc > 1 ? argv[ 1 ] : "/tmp";
+    int errors = 0;
+
+    srand( 1 );
+    if ( argc > 2 ) {
+        for( int i = 2 ; i < argc ; i++ ) {
+            std::string log;
+            if ( !read_file( argv[ i ], log ) ) {
+                printf( "can't read %s\n", argv[ i ] );
+                return( 1 );
+            }
+            errors += run( argv[ i ], log, directory );
+        }
+    }
+    else {
+        errors += run( "walk 1.4m/s", synthesize( 1.4 ), directory );
+        errors += run( "run 3m/s", synthesize( 3.0 ), directory );
+        errors += run( "bike 6m/s", synthesize( 6.0 ), directory );
+        errors += run( "sitting", synthesize( 0.0 ), directory );
+    }
+    printf( "\n%s\n", errors ? "FAILED" : "ok" );
+    return( errors ? 1 : 0 );
+}
@@ -0,0 +1,66 @@
+/*
+ * Host replacement for src/config.h. Tools that include a module which
+ * pulls in "config.h", <esp_timer.h>, "hardware/powermgm.h",
+ * "lvgl/lvgl.h" or <esp32-hal-psram.h> build with -Itools/host, so the
+ * module source is used unchanged.
+ *
+ * log_* calls are only printed with -DHOST_LOG, benchmarks would measure
+ * the printf otherwise. the formats are written for the 32 bit esp32, so
+ * -Wformat warns with -DHOST_LOG.
+ */
+#ifndef _CONFIG_H
+    #define _CONFIG_H
+
+    #include <stdio.h>
+    #include <stdlib.h>
+    #include <stdint.h>
+    #include <stdbool.h>
+    #include <string.h>
+    #include <time.h>
+
+    #ifdef HOST_LOG
+        #define host_log( level, format, ... )  fprintf( stderr, "[" level "] " format "\n", ##__VA_ARGS__ )
+    #else
+        static inline void host_log_none( const char *format, ... ) {}
+        #define host_log( level, format, ... )  host_log_none( format, ##__VA_ARGS__ )
+    #endif
+    #define log_e( format, ... )        host_log( "E", format, ##__VA_ARGS__ )
+    #define log_w( format, ... )        host_log( "W", format, ##__VA_ARGS__ )
+    #define log_i( format, ... )        host_log( "I", format, ##__VA_ARGS__ )
+    #define log_d( format, ... )        host_log( "D", format, ##__VA_ARGS__ )
+
+    /*
+     * one thread on the host, critical sections are empty
+     */
+    typedef int portMUX_TYPE;
+    #define portMUX_INITIALIZER_UNLOCKED    0
+    #define portENTER_CRITICAL( mux )       do { (void)( mux ); } while( 0 )
+    #define portEXIT_CRITICAL( mux )        do { (void)( mux ); } while( 0 )
+    #define DRAM_ATTR
+    #define IRAM_ATTR
+
+    typedef uint32_t EventBits_t;
+
+    /*
+     * older glibc has no strlcpy
+     */
+    static inline size_t host_strlcpy( char *dst, const char *src, size_t size ) {
+        size_t len = strlen( src );
+
+        if ( size ) {
+            size_t n = len < size - 1 ? len : size - 1;
+            memcpy( dst, src, n );
+            dst[ n ] = '\0';
+        }
+        return( len );
+    }
+    #define strlcpy host_strlcpy
+
+    static inline uint32_t millis( void ) {
+        struct timespec ts;
+
+        clock_gettime( CLOCK_MONOTONIC, &ts );
+        return( ts.tv_sec * 1000 + ts.tv_nsec / 1000000 );
+    }
+
+#endif // _CONFIG_H
@@ -0,0 +1,14 @@
+/*
+ * Host replacement for esp32-hal-psram.h, tools build with -DBOARD_HAS_PSRAM
+ * to get the PSRAM sized buffers of the watch, see tools/host/config.h.
+ */
+#ifndef _ESP32_HAL_PSRAM_H_
+    #define _ESP32_HAL_PSRAM_H_
+
+    #include <stdlib.h>
+
+    #define ps_malloc       malloc
+    #define ps_calloc       calloc
+    #define ps_realloc      realloc
+
+#endif // _ESP32_HAL_PSRAM_H_
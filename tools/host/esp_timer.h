@@ -0,0 +1,17 @@
+/*
+ * Host replacement for <esp_timer.h>, see config.h
+ */
+#ifndef _ESP_TIMER_H
+    #define _ESP_TIMER_H
+
+    #include <stdint.h>
+    #include <time.h>
+
+    static inline int64_t esp_timer_get_time( void ) {
+        struct timespec ts;
+
+        clock_gettime( CLOCK_MONOTONIC, &ts );
+        return( (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000 );
+    }
+
+#endif // _ESP_TIMER_H
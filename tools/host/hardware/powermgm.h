@@ -0,0 +1,28 @@
+/*
+ * Host replacement for src/hardware/powermgm.h, see config.h. There is
+ * no powermgm loop on the host, registered callbacks are never called.
+ */
+#ifndef _POWERMGM_H
+    #define _POWERMGM_H
+
+    #include "config.h"
+
+    #ifndef _BV
+        #define _BV( bit )              ( 1 << ( bit ) )
+    #endif
+
+    #define POWERMGM_STANDBY            _BV(0)
+    #define POWERMGM_SILENCE_WAKEUP     _BV(2)
+    #define POWERMGM_WAKEUP             _BV(4)
+
+    typedef bool ( * CALLBACK_FUNC ) ( EventBits_t event, void *arg );
+
+    static inline bool powermgm_register_cb( EventBits_t event, CALLBACK_FUNC callback_func, const char *id ) {
+        return( true );
+    }
+
+    static inline bool powermgm_register_loop_cb( EventBits_t event, CALLBACK_FUNC callback_func, const char *id ) {
+        return( true );
+    }
+
+#endif // _POWERMGM_H
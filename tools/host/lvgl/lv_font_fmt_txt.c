@@ -0,0 +1,238 @@
+/*
+ * Host build of the LVGL 7 fmt_txt font reader from lv_font_fmt_txt.c:
+ * cmap lookup, class kerning and the RLE + xor prefilter decompression
+ * of the glyph bitmaps. kern pairs and the full cmap formats are left
+ * out, the fonts in src/gui/font don't use them.
+ *
+ * build as C next to the tool, e.g. -x c tools/host/lvgl/lv_font_fmt_txt.c
+ */
+#include <stdlib.h>
+#include <string.h>
+
+#include "lvgl.h"
+
+uint32_t lv_font_host_rle_bits = 0;
+uint32_t lv_font_host_decompressed_px = 0;
+
+typedef enum {
+    RLE_STATE_SINGLE = 0,
+    RLE_STATE_REPEATE,
+    RLE_STATE_COUNTER,
+} rle_state_t;
+
+static const uint8_t *rle_in;
+static uint32_t rle_rdp;
+static uint8_t rle_bpp;
+static uint8_t rle_prev_v;
+static uint8_t rle_cnt;
+static rle_state_t rle_state;
+
+static uint8_t *decompr_buf = NULL;
+static uint32_t decompr_size = 0;
+
+static int unicode_list_compare( const void *ref, const void *element ) {
+    return( *(const uint16_t *)ref - *(const uint16_t *)element );
+}
+
+static uint32_t get_glyph_dsc_id( const lv_font_t *font, uint32_t letter ) {
+    const lv_font_fmt_txt_dsc_t *fdsc = (const lv_font_fmt_txt_dsc_t *)font->dsc;
+
+    for( uint32_t i = 0 ; i < fdsc->cmap_num ; i++ ) {
+        const lv_font_fmt_txt_cmap_t *cmap = &fdsc->cmaps[ i ];
+        uint32_t rcp = letter - cmap->range_start;
+        if ( letter < cmap->range_start || rcp > cmap->range_length ) {
+            continue;
+        }
+        if ( cmap->type == LV_FONT_FMT_TXT_CMAP_FORMAT0_TINY ) {
+            return( cmap->glyph_id_start + rcp );
+        }
+        if ( cmap->type == LV_FONT_FMT_TXT_CMAP_SPARSE_TINY ) {
+            uint16_t key = rcp;
+            const uint16_t *p = (const uint16_t *)bsearch( &key, cmap->unicode_list, cmap->list_length, sizeof( uint16_t ), unicode_list_compare );
+            if ( p ) {
+                return( cmap->glyph_id_start + ( p - cmap->unicode_list ) );
+            }
+        }
+    }
+    return( 0 );
+}
+
+static int8_t get_kern_value( const lv_font_t *font, uint32_t gid_left, uint32_t gid_right ) {
+    const lv_font_fmt_txt_dsc_t *fdsc = (const lv_font_fmt_txt_dsc_t *)font->dsc;
+
+    if ( !fdsc->kern_classes ) {
+        return( 0 );
+    }
+    const lv_font_fmt_txt_kern_classes_t *kdsc = (const lv_font_fmt_txt_kern_classes_t *)fdsc->kern_dsc;
+    uint8_t left_class = kdsc->left_class_mapping[ gid_left ];
+    uint8_t right_class = kdsc->right_class_mapping[ gid_right ];
+    if ( left_class > 0 && right_class > 0 ) {
+        return( kdsc->class_pair_values[ ( left_class - 1 ) * kdsc->right_class_cnt + ( right_class - 1 ) ] );
+    }
+    return( 0 );
+}
+
+bool lv_font_get_glyph_dsc_fmt_txt( const lv_font_t *font, lv_font_glyph_dsc_t *dsc_out, uint32_t unicode_letter, uint32_t unicode_letter_next ) {
+    const lv_font_fmt_txt_dsc_t *fdsc = (const lv_font_fmt_txt_dsc_t *)font->dsc;
+    bool is_tab = false;
+
+    if ( unicode_letter == '\t' ) {
+        unicode_letter = ' ';
+        is_tab = true;
+    }
+    uint32_t gid = get_glyph_dsc_id( font, unicode_letter );
+    if ( !gid ) {
+        return( false );
+    }
+    int8_t kvalue = 0;
+    if ( fdsc->kern_dsc ) {
+        uint32_t gid_next = get_glyph_dsc_id( font, unicode_letter_next );
+        if ( gid_next ) {
+            kvalue = get_kern_value( font, gid, gid_next );
+        }
+    }
+    const lv_font_fmt_txt_glyph_dsc_t *gdsc = &fdsc->glyph_dsc[ gid ];
+    int32_t kv = ( (int32_t)kvalue * fdsc->kern_scale ) >> 4;
+    uint32_t adv_w = gdsc->adv_w;
+    if ( is_tab ) {
+        adv_w *= 2;
+    }
+    adv_w += kv;
+    adv_w = ( adv_w + ( 1 << 3 ) ) >> 4;
+
+    dsc_out->adv_w = adv_w;
+    dsc_out->box_h = gdsc->box_h;
+    dsc_out->box_w = is_tab ? gdsc->box_w * 2 : gdsc->box_w;
+    dsc_out->ofs_x = gdsc->ofs_x;
+    dsc_out->ofs_y = gdsc->ofs_y;
+    dsc_out->bpp = fdsc->bpp;
+    return( true );
+}
+
+static uint8_t get_bits( const uint8_t *in, uint32_t bit_pos, uint8_t len ) {
+    uint8_t bit_mask = ( 1 << len ) - 1;
+    uint32_t byte_pos = bit_pos >> 3;
+
+    bit_pos &= 0x7;
+    if ( bit_pos + len >= 8 ) {
+        uint16_t in16 = ( in[ byte_pos ] << 8 ) + in[ byte_pos + 1 ];
+        return( ( in16 >> ( 16 - bit_pos - len ) ) & bit_mask );
+    }
+    return( ( in[ byte_pos ] >> ( 8 - bit_pos - len ) ) & bit_mask );
+}
+
+static void bits_write( uint8_t *out, uint32_t bit_pos, uint8_t val, uint8_t len ) {
+    static const uint8_t bpp3_to_4[] = { 0, 2, 4, 6, 9, 11, 13, 15 };
+
+    if ( len == 3 ) {
+        len = 4;
+        val = bpp3_to_4[ val ];
+    }
+    uint32_t byte_pos = bit_pos >> 3;
+    uint8_t shift = 8 - ( bit_pos & 0x7 ) - len;
+    uint8_t bit_mask = ( 1 << len ) - 1;
+    out[ byte_pos ] = ( out[ byte_pos ] & ~( bit_mask << shift ) ) | ( val << shift );
+}
+
+static uint8_t rle_next( void ) {
+    uint8_t ret = 0;
+
+    if ( rle_state == RLE_STATE_SINGLE ) {
+        ret = get_bits( rle_in, rle_rdp, rle_bpp );
+        if ( rle_rdp != 0 && rle_prev_v == ret ) {
+            rle_cnt = 0;
+            rle_state = RLE_STATE_REPEATE;
+        }
+        rle_prev_v = ret;
+        rle_rdp += rle_bpp;
+    }
+    else if ( rle_state == RLE_STATE_REPEATE ) {
+        uint8_t v = get_bits( rle_in, rle_rdp, 1 );
+        rle_cnt++;
+        rle_rdp += 1;
+        if ( v == 1 ) {
+            ret = rle_prev_v;
+            if ( rle_cnt == 11 ) {
+                rle_cnt = get_bits( rle_in, rle_rdp, 6 );
+                rle_rdp += 6;
+                if ( rle_cnt != 0 ) {
+                    rle_state = RLE_STATE_COUNTER;
+                }
+                else {
+                    ret = get_bits( rle_in, rle_rdp, rle_bpp );
+                    rle_prev_v = ret;
+                    rle_rdp += rle_bpp;
+                    rle_state = RLE_STATE_SINGLE;
+                }
+            }
+        }
+        else {
+            ret = get_bits( rle_in, rle_rdp, rle_bpp );
+            rle_prev_v = ret;
+            rle_rdp += rle_bpp;
+            rle_state = RLE_STATE_SINGLE;
+        }
+    }
+    else {
+        ret = rle_prev_v;
+        rle_cnt--;
+        if ( rle_cnt == 0 ) {
+            ret = get_bits( rle_in, rle_rdp, rle_bpp );
+            rle_prev_v = ret;
+            rle_rdp += rle_bpp;
+            rle_state = RLE_STATE_SINGLE;
+        }
+    }
+    return( ret );
+}
+
+static void decompress( const uint8_t *in, uint8_t *out, lv_coord_t w, lv_coord_t h, uint8_t bpp, bool prefilter ) {
+    uint8_t line_buf1[ 256 ], line_buf2[ 256 ];
+    uint8_t wr_size = bpp == 3 ? 4 : bpp;
+    uint32_t wrp = 0;
+
+    rle_in = in;
+    rle_bpp = bpp;
+    rle_state = RLE_STATE_SINGLE;
+    rle_rdp = 0;
+    rle_prev_v = 0;
+    rle_cnt = 0;
+
+    for( lv_coord_t y = 0 ; y < h ; y++ ) {
+        for( lv_coord_t x = 0 ; x < w ; x++ ) {
+            line_buf2[ x ] = rle_next();
+            line_buf1[ x ] = prefilter && y ? line_buf1[ x ] ^ line_buf2[ x ] : line_buf2[ x ];
+            bits_write( out, wrp, line_buf1[ x ], bpp );
+            wrp += wr_size;
+        }
+    }
+    lv_font_host_rle_bits = rle_rdp;
+    lv_font_host_decompressed_px += w * h;
+}
+
+const uint8_t *lv_font_get_bitmap_fmt_txt( const lv_font_t *font, uint32_t unicode_letter ) {
+    const lv_font_fmt_txt_dsc_t *fdsc = (const lv_font_fmt_txt_dsc_t *)font->dsc;
+
+    if ( unicode_letter == '\t' ) {
+        unicode_letter = ' ';
+    }
+    uint32_t gid = get_glyph_dsc_id( font, unicode_letter );
+    if ( !gid ) {
+        return( NULL );
+    }
+    const lv_font_fmt_txt_glyph_dsc_t *gdsc = &fdsc->glyph_dsc[ gid ];
+    if ( fdsc->bitmap_format == LV_FONT_FMT_TXT_PLAIN ) {
+        return( &fdsc->glyph_bitmap[ gdsc->bitmap_index ] );
+    }
+    uint32_t gsize = gdsc->box_w * gdsc->box_h;
+    if ( gsize == 0 ) {
+        return( NULL );
+    }
+    uint32_t buf_size = fdsc->bpp == 1 ? ( gsize + 7 ) >> 3 : fdsc->bpp == 2 ? ( gsize + 3 ) >> 2 : ( gsize + 1 ) >> 1;
+    if ( decompr_size < buf_size ) {
+        decompr_buf = (uint8_t *)realloc( decompr_buf, buf_size );
+        decompr_size = buf_size;
+    }
+    decompress( &fdsc->glyph_bitmap[ gdsc->bitmap_index ], decompr_buf, gdsc->box_w, gdsc->box_h, fdsc->bpp, fdsc->bitmap_format == LV_FONT_FMT_TXT_COMPRESSED );
+    return( decompr_buf );
+}
@@ -0,0 +1,138 @@
+/*
+ * Host replacement for the parts of lvgl/lvgl.h the image cache, the
+ * glyph cache and the font files use, see tools/host/config.h.
+ *
+ * the font types follow LVGL 7 lv_font.h and lv_font_fmt_txt.h, so the
+ * generated font files in src/gui/font build unchanged as C. the fmt_txt
+ * reader is in tools/host/lvgl/lv_font_fmt_txt.c.
+ */
+#ifndef LVGL_H
+    #define LVGL_H
+
+    #include <stdint.h>
+    #include <stdbool.h>
+
+    #define LVGL_VERSION_MAJOR          7
+    #define LVGL_VERSION_MINOR          7
+    #define LV_ATTRIBUTE_LARGE_CONST
+
+    #ifdef __cplusplus
+    extern "C" {
+    #endif
+
+    enum {
+        LV_IMG_SRC_VARIABLE,
+        LV_IMG_SRC_FILE,
+        LV_IMG_SRC_SYMBOL,
+        LV_IMG_SRC_UNKNOWN,
+    };
+    typedef uint8_t lv_img_src_t;
+
+    static inline void lv_img_cache_invalidate_src( const void *src ) { (void)src; }
+
+    typedef int16_t lv_coord_t;
+
+    enum {
+        LV_FONT_SUBPX_NONE,
+        LV_FONT_SUBPX_HOR,
+        LV_FONT_SUBPX_VER,
+        LV_FONT_SUBPX_BOTH,
+    };
+
+    typedef struct {
+        uint16_t adv_w;
+        uint16_t box_w;
+        uint16_t box_h;
+        int16_t ofs_x;
+        int16_t ofs_y;
+        uint8_t bpp;
+    } lv_font_glyph_dsc_t;
+
+    typedef struct _lv_font_struct {
+        bool (*get_glyph_dsc)( const struct _lv_font_struct *, lv_font_glyph_dsc_t *, uint32_t letter, uint32_t letter_next );
+        const uint8_t * (*get_glyph_bitmap)( const struct _lv_font_struct *, uint32_t letter );
+        lv_coord_t line_height;
+        lv_coord_t base_line;
+        uint8_t subpx : 2;
+        void *dsc;
+    } lv_font_t;
+
+    #define LV_FONT_DECLARE( font_name )    extern lv_font_t font_name;
+
+    typedef struct {
+        uint32_t bitmap_index : 20;
+        uint32_t adv_w : 12;
+        uint8_t box_w;
+        uint8_t box_h;
+        int8_t ofs_x;
+        int8_t ofs_y;
+    } lv_font_fmt_txt_glyph_dsc_t;
+
+    enum {
+        LV_FONT_FMT_TXT_CMAP_FORMAT0_FULL,
+        LV_FONT_FMT_TXT_CMAP_SPARSE_FULL,
+        LV_FONT_FMT_TXT_CMAP_FORMAT0_TINY,
+        LV_FONT_FMT_TXT_CMAP_SPARSE_TINY,
+    };
+    typedef uint8_t lv_font_fmt_txt_cmap_type_t;
+
+    typedef struct {
+        uint32_t range_start;
+        uint16_t range_length;
+        uint16_t glyph_id_start;
+        const uint16_t *unicode_list;
+        const void *glyph_id_ofs_list;
+        uint16_t list_length;
+        lv_font_fmt_txt_cmap_type_t type;
+    } lv_font_fmt_txt_cmap_t;
+
+    typedef struct {
+        const int8_t *class_pair_values;
+        const uint8_t *left_class_mapping;
+        const uint8_t *right_class_mapping;
+        uint8_t left_class_cnt;
+        uint8_t right_class_cnt;
+    } lv_font_fmt_txt_kern_classes_t;
+
+    enum {
+        LV_FONT_FMT_TXT_PLAIN = 0,
+        LV_FONT_FMT_TXT_COMPRESSED = 1,
+        LV_FONT_FMT_TXT_COMPRESSED_NO_PREFILTER = 2,
+    };
+
+    typedef struct {
+        const uint8_t *glyph_bitmap;
+        const lv_font_fmt_txt_glyph_dsc_t *glyph_dsc;
+        const lv_font_fmt_txt_cmap_t *cmaps;
+        const void *kern_dsc;
+        uint16_t kern_scale;
+        uint16_t cmap_num : 9;
+        uint16_t bpp : 4;
+        uint16_t kern_classes : 1;
+        uint16_t bitmap_format : 2;
+        uint32_t last_letter;
+        uint32_t last_glyph_id;
+    } lv_font_fmt_txt_dsc_t;
+
+    bool lv_font_get_glyph_dsc_fmt_txt( const lv_font_t *font, lv_font_glyph_dsc_t *dsc_out, uint32_t unicode_letter, uint32_t unicode_letter_next );
+    const uint8_t *lv_font_get_bitmap_fmt_txt( const lv_font_t *font, uint32_t unicode_letter );
+
+    static inline bool lv_font_get_glyph_dsc( const lv_font_t *font, lv_font_glyph_dsc_t *dsc_out, uint32_t letter, uint32_t letter_next ) {
+        return( font->get_glyph_dsc( font, dsc_out, letter, letter_next ) );
+    }
+
+    static inline const uint8_t *lv_font_get_glyph_bitmap( const lv_font_t *font, uint32_t letter ) {
+        return( font->get_glyph_bitmap( font, letter ) );
+    }
+
+    /*
+     * host only, filled by lv_font_get_bitmap_fmt_txt
+     */
+    extern uint32_t lv_font_host_rle_bits;          /* compressed bits read by the last decompress */
+    extern uint32_t lv_font_host_decompressed_px;   /* pixels decompressed since start */
+
+    #ifdef __cplusplus
+    }
+    #endif
+
+#endif // LVGL_H
@@ -0,0 +1,305 @@
+/*
+ * Register 100 tiles like the mainbar does and jump across them, with the
+ * tile index from src/gui/mainbar/tile_index.cpp against the old per tile
+ * realloc, a linear scan and the old low bits position hash.
+ *
+ * build:   g++ -O2 tools/mainbar_bench.cpp -o mainbar_bench
+ * usage:   mainbar_bench [seed]
+ *
+ * the layout follows mainbar_add_app_tile(): 12 fixed tiles in the rows
+ * 0 to 2 and app tiles side by side from row 4 on, most apps are one
+ * tile, some have a setup tile below or beside the main tile. a jump
+ * looks up the target tile by position, calls the hibernate callback of
+ * the current tile and the activate callback of the new one and keeps
+ * the runtimes like mainbar_jump_to_tilenumber().
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../src/gui/mainbar/tile_index.cpp"
+
+#define BENCH_TILES         100
+#define BENCH_RESERVE       48              /* MAINBAR_TILE_RESERVE */
+#define BENCH_GROWTH        2               /* MAINBAR_TILE_GROWTH */
+#define BENCH_APP_Y_START   4               /* MAINBAR_APP_TILE_Y_START */
+#define BENCH_REGISTER_RUNS 1000
+#define BENCH_JUMPS         1000000
+
+/**
+ * @brief same layout as lv_tile_t
+ */
+typedef struct {
+    void *tile;
+    void ( *activate_cb )( void );
+    void ( *hibernate_cb )( void );
+    void ( *setup_cb )( void );
+    uint16_t x;
+    uint16_t y;
+    const char *id;
+    uint32_t activations;
+    uint32_t activate_us;
+    uint32_t activate_max_us;
+    uint32_t hibernate_us;
+    uint32_t hibernate_max_us;
+} bench_tile_t;
+
+typedef struct {
+    int16_t x;
+    int16_t y;
+} bench_point_t;
+
+static uint16_t pos_x[ BENCH_TILES ];
+static uint16_t pos_y[ BENCH_TILES ];
+static char ids[ BENCH_TILES ][ 24 ];
+static volatile uint32_t callback_count = 0;
+
+static uint64_t now_ns( void ) {
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return( (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec );
+}
+
+static void bench_cb( void ) {
+    callback_count++;
+}
+
+static void layout( void ) {
+    uint32_t n = 0, app_x = 0;
+
+    for( uint16_t y = 0 ; y < 3 ; y++ ) {
+        for( uint16_t x = 0 ; x < 4 ; x++ ) {
+            pos_x[ n ] = x;
+            pos_y[ n ] = y;
+            snprintf( ids[ n ], sizeof( ids[ n ] ), "fixed tile %d", n );
+            n++;
+        }
+    }
+    for( uint32_t app = 0 ; n < BENCH_TILES ; app++ ) {
+        uint32_t w = 1, h = 1;
+        switch( rand() % 6 ) {
+            case 0:     w = 2; break;
+            case 1:     h = 2; break;
+        }
+        for( uint32_t x = 0 ; x < w && n < BENCH_TILES ; x++ ) {
+            for( uint32_t y = 0 ; y < h && n < BENCH_TILES ; y++ ) {
+                pos_x[ n ] = app_x + x;
+                pos_y[ n ] = BENCH_APP_Y_START + y;
+                snprintf( ids[ n ], sizeof( ids[ n ] ), "app %d", app );
+                n++;
+            }
+        }
+        app_x += w + 1;
+    }
+}
+
+/**
+ * @brief register all tiles, old: realloc both tables for every tile,
+ * new: reserve and grow, keep the index up to date
+ */
+static uint32_t register_tiles( bool old, bench_tile_t **tiles, tile_index_t *index ) {
+    bench_tile_t *tile = NULL;
+    bench_point_t *pos_table = NULL;
+    tile_index_pos_slot_t *pos_slots = NULL;
+    tile_index_id_slot_t *id_slots = NULL;
+    uint32_t capacity = 0, reallocs = 0;
+
+    for( uint32_t n = 0 ; n < BENCH_TILES ; n++ ) {
+        if ( old || n + 1 > capacity ) {
+            capacity = old ? n + 1 : ( capacity ? capacity * BENCH_GROWTH : BENCH_RESERVE );
+            tile = (bench_tile_t *)realloc( tile, sizeof( bench_tile_t ) * capacity );
+            pos_table = (bench_point_t *)realloc( pos_table, sizeof( bench_point_t ) * capacity );
+            reallocs += 2;
+            if ( !old ) {
+                uint32_t size = tile_index_slots( capacity );
+                pos_slots = (tile_index_pos_slot_t *)realloc( pos_slots, sizeof( tile_index_pos_slot_t ) * size );
+                id_slots = (tile_index_id_slot_t *)realloc( id_slots, sizeof( tile_index_id_slot_t ) * size );
+                reallocs += 2;
+                tile_index_init( index, pos_slots, id_slots, size );
+                for( uint32_t i = 0 ; i < n ; i++ ) {
+                    tile_index_add( index, tile[ i ].x, tile[ i ].y, tile[ i ].id, i );
+                }
+            }
+        }
+        memset( &tile[ n ], 0, sizeof( bench_tile_t ) );
+        tile[ n ].x = pos_table[ n ].x = pos_x[ n ];
+        tile[ n ].y = pos_table[ n ].y = pos_y[ n ];
+        tile[ n ].id = ids[ n ];
+        tile[ n ].activate_cb = bench_cb;
+        tile[ n ].hibernate_cb = bench_cb;
+        if ( !old ) {
+            tile_index_add( index, pos_x[ n ], pos_y[ n ], ids[ n ], n );
+        }
+    }
+    free( pos_table );
+    if ( tiles ) {
+        *tiles = tile;
+    }
+    else {
+        free( tile );
+        free( pos_slots );
+        free( id_slots );
+    }
+    return( reallocs );
+}
+
+static int32_t linear_pos( const bench_tile_t *tile, uint16_t x, uint16_t y, uint32_t *probes ) {
+    for( uint32_t i = 0 ; i < BENCH_TILES ; i++ ) {
+        ( *probes )++;
+        if ( tile[ i ].x == x && tile[ i ].y == y ) {
+            return( i );
+        }
+    }
+    return( -1 );
+}
+
+/**
+ * @brief the first mainbar index, slot = low bits of the fibonacci product
+ */
+static int16_t low_bits_table[ 1024 ];
+
+static void low_bits_build( const bench_tile_t *tile, uint32_t size ) {
+    for( uint32_t i = 0 ; i < size ; i++ ) {
+        low_bits_table[ i ] = -1;
+    }
+    for( uint32_t i = 0 ; i < BENCH_TILES ; i++ ) {
+        uint32_t slot = ( ( ( (uint32_t)tile[ i ].x << 16 ) | tile[ i ].y ) * 2654435761u ) & ( size - 1 );
+        while( low_bits_table[ slot ] != -1 ) {
+            slot = ( slot + 1 ) & ( size - 1 );
+        }
+        low_bits_table[ slot ] = i;
+    }
+}
+
+static int32_t low_bits_pos( const bench_tile_t *tile, uint32_t size, uint16_t x, uint16_t y, uint32_t *probes ) {
+    uint32_t slot = ( ( ( (uint32_t)x << 16 ) | y ) * 2654435761u ) & ( size - 1 );
+
+    while( low_bits_table[ slot ] != -1 ) {
+        ( *probes )++;
+        if ( tile[ low_bits_table[ slot ] ].x == x && tile[ low_bits_table[ slot ] ].y == y ) {
+            return( low_bits_table[ slot ] );
+        }
+        slot = ( slot + 1 ) & ( size - 1 );
+    }
+    return( -1 );
+}
+
+static int32_t index_pos( const tile_index_t *index, uint16_t x, uint16_t y, uint32_t *probes ) {
+    uint32_t pos = ( (uint32_t)x << 16 ) | y;
+    uint32_t slot = tile_index_pos_hash( pos ) >> index->shift;
+
+    while( index->pos[ slot ].tile != TILE_INDEX_FREE ) {
+        ( *probes )++;
+        if ( index->pos[ slot ].pos == pos ) {
+            return( index->pos[ slot ].tile );
+        }
+        slot = ( slot + 1 ) & ( index->size - 1 );
+    }
+    return( -1 );
+}
+
+static int32_t index_id( const tile_index_t *index, const char *id, uint32_t *probes ) {
+    uint32_t slot = tile_index_id_hash( id ) >> index->shift;
+
+    while( index->id[ slot ].tile != TILE_INDEX_FREE ) {
+        ( *probes )++;
+        if ( !strcmp( index->id[ slot ].id, id ) ) {
+            return( index->id[ slot ].tile );
+        }
+        slot = ( slot + 1 ) & ( index->size - 1 );
+    }
+    return( -1 );
+}
+
+static void jump( bench_tile_t *tile, uint32_t *current, int32_t target ) {
+    uint64_t start = now_ns();
+
+    tile[ *current ].hibernate_cb();
+    tile[ *current ].hibernate_us = ( now_ns() - start ) / 1000;
+    tile[ target ].activations++;
+    tile[ target ].activate_cb();
+    tile[ target ].activate_us = ( now_ns() - start ) / 1000;
+    *current = target;
+}
+
+int main( int argc, char **argv ) {
+    srand( argc > 1 ? atoi( argv[ 1 ] ) : 1 );
+    layout();
+
+    /*
+     * registration
+     */
+    uint64_t start = now_ns();
+    uint32_t old_reallocs = 0, new_reallocs = 0;
+    tile_index_t index;
+    for( uint32_t run = 0 ; run < BENCH_REGISTER_RUNS ; run++ ) {
+        old_reallocs = register_tiles( true, NULL, &index );
+    }
+    uint64_t old_ns = ( now_ns() - start ) / BENCH_REGISTER_RUNS;
+    start = now_ns();
+    for( uint32_t run = 0 ; run < BENCH_REGISTER_RUNS ; run++ ) {
+        new_reallocs = register_tiles( false, NULL, &index );
+    }
+    uint64_t new_ns = ( now_ns() - start ) / BENCH_REGISTER_RUNS;
+    printf( "register %d tiles\n", BENCH_TILES );
+    printf( "  realloc per tile          %4d reallocs %8.1f us\n", old_reallocs, old_ns / 1000.0 );
+    printf( "  reserve %d, growth %d     %4d reallocs %8.1f us  (incl. index)\n\n", BENCH_RESERVE, BENCH_GROWTH, new_reallocs, new_ns / 1000.0 );
+
+    bench_tile_t *tile;
+    register_tiles( false, &tile, &index );
+    low_bits_build( tile, index.size );
+
+    /*
+     * probe lengths, every tile looked up once
+     */
+    uint32_t linear_probes = 0, low_probes = 0, index_probes = 0, id_probes = 0;
+    uint32_t linear_max = 0, low_max = 0, index_max = 0, id_max = 0;
+    for( uint32_t i = 0 ; i < BENCH_TILES ; i++ ) {
+        uint32_t p;
+        p = 0; if ( linear_pos( tile, pos_x[ i ], pos_y[ i ], &p ) != (int32_t)i ) { printf( "linear lookup failed\n" ); return( 1 ); }
+        linear_probes += p; linear_max = p > linear_max ? p : linear_max;
+        p = 0; if ( low_bits_pos( tile, index.size, pos_x[ i ], pos_y[ i ], &p ) != (int32_t)i ) { printf( "low bits lookup failed\n" ); return( 1 ); }
+        low_probes += p; low_max = p > low_max ? p : low_max;
+        p = 0; if ( index_pos( &index, pos_x[ i ], pos_y[ i ], &p ) != (int32_t)i || tile_index_get_pos( &index, pos_x[ i ], pos_y[ i ] ) != (int32_t)i ) { printf( "index lookup failed\n" ); return( 1 ); }
+        index_probes += p; index_max = p > index_max ? p : index_max;
+        p = 0; int32_t first = index_id( &index, ids[ i ], &p );
+        if ( first < 0 || first > (int32_t)i || strcmp( tile[ first ].id, ids[ i ] ) || tile_index_get_id( &index, ids[ i ] ) != first ) { printf( "id lookup failed\n" ); return( 1 ); }
+        id_probes += p; id_max = p > id_max ? p : id_max;
+    }
+    printf( "lookup, %d slots\n", index.size );
+    printf( "  linear scan               %5.1f probes avg %3d max\n", (double)linear_probes / BENCH_TILES, linear_max );
+    printf( "  position, low bits hash   %5.1f probes avg %3d max\n", (double)low_probes / BENCH_TILES, low_max );
+    printf( "  position, top bits hash   %5.1f probes avg %3d max\n", (double)index_probes / BENCH_TILES, index_max );
+    printf( "  id, top bits hash         %5.1f probes avg %3d max\n\n", (double)id_probes / BENCH_TILES, id_max );
+
+    /*
+     * jumps to random tiles, looked up by position
+     */
+    uint32_t *targets = (uint32_t *)malloc( sizeof( uint32_t ) * BENCH_JUMPS );
+    for( uint32_t i = 0 ; i < BENCH_JUMPS ; i++ ) {
+        targets[ i ] = rand() % BENCH_TILES;
+    }
+    printf( "%d jumps across %d tiles\n", BENCH_JUMPS, BENCH_TILES );
+    for( uint32_t method = 0 ; method < 3 ; method++ ) {
+        static const char *names[] = { "linear scan", "low bits hash", "tile index" };
+        uint32_t current = 0, probes = 0;
+        start = now_ns();
+        for( uint32_t i = 0 ; i < BENCH_JUMPS ; i++ ) {
+            uint16_t x = pos_x[ targets[ i ] ], y = pos_y[ targets[ i ] ];
+            int32_t target;
+            switch( method ) {
+                case 0:     target = linear_pos( tile, x, y, &probes ); break;
+                case 1:     target = low_bits_pos( tile, index.size, x, y, &probes ); break;
+                default:    target = tile_index_get_pos( &index, x, y ); break;
+            }
+            jump( tile, &current, target );
+        }
+        printf( "  %-24s %6.1f ns per jump\n", names[ method ], (double)( now_ns() - start ) / BENCH_JUMPS );
+    }
+    free( targets );
+    free( tile );
+    free( index.pos );
+    free( index.id );
+    return( 0 );
+}
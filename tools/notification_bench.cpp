@@ -0,0 +1,208 @@
+/*
+ * Push 10000 notifications through the notification store from
+ * src/utils/notification_store.cpp and report the add and get time,
+ * next to a linked list with one CALLOC per string like the removed
+ * msg_chain. Every stored notification is checked against what was
+ * pushed: order, eviction of the oldest, interned source, utf-8 safe
+ * truncation and the NOTIFICATION_TRUNCATED_* flags.
+ *
+ * build:   g++ -O2 -Itools/host tools/notification_bench.cpp -o notification_bench
+ * usage:   notification_bench [count] [seed]
+ *
+ * sources come from a small set of apps with a rare one-off app mixed
+ * in, so the intern arena runs full and is compacted. every 7th push
+ * deletes a random notification like a swipe in the message tile.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "../src/utils/bench.cpp"
+#include "../src/utils/notification_store.cpp"
+
+#define BENCH_COUNT         10000
+#define BENCH_DELETE_EVERY  7
+
+static const char *apps[] = { "WhatsApp", "Telegram", "Signal", "Gmail", "K-9 Mail", "Calendar", "Phone", "SMS", "Slack", "Threema", "Twitter", "Home Assistant" };
+static const char *words[] = { "hello", "meeting", "at", "noon", "Grüße", "aus", "Köln", "😀", "ok", "see", "you", "später", "ночь", "東京", "tomorrow", "⚡" };
+
+typedef struct {
+    int32_t id;
+    std::string src, title, sender, body;
+} pushed_t;
+
+static int failed = 0;
+
+static std::string text( uint32_t max_len ) {
+    std::string s;
+    uint32_t len = rand() % max_len;
+
+    while( s.size() < len ) {
+        if ( !s.empty() ) {
+            s += ' ';
+        }
+        s += words[ rand() % ( sizeof( words ) / sizeof( words[ 0 ] ) ) ];
+    }
+    return( s );
+}
+
+/**
+ * @brief check a stored string against the pushed one, a cut string is a
+ * prefix on a character boundary plus NOTIFICATION_TRUNCATED_MARK
+ */
+static bool check_string( const char *stored, const std::string &pushed, size_t size, bool truncated ) {
+    if ( pushed.size() < size ) {
+        return( !truncated && pushed == stored );
+    }
+    size_t len = strlen( stored );
+    size_t mark = sizeof( NOTIFICATION_TRUNCATED_MARK ) - 1;
+    if ( !truncated || len >= size || len < mark || strcmp( &stored[ len - mark ], NOTIFICATION_TRUNCATED_MARK ) ) {
+        return( false );
+    }
+    size_t cut = len - mark;
+    return( pushed.compare( 0, cut, stored, cut ) == 0 && ( pushed[ cut ] & 0xc0 ) != 0x80 );
+}
+
+/*
+ * the removed msg_chain: every add walks to the tail, every get walks
+ * from the head, each raw msg is one CALLOC
+ */
+typedef struct chain_entry_t {
+    char *msg;
+    struct chain_entry_t *next;
+} chain_entry_t;
+
+static chain_entry_t *chain = NULL;
+static int32_t chain_entrys = 0;
+
+static void chain_add( const char *msg ) {
+    chain_entry_t *entry = (chain_entry_t *)calloc( sizeof( chain_entry_t ), 1 );
+    entry->msg = (char *)calloc( strlen( msg ) + 1, 1 );
+    strcpy( entry->msg, msg );
+    chain_entry_t **tail = &chain;
+    while( *tail ) {
+        tail = &( *tail )->next;
+    }
+    *tail = entry;
+    chain_entrys++;
+}
+
+static const char *chain_get( int32_t entry ) {
+    chain_entry_t *current = chain;
+    while( current && entry-- ) {
+        current = current->next;
+    }
+    return( current ? current->msg : NULL );
+}
+
+static void chain_delete_first( void ) {
+    chain_entry_t *first = chain;
+    chain = first->next;
+    free( first->msg );
+    free( first );
+    chain_entrys--;
+}
+
+int main( int argc, char **argv ) {
+    uint32_t count = argc > 1 ? atoi( argv[ 1 ] ) : BENCH_COUNT;
+    srand( argc > 2 ? atoi( argv[ 2 ] ) : 1 );
+
+    notification_store_t *store = notification_store_create();
+    if ( store == NULL ) {
+        printf( "notification_store_create failed\n" );
+        return( 1 );
+    }
+    std::vector<pushed_t> expected;
+    uint32_t truncated = 0, deletes = 0, default_src = 0;
+    uint64_t get_us = 0, chain_add_us = 0, chain_get_us = 0;
+
+    for( uint32_t i = 0 ; i < count ; i++ ) {
+        pushed_t p;
+        p.id = 1000 + i;
+        p.src = i % 50 == 49 ? "One-off App " + std::to_string( i ) : apps[ rand() % ( sizeof( apps ) / sizeof( apps[ 0 ] ) ) ];
+        p.title = text( 90 );
+        p.sender = text( 80 );
+        p.body = text( 1200 );
+
+        const notification_t *n = notification_store_add( store, p.id, p.src.c_str(), p.title.c_str(), p.sender.c_str(), p.body.c_str(), NOTIFICATION_NO_ICON );
+        if ( n == NULL ) {
+            printf( "add %d failed\n", i );
+            return( 1 );
+        }
+        truncated += n->truncated ? 1 : 0;
+        default_src += strcmp( n->src, p.src.c_str() ) ? 1 : 0;
+        if ( expected.size() == NOTIFICATION_STORE_ENTRYS ) {
+            expected.erase( expected.begin() );
+        }
+        expected.push_back( p );
+        if ( i % BENCH_DELETE_EVERY == BENCH_DELETE_EVERY - 1 ) {
+            uint32_t entry = rand() % expected.size();
+            notification_store_delete( store, entry );
+            expected.erase( expected.begin() + entry );
+            deletes++;
+        }
+        /*
+         * read every entry like the message tile does, then check them
+         */
+        uint64_t start = esp_timer_get_time();
+        int32_t ids = 0;
+        for( int32_t e = 0 ; e < notification_store_get_entrys( store ) ; e++ ) {
+            ids += notification_store_get( store, e )->id;
+        }
+        get_us += esp_timer_get_time() - start;
+
+        bool ok = notification_store_get_entrys( store ) == (int32_t)expected.size() && ids;
+        for( uint32_t e = 0 ; ok && e < expected.size() ; e++ ) {
+            const notification_t *stored = notification_store_get( store, e );
+            ok = stored && stored->id == expected[ e ].id
+                        && ( !strcmp( stored->src, expected[ e ].src.c_str() ) || !strcmp( stored->src, "Message" ) )
+                        && stored->body_len == expected[ e ].body.size()
+                        && check_string( stored->title, expected[ e ].title, NOTIFICATION_TITLE_SIZE, stored->truncated & NOTIFICATION_TRUNCATED_TITLE )
+                        && check_string( stored->sender, expected[ e ].sender, NOTIFICATION_SENDER_SIZE, stored->truncated & NOTIFICATION_TRUNCATED_SENDER )
+                        && check_string( stored->body, expected[ e ].body, NOTIFICATION_BODY_SIZE, stored->truncated & NOTIFICATION_TRUNCATED_BODY );
+        }
+        if ( !ok ) {
+            printf( "store content wrong after push %d\n", i );
+            failed++;
+            break;
+        }
+        /*
+         * the same with the chain, the raw msg is about the json gadgetbridge sends
+         */
+        std::string raw = "{\"t\":\"notify\",\"id\":" + std::to_string( p.id ) + ",\"src\":\"" + p.src + "\",\"title\":\"" + p.title + "\",\"sender\":\"" + p.sender + "\",\"body\":\"" + p.body + "\"}";
+        start = esp_timer_get_time();
+        if ( chain_entrys == NOTIFICATION_STORE_ENTRYS ) {
+            chain_delete_first();
+        }
+        chain_add( raw.c_str() );
+        chain_add_us += esp_timer_get_time() - start;
+        start = esp_timer_get_time();
+        for( int32_t e = 0 ; e < chain_entrys ; e++ ) {
+            if ( chain_get( e ) == NULL ) {
+                failed++;
+            }
+        }
+        chain_get_us += esp_timer_get_time() - start;
+    }
+
+    const bench_entry_t *add = bench_get_entry( notification_store_bench_add );
+    printf( "%d notifications, %d deleted, %d cut, %d with default src, %d stored\n", count, deletes, truncated, default_src, notification_store_get_entrys( store ) );
+    printf( "store: %d bytes allocated once\n", (int)( sizeof( notification_t ) * NOTIFICATION_STORE_ENTRYS + NOTIFICATION_STORE_INTERN_SIZE ) );
+    printf( "%-28s %10s %10s\n", "", "avg ns", "max us" );
+    printf( "%-28s %10.0f %10d\n", "store add", add->total_us * 1000.0 / add->count, add->max_us );
+    printf( "%-28s %10.0f %10s\n", "store get all", get_us * 1000.0 / count, "" );
+    printf( "%-28s %10.0f %10s\n", "msg_chain add", chain_add_us * 1000.0 / count, "" );
+    printf( "%-28s %10.0f %10s\n", "msg_chain get all", chain_get_us * 1000.0 / count, "" );
+    printf( "the msg_chain numbers do not include the json parse every consumer did on each get\n" );
+
+    while( chain_entrys ) {
+        chain_delete_first();
+    }
+    free( store->slab );
+    free( store->intern );
+    free( store );
+    printf( "%s\n", failed ? "FAILED" : "all ok" );
+    return( failed ? 1 : 0 );
+}
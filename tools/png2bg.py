@@ -0,0 +1,58 @@
+#!/usr/bin/env python3
+"""
+Convert an image into a pre-baked background (bg.bin) in the native display
+color format, the format is read by src/gui/background.cpp.
+
+usage: png2bg.py [--swap] [--no-crc] bg.png [bg.bin]
+
+  --swap    swap the bytes of each pixel, only for LV_COLOR_16_SWAP=1 builds
+  --no-crc  don't bind the bin file to the source png, use this if bg.png is
+            not uploaded to the watch
+"""
+import struct
+import sys
+import zlib
+
+from PIL import Image
+
+# must match background_bin_header_t, 24 bytes
+HEADER = struct.Struct("<IBBBBHHIII")
+BACKGROUND_BIN_MAGIC = 0x4e424742
+BACKGROUND_BIN_VERSION = 2
+LV_COLOR_DEPTH = 16
+LV_IMG_CF_TRUE_COLOR = 4
+
+
+def convert(infile, outfile, swap, crc):
+    with open(infile, "rb") as f:
+        src_crc = zlib.crc32(f.read()) & 0xffffffff if crc else 0
+    img = Image.open(infile).convert("RGBA")
+    w, h = img.size
+    # transparent pixels are blended onto black like on the watch
+    black = Image.new("RGBA", img.size, (0, 0, 0, 255))
+    img = Image.alpha_composite(black, img).convert("RGB")
+
+    pixel = struct.Struct(">H" if swap else "<H")
+    data = bytearray()
+    for r, g, b in img.getdata():
+        data += pixel.pack(((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3))
+
+    with open(outfile, "wb") as out:
+        out.write(HEADER.pack(BACKGROUND_BIN_MAGIC, BACKGROUND_BIN_VERSION, LV_COLOR_DEPTH,
+                              1 if swap else 0, LV_IMG_CF_TRUE_COLOR, w, h, src_crc,
+                              0, 0))  # size and mtime of bg.png on the watch are set on the first load
+        out.write(data)
+    sys.stderr.write("%s: %dx%d, %d bytes\n" % (outfile, w, h, HEADER.size + len(data)))
+
+
+def main():
+    args = [a for a in sys.argv[1:] if not a.startswith("--")]
+    if not args:
+        sys.stderr.write(__doc__)
+        sys.exit(1)
+    outfile = args[1] if len(args) > 1 else "bg.bin"
+    convert(args[0], outfile, "--swap" in sys.argv, "--no-crc" not in sys.argv)
+
+
+if __name__ == "__main__":
+    main()
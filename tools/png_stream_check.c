@@ -0,0 +1,247 @@
+/*
+ * Check the row streaming png decoder from src/gui/png_decoder/png_stream.c
+ * against lodepng. Test images for all supported color types are encoded
+ * with every png filter type, with and without tRNS, and once more with
+ * the IDAT data split into small chunks. Crafted IHDR headers with a
+ * zero, too large or overflowing size must be rejected.
+ *
+ * build:   gcc -O2 -Isrc tools/png_stream_check.c src/gui/png_decoder/png_stream.c
+ *              src/gui/png_decoder/lodepng.c src/utils/ESP32-targz/uzlib/tinflate.c
+ *              src/utils/ESP32-targz/uzlib/tinfzlib.c src/utils/ESP32-targz/uzlib/adler32.c
+ *              src/utils/ESP32-targz/uzlib/crc32.c -o png_stream_check
+ * usage:   png_stream_check [directory]
+ *
+ * the test files are written to directory, default /tmp.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "gui/png_decoder/lodepng.h"
+#include "gui/png_decoder/png_stream.h"
+
+#define CHECK_WIDTH         61
+#define CHECK_HEIGHT        37
+#define CHECK_IDAT_SPLIT    97              /* bytes per IDAT chunk in the split files */
+
+static char filename[ 256 ];
+static int failed = 0;
+
+static void be32( uint8_t *data, uint32_t value ) {
+    data[ 0 ] = value >> 24;
+    data[ 1 ] = value >> 16;
+    data[ 2 ] = value >> 8;
+    data[ 3 ] = value;
+}
+
+static uint32_t get_be32( const uint8_t *data ) {
+    return( ( (uint32_t)data[ 0 ] << 24 ) | ( (uint32_t)data[ 1 ] << 16 ) | ( (uint32_t)data[ 2 ] << 8 ) | data[ 3 ] );
+}
+
+static void write_file( const uint8_t *data, size_t size ) {
+    FILE *file = fopen( filename, "wb" );
+
+    if ( file == NULL || fwrite( data, 1, size, file ) != size ) {
+        printf( "can't write %s\n", filename );
+        exit( 1 );
+    }
+    fclose( file );
+}
+
+/**
+ * @brief copy a png with all IDAT data split into CHECK_IDAT_SPLIT byte chunks,
+ * chunk crcs are not checked by the stream decoder
+ */
+static size_t split_idat( const uint8_t *png, size_t size, uint8_t *out ) {
+    size_t pos = 8, out_size = 8;
+
+    memcpy( out, png, 8 );
+    while( pos + 12 <= size ) {
+        uint32_t len = get_be32( &png[ pos ] );
+        if ( memcmp( &png[ pos + 4 ], "IDAT", 4 ) ) {
+            memcpy( &out[ out_size ], &png[ pos ], len + 12 );
+            out_size += len + 12;
+        }
+        else {
+            for( uint32_t i = 0 ; i < len ; i += CHECK_IDAT_SPLIT ) {
+                uint32_t part = len - i < CHECK_IDAT_SPLIT ? len - i : CHECK_IDAT_SPLIT;
+                be32( &out[ out_size ], part );
+                memcpy( &out[ out_size + 4 ], "IDAT", 4 );
+                memcpy( &out[ out_size + 8 ], &png[ pos + 8 + i ], part );
+                be32( &out[ out_size + 8 + part ], 0 );
+                out_size += part + 12;
+            }
+        }
+        pos += len + 12;
+    }
+    return( out_size );
+}
+
+/**
+ * @brief decode the current file with png_stream, row by row and once more
+ * backwards to check the rewind, and compare with the lodepng result of png
+ */
+static void compare( const char *name, const uint8_t *png, size_t size ) {
+    uint8_t *ref;
+    unsigned w, h;
+
+    if ( lodepng_decode32( &ref, &w, &h, png, size ) ) {
+        printf( "%-28s lodepng failed\n", name );
+        failed++;
+        return;
+    }
+    png_stream_t *stream = png_stream_open( filename );
+    if ( stream == NULL || stream->width != w || stream->height != h ) {
+        printf( "%-28s open failed\n", name );
+        failed++;
+        free( ref );
+        png_stream_close( stream );
+        return;
+    }
+    uint32_t diff = 0;
+    for( uint32_t pass = 0 ; pass < 2 ; pass++ ) {
+        for( uint32_t i = 0 ; i < h ; i++ ) {
+            uint32_t y = pass ? h - 1 - i : i;
+            const uint8_t *row = png_stream_read_row( stream, y );
+            if ( row == NULL || memcmp( row, &ref[ y * w * 4 ], w * 4 ) ) {
+                diff++;
+            }
+        }
+    }
+    printf( "%-28s %s\n", name, diff ? "FAILED" : "ok" );
+    failed += diff ? 1 : 0;
+    png_stream_close( stream );
+    free( ref );
+}
+
+static void check_color_type( LodePNGColorType color_type, bool trns ) {
+    static const char *color_names[] = { "gray", "", "rgb", "palette", "gray+alpha", "", "rgba" };
+    static const char *filter_names[] = { "none", "sub", "up", "average", "paeth", "mixed" };
+    uint8_t filters[ CHECK_HEIGHT ];
+    uint8_t *rgba = (uint8_t *)malloc( CHECK_WIDTH * CHECK_HEIGHT * 4 );
+
+    /*
+     * a gradient with a few repeated colors, so the palette stays small and
+     * tRNS keys are hit
+     */
+    for( uint32_t y = 0 ; y < CHECK_HEIGHT ; y++ ) {
+        for( uint32_t x = 0 ; x < CHECK_WIDTH ; x++ ) {
+            uint8_t *px = &rgba[ ( y * CHECK_WIDTH + x ) * 4 ];
+            uint8_t v = ( ( x / 4 ) * 16 + ( y / 4 ) * 8 ) & 0xf8;
+            px[ 0 ] = v;
+            px[ 1 ] = color_type == LCT_GREY || color_type == LCT_GREY_ALPHA ? v : ( v + 64 ) & 0xf8;
+            px[ 2 ] = color_type == LCT_GREY || color_type == LCT_GREY_ALPHA ? v : ( 255 - v ) & 0xf8;
+            px[ 3 ] = 0xff;
+            if ( color_type == LCT_RGBA || color_type == LCT_GREY_ALPHA ) {
+                px[ 3 ] = x * 4;
+            }
+            else if ( color_type == LCT_PALETTE ) {
+                px[ 3 ] = ( x / 16 ) * 85;
+            }
+        }
+    }
+    /*
+     * every row with one png filter type, the last pass cycles through all
+     */
+    for( int filter = 0 ; filter <= 5 ; filter++ ) {
+        LodePNGState state;
+        uint8_t *png, *split;
+        size_t size, split_size;
+        char name[ 64 ];
+
+        lodepng_state_init( &state );
+        state.info_png.color.colortype = color_type;
+        state.info_png.color.bitdepth = 8;
+        state.info_raw.colortype = LCT_RGBA;
+        state.info_raw.bitdepth = 8;
+        state.encoder.auto_convert = 0;
+        state.encoder.filter_strategy = LFS_PREDEFINED;
+        state.encoder.filter_palette_zero = 0;
+        state.encoder.predefined_filters = filters;
+        for( uint32_t y = 0 ; y < CHECK_HEIGHT ; y++ ) {
+            filters[ y ] = filter < 5 ? filter : y % 5;
+        }
+        if ( color_type == LCT_PALETTE ) {
+            for( uint32_t i = 0 ; i < CHECK_WIDTH * CHECK_HEIGHT ; i++ ) {
+                LodePNGColorMode *mode = &state.info_png.color;
+                size_t n = 0;
+                while( n < mode->palettesize && memcmp( &mode->palette[ n * 4 ], &rgba[ i * 4 ], 4 ) ) {
+                    n++;
+                }
+                if ( n == mode->palettesize ) {
+                    lodepng_palette_add( mode, rgba[ i * 4 ], rgba[ i * 4 + 1 ], rgba[ i * 4 + 2 ], rgba[ i * 4 + 3 ] );
+                }
+            }
+        }
+        if ( trns ) {
+            state.info_png.color.key_defined = 1;
+            state.info_png.color.key_r = rgba[ 0 ];
+            state.info_png.color.key_g = rgba[ 1 ];
+            state.info_png.color.key_b = rgba[ 2 ];
+        }
+        if ( lodepng_encode( &png, &size, rgba, CHECK_WIDTH, CHECK_HEIGHT, &state ) ) {
+            printf( "%s encode failed: %s\n", color_names[ color_type ], lodepng_error_text( state.error ) );
+            failed++;
+            lodepng_state_cleanup( &state );
+            continue;
+        }
+        snprintf( name, sizeof( name ), "%s%s %s", color_names[ color_type ], trns ? "+trns" : "", filter_names[ filter ] );
+        write_file( png, size );
+        compare( name, png, size );
+
+        split = (uint8_t *)malloc( size * 2 + 1024 );
+        split_size = split_idat( png, size, split );
+        write_file( split, split_size );
+        strncat( name, " split", sizeof( name ) - strlen( name ) - 1 );
+        compare( name, png, size );
+
+        free( split );
+        free( png );
+        lodepng_state_cleanup( &state );
+    }
+    free( rgba );
+}
+
+/**
+ * @brief a png with only signature and IHDR, png_stream_open must fail
+ * before it looks at the missing IDAT
+ */
+static void check_header( const char *name, uint32_t width, uint32_t height, uint8_t color_type ) {
+    uint8_t png[ 33 ] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n', 0, 0, 0, 13, 'I', 'H', 'D', 'R' };
+
+    be32( &png[ 16 ], width );
+    be32( &png[ 20 ], height );
+    png[ 24 ] = 8;
+    png[ 25 ] = color_type;
+    write_file( png, sizeof( png ) );
+
+    png_stream_t *stream = png_stream_open( filename );
+    printf( "%-28s %s\n", name, stream ? "FAILED" : "ok" );
+    failed += stream ? 1 : 0;
+    png_stream_close( stream );
+}
+
+int main( int argc, char **argv ) {
+    const char *directory = argc > 1 ? argv[ 1 ] : "/tmp";
+
+    snprintf( filename, sizeof( filename ), "%s/png_stream_check.png", directory );
+
+    check_color_type( LCT_GREY, false );
+    check_color_type( LCT_GREY, true );
+    check_color_type( LCT_RGB, false );
+    check_color_type( LCT_RGB, true );
+    check_color_type( LCT_PALETTE, false );
+    check_color_type( LCT_GREY_ALPHA, false );
+    check_color_type( LCT_RGBA, false );
+
+    check_header( "width 0", 0, 240, 6 );
+    check_header( "height 0", 240, 0, 6 );
+    check_header( "width too large", PNG_STREAM_MAX_SIZE + 1, 1, 6 );
+    check_header( "height too large", 1, PNG_STREAM_MAX_SIZE + 1, 6 );
+    check_header( "width * 4 overflow", 0x40000001, 1, 6 );
+    check_header( "width * 3 overflow", 0x55555556, 1, 2 );
+
+    remove( filename );
+    printf( "%s\n", failed ? "FAILED" : "all ok" );
+    return( failed ? 1 : 0 );
+}
@@ -0,0 +1,760 @@
+/*
+ * Scroll through tall split jpg images with the frame handling of
+ * src/gui/sjpg_decoder/lv_sjpg.c and report the decode and conversion
+ * cost per display frame for the old single RGB888 frame with a per pixel
+ * conversion on every line read, for the converted frames in the image
+ * cache from src/gui/img_cache.cpp and for the image cache with the
+ * prefetch of the next frame in scroll direction. TJpgDec and the
+ * conversions from src/gui/sjpg_decoder/sjpg_convert.c are used as they
+ * are, tjpgd.c is C and is built next to the tool. The packed and the
+ * dithered conversion are checked against the per pixel one.
+ *
+ * build:   g++ -O2 -DBOARD_HAS_PSRAM -Itools/host -Isrc tools/sjpg_bench.cpp -x c src/gui/sjpg_decoder/tjpgd.c -o sjpg_bench
+ * usage:   sjpg_bench [file.sjpg ...]
+ *
+ * without files two samples are synthesized with a small baseline jpeg
+ * encoder and split into 16 line frames like the lvgl jpg_to_sjpg
+ * converter does: a 240x1920 photo like gradient and a 240x1920 chat
+ * screenshot with text like high contrast blocks. without
+ * -DBOARD_HAS_PSRAM the image cache has the 64k of a watch without PSRAM.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <string>
+#include <vector>
+
+#include "../src/gui/sjpg_decoder/tjpgd.h"
+#include "../src/gui/sjpg_decoder/sjpg_convert.c"
+#include "../src/gui/img_cache.cpp"
+
+#define SIM_WIDTH           240
+#define SIM_HEIGHT          240             /* visible rows */
+#define SIM_BAND_H          20              /* FRAMEBUFFER_BUFFER_H, rows per LVGL render band */
+#define SIM_SCROLL_PX       12              /* scroll speed in rows per display frame */
+#define SIM_FRAME_H         16              /* sjpg frame height */
+#define SIM_IMAGE_H         1920
+#define SIM_QUALITY         85
+#define TJPGD_WORKBUFF_SIZE 4096            /* lv_sjpg.c */
+
+static int failed = 0;
+
+static uint64_t now_ns( void ) {
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return( (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec );
+}
+
+/*
+ * baseline jpeg encoder, 4:4:4 YCbCr with the tables from annex K
+ */
+static const uint8_t zigzag[ 64 ] = {
+     0,  1,  8, 16,  9,  2,  3, 10, 17, 24, 32, 25, 18, 11,  4,  5,
+    12, 19, 26, 33, 40, 48, 41, 34, 27, 20, 13,  6,  7, 14, 21, 28,
+    35, 42, 49, 56, 57, 50, 43, 36, 29, 22, 15, 23, 30, 37, 44, 51,
+    58, 59, 52, 45, 38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63 };
+static const uint8_t quant_luma[ 64 ] = {
+    16, 11, 10, 16,  24,  40,  51,  61,  12, 12, 14, 19,  26,  58,  60,  55,
+    14, 13, 16, 24,  40,  57,  69,  56,  14, 17, 22, 29,  51,  87,  80,  62,
+    18, 22, 37, 56,  68, 109, 103,  77,  24, 35, 55, 64,  81, 104, 113,  92,
+    49, 64, 78, 87, 103, 121, 120, 101,  72, 92, 95, 98, 112, 100, 103,  99 };
+static const uint8_t quant_chroma[ 64 ] = {
+    17, 18, 24, 47, 99, 99, 99, 99,  18, 21, 26, 66, 99, 99, 99, 99,
+    24, 26, 56, 99, 99, 99, 99, 99,  47, 66, 99, 99, 99, 99, 99, 99,
+    99, 99, 99, 99, 99, 99, 99, 99,  99, 99, 99, 99, 99, 99, 99, 99,
+    99, 99, 99, 99, 99, 99, 99, 99,  99, 99, 99, 99, 99, 99, 99, 99 };
+static const uint8_t dc_luma_bits[ 16 ] = { 0, 1, 5, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0 };
+static const uint8_t dc_chroma_bits[ 16 ] = { 0, 3, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0 };
+static const uint8_t dc_vals[ 12 ] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11 };
+static const uint8_t ac_luma_bits[ 16 ] = { 0, 2, 1, 3, 3, 2, 4, 3, 5, 5, 4, 4, 0, 0, 1, 0x7d };
+static const uint8_t ac_luma_vals[ 162 ] = {
+    0x01, 0x02, 0x03, 0x00, 0x04, 0x11, 0x05, 0x12, 0x21, 0x31, 0x41, 0x06, 0x13, 0x51, 0x61, 0x07,
+    0x22, 0x71, 0x14, 0x32, 0x81, 0x91, 0xa1, 0x08, 0x23, 0x42, 0xb1, 0xc1, 0x15, 0x52, 0xd1, 0xf0,
+    0x24, 0x33, 0x62, 0x72, 0x82, 0x09, 0x0a, 0x16, 0x17, 0x18, 0x19, 0x1a, 0x25, 0x26, 0x27, 0x28,
+    0x29, 0x2a, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49,
+    0x4a, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5a, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69,
+    0x6a, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7a, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89,
+    0x8a, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9a, 0xa2, 0xa3, 0xa4, 0xa5, 0xa6, 0xa7,
+    0xa8, 0xa9, 0xaa, 0xb2, 0xb3, 0xb4, 0xb5, 0xb6, 0xb7, 0xb8, 0xb9, 0xba, 0xc2, 0xc3, 0xc4, 0xc5,
+    0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xd2, 0xd3, 0xd4, 0xd5, 0xd6, 0xd7, 0xd8, 0xd9, 0xda, 0xe1, 0xe2,
+    0xe3, 0xe4, 0xe5, 0xe6, 0xe7, 0xe8, 0xe9, 0xea, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8,
+    0xf9, 0xfa };
+static const uint8_t ac_chroma_bits[ 16 ] = { 0, 2, 1, 2, 4, 4, 3, 4, 7, 5, 4, 4, 0, 1, 2, 0x77 };
+static const uint8_t ac_chroma_vals[ 162 ] = {
+    0x00, 0x01, 0x02, 0x03, 0x11, 0x04, 0x05, 0x21, 0x31, 0x06, 0x12, 0x41, 0x51, 0x07, 0x61, 0x71,
+    0x13, 0x22, 0x32, 0x81, 0x08, 0x14, 0x42, 0x91, 0xa1, 0xb1, 0xc1, 0x09, 0x23, 0x33, 0x52, 0xf0,
+    0x15, 0x62, 0x72, 0xd1, 0x0a, 0x16, 0x24, 0x34, 0xe1, 0x25, 0xf1, 0x17, 0x18, 0x19, 0x1a, 0x26,
+    0x27, 0x28, 0x29, 0x2a, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48,
+    0x49, 0x4a, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5a, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68,
+    0x69, 0x6a, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7a, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87,
+    0x88, 0x89, 0x8a, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9a, 0xa2, 0xa3, 0xa4, 0xa5,
+    0xa6, 0xa7, 0xa8, 0xa9, 0xaa, 0xb2, 0xb3, 0xb4, 0xb5, 0xb6, 0xb7, 0xb8, 0xb9, 0xba, 0xc2, 0xc3,
+    0xc4, 0xc5, 0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xd2, 0xd3, 0xd4, 0xd5, 0xd6, 0xd7, 0xd8, 0xd9, 0xda,
+    0xe2, 0xe3, 0xe4, 0xe5, 0xe6, 0xe7, 0xe8, 0xe9, 0xea, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8,
+    0xf9, 0xfa };
+
+typedef struct {
+    uint16_t code[ 256 ];
+    uint8_t size[ 256 ];
+} huffman_t;
+
+typedef struct {
+    std::vector<uint8_t> out;
+    uint32_t bits;
+    uint32_t count;
+} bitwriter_t;
+
+static void huffman_build( huffman_t *h, const uint8_t *bits, const uint8_t *vals ) {
+    uint16_t code = 0;
+    uint32_t k = 0;
+
+    for( uint32_t len = 1 ; len <= 16 ; len++ ) {
+        for( uint32_t i = 0 ; i < bits[ len - 1 ] ; i++ ) {
+            h->code[ vals[ k ] ] = code++;
+            h->size[ vals[ k ] ] = len;
+            k++;
+        }
+        code <<= 1;
+    }
+}
+
+static void put_bits( bitwriter_t *w, uint32_t value, uint32_t size ) {
+    w->bits = ( w->bits << size ) | ( value & ( ( 1u << size ) - 1 ) );
+    w->count += size;
+    while( w->count >= 8 ) {
+        uint8_t byte = w->bits >> ( w->count - 8 );
+        w->out.push_back( byte );
+        if ( byte == 0xff ) {
+            w->out.push_back( 0 );
+        }
+        w->count -= 8;
+    }
+}
+
+static void put_marker( std::vector<uint8_t> &out, uint8_t marker, const std::vector<uint8_t> &payload ) {
+    out.push_back( 0xff );
+    out.push_back( marker );
+    out.push_back( ( payload.size() + 2 ) >> 8 );
+    out.push_back( ( payload.size() + 2 ) & 0xff );
+    out.insert( out.end(), payload.begin(), payload.end() );
+}
+
+static uint32_t category( int32_t v ) {
+    uint32_t c = 0;
+
+    v = v < 0 ? -v : v;
+    while( v ) {
+        c++;
+        v >>= 1;
+    }
+    return( c );
+}
+
+static void encode_block( bitwriter_t *w, const float *block, const uint8_t *quant, int32_t *dc, const huffman_t *dc_h, const huffman_t *ac_h ) {
+    int32_t q[ 64 ];
+
+    for( int v = 0 ; v < 8 ; v++ ) {
+        for( int u = 0 ; u < 8 ; u++ ) {
+            float sum = 0;
+            for( int y = 0 ; y < 8 ; y++ ) {
+                for( int x = 0 ; x < 8 ; x++ ) {
+                    sum += block[ y * 8 + x ] * cosf( ( 2 * x + 1 ) * u * (float)M_PI / 16 ) * cosf( ( 2 * y + 1 ) * v * (float)M_PI / 16 );
+                }
+            }
+            sum *= 0.25f * ( u ? 1.0f : (float)M_SQRT1_2 ) * ( v ? 1.0f : (float)M_SQRT1_2 );
+            q[ v * 8 + u ] = lroundf( sum / quant[ v * 8 + u ] );
+        }
+    }
+    int32_t diff = q[ 0 ] - *dc;
+    uint32_t c = category( diff );
+    *dc = q[ 0 ];
+    put_bits( w, dc_h->code[ c ], dc_h->size[ c ] );
+    put_bits( w, diff < 0 ? diff - 1 : diff, c );
+
+    uint32_t run = 0;
+    for( int k = 1 ; k < 64 ; k++ ) {
+        int32_t v = q[ zigzag[ k ] ];
+        if ( v == 0 ) {
+            run++;
+            continue;
+        }
+        while( run > 15 ) {
+            put_bits( w, ac_h->code[ 0xf0 ], ac_h->size[ 0xf0 ] );
+            run -= 16;
+        }
+        c = category( v );
+        put_bits( w, ac_h->code[ ( run << 4 ) | c ], ac_h->size[ ( run << 4 ) | c ] );
+        put_bits( w, v < 0 ? v - 1 : v, c );
+        run = 0;
+    }
+    if ( run ) {
+        put_bits( w, ac_h->code[ 0 ], ac_h->size[ 0 ] );
+    }
+}
+
+static std::vector<uint8_t> jpeg_encode( const uint8_t *rgb, uint32_t width, uint32_t height, uint32_t quality ) {
+    static const uint8_t jfif[] = { 'J', 'F', 'I', 'F', 0, 1, 1, 0, 0, 1, 0, 1, 0, 0 };
+    const uint8_t *bits[ 4 ] = { dc_luma_bits, ac_luma_bits, dc_chroma_bits, ac_chroma_bits };
+    const uint8_t *vals[ 4 ] = { dc_vals, ac_luma_vals, dc_vals, ac_chroma_vals };
+    const uint8_t classes[ 4 ] = { 0x00, 0x10, 0x01, 0x11 };
+    uint8_t quant[ 2 ][ 64 ];
+    huffman_t huffman[ 4 ];
+    std::vector<uint8_t> out = { 0xff, 0xd8 };
+
+    uint32_t scale = quality < 50 ? 5000 / quality : 200 - quality * 2;
+    for( int i = 0 ; i < 64 ; i++ ) {
+        uint32_t l = ( quant_luma[ i ] * scale + 50 ) / 100;
+        uint32_t c = ( quant_chroma[ i ] * scale + 50 ) / 100;
+        quant[ 0 ][ i ] = l < 1 ? 1 : l > 255 ? 255 : l;
+        quant[ 1 ][ i ] = c < 1 ? 1 : c > 255 ? 255 : c;
+    }
+    put_marker( out, 0xe0, std::vector<uint8_t>( jfif, jfif + sizeof( jfif ) ) );
+    for( int t = 0 ; t < 2 ; t++ ) {
+        std::vector<uint8_t> dqt = { (uint8_t)t };
+        for( int k = 0 ; k < 64 ; k++ ) {
+            dqt.push_back( quant[ t ][ zigzag[ k ] ] );
+        }
+        put_marker( out, 0xdb, dqt );
+    }
+    put_marker( out, 0xc0, { 8, (uint8_t)( height >> 8 ), (uint8_t)height, (uint8_t)( width >> 8 ), (uint8_t)width, 3, 1, 0x11, 0, 2, 0x11, 1, 3, 0x11, 1 } );
+    for( int t = 0 ; t < 4 ; t++ ) {
+        std::vector<uint8_t> dht = { classes[ t ] };
+        uint32_t n = 0;
+        for( int i = 0 ; i < 16 ; i++ ) {
+            dht.push_back( bits[ t ][ i ] );
+            n += bits[ t ][ i ];
+        }
+        dht.insert( dht.end(), vals[ t ], vals[ t ] + n );
+        put_marker( out, 0xc4, dht );
+        huffman_build( &huffman[ t ], bits[ t ], vals[ t ] );
+    }
+    put_marker( out, 0xda, { 3, 1, 0x00, 2, 0x11, 3, 0x11, 0, 63, 0 } );
+
+    bitwriter_t w = { out, 0, 0 };
+    int32_t dc[ 3 ] = { 0, 0, 0 };
+    for( uint32_t by = 0 ; by < height ; by += 8 ) {
+        for( uint32_t bx = 0 ; bx < width ; bx += 8 ) {
+            float block[ 3 ][ 64 ];
+            for( uint32_t y = 0 ; y < 8 ; y++ ) {
+                for( uint32_t x = 0 ; x < 8 ; x++ ) {
+                    uint32_t sx = bx + x < width ? bx + x : width - 1;
+                    uint32_t sy = by + y < height ? by + y : height - 1;
+                    const uint8_t *p = &rgb[ ( sy * width + sx ) * 3 ];
+                    block[ 0 ][ y * 8 + x ] = 0.299f * p[ 0 ] + 0.587f * p[ 1 ] + 0.114f * p[ 2 ] - 128;
+                    block[ 1 ][ y * 8 + x ] = -0.1687f * p[ 0 ] - 0.3313f * p[ 1 ] + 0.5f * p[ 2 ];
+                    block[ 2 ][ y * 8 + x ] = 0.5f * p[ 0 ] - 0.4187f * p[ 1 ] - 0.0813f * p[ 2 ];
+                }
+            }
+            encode_block( &w, block[ 0 ], quant[ 0 ], &dc[ 0 ], &huffman[ 0 ], &huffman[ 1 ] );
+            encode_block( &w, block[ 1 ], quant[ 1 ], &dc[ 1 ], &huffman[ 2 ], &huffman[ 3 ] );
+            encode_block( &w, block[ 2 ], quant[ 1 ], &dc[ 2 ], &huffman[ 2 ], &huffman[ 3 ] );
+        }
+    }
+    if ( w.count ) {
+        put_bits( &w, 0x7f, 8 - w.count );
+    }
+    w.out.push_back( 0xff );
+    w.out.push_back( 0xd9 );
+    return( w.out );
+}
+
+/**
+ * @brief split an image into frames and put them behind a sjpg header
+ */
+static std::vector<uint8_t> sjpg_encode( const std::vector<uint8_t> &rgb, uint32_t width, uint32_t height ) {
+    std::vector<std::vector<uint8_t>> frames;
+    std::vector<uint8_t> out = { '_', 'S', 'J', 'P', 'G', '_', '_', 0, 'V', '1', '.', '0', '0', 0 };
+
+    for( uint32_t y = 0 ; y < height ; y += SIM_FRAME_H ) {
+        frames.push_back( jpeg_encode( &rgb[ y * width * 3 ], width, SIM_FRAME_H, SIM_QUALITY ) );
+    }
+    for( uint32_t v : { width, height, (uint32_t)frames.size(), (uint32_t)SIM_FRAME_H } ) {
+        out.push_back( v & 0xff );
+        out.push_back( v >> 8 );
+    }
+    for( const std::vector<uint8_t> &f : frames ) {
+        out.push_back( f.size() & 0xff );
+        out.push_back( f.size() >> 8 );
+    }
+    for( const std::vector<uint8_t> &f : frames ) {
+        out.insert( out.end(), f.begin(), f.end() );
+    }
+    return( out );
+}
+
+static std::vector<uint8_t> sample_photo( void ) {
+    std::vector<uint8_t> rgb( SIM_WIDTH * SIM_IMAGE_H * 3 );
+
+    for( uint32_t y = 0 ; y < SIM_IMAGE_H ; y++ ) {
+        for( uint32_t x = 0 ; x < SIM_WIDTH ; x++ ) {
+            float fx = x / (float)SIM_WIDTH, fy = y / (float)SIM_IMAGE_H;
+            float sun = expf( -( ( fx - 0.7f ) * ( fx - 0.7f ) + ( fy * 8 - 1.2f ) * ( fy * 8 - 1.2f ) ) * 20 );
+            float hills = 0.5f + 0.5f * sinf( x * 0.05f + y * 0.013f ) * cosf( y * 0.021f );
+            uint8_t *p = &rgb[ ( y * SIM_WIDTH + x ) * 3 ];
+            p[ 0 ] = fminf( 255, 40 + 150 * fy + 120 * sun + 20 * hills + rand() % 6 );
+            p[ 1 ] = fminf( 255, 80 + 90 * hills + 60 * sun + rand() % 6 );
+            p[ 2 ] = fminf( 255, 200 - 140 * fy + 30 * hills + rand() % 6 );
+        }
+    }
+    return( rgb );
+}
+
+static std::vector<uint8_t> sample_chat( void ) {
+    std::vector<uint8_t> rgb( SIM_WIDTH * SIM_IMAGE_H * 3, 0xf0 );
+
+    for( uint32_t y = 0 ; y < SIM_IMAGE_H ; y++ ) {
+        uint32_t bubble = y / 120;
+        bool right = bubble & 1;
+        uint32_t line = y % 120;
+        for( uint32_t x = 0 ; x < SIM_WIDTH ; x++ ) {
+            uint8_t *p = &rgb[ ( y * SIM_WIDTH + x ) * 3 ];
+            bool in_bubble = line > 8 && line < 110 && ( right ? x > 50 && x < 232 : x > 8 && x < 190 );
+            if ( !in_bubble ) {
+                continue;
+            }
+            p[ 0 ] = right ? 0xdc : 0xff;
+            p[ 1 ] = right ? 0xf8 : 0xff;
+            p[ 2 ] = right ? 0xc6 : 0xff;
+            /*
+             * text rows of 2px strokes in 5px glyph cells
+             */
+            uint32_t row = ( line - 14 ) % 18;
+            uint32_t cell = ( x + bubble * 7 ) / 6;
+            if ( line >= 14 && line < 104 && row < 12 && ( ( cell * 2654435761u ) >> 28 ) > 3 && ( x % 6 ) < 4 && ( ( row * 5 + x * 3 + cell ) % 7 ) < 3 ) {
+                p[ 0 ] = p[ 1 ] = p[ 2 ] = 0x20;
+            }
+        }
+    }
+    return( rgb );
+}
+
+/*
+ * the sjpg frame handling of lv_sjpg.c for a variable source
+ */
+typedef struct {
+    const uint8_t *data;
+    const uint8_t *pos;
+} io_t;
+
+typedef struct {
+    const uint8_t *sjpg;
+    int x_res;
+    int y_res;
+    int total_frames;
+    int frame_height;
+    std::vector<const uint8_t *> frame_base;
+    uint8_t *frame_cache;                   /* RGB888 output of TJpgDec */
+    uint8_t *frame_native;
+    bool frame_native_cached;
+    int cache_frame_index;
+    int prefetch_frame;
+    bool prefetch;
+    uint8_t *workb;
+    JDEC jd;
+    io_t io;
+    uint32_t decodes;
+    uint32_t loads;
+    uint64_t decode_ns;
+    uint64_t convert_ns;
+} sjpg_t;
+
+static unsigned int input_func( JDEC *jd, uint8_t *buff, unsigned int ndata ) {
+    io_t *io = (io_t *)jd->device;
+
+    if ( buff ) {
+        memcpy( buff, io->pos, ndata );
+    }
+    io->pos += ndata;
+    return( ndata );
+}
+
+static int img_data_cb( JDEC *jd, void *data, JRECT *rect ) {
+    sjpg_t *sjpeg = (sjpg_t *)( (io_t *)jd->device )->data;
+    const uint8_t *buf = (const uint8_t *)data;
+    int row_size = ( rect->right - rect->left + 1 ) * 3;
+
+    for( int y = rect->top ; y <= rect->bottom ; y++ ) {
+        memcpy( sjpeg->frame_cache + ( y * sjpeg->x_res + rect->left ) * 3, buf, row_size );
+        buf += row_size;
+    }
+    return( 1 );
+}
+
+static bool sjpg_open( sjpg_t *sjpeg, const uint8_t *data ) {
+    if ( strncmp( (const char *)data, "_SJPG__", 7 ) ) {
+        return( false );
+    }
+    sjpeg->sjpg = data;
+    sjpeg->x_res = data[ 14 ] | data[ 15 ] << 8;
+    sjpeg->y_res = data[ 16 ] | data[ 17 ] << 8;
+    sjpeg->total_frames = data[ 18 ] | data[ 19 ] << 8;
+    sjpeg->frame_height = data[ 20 ] | data[ 21 ] << 8;
+    sjpeg->frame_base.assign( sjpeg->total_frames, NULL );
+    sjpeg->frame_base[ 0 ] = data + 22 + sjpeg->total_frames * 2;
+    for( int i = 1 ; i < sjpeg->total_frames ; i++ ) {
+        sjpeg->frame_base[ i ] = sjpeg->frame_base[ i - 1 ] + ( data[ 22 + ( i - 1 ) * 2 ] | data[ 23 + ( i - 1 ) * 2 ] << 8 );
+    }
+    sjpeg->frame_cache = (uint8_t *)malloc( sjpeg->x_res * sjpeg->frame_height * 3 );
+    sjpeg->workb = (uint8_t *)malloc( TJPGD_WORKBUFF_SIZE );
+    sjpeg->frame_native = NULL;
+    sjpeg->frame_native_cached = false;
+    sjpeg->cache_frame_index = -1;
+    sjpeg->prefetch_frame = 0;
+    sjpeg->prefetch = false;
+    sjpeg->decodes = 0;
+    sjpeg->loads = 0;
+    sjpeg->decode_ns = 0;
+    sjpeg->convert_ns = 0;
+    return( true );
+}
+
+static bool sjpg_decode_rgb888( sjpg_t *sjpeg, int frame ) {
+    uint64_t start = now_ns();
+
+    sjpeg->io.data = (const uint8_t *)sjpeg;
+    sjpeg->io.pos = sjpeg->frame_base[ frame ];
+    if ( jd_prepare( &sjpeg->jd, input_func, sjpeg->workb, TJPGD_WORKBUFF_SIZE, &sjpeg->io ) != JDR_OK ) {
+        return( false );
+    }
+    if ( jd_decomp( &sjpeg->jd, img_data_cb, 0 ) != JDR_OK ) {
+        return( false );
+    }
+    sjpeg->decodes++;
+    sjpeg->decode_ns += now_ns() - start;
+    return( true );
+}
+
+/**
+ * @brief lv_sjpg_decode_frame
+ */
+static uint8_t *sjpg_decode_frame( sjpg_t *sjpeg, int frame, uint32_t *size, uint32_t *decode_us ) {
+    uint64_t start = now_ns();
+
+    if ( !sjpg_decode_rgb888( sjpeg, frame ) ) {
+        return( NULL );
+    }
+    *size = sjpeg->x_res * sjpeg->frame_height * 2;
+    uint8_t *native = (uint8_t *)malloc( *size );
+    uint64_t convert_start = now_ns();
+    sjpg_convert_rgb565( sjpeg->frame_cache, (uint16_t *)native, sjpeg->x_res * sjpeg->frame_height );
+    sjpeg->convert_ns += now_ns() - convert_start;
+    *decode_us = ( now_ns() - start ) / 1000;
+    return( native );
+}
+
+static void sjpg_release_frame( sjpg_t *sjpeg ) {
+    if ( sjpeg->frame_native ) {
+        if ( sjpeg->frame_native_cached ) {
+            img_cache_release( sjpeg->frame_native );
+        }
+        else {
+            free( sjpeg->frame_native );
+        }
+    }
+    sjpeg->frame_native = NULL;
+    sjpeg->frame_native_cached = false;
+    sjpeg->cache_frame_index = -1;
+}
+
+/**
+ * @brief lv_sjpg_load_frame
+ */
+static bool sjpg_load_frame( sjpg_t *sjpeg, int frame, bool prefetch ) {
+    int previous = sjpeg->cache_frame_index;
+
+    sjpg_release_frame( sjpeg );
+    sjpeg->loads++;
+    const uint8_t *cached = img_cache_get( LV_IMG_SRC_VARIABLE, sjpeg->sjpg, frame );
+    if ( cached ) {
+        sjpeg->frame_native = (uint8_t *)cached;
+        sjpeg->frame_native_cached = true;
+    }
+    else {
+        uint32_t size, decode_us;
+        sjpeg->frame_native = sjpg_decode_frame( sjpeg, frame, &size, &decode_us );
+        if ( !sjpeg->frame_native ) {
+            return( false );
+        }
+        sjpeg->frame_native_cached = img_cache_put( LV_IMG_SRC_VARIABLE, sjpeg->sjpg, frame, sjpeg->frame_native, size, decode_us );
+    }
+    sjpeg->cache_frame_index = frame;
+    uint32_t screen_frames = SIM_HEIGHT / sjpeg->frame_height + 2;
+    if ( screen_frames * sjpeg->x_res * sjpeg->frame_height * 2 > IMG_CACHE_SIZE ) {
+        return( true );
+    }
+    sjpeg->prefetch_frame = ( previous >= 0 && frame < previous ) ? frame - 1 : frame + 1;
+    sjpeg->prefetch = prefetch && sjpeg->prefetch_frame >= 0 && sjpeg->prefetch_frame < sjpeg->total_frames;
+    return( true );
+}
+
+/**
+ * @brief lv_sjpg_prefetch_task
+ */
+static void sjpg_prefetch( sjpg_t *sjpeg ) {
+    uint32_t size, decode_us;
+
+    if ( !sjpeg->prefetch ) {
+        return;
+    }
+    sjpeg->prefetch = false;
+    if ( img_cache_contains( LV_IMG_SRC_VARIABLE, sjpeg->sjpg, sjpeg->prefetch_frame ) ) {
+        return;
+    }
+    uint8_t *native = sjpg_decode_frame( sjpeg, sjpeg->prefetch_frame, &size, &decode_us );
+    if ( native == NULL ) {
+        return;
+    }
+    if ( img_cache_put( LV_IMG_SRC_VARIABLE, sjpeg->sjpg, sjpeg->prefetch_frame, native, size, decode_us ) ) {
+        img_cache_release( native );
+    }
+    else {
+        free( native );
+    }
+}
+
+typedef enum {
+    MODE_OLD = 0,
+    MODE_CACHE,
+    MODE_PREFETCH,
+    MODE_MAX
+} mode_t_;
+
+static const char *mode_name[] = { "one rgb888 frame", "img_cache", "img_cache + prefetch" };
+
+/**
+ * @brief decoder_read_line, the old one converted the rgb888 frame on every read
+ */
+static bool read_line( sjpg_t *sjpeg, mode_t_ mode, int x, int y, int len, uint16_t *buf ) {
+    int frame = y / sjpeg->frame_height;
+
+    if ( mode == MODE_OLD ) {
+        if ( frame != sjpeg->cache_frame_index ) {
+            if ( !sjpg_decode_rgb888( sjpeg, frame ) ) {
+                return( false );
+            }
+            sjpeg->cache_frame_index = frame;
+        }
+        uint64_t start = now_ns();
+        sjpg_convert_rgb565_px( sjpeg->frame_cache + ( x + ( y % sjpeg->frame_height ) * sjpeg->x_res ) * 3, buf, len );
+        sjpeg->convert_ns += now_ns() - start;
+        return( true );
+    }
+    if ( frame != sjpeg->cache_frame_index && !sjpg_load_frame( sjpeg, frame, mode == MODE_PREFETCH ) ) {
+        return( false );
+    }
+    memcpy( buf, sjpeg->frame_native + ( x + ( y % sjpeg->frame_height ) * sjpeg->x_res ) * 2, len * 2 );
+    return( true );
+}
+
+typedef struct {
+    uint32_t frames;
+    uint32_t decodes;
+    uint64_t render_ns;
+    uint64_t max_render_ns;
+    uint64_t idle_ns;
+    uint64_t convert_ns;
+    uint32_t hits;
+    uint32_t misses;
+} result_t;
+
+/**
+ * @brief scroll down through the image and back up, LVGL renders every display frame in bands
+ */
+static bool scroll( sjpg_t *sjpeg, mode_t_ mode, result_t *result, const std::vector<uint16_t> &reference ) {
+    static uint16_t band[ SIM_WIDTH * SIM_BAND_H ];
+    img_cache_stats_t before, after;
+    std::vector<int> offsets;
+    int max_offset = sjpeg->y_res - SIM_HEIGHT;
+
+    for( int o = 0 ; o < max_offset ; o += SIM_SCROLL_PX ) {
+        offsets.push_back( o );
+    }
+    for( int o = max_offset ; o > 0 ; o -= SIM_SCROLL_PX ) {
+        offsets.push_back( o );
+    }
+    memset( result, 0, sizeof( result_t ) );
+    img_cache_invalidate( NULL );
+    img_cache_get_stats( &before );
+    sjpeg->cache_frame_index = -1;
+    sjpeg->prefetch = false;
+    sjpeg->decodes = 0;
+    sjpeg->loads = 0;
+    sjpeg->convert_ns = 0;
+
+    for( int offset : offsets ) {
+        uint64_t start = now_ns();
+        for( int row = 0 ; row < SIM_HEIGHT ; row += SIM_BAND_H ) {
+            for( int line = 0 ; line < SIM_BAND_H ; line++ ) {
+                if ( !read_line( sjpeg, mode, 0, offset + row + line, sjpeg->x_res, &band[ line * SIM_WIDTH ] ) ) {
+                    printf( "%s: read_line failed at %d\n", mode_name[ mode ], offset + row + line );
+                    return( false );
+                }
+            }
+            if ( memcmp( band, &reference[ ( offset + row ) * SIM_WIDTH ], sizeof( band ) ) ) {
+                printf( "%s: wrong pixels at row %d\n", mode_name[ mode ], offset + row );
+                return( false );
+            }
+        }
+        uint64_t render = now_ns() - start;
+        result->render_ns += render;
+        result->max_render_ns = render > result->max_render_ns ? render : result->max_render_ns;
+        result->frames++;
+        /*
+         * the prefetch task runs when LVGL is idle
+         */
+        start = now_ns();
+        sjpg_prefetch( sjpeg );
+        result->idle_ns += now_ns() - start;
+    }
+    sjpg_release_frame( sjpeg );
+    img_cache_get_stats( &after );
+    result->decodes = sjpeg->decodes;
+    result->convert_ns = sjpeg->convert_ns;
+    result->hits = after.hits - before.hits;
+    result->misses = after.misses - before.misses;
+    /*
+     * only frame loads count, prefetch lookups are neither hit nor miss
+     */
+    if ( result->hits + result->misses != sjpeg->loads ) {
+        printf( "%s: %d hits and misses for %d frame loads\n", mode_name[ mode ], result->hits + result->misses, sjpeg->loads );
+        return( false );
+    }
+    return( true );
+}
+
+/**
+ * @brief packed and dithered conversion against the per pixel one
+ */
+static void check_convert( void ) {
+    static uint8_t in[ 4 + SIM_WIDTH * SIM_FRAME_H * 3 ];
+    static uint16_t ref[ 2 + SIM_WIDTH * SIM_FRAME_H ], out[ 2 + SIM_WIDTH * SIM_FRAME_H ];
+    bool ok = true;
+
+    for( uint32_t i = 0 ; i < sizeof( in ) ; i++ ) {
+        in[ i ] = rand();
+    }
+    for( uint32_t px = 0 ; px < 64 && ok ; px++ ) {
+        for( uint32_t in_off = 0 ; in_off < 4 && ok ; in_off++ ) {
+            for( uint32_t out_off = 0 ; out_off < 2 && ok ; out_off++ ) {
+                sjpg_convert_rgb565_px( &in[ in_off ], &ref[ out_off ], px );
+                sjpg_convert_rgb565( &in[ in_off ], &out[ out_off ], px );
+                ok = !memcmp( &ref[ out_off ], &out[ out_off ], px * 2 );
+            }
+        }
+    }
+    printf( "%-40s %s\n", "packed conversion, any alignment", ok ? "ok" : "FAILED" );
+    failed += ok ? 0 : 1;
+    /*
+     * a slow gradient: the dither keeps the mean, the plain conversion truncates
+     */
+    double err_plain = 0, err_dither = 0;
+    for( uint32_t i = 0 ; i < SIM_WIDTH * SIM_FRAME_H ; i++ ) {
+        uint8_t v = ( i % SIM_WIDTH ) * 255 / SIM_WIDTH;
+        in[ i * 3 ] = in[ i * 3 + 1 ] = in[ i * 3 + 2 ] = v;
+    }
+    sjpg_convert_rgb565_px( in, ref, SIM_WIDTH * SIM_FRAME_H );
+    sjpg_convert_rgb565_dither( in, out, SIM_WIDTH, SIM_FRAME_H, 0 );
+    for( uint32_t i = 0 ; i < SIM_WIDTH * SIM_FRAME_H ; i++ ) {
+        err_plain += in[ i * 3 ] - ( ( ref[ i ] >> 11 ) << 3 );
+        err_dither += in[ i * 3 ] - ( ( out[ i ] >> 11 ) << 3 );
+    }
+    err_plain /= SIM_WIDTH * SIM_FRAME_H;
+    err_dither /= SIM_WIDTH * SIM_FRAME_H;
+    ok = fabs( err_dither ) < fabs( err_plain ) / 2;
+    printf( "%-40s %s\n", "dither keeps the mean of a gradient", ok ? "ok" : "FAILED" );
+    printf( "  red mean error %.2f plain, %.2f dithered\n", err_plain, err_dither );
+    failed += ok ? 0 : 1;
+    /*
+     * speed of one frame
+     */
+    const uint32_t repeat = 2000, px = SIM_WIDTH * SIM_FRAME_H;
+    uint64_t t[ 3 ];
+    for( int c = 0 ; c < 3 ; c++ ) {
+        uint64_t start = now_ns();
+        for( uint32_t r = 0 ; r < repeat ; r++ ) {
+            in[ r % px ] = r;
+            switch( c ) {
+                case 0:     sjpg_convert_rgb565_px( in, ref, px );
+                            break;
+                case 1:     sjpg_convert_rgb565( in, out, px );
+                            break;
+                default:    sjpg_convert_rgb565_dither( in, out, SIM_WIDTH, SIM_FRAME_H, 0 );
+                            break;
+            }
+        }
+        t[ c ] = now_ns() - start;
+    }
+    printf( "conversion ns/px: %.2f per pixel, %.2f packed, %.2f dithered (%d)\n", (double)t[ 0 ] / repeat / px, (double)t[ 1 ] / repeat / px, (double)t[ 2 ] / repeat / px, ref[ 7 ] ^ out[ 7 ] );
+}
+
+static void run( const char *name, const std::vector<uint8_t> &data ) {
+    sjpg_t sjpeg;
+
+    if ( !sjpg_open( &sjpeg, data.data() ) ) {
+        printf( "%s: no sjpg\n", name );
+        failed++;
+        return;
+    }
+    if ( sjpeg.x_res != SIM_WIDTH || sjpeg.y_res < SIM_HEIGHT ) {
+        printf( "%s: %dx%d, only %d px wide images taller than %d px\n", name, sjpeg.x_res, sjpeg.y_res, SIM_WIDTH, SIM_HEIGHT );
+        failed++;
+        return;
+    }
+    /*
+     * decode all frames once as the reference for the scroll runs
+     */
+    std::vector<uint16_t> reference( sjpeg.x_res * sjpeg.total_frames * sjpeg.frame_height );
+    for( int f = 0 ; f < sjpeg.total_frames ; f++ ) {
+        if ( !sjpg_decode_rgb888( &sjpeg, f ) ) {
+            printf( "%s: frame %d does not decode\n", name, f );
+            failed++;
+            return;
+        }
+        sjpg_convert_rgb565_px( sjpeg.frame_cache, &reference[ f * sjpeg.x_res * sjpeg.frame_height ], sjpeg.x_res * sjpeg.frame_height );
+    }
+    printf( "\n%s: %dx%d, %d frames, %d bytes, %.0f us per frame decode\n", name, sjpeg.x_res, sjpeg.y_res, sjpeg.total_frames, (int)data.size(), sjpeg.decode_ns / 1000.0 / sjpeg.decodes );
+    printf( "%-22s %7s %8s %10s %10s %10s %8s %8s\n", "", "frames", "decodes", "avg us", "max us", "idle us", "hits", "misses" );
+    for( int mode = 0 ; mode < MODE_MAX ; mode++ ) {
+        result_t r;
+        if ( !scroll( &sjpeg, (mode_t_)mode, &r, reference ) ) {
+            failed++;
+            continue;
+        }
+        printf( "%-22s %7d %8d %10.0f %10.0f %10.0f %8d %8d\n", mode_name[ mode ], r.frames, r.decodes, r.render_ns / 1000.0 / r.frames, r.max_render_ns / 1000.0, r.idle_ns / 1000.0 / r.frames, r.hits, r.misses );
+    }
+    img_cache_invalidate( NULL );
+    free( sjpeg.frame_cache );
+    free( sjpeg.workb );
+}
+
+int main( int argc, char **argv ) {
+    srand( 1 );
+    check_convert();
+    printf( "image cache %d kB, %d entries, scroll %d rows per display frame\n", IMG_CACHE_SIZE / 1024, IMG_CACHE_ENTRYS, SIM_SCROLL_PX );
+
+    if ( argc > 1 ) {
+        for( int i = 1 ; i < argc ; i++ ) {
+            FILE *file = fopen( argv[ i ], "rb" );
+            if ( file == NULL ) {
+                printf( "can't open %s\n", argv[ i ] );
+                return( 1 );
+            }
+            std::vector<uint8_t> data;
+            uint8_t buffer[ 4096 ];
+            size_t len;
+            while( ( len = fread( buffer, 1, sizeof( buffer ), file ) ) > 0 ) {
+                data.insert( data.end(), buffer, buffer + len );
+            }
+            fclose( file );
+            run( argv[ i ], data );
+        }
+    }
+    else {
+        run( "photo", sjpg_encode( sample_photo(), SIM_WIDTH, SIM_IMAGE_H ) );
+        run( "chat", sjpg_encode( sample_chat(), SIM_WIDTH, SIM_IMAGE_H ) );
+    }
+    printf( "%s\n", failed ? "FAILED" : "all ok" );
+    return( failed ? 1 : 0 );
+}
@@ -0,0 +1,164 @@
+/*
+ * Simulate one year of step and battery history through the time series
+ * store from src/utils/timeseries.cpp and report the write amplification
+ * and the query latency.
+ *
+ * build:   g++ -O2 tools/timeseries_bench.cpp -o timeseries_bench
+ * usage:   timeseries_bench [directory]
+ *
+ * the store files are written to directory, default /tmp. the watch is
+ * restarted once a week to check the restore of the open buckets.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../src/utils/timeseries.cpp"
+
+#define BENCH_START         1609459200      /* 2021-01-01 */
+#define BENCH_DAYS          365
+#define BENCH_QUERIES       1000
+
+static uint64_t now_ns( void ) {
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return( (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec );
+}
+
+static void remove_files( const char *path ) {
+    char filename[ 64 ];
+
+    for( int tier = 0 ; tier < TIMESERIES_TIERS ; tier++ ) {
+        for( int file = 0 ; file < 2 ; file++ ) {
+            snprintf( filename, sizeof( filename ), "%s_%c%d.bin", path, "mhd"[ tier ], file );
+            remove( filename );
+        }
+    }
+}
+
+static double query_us( timeseries_t *ts, int tier, uint32_t span, uint32_t end, int32_t *points_out ) {
+    static timeseries_point_t points[ 2048 ];
+    uint64_t ns = 0;
+    int32_t count = 0;
+
+    srand( 1 );
+    for( int i = 0 ; i < BENCH_QUERIES ; i++ ) {
+        uint32_t to = end - ( rand() % ( span / 2 + 1 ) );
+        uint64_t start = now_ns();
+        count = timeseries_query( ts, tier, to - span, to, points, 2048 );
+        ns += now_ns() - start;
+    }
+    *points_out = count;
+    return( (double)ns / BENCH_QUERIES / 1000.0 );
+}
+
+int main( int argc, char **argv ) {
+    const char *dir = argc > 1 ? argv[ 1 ] : "/tmp";
+    static int32_t day_steps[ BENCH_DAYS ];
+    char steps_path[ TIMESERIES_PATH_SIZE ];
+    char battery_path[ TIMESERIES_PATH_SIZE ];
+    timeseries_t steps, battery;
+    timeseries_stats_t steps_stats = {}, battery_stats = {};
+    uint32_t samples = 0;
+    int battery_percent = 100;
+
+    snprintf( steps_path, sizeof( steps_path ), "%s/ts_steps", dir );
+    snprintf( battery_path, sizeof( battery_path ), "%s/ts_battery", dir );
+    remove_files( steps_path );
+    remove_files( battery_path );
+    timeseries_open( &steps, steps_path, TIMESERIES_SUM );
+    timeseries_open( &battery, battery_path, TIMESERIES_MEAN );
+    srand( 42 );
+
+    uint64_t start = now_ns();
+    for( uint32_t t = BENCH_START ; t < BENCH_START + BENCH_DAYS * 86400 ; t += 60 ) {
+        uint32_t hour = ( t / 3600 ) % 24;
+        /*
+         * steps during the day, nothing at night
+         */
+        int32_t step = ( hour >= 7 && hour < 22 ) ? rand() % 40 : 0;
+        if ( hour == 18 && rand() % 4 == 0 ) {
+            step += 100;
+        }
+        day_steps[ ( t - BENCH_START ) / 86400 ] += step;
+        timeseries_add( &steps, t, step );
+        /*
+         * about one day per charge, two hours to charge
+         */
+        if ( hour == 21 && battery_percent < 30 ) {
+            battery_percent = 100;
+        }
+        else if ( rand() % 20 == 0 && battery_percent > 0 ) {
+            battery_percent--;
+        }
+        timeseries_add( &battery, t, battery_percent );
+        samples += 2;
+        /*
+         * restart once a week
+         */
+        if ( ( t - BENCH_START ) % ( 7 * 86400 ) == 7 * 86400 - 60 * 17 ) {
+            timeseries_flush( &steps );
+            timeseries_flush( &battery );
+            steps_stats.bytes_written += steps.stats.bytes_written;
+            steps_stats.writes += steps.stats.writes;
+            steps_stats.bytes_encoded += steps.stats.bytes_encoded;
+            battery_stats.bytes_written += battery.stats.bytes_written;
+            battery_stats.writes += battery.stats.writes;
+            battery_stats.bytes_encoded += battery.stats.bytes_encoded;
+            timeseries_open( &steps, steps_path, TIMESERIES_SUM );
+            timeseries_open( &battery, battery_path, TIMESERIES_MEAN );
+        }
+    }
+    /*
+     * close the last day
+     */
+    timeseries_add( &steps, BENCH_START + BENCH_DAYS * 86400, 0 );
+    timeseries_add( &battery, BENCH_START + BENCH_DAYS * 86400, battery_percent );
+    uint64_t write_ns = now_ns() - start;
+
+    steps_stats.bytes_written += steps.stats.bytes_written;
+    steps_stats.writes += steps.stats.writes;
+    steps_stats.bytes_encoded += steps.stats.bytes_encoded;
+    battery_stats.bytes_written += battery.stats.bytes_written;
+    battery_stats.writes += battery.stats.writes;
+    battery_stats.bytes_encoded += battery.stats.bytes_encoded;
+
+    uint32_t raw = samples / 2 * sizeof( timeseries_point_t );
+    printf( "%u samples over %d days, %.2f us per sample\n\n", samples, BENCH_DAYS, (double)write_ns / samples / 1000.0 );
+    printf( "series\traw bytes\tencoded\twritten\twrites\tbytes/write\tpage writes (est.)\n" );
+    printf( "steps\t%u\t\t%u\t%u\t%u\t%.1f\t\t%u\n", raw, steps_stats.bytes_encoded, steps_stats.bytes_written, steps_stats.writes,
+            (double)steps_stats.bytes_written / steps_stats.writes, steps_stats.writes * 2 );
+    printf( "battery\t%u\t\t%u\t%u\t%u\t%.1f\t\t%u\n", raw, battery_stats.bytes_encoded, battery_stats.bytes_written, battery_stats.writes,
+            (double)battery_stats.bytes_written / battery_stats.writes, battery_stats.writes * 2 );
+    printf( "\nwrite amplification vs. one SPIFFS page per sample: %.4f\n", (double)( steps_stats.writes + battery_stats.writes ) * 2 / samples );
+    printf( "(page writes estimated as one data page and one index page per write)\n" );
+
+    /*
+     * verify the retained day buckets
+     */
+    static timeseries_point_t points[ 2048 ];
+    int32_t count = timeseries_query( &steps, TIMESERIES_DAY, BENCH_START, BENCH_START + BENCH_DAYS * 86400, points, 2048 );
+    int32_t errors = 0;
+    for( int32_t i = 0 ; i < count ; i++ ) {
+        if ( points[ i ].value != day_steps[ ( points[ i ].time - BENCH_START ) / 86400 ] ) {
+            errors++;
+        }
+    }
+    printf( "\nday buckets retained: %d, mismatches: %d\n", count, errors );
+
+    int32_t n;
+    uint32_t end = BENCH_START + BENCH_DAYS * 86400;
+    printf( "\nquery\t\t\tpoints\tus\n" );
+    double us = query_us( &steps, TIMESERIES_MINUTE, 86400, end, &n );
+    printf( "minute, last 24h\t%d\t%.2f\n", n, us );
+    us = query_us( &steps, TIMESERIES_HOUR, 7 * 86400, end, &n );
+    printf( "hour, last 7 days\t%d\t%.2f\n", n, us );
+    us = query_us( &steps, TIMESERIES_HOUR, 86400, end, &n );
+    printf( "hour, last 24h\t\t%d\t%.2f\n", n, us );
+    us = query_us( &steps, TIMESERIES_DAY, 7 * 86400, end, &n );
+    printf( "day, last 7 days\t%d\t%.2f\n", n, us );
+    us = query_us( &steps, TIMESERIES_DAY, BENCH_DAYS * 86400, end, &n );
+    printf( "day, full year\t\t%d\t%.2f\n", n, us );
+    return( errors ? 1 : 0 );
+}
@@ -0,0 +1,206 @@
+/*
+ * Run synthetic touch traces through the touch pipeline from
+ * src/utils/touch_gesture.cpp and report gesture accuracy, callback
+ * events per second, filter jitter and lag and the interrupt to lvgl
+ * latency of the old polling and the new interrupt driven path.
+ *
+ * build:   g++ -O2 tools/touch_sim.cpp -o touch_sim
+ * usage:   touch_sim [seed]
+ *
+ * traces are screen paths, mapped to raw controller points with the
+ * inverse of the default calibration and 3px jitter, sampled every
+ * TOUCH_SAMPLE_INTERVAL ms like src/hardware/touch.cpp does.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "../src/utils/touch_gesture.cpp"
+
+#define SIM_WIDTH           240
+#define SIM_HEIGHT          240
+#define SIM_SAMPLE_MS       10              /* TOUCH_SAMPLE_INTERVAL */
+#define SIM_LV_READ_MS      30              /* LV_INDEV_DEF_READ_PERIOD, old touch_read polling */
+#define SIM_I2C_US          350             /* one touch controller read */
+#define SIM_WAKE_US         150             /* scheduler wakeup from the touch interrupt */
+#define SIM_JITTER          3               /* raw jitter in px */
+#define SIM_TRACES          200             /* traces per gesture */
+
+static const touch_calibration_t calibration = { { 75366, 0, -1179648, 0, 65536, 0 } };
+
+static double rnd( void ) {
+    return( (double)rand() / RAND_MAX );
+}
+
+typedef struct {
+    uint8_t label;
+    double x0, y0, x1, y1;
+    uint32_t duration_ms;
+} trace_t;
+
+/*
+ * screen point to raw controller point, inverse of the default calibration
+ */
+static void to_raw( double x, double y, int16_t *raw_x, int16_t *raw_y ) {
+    x = ( x + 18.0 ) / 1.15;
+    *raw_x = (int16_t)lround( x + ( rand() % ( 2 * SIM_JITTER + 1 ) ) - SIM_JITTER );
+    *raw_y = (int16_t)lround( y + ( rand() % ( 2 * SIM_JITTER + 1 ) ) - SIM_JITTER );
+}
+
+static trace_t make_trace( uint8_t label ) {
+    trace_t t;
+    double len = 60 + rnd() * 100;
+    t.label = label;
+    t.x0 = 40 + rnd() * 160;
+    t.y0 = 40 + rnd() * 160;
+    t.x1 = t.x0;
+    t.y1 = t.y0;
+    t.duration_ms = 120 + rand() % 300;
+    switch( label ) {
+        case TOUCH_GESTURE_TAP:         t.duration_ms = 40 + rand() % 150; t.x1 += rnd() * 4 - 2; break;
+        case TOUCH_GESTURE_LONG_PRESS:  t.duration_ms = 700 + rand() % 800; t.y1 += rnd() * 4 - 2; break;
+        case TOUCH_GESTURE_SWIPE_LEFT:  t.x0 = 200 - rnd() * 20; t.x1 = t.x0 - len; break;
+        case TOUCH_GESTURE_SWIPE_RIGHT: t.x0 = 40 + rnd() * 20; t.x1 = t.x0 + len; break;
+        case TOUCH_GESTURE_SWIPE_UP:    t.y0 = 200 - rnd() * 20; t.y1 = t.y0 - len; break;
+        case TOUCH_GESTURE_SWIPE_DOWN:  t.y0 = 40 + rnd() * 20; t.y1 = t.y0 + len; break;
+        case TOUCH_GESTURE_EDGE_LEFT:   t.x0 = rnd() * 8; t.x1 = t.x0 + len; break;
+        case TOUCH_GESTURE_EDGE_RIGHT:  t.x0 = 239 - rnd() * 8; t.x1 = t.x0 - len; break;
+        case TOUCH_GESTURE_EDGE_TOP:    t.y0 = rnd() * 8; t.y1 = t.y0 + len; break;
+        case TOUCH_GESTURE_EDGE_BOTTOM: t.y0 = 239 - rnd() * 8; t.y1 = t.y0 - len; break;
+        default: {                      /* slow drag, leaves the slop before a long press */
+                                        double angle = rnd() * 6.283;
+                                        len = 50 + rnd() * 30;
+                                        t.x1 = t.x0 + cos( angle ) * len;
+                                        t.y1 = t.y0 + sin( angle ) * len;
+                                        t.duration_ms = 1200 + rand() % 800;
+                                        break;
+                                        }
+    }
+    return( t );
+}
+
+typedef struct {
+    uint32_t recognized;
+    uint32_t wrong;
+    uint32_t events_new;
+    uint32_t events_old;
+    uint32_t touched_ms;
+    double jitter_raw;
+    double jitter_filtered;
+    uint32_t jitter_n;
+} result_t;
+
+static void run_trace( const trace_t *t, uint16_t latency_ms, result_t *r ) {
+    touch_gesture_t g;
+    touch_filter_t f;
+    touch_gesture_event_t event;
+    uint8_t type = TOUCH_GESTURE_NONE;
+
+    touch_gesture_init( &g, SIM_WIDTH, SIM_HEIGHT );
+    touch_filter_init( &f, latency_ms );
+    /*
+     * new path: TOUCH_UPDATE on press and release, one TOUCH_GESTURE per gesture
+     */
+    r->events_new += 2;
+    for( uint32_t ms = 0 ; ms <= t->duration_ms ; ms += SIM_SAMPLE_MS ) {
+        double p = t->duration_ms ? (double)ms / t->duration_ms : 1.0;
+        double x = t->x0 + ( t->x1 - t->x0 ) * p;
+        double y = t->y0 + ( t->y1 - t->y0 ) * p;
+        int16_t sx, sy;
+        to_raw( x, y, &sx, &sy );
+        touch_calibration_apply( &calibration, &sx, &sy, SIM_WIDTH, SIM_HEIGHT );
+        if ( touch_gesture_push( &g, sx, sy, ms, &event ) ) {
+            type = event.type;
+            r->events_new++;
+        }
+        int16_t fx = sx, fy = sy;
+        touch_filter_push( &f, &fx, &fy, ms );
+        if ( t->label == TOUCH_GESTURE_LONG_PRESS && ms > 100 ) {
+            r->jitter_raw += ( sx - x ) * ( sx - x ) + ( sy - y ) * ( sy - y );
+            r->jitter_filtered += ( fx - x ) * ( fx - x ) + ( fy - y ) * ( fy - y );
+            r->jitter_n++;
+        }
+    }
+    if ( touch_gesture_release( &g, t->duration_ms + SIM_SAMPLE_MS, &event ) ) {
+        type = event.type;
+        r->events_new++;
+    }
+    /*
+     * old path: one TOUCH_UPDATE per lvgl read while touched and one on release
+     */
+    r->events_old += t->duration_ms / SIM_LV_READ_MS + 2;
+    r->touched_ms += t->duration_ms + SIM_SAMPLE_MS;
+    if ( type == t->label ) {
+        r->recognized++;
+    }
+    else {
+        r->wrong++;
+    }
+}
+
+/*
+ * mean distance of the filtered pointer to the finger at 300 px/s
+ */
+static double filter_lag( uint16_t latency_ms ) {
+    touch_filter_t f;
+    double lag = 0.0;
+    int n = 0;
+
+    touch_filter_init( &f, latency_ms );
+    for( uint32_t ms = 0 ; ms <= 500 ; ms += SIM_SAMPLE_MS ) {
+        int16_t x = 20 + ms * 300 / 1000;
+        int16_t y = 120;
+        int16_t fx = x, fy = y;
+        touch_filter_push( &f, &fx, &fy, ms );
+        if ( ms >= 200 ) {
+            lag += fabs( (double)fx - x );
+            n++;
+        }
+    }
+    return( lag / n );
+}
+
+int main( int argc, char **argv ) {
+    srand( argc > 1 ? atoi( argv[ 1 ] ) : 1 );
+    uint32_t errors = 0;
+
+    printf( "gesture\t\trecognized\n" );
+    result_t total = {};
+    for( uint8_t label = TOUCH_GESTURE_NONE ; label < TOUCH_GESTURE_NUM ; label++ ) {
+        result_t r = {};
+        for( int i = 0 ; i < SIM_TRACES ; i++ ) {
+            trace_t t = make_trace( label );
+            run_trace( &t, 20, &r );
+        }
+        printf( "%-12s\t%u/%d\n", label == TOUCH_GESTURE_NONE ? "slow drag" : touch_gesture_get_name( label ), r.recognized, SIM_TRACES );
+        errors += r.wrong;
+        total.events_new += r.events_new;
+        total.events_old += r.events_old;
+        total.touched_ms += r.touched_ms;
+        total.jitter_raw += r.jitter_raw;
+        total.jitter_filtered += r.jitter_filtered;
+        total.jitter_n += r.jitter_n;
+    }
+    printf( "\ncallback events per touched second: old %.1f, new %.1f\n", total.events_old * 1000.0 / total.touched_ms, total.events_new * 1000.0 / total.touched_ms );
+    printf( "resting finger error: raw %.2f px, filtered %.2f px (rms, 20ms filter)\n", sqrt( total.jitter_raw / total.jitter_n ), sqrt( total.jitter_filtered / total.jitter_n ) );
+
+    printf( "\nfilter ms\tlag at 300px/s\n" );
+    uint16_t latencies[] = { 0, 10, 20, 40 };
+    for( int i = 0 ; i < 4 ; i++ ) {
+        printf( "%d\t\t%.1f px\n", latencies[ i ], filter_lag( latencies[ i ] ) );
+    }
+    /*
+     * latency model: the old path waits for the next lvgl read period,
+     * the new path samples on the interrupt wakeup and makes the lvgl
+     * read task ready for the same loop pass
+     */
+    double old_sum = 0.0, old_max = 0.0;
+    for( int i = 0 ; i < 10000 ; i++ ) {
+        double us = rnd() * SIM_LV_READ_MS * 1000.0 + SIM_I2C_US;
+        old_sum += us;
+        old_max = us > old_max ? us : old_max;
+    }
+    printf( "\ninterrupt to lvgl: old %.1f ms avg, %.1f ms max; new %.1f ms\n", old_sum / 10000 / 1000.0, old_max / 1000.0, ( SIM_WAKE_US + SIM_I2C_US ) / 1000.0 );
+    printf( "\nwrong gestures: %u of %d\n", errors, SIM_TRACES * TOUCH_GESTURE_NUM );
+    return( errors > SIM_TRACES * TOUCH_GESTURE_NUM / 100 ? 1 : 0 );
+}